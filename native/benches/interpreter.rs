@@ -0,0 +1,220 @@
+//! Criterion benchmarks for the interpreter binding.
+//!
+//! Covers create/compile latency, run throughput, per-external-call
+//! overhead, snapshot/restore cost, and value-conversion cost by payload
+//! size. Run `cargo bench -- --save-baseline <name>` before bumping the
+//! monty rev and `cargo bench -- --baseline <name>` after to compare.
+
+use std::ffi::c_void;
+use std::hint::black_box;
+
+use criterion::{BenchmarkId, Criterion, Throughput, criterion_group, criterion_main};
+use dart_monty_native::*;
+use monty::MontyObject;
+
+const PAYLOAD_SIZES: [usize; 3] = [10, 1_000, 100_000];
+const CALLS: usize = 100;
+
+const FIB: &str = "def fib(n):\n    return n if n < 2 else fib(n - 1) + fib(n - 2)\n\nfib(18)";
+
+fn call_loop() -> String {
+    format!("total = 0\nfor i in range({CALLS}):\n    total += lookup(i)\ntotal")
+}
+
+fn large_program() -> String {
+    let mut code: String = (0..200)
+        .map(|i| format!("def f{i}(x):\n    return x + {i}\n\n"))
+        .collect();
+    code.push('0');
+    code
+}
+
+fn handle(code: &str, ext_fns: &[&str]) -> MontyHandle {
+    let ext_fns = ext_fns.iter().map(|s| s.to_string()).collect();
+    MontyHandle::new(code.to_string(), ext_fns, None).unwrap()
+}
+
+fn payload(size: usize) -> MontyObject {
+    MontyObject::List((0..size as i64).map(MontyObject::Int).collect())
+}
+
+/// Native function returning its first argument.
+unsafe extern "C" fn identity(
+    _user_data: *mut c_void,
+    args: *const u8,
+    args_len: usize,
+    _kwargs: *const u8,
+    _kwargs_len: usize,
+    result: *mut MontyNativeResult,
+) {
+    let args = unsafe { std::slice::from_raw_parts(args, args_len) };
+    if let Ok(MontyObject::List(items)) = decode_object(args) {
+        let first = items.into_iter().next().unwrap_or(MontyObject::None);
+        unsafe { (*result).set_value(&encode_object(&first)) };
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Create / compile
+// ---------------------------------------------------------------------------
+
+fn bench_create(c: &mut Criterion) {
+    let mut group = c.benchmark_group("create");
+    let large = large_program();
+
+    group.bench_function("trivial", |b| b.iter(|| handle(black_box("1"), &[])));
+    group.bench_function("200_defs", |b| b.iter(|| handle(black_box(&large), &[])));
+
+    let program = MontyProgram::compile(large.clone(), vec![], None).unwrap();
+    group.bench_function("200_defs_instantiate", |b| b.iter(|| program.instantiate()));
+    group.finish();
+}
+
+// ---------------------------------------------------------------------------
+// Run throughput
+// ---------------------------------------------------------------------------
+
+fn bench_run(c: &mut Criterion) {
+    let mut group = c.benchmark_group("run");
+    let program = MontyProgram::compile(FIB.to_string(), vec![], None).unwrap();
+
+    group.bench_function("fib_18", |b| {
+        b.iter(|| {
+            let mut h = program.instantiate();
+            black_box(h.execute().unwrap())
+        })
+    });
+    group.finish();
+}
+
+// ---------------------------------------------------------------------------
+// External calls
+// ---------------------------------------------------------------------------
+
+fn bench_external_call(c: &mut Criterion) {
+    let mut group = c.benchmark_group("external_call");
+    group.throughput(Throughput::Elements(CALLS as u64));
+    let program = MontyProgram::compile(call_loop(), vec!["lookup".into()], None).unwrap();
+
+    group.bench_function("json", |b| {
+        b.iter(|| {
+            let mut h = program.instantiate();
+            let (mut tag, _) = h.start();
+            while tag == MontyProgressTag::Pending {
+                let args = h.pending_fn_args_json().unwrap();
+                let arg: Vec<i64> = serde_json::from_str(args).unwrap();
+                (tag, _) = h.resume(&arg[0].to_string());
+            }
+            black_box(h.complete_result_json().map(str::len))
+        })
+    });
+
+    group.bench_function("bin", |b| {
+        b.iter(|| {
+            let mut h = program.instantiate();
+            let (mut tag, _) = h.start();
+            while tag == MontyProgressTag::Pending {
+                let args = h.pending_fn_args_bin().unwrap();
+                let MontyObject::List(items) = decode_object(&args).unwrap() else {
+                    unreachable!()
+                };
+                (tag, _) = h.resume_bin(&encode_object(&items[0]));
+            }
+            black_box(h.complete_result_bin())
+        })
+    });
+
+    group.bench_function("progress_descriptor", |b| {
+        b.iter(|| {
+            let mut h = program.instantiate();
+            let (mut tag, _) = h.start();
+            while tag == MontyProgressTag::Pending {
+                black_box(h.progress_bin(tag));
+                let args = h.pending_fn_args_bin().unwrap();
+                let MontyObject::List(items) = decode_object(&args).unwrap() else {
+                    unreachable!()
+                };
+                (tag, _) = h.resume_bin(&encode_object(&items[0]));
+            }
+            black_box(h.progress_bin(tag))
+        })
+    });
+
+    group.bench_function("native_fn", |b| {
+        b.iter(|| {
+            let mut h = program.instantiate();
+            h.register_native_fn("lookup".into(), identity, std::ptr::null_mut());
+            black_box(h.execute().unwrap())
+        })
+    });
+    group.finish();
+}
+
+// ---------------------------------------------------------------------------
+// Snapshot / restore
+// ---------------------------------------------------------------------------
+
+fn bench_snapshot(c: &mut Criterion) {
+    let mut group = c.benchmark_group("snapshot");
+    let mut paused = handle("x = [i for i in range(1000)]\nfetch(len(x))", &["fetch"]);
+    assert_eq!(paused.start().0, MontyProgressTag::Pending);
+    let bytes = paused.snapshot().unwrap();
+
+    group.bench_function("snapshot", |b| b.iter(|| paused.snapshot().unwrap()));
+    group.bench_function("restore", |b| {
+        b.iter(|| MontyHandle::restore(black_box(&bytes)).unwrap())
+    });
+    group.bench_function("restore_resume", |b| {
+        b.iter(|| {
+            let mut h = MontyHandle::restore(&bytes).unwrap();
+            black_box(h.resume("0"))
+        })
+    });
+    group.finish();
+}
+
+// ---------------------------------------------------------------------------
+// Value conversion
+// ---------------------------------------------------------------------------
+
+fn bench_value_transfer(c: &mut Criterion) {
+    let mut group = c.benchmark_group("value_transfer");
+    let program = MontyProgram::compile("echo()".into(), vec!["echo".into()], None).unwrap();
+
+    for size in PAYLOAD_SIZES {
+        let value = payload(size);
+        let json = serde_json::to_string(&(0..size).collect::<Vec<_>>()).unwrap();
+        group.throughput(Throughput::Elements(size as u64));
+
+        group.bench_with_input(BenchmarkId::new("json", size), &json, |b, json| {
+            b.iter(|| {
+                let mut h = program.instantiate();
+                h.start();
+                h.resume(json);
+                black_box(h.complete_result_json().map(str::len))
+            })
+        });
+        group.bench_with_input(BenchmarkId::new("bin", size), &value, |b, value| {
+            b.iter(|| {
+                let mut h = program.instantiate();
+                h.start();
+                h.resume_bin(&encode_object(value));
+                black_box(h.complete_result_bin())
+            })
+        });
+        group.bench_with_input(BenchmarkId::new("codec", size), &value, |b, value| {
+            b.iter(|| decode_object(&encode_object(black_box(value))).unwrap())
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    bench_create,
+    bench_run,
+    bench_external_call,
+    bench_snapshot,
+    bench_value_transfer,
+);
+criterion_main!(benches);
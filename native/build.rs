@@ -6,4 +6,17 @@ fn main() {
     if target_os == "macos" {
         println!("cargo:rustc-cdylib-link-arg=-Wl,-install_name,@rpath/libdart_monty_native.dylib");
     }
+
+    // Expose the pinned monty revision, so on-disk program caches can tell
+    // files written by a different interpreter build apart.
+    let manifest = std::fs::read_to_string("Cargo.toml").unwrap_or_default();
+    let rev = manifest
+        .lines()
+        .find(|line| line.trim_start().starts_with("monty "))
+        .and_then(|line| line.split("rev = \"").nth(1))
+        .and_then(|rest| rest.split('"').next())
+        .unwrap_or("unknown");
+    println!("cargo:rustc-env=DART_MONTY_MONTY_REV={rev}");
+    println!("cargo:rerun-if-changed=Cargo.toml");
+    println!("cargo:rerun-if-changed=build.rs");
 }
@@ -23,6 +23,75 @@ extern "C" {
 /** Opaque handle to a compiled Python program. */
 typedef struct MontyHandle MontyHandle;
 
+/**
+ * Opaque compiled program. Compiled once with monty_program_compile(),
+ * instantiated into any number of MontyHandle executions.
+ */
+typedef struct MontyProgram MontyProgram;
+
+/**
+ * Opaque, thread-safe, reference-counted cache of compiled programs; see
+ * monty_cache_new().
+ */
+typedef struct MontyProgramCache MontyProgramCache;
+
+/**
+ * Opaque, thread-safe, reference-counted cancellation flag; see
+ * monty_interrupt_new().
+ */
+typedef struct MontyInterrupt MontyInterrupt;
+
+/** Opaque persistent session (live globals between feeds). */
+typedef struct MontyReplSession MontyReplSession;
+
+/** Opaque outcome of a native function call; see MontyNativeFn. */
+typedef struct MontyNativeResult MontyNativeResult;
+
+/**
+ * Native host function, called in-process without pausing the VM.
+ *
+ * @param user_data   Pointer given to monty_register_native_fn().
+ * @param args        Encoded List of positional arguments (borrowed).
+ * @param args_len    Byte count of args.
+ * @param kwargs      Encoded Dict of keyword arguments (borrowed).
+ * @param kwargs_len  Byte count of kwargs.
+ * @param result      Set with monty_native_result_set_bin() or
+ *                    monty_native_result_set_error(); untouched means None.
+ */
+typedef void (*MontyNativeFn)(void *user_data,
+                              const uint8_t *args,
+                              size_t args_len,
+                              const uint8_t *kwargs,
+                              size_t kwargs_len,
+                              MontyNativeResult *result);
+
+/**
+ * Print output callback, see monty_set_output_stream().
+ *
+ * @param user_data  Pointer given to monty_set_output_stream().
+ * @param text       UTF-8 output, not NUL-terminated (borrowed). Normally
+ *                   whole lines; a trailing partial line is delivered when
+ *                   the VM pauses or completes.
+ * @param len        Byte count of text.
+ */
+typedef void (*MontyOutputCallback)(void *user_data,
+                                    const char *text,
+                                    size_t len);
+
+/**
+ * Batch result callback, see monty_run_batch().
+ *
+ * @param user_data  Pointer given to monty_run_batch().
+ * @param index      Position of the job in the input list.
+ * @param result     The job's (result_tag, envelope) Tuple in the binary
+ *                   value encoding (borrowed for the call).
+ * @param len        Byte count of result.
+ */
+typedef void (*MontyBatchCallback)(void *user_data,
+                                   size_t index,
+                                   const uint8_t *result,
+                                   size_t len);
+
 /* ------------------------------------------------------------------ */
 /* Enums                                                              */
 /* ------------------------------------------------------------------ */
@@ -41,6 +110,26 @@ typedef enum {
     MONTY_PROGRESS_RESOLVE_FUTURES = 3,
 } MontyProgressTag;
 
+/** Resource usage filled in by monty_usage(). */
+typedef struct {
+    size_t   memory_bytes_used;  /**< Peak live heap bytes. */
+    uint64_t time_elapsed_ms;    /**< Wall time inside the VM (excludes pauses). */
+    size_t   stack_depth_used;   /**< Deepest recursion depth reached. */
+    size_t   allocations;        /**< Number of heap allocations. */
+    int64_t  cpu_time_ms;        /**< Thread CPU time inside the VM, or -1 if unavailable. */
+} MontyUsage;
+
+/** Counters filled in by monty_cache_stats(). */
+typedef struct {
+    uint64_t hits;            /**< Creations that reused a cached program. */
+    uint64_t misses;          /**< Creations that compiled. */
+    size_t   entries;         /**< Programs currently cached. */
+    size_t   bytes;           /**< Approximate size of cached programs. */
+    size_t   capacity_bytes;  /**< Limit given to monty_cache_new(). */
+    uint64_t disk_loads;      /**< Programs read from the cache directory. */
+    uint64_t disk_writes;     /**< Programs written to the cache directory. */
+} MontyCacheStats;
+
 /* ------------------------------------------------------------------ */
 /* Lifecycle                                                          */
 /* ------------------------------------------------------------------ */
@@ -61,11 +150,208 @@ MontyHandle *monty_create(const char *code,
                            const char *script_name,
                            char **out_error);
 
+/**
+ * Create a new handle whose code reads named inputs as global variables.
+ *
+ * Other parameters match monty_create(). To run the same code with
+ * different inputs without recompiling, use
+ * monty_program_compile_with_inputs() instead.
+ *
+ * @param inputs      Dict in the binary value encoding mapping each input
+ *                    name (string) to its value.
+ * @param inputs_len  Byte count of inputs.
+ * @return            Heap-allocated handle, or NULL on error.
+ */
+MontyHandle *monty_create_with_inputs(const char *code,
+                                      const char *ext_fns,
+                                      const uint8_t *inputs,
+                                      size_t inputs_len,
+                                      const char *script_name,
+                                      char **out_error);
+
+/**
+ * Return a handle to Ready state with new code, keeping its internal
+ * buffers for reuse instead of a monty_free() / monty_create() pair.
+ *
+ * Any paused execution is dropped. Limits, native functions
+ * (monty_register_native_fn()), the output stream, buffered print output,
+ * tracing (monty_set_trace()) and resource usage are cleared, exactly as
+ * for a new handle. An interrupt set with monty_set_interrupt() is kept.
+ *
+ * @param handle       Handle in any state.
+ * @param code         NUL-terminated UTF-8 Python source.
+ * @param ext_fns      Comma-separated external function names, or NULL.
+ * @param inputs       Encoded Dict of input name -> value, or NULL.
+ * @param inputs_len   Byte count of inputs.
+ * @param script_name  NUL-terminated script name for tracebacks, or NULL.
+ * @param out_error    Receives error message on failure (caller frees).
+ * @return             0 on success, -1 on error (handle left unchanged).
+ */
+int monty_reset(MontyHandle *handle,
+                const char *code,
+                const char *ext_fns,
+                const uint8_t *inputs,
+                size_t inputs_len,
+                const char *script_name,
+                char **out_error);
+
 /**
  * Free a handle. Safe to call with NULL.
  */
 void monty_free(MontyHandle *handle);
 
+/* ------------------------------------------------------------------ */
+/* Compiled programs                                                  */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Compile Python source code once into a reusable program.
+ *
+ * Parameters match monty_create(). Use monty_program_instantiate() to
+ * create execution handles without re-parsing the source.
+ *
+ * @param out_error  On failure, receives a heap-allocated error message.
+ *                   Caller frees with monty_string_free(). May be NULL.
+ * @return           Heap-allocated program, or NULL on error.
+ *                   Caller frees with monty_program_free().
+ */
+MontyProgram *monty_program_compile(const char *code,
+                                    const char *ext_fns,
+                                    const char *script_name,
+                                    char **out_error);
+
+/**
+ * Compile a reusable program whose code reads named inputs as global
+ * variables. Other parameters match monty_program_compile().
+ *
+ * @param input_names  Comma-separated input names, or NULL for none.
+ * @return             Heap-allocated program, or NULL on error.
+ *                     Caller frees with monty_program_free().
+ */
+MontyProgram *monty_program_compile_with_inputs(const char *code,
+                                                const char *ext_fns,
+                                                const char *input_names,
+                                                const char *script_name,
+                                                char **out_error);
+
+/**
+ * Create a new handle in Ready state from a compiled program.
+ *
+ * The program is left untouched and may be instantiated again.
+ *
+ * @param program    Valid program from monty_program_compile().
+ * @param out_error  Receives error message on failure. Caller frees.
+ * @return           Heap-allocated handle, or NULL on error.
+ *                   Caller frees with monty_free().
+ */
+MontyHandle *monty_program_instantiate(const MontyProgram *program,
+                                       char **out_error);
+
+/**
+ * Create a new handle from a program compiled with inputs, binding a value
+ * to each of them.
+ *
+ * @param program     Valid program from monty_program_compile_with_inputs().
+ * @param inputs      Dict in the binary value encoding mapping every
+ *                    declared input name to its value. Missing or unknown
+ *                    names are an error.
+ * @param inputs_len  Byte count of inputs.
+ * @param out_error   Receives error message on failure. Caller frees.
+ * @return            Heap-allocated handle, or NULL on error.
+ *                    Caller frees with monty_free().
+ */
+MontyHandle *monty_program_instantiate_with_inputs(const MontyProgram *program,
+                                                   const uint8_t *inputs,
+                                                   size_t inputs_len,
+                                                   char **out_error);
+
+/**
+ * Free a program. Safe to call with NULL.
+ * Handles instantiated from it remain valid.
+ */
+void monty_program_free(MontyProgram *program);
+
+/* ------------------------------------------------------------------ */
+/* Program cache                                                      */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Create a cache of compiled programs, keyed by source hash, external
+ * function names, script name and input names. Least recently used
+ * programs are evicted once capacity_bytes is exceeded.
+ *
+ * The cache may be used from any thread. Share it by calling
+ * monty_cache_retain() once per extra owner.
+ *
+ * @param capacity_bytes  Approximate size limit; 0 disables caching.
+ * @return                New cache with one reference.
+ *                        Release with monty_cache_free().
+ */
+const MontyProgramCache *monty_cache_new(size_t capacity_bytes);
+
+/**
+ * Create a cache like monty_cache_new(), backed by a directory.
+ *
+ * Each compiled program is also written to dir as a snapshot container
+ * named after its key and the monty revision of this build. Nothing is
+ * read on open: a lookup that misses in memory loads the file for its key,
+ * if one from the same revision exists, instead of compiling. Other files
+ * are ignored.
+ *
+ * @param capacity_bytes  Approximate in-memory size limit.
+ * @param dir             NUL-terminated directory path; created if missing.
+ * @param out_error       Receives error message on failure (caller frees).
+ * @return                New cache with one reference, or NULL on error.
+ *                        Release with monty_cache_free().
+ */
+const MontyProgramCache *monty_cache_open(size_t capacity_bytes,
+                                          const char *dir,
+                                          char **out_error);
+
+/** Take another reference to cache. Safe to call with NULL. */
+void monty_cache_retain(const MontyProgramCache *cache);
+
+/**
+ * Release a reference to cache, freeing it with the last one. Safe to call
+ * with NULL. Handles created from the cache remain valid.
+ */
+void monty_cache_free(const MontyProgramCache *cache);
+
+/** Drop every program cached in memory. Counters and dir are kept. */
+void monty_cache_clear(const MontyProgramCache *cache);
+
+/**
+ * Read the cache counters.
+ *
+ * @param cache  Cache to query.
+ * @param out    Receives the counters.
+ * @return       0 on success, -1 if cache or out is NULL.
+ */
+int monty_cache_stats(const MontyProgramCache *cache, MontyCacheStats *out);
+
+/**
+ * Create a handle, reusing a compiled program from cache when one matches.
+ *
+ * @param cache        Cache from monty_cache_new().
+ * @param code         NUL-terminated UTF-8 Python source.
+ * @param ext_fns      Comma-separated external function names, or NULL.
+ * @param inputs       Encoded Dict of input name -> value (see "Binary
+ *                     values"), or NULL for no inputs. Only the names are
+ *                     part of the cache key.
+ * @param inputs_len   Byte count of inputs.
+ * @param script_name  NUL-terminated script name for tracebacks, or NULL.
+ * @param out_error    Receives error message on failure (caller frees).
+ * @return             Heap-allocated handle, or NULL on error.
+ *                     Caller frees with monty_free().
+ */
+MontyHandle *monty_create_cached(const MontyProgramCache *cache,
+                                 const char *code,
+                                 const char *ext_fns,
+                                 const uint8_t *inputs,
+                                 size_t inputs_len,
+                                 const char *script_name,
+                                 char **out_error);
+
 /* ------------------------------------------------------------------ */
 /* Run to completion                                                  */
 /* ------------------------------------------------------------------ */
@@ -84,6 +370,56 @@ MontyResultTag monty_run(MontyHandle *handle,
                           char **result_json,
                           char **error_msg);
 
+/* ------------------------------------------------------------------ */
+/* Batch execution                                                    */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Run a compiled program to completion once per input set, in parallel
+ * on a pool of native threads. The program is not modified.
+ *
+ * Each job's result is a (result_tag, envelope) Tuple in the binary value
+ * encoding, the envelope as from monty_complete_result_bin(). A failing
+ * job reports its error there without stopping the others. Jobs cannot
+ * call external functions. Packed arrays in every result, including each
+ * element of out_results, are aligned to the start of the buffer passed
+ * back.
+ *
+ * @param program      Program from monty_program_compile_with_inputs().
+ * @param inputs       Binary-encoded List with one Dict per job, mapping
+ *                     each input name to its value (borrowed).
+ * @param inputs_len   Byte count of inputs.
+ * @param threads      Worker threads, or 0 for one per available core;
+ *                     a larger count is clamped to the available cores.
+ * @param limits_json  Limits for every job: JSON object with optional
+ *                     "memory_bytes", "timeout_ms" and "stack_depth"
+ *                     keys. NULL for none.
+ * @param interrupt    Watched by every job, or NULL. Setting it stops the
+ *                     running jobs with a KeyboardInterrupt and fails
+ *                     those not yet started; all results are still
+ *                     reported.
+ * @param on_result    If non-NULL, called on the calling thread with each
+ *                     result as its job finishes, in completion order;
+ *                     out_results and out_len are then not written.
+ * @param user_data    Passed through to on_result.
+ * @param out_results  Otherwise receives a binary List of every result in
+ *                     input order. Caller frees with monty_bytes_free().
+ * @param out_len      Receives the byte count of out_results.
+ * @param out_error    Receives error message on failure. Caller frees.
+ * @return             0 on success, -1 on invalid arguments.
+ */
+int monty_run_batch(const MontyProgram *program,
+                    const uint8_t *inputs,
+                    size_t inputs_len,
+                    size_t threads,
+                    const char *limits_json,
+                    const MontyInterrupt *interrupt,
+                    MontyBatchCallback on_result,
+                    void *user_data,
+                    uint8_t **out_results,
+                    size_t *out_len,
+                    char **out_error);
+
 /* ------------------------------------------------------------------ */
 /* Iterative execution                                                */
 /* ------------------------------------------------------------------ */
@@ -225,13 +561,282 @@ char *monty_complete_result_json(const MontyHandle *handle);
  */
 int monty_complete_is_error(const MontyHandle *handle);
 
+/**
+ * Read the resource usage so far. Valid in every state, including while
+ * paused at an external call; the same figures appear in the "usage" key
+ * of the result. Does not allocate.
+ *
+ * @param handle  Valid handle.
+ * @param out     Receives the usage.
+ * @return        0 on success, -1 if handle or out is NULL.
+ */
+int monty_usage(const MontyHandle *handle, MontyUsage *out);
+
+/**
+ * Inspect the live heap and stack. Valid in every state; meant for a
+ * handle paused at an external call.
+ *
+ * The object has "state", "heap_bytes", "peak_heap_bytes",
+ * "memory_limit", "live_allocations", "allocations", "live_by_size"
+ * (non-empty power-of-two size classes as {"max_bytes", "count"},
+ * "max_bytes" null for the largest), "stack_depth" (where the VM
+ * stopped), "max_stack_depth", "stack_limit", "time_elapsed_ms", and
+ * "pending": the paused call's "function_name", "call_id", and
+ * "args"/"kwargs" described as {"type", "len"}, or null. Live counts
+ * cover activity since the handle was created or restored.
+ *
+ * @param handle  Handle to inspect.
+ * @return        JSON object (caller frees with monty_string_free), or
+ *                NULL if handle is NULL.
+ */
+char *monty_inspect_json(const MontyHandle *handle);
+
+/* ------------------------------------------------------------------ */
+/* Result access                                                      */
+/* ------------------------------------------------------------------ */
+
+/*
+ * Read parts of a completed value without serializing the rest of it.
+ * The value stays in the handle until monty_free().
+ *
+ * path_json is a JSON array of steps from the value: a string selects a
+ * dict key or dataclass attribute, an integer a list/tuple element
+ * (negative from the end) or an integer dict key. NULL or "[]" selects the
+ * whole value. Example: ["users", 0, "name"].
+ */
+
+/**
+ * Get the part of the completed value at path_json as JSON.
+ *
+ * @param out_error  Receives an error message if the handle is not
+ *                   complete or the path does not resolve (caller frees).
+ * @return           Heap-allocated JSON string, or NULL on error.
+ *                   Caller frees with monty_string_free().
+ */
+char *monty_result_get_path(const MontyHandle *handle, const char *path_json,
+                            char **out_error);
+
+/**
+ * Get the part of the completed value at path_json in the binary value
+ * encoding.
+ *
+ * @param out_len    Receives byte count.
+ * @param out_error  As for monty_result_get_path().
+ * @return           Heap-allocated buffer, or NULL on error. Caller frees
+ *                   with monty_bytes_free().
+ */
+uint8_t *monty_result_get_path_bin(const MontyHandle *handle,
+                                   const char *path_json, size_t *out_len,
+                                   char **out_error);
+
+/**
+ * Get value[start:end] for the list, tuple, str or bytes at path_json as
+ * JSON. Bounds follow Python: negative bounds count from the end and
+ * out-of-range bounds are clamped (pass INT64_MAX as end for "to the
+ * end").
+ *
+ * @param out_error  Receives an error message on failure (caller frees).
+ * @return           Heap-allocated JSON string, or NULL on error.
+ *                   Caller frees with monty_string_free().
+ */
+char *monty_result_slice(const MontyHandle *handle, const char *path_json,
+                         int64_t start, int64_t end, char **out_error);
+
+/**
+ * Get value[start:end] like monty_result_slice(), in the binary value
+ * encoding.
+ *
+ * @param out_len    Receives byte count.
+ * @return           Heap-allocated buffer, or NULL on error. Caller frees
+ *                   with monty_bytes_free().
+ */
+uint8_t *monty_result_slice_bin(const MontyHandle *handle,
+                                const char *path_json, int64_t start,
+                                int64_t end, size_t *out_len,
+                                char **out_error);
+
+/**
+ * len() of the part of the completed value at path_json.
+ *
+ * @return  The length, or -1 if the handle is not complete, the path does
+ *          not resolve, or the value has no length.
+ */
+int64_t monty_result_len(const MontyHandle *handle, const char *path_json);
+
+/**
+ * Python type name ("dict", "list", "int", ...) of the part of the
+ * completed value at path_json.
+ *
+ * @return  Heap-allocated string, or NULL if the handle is not complete
+ *          or the path does not resolve. Caller frees with
+ *          monty_string_free().
+ */
+char *monty_result_type(const MontyHandle *handle, const char *path_json);
+
+/* ------------------------------------------------------------------ */
+/* Binary values                                                      */
+/* ------------------------------------------------------------------ */
+
+/*
+ * Compact tagged encoding used by the *_bin functions in place of JSON.
+ * Each value is a one-byte tag followed by its payload. All integers are
+ * little-endian; lengths and element counts are uint32.
+ *
+ *   0x00 None          0x07 Bytes      (len, raw bytes)
+ *   0x01 False         0x08 List       (count, values)
+ *   0x02 True          0x09 Tuple      (count, values)
+ *   0x03 Int    (i64)  0x0A Dict       (count, key/value pairs)
+ *   0x04 BigInt        0x0B Set        (count, values)
+ *        (sign u8 0=+ 1=-, len, magnitude bytes LE)
+ *   0x05 Float  (f64)  0x0C FrozenSet  (count, values)
+ *   0x06 String        0x0D Ellipsis
+ *        (len, UTF-8 bytes)
+ *   0x0E IntArray   (count, pad len u8, pad, i64 x count)
+ *   0x0F FloatArray (count, pad len u8, pad, f64 x count)
+ *
+ * A List of 16 or more values that are all Int (or all Float) is written
+ * as an IntArray (FloatArray). The pad aligns the first element to 8
+ * bytes from the start of the buffer, so it can be read in place.
+ *
+ * The complete-result envelope is a Dict with String keys "value",
+ * "usage" and optionally "error" and "print_output", mirroring the JSON
+ * envelope. Buffers returned by these functions are freed with
+ * monty_bytes_free().
+ */
+
+/**
+ * Get the pending function arguments as an encoded List.
+ * Only valid after monty_start/monty_resume returned MONTY_PROGRESS_PENDING.
+ *
+ * @param out_len  Receives byte count.
+ * @return         Heap-allocated buffer, or NULL. Caller frees with monty_bytes_free().
+ */
+uint8_t *monty_pending_fn_args_bin(const MontyHandle *handle,
+                                   size_t *out_len);
+
+/**
+ * Get the pending function keyword arguments as an encoded Dict.
+ * Only valid after monty_start/monty_resume returned MONTY_PROGRESS_PENDING.
+ *
+ * @param out_len  Receives byte count.
+ * @return         Heap-allocated buffer, or NULL. Caller frees with monty_bytes_free().
+ */
+uint8_t *monty_pending_fn_kwargs_bin(const MontyHandle *handle,
+                                     size_t *out_len);
+
+/**
+ * Get the completed result envelope as an encoded Dict.
+ * Only valid after execution reached COMPLETE state.
+ *
+ * @param out_len  Receives byte count.
+ * @return         Heap-allocated buffer, or NULL. Caller frees with monty_bytes_free().
+ */
+uint8_t *monty_complete_result_bin(const MontyHandle *handle,
+                                   size_t *out_len);
+
+/**
+ * Resume execution with an encoded return value.
+ *
+ * @param handle     Handle in PENDING state.
+ * @param value      Pointer to the encoded value.
+ * @param len        Byte count.
+ * @param out_error  Receives error message on failure. Caller frees.
+ * @return           MONTY_PROGRESS_COMPLETE, _PENDING, or _ERROR.
+ */
+MontyProgressTag monty_resume_bin(MontyHandle *handle,
+                                  const uint8_t *value,
+                                  size_t len,
+                                  char **out_error);
+
+/**
+ * Resume futures with encoded results and errors.
+ * Only valid when handle is in RESOLVE_FUTURES state.
+ *
+ * @param handle       Handle in RESOLVE_FUTURES state.
+ * @param results      Encoded Dict mapping Int call_id to value.
+ * @param results_len  Byte count of results.
+ * @param errors       Encoded Dict mapping Int call_id to String message,
+ *                     or NULL for no errors.
+ * @param errors_len   Byte count of errors (ignored if errors is NULL).
+ * @param out_error    Receives error message on failure. Caller frees.
+ * @return             MONTY_PROGRESS_COMPLETE, _RESOLVE_FUTURES, _PENDING,
+ *                     or _ERROR.
+ */
+MontyProgressTag monty_resume_futures_bin(MontyHandle *handle,
+                                          const uint8_t *results,
+                                          size_t results_len,
+                                          const uint8_t *errors,
+                                          size_t errors_len,
+                                          char **out_error);
+
+/* ------------------------------------------------------------------ */
+/* Single-crossing progress                                           */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Describe the current progress in one encoded buffer, replacing the
+ * monty_pending_* / monty_complete_* accessor sequence.
+ *
+ * The descriptor is an encoded Tuple whose first element is the tag:
+ *   PENDING:          (1, fn_name, args, kwargs, call_id, method_call)
+ *   COMPLETE / ERROR: (tag, result) -- the monty_complete_result_bin envelope
+ *   RESOLVE_FUTURES:  (3, call_ids)
+ *
+ * @param handle   Valid handle.
+ * @param out_len  Receives byte count.
+ * @return         Heap-allocated buffer, or NULL in Ready state.
+ *                 Caller frees with monty_bytes_free().
+ */
+uint8_t *monty_progress_bin(const MontyHandle *handle,
+                            size_t *out_len);
+
+/**
+ * monty_start() that also returns the resulting progress descriptor
+ * (see monty_progress_bin()).
+ *
+ * @param handle        Handle in Ready state.
+ * @param out_progress  Receives the descriptor, or NULL. Caller frees
+ *                      with monty_bytes_free().
+ * @param out_len       Receives descriptor byte count.
+ * @param out_error     Receives error message on failure. Caller frees.
+ * @return              MONTY_PROGRESS_COMPLETE, _PENDING, _RESOLVE_FUTURES,
+ *                      or _ERROR.
+ */
+MontyProgressTag monty_start_step(MontyHandle *handle,
+                                  uint8_t **out_progress,
+                                  size_t *out_len,
+                                  char **out_error);
+
+/**
+ * monty_resume_bin() that also returns the next progress descriptor
+ * (see monty_progress_bin()): one crossing per external call.
+ *
+ * @param handle        Handle in PENDING state.
+ * @param value         Pointer to the encoded return value.
+ * @param len           Byte count.
+ * @param out_progress  Receives the descriptor, or NULL. Caller frees
+ *                      with monty_bytes_free().
+ * @param out_len       Receives descriptor byte count.
+ * @param out_error     Receives error message on failure. Caller frees.
+ * @return              MONTY_PROGRESS_COMPLETE, _PENDING, _RESOLVE_FUTURES,
+ *                      or _ERROR.
+ */
+MontyProgressTag monty_resume_step(MontyHandle *handle,
+                                   const uint8_t *value,
+                                   size_t len,
+                                   uint8_t **out_progress,
+                                   size_t *out_len,
+                                   char **out_error);
+
 /* ------------------------------------------------------------------ */
 /* Snapshots                                                          */
 /* ------------------------------------------------------------------ */
 
 /**
- * Serialize compiled code to a byte buffer (snapshot).
- * Only valid in Ready state.
+ * Serialize a handle to a byte buffer (snapshot).
+ * In Ready state this is the compiled code. While Pending or
+ * ResolveFutures it is the whole in-flight execution (VM state, usage,
+ * pending call metadata, print output). Returns NULL once complete.
  *
  * @param handle   Valid handle.
  * @param out_len  Receives byte count.
@@ -242,6 +847,9 @@ uint8_t *monty_snapshot(const MontyHandle *handle,
 
 /**
  * Restore a handle from a snapshot byte buffer.
+ * An in-flight snapshot restores paused; see monty_progress_state().
+ * data may also be a snapshot container (see monty_snapshot_file()),
+ * e.g. part of a caller-owned mmap; it is only borrowed for the call.
  *
  * @param data       Pointer to snapshot bytes.
  * @param len        Byte count.
@@ -252,6 +860,126 @@ MontyHandle *monty_restore(const uint8_t *data,
                             size_t len,
                             char **out_error);
 
+/**
+ * Write a handle's snapshot to a file as a snapshot container: magic,
+ * version, CRC-32 and length header, then the monty_snapshot() bytes.
+ * Written to a temporary sibling and renamed into place.
+ *
+ * @param handle     Valid handle (Ready, Pending, or ResolveFutures).
+ * @param path       Destination path (UTF-8).
+ * @param out_error  Receives error message on failure. Caller frees.
+ * @return           0 on success, -1 on error.
+ */
+int monty_snapshot_file(const MontyHandle *handle,
+                        const char *path,
+                        char **out_error);
+
+/**
+ * Restore a handle from a snapshot container file. On unix the file is
+ * memory-mapped and deserialized in place, without a heap copy.
+ *
+ * @param path       File written by monty_snapshot_file() (UTF-8).
+ * @param out_error  Receives error message on failure. Caller frees.
+ * @return           New heap-allocated handle, or NULL on error.
+ */
+MontyHandle *monty_restore_file(const char *path,
+                                char **out_error);
+
+/**
+ * Current progress of a handle, e.g. after monty_restore().
+ *
+ * @param handle  Valid handle.
+ * @return        A MontyProgressTag value, or -1 in Ready state or if NULL.
+ */
+int monty_progress_state(const MontyHandle *handle);
+
+/* ------------------------------------------------------------------ */
+/* Native host functions                                              */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Register a native function called in-process, without pausing,
+ * whenever Python calls the external function `name`. Calls to other
+ * external functions still pause as usual, and monty_run() can complete
+ * code that only calls native functions.
+ *
+ * `name` must be listed in ext_fns at creation. `func` runs on the thread
+ * driving the handle; `user_data` must stay valid while the handle runs.
+ * Registrations are not snapshotted; register again after monty_restore().
+ *
+ * @param handle     Valid handle, in any state.
+ * @param name       NUL-terminated external function name.
+ * @param func       Callback.
+ * @param user_data  Passed to every call of func.
+ * @return           0 on success, -1 if an argument is NULL or not UTF-8.
+ */
+int monty_register_native_fn(MontyHandle *handle,
+                             const char *name,
+                             MontyNativeFn func,
+                             void *user_data);
+
+/**
+ * Return an encoded value from a native function.
+ * Only valid inside the callback that received `result`.
+ */
+void monty_native_result_set_bin(MontyNativeResult *result,
+                                 const uint8_t *value,
+                                 size_t len);
+
+/**
+ * Raise RuntimeError(message) in Python from a native function.
+ * Only valid inside the callback that received `result`.
+ */
+void monty_native_result_set_error(MontyNativeResult *result,
+                                   const char *message);
+
+/* ------------------------------------------------------------------ */
+/* REPL sessions                                                      */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Create a persistent session. Globals, functions, and imports defined
+ * by one monty_repl_feed() stay live in the VM for the next, so each
+ * feed only compiles and runs the new code.
+ *
+ * @param script_name  Script name for tracebacks, or NULL for "<input>".
+ * @param out_error    Receives error message on failure. Caller frees.
+ * @return             Heap-allocated session, or NULL on error.
+ *                     Caller frees with monty_repl_free().
+ */
+MontyReplSession *monty_repl_create(const char *script_name,
+                                    char **out_error);
+
+/**
+ * Run code in the session's namespace.
+ *
+ * @param session      Valid session.
+ * @param code         NUL-terminated UTF-8 Python source.
+ * @param result_json  Receives the JSON result envelope (also on error);
+ *                     its usage covers this feed only. May be NULL.
+ * @param error_msg    Receives error message on failure, or NULL.
+ * @return             MONTY_RESULT_OK or MONTY_RESULT_ERROR.
+ */
+MontyResultTag monty_repl_feed(MontyReplSession *session,
+                               const char *code,
+                               char **result_json,
+                               char **error_msg);
+
+/** Drop all session state; the next feed starts from an empty namespace. */
+void monty_repl_reset(MontyReplSession *session);
+
+/*
+ * Session limits apply from the next feed, including on a live session.
+ * The time limit applies to each feed; the memory limit covers the
+ * session's whole live heap.
+ */
+void monty_repl_set_memory_limit(MontyReplSession *session, size_t bytes);
+void monty_repl_set_time_limit_ms(MontyReplSession *session, uint64_t ms);
+void monty_repl_set_stack_limit(MontyReplSession *session, size_t depth);
+
+/** Free a session. Safe to call with NULL. */
+void monty_repl_free(MontyReplSession *session);
+
 /* ------------------------------------------------------------------ */
 /* Resource limits                                                    */
 /* ------------------------------------------------------------------ */
@@ -265,6 +993,113 @@ void monty_set_time_limit_ms(MontyHandle *handle, uint64_t ms);
 /** Set stack depth limit. */
 void monty_set_stack_limit(MontyHandle *handle, size_t depth);
 
+/* ------------------------------------------------------------------ */
+/* Interrupts                                                         */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Create a cancellation flag that handles can watch; see
+ * monty_set_interrupt(). Share it by calling monty_interrupt_retain()
+ * once per extra owner.
+ *
+ * @return  New interrupt with one reference, not set.
+ *          Release with monty_interrupt_free().
+ */
+const MontyInterrupt *monty_interrupt_new(void);
+
+/** Take another reference to interrupt. Safe to call with NULL. */
+void monty_interrupt_retain(const MontyInterrupt *interrupt);
+
+/**
+ * Release a reference to interrupt, freeing it with the last one. Safe to
+ * call with NULL. Handles watching it keep their own reference.
+ */
+void monty_interrupt_free(const MontyInterrupt *interrupt);
+
+/**
+ * Interrupt every execution watching interrupt. May be called from any
+ * thread, including while another thread is inside monty_run() or a
+ * resume on a watching handle.
+ *
+ * A running execution stops at its next time check and fails with a
+ * KeyboardInterrupt; a paused one fails when resumed. The flag stays set
+ * until monty_interrupt_clear(). Safe to call with NULL.
+ */
+void monty_interrupt(const MontyInterrupt *interrupt);
+
+/** Unset interrupt. May be called from any thread. Safe to call with NULL. */
+void monty_interrupt_clear(const MontyInterrupt *interrupt);
+
+/**
+ * Make handle watch interrupt (NULL stops watching). Call from the thread
+ * that owns handle, between calls. Applies to the current execution, even
+ * while paused, and is kept by monty_reset().
+ *
+ * @param handle     Handle to watch interrupt; NULL is ignored.
+ * @param interrupt  Interrupt to watch, or NULL. The handle takes its own
+ *                   reference.
+ */
+void monty_set_interrupt(MontyHandle *handle, const MontyInterrupt *interrupt);
+
+/* ------------------------------------------------------------------ */
+/* Tracing                                                            */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Start (enabled != 0) or stop recording trace events on handle. Enabling
+ * a handle that compiled its own source records the compile first;
+ * stopping drops undrained events. monty_reset() stops tracing.
+ *
+ * @param handle   Handle to configure (NULL is a no-op).
+ * @param enabled  Non-zero to record, 0 to stop.
+ */
+void monty_set_trace(MontyHandle *handle, int enabled);
+
+/**
+ * Drain the trace events recorded since the last call, oldest first.
+ *
+ * Each event is an object with "kind" ("compile", "vm", "host" for time
+ * paused waiting on the host, or "convert"), "op" (the call or conversion,
+ * e.g. "start", "resume", "args_bin"), "at_us" (microseconds since the
+ * handle was created or reset), "duration_us", and for conversions
+ * "bytes".
+ *
+ * @return JSON array (caller frees with monty_string_free), or NULL if
+ *         tracing is off.
+ */
+char *monty_trace_json(const MontyHandle *handle);
+
+/* ------------------------------------------------------------------ */
+/* Print output streaming                                             */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Stream print output instead of collecting it into the completion
+ * result's "print_output". Takes effect from the next run, start, or
+ * resume, and is not part of snapshots.
+ *
+ * @param handle              Handle to configure (NULL is a no-op).
+ * @param max_retained_bytes  Without a callback, keep at most this many of
+ *                            the newest bytes for monty_take_output();
+ *                            older output is reported as a
+ *                            "[... N bytes dropped]" line. 0 is unbounded.
+ * @param callback            Called line by line on the thread driving the
+ *                            handle, or NULL to buffer instead.
+ * @param user_data           Passed to callback; must outlive the handle.
+ */
+void monty_set_output_stream(MontyHandle *handle,
+                             size_t max_retained_bytes,
+                             MontyOutputCallback callback,
+                             void *user_data);
+
+/**
+ * Drain output buffered since the last call.
+ *
+ * @return Buffered output (caller frees with monty_string_free), or NULL
+ *         if there is none.
+ */
+char *monty_take_output(MontyHandle *handle);
+
 /* ------------------------------------------------------------------ */
 /* Memory management                                                  */
 /* ------------------------------------------------------------------ */
@@ -272,9 +1107,19 @@ void monty_set_stack_limit(MontyHandle *handle, size_t depth);
 /** Free a string returned by any monty_* function. Safe with NULL. */
 void monty_string_free(char *ptr);
 
-/** Free a byte buffer returned by monty_snapshot(). Safe with NULL. */
+/**
+ * Free a byte buffer returned by monty_snapshot() or a *_bin function.
+ * len must be the length returned with it. Safe with NULL.
+ */
 void monty_bytes_free(uint8_t *ptr, size_t len);
 
+/**
+ * Free a byte buffer like monty_bytes_free(), from its pointer alone, e.g.
+ * as the finalizer of an external typed list viewing it. Buffers start on
+ * an 8-byte boundary. Safe with NULL.
+ */
+void monty_bytes_release(void *ptr);
+
 #ifdef __cplusplus
 }
 #endif
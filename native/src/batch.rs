@@ -0,0 +1,352 @@
+//! Running one compiled program over many input sets in parallel.
+//!
+//! `monty_run_batch` gives every input set its own handle instantiated
+//! from a shared [`MontyProgram`] and runs the handles to completion on a
+//! pool of scoped threads, so a host can saturate the machine without a
+//! thread or isolate of its own per job. Workers pull the next job from a
+//! shared counter, which keeps them busy when job costs vary.
+
+use std::ffi::c_void;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::mpsc;
+use std::sync::{Arc, Mutex};
+use std::thread;
+
+use monty::MontyObject;
+use serde_json::Value;
+
+use crate::binary;
+use crate::error::catch_ffi_panic;
+use crate::handle::{CompletedRun, MontyHandle, MontyResultTag};
+use crate::program::MontyProgram;
+use crate::tracker::MontyInterrupt;
+
+/// Signature of the callback passed to `monty_run_batch`.
+///
+/// `result` is `len` bytes holding one job's `(result_tag, envelope)`
+/// tuple in the binary value encoding, borrowed for the duration of the
+/// call. `index` is the job's position in the input list.
+pub type MontyBatchCallback =
+    unsafe extern "C" fn(user_data: *mut c_void, index: usize, result: *const u8, len: usize);
+
+/// An input set: a value for each of the program's input names.
+pub(crate) type Inputs = Vec<(String, MontyObject)>;
+
+/// Limits applied to every job, read from the same JSON object the Dart
+/// side passes around as `limitsJson`.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub(crate) struct BatchLimits {
+    memory_bytes: Option<usize>,
+    timeout_ms: Option<u64>,
+    stack_depth: Option<usize>,
+}
+
+impl BatchLimits {
+    /// Parse `{"memory_bytes": .., "timeout_ms": .., "stack_depth": ..}`;
+    /// every key is optional.
+    pub(crate) fn from_json(limits_json: &str) -> Result<Self, String> {
+        let limits: Value =
+            serde_json::from_str(limits_json).map_err(|e| format!("invalid limits JSON: {e}"))?;
+        let field = |name: &str| limits.get(name).and_then(Value::as_u64);
+        Ok(Self {
+            memory_bytes: field("memory_bytes").and_then(|n| usize::try_from(n).ok()),
+            timeout_ms: field("timeout_ms"),
+            stack_depth: field("stack_depth").and_then(|n| usize::try_from(n).ok()),
+        })
+    }
+
+    fn apply(self, handle: &mut MontyHandle) {
+        if let Some(bytes) = self.memory_bytes {
+            handle.set_memory_limit(bytes);
+        }
+        if let Some(ms) = self.timeout_ms {
+            handle.set_time_limit_ms(ms);
+        }
+        if let Some(depth) = self.stack_depth {
+            handle.set_stack_limit(depth);
+        }
+    }
+}
+
+/// A finished job, encoded by the thread that collects it.
+pub(crate) struct JobResult {
+    tag: MontyResultTag,
+    run: CompletedRun,
+}
+
+impl JobResult {
+    /// Append the job's `(result_tag, envelope)` tuple to `buf`.
+    ///
+    /// The envelope is written in place after the tuple header rather
+    /// than encoded separately and appended, so packed arrays in it stay
+    /// aligned to the start of `buf`.
+    pub(crate) fn write_bin(&self, buf: &mut Vec<u8>) {
+        buf.push(binary::TAG_TUPLE);
+        binary::write_len(buf, 2);
+        binary::write_int(buf, self.tag as i64);
+        self.run.write_bin(buf);
+    }
+
+    /// The job's `(result_tag, envelope)` tuple in a buffer of its own.
+    pub(crate) fn to_bin(&self) -> Vec<u8> {
+        let mut buf = Vec::new();
+        self.write_bin(&mut buf);
+        buf
+    }
+}
+
+/// Decode a binary-encoded `List` of `Dict`s keyed by input name.
+pub(crate) fn decode_input_sets(bytes: &[u8]) -> Result<Vec<Inputs>, String> {
+    let MontyObject::List(sets) = binary::decode_object(bytes)? else {
+        return Err("expected a list of input dicts".into());
+    };
+    sets.into_iter()
+        .enumerate()
+        .map(|(i, set)| match set {
+            MontyObject::Dict(pairs) => (&pairs)
+                .into_iter()
+                .map(|(k, v)| match k {
+                    MontyObject::String(name) => Ok((name.clone(), v.clone())),
+                    other => Err(format!("input set {i}: invalid name: {other}")),
+                })
+                .collect(),
+            _ => Err(format!("input set {i} is not a dict")),
+        })
+        .collect()
+}
+
+/// Run `program` once per entry of `inputs` on up to `threads` threads
+/// (0 for one per available core, and never more than that), passing
+/// each job's index and result to `on_result` on the calling thread as
+/// the job finishes.
+///
+/// Each result encodes as a binary `(result_tag, envelope)` tuple, where
+/// the envelope matches `monty_complete_result_bin`. A job that cannot start
+/// (e.g. a missing input) reports an error envelope like a failed run.
+/// Every job watches `interrupt`: setting it stops the running jobs with
+/// a `KeyboardInterrupt`, and jobs not yet started report an error
+/// without running.
+pub(crate) fn run_batch(
+    program: &MontyProgram,
+    inputs: Vec<Inputs>,
+    threads: usize,
+    limits: BatchLimits,
+    interrupt: Option<&Arc<MontyInterrupt>>,
+    mut on_result: impl FnMut(usize, JobResult),
+) {
+    let jobs: Vec<Mutex<Option<Inputs>>> =
+        inputs.into_iter().map(|i| Mutex::new(Some(i))).collect();
+    let next = AtomicUsize::new(0);
+    let (tx, rx) = mpsc::channel();
+    thread::scope(|scope| {
+        for _ in 0..worker_count(threads, jobs.len()) {
+            let tx = tx.clone();
+            let (jobs, next) = (&jobs, &next);
+            scope.spawn(move || {
+                loop {
+                    let index = next.fetch_add(1, Ordering::Relaxed);
+                    let Some(job) = jobs.get(index) else {
+                        break;
+                    };
+                    let inputs = job.lock().ok().and_then(|mut slot| slot.take());
+                    let result = run_one(program, inputs.unwrap_or_default(), limits, interrupt);
+                    if tx.send((index, result)).is_err() {
+                        break;
+                    }
+                }
+            });
+        }
+        drop(tx);
+        for (index, result) in rx {
+            on_result(index, result);
+        }
+    });
+}
+
+/// Threads to start for `jobs` jobs when `requested` were asked for.
+///
+/// More threads than cores only adds stacks and contention, so a request
+/// above the available parallelism is clamped to it.
+fn worker_count(requested: usize, jobs: usize) -> usize {
+    let cores = thread::available_parallelism().map_or(1, usize::from);
+    let threads = if requested == 0 {
+        cores
+    } else {
+        requested.min(cores)
+    };
+    threads.min(jobs)
+}
+
+fn run_one(
+    program: &MontyProgram,
+    inputs: Inputs,
+    limits: BatchLimits,
+    interrupt: Option<&Arc<MontyInterrupt>>,
+) -> JobResult {
+    let outcome = catch_ffi_panic(|| {
+        if interrupt.is_some_and(|i| i.is_set()) {
+            return Err("interrupted before the run started".to_string());
+        }
+        let mut handle = program.instantiate_with_inputs(inputs)?;
+        limits.apply(&mut handle);
+        handle.set_interrupt(interrupt.cloned());
+        let (tag, _) = handle.execute()?;
+        let run = handle.take_completed().ok_or("run did not complete")?;
+        Ok::<_, String>(JobResult { tag, run })
+    });
+    match outcome {
+        Ok(Ok(result)) => result,
+        Ok(Err(msg)) | Err(msg) => JobResult {
+            tag: MontyResultTag::Error,
+            run: CompletedRun::failed(&msg),
+        },
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn program() -> MontyProgram {
+        MontyProgram::compile_with_inputs("x * 2".into(), vec!["x".into()], vec![], None).unwrap()
+    }
+
+    fn run(inputs: Vec<Inputs>, threads: usize) -> Vec<(usize, MontyObject)> {
+        run_watching(inputs, threads, None)
+    }
+
+    fn run_watching(
+        inputs: Vec<Inputs>,
+        threads: usize,
+        interrupt: Option<&Arc<MontyInterrupt>>,
+    ) -> Vec<(usize, MontyObject)> {
+        let mut results = Vec::new();
+        run_batch(
+            &program(),
+            inputs,
+            threads,
+            BatchLimits::default(),
+            interrupt,
+            |i, result| {
+                results.push((i, binary::decode_object(&result.to_bin()).unwrap()));
+            },
+        );
+        results.sort_by_key(|(i, _)| *i);
+        results
+    }
+
+    fn value_of(result: &MontyObject) -> (i64, Option<&MontyObject>) {
+        let MontyObject::Tuple(items) = result else {
+            panic!("expected tuple, got {result:?}");
+        };
+        let MontyObject::Int(tag) = items[0] else {
+            panic!("expected tag");
+        };
+        let MontyObject::Dict(envelope) = &items[1] else {
+            panic!("expected envelope");
+        };
+        let value = envelope
+            .into_iter()
+            .find(|(k, _)| k == &MontyObject::String("value".into()))
+            .map(|(_, v)| v);
+        (tag, value)
+    }
+
+    #[test]
+    fn test_runs_every_job_once() {
+        let inputs: Vec<Inputs> = (0..50)
+            .map(|x| vec![("x".into(), MontyObject::Int(x))])
+            .collect();
+        let results = run(inputs, 4);
+        assert_eq!(results.len(), 50);
+        for (i, (index, result)) in results.iter().enumerate() {
+            assert_eq!(*index, i);
+            let expected = MontyObject::Int(i64::try_from(i).unwrap() * 2);
+            assert_eq!(value_of(result), (0, Some(&expected)));
+        }
+    }
+
+    #[test]
+    fn test_bad_inputs_report_an_error() {
+        let results = run(vec![vec![], vec![("x".into(), MontyObject::Int(1))]], 0);
+        assert_eq!(value_of(&results[0].1), (1, Some(&MontyObject::None)));
+        assert_eq!(value_of(&results[1].1), (0, Some(&MontyObject::Int(2))));
+    }
+
+    #[test]
+    fn test_set_interrupt_fails_every_job() {
+        let interrupt = Arc::new(MontyInterrupt::default());
+        interrupt.set();
+        let inputs: Vec<Inputs> = (0..4)
+            .map(|x| vec![("x".into(), MontyObject::Int(x))])
+            .collect();
+        let results = run_watching(inputs, 2, Some(&interrupt));
+        assert_eq!(results.len(), 4);
+        for (_, result) in &results {
+            assert_eq!(value_of(result), (1, Some(&MontyObject::None)));
+        }
+    }
+
+    #[test]
+    fn test_results_aligned_in_a_shared_buffer() {
+        let program =
+            MontyProgram::compile_with_inputs("[x] * 16".into(), vec!["x".into()], vec![], None)
+                .unwrap();
+        let result = run_one(
+            &program,
+            vec![("x".into(), MontyObject::Int(7))],
+            BatchLimits::default(),
+            None,
+        );
+        for prefix in 0..8 {
+            let mut buf = vec![binary::TAG_NONE; prefix];
+            result.write_bin(&mut buf);
+            let key = buf.windows(5).position(|w| w == b"value").unwrap();
+            let value = key + 5;
+            assert_eq!(buf[value], binary::TAG_INT_ARRAY, "prefix {prefix}");
+            let pad = usize::from(buf[value + 5]);
+            assert_eq!((value + 6 + pad) % 8, 0, "prefix {prefix}");
+        }
+    }
+
+    #[test]
+    fn test_worker_count_clamped_to_cores() {
+        let cores = thread::available_parallelism().map_or(1, usize::from);
+        assert_eq!(worker_count(0, usize::MAX), cores);
+        assert_eq!(worker_count(usize::MAX, usize::MAX), cores);
+        assert_eq!(worker_count(usize::MAX, 1), 1);
+    }
+
+    #[test]
+    fn test_empty_batch() {
+        assert!(run(vec![], 0).is_empty());
+    }
+
+    #[test]
+    fn test_limits_from_json() {
+        let limits = BatchLimits::from_json(r#"{"timeout_ms": 5, "stack_depth": 10}"#).unwrap();
+        assert_eq!(
+            limits,
+            BatchLimits {
+                memory_bytes: None,
+                timeout_ms: Some(5),
+                stack_depth: Some(10),
+            }
+        );
+        assert!(BatchLimits::from_json("[").is_err());
+    }
+
+    #[test]
+    fn test_decode_input_sets() {
+        let encoded = binary::encode_object(&MontyObject::List(vec![MontyObject::dict(vec![(
+            MontyObject::String("x".into()),
+            MontyObject::Int(1),
+        )])]));
+        assert_eq!(
+            decode_input_sets(&encoded).unwrap(),
+            vec![vec![("x".to_string(), MontyObject::Int(1))]]
+        );
+        let bad = binary::encode_object(&MontyObject::List(vec![MontyObject::Int(1)]));
+        assert!(decode_input_sets(&bad).unwrap_err().contains("not a dict"));
+    }
+}
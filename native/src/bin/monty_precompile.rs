@@ -0,0 +1,170 @@
+//! Precompile Python sources into snapshot container files at build time.
+//!
+//! ```text
+//! monty_precompile [--external NAME]... [--script-name NAME] <input.py> <output>
+//! ```
+//!
+//! The output is the `Ready`-state snapshot of a handle created from the
+//! source (the compiled program), wrapped in a snapshot container. Apps
+//! load it with `monty_restore` or `monty_restore_file` and run it without
+//! parsing or compiling on the device. `--external` declares an external
+//! function the code may call, and may be repeated; `--script-name` sets
+//! the filename used in tracebacks, defaulting to the input's file name.
+//!
+//! Snapshots are only portable between builds of the same native library,
+//! so precompile with the version the app ships.
+
+use std::path::{Path, PathBuf};
+use std::process::ExitCode;
+
+use dart_monty_native::MontyHandle;
+
+const USAGE: &str =
+    "usage: monty_precompile [--external NAME]... [--script-name NAME] <input.py> <output>";
+
+/// Parsed command line.
+#[derive(Debug, PartialEq, Eq)]
+struct Args {
+    input: PathBuf,
+    output: PathBuf,
+    external_functions: Vec<String>,
+    script_name: Option<String>,
+}
+
+impl Args {
+    fn parse(args: impl IntoIterator<Item = String>) -> Result<Self, String> {
+        let mut external_functions = Vec::new();
+        let mut script_name = None;
+        let mut paths = Vec::new();
+        let mut args = args.into_iter();
+        while let Some(arg) = args.next() {
+            match arg.as_str() {
+                "--external" => external_functions.push(value_of(&arg, args.next())?),
+                "--script-name" => script_name = Some(value_of(&arg, args.next())?),
+                flag if flag.starts_with("--") => return Err(format!("unknown option: {flag}")),
+                _ => paths.push(PathBuf::from(arg)),
+            }
+        }
+        let [input, output] = <[PathBuf; 2]>::try_from(paths)
+            .map_err(|paths| format!("expected 2 paths, got {}", paths.len()))?;
+        Ok(Self {
+            input,
+            output,
+            external_functions,
+            script_name,
+        })
+    }
+}
+
+fn value_of(flag: &str, value: Option<String>) -> Result<String, String> {
+    value.ok_or_else(|| format!("{flag} needs a value"))
+}
+
+/// Compile `args.input` and write its snapshot container to `args.output`.
+fn precompile(args: &Args) -> Result<(), String> {
+    let code = std::fs::read_to_string(&args.input)
+        .map_err(|e| format!("cannot read {}: {e}", args.input.display()))?;
+    let script_name = args.script_name.clone().or_else(|| file_name(&args.input));
+    let handle = MontyHandle::new(code, args.external_functions.clone(), script_name)
+        .map_err(|exc| exc.summary())?;
+    handle.snapshot_to_file(&args.output)
+}
+
+fn file_name(path: &Path) -> Option<String> {
+    path.file_name()
+        .map(|name| name.to_string_lossy().into_owned())
+}
+
+fn main() -> ExitCode {
+    let args = match Args::parse(std::env::args().skip(1)) {
+        Ok(args) => args,
+        Err(msg) => {
+            eprintln!("monty_precompile: {msg}\n{USAGE}");
+            return ExitCode::from(2);
+        }
+    };
+    match precompile(&args) {
+        Ok(()) => ExitCode::SUCCESS,
+        Err(msg) => {
+            eprintln!("monty_precompile: {}: {msg}", args.input.display());
+            ExitCode::FAILURE
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn parse(args: &[&str]) -> Result<Args, String> {
+        Args::parse(args.iter().map(|s| (*s).to_string()))
+    }
+
+    #[test]
+    fn test_parse_args() {
+        assert_eq!(
+            parse(&["--external", "fetch", "a.py", "--external", "log", "a.snap"]).unwrap(),
+            Args {
+                input: "a.py".into(),
+                output: "a.snap".into(),
+                external_functions: vec!["fetch".into(), "log".into()],
+                script_name: None,
+            }
+        );
+        assert!(parse(&["a.py"]).unwrap_err().contains("expected 2 paths"));
+        assert!(
+            parse(&["--script-name"])
+                .unwrap_err()
+                .contains("needs a value")
+        );
+        assert!(
+            parse(&["--fast", "a", "b"])
+                .unwrap_err()
+                .contains("unknown option")
+        );
+    }
+
+    #[test]
+    fn test_precompiled_snapshot_runs() {
+        let dir = std::env::temp_dir().join(format!("monty_precompile_{}", std::process::id()));
+        std::fs::create_dir_all(&dir).unwrap();
+        let input = dir.join("add.py");
+        std::fs::write(&input, "1 + 2").unwrap();
+        let args = Args {
+            input,
+            output: dir.join("add.snap"),
+            external_functions: vec![],
+            script_name: None,
+        };
+
+        precompile(&args).unwrap();
+        let mut handle = MontyHandle::restore_file(&args.output).unwrap();
+        let (_, result_json, error) = handle.run();
+        std::fs::remove_dir_all(&dir).unwrap();
+
+        assert_eq!(error, None);
+        let result: serde_json::Value = serde_json::from_str(&result_json).unwrap();
+        assert_eq!(result["value"], 3);
+    }
+
+    #[test]
+    fn test_compile_error_is_reported() {
+        let dir = std::env::temp_dir().join(format!("monty_precompile_err_{}", std::process::id()));
+        std::fs::create_dir_all(&dir).unwrap();
+        let input = dir.join("bad.py");
+        std::fs::write(&input, "def (").unwrap();
+        let args = Args {
+            input,
+            output: dir.join("bad.snap"),
+            external_functions: vec![],
+            script_name: None,
+        };
+
+        let result = precompile(&args);
+        let written = args.output.exists();
+        std::fs::remove_dir_all(&dir).unwrap();
+
+        assert!(result.is_err());
+        assert!(!written);
+    }
+}
@@ -0,0 +1,702 @@
+//! Compact binary encoding for values crossing the C boundary.
+//!
+//! Every value is a one-byte tag followed by a little-endian payload.
+//! Lengths and element counts are `u32`.
+//!
+//! | Tag    | Type      | Payload                                         |
+//! |--------|-----------|-------------------------------------------------|
+//! | `0x00` | None      | —                                               |
+//! | `0x01` | False     | —                                               |
+//! | `0x02` | True      | —                                               |
+//! | `0x03` | Int       | `i64`                                           |
+//! | `0x04` | BigInt    | sign `u8` (0 = +, 1 = −), `u32` len, magnitude  |
+//! | `0x05` | Float     | `f64`                                           |
+//! | `0x06` | String    | `u32` len, UTF-8 bytes                          |
+//! | `0x07` | Bytes     | `u32` len, raw bytes                            |
+//! | `0x08` | List      | `u32` count, values                             |
+//! | `0x09` | Tuple     | `u32` count, values                             |
+//! | `0x0A` | Dict      | `u32` count, key/value pairs                    |
+//! | `0x0B` | Set       | `u32` count, values                             |
+//! | `0x0C` | FrozenSet | `u32` count, values                             |
+//! | `0x0D` | Ellipsis  | —                                               |
+//! | `0x0E` | IntArray  | `u32` count, `u8` pad, pad bytes, `i64` × count |
+//! | `0x0F` | FloatArray| `u32` count, `u8` pad, pad bytes, `f64` × count |
+//!
+//! BigInt magnitudes are little-endian bytes. Values that fit in `i64` are
+//! always written as `Int`. Every non-empty `List` whose elements are all
+//! `Int` (or all `Float`) is written packed as an `IntArray`
+//! (`FloatArray`), whatever its length, and decodes back to a `List`. The
+//! pad puts the first element on an 8-byte boundary from the start of the
+//! buffer, so the host can view the elements in place as an `Int64List` /
+//! `Float64List`.
+//!
+//! Variants without a wire type degrade the same way
+//! `convert::monty_object_to_json` does (e.g. `NamedTuple` → `Tuple`,
+//! `Dataclass` → `Dict`, `Repr` → `String`).
+
+use monty::MontyObject;
+use num_bigint::{BigInt, Sign};
+use num_traits::ToPrimitive;
+use serde_json::Value;
+
+pub const TAG_NONE: u8 = 0x00;
+pub const TAG_FALSE: u8 = 0x01;
+pub const TAG_TRUE: u8 = 0x02;
+pub const TAG_INT: u8 = 0x03;
+pub const TAG_BIGINT: u8 = 0x04;
+pub const TAG_FLOAT: u8 = 0x05;
+pub const TAG_STRING: u8 = 0x06;
+pub const TAG_BYTES: u8 = 0x07;
+pub const TAG_LIST: u8 = 0x08;
+pub const TAG_TUPLE: u8 = 0x09;
+pub const TAG_DICT: u8 = 0x0A;
+pub const TAG_SET: u8 = 0x0B;
+pub const TAG_FROZENSET: u8 = 0x0C;
+pub const TAG_ELLIPSIS: u8 = 0x0D;
+pub const TAG_INT_ARRAY: u8 = 0x0E;
+pub const TAG_FLOAT_ARRAY: u8 = 0x0F;
+
+/// Encode a `MontyObject` into a fresh buffer.
+pub fn encode_object(obj: &MontyObject) -> Vec<u8> {
+    let mut buf = Vec::new();
+    write_object(&mut buf, obj);
+    buf
+}
+
+/// Append the encoding of `obj` to `buf`.
+pub fn write_object(buf: &mut Vec<u8>, obj: &MontyObject) {
+    match obj {
+        MontyObject::None => buf.push(TAG_NONE),
+        MontyObject::Bool(false) => buf.push(TAG_FALSE),
+        MontyObject::Bool(true) => buf.push(TAG_TRUE),
+        MontyObject::Int(n) => write_int(buf, *n),
+        MontyObject::BigInt(n) => write_bigint(buf, n),
+        MontyObject::Float(f) => write_float(buf, *f),
+        MontyObject::String(s) => write_str(buf, s),
+        MontyObject::Bytes(bytes) => {
+            buf.push(TAG_BYTES);
+            write_len(buf, bytes.len());
+            buf.extend_from_slice(bytes);
+        }
+        MontyObject::List(items) => {
+            if !write_packed(buf, items) {
+                write_seq(buf, TAG_LIST, items);
+            }
+        }
+        MontyObject::Tuple(items) => write_seq(buf, TAG_TUPLE, items),
+        MontyObject::NamedTuple { values, .. } => write_seq(buf, TAG_TUPLE, values),
+        MontyObject::Set(items) => write_seq(buf, TAG_SET, items),
+        MontyObject::FrozenSet(items) => write_seq(buf, TAG_FROZENSET, items),
+        MontyObject::Dict(pairs) | MontyObject::Dataclass { attrs: pairs, .. } => {
+            let items: Vec<&(MontyObject, MontyObject)> = pairs.into_iter().collect();
+            write_pairs(buf, items.into_iter().map(|(k, v)| (k, v)));
+        }
+        MontyObject::Ellipsis => buf.push(TAG_ELLIPSIS),
+        MontyObject::Path(p) => write_str(buf, p),
+        MontyObject::Type(t) => write_str(buf, &format!("{t}")),
+        MontyObject::BuiltinFunction(f) => write_str(buf, &format!("{f:?}")),
+        MontyObject::Exception { exc_type, arg } => {
+            let msg = match arg {
+                Some(a) => format!("{exc_type}: {a}"),
+                None => format!("{exc_type}"),
+            };
+            write_str(buf, &msg);
+        }
+        MontyObject::Repr(r) => write_str(buf, r),
+        MontyObject::Cycle(_, desc) => write_str(buf, desc),
+    }
+}
+
+/// Append a `(key, value)` sequence as a `Dict`.
+pub fn write_pairs<'a>(
+    buf: &mut Vec<u8>,
+    pairs: impl ExactSizeIterator<Item = (&'a MontyObject, &'a MontyObject)>,
+) {
+    buf.push(TAG_DICT);
+    write_len(buf, pairs.len());
+    for (k, v) in pairs {
+        write_object(buf, k);
+        write_object(buf, v);
+    }
+}
+
+/// Append the encoding of a JSON value (used for result envelopes).
+///
+/// Objects become `Dict`s with string keys, arrays become `List`s.
+pub fn write_json(buf: &mut Vec<u8>, val: &Value) {
+    match val {
+        Value::Null => buf.push(TAG_NONE),
+        Value::Bool(false) => buf.push(TAG_FALSE),
+        Value::Bool(true) => buf.push(TAG_TRUE),
+        Value::Number(n) => {
+            if let Some(i) = n.as_i64() {
+                write_int(buf, i);
+            } else if let Some(u) = n.as_u64() {
+                write_bigint(buf, &BigInt::from(u));
+            } else {
+                write_float(buf, n.as_f64().unwrap_or(f64::NAN));
+            }
+        }
+        Value::String(s) => write_str(buf, s),
+        Value::Array(items) => {
+            buf.push(TAG_LIST);
+            write_len(buf, items.len());
+            for item in items {
+                write_json(buf, item);
+            }
+        }
+        Value::Object(map) => {
+            buf.push(TAG_DICT);
+            write_len(buf, map.len());
+            for (k, v) in map {
+                write_str(buf, k);
+                write_json(buf, v);
+            }
+        }
+    }
+}
+
+/// Append a string value.
+pub fn write_str(buf: &mut Vec<u8>, s: &str) {
+    buf.push(TAG_STRING);
+    write_len(buf, s.len());
+    buf.extend_from_slice(s.as_bytes());
+}
+
+/// Append a list value.
+pub fn write_list(buf: &mut Vec<u8>, items: &[MontyObject]) {
+    write_seq(buf, TAG_LIST, items);
+}
+
+/// Append a boolean value.
+pub fn write_bool(buf: &mut Vec<u8>, b: bool) {
+    buf.push(if b { TAG_TRUE } else { TAG_FALSE });
+}
+
+/// Append an integer value.
+pub fn write_int(buf: &mut Vec<u8>, n: i64) {
+    buf.push(TAG_INT);
+    buf.extend_from_slice(&n.to_le_bytes());
+}
+
+/// Append a length or element count.
+///
+/// # Panics
+/// If `len` exceeds `u32::MAX` — no single value crossing the boundary is
+/// expected to be that large.
+pub fn write_len(buf: &mut Vec<u8>, len: usize) {
+    let len = u32::try_from(len).expect("binary value length exceeds u32::MAX");
+    buf.extend_from_slice(&len.to_le_bytes());
+}
+
+fn write_float(buf: &mut Vec<u8>, f: f64) {
+    buf.push(TAG_FLOAT);
+    buf.extend_from_slice(&f.to_le_bytes());
+}
+
+fn write_bigint(buf: &mut Vec<u8>, n: &BigInt) {
+    if let Some(i) = n.to_i64() {
+        write_int(buf, i);
+        return;
+    }
+    let (sign, magnitude) = n.to_bytes_le();
+    buf.push(TAG_BIGINT);
+    buf.push(u8::from(sign == Sign::Minus));
+    write_len(buf, magnitude.len());
+    buf.extend_from_slice(&magnitude);
+}
+
+/// Write `items` as an `IntArray` or `FloatArray` if they qualify,
+/// returning whether it did.
+fn write_packed(buf: &mut Vec<u8>, items: &[MontyObject]) -> bool {
+    let tag = match items.first() {
+        Some(MontyObject::Int(_)) => TAG_INT_ARRAY,
+        Some(MontyObject::Float(_)) => TAG_FLOAT_ARRAY,
+        _ => return false,
+    };
+    let homogeneous = items.iter().all(|item| match item {
+        MontyObject::Int(_) => tag == TAG_INT_ARRAY,
+        MontyObject::Float(_) => tag == TAG_FLOAT_ARRAY,
+        _ => false,
+    });
+    if !homogeneous {
+        return false;
+    }
+    buf.push(tag);
+    write_len(buf, items.len());
+    // The elements follow the pad-length byte and the pad.
+    let pad = (8 - (buf.len() + 1) % 8) % 8;
+    buf.push(pad as u8);
+    buf.resize(buf.len() + pad, 0);
+    buf.reserve(items.len() * 8);
+    for item in items {
+        match item {
+            MontyObject::Int(n) => buf.extend_from_slice(&n.to_le_bytes()),
+            MontyObject::Float(f) => buf.extend_from_slice(&f.to_le_bytes()),
+            _ => unreachable!("checked homogeneous above"),
+        }
+    }
+    true
+}
+
+fn write_seq(buf: &mut Vec<u8>, tag: u8, items: &[MontyObject]) {
+    buf.push(tag);
+    write_len(buf, items.len());
+    for item in items {
+        write_object(buf, item);
+    }
+}
+
+/// Decode a single value occupying all of `bytes`.
+pub fn decode_object(bytes: &[u8]) -> Result<MontyObject, String> {
+    let mut reader = Reader {
+        bytes,
+        pos: 0,
+        depth: 0,
+    };
+    let obj = reader.read_object()?;
+    if reader.pos != bytes.len() {
+        return Err(format!(
+            "trailing bytes after value: {} of {}",
+            reader.pos,
+            bytes.len()
+        ));
+    }
+    Ok(obj)
+}
+
+/// Decode a `Dict` whose keys are integer call IDs (for `resume_futures`).
+pub fn decode_call_id_map(bytes: &[u8]) -> Result<Vec<(u32, MontyObject)>, String> {
+    let pairs = match decode_object(bytes)? {
+        MontyObject::Dict(pairs) => pairs,
+        _ => return Err("expected a dict keyed by call_id".into()),
+    };
+    (&pairs)
+        .into_iter()
+        .map(|(k, v)| match k {
+            MontyObject::Int(id) => u32::try_from(*id)
+                .map(|id| (id, v.clone()))
+                .map_err(|_| format!("invalid call_id: {id}")),
+            other => Err(format!("invalid call_id: {other}")),
+        })
+        .collect()
+}
+
+/// Decode a `Dict` whose keys are strings, such as named inputs.
+pub fn decode_named_map(bytes: &[u8]) -> Result<Vec<(String, MontyObject)>, String> {
+    let pairs = match decode_object(bytes)? {
+        MontyObject::Dict(pairs) => pairs,
+        _ => return Err("expected a dict keyed by name".into()),
+    };
+    (&pairs)
+        .into_iter()
+        .map(|(k, v)| match k {
+            MontyObject::String(name) => Ok((name.clone(), v.clone())),
+            other => Err(format!("invalid name: {other}")),
+        })
+        .collect()
+}
+
+/// Most containers a decoded value may nest, the same limit `serde_json`
+/// puts on the JSON transport. Decoding recurses once per level, so a
+/// deeper value would overflow the stack instead of failing to decode.
+const MAX_DEPTH: usize = 128;
+
+struct Reader<'a> {
+    bytes: &'a [u8],
+    pos: usize,
+    /// Containers open around the value being read.
+    depth: usize,
+}
+
+impl<'a> Reader<'a> {
+    fn take(&mut self, n: usize) -> Result<&'a [u8], String> {
+        let end = self
+            .pos
+            .checked_add(n)
+            .filter(|&end| end <= self.bytes.len())
+            .ok_or_else(|| format!("unexpected end of input at byte {}", self.pos))?;
+        let slice = &self.bytes[self.pos..end];
+        self.pos = end;
+        Ok(slice)
+    }
+
+    fn read_u8(&mut self) -> Result<u8, String> {
+        Ok(self.take(1)?[0])
+    }
+
+    fn read_len(&mut self) -> Result<usize, String> {
+        let raw: [u8; 4] = self.take(4)?.try_into().unwrap();
+        Ok(u32::from_le_bytes(raw) as usize)
+    }
+
+    fn read_8(&mut self) -> Result<[u8; 8], String> {
+        Ok(self.take(8)?.try_into().unwrap())
+    }
+
+    /// Read an `IntArray` / `FloatArray` payload, building each element
+    /// from its eight bytes with `f`.
+    fn read_packed(&mut self, f: fn([u8; 8]) -> MontyObject) -> Result<Vec<MontyObject>, String> {
+        let count = self.read_len()?;
+        let pad = usize::from(self.read_u8()?);
+        self.take(pad)?;
+        let len = count
+            .checked_mul(8)
+            .ok_or_else(|| format!("packed array too long: {count}"))?;
+        Ok(self
+            .take(len)?
+            .chunks_exact(8)
+            .map(|chunk| f(chunk.try_into().unwrap()))
+            .collect())
+    }
+
+    /// Enter a container, failing if that nests deeper than [`MAX_DEPTH`].
+    /// The caller leaves it by decrementing `depth`.
+    fn enter(&mut self) -> Result<(), String> {
+        if self.depth == MAX_DEPTH {
+            return Err(format!(
+                "value nested deeper than {MAX_DEPTH} levels at byte {}",
+                self.pos
+            ));
+        }
+        self.depth += 1;
+        Ok(())
+    }
+
+    fn read_seq(&mut self) -> Result<Vec<MontyObject>, String> {
+        self.enter()?;
+        let count = self.read_len()?;
+        // Each element takes at least one byte; cap the reservation so a
+        // corrupt count cannot trigger a huge allocation.
+        let mut items = Vec::with_capacity(count.min(self.bytes.len() - self.pos));
+        for _ in 0..count {
+            items.push(self.read_object()?);
+        }
+        self.depth -= 1;
+        Ok(items)
+    }
+
+    fn read_object(&mut self) -> Result<MontyObject, String> {
+        let tag = self.read_u8()?;
+        Ok(match tag {
+            TAG_NONE => MontyObject::None,
+            TAG_FALSE => MontyObject::Bool(false),
+            TAG_TRUE => MontyObject::Bool(true),
+            TAG_INT => MontyObject::Int(i64::from_le_bytes(self.read_8()?)),
+            TAG_BIGINT => {
+                let negative = self.read_u8()? != 0;
+                let len = self.read_len()?;
+                let sign = if negative { Sign::Minus } else { Sign::Plus };
+                MontyObject::BigInt(BigInt::from_bytes_le(sign, self.take(len)?))
+            }
+            TAG_FLOAT => MontyObject::Float(f64::from_le_bytes(self.read_8()?)),
+            TAG_STRING => {
+                let len = self.read_len()?;
+                let raw = self.take(len)?;
+                let s = std::str::from_utf8(raw).map_err(|e| format!("invalid UTF-8: {e}"))?;
+                MontyObject::String(s.to_string())
+            }
+            TAG_BYTES => {
+                let len = self.read_len()?;
+                MontyObject::Bytes(self.take(len)?.to_vec())
+            }
+            TAG_LIST => MontyObject::List(self.read_seq()?),
+            TAG_TUPLE => MontyObject::Tuple(self.read_seq()?),
+            TAG_DICT => {
+                self.enter()?;
+                let count = self.read_len()?;
+                let mut pairs = Vec::with_capacity(count.min(self.bytes.len() - self.pos));
+                for _ in 0..count {
+                    let k = self.read_object()?;
+                    let v = self.read_object()?;
+                    pairs.push((k, v));
+                }
+                self.depth -= 1;
+                MontyObject::dict(pairs)
+            }
+            TAG_SET => MontyObject::Set(self.read_seq()?),
+            TAG_FROZENSET => MontyObject::FrozenSet(self.read_seq()?),
+            TAG_ELLIPSIS => MontyObject::Ellipsis,
+            TAG_INT_ARRAY => {
+                MontyObject::List(self.read_packed(|b| MontyObject::Int(i64::from_le_bytes(b)))?)
+            }
+            TAG_FLOAT_ARRAY => {
+                MontyObject::List(self.read_packed(|b| MontyObject::Float(f64::from_le_bytes(b)))?)
+            }
+            other => return Err(format!("unknown value tag 0x{other:02x}")),
+        })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use serde_json::json;
+
+    use super::*;
+
+    fn round_trip(obj: MontyObject) -> MontyObject {
+        decode_object(&encode_object(&obj)).unwrap()
+    }
+
+    #[test]
+    fn test_scalars_round_trip() {
+        for obj in [
+            MontyObject::None,
+            MontyObject::Bool(true),
+            MontyObject::Bool(false),
+            MontyObject::Int(-7),
+            MontyObject::Int(i64::MAX),
+            MontyObject::Float(3.5),
+            MontyObject::String("héllo".into()),
+            MontyObject::Ellipsis,
+        ] {
+            assert_eq!(round_trip(obj.clone()), obj);
+        }
+    }
+
+    #[test]
+    fn test_float_special_values_round_trip() {
+        match round_trip(MontyObject::Float(f64::NAN)) {
+            MontyObject::Float(f) => assert!(f.is_nan()),
+            other => panic!("expected Float, got {other:?}"),
+        }
+        assert_eq!(
+            round_trip(MontyObject::Float(f64::NEG_INFINITY)),
+            MontyObject::Float(f64::NEG_INFINITY)
+        );
+    }
+
+    #[test]
+    fn test_int_layout() {
+        assert_eq!(
+            encode_object(&MontyObject::Int(1)),
+            vec![TAG_INT, 1, 0, 0, 0, 0, 0, 0, 0]
+        );
+    }
+
+    #[test]
+    fn test_bigint_round_trip() {
+        let big = BigInt::parse_bytes(b"-99999999999999999999999", 10).unwrap();
+        assert_eq!(
+            round_trip(MontyObject::BigInt(big.clone())),
+            MontyObject::BigInt(big)
+        );
+    }
+
+    #[test]
+    fn test_small_bigint_written_as_int() {
+        let encoded = encode_object(&MontyObject::BigInt(BigInt::from(5)));
+        assert_eq!(encoded[0], TAG_INT);
+    }
+
+    #[test]
+    fn test_containers_round_trip() {
+        let obj = MontyObject::List(vec![
+            MontyObject::Tuple(vec![MontyObject::Int(1), MontyObject::Float(2.0)]),
+            MontyObject::Bytes(vec![0, 255]),
+            MontyObject::Set(vec![MontyObject::Int(3)]),
+            MontyObject::FrozenSet(vec![MontyObject::String("x".into())]),
+            MontyObject::dict(vec![
+                (MontyObject::String("a".into()), MontyObject::Int(1)),
+                (MontyObject::Int(2), MontyObject::None),
+            ]),
+        ]);
+        assert_eq!(round_trip(obj.clone()), obj);
+    }
+
+    #[test]
+    fn test_numeric_lists_packed() {
+        let ints = MontyObject::List((0..20).map(MontyObject::Int).collect());
+        let encoded = encode_object(&ints);
+        assert_eq!(encoded[0], TAG_INT_ARRAY);
+        // Tag, count, pad length, 2 pad bytes: elements start at offset 8.
+        assert_eq!(encoded[5], 2);
+        assert_eq!(encoded.len(), 8 + 20 * 8);
+        assert_eq!(round_trip(ints.clone()), ints);
+
+        let floats = MontyObject::List((0..16).map(|i| MontyObject::Float(f64::from(i))).collect());
+        assert_eq!(encode_object(&floats)[0], TAG_FLOAT_ARRAY);
+        assert_eq!(round_trip(floats.clone()), floats);
+    }
+
+    #[test]
+    fn test_packed_elements_aligned_to_buffer_start() {
+        let ints = MontyObject::List((0..16).map(MontyObject::Int).collect());
+        for prefix in 0..8 {
+            let mut buf = vec![TAG_NONE; prefix];
+            write_object(&mut buf, &ints);
+            let pad = usize::from(buf[prefix + 5]);
+            assert_eq!((prefix + 6 + pad) % 8, 0, "prefix {prefix}");
+        }
+    }
+
+    #[test]
+    fn test_numeric_lists_packed_at_any_length() {
+        for len in [1, 3, 16] {
+            let ints = MontyObject::List((0..len).map(MontyObject::Int).collect());
+            assert_eq!(encode_object(&ints)[0], TAG_INT_ARRAY, "len {len}");
+            assert_eq!(round_trip(ints.clone()), ints);
+        }
+        let single = MontyObject::List(vec![MontyObject::Float(0.5)]);
+        assert_eq!(encode_object(&single)[0], TAG_FLOAT_ARRAY);
+    }
+
+    #[test]
+    fn test_empty_or_mixed_lists_not_packed() {
+        let empty = MontyObject::List(vec![]);
+        assert_eq!(encode_object(&empty)[0], TAG_LIST);
+        assert_eq!(round_trip(empty.clone()), empty);
+
+        let mut mixed: Vec<MontyObject> = (0..20).map(MontyObject::Int).collect();
+        mixed.push(MontyObject::Float(0.5));
+        let mixed = MontyObject::List(mixed);
+        assert_eq!(encode_object(&mixed)[0], TAG_LIST);
+        assert_eq!(round_trip(mixed.clone()), mixed);
+
+        let tuple = MontyObject::Tuple((0..20).map(MontyObject::Int).collect());
+        assert_eq!(encode_object(&tuple)[0], TAG_TUPLE);
+    }
+
+    #[test]
+    fn test_decode_truncated_packed() {
+        let mut encoded =
+            encode_object(&MontyObject::List((0..16).map(MontyObject::Int).collect()));
+        encoded.pop();
+        assert!(
+            decode_object(&encoded)
+                .unwrap_err()
+                .contains("unexpected end")
+        );
+    }
+
+    #[test]
+    fn test_write_json_envelope() {
+        let mut buf = Vec::new();
+        write_json(
+            &mut buf,
+            &json!({"memory_bytes_used": 3, "ok": [true, null]}),
+        );
+        let decoded = decode_object(&buf).unwrap();
+        let expected = MontyObject::dict(vec![
+            (
+                MontyObject::String("memory_bytes_used".into()),
+                MontyObject::Int(3),
+            ),
+            (
+                MontyObject::String("ok".into()),
+                MontyObject::List(vec![MontyObject::Bool(true), MontyObject::None]),
+            ),
+        ]);
+        assert_eq!(decoded, expected);
+    }
+
+    #[test]
+    fn test_decode_truncated() {
+        let mut encoded = encode_object(&MontyObject::String("hello".into()));
+        encoded.pop();
+        assert!(
+            decode_object(&encoded)
+                .unwrap_err()
+                .contains("unexpected end")
+        );
+    }
+
+    #[test]
+    fn test_decode_depth_limit() {
+        fn nested(depth: usize) -> Vec<u8> {
+            let mut encoded = Vec::new();
+            for _ in 0..depth {
+                encoded.extend([TAG_LIST, 1, 0, 0, 0]);
+            }
+            encoded.push(TAG_NONE);
+            encoded
+        }
+        assert!(decode_object(&nested(MAX_DEPTH)).is_ok());
+        assert!(
+            decode_object(&nested(MAX_DEPTH + 1))
+                .unwrap_err()
+                .contains("nested deeper")
+        );
+        // Far past the limit: must fail, not overflow the stack.
+        let mut dicts = Vec::new();
+        for _ in 0..1_000_000 {
+            dicts.extend([TAG_DICT, 1, 0, 0, 0, TAG_NONE]);
+        }
+        assert!(decode_object(&dicts).is_err());
+    }
+
+    #[test]
+    fn test_decode_trailing_bytes() {
+        assert!(
+            decode_object(&[TAG_NONE, TAG_NONE])
+                .unwrap_err()
+                .contains("trailing bytes")
+        );
+    }
+
+    #[test]
+    fn test_decode_unknown_tag() {
+        assert!(
+            decode_object(&[0xFF])
+                .unwrap_err()
+                .contains("unknown value tag")
+        );
+    }
+
+    #[test]
+    fn test_decode_invalid_utf8() {
+        let bytes = [TAG_STRING, 1, 0, 0, 0, 0xFF];
+        assert!(decode_object(&bytes).unwrap_err().contains("invalid UTF-8"));
+    }
+
+    #[test]
+    fn test_decode_call_id_map() {
+        let obj = MontyObject::dict(vec![
+            (MontyObject::Int(0), MontyObject::String("a".into())),
+            (MontyObject::Int(4), MontyObject::Int(9)),
+        ]);
+        let map = decode_call_id_map(&encode_object(&obj)).unwrap();
+        assert_eq!(
+            map,
+            vec![
+                (0, MontyObject::String("a".into())),
+                (4, MontyObject::Int(9)),
+            ]
+        );
+    }
+
+    #[test]
+    fn test_decode_call_id_map_rejects_bad_keys() {
+        let obj = MontyObject::dict(vec![(MontyObject::String("0".into()), MontyObject::None)]);
+        assert!(
+            decode_call_id_map(&encode_object(&obj))
+                .unwrap_err()
+                .contains("invalid call_id")
+        );
+        let obj = MontyObject::dict(vec![(MontyObject::Int(-1), MontyObject::None)]);
+        assert!(decode_call_id_map(&encode_object(&obj)).is_err());
+        assert!(decode_call_id_map(&encode_object(&MontyObject::None)).is_err());
+    }
+
+    #[test]
+    fn test_decode_named_map() {
+        let obj = MontyObject::dict(vec![
+            (MontyObject::String("x".into()), MontyObject::Int(1)),
+            (MontyObject::String("y".into()), MontyObject::None),
+        ]);
+        let map = decode_named_map(&encode_object(&obj)).unwrap();
+        assert_eq!(
+            map,
+            vec![
+                ("x".into(), MontyObject::Int(1)),
+                ("y".into(), MontyObject::None),
+            ]
+        );
+        let obj = MontyObject::dict(vec![(MontyObject::Int(0), MontyObject::None)]);
+        assert!(
+            decode_named_map(&encode_object(&obj))
+                .unwrap_err()
+                .contains("invalid name")
+        );
+    }
+}
@@ -0,0 +1,564 @@
+//! Process-wide cache of compiled programs.
+//!
+//! [`MontyProgramCache`] maps (source, external functions, script name, input
+//! names) to a compiled [`MontyProgram`], so repeated requests for the same
+//! script skip parsing and compilation. It is bounded by an approximate
+//! byte budget and evicts least recently used programs first. A cache is
+//! `Sync`: one instance can serve every handle and thread in the process.
+//!
+//! A cache opened with [`MontyProgramCache::open`] is also backed by a
+//! directory. Every program it compiles is written there as a snapshot
+//! container (see [`crate::snapshot_file`]) named after a hash of its key
+//! and the monty revision this crate was built against. A lookup that
+//! misses in memory reads only the file its key names, so opening a large
+//! directory costs nothing up front and a fresh process still skips the
+//! compile of every program stored there. Entries written by a different
+//! monty revision are never read.
+
+use std::collections::HashMap;
+use std::path::{Path, PathBuf};
+use std::sync::{Arc, Mutex};
+
+use monty::MontyObject;
+use serde::{Deserialize, Serialize};
+
+use crate::handle::MontyHandle;
+use crate::program::MontyProgram;
+use crate::snapshot_file::{self, MappedFile};
+
+/// The monty git revision pinned in `Cargo.toml`, set by `build.rs`.
+const MONTY_REV: &str = env!("DART_MONTY_MONTY_REV");
+
+/// Extension of program files in a cache directory.
+const DISK_EXTENSION: &str = "mpc";
+
+/// Counters filled in by `monty_cache_stats` — matches `MontyCacheStats` in
+/// the C header.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct MontyCacheStats {
+    pub hits: u64,
+    pub misses: u64,
+    pub entries: usize,
+    pub bytes: usize,
+    pub capacity_bytes: usize,
+    /// Programs read from the cache directory instead of compiled.
+    pub disk_loads: u64,
+    /// Programs written to the cache directory.
+    pub disk_writes: u64,
+}
+
+#[derive(Clone, PartialEq, Eq, Hash)]
+struct CacheKey {
+    source_hash: u64,
+    external_functions: Vec<String>,
+    script_name: Option<String>,
+    input_names: Vec<String>,
+}
+
+impl CacheKey {
+    /// Stable hash of the key and [`MONTY_REV`], used as the file name.
+    fn disk_hash(&self) -> u64 {
+        let mut hash = Fnv::new();
+        hash.write_str(MONTY_REV);
+        hash.write(&self.source_hash.to_le_bytes());
+        hash.write_strs(&self.external_functions);
+        hash.write_str(self.script_name.as_deref().unwrap_or(""));
+        hash.write(&[u8::from(self.script_name.is_some())]);
+        hash.write_strs(&self.input_names);
+        hash.finish()
+    }
+}
+
+struct CacheEntry {
+    /// Full source, compared on lookup so a hash collision is a miss.
+    source: Box<str>,
+    program: Arc<MontyProgram>,
+    bytes: usize,
+    last_used: u64,
+}
+
+/// Payload of a program file in a cache directory. Carries the whole key
+/// so a file is only used for exactly the program it was written for.
+#[derive(Serialize, Deserialize)]
+struct DiskEntry {
+    monty_rev: String,
+    source: String,
+    external_functions: Vec<String>,
+    script_name: Option<String>,
+    input_names: Vec<String>,
+    program: Vec<u8>,
+}
+
+#[derive(Default)]
+struct CacheInner {
+    entries: HashMap<CacheKey, CacheEntry>,
+    bytes: usize,
+    clock: u64,
+    hits: u64,
+    misses: u64,
+    disk_loads: u64,
+    disk_writes: u64,
+}
+
+/// LRU cache of compiled programs bounded by `capacity_bytes`.
+pub struct MontyProgramCache {
+    capacity_bytes: usize,
+    dir: Option<PathBuf>,
+    inner: Mutex<CacheInner>,
+}
+
+impl MontyProgramCache {
+    /// Create an empty cache holding at most `capacity_bytes` of programs.
+    /// A capacity of 0 disables caching; every lookup is a miss.
+    pub fn new(capacity_bytes: usize) -> Self {
+        Self {
+            capacity_bytes,
+            dir: None,
+            inner: Mutex::default(),
+        }
+    }
+
+    /// Create a cache backed by the directory `dir`, creating it if needed.
+    ///
+    /// Nothing is read on open: a program stored in `dir` is loaded the
+    /// first time it is looked up and missing from memory. Unreadable,
+    /// corrupt, or foreign files in `dir` are treated as misses.
+    pub fn open(capacity_bytes: usize, dir: &Path) -> Result<Self, String> {
+        std::fs::create_dir_all(dir).map_err(|e| format!("cache open failed: {e}"))?;
+        Ok(Self {
+            capacity_bytes,
+            dir: Some(dir.to_path_buf()),
+            inner: Mutex::default(),
+        })
+    }
+
+    /// Create a handle for `code`, compiling it only if no matching program
+    /// is cached in memory or on disk.
+    ///
+    /// `inputs` are bound as for [`MontyHandle::with_inputs`]; their names,
+    /// not their values, are part of the cache key.
+    pub fn create(
+        &self,
+        code: String,
+        inputs: Vec<(String, MontyObject)>,
+        external_functions: Vec<String>,
+        script_name: Option<String>,
+    ) -> Result<MontyHandle, String> {
+        let mut input_names: Vec<String> = inputs.iter().map(|(n, _)| n.clone()).collect();
+        input_names.sort_unstable();
+        let key = CacheKey {
+            source_hash: hash_source(&code),
+            external_functions,
+            script_name,
+            input_names,
+        };
+
+        let program = match self.lookup(&key, &code) {
+            Some(program) => program,
+            // Load and compile outside the lock so other threads are not
+            // held up; a concurrent miss for the same key does the work twice.
+            None => match self.load_from_disk(&key, &code) {
+                Some(loaded) => {
+                    let program = Arc::new(loaded.program);
+                    self.lock().disk_loads += 1;
+                    self.insert(key, code, Arc::clone(&program), loaded.program_bytes);
+                    program
+                }
+                None => {
+                    let program = MontyProgram::compile_with_inputs(
+                        code.clone(),
+                        key.input_names.clone(),
+                        key.external_functions.clone(),
+                        key.script_name.clone(),
+                    )
+                    .map_err(|e| e.summary())?;
+                    let dumped = program.dump().unwrap_or_default();
+                    if !dumped.is_empty() {
+                        self.store_to_disk(&key, &code, &dumped);
+                    }
+                    let program = Arc::new(program);
+                    self.insert(key, code, Arc::clone(&program), dumped.len());
+                    program
+                }
+            },
+        };
+        program.instantiate_with_inputs(inputs)
+    }
+
+    /// Current counters.
+    pub fn stats(&self) -> MontyCacheStats {
+        let inner = self.lock();
+        MontyCacheStats {
+            hits: inner.hits,
+            misses: inner.misses,
+            entries: inner.entries.len(),
+            bytes: inner.bytes,
+            capacity_bytes: self.capacity_bytes,
+            disk_loads: inner.disk_loads,
+            disk_writes: inner.disk_writes,
+        }
+    }
+
+    /// Drop every program cached in memory. Counters and the cache
+    /// directory are kept.
+    pub fn clear(&self) {
+        let mut inner = self.lock();
+        inner.entries.clear();
+        inner.bytes = 0;
+    }
+
+    fn lookup(&self, key: &CacheKey, code: &str) -> Option<Arc<MontyProgram>> {
+        let mut guard = self.lock();
+        let inner = &mut *guard;
+        inner.clock += 1;
+        let now = inner.clock;
+        match inner.entries.get_mut(key) {
+            Some(entry) if &*entry.source == code => {
+                entry.last_used = now;
+                let program = Arc::clone(&entry.program);
+                inner.hits += 1;
+                Some(program)
+            }
+            _ => {
+                inner.misses += 1;
+                None
+            }
+        }
+    }
+
+    /// Insert `program`, whose serialized form is `program_bytes` long,
+    /// evicting least recently used entries to make room. Returns `false`
+    /// if it is larger than the whole capacity.
+    fn insert(
+        &self,
+        key: CacheKey,
+        source: String,
+        program: Arc<MontyProgram>,
+        program_bytes: usize,
+    ) -> bool {
+        let bytes = source.len() + program_bytes;
+        if bytes > self.capacity_bytes {
+            return false;
+        }
+        let mut inner = self.lock();
+        if let Some(old) = inner.entries.remove(&key) {
+            inner.bytes -= old.bytes;
+        }
+        while inner.bytes + bytes > self.capacity_bytes {
+            let Some(oldest) = inner
+                .entries
+                .iter()
+                .min_by_key(|(_, e)| e.last_used)
+                .map(|(k, _)| k.clone())
+            else {
+                break;
+            };
+            if let Some(evicted) = inner.entries.remove(&oldest) {
+                inner.bytes -= evicted.bytes;
+            }
+        }
+        inner.clock += 1;
+        let last_used = inner.clock;
+        inner.bytes += bytes;
+        inner.entries.insert(
+            key,
+            CacheEntry {
+                source: source.into_boxed_str(),
+                program,
+                bytes,
+                last_used,
+            },
+        );
+        true
+    }
+
+    fn disk_path(&self, key: &CacheKey) -> Option<PathBuf> {
+        let dir = self.dir.as_ref()?;
+        Some(dir.join(format!("{}.{DISK_EXTENSION}", disk_file_stem(key))))
+    }
+
+    fn load_from_disk(&self, key: &CacheKey, code: &str) -> Option<DiskProgram> {
+        let loaded = read_disk_entry(&self.disk_path(key)?)?;
+        (loaded.key == *key && loaded.source == code).then_some(loaded)
+    }
+
+    /// Write the serialized program `dumped` to the cache directory, if
+    /// any. Best effort: a directory that cannot be written to only costs a
+    /// recompile in the next process.
+    fn store_to_disk(&self, key: &CacheKey, code: &str, dumped: &[u8]) {
+        let Some(path) = self.disk_path(key) else {
+            return;
+        };
+        let entry = DiskEntry {
+            monty_rev: MONTY_REV.to_string(),
+            source: code.to_string(),
+            external_functions: key.external_functions.clone(),
+            script_name: key.script_name.clone(),
+            input_names: key.input_names.clone(),
+            program: dumped.to_vec(),
+        };
+        let Ok(payload) = postcard::to_allocvec(&entry) else {
+            return;
+        };
+        if snapshot_file::write(&path, &payload).is_ok() {
+            self.lock().disk_writes += 1;
+        }
+    }
+
+    fn lock(&self) -> std::sync::MutexGuard<'_, CacheInner> {
+        // A panic while holding the lock cannot leave the map inconsistent
+        // in a way that matters for a cache, so recover from poisoning.
+        self.inner.lock().unwrap_or_else(|e| e.into_inner())
+    }
+}
+
+/// A program read back from a cache directory.
+struct DiskProgram {
+    key: CacheKey,
+    source: String,
+    program: MontyProgram,
+    /// Length of the serialized program.
+    program_bytes: usize,
+}
+
+/// Read and validate a program file. `None` for anything unreadable or
+/// written by another monty revision.
+fn read_disk_entry(path: &Path) -> Option<DiskProgram> {
+    let file = MappedFile::open(path).ok()?;
+    let payload = snapshot_file::decode(file.bytes()).ok()?;
+    let entry: DiskEntry = postcard::from_bytes(payload).ok()?;
+    if entry.monty_rev != MONTY_REV {
+        return None;
+    }
+    let program = MontyProgram::load(&entry.program, entry.input_names.clone()).ok()?;
+    let key = CacheKey {
+        source_hash: hash_source(&entry.source),
+        external_functions: entry.external_functions,
+        script_name: entry.script_name,
+        input_names: entry.input_names,
+    };
+    Some(DiskProgram {
+        key,
+        source: entry.source,
+        program,
+        program_bytes: entry.program.len(),
+    })
+}
+
+fn disk_file_stem(key: &CacheKey) -> String {
+    format!("{:016x}", key.disk_hash())
+}
+
+/// Hash of a program's source. Stable across processes and builds, since
+/// it also names files in a cache directory.
+fn hash_source(code: &str) -> u64 {
+    let mut hash = Fnv::new();
+    hash.write(code.as_bytes());
+    hash.finish()
+}
+
+/// 64-bit FNV-1a. `std`'s `DefaultHasher` is not guaranteed to be stable
+/// between Rust releases, which would orphan every file on disk.
+struct Fnv(u64);
+
+impl Fnv {
+    fn new() -> Self {
+        Self(0xcbf2_9ce4_8422_2325)
+    }
+
+    fn write(&mut self, bytes: &[u8]) {
+        for &b in bytes {
+            self.0 = (self.0 ^ u64::from(b)).wrapping_mul(0x0000_0100_0000_01b3);
+        }
+    }
+
+    /// Length-prefixed, so adjacent strings cannot run together.
+    fn write_str(&mut self, s: &str) {
+        self.write(&(s.len() as u64).to_le_bytes());
+        self.write(s.as_bytes());
+    }
+
+    fn write_strs(&mut self, strs: &[String]) {
+        self.write(&(strs.len() as u64).to_le_bytes());
+        for s in strs {
+            self.write_str(s);
+        }
+    }
+
+    fn finish(&self) -> u64 {
+        self.0
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use serde_json::Value;
+
+    use super::*;
+    use crate::handle::MontyResultTag;
+
+    fn run_value(mut handle: MontyHandle) -> Value {
+        let (tag, result_json, _) = handle.run();
+        assert_eq!(tag, MontyResultTag::Ok);
+        serde_json::from_str::<Value>(&result_json).unwrap()["value"].clone()
+    }
+
+    fn temp_dir(name: &str) -> PathBuf {
+        let dir =
+            std::env::temp_dir().join(format!("dart_monty_cache_{name}_{}", std::process::id()));
+        let _ = std::fs::remove_dir_all(&dir);
+        dir
+    }
+
+    #[test]
+    fn test_hit_after_miss() {
+        let cache = MontyProgramCache::new(1 << 20);
+        for _ in 0..3 {
+            let handle = cache.create("2 + 2".into(), vec![], vec![], None).unwrap();
+            assert_eq!(run_value(handle), 4);
+        }
+        let stats = cache.stats();
+        assert_eq!((stats.hits, stats.misses, stats.entries), (2, 1, 1));
+        assert!(stats.bytes > 0);
+    }
+
+    #[test]
+    fn test_key_includes_script_name_and_ext_fns() {
+        let cache = MontyProgramCache::new(1 << 20);
+        cache.create("1".into(), vec![], vec![], None).unwrap();
+        cache
+            .create("1".into(), vec![], vec![], Some("a.py".into()))
+            .unwrap();
+        cache
+            .create("1".into(), vec![], vec!["f".into()], None)
+            .unwrap();
+        assert_eq!(cache.stats().misses, 3);
+        assert_eq!(cache.stats().entries, 3);
+    }
+
+    #[test]
+    fn test_inputs_share_one_program() {
+        let cache = MontyProgramCache::new(1 << 20);
+        for x in [1, 2, 3] {
+            let inputs = vec![
+                ("y".into(), MontyObject::Int(10)),
+                ("x".into(), MontyObject::Int(x)),
+            ];
+            let handle = cache.create("x + y".into(), inputs, vec![], None).unwrap();
+            assert_eq!(run_value(handle), 10 + x);
+        }
+        assert_eq!(cache.stats().misses, 1);
+    }
+
+    #[test]
+    fn test_evicts_least_recently_used() {
+        let one = MontyProgramCache::new(usize::MAX);
+        one.create("1".into(), vec![], vec![], None).unwrap();
+        // Room for two programs of this size, not three.
+        let cache = MontyProgramCache::new(one.stats().bytes * 2 + 1);
+
+        cache.create("1".into(), vec![], vec![], None).unwrap();
+        cache.create("2".into(), vec![], vec![], None).unwrap();
+        cache.create("1".into(), vec![], vec![], None).unwrap();
+        cache.create("3".into(), vec![], vec![], None).unwrap();
+        assert_eq!(cache.stats().entries, 2);
+
+        // "2" was least recently used and evicted; "1" survived.
+        let before = cache.stats().hits;
+        cache.create("1".into(), vec![], vec![], None).unwrap();
+        assert_eq!(cache.stats().hits, before + 1);
+        cache.create("2".into(), vec![], vec![], None).unwrap();
+        assert_eq!(cache.stats().hits, before + 1);
+    }
+
+    #[test]
+    fn test_zero_capacity_disables_caching() {
+        let cache = MontyProgramCache::new(0);
+        cache.create("1".into(), vec![], vec![], None).unwrap();
+        cache.create("1".into(), vec![], vec![], None).unwrap();
+        let stats = cache.stats();
+        assert_eq!((stats.hits, stats.misses, stats.entries), (0, 2, 0));
+    }
+
+    #[test]
+    fn test_compile_error_is_not_cached() {
+        let cache = MontyProgramCache::new(1 << 20);
+        assert!(cache.create("def".into(), vec![], vec![], None).is_err());
+        assert_eq!(cache.stats().entries, 0);
+        cache.clear();
+    }
+
+    #[test]
+    fn test_disk_cache_survives_reopen() {
+        let dir = temp_dir("reopen");
+        let first = MontyProgramCache::open(1 << 20, &dir).unwrap();
+        let inputs = vec![("x".into(), MontyObject::Int(1))];
+        first.create("x * 3".into(), inputs, vec![], None).unwrap();
+        assert_eq!(first.stats().disk_writes, 1);
+        drop(first);
+
+        // A new cache (as in a new process) reads nothing on open, then
+        // loads the program from the directory instead of compiling it.
+        let second = MontyProgramCache::open(1 << 20, &dir).unwrap();
+        assert_eq!(second.stats().disk_loads, 0);
+        assert_eq!(second.stats().entries, 0);
+        let inputs = vec![("x".into(), MontyObject::Int(5))];
+        let handle = second.create("x * 3".into(), inputs, vec![], None).unwrap();
+        assert_eq!(run_value(handle), 15);
+        let stats = second.stats();
+        assert_eq!(
+            (stats.misses, stats.disk_loads, stats.disk_writes),
+            (1, 1, 0)
+        );
+        assert_eq!(stats.entries, 1);
+
+        std::fs::remove_dir_all(&dir).unwrap();
+    }
+
+    #[test]
+    fn test_disk_cache_loads_on_memory_miss() {
+        let dir = temp_dir("lazy");
+        let cache = MontyProgramCache::open(1 << 20, &dir).unwrap();
+        cache.create("7".into(), vec![], vec![], None).unwrap();
+        cache.clear();
+
+        let handle = cache.create("7".into(), vec![], vec![], None).unwrap();
+        assert_eq!(run_value(handle), 7);
+        let stats = cache.stats();
+        assert_eq!(
+            (stats.misses, stats.disk_loads, stats.disk_writes),
+            (2, 1, 1)
+        );
+
+        std::fs::remove_dir_all(&dir).unwrap();
+    }
+
+    #[test]
+    fn test_disk_cache_skips_foreign_files() {
+        let dir = temp_dir("foreign");
+        let first = MontyProgramCache::open(1 << 20, &dir).unwrap();
+        first.create("1 + 1".into(), vec![], vec![], None).unwrap();
+        drop(first);
+        // Clobber the stored program where the next lookup will read it.
+        for entry in std::fs::read_dir(&dir).unwrap() {
+            std::fs::write(entry.unwrap().path(), b"not a container").unwrap();
+        }
+        std::fs::write(dir.join("notes.txt"), b"hello").unwrap();
+
+        let cache = MontyProgramCache::open(1 << 20, &dir).unwrap();
+        let handle = cache.create("1 + 1".into(), vec![], vec![], None).unwrap();
+        assert_eq!(run_value(handle), 2);
+        let stats = cache.stats();
+        assert_eq!((stats.disk_loads, stats.disk_writes), (0, 1));
+
+        std::fs::remove_dir_all(&dir).unwrap();
+    }
+
+    #[test]
+    fn test_source_hash_is_stable() {
+        // Pinned: changing the hash would orphan existing cache directories.
+        assert_eq!(hash_source(""), 0xcbf2_9ce4_8422_2325);
+        assert_eq!(hash_source("a"), 0xaf63_dc4c_8601_ec8c);
+    }
+}
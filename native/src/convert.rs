@@ -21,7 +21,7 @@ pub fn monty_object_to_json(obj: &MontyObject) -> Value {
     match obj {
         MontyObject::None => Value::Null,
         MontyObject::Bool(b) => Value::Bool(*b),
-        MontyObject::Int(n) => json!(n),
+        MontyObject::Int(n) => Value::Number((*n).into()),
         MontyObject::BigInt(n) => bigint_to_json(n),
         MontyObject::Float(f) => float_to_json(*f),
         MontyObject::String(s) => Value::String(s.clone()),
@@ -33,7 +33,9 @@ pub fn monty_object_to_json(obj: &MontyObject) -> Value {
             Value::Array(items.iter().map(monty_object_to_json).collect())
         }
         MontyObject::Ellipsis => Value::String("...".into()),
-        MontyObject::Bytes(bytes) => Value::Array(bytes.iter().map(|b| json!(*b)).collect()),
+        MontyObject::Bytes(bytes) => {
+            Value::Array(bytes.iter().map(|&b| Value::Number(b.into())).collect())
+        }
         MontyObject::NamedTuple { values, .. } => {
             Value::Array(values.iter().map(monty_object_to_json).collect())
         }
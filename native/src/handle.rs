@@ -1,13 +1,32 @@
-use std::time::Duration;
+use std::cell::OnceCell;
+use std::ffi::c_void;
+use std::path::Path;
+use std::sync::Arc;
+use std::time::{Duration, Instant};
 
 use monty::{
-    ExternalResult, FutureSnapshot, LimitedTracker, MontyException, MontyRun, NoLimitTracker,
-    PrintWriter, ResourceLimits, RunProgress, Snapshot,
+    ExternalResult, FutureSnapshot, LimitedTracker, MontyException, MontyObject, MontyRun,
+    NoLimitTracker, PrintWriter, ResourceLimits, RunProgress, Snapshot,
 };
-use serde_json::Value;
+use serde::{Deserialize, Serialize};
+use serde_json::{Value, json};
 
+use crate::binary;
 use crate::convert::{json_to_monty_object, monty_object_to_json};
 use crate::error::monty_exception_to_json;
+use crate::lookup;
+use crate::native_fn::{MontyNativeFn, NativeFns};
+use crate::output::OutputStream;
+use crate::snapshot_file;
+use crate::trace::{Trace, TraceKind};
+use crate::tracker::{
+    self, HeapStats, Meter, MeteredTracker, MontyInterrupt, MontyUsage, ResourceUsage,
+};
+
+/// Tracker used when resource limits are set.
+type Limited = MeteredTracker<LimitedTracker>;
+/// Tracker used when no resource limits are set.
+type Unlimited = MeteredTracker<NoLimitTracker>;
 
 /// Maps a `ResourceTracker` type to its `HandleState` variants.
 trait TrackerExt: monty::ResourceTracker + Sized {
@@ -15,7 +34,7 @@ trait TrackerExt: monty::ResourceTracker + Sized {
     fn into_futures(snapshot: FutureSnapshot<Self>, call_ids_json: String) -> HandleState;
 }
 
-impl TrackerExt for LimitedTracker {
+impl TrackerExt for Limited {
     fn into_paused(snapshot: Snapshot<Self>, meta: PendingMeta) -> HandleState {
         HandleState::PausedLimited { snapshot, meta }
     }
@@ -27,7 +46,7 @@ impl TrackerExt for LimitedTracker {
     }
 }
 
-impl TrackerExt for NoLimitTracker {
+impl TrackerExt for Unlimited {
     fn into_paused(snapshot: Snapshot<Self>, meta: PendingMeta) -> HandleState {
         HandleState::PausedNoLimit { snapshot, meta }
     }
@@ -59,46 +78,195 @@ pub enum MontyProgressTag {
 }
 
 /// Metadata captured when paused at a `FunctionCall`.
+///
+/// Arguments are kept as `MontyObject`s; the JSON forms are built on first
+/// access so binary callers never pay for them.
+#[derive(Serialize, Deserialize)]
 struct PendingMeta {
     fn_name: String,
-    args_json: String,
-    kwargs_json: String,
+    args: Vec<MontyObject>,
+    kwargs: Vec<(MontyObject, MontyObject)>,
     call_id: u32,
     method_call: bool,
+    #[serde(skip)]
+    args_json: OnceCell<String>,
+    #[serde(skip)]
+    kwargs_json: OnceCell<String>,
+}
+
+/// Final value (or error) of a completed execution.
+///
+/// The JSON result envelope is built on first access.
+struct CompleteResult {
+    value: MontyObject,
+    error: Option<Value>,
+    is_error: bool,
+    result_json: OnceCell<String>,
+}
+
+/// A completed run taken out of its handle, so the result envelope can
+/// be written into a buffer owned elsewhere.
+pub(crate) struct CompletedRun {
+    value: MontyObject,
+    error: Option<Value>,
+    usage: ResourceUsage,
+    print_output: String,
+}
+
+impl CompletedRun {
+    /// A run that failed before it could start, with `message` as its
+    /// error and no usage.
+    pub(crate) fn failed(message: &str) -> Self {
+        Self {
+            value: MontyObject::None,
+            error: Some(json!({ "message": message })),
+            usage: ResourceUsage::default(),
+            print_output: String::new(),
+        }
+    }
+
+    /// Append the envelope [`MontyHandle::complete_result_bin`] returns,
+    /// written in place so packed arrays stay aligned to the start of
+    /// `buf`.
+    pub(crate) fn write_bin(&self, buf: &mut Vec<u8>) {
+        write_result_bin(
+            buf,
+            &self.value,
+            self.error.as_ref(),
+            self.usage,
+            &self.print_output,
+        );
+    }
 }
 
 /// Internal state of a running handle.
 enum HandleState {
     Ready(MontyRun),
     PausedLimited {
-        snapshot: Snapshot<LimitedTracker>,
+        snapshot: Snapshot<Limited>,
         meta: PendingMeta,
     },
     PausedNoLimit {
-        snapshot: Snapshot<NoLimitTracker>,
+        snapshot: Snapshot<Unlimited>,
         meta: PendingMeta,
     },
     FuturesLimited {
-        snapshot: FutureSnapshot<LimitedTracker>,
+        snapshot: FutureSnapshot<Limited>,
         call_ids_json: String,
     },
     FuturesNoLimit {
-        snapshot: FutureSnapshot<NoLimitTracker>,
+        snapshot: FutureSnapshot<Unlimited>,
         call_ids_json: String,
     },
-    Complete {
-        result_json: String,
-        is_error: bool,
-    },
+    Complete(CompleteResult),
     Consumed,
 }
 
+/// Prefix of an in-flight snapshot. Ready-state snapshots are a bare
+/// `MontyRun::dump` with no prefix, as before.
+const SNAPSHOT_MAGIC: &[u8; 4] = b"MSNP";
+/// Version byte following [`SNAPSHOT_MAGIC`].
+const SNAPSHOT_VERSION: u8 = 1;
+
+/// Borrowed form of a paused or futures `HandleState`, for serializing.
+///
+/// Variant and field order must match [`SavedState`].
+#[derive(Serialize)]
+enum SavedStateRef<'a> {
+    PausedLimited {
+        snapshot: &'a Snapshot<Limited>,
+        meta: &'a PendingMeta,
+    },
+    PausedNoLimit {
+        snapshot: &'a Snapshot<Unlimited>,
+        meta: &'a PendingMeta,
+    },
+    FuturesLimited {
+        snapshot: &'a FutureSnapshot<Limited>,
+        call_ids_json: &'a str,
+    },
+    FuturesNoLimit {
+        snapshot: &'a FutureSnapshot<Unlimited>,
+        call_ids_json: &'a str,
+    },
+}
+
+/// Owned form of [`SavedStateRef`], for deserializing.
+#[derive(Deserialize)]
+enum SavedState {
+    PausedLimited {
+        snapshot: Snapshot<Limited>,
+        meta: PendingMeta,
+    },
+    PausedNoLimit {
+        snapshot: Snapshot<Unlimited>,
+        meta: PendingMeta,
+    },
+    FuturesLimited {
+        snapshot: FutureSnapshot<Limited>,
+        call_ids_json: String,
+    },
+    FuturesNoLimit {
+        snapshot: FutureSnapshot<Unlimited>,
+        call_ids_json: String,
+    },
+}
+
+impl From<SavedState> for HandleState {
+    fn from(saved: SavedState) -> Self {
+        match saved {
+            SavedState::PausedLimited { snapshot, meta } => Self::PausedLimited { snapshot, meta },
+            SavedState::PausedNoLimit { snapshot, meta } => Self::PausedNoLimit { snapshot, meta },
+            SavedState::FuturesLimited {
+                snapshot,
+                call_ids_json,
+            } => Self::FuturesLimited {
+                snapshot,
+                call_ids_json,
+            },
+            SavedState::FuturesNoLimit {
+                snapshot,
+                call_ids_json,
+            } => Self::FuturesNoLimit {
+                snapshot,
+                call_ids_json,
+            },
+        }
+    }
+}
+
+/// Body of an in-flight snapshot, after the magic and version bytes.
+#[derive(Serialize)]
+struct SavedHandleRef<'a> {
+    state: SavedStateRef<'a>,
+    print_output: &'a str,
+}
+
+/// Owned form of [`SavedHandleRef`].
+#[derive(Deserialize)]
+struct SavedHandle {
+    state: SavedState,
+    print_output: String,
+}
+
 /// Opaque handle exposed to C callers.
 pub struct MontyHandle {
     state: HandleState,
     limits: Option<ResourceLimits>,
-    usage_json: String,
+    meter: Arc<Meter>,
+    /// Interrupt the meter watches, kept alive here.
+    interrupt: Option<Arc<MontyInterrupt>>,
     print_output: String,
+    natives: NativeFns,
+    stream: Option<OutputStream>,
+    /// Values for the program's declared inputs, in declaration order.
+    /// Consumed by the first `run`/`start`.
+    inputs: Vec<MontyObject>,
+    /// When the handle was created or last reset; the trace's origin.
+    created: Instant,
+    /// Time spent compiling, if this handle compiled its own program.
+    compile_time: Duration,
+    trace: Option<Trace>,
 }
 
 impl MontyHandle {
@@ -111,67 +279,165 @@ impl MontyHandle {
         external_functions: Vec<String>,
         script_name: Option<String>,
     ) -> Result<Self, MontyException> {
-        let name = script_name.unwrap_or_else(|| "<input>".into());
-        let compiled = MontyRun::new(code, &name, vec![], external_functions)?;
-        Ok(Self {
+        let started = Instant::now();
+        let compiled = compile(code, vec![], external_functions, script_name)?;
+        Ok(Self::from_compiled(compiled).compiled_since(started))
+    }
+
+    /// Create a new handle whose code reads the named `inputs` as global
+    /// variables.
+    ///
+    /// Other arguments match [`Self::new`].
+    pub fn with_inputs(
+        code: String,
+        inputs: Vec<(String, MontyObject)>,
+        external_functions: Vec<String>,
+        script_name: Option<String>,
+    ) -> Result<Self, MontyException> {
+        let (names, values) = inputs.into_iter().unzip();
+        let started = Instant::now();
+        let compiled = compile(code, names, external_functions, script_name)?;
+        let mut handle = Self::from_compiled(compiled).compiled_since(started);
+        handle.inputs = values;
+        Ok(handle)
+    }
+
+    /// Wrap an already-compiled program in a fresh `Ready` handle.
+    ///
+    /// A program compiled with inputs also needs [`Self::set_inputs`].
+    pub(crate) fn from_compiled(compiled: MontyRun) -> Self {
+        Self {
             state: HandleState::Ready(compiled),
             limits: None,
-            usage_json: default_usage_json(),
+            meter: Arc::default(),
+            interrupt: None,
             print_output: String::new(),
-        })
+            natives: NativeFns::default(),
+            stream: None,
+            inputs: Vec::new(),
+            created: Instant::now(),
+            compile_time: Duration::ZERO,
+            trace: None,
+        }
+    }
+
+    /// Record that the program was compiled here, starting at `started`.
+    fn compiled_since(mut self, started: Instant) -> Self {
+        self.created = started;
+        self.compile_time = started.elapsed();
+        self
+    }
+
+    /// Return the handle to `Ready` with a newly compiled program, keeping
+    /// its allocations — the print output buffer and input storage — for
+    /// the next run.
+    ///
+    /// Whatever the handle was doing is dropped. Limits, native functions,
+    /// the output stream, buffered print output, tracing and resource usage
+    /// are cleared, so it behaves exactly like a handle from
+    /// [`Self::with_inputs`] with the same arguments, except that an
+    /// interrupt set with [`Self::set_interrupt`] is kept. On a compile
+    /// error the handle is left untouched.
+    pub fn reset(
+        &mut self,
+        code: String,
+        inputs: Vec<(String, MontyObject)>,
+        external_functions: Vec<String>,
+        script_name: Option<String>,
+    ) -> Result<(), MontyException> {
+        let names = inputs.iter().map(|(n, _)| n.clone()).collect();
+        let started = Instant::now();
+        let compiled = compile(code, names, external_functions, script_name)?;
+        let mut values = std::mem::take(&mut self.inputs);
+        values.clear();
+        values.extend(inputs.into_iter().map(|(_, v)| v));
+        self.reuse(compiled, values);
+        self.created = started;
+        self.compile_time = started.elapsed();
+        Ok(())
+    }
+
+    /// Install `compiled` as in [`Self::reset`], with input values already
+    /// in declaration order.
+    pub(crate) fn reuse(&mut self, compiled: MontyRun, inputs: Vec<MontyObject>) {
+        // Drop the old state first: a paused VM's tracker shares the meter.
+        self.state = HandleState::Ready(compiled);
+        match Arc::get_mut(&mut self.meter) {
+            Some(meter) => *meter = Meter::default(),
+            None => self.meter = Arc::default(),
+        }
+        self.meter.watch(self.interrupt.as_ref());
+        self.limits = None;
+        self.print_output.clear();
+        self.natives.clear();
+        self.stream = None;
+        self.inputs = inputs;
+        self.created = Instant::now();
+        self.compile_time = Duration::ZERO;
+        self.trace = None;
     }
 
     /// Run code to completion. Returns `(result_tag, result_json, error_msg)`.
     pub fn run(&mut self) -> (MontyResultTag, String, Option<String>) {
+        match self.execute() {
+            Ok((tag, err)) => {
+                let result_json = self.complete_result_json().unwrap_or_default().to_string();
+                (tag, result_json, err)
+            }
+            Err(msg) => (MontyResultTag::Error, String::new(), Some(msg)),
+        }
+    }
+
+    /// Run code to completion without building the result JSON.
+    ///
+    /// Returns `(result_tag, error_msg)`; the result is then available via
+    /// [`Self::complete_result_json`] or [`Self::complete_result_bin`].
+    /// `Err` means the handle was not in Ready state.
+    pub fn execute(&mut self) -> Result<(MontyResultTag, Option<String>), String> {
         let state = std::mem::replace(&mut self.state, HandleState::Consumed);
         let compiled = match state {
             HandleState::Ready(c) => c,
             _ => {
                 self.state = state;
-                return (
-                    MontyResultTag::Error,
-                    String::new(),
-                    Some("handle not in Ready state".into()),
-                );
+                return Err("handle not in Ready state".into());
             }
         };
 
-        let mut print = PrintWriter::Collect(String::new());
-
-        let result = if let Some(limits) = self.limits.clone() {
-            let tracker = LimitedTracker::new(limits);
-            compiled.run(vec![], tracker, &mut print)
-        } else {
-            compiled.run(vec![], NoLimitTracker, &mut print)
-        };
-
-        self.drain_print(print);
+        let meter = Arc::clone(&self.meter);
+        let inputs = std::mem::take(&mut self.inputs);
+        let started = self.trace_start();
+        let result = self.with_print(|this, print| {
+            let natives = &this.natives;
+            meter.time(|| {
+                if let Some(limits) = this.limits.clone() {
+                    let tracker = this.tracker(LimitedTracker::new(limits));
+                    if natives.is_empty() {
+                        compiled.run(inputs, tracker, print)
+                    } else {
+                        let progress = compiled.start(inputs, tracker, print);
+                        complete_with_natives(natives, progress, print)
+                    }
+                } else if natives.is_empty() {
+                    compiled.run(inputs, this.tracker(NoLimitTracker), print)
+                } else {
+                    let progress = compiled.start(inputs, this.tracker(NoLimitTracker), print);
+                    complete_with_natives(natives, progress, print)
+                }
+            })
+        });
+        self.trace_end(TraceKind::Vm, "run", started, 0);
 
         match result {
             Ok(obj) => {
-                let val = monty_object_to_json(&obj);
-                let result_json =
-                    build_result_json(val, None, &self.usage_json, &self.print_output);
-                self.state = HandleState::Complete {
-                    result_json: result_json.clone(),
-                    is_error: false,
-                };
-                (MontyResultTag::Ok, result_json, None)
+                self.state = HandleState::Complete(CompleteResult::ok(obj));
+                Ok((MontyResultTag::Ok, None))
             }
             Err(exc) => {
-                let err_json = monty_exception_to_json(&exc);
-                let result_json = build_result_json(
-                    Value::Null,
-                    Some(err_json),
-                    &self.usage_json,
-                    &self.print_output,
-                );
+                let exc = self.interrupted_or(exc);
                 let msg = exc.summary();
-                self.state = HandleState::Complete {
-                    result_json: result_json.clone(),
-                    is_error: true,
-                };
-                (MontyResultTag::Error, result_json, Some(msg))
+                self.state =
+                    HandleState::Complete(CompleteResult::error(monty_exception_to_json(&exc)));
+                Ok((MontyResultTag::Error, Some(msg)))
             }
         }
     }
@@ -190,33 +456,51 @@ impl MontyHandle {
             }
         };
 
+        let inputs = std::mem::take(&mut self.inputs);
         if let Some(limits) = self.limits.clone() {
-            let tracker = LimitedTracker::new(limits);
-            self.run_snapshot_op(|print| compiled.start(vec![], tracker, print))
+            let tracker = self.tracker(LimitedTracker::new(limits));
+            self.run_snapshot_op("start", |print| compiled.start(inputs, tracker, print))
         } else {
-            self.run_snapshot_op(|print| compiled.start(vec![], NoLimitTracker, print))
+            let tracker = self.tracker(NoLimitTracker);
+            self.run_snapshot_op("start", |print| compiled.start(inputs, tracker, print))
         }
     }
 
     /// Resume with a return value (JSON string).
     pub fn resume(&mut self, value_json: &str) -> (MontyProgressTag, Option<String>) {
+        self.trace_resumed("resume");
+        let started = self.trace_start();
         let val: Value = match serde_json::from_str(value_json) {
             Ok(v) => v,
             Err(e) => return (MontyProgressTag::Error, Some(format!("invalid JSON: {e}"))),
         };
         let obj = json_to_monty_object(&val);
+        self.trace_end(TraceKind::Convert, "value_json", started, value_json.len());
         let result = ExternalResult::Return(obj);
-        self.resume_with_result(result)
+        self.resume_with_result("resume", result)
+    }
+
+    /// Resume with a return value in the binary value encoding.
+    pub fn resume_bin(&mut self, value: &[u8]) -> (MontyProgressTag, Option<String>) {
+        self.trace_resumed("resume");
+        let started = self.trace_start();
+        let obj = match binary::decode_object(value) {
+            Ok(obj) => obj,
+            Err(e) => return (MontyProgressTag::Error, Some(format!("invalid value: {e}"))),
+        };
+        self.trace_end(TraceKind::Convert, "value_bin", started, value.len());
+        self.resume_with_result("resume", ExternalResult::Return(obj))
     }
 
     /// Resume with an error message.
     pub fn resume_with_error(&mut self, error_message: &str) -> (MontyProgressTag, Option<String>) {
+        self.trace_resumed("resume_with_error");
         let exc = MontyException::new(
             monty::ExcType::RuntimeError,
             Some(error_message.to_string()),
         );
         let result = ExternalResult::Error(exc);
-        self.resume_with_result(result)
+        self.resume_with_result("resume_with_error", result)
     }
 
     /// Resume by creating a future (tells the VM this call returns a future).
@@ -224,14 +508,15 @@ impl MontyHandle {
     /// The VM continues executing until all coroutines are blocked, then
     /// yields `ResolveFutures`. Only valid in Paused state.
     pub fn resume_as_future(&mut self) -> (MontyProgressTag, Option<String>) {
+        self.trace_resumed("resume_as_future");
         let state = std::mem::replace(&mut self.state, HandleState::Consumed);
 
         match state {
             HandleState::PausedLimited { snapshot, .. } => {
-                self.run_snapshot_op(|print| snapshot.run_pending(print))
+                self.run_snapshot_op("resume_as_future", |print| snapshot.run_pending(print))
             }
             HandleState::PausedNoLimit { snapshot, .. } => {
-                self.run_snapshot_op(|print| snapshot.run_pending(print))
+                self.run_snapshot_op("resume_as_future", |print| snapshot.run_pending(print))
             }
             other => {
                 self.state = other;
@@ -264,6 +549,8 @@ impl MontyHandle {
         results_json: &str,
         errors_json: &str,
     ) -> (MontyProgressTag, Option<String>) {
+        self.trace_resumed("resume_futures");
+        let started = self.trace_start();
         let results_map: serde_json::Map<String, Value> = match serde_json::from_str(results_json) {
             Ok(v) => v,
             Err(e) => {
@@ -310,47 +597,79 @@ impl MontyHandle {
                 }
             };
             let msg = val.as_str().unwrap_or("unknown error").to_string();
-            let exc = MontyException::new(monty::ExcType::RuntimeError, Some(msg));
-            ext_results.push((call_id, ExternalResult::Error(exc)));
+            ext_results.push((call_id, future_error(msg)));
         }
+        let bytes = results_json.len() + errors_json.len();
+        self.trace_end(TraceKind::Convert, "futures_json", started, bytes);
 
-        let state = std::mem::replace(&mut self.state, HandleState::Consumed);
+        self.resume_futures_with(ext_results)
+    }
 
-        match state {
-            HandleState::FuturesLimited { snapshot, .. } => {
-                self.run_snapshot_op(|print| snapshot.resume(ext_results, print))
-            }
-            HandleState::FuturesNoLimit { snapshot, .. } => {
-                self.run_snapshot_op(|print| snapshot.resume(ext_results, print))
-            }
-            other => {
-                self.state = other;
-                (
+    /// Resume futures with results and errors in the binary value encoding.
+    ///
+    /// - `results`: dict mapping integer call IDs to return values
+    /// - `errors`: dict mapping integer call IDs to error message strings,
+    ///   or empty for no errors
+    pub fn resume_futures_bin(
+        &mut self,
+        results: &[u8],
+        errors: &[u8],
+    ) -> (MontyProgressTag, Option<String>) {
+        self.trace_resumed("resume_futures");
+        let started = self.trace_start();
+        let mut ext_results: Vec<(u32, ExternalResult)> = match binary::decode_call_id_map(results)
+        {
+            Ok(pairs) => pairs
+                .into_iter()
+                .map(|(id, obj)| (id, ExternalResult::Return(obj)))
+                .collect(),
+            Err(e) => {
+                return (
                     MontyProgressTag::Error,
-                    Some("handle not in Futures state".into()),
-                )
+                    Some(format!("invalid results: {e}")),
+                );
+            }
+        };
+
+        if !errors.is_empty() {
+            match binary::decode_call_id_map(errors) {
+                Ok(pairs) => {
+                    for (id, obj) in pairs {
+                        let msg = match obj {
+                            MontyObject::String(s) => s,
+                            _ => "unknown error".into(),
+                        };
+                        ext_results.push((id, future_error(msg)));
+                    }
+                }
+                Err(e) => {
+                    return (
+                        MontyProgressTag::Error,
+                        Some(format!("invalid errors: {e}")),
+                    );
+                }
             }
         }
+        let bytes = results.len() + errors.len();
+        self.trace_end(TraceKind::Convert, "futures_bin", started, bytes);
+
+        self.resume_futures_with(ext_results)
     }
 
     /// Get the pending function name (only valid in Paused state).
     pub fn pending_fn_name(&self) -> Option<&str> {
-        match &self.state {
-            HandleState::PausedLimited { meta, .. } | HandleState::PausedNoLimit { meta, .. } => {
-                Some(meta.fn_name.as_str())
-            }
-            _ => None,
-        }
+        self.pending_meta().map(|meta| meta.fn_name.as_str())
     }
 
     /// Get the pending function args as JSON (only valid in Paused state).
     pub fn pending_fn_args_json(&self) -> Option<&str> {
-        match &self.state {
-            HandleState::PausedLimited { meta, .. } | HandleState::PausedNoLimit { meta, .. } => {
-                Some(meta.args_json.as_str())
-            }
-            _ => None,
-        }
+        let meta = self.pending_meta()?;
+        let started = self
+            .trace_start()
+            .filter(|_| meta.args_json.get().is_none());
+        let json = meta.args_json();
+        self.trace_end(TraceKind::Convert, "args_json", started, json.len());
+        Some(json)
     }
 
     /// Get the pending function kwargs as JSON (only valid in Paused state).
@@ -358,12 +677,37 @@ impl MontyHandle {
     /// Returns a JSON object string like `{"key": value}`, or `"{}"` if no
     /// keyword arguments were passed.
     pub fn pending_fn_kwargs_json(&self) -> Option<&str> {
-        match &self.state {
-            HandleState::PausedLimited { meta, .. } | HandleState::PausedNoLimit { meta, .. } => {
-                Some(meta.kwargs_json.as_str())
-            }
-            _ => None,
-        }
+        let meta = self.pending_meta()?;
+        let started = self
+            .trace_start()
+            .filter(|_| meta.kwargs_json.get().is_none());
+        let json = meta.kwargs_json();
+        self.trace_end(TraceKind::Convert, "kwargs_json", started, json.len());
+        Some(json)
+    }
+
+    /// Get the pending function args as a binary-encoded list (only valid
+    /// in Paused state).
+    pub fn pending_fn_args_bin(&self) -> Option<Vec<u8>> {
+        self.pending_meta().map(|meta| {
+            let started = self.trace_start();
+            let mut buf = Vec::new();
+            binary::write_list(&mut buf, &meta.args);
+            self.trace_end(TraceKind::Convert, "args_bin", started, buf.len());
+            buf
+        })
+    }
+
+    /// Get the pending function kwargs as a binary-encoded dict (only valid
+    /// in Paused state). Empty kwargs encode as an empty dict.
+    pub fn pending_fn_kwargs_bin(&self) -> Option<Vec<u8>> {
+        self.pending_meta().map(|meta| {
+            let started = self.trace_start();
+            let mut buf = Vec::new();
+            binary::write_pairs(&mut buf, meta.kwargs.iter().map(|(k, v)| (k, v)));
+            self.trace_end(TraceKind::Convert, "kwargs_bin", started, buf.len());
+            buf
+        })
     }
 
     /// Get the pending call ID (only valid in Paused state).
@@ -371,30 +715,84 @@ impl MontyHandle {
     /// The call ID is a monotonically increasing integer assigned by the VM
     /// to each external function call. Used for correlating async futures.
     pub fn pending_call_id(&self) -> Option<u32> {
-        match &self.state {
-            HandleState::PausedLimited { meta, .. } | HandleState::PausedNoLimit { meta, .. } => {
-                Some(meta.call_id)
-            }
-            _ => None,
-        }
+        self.pending_meta().map(|meta| meta.call_id)
     }
 
     /// Whether the pending call is a method call (only valid in Paused state).
     ///
     /// `true` when Python used `obj.method()` syntax, `false` for `func()`.
     pub fn pending_method_call(&self) -> Option<bool> {
+        self.pending_meta().map(|meta| meta.method_call)
+    }
+
+    /// Get the complete result as JSON (only valid in Complete state).
+    pub fn complete_result_json(&self) -> Option<&str> {
         match &self.state {
-            HandleState::PausedLimited { meta, .. } | HandleState::PausedNoLimit { meta, .. } => {
-                Some(meta.method_call)
+            HandleState::Complete(done) => Some(
+                done.result_json
+                    .get_or_init(|| {
+                        let started = self.trace_start();
+                        let json = build_result_json(
+                            monty_object_to_json(&done.value),
+                            done.error.clone(),
+                            self.meter.usage(),
+                            &self.print_output,
+                        );
+                        self.trace_end(TraceKind::Convert, "result_json", started, json.len());
+                        json
+                    })
+                    .as_str(),
+            ),
+            _ => None,
+        }
+    }
+
+    /// Get the complete result in the binary value encoding (only valid in
+    /// Complete state).
+    ///
+    /// The envelope is a dict with the same keys as the JSON result:
+    /// `value`, `usage`, and optionally `error` and `print_output`.
+    pub fn complete_result_bin(&self) -> Option<Vec<u8>> {
+        match &self.state {
+            HandleState::Complete(done) => {
+                let started = self.trace_start();
+                let mut buf = Vec::new();
+                write_result_bin(
+                    &mut buf,
+                    &done.value,
+                    done.error.as_ref(),
+                    self.meter.usage(),
+                    &self.print_output,
+                );
+                self.trace_end(TraceKind::Convert, "result_bin", started, buf.len());
+                Some(buf)
             }
             _ => None,
         }
     }
 
-    /// Get the complete result as JSON (only valid in Complete state).
-    pub fn complete_result_json(&self) -> Option<&str> {
+    /// Move the completed run out of the handle, leaving it consumed (only
+    /// valid in Complete state).
+    pub(crate) fn take_completed(&mut self) -> Option<CompletedRun> {
+        match std::mem::replace(&mut self.state, HandleState::Consumed) {
+            HandleState::Complete(done) => Some(CompletedRun {
+                value: done.value,
+                error: done.error,
+                usage: self.meter.usage(),
+                print_output: std::mem::take(&mut self.print_output),
+            }),
+            other => {
+                self.state = other;
+                None
+            }
+        }
+    }
+
+    /// The completed value itself, for reading parts of it without
+    /// serializing the whole result (only valid in Complete state).
+    pub fn complete_value(&self) -> Option<&MontyObject> {
         match &self.state {
-            HandleState::Complete { result_json, .. } => Some(result_json.as_str()),
+            HandleState::Complete(done) => Some(&done.value),
             _ => None,
         }
     }
@@ -402,32 +800,232 @@ impl MontyHandle {
     /// Whether the complete result is an error.
     pub fn complete_is_error(&self) -> Option<bool> {
         match &self.state {
-            HandleState::Complete { is_error, .. } => Some(*is_error),
+            HandleState::Complete(done) => Some(done.is_error),
             _ => None,
         }
     }
 
-    /// Serialize the compiled code to bytes (snapshot).
+    /// Describe a progress step in one buffer, so callers need a single
+    /// crossing per external call instead of one per accessor.
+    ///
+    /// The descriptor is a binary-encoded tuple whose first element is the
+    /// `tag` value:
+    ///
+    /// - `Pending`: `(1, fn_name, args, kwargs, call_id, method_call)`
+    /// - `Complete` / `Error`: `(tag, result)`, where `result` is the
+    ///   `complete_result_bin` envelope
+    /// - `ResolveFutures`: `(3, call_ids)`
+    ///
+    /// If the state does not match `tag` (e.g. an `Error` returned for a
+    /// call made in the wrong state), the payload is `(tag, None)`.
+    pub fn progress_bin(&self, tag: MontyProgressTag) -> Vec<u8> {
+        let started = self.trace_start();
+        let mut buf = Vec::new();
+        buf.push(binary::TAG_TUPLE);
+        match (tag, &self.state) {
+            (
+                MontyProgressTag::Pending,
+                HandleState::PausedLimited { meta, .. } | HandleState::PausedNoLimit { meta, .. },
+            ) => {
+                binary::write_len(&mut buf, 6);
+                binary::write_int(&mut buf, tag as i64);
+                binary::write_str(&mut buf, &meta.fn_name);
+                binary::write_list(&mut buf, &meta.args);
+                binary::write_pairs(&mut buf, meta.kwargs.iter().map(|(k, v)| (k, v)));
+                binary::write_int(&mut buf, meta.call_id.into());
+                binary::write_bool(&mut buf, meta.method_call);
+            }
+            (
+                MontyProgressTag::ResolveFutures,
+                HandleState::FuturesLimited { call_ids_json, .. }
+                | HandleState::FuturesNoLimit { call_ids_json, .. },
+            ) => {
+                binary::write_len(&mut buf, 2);
+                binary::write_int(&mut buf, tag as i64);
+                let call_ids = serde_json::from_str(call_ids_json).unwrap_or(Value::Array(vec![]));
+                binary::write_json(&mut buf, &call_ids);
+            }
+            (MontyProgressTag::Complete | MontyProgressTag::Error, HandleState::Complete(done)) => {
+                binary::write_len(&mut buf, 2);
+                binary::write_int(&mut buf, tag as i64);
+                // Written in place rather than appended, so packed arrays in
+                // the value stay aligned to the start of `buf`.
+                write_result_bin(
+                    &mut buf,
+                    &done.value,
+                    done.error.as_ref(),
+                    self.meter.usage(),
+                    &self.print_output,
+                );
+            }
+            _ => {
+                binary::write_len(&mut buf, 2);
+                binary::write_int(&mut buf, tag as i64);
+                buf.push(binary::TAG_NONE);
+            }
+        }
+        self.trace_end(TraceKind::Convert, "progress_bin", started, buf.len());
+        buf
+    }
+
+    /// Serialize the handle to bytes (snapshot).
+    ///
+    /// In `Ready` state this is the compiled code. While paused at an
+    /// external call or waiting on futures it is the whole in-flight
+    /// execution — VM state, tracker and usage so far, pending call
+    /// metadata, and captured print output — so it can be resumed later,
+    /// in another process if need be.
     pub fn snapshot(&self) -> Result<Vec<u8>, String> {
-        match &self.state {
+        let state = match &self.state {
             HandleState::Ready(compiled) => {
-                compiled.dump().map_err(|e| format!("snapshot failed: {e}"))
+                return compiled.dump().map_err(|e| format!("snapshot failed: {e}"));
             }
-            _ => Err("can only snapshot in Ready state".into()),
-        }
+            HandleState::PausedLimited { snapshot, meta } => {
+                SavedStateRef::PausedLimited { snapshot, meta }
+            }
+            HandleState::PausedNoLimit { snapshot, meta } => {
+                SavedStateRef::PausedNoLimit { snapshot, meta }
+            }
+            HandleState::FuturesLimited {
+                snapshot,
+                call_ids_json,
+            } => SavedStateRef::FuturesLimited {
+                snapshot,
+                call_ids_json,
+            },
+            HandleState::FuturesNoLimit {
+                snapshot,
+                call_ids_json,
+            } => SavedStateRef::FuturesNoLimit {
+                snapshot,
+                call_ids_json,
+            },
+            HandleState::Complete(_) | HandleState::Consumed => {
+                return Err("cannot snapshot a completed execution".into());
+            }
+        };
+        let saved = SavedHandleRef {
+            state,
+            print_output: &self.print_output,
+        };
+        let mut bytes = SNAPSHOT_MAGIC.to_vec();
+        bytes.push(SNAPSHOT_VERSION);
+        postcard::to_extend(&saved, bytes).map_err(|e| format!("snapshot failed: {e}"))
     }
 
     /// Restore a handle from serialized bytes.
+    ///
+    /// Accepts both Ready-state snapshots (compiled code) and in-flight
+    /// snapshots; the latter restore paused, ready for `resume` or
+    /// `resume_futures`. Either may be wrapped in a snapshot container
+    /// (see [`snapshot_file`]), which is validated and then read in place.
+    /// Bytes with the in-flight header that fail to deserialize are
+    /// reported as corrupt rather than retried as compiled code.
     pub fn restore(bytes: &[u8]) -> Result<Self, String> {
+        let bytes = if snapshot_file::is_container(bytes) {
+            snapshot_file::decode(bytes)?
+        } else {
+            bytes
+        };
+        if let Some(body) = bytes.strip_prefix(SNAPSHOT_MAGIC) {
+            match body.split_first() {
+                Some((&SNAPSHOT_VERSION, body)) => {
+                    return Self::restore_in_flight(body)
+                        .map_err(|e| format!("restore failed: corrupt snapshot: {e}"));
+                }
+                Some((&version, _)) => {
+                    return Err(format!(
+                        "restore failed: unsupported snapshot version {version}"
+                    ));
+                }
+                None => {}
+            }
+        }
         let compiled = MontyRun::load(bytes).map_err(|e| format!("restore failed: {e}"))?;
+        Ok(Self::from_compiled(compiled))
+    }
+
+    /// Write [`Self::snapshot`] to `path` as a snapshot container.
+    pub fn snapshot_to_file(&self, path: &Path) -> Result<(), String> {
+        snapshot_file::write(path, &self.snapshot()?)
+    }
+
+    /// Restore a handle from a snapshot container file.
+    ///
+    /// The file is memory-mapped where the platform allows, so the
+    /// snapshot is deserialized directly from the page cache.
+    pub fn restore_file(path: &Path) -> Result<Self, String> {
+        let mapped = snapshot_file::MappedFile::open(path)?;
+        Self::restore(snapshot_file::decode(mapped.bytes())?)
+    }
+
+    fn restore_in_flight(body: &[u8]) -> Result<Self, postcard::Error> {
+        let meter = Arc::new(Meter::default());
+        let saved: SavedHandle = tracker::restore_into(&meter, || postcard::from_bytes(body))?;
         Ok(Self {
-            state: HandleState::Ready(compiled),
+            state: saved.state.into(),
             limits: None,
-            usage_json: default_usage_json(),
-            print_output: String::new(),
+            meter,
+            interrupt: None,
+            print_output: saved.print_output,
+            natives: NativeFns::default(),
+            stream: None,
+            inputs: Vec::new(),
+            created: Instant::now(),
+            compile_time: Duration::ZERO,
+            trace: None,
         })
     }
 
+    /// Tag describing the current state, as `monty_start` would have
+    /// returned it; `None` in `Ready` state.
+    pub fn progress_tag(&self) -> Option<MontyProgressTag> {
+        match &self.state {
+            HandleState::PausedLimited { .. } | HandleState::PausedNoLimit { .. } => {
+                Some(MontyProgressTag::Pending)
+            }
+            HandleState::FuturesLimited { .. } | HandleState::FuturesNoLimit { .. } => {
+                Some(MontyProgressTag::ResolveFutures)
+            }
+            HandleState::Complete(done) if done.is_error => Some(MontyProgressTag::Error),
+            HandleState::Complete(_) => Some(MontyProgressTag::Complete),
+            HandleState::Ready(_) | HandleState::Consumed => None,
+        }
+    }
+
+    /// Register a native host function called in-process whenever Python
+    /// calls the external function `name`, instead of pausing.
+    ///
+    /// `name` must also be declared as an external function when the
+    /// handle is created. Registrations are not part of snapshots.
+    pub fn register_native_fn(
+        &mut self,
+        name: String,
+        func: MontyNativeFn,
+        user_data: *mut c_void,
+    ) {
+        self.natives.register(name, func, user_data);
+    }
+
+    /// Set the values of the inputs the program was compiled with, in
+    /// declaration order. Ignored once the handle has left `Ready` state.
+    pub(crate) fn set_inputs(&mut self, values: Vec<MontyObject>) {
+        self.inputs = values;
+    }
+
+    /// Stream print output to `stream` instead of collecting it into the
+    /// completion result's `print_output`. Affects subsequent runs and
+    /// resumes; output already collected stays in the result.
+    pub fn set_output_stream(&mut self, stream: OutputStream) {
+        self.stream = Some(stream);
+    }
+
+    /// Drain output buffered by an output stream without a callback.
+    /// Returns `None` if nothing is buffered or no stream is set.
+    pub fn take_output(&mut self) -> Option<String> {
+        self.stream.as_mut()?.take()
+    }
+
     /// Set memory limit in bytes.
     pub fn set_memory_limit(&mut self, bytes: usize) {
         let limits = self.limits.get_or_insert_with(ResourceLimits::new);
@@ -446,36 +1044,231 @@ impl MontyHandle {
         limits.max_recursion_depth = Some(depth);
     }
 
+    /// Resource usage so far. Valid in every state; while paused it
+    /// reflects the VM steps run up to the pending call.
+    pub fn usage(&self) -> MontyUsage {
+        self.meter.usage().into()
+    }
+
+    /// Live heap and stack of the execution as a JSON object, for a host
+    /// looking into a paused (or finished) run. Valid in every state.
+    ///
+    /// Heap figures come from the tracker, which only sees allocation
+    /// sizes: `live_by_size` buckets the allocations not yet freed by
+    /// power-of-two size class, and `stack_depth` is the recursion depth
+    /// where the VM last stopped. While paused at an external call,
+    /// `pending` describes that call's arguments by type and length.
+    /// Live counts cover activity since the handle was created or
+    /// restored.
+    pub fn inspect_json(&self) -> String {
+        let HeapStats {
+            heap_bytes,
+            peak_heap_bytes,
+            live_allocations,
+            live_by_size,
+            stack_depth,
+            max_stack_depth,
+        } = self.meter.heap();
+        let usage = self.meter.usage();
+        let live_by_size: Vec<Value> = live_by_size
+            .iter()
+            .enumerate()
+            .filter(|(_, count)| **count > 0)
+            .map(|(class, count)| {
+                json!({"max_bytes": HeapStats::class_max_bytes(class), "count": count})
+            })
+            .collect();
+        let describe =
+            |obj: &MontyObject| json!({"type": lookup::type_name(obj), "len": lookup::len(obj)});
+        let pending = self.pending_meta().map(|meta| {
+            let kwargs: Vec<Value> = meta
+                .kwargs
+                .iter()
+                .map(|(key, value)| {
+                    let mut entry = describe(value);
+                    entry["name"] = match key {
+                        MontyObject::String(name) => json!(name),
+                        other => json!(other.to_string()),
+                    };
+                    entry
+                })
+                .collect();
+            json!({
+                "function_name": meta.fn_name,
+                "call_id": meta.call_id,
+                "args": meta.args.iter().map(describe).collect::<Vec<_>>(),
+                "kwargs": kwargs,
+            })
+        });
+        let state = match self.progress_tag() {
+            None if matches!(self.state, HandleState::Consumed) => "consumed",
+            None => "ready",
+            Some(MontyProgressTag::Pending) => "pending",
+            Some(MontyProgressTag::ResolveFutures) => "resolve_futures",
+            Some(MontyProgressTag::Complete | MontyProgressTag::Error) => "complete",
+        };
+        let limits = self.limits.as_ref();
+        json!({
+            "state": state,
+            "heap_bytes": heap_bytes,
+            "peak_heap_bytes": peak_heap_bytes,
+            "memory_limit": limits.and_then(|l| l.max_memory),
+            "live_allocations": live_allocations,
+            "allocations": usage.allocations,
+            "live_by_size": live_by_size,
+            "stack_depth": stack_depth,
+            "max_stack_depth": max_stack_depth,
+            "stack_limit": limits.and_then(|l| l.max_recursion_depth),
+            "time_elapsed_ms": usage.time_elapsed_ms,
+            "pending": pending,
+        })
+        .to_string()
+    }
+
+    /// Stop at the next time check whenever `interrupt` is set, or stop
+    /// watching with `None`.
+    ///
+    /// Applies to the current execution too, even while paused, and is
+    /// kept across [`Self::reset`].
+    pub fn set_interrupt(&mut self, interrupt: Option<Arc<MontyInterrupt>>) {
+        self.meter.watch(interrupt.as_ref());
+        self.interrupt = interrupt;
+    }
+
+    /// Start or stop recording trace events. Enabling an idle handle that
+    /// compiled its own program records the compile first; disabling
+    /// drops events not yet taken.
+    pub fn set_trace(&mut self, enabled: bool) {
+        if !enabled {
+            self.trace = None;
+        } else if self.trace.is_none() {
+            let trace = Trace::new(self.created);
+            if !self.compile_time.is_zero() {
+                trace.push(
+                    TraceKind::Compile,
+                    "compile",
+                    self.created,
+                    self.compile_time,
+                    0,
+                );
+            }
+            self.trace = Some(trace);
+        }
+    }
+
+    /// Drain the trace events recorded since the last call as a JSON
+    /// array, or `None` if tracing is off.
+    pub fn take_trace_json(&self) -> Option<String> {
+        self.trace.as_ref().map(Trace::take_json)
+    }
+
     // --- private helpers ---
 
-    fn drain_print(&mut self, print: PrintWriter) {
+    /// Start time for a trace event, or `None` when not tracing.
+    fn trace_start(&self) -> Option<Instant> {
+        self.trace.as_ref().map(|_| Instant::now())
+    }
+
+    /// Record an event begun at `started` (from [`Self::trace_start`]).
+    fn trace_end(&self, kind: TraceKind, op: &'static str, started: Option<Instant>, bytes: usize) {
+        if let (Some(trace), Some(started)) = (&self.trace, started) {
+            trace.record(kind, op, started, bytes);
+        }
+    }
+
+    /// End the host wait since the last pause, as the call `op` resumes.
+    fn trace_resumed(&self, op: &'static str) {
+        if let Some(trace) = &self.trace {
+            trace.resumed(op);
+        }
+    }
+
+    /// Replace the error an interrupted execution unwound with — a timeout
+    /// raised by the tracker — with a `KeyboardInterrupt`.
+    fn interrupted_or(&self, exc: MontyException) -> MontyException {
+        let interrupted = self.interrupt.as_ref().is_some_and(|i| i.is_set());
+        if interrupted && matches!(exc.exc_type(), monty::ExcType::TimeoutError) {
+            MontyException::new(
+                monty::ExcType::KeyboardInterrupt,
+                Some("execution interrupted".into()),
+            )
+        } else {
+            exc
+        }
+    }
+
+    /// Wrap `inner` so it records into this handle's meter.
+    fn tracker<T: monty::ResourceTracker>(&self, inner: T) -> MeteredTracker<T> {
+        MeteredTracker::new(inner, Arc::clone(&self.meter))
+    }
+
+    fn pending_meta(&self) -> Option<&PendingMeta> {
+        match &self.state {
+            HandleState::PausedLimited { meta, .. } | HandleState::PausedNoLimit { meta, .. } => {
+                Some(meta)
+            }
+            _ => None,
+        }
+    }
+
+    /// Run `f` with the writer for this handle's print output: the output
+    /// stream when one is set, otherwise a collector appended to
+    /// `print_output` afterwards.
+    fn with_print<R>(&mut self, f: impl FnOnce(&Self, &mut PrintWriter<'_>) -> R) -> R {
+        if let Some(mut stream) = self.stream.take() {
+            let result = f(self, &mut PrintWriter::Callback(&mut stream));
+            stream.flush();
+            self.stream = Some(stream);
+            return result;
+        }
+        let mut print = PrintWriter::Collect(String::new());
+        let result = f(self, &mut print);
         if let PrintWriter::Collect(collected) = print {
             self.print_output.push_str(&collected);
         }
+        result
     }
 
+    /// Run one VM segment for the call `op`, then move to the state it
+    /// ended in.
     fn run_snapshot_op<T: TrackerExt>(
         &mut self,
+        op: &'static str,
         f: impl FnOnce(&mut PrintWriter) -> Result<RunProgress<T>, MontyException>,
     ) -> (MontyProgressTag, Option<String>) {
-        let mut print = PrintWriter::Collect(String::new());
-        let result = f(&mut print);
-        self.drain_print(print);
-        match result {
+        let started = self.trace_start();
+        let result = self.with_print(|this, print| {
+            this.meter.time(|| {
+                let progress = f(print);
+                drive_natives(&this.natives, progress, print)
+            })
+        });
+        self.trace_end(TraceKind::Vm, op, started, 0);
+        let progress = match result {
             Ok(progress) => self.process_progress(progress),
             Err(exc) => self.handle_exception(exc),
+        };
+        if let (Some(trace), MontyProgressTag::Pending | MontyProgressTag::ResolveFutures) =
+            (&self.trace, progress.0)
+        {
+            trace.paused();
         }
+        progress
     }
 
-    fn resume_with_result(&mut self, result: ExternalResult) -> (MontyProgressTag, Option<String>) {
+    fn resume_with_result(
+        &mut self,
+        op: &'static str,
+        result: ExternalResult,
+    ) -> (MontyProgressTag, Option<String>) {
         let state = std::mem::replace(&mut self.state, HandleState::Consumed);
 
         match state {
             HandleState::PausedLimited { snapshot, .. } => {
-                self.run_snapshot_op(|print| snapshot.run(result, print))
+                self.run_snapshot_op(op, |print| snapshot.run(result, print))
             }
             HandleState::PausedNoLimit { snapshot, .. } => {
-                self.run_snapshot_op(|print| snapshot.run(result, print))
+                self.run_snapshot_op(op, |print| snapshot.run(result, print))
             }
             other => {
                 self.state = other;
@@ -487,19 +1280,38 @@ impl MontyHandle {
         }
     }
 
+    fn resume_futures_with(
+        &mut self,
+        ext_results: Vec<(u32, ExternalResult)>,
+    ) -> (MontyProgressTag, Option<String>) {
+        let state = std::mem::replace(&mut self.state, HandleState::Consumed);
+
+        match state {
+            HandleState::FuturesLimited { snapshot, .. } => self
+                .run_snapshot_op("resume_futures", |print| {
+                    snapshot.resume(ext_results, print)
+                }),
+            HandleState::FuturesNoLimit { snapshot, .. } => self
+                .run_snapshot_op("resume_futures", |print| {
+                    snapshot.resume(ext_results, print)
+                }),
+            other => {
+                self.state = other;
+                (
+                    MontyProgressTag::Error,
+                    Some("handle not in Futures state".into()),
+                )
+            }
+        }
+    }
+
     fn process_progress<T: TrackerExt>(
         &mut self,
         progress: RunProgress<T>,
     ) -> (MontyProgressTag, Option<String>) {
         match progress {
             RunProgress::Complete(obj) => {
-                let val = monty_object_to_json(&obj);
-                let result_json =
-                    build_result_json(val, None, &self.usage_json, &self.print_output);
-                self.state = HandleState::Complete {
-                    result_json,
-                    is_error: false,
-                };
+                self.state = HandleState::Complete(CompleteResult::ok(obj));
                 (MontyProgressTag::Complete, None)
             }
             RunProgress::FunctionCall {
@@ -510,7 +1322,7 @@ impl MontyHandle {
                 method_call,
                 state: snapshot,
             } => {
-                let meta = build_pending_meta(function_name, &args, &kwargs, call_id, method_call);
+                let meta = PendingMeta::new(function_name, args, kwargs, call_id, method_call);
                 self.state = T::into_paused(snapshot, meta);
                 (MontyProgressTag::Pending, None)
             }
@@ -521,15 +1333,9 @@ impl MontyHandle {
                 (MontyProgressTag::ResolveFutures, None)
             }
             RunProgress::OsCall { .. } => {
-                self.state = HandleState::Complete {
-                    result_json: build_result_json(
-                        Value::Null,
-                        Some(serde_json::json!({"message": "unsupported progress type: OsCall"})),
-                        &self.usage_json,
-                        &self.print_output,
-                    ),
-                    is_error: true,
-                };
+                self.state = HandleState::Complete(CompleteResult::error(
+                    json!({"message": "unsupported progress type: OsCall"}),
+                ));
                 (
                     MontyProgressTag::Error,
                     Some("unsupported progress type: OsCall".into()),
@@ -539,78 +1345,118 @@ impl MontyHandle {
     }
 
     fn handle_exception(&mut self, exc: MontyException) -> (MontyProgressTag, Option<String>) {
-        let err_json = monty_exception_to_json(&exc);
-        let result_json = build_result_json(
-            Value::Null,
-            Some(err_json),
-            &self.usage_json,
-            &self.print_output,
-        );
+        let exc = self.interrupted_or(exc);
         let msg = exc.summary();
-        self.state = HandleState::Complete {
-            result_json,
-            is_error: true,
-        };
+        self.state = HandleState::Complete(CompleteResult::error(monty_exception_to_json(&exc)));
         (MontyProgressTag::Error, Some(msg))
     }
 }
 
-/// Build a `PendingMeta` from a `FunctionCall` variant's fields.
-fn build_pending_meta(
-    function_name: String,
-    args: &[monty::MontyObject],
-    kwargs: &[(monty::MontyObject, monty::MontyObject)],
-    call_id: u32,
-    method_call: bool,
-) -> PendingMeta {
-    let args_json =
-        serde_json::to_string(&args.iter().map(monty_object_to_json).collect::<Vec<_>>())
-            .unwrap_or_else(|_| "[]".into());
-
-    let kwargs_json = if kwargs.is_empty() {
-        "{}".into()
-    } else {
-        let map: serde_json::Map<String, Value> = kwargs
-            .iter()
-            .map(|(k, v)| {
-                let key = if let monty::MontyObject::String(s) = k {
-                    s.clone()
-                } else {
-                    format!("{k}")
-                };
-                (key, monty_object_to_json(v))
-            })
-            .collect();
-        serde_json::to_string(&map).unwrap_or_else(|_| "{}".into())
-    };
+impl PendingMeta {
+    /// Build a `PendingMeta` from a `FunctionCall` variant's fields.
+    fn new(
+        fn_name: String,
+        args: Vec<MontyObject>,
+        kwargs: Vec<(MontyObject, MontyObject)>,
+        call_id: u32,
+        method_call: bool,
+    ) -> Self {
+        Self {
+            fn_name,
+            args,
+            kwargs,
+            call_id,
+            method_call,
+            args_json: OnceCell::new(),
+            kwargs_json: OnceCell::new(),
+        }
+    }
 
-    PendingMeta {
-        fn_name: function_name,
-        args_json,
-        kwargs_json,
-        call_id,
-        method_call,
+    fn args_json(&self) -> &str {
+        self.args_json.get_or_init(|| {
+            serde_json::to_string(
+                &self
+                    .args
+                    .iter()
+                    .map(monty_object_to_json)
+                    .collect::<Vec<_>>(),
+            )
+            .unwrap_or_else(|_| "[]".into())
+        })
+    }
+
+    fn kwargs_json(&self) -> &str {
+        self.kwargs_json.get_or_init(|| {
+            if self.kwargs.is_empty() {
+                return "{}".into();
+            }
+            let map: serde_json::Map<String, Value> = self
+                .kwargs
+                .iter()
+                .map(|(k, v)| {
+                    let key = if let MontyObject::String(s) = k {
+                        s.clone()
+                    } else {
+                        format!("{k}")
+                    };
+                    (key, monty_object_to_json(v))
+                })
+                .collect();
+            serde_json::to_string(&map).unwrap_or_else(|_| "{}".into())
+        })
     }
 }
 
-fn default_usage_json() -> String {
-    r#"{"memory_bytes_used":0,"time_elapsed_ms":0,"stack_depth_used":0}"#.into()
+impl CompleteResult {
+    fn ok(value: MontyObject) -> Self {
+        Self {
+            value,
+            error: None,
+            is_error: false,
+            result_json: OnceCell::new(),
+        }
+    }
+
+    fn error(error: Value) -> Self {
+        Self {
+            value: MontyObject::None,
+            error: Some(error),
+            is_error: true,
+            result_json: OnceCell::new(),
+        }
+    }
+}
+
+/// Parse and compile Python source code.
+///
+/// `input_names` are the global variables the code reads from the values
+/// passed to `run`/`start`, in that order. `script_name` defaults to
+/// `"<input>"` when `None`.
+pub(crate) fn compile(
+    code: String,
+    input_names: Vec<String>,
+    external_functions: Vec<String>,
+    script_name: Option<String>,
+) -> Result<MontyRun, MontyException> {
+    let name = script_name.unwrap_or_else(|| "<input>".into());
+    MontyRun::new(code, &name, input_names, external_functions)
+}
+
+/// Build the `ExternalResult` for a future that failed with `msg`.
+fn future_error(msg: String) -> ExternalResult {
+    let exc = MontyException::new(monty::ExcType::RuntimeError, Some(msg));
+    ExternalResult::Error(exc)
 }
 
-fn build_result_json(
+pub(crate) fn build_result_json(
     value: Value,
     error: Option<Value>,
-    usage_json: &str,
+    usage: ResourceUsage,
     print_output: &str,
 ) -> String {
-    let usage: Value = serde_json::from_str(usage_json).unwrap_or(serde_json::json!({
-        "memory_bytes_used": 0,
-        "time_elapsed_ms": 0,
-        "stack_depth_used": 0,
-    }));
-    let mut result = serde_json::json!({
+    let mut result = json!({
         "value": value,
-        "usage": usage,
+        "usage": usage.to_json(),
     });
     if let Some(err) = error {
         result.as_object_mut().unwrap().insert("error".into(), err);
@@ -624,6 +1470,81 @@ fn build_result_json(
     serde_json::to_string(&result).unwrap_or_default()
 }
 
+fn write_result_bin(
+    buf: &mut Vec<u8>,
+    value: &MontyObject,
+    error: Option<&Value>,
+    usage: ResourceUsage,
+    print_output: &str,
+) {
+    let count = 2 + usize::from(error.is_some()) + usize::from(!print_output.is_empty());
+    buf.push(binary::TAG_DICT);
+    binary::write_len(buf, count);
+    binary::write_str(buf, "value");
+    binary::write_object(buf, value);
+    binary::write_str(buf, "usage");
+    binary::write_json(buf, &usage.to_json());
+    if let Some(err) = error {
+        binary::write_str(buf, "error");
+        binary::write_json(buf, err);
+    }
+    if !print_output.is_empty() {
+        binary::write_str(buf, "print_output");
+        binary::write_str(buf, print_output);
+    }
+}
+
+/// Answer every `FunctionCall` for a registered native function in place,
+/// returning the first progress the caller has to handle itself.
+fn drive_natives<T: monty::ResourceTracker>(
+    natives: &NativeFns,
+    mut progress: Result<RunProgress<T>, MontyException>,
+    print: &mut PrintWriter,
+) -> Result<RunProgress<T>, MontyException> {
+    if natives.is_empty() {
+        return progress;
+    }
+    loop {
+        match progress {
+            Ok(RunProgress::FunctionCall {
+                function_name,
+                args,
+                kwargs,
+                state,
+                ..
+            }) if natives.contains(&function_name) => {
+                let result = natives
+                    .call(&function_name, &args, &kwargs)
+                    .expect("checked by contains");
+                progress = state.run(result, print);
+            }
+            other => return other,
+        }
+    }
+}
+
+/// Run to completion when native functions are registered: natives are
+/// answered in place, and any other pause is an error since `monty_run`
+/// has no way to resume it.
+fn complete_with_natives<T: monty::ResourceTracker>(
+    natives: &NativeFns,
+    progress: Result<RunProgress<T>, MontyException>,
+    print: &mut PrintWriter,
+) -> Result<MontyObject, MontyException> {
+    let message = match drive_natives(natives, progress, print)? {
+        RunProgress::Complete(obj) => return Ok(obj),
+        RunProgress::FunctionCall { function_name, .. } => {
+            format!("external function {function_name} is not a native function; use monty_start")
+        }
+        RunProgress::ResolveFutures(_) => "awaiting external futures requires monty_start".into(),
+        RunProgress::OsCall { .. } => "unsupported progress type: OsCall".into(),
+    };
+    Err(MontyException::new(
+        monty::ExcType::RuntimeError,
+        Some(message),
+    ))
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -698,6 +1619,132 @@ mod tests {
         assert!(result.is_err());
     }
 
+    #[test]
+    fn test_snapshot_paused_restore_resume() {
+        let mut handle = MontyHandle::new(
+            "print('before')\nx = fetch(1, key='k')\nx + 1".into(),
+            vec!["fetch".into()],
+            None,
+        )
+        .unwrap();
+        let (tag, _) = handle.start();
+        assert_eq!(tag, MontyProgressTag::Pending);
+        let bytes = handle.snapshot().unwrap();
+        assert!(bytes.starts_with(SNAPSHOT_MAGIC));
+        drop(handle);
+
+        let mut restored = MontyHandle::restore(&bytes).unwrap();
+        assert_eq!(restored.progress_tag(), Some(MontyProgressTag::Pending));
+        assert_eq!(restored.pending_fn_name(), Some("fetch"));
+        assert_eq!(restored.pending_fn_args_json(), Some("[1]"));
+        assert_eq!(restored.pending_fn_kwargs_json(), Some(r#"{"key":"k"}"#));
+        assert_eq!(restored.pending_call_id(), Some(0));
+
+        let (tag, _) = restored.resume("41");
+        assert_eq!(tag, MontyProgressTag::Complete);
+        let parsed: Value = serde_json::from_str(restored.complete_result_json().unwrap()).unwrap();
+        assert_eq!(parsed["value"], json!(42));
+        assert_eq!(parsed["print_output"], json!("before\n"));
+    }
+
+    #[test]
+    fn test_snapshot_paused_with_limits_keeps_usage() {
+        let mut handle =
+            MontyHandle::new("y = [1, 2, 3]\nfetch()".into(), vec!["fetch".into()], None).unwrap();
+        handle.set_memory_limit(1 << 20);
+        handle.start();
+        let before = handle.usage();
+        let bytes = handle.snapshot().unwrap();
+
+        let mut restored = MontyHandle::restore(&bytes).unwrap();
+        assert_eq!(restored.usage(), before);
+        let (tag, _) = restored.resume("null");
+        assert_eq!(tag, MontyProgressTag::Complete);
+        assert!(restored.usage().allocations >= before.allocations);
+    }
+
+    #[test]
+    fn test_snapshot_futures_restore_resolve() {
+        let mut handle =
+            MontyHandle::new(async_code_single().into(), vec!["fetch".into()], None).unwrap();
+        assert_eq!(handle.start().0, MontyProgressTag::Pending);
+        assert_eq!(
+            handle.resume_as_future().0,
+            MontyProgressTag::ResolveFutures
+        );
+        let call_ids = handle.pending_future_call_ids().unwrap().to_owned();
+        let bytes = handle.snapshot().unwrap();
+        drop(handle);
+
+        let mut restored = MontyHandle::restore(&bytes).unwrap();
+        assert_eq!(
+            restored.progress_tag(),
+            Some(MontyProgressTag::ResolveFutures)
+        );
+        assert_eq!(restored.pending_future_call_ids(), Some(call_ids.as_str()));
+
+        let ids: Vec<u32> = serde_json::from_str(&call_ids).unwrap();
+        let results = format!("{{\"{}\":\"response_x\"}}", ids[0]);
+        let (tag, _) = restored.resume_futures(&results, "{}");
+        assert_eq!(tag, MontyProgressTag::Complete);
+        let result: Value = serde_json::from_str(restored.complete_result_json().unwrap()).unwrap();
+        assert_eq!(result["value"], "response_x");
+    }
+
+    #[test]
+    fn test_restore_unsupported_snapshot_version() {
+        let mut bytes = SNAPSHOT_MAGIC.to_vec();
+        bytes.push(SNAPSHOT_VERSION + 1);
+        let err = MontyHandle::restore(&bytes).err().unwrap();
+        assert!(err.contains("unsupported snapshot version"), "{err}");
+    }
+
+    #[test]
+    fn test_restore_corrupt_snapshot_reports_error() {
+        let mut handle = MontyHandle::new("fetch()".into(), vec!["fetch".into()], None).unwrap();
+        handle.start();
+        let mut bytes = handle.snapshot().unwrap();
+        bytes.truncate(SNAPSHOT_MAGIC.len() + 1 + 4);
+        let err = MontyHandle::restore(&bytes).err().unwrap();
+        assert!(err.contains("corrupt snapshot"), "{err}");
+    }
+
+    #[test]
+    fn test_snapshot_file_restore_resume() {
+        let mut handle =
+            MontyHandle::new("x = fetch()\nx * 2".into(), vec!["fetch".into()], None).unwrap();
+        handle.start();
+        let path = std::env::temp_dir().join(format!("monty_handle_{}.snap", std::process::id()));
+        handle.snapshot_to_file(&path).unwrap();
+
+        let mut restored = MontyHandle::restore_file(&path).unwrap();
+        assert_eq!(restored.pending_fn_name(), Some("fetch"));
+        let (tag, _) = restored.resume("21");
+        assert_eq!(tag, MontyProgressTag::Complete);
+
+        // A container held in memory restores through the plain path too.
+        let bytes = std::fs::read(&path).unwrap();
+        std::fs::remove_file(&path).unwrap();
+        assert!(MontyHandle::restore(&bytes).is_ok());
+    }
+
+    #[test]
+    fn test_restore_file_rejects_bare_snapshot() {
+        let handle = MontyHandle::new("1".into(), vec![], None).unwrap();
+        let path = std::env::temp_dir().join(format!("monty_bare_{}.snap", std::process::id()));
+        std::fs::write(&path, handle.snapshot().unwrap()).unwrap();
+
+        let err = MontyHandle::restore_file(&path).err().unwrap();
+        std::fs::remove_file(&path).unwrap();
+        assert!(err.contains("not a snapshot container"), "{err}");
+    }
+
+    #[test]
+    fn test_progress_tag_ready_is_none() {
+        let handle = MontyHandle::new("1".into(), vec![], None).unwrap();
+        assert_eq!(handle.progress_tag(), None);
+    }
+
     #[test]
     fn test_restore_invalid_bytes() {
         let result = MontyHandle::restore(&[0, 1, 2, 3]);
@@ -894,7 +1941,7 @@ result
 
     #[test]
     fn test_default_usage_json() {
-        let usage: Value = serde_json::from_str(&default_usage_json()).unwrap();
+        let usage = ResourceUsage::default().to_json();
         assert_eq!(usage["memory_bytes_used"], 0);
         assert_eq!(usage["time_elapsed_ms"], 0);
         assert_eq!(usage["stack_depth_used"], 0);
@@ -902,7 +1949,7 @@ result
 
     #[test]
     fn test_build_result_json_ok() {
-        let result = build_result_json(json!(42), None, &default_usage_json(), "");
+        let result = build_result_json(json!(42), None, ResourceUsage::default(), "");
         let parsed: Value = serde_json::from_str(&result).unwrap();
         assert_eq!(parsed["value"], 42);
         assert!(parsed.get("error").is_none());
@@ -913,7 +1960,7 @@ result
     #[test]
     fn test_build_result_json_error() {
         let err = json!({"message": "boom"});
-        let result = build_result_json(Value::Null, Some(err), &default_usage_json(), "");
+        let result = build_result_json(Value::Null, Some(err), ResourceUsage::default(), "");
         let parsed: Value = serde_json::from_str(&result).unwrap();
         assert!(parsed["value"].is_null());
         assert_eq!(parsed["error"]["message"], "boom");
@@ -921,7 +1968,7 @@ result
 
     #[test]
     fn test_build_result_json_with_print_output() {
-        let result = build_result_json(json!(42), None, &default_usage_json(), "hello world\n");
+        let result = build_result_json(json!(42), None, ResourceUsage::default(), "hello world\n");
         let parsed: Value = serde_json::from_str(&result).unwrap();
         assert_eq!(parsed["value"], 42);
         assert_eq!(parsed["print_output"], "hello world\n");
@@ -929,79 +1976,290 @@ result
 
     #[test]
     fn test_build_result_json_empty_print_output_omitted() {
-        let result = build_result_json(json!(42), None, &default_usage_json(), "");
+        let result = build_result_json(json!(42), None, ResourceUsage::default(), "");
         let parsed: Value = serde_json::from_str(&result).unwrap();
         assert!(parsed.get("print_output").is_none());
     }
 
     #[test]
-    fn test_run_captures_print_output() {
-        let mut handle = MontyHandle::new("print('hello')".into(), vec![], None).unwrap();
+    fn test_run_captures_print_output() {
+        let mut handle = MontyHandle::new("print('hello')".into(), vec![], None).unwrap();
+        let (tag, result_json, _) = handle.run();
+        assert_eq!(tag, MontyResultTag::Ok);
+        let parsed: Value = serde_json::from_str(&result_json).unwrap();
+        assert_eq!(parsed["print_output"], "hello\n");
+    }
+
+    #[test]
+    fn test_run_no_print_output_omits_key() {
+        let mut handle = MontyHandle::new("2 + 2".into(), vec![], None).unwrap();
+        let (tag, result_json, _) = handle.run();
+        assert_eq!(tag, MontyResultTag::Ok);
+        let parsed: Value = serde_json::from_str(&result_json).unwrap();
+        assert!(parsed.get("print_output").is_none());
+    }
+
+    #[test]
+    fn test_start_captures_print_no_limits() {
+        let mut handle = MontyHandle::new("print('start')\n42".into(), vec![], None).unwrap();
+        let (tag, err) = handle.start();
+        assert_eq!(tag, MontyProgressTag::Complete);
+        assert!(err.is_none());
+        let result: Value = serde_json::from_str(handle.complete_result_json().unwrap()).unwrap();
+        assert_eq!(result["print_output"], "start\n");
+        assert_eq!(result["value"], 42);
+    }
+
+    #[test]
+    fn test_start_captures_print_with_limits() {
+        let mut handle = MontyHandle::new("print('limited')\n99".into(), vec![], None).unwrap();
+        handle.set_memory_limit(10 * 1024 * 1024);
+        let (tag, err) = handle.start();
+        assert_eq!(tag, MontyProgressTag::Complete);
+        assert!(err.is_none());
+        let result: Value = serde_json::from_str(handle.complete_result_json().unwrap()).unwrap();
+        assert_eq!(result["print_output"], "limited\n");
+        assert_eq!(result["value"], 99);
+    }
+
+    #[test]
+    fn test_iterative_captures_print_across_steps() {
+        let code = "print('before')\na = ext_fn(1)\nprint('after')\na + 10";
+        let mut handle = MontyHandle::new(code.into(), vec!["ext_fn".into()], None).unwrap();
+        let (tag, _) = handle.start();
+        assert_eq!(tag, MontyProgressTag::Pending);
+
+        let (tag, _) = handle.resume("5");
+        assert_eq!(tag, MontyProgressTag::Complete);
+        let result: Value = serde_json::from_str(handle.complete_result_json().unwrap()).unwrap();
+        assert_eq!(result["value"], 15);
+        assert_eq!(result["print_output"], "before\nafter\n");
+    }
+
+    #[test]
+    fn test_iterative_captures_print_with_limits() {
+        let code = "print('hello')\na = ext_fn(1)\na";
+        let mut handle = MontyHandle::new(code.into(), vec!["ext_fn".into()], None).unwrap();
+        handle.set_memory_limit(10 * 1024 * 1024);
+        let (tag, _) = handle.start();
+        assert_eq!(tag, MontyProgressTag::Pending);
+
+        let (tag, _) = handle.resume("7");
+        assert_eq!(tag, MontyProgressTag::Complete);
+        let result: Value = serde_json::from_str(handle.complete_result_json().unwrap()).unwrap();
+        assert_eq!(result["value"], 7);
+        assert_eq!(result["print_output"], "hello\n");
+    }
+
+    #[test]
+    fn test_output_stream_buffers_between_steps() {
+        let code = "print('before')\na = ext_fn(1)\nprint('after')\na";
+        let mut handle = MontyHandle::new(code.into(), vec!["ext_fn".into()], None).unwrap();
+        handle.set_output_stream(OutputStream::buffered(0));
+        assert_eq!(handle.take_output(), None);
+
+        let (tag, _) = handle.start();
+        assert_eq!(tag, MontyProgressTag::Pending);
+        assert_eq!(handle.take_output().as_deref(), Some("before\n"));
+
+        let (tag, _) = handle.resume("1");
+        assert_eq!(tag, MontyProgressTag::Complete);
+        assert_eq!(handle.take_output().as_deref(), Some("after\n"));
+        let result: Value = serde_json::from_str(handle.complete_result_json().unwrap()).unwrap();
+        assert!(result.get("print_output").is_none());
+    }
+
+    #[test]
+    fn test_output_stream_cap_bounds_run() {
+        let mut handle =
+            MontyHandle::new("for i in range(1000):\n    print(i)".into(), vec![], None).unwrap();
+        handle.set_output_stream(OutputStream::buffered(16));
+        let (tag, _, _) = handle.run();
+        assert_eq!(tag, MontyResultTag::Ok);
+        let out = handle.take_output().unwrap();
+        assert!(out.starts_with("[... "));
+        assert!(out.ends_with("997\n998\n999\n"));
+    }
+
+    #[test]
+    fn test_take_output_without_stream() {
+        let mut handle = MontyHandle::new("print('x')".into(), vec![], None).unwrap();
+        handle.run();
+        assert_eq!(handle.take_output(), None);
+    }
+
+    #[test]
+    fn test_with_inputs_start() {
+        let inputs = vec![("n".into(), MontyObject::Int(5))];
+        let mut handle =
+            MontyHandle::with_inputs("ext_fn(n) + n".into(), inputs, vec!["ext_fn".into()], None)
+                .unwrap();
+        assert_eq!(handle.start().0, MontyProgressTag::Pending);
+        assert_eq!(handle.resume("10").0, MontyProgressTag::Complete);
+        let parsed: Value = serde_json::from_str(handle.complete_result_json().unwrap()).unwrap();
+        assert_eq!(parsed["value"], 15);
+    }
+
+    #[test]
+    fn test_reset_runs_new_program() {
+        let mut handle = MontyHandle::new("print('first')\n1".into(), vec![], None).unwrap();
+        handle.set_stack_limit(5);
+        assert_eq!(handle.run().0, MontyResultTag::Ok);
+
+        let inputs = vec![("n".into(), MontyObject::Int(20))];
+        handle.reset("n * 2".into(), inputs, vec![], None).unwrap();
+        let (tag, result_json, _) = handle.run();
+        assert_eq!(tag, MontyResultTag::Ok);
+        let parsed: Value = serde_json::from_str(&result_json).unwrap();
+        assert_eq!(parsed["value"], 40);
+        // Print output and limits from the previous program are gone.
+        assert!(parsed.get("print_output").is_none());
+        assert!(handle.limits.is_none());
+    }
+
+    #[test]
+    fn test_reset_drops_paused_state() {
+        let mut handle = MontyHandle::new("ext_fn(1)".into(), vec!["ext_fn".into()], None).unwrap();
+        handle.set_memory_limit(10 * 1024 * 1024);
+        assert_eq!(handle.start().0, MontyProgressTag::Pending);
+
+        handle.reset("3".into(), vec![], vec![], None).unwrap();
+        assert_eq!(handle.progress_tag(), None);
+        assert_eq!(handle.usage().allocations, 0);
+        assert_eq!(handle.run().0, MontyResultTag::Ok);
+    }
+
+    #[test]
+    fn test_reset_compile_error_leaves_handle() {
+        let mut handle = MontyHandle::new("5".into(), vec![], None).unwrap();
+        assert!(handle.reset("def".into(), vec![], vec![], None).is_err());
         let (tag, result_json, _) = handle.run();
         assert_eq!(tag, MontyResultTag::Ok);
         let parsed: Value = serde_json::from_str(&result_json).unwrap();
-        assert_eq!(parsed["print_output"], "hello\n");
+        assert_eq!(parsed["value"], 5);
     }
 
     #[test]
-    fn test_run_no_print_output_omits_key() {
-        let mut handle = MontyHandle::new("2 + 2".into(), vec![], None).unwrap();
+    fn test_interrupt_stops_run() {
+        let code = "i = 0\nwhile True:\n    i += 1";
+        let mut handle = MontyHandle::new(code.into(), vec![], None).unwrap();
+        let interrupt = Arc::new(MontyInterrupt::default());
+        handle.set_interrupt(Some(Arc::clone(&interrupt)));
+        let stopper = {
+            let interrupt = Arc::clone(&interrupt);
+            std::thread::spawn(move || {
+                std::thread::sleep(Duration::from_millis(20));
+                interrupt.set();
+            })
+        };
+
         let (tag, result_json, _) = handle.run();
-        assert_eq!(tag, MontyResultTag::Ok);
+        stopper.join().unwrap();
+        assert_eq!(tag, MontyResultTag::Error);
         let parsed: Value = serde_json::from_str(&result_json).unwrap();
-        assert!(parsed.get("print_output").is_none());
+        assert_eq!(parsed["error"]["exc_type"], "KeyboardInterrupt");
     }
 
     #[test]
-    fn test_start_captures_print_no_limits() {
-        let mut handle = MontyHandle::new("print('start')\n42".into(), vec![], None).unwrap();
-        let (tag, err) = handle.start();
-        assert_eq!(tag, MontyProgressTag::Complete);
-        assert!(err.is_none());
-        let result: Value = serde_json::from_str(handle.complete_result_json().unwrap()).unwrap();
-        assert_eq!(result["print_output"], "start\n");
-        assert_eq!(result["value"], 42);
+    fn test_interrupt_stops_paused_execution_on_resume() {
+        let code = "ext()\nwhile True:\n    pass";
+        let mut handle = MontyHandle::new(code.into(), vec!["ext".into()], None).unwrap();
+        assert_eq!(handle.start().0, MontyProgressTag::Pending);
+        let interrupt = Arc::new(MontyInterrupt::default());
+        handle.set_interrupt(Some(Arc::clone(&interrupt)));
+        interrupt.set();
+
+        let (tag, _) = handle.resume("null");
+        assert_eq!(tag, MontyProgressTag::Error);
     }
 
     #[test]
-    fn test_start_captures_print_with_limits() {
-        let mut handle = MontyHandle::new("print('limited')\n99".into(), vec![], None).unwrap();
-        handle.set_memory_limit(10 * 1024 * 1024);
-        let (tag, err) = handle.start();
-        assert_eq!(tag, MontyProgressTag::Complete);
-        assert!(err.is_none());
-        let result: Value = serde_json::from_str(handle.complete_result_json().unwrap()).unwrap();
-        assert_eq!(result["print_output"], "limited\n");
-        assert_eq!(result["value"], 99);
+    fn test_interrupt_kept_across_reset() {
+        let mut handle = MontyHandle::new("1".into(), vec![], None).unwrap();
+        let interrupt = Arc::new(MontyInterrupt::default());
+        handle.set_interrupt(Some(Arc::clone(&interrupt)));
+        handle
+            .reset("while True:\n    pass".into(), vec![], vec![], None)
+            .unwrap();
+        interrupt.set();
+
+        let (tag, _, _) = handle.run();
+        assert_eq!(tag, MontyResultTag::Error);
+    }
+
+    fn trace_events(handle: &MontyHandle) -> Vec<(String, String)> {
+        let events: Value = serde_json::from_str(&handle.take_trace_json().unwrap()).unwrap();
+        events
+            .as_array()
+            .unwrap()
+            .iter()
+            .map(|e| {
+                let kind = e["kind"].as_str().unwrap().to_string();
+                (kind, e["op"].as_str().unwrap().to_string())
+            })
+            .collect()
     }
 
     #[test]
-    fn test_iterative_captures_print_across_steps() {
-        let code = "print('before')\na = ext_fn(1)\nprint('after')\na + 10";
-        let mut handle = MontyHandle::new(code.into(), vec!["ext_fn".into()], None).unwrap();
-        let (tag, _) = handle.start();
-        assert_eq!(tag, MontyProgressTag::Pending);
+    fn test_trace_off_by_default() {
+        let mut handle = MontyHandle::new("1".into(), vec![], None).unwrap();
+        handle.run();
+        assert!(handle.take_trace_json().is_none());
+    }
 
-        let (tag, _) = handle.resume("5");
-        assert_eq!(tag, MontyProgressTag::Complete);
-        let result: Value = serde_json::from_str(handle.complete_result_json().unwrap()).unwrap();
-        assert_eq!(result["value"], 15);
-        assert_eq!(result["print_output"], "before\nafter\n");
+    #[test]
+    fn test_trace_records_each_segment() {
+        let mut handle =
+            MontyHandle::new("x = fetch(1)\nx * 2".into(), vec!["fetch".into()], None).unwrap();
+        handle.set_trace(true);
+
+        assert_eq!(handle.start().0, MontyProgressTag::Pending);
+        handle.pending_fn_args_json();
+        handle.pending_fn_args_json();
+        assert_eq!(handle.resume("21").0, MontyProgressTag::Complete);
+        handle.complete_result_json();
+
+        let pair = |k: &str, o: &str| (k.to_string(), o.to_string());
+        assert_eq!(
+            trace_events(&handle),
+            vec![
+                pair("compile", "compile"),
+                pair("vm", "start"),
+                pair("convert", "args_json"),
+                pair("host", "resume"),
+                pair("convert", "value_json"),
+                pair("vm", "resume"),
+                pair("convert", "result_json"),
+            ]
+        );
+        assert_eq!(handle.take_trace_json().as_deref(), Some("[]"));
     }
 
     #[test]
-    fn test_iterative_captures_print_with_limits() {
-        let code = "print('hello')\na = ext_fn(1)\na";
-        let mut handle = MontyHandle::new(code.into(), vec!["ext_fn".into()], None).unwrap();
-        handle.set_memory_limit(10 * 1024 * 1024);
-        let (tag, _) = handle.start();
-        assert_eq!(tag, MontyProgressTag::Pending);
+    fn test_trace_reports_converted_bytes() {
+        let mut handle = MontyHandle::new("[1, 2, 3]".into(), vec![], None).unwrap();
+        handle.set_trace(true);
+        handle.execute().unwrap();
+        let bin = handle.complete_result_bin().unwrap();
 
-        let (tag, _) = handle.resume("7");
-        assert_eq!(tag, MontyProgressTag::Complete);
-        let result: Value = serde_json::from_str(handle.complete_result_json().unwrap()).unwrap();
-        assert_eq!(result["value"], 7);
-        assert_eq!(result["print_output"], "hello\n");
+        let events: Value = serde_json::from_str(&handle.take_trace_json().unwrap()).unwrap();
+        let last = events.as_array().unwrap().last().unwrap();
+        assert_eq!(last["op"], "result_bin");
+        assert_eq!(last["bytes"], json!(bin.len()));
+    }
+
+    #[test]
+    fn test_reset_stops_trace() {
+        let mut handle = MontyHandle::new("1".into(), vec![], None).unwrap();
+        handle.set_trace(true);
+        handle.reset("2".into(), vec![], vec![], None).unwrap();
+        assert!(handle.take_trace_json().is_none());
+
+        handle.set_trace(true);
+        assert_eq!(
+            trace_events(&handle),
+            vec![("compile".into(), "compile".into())]
+        );
     }
 
     #[test]
@@ -1362,4 +2620,422 @@ outer()
         let result: Value = serde_json::from_str(handle.complete_result_json().unwrap()).unwrap();
         assert_eq!(result["value"], "limited_response");
     }
+
+    // --- Binary value transport ---
+
+    fn decode_dict(bytes: &[u8]) -> Vec<(MontyObject, MontyObject)> {
+        match binary::decode_object(bytes).unwrap() {
+            MontyObject::Dict(pairs) => (&pairs).into_iter().cloned().collect(),
+            other => panic!("expected dict, got {other:?}"),
+        }
+    }
+
+    fn dict_get<'a>(pairs: &'a [(MontyObject, MontyObject)], key: &str) -> Option<&'a MontyObject> {
+        pairs
+            .iter()
+            .find(|(k, _)| matches!(k, MontyObject::String(s) if s == key))
+            .map(|(_, v)| v)
+    }
+
+    #[test]
+    fn test_pending_args_bin() {
+        let code = "ext_fn(1, 'two', [3.5], key=None)";
+        let mut handle = MontyHandle::new(code.into(), vec!["ext_fn".into()], None).unwrap();
+        let (tag, _) = handle.start();
+        assert_eq!(tag, MontyProgressTag::Pending);
+
+        let args = binary::decode_object(&handle.pending_fn_args_bin().unwrap()).unwrap();
+        assert_eq!(
+            args,
+            MontyObject::List(vec![
+                MontyObject::Int(1),
+                MontyObject::String("two".into()),
+                MontyObject::List(vec![MontyObject::Float(3.5)]),
+            ])
+        );
+
+        let kwargs = decode_dict(&handle.pending_fn_kwargs_bin().unwrap());
+        assert_eq!(dict_get(&kwargs, "key"), Some(&MontyObject::None));
+    }
+
+    #[test]
+    fn test_pending_bin_wrong_state() {
+        let handle = MontyHandle::new("2 + 2".into(), vec![], None).unwrap();
+        assert!(handle.pending_fn_args_bin().is_none());
+        assert!(handle.pending_fn_kwargs_bin().is_none());
+        assert!(handle.complete_result_bin().is_none());
+    }
+
+    #[test]
+    fn test_resume_bin_and_complete_bin() {
+        let code = "print('hi')\nx = ext_fn()\n(x, b'ab')";
+        let mut handle = MontyHandle::new(code.into(), vec!["ext_fn".into()], None).unwrap();
+        handle.start();
+
+        let value = binary::encode_object(&MontyObject::Float(2.5));
+        let (tag, err) = handle.resume_bin(&value);
+        assert_eq!(tag, MontyProgressTag::Complete);
+        assert!(err.is_none());
+
+        let result = decode_dict(&handle.complete_result_bin().unwrap());
+        assert_eq!(
+            dict_get(&result, "value"),
+            Some(&MontyObject::Tuple(vec![
+                MontyObject::Float(2.5),
+                MontyObject::Bytes(b"ab".to_vec()),
+            ]))
+        );
+        assert_eq!(
+            dict_get(&result, "print_output"),
+            Some(&MontyObject::String("hi\n".into()))
+        );
+        assert!(matches!(
+            dict_get(&result, "usage"),
+            Some(MontyObject::Dict(_))
+        ));
+        assert!(dict_get(&result, "error").is_none());
+    }
+
+    #[test]
+    fn test_complete_bin_error() {
+        let mut handle = MontyHandle::new("1/0".into(), vec![], None).unwrap();
+        let (tag, _) = handle.execute().unwrap();
+        assert_eq!(tag, MontyResultTag::Error);
+
+        let result = decode_dict(&handle.complete_result_bin().unwrap());
+        assert_eq!(dict_get(&result, "value"), Some(&MontyObject::None));
+        let error = match dict_get(&result, "error") {
+            Some(MontyObject::Dict(pairs)) => (&pairs).into_iter().cloned().collect::<Vec<_>>(),
+            other => panic!("expected error dict, got {other:?}"),
+        };
+        assert_eq!(
+            dict_get(&error, "exc_type"),
+            Some(&MontyObject::String("ZeroDivisionError".into()))
+        );
+    }
+
+    #[test]
+    fn test_resume_bin_invalid() {
+        let mut handle = MontyHandle::new("ext_fn()".into(), vec!["ext_fn".into()], None).unwrap();
+        handle.start();
+        let (tag, err) = handle.resume_bin(&[0xFF]);
+        assert_eq!(tag, MontyProgressTag::Error);
+        assert!(err.unwrap().contains("invalid value"));
+    }
+
+    #[test]
+    fn test_execute_not_ready() {
+        let mut handle = MontyHandle::new("2 + 2".into(), vec![], None).unwrap();
+        handle.execute().unwrap();
+        assert!(handle.execute().unwrap_err().contains("not in Ready state"));
+    }
+
+    #[test]
+    fn test_progress_bin_pending_and_complete() {
+        let code = "x = ext_fn(1, key='v')\nx + 1";
+        let mut handle = MontyHandle::new(code.into(), vec!["ext_fn".into()], None).unwrap();
+        let (tag, _) = handle.start();
+
+        let MontyObject::Tuple(fields) = binary::decode_object(&handle.progress_bin(tag)).unwrap()
+        else {
+            panic!("expected tuple descriptor");
+        };
+        assert_eq!(fields.len(), 6);
+        assert_eq!(
+            fields[0],
+            MontyObject::Int(MontyProgressTag::Pending as i64)
+        );
+        assert_eq!(fields[1], MontyObject::String("ext_fn".into()));
+        assert_eq!(fields[2], MontyObject::List(vec![MontyObject::Int(1)]));
+        assert_eq!(
+            fields[4],
+            MontyObject::Int(handle.pending_call_id().unwrap().into())
+        );
+        assert_eq!(fields[5], MontyObject::Bool(false));
+
+        let (tag, _) = handle.resume_bin(&binary::encode_object(&MontyObject::Int(41)));
+        assert_eq!(tag, MontyProgressTag::Complete);
+        let MontyObject::Tuple(fields) = binary::decode_object(&handle.progress_bin(tag)).unwrap()
+        else {
+            panic!("expected tuple descriptor");
+        };
+        assert_eq!(
+            fields[0],
+            MontyObject::Int(MontyProgressTag::Complete as i64)
+        );
+        let MontyObject::Dict(result) = &fields[1] else {
+            panic!("expected result envelope");
+        };
+        let result: Vec<_> = result.into_iter().cloned().collect();
+        assert_eq!(dict_get(&result, "value"), Some(&MontyObject::Int(42)));
+    }
+
+    #[test]
+    fn test_progress_bin_futures() {
+        let mut handle =
+            MontyHandle::new(async_code_single().into(), vec!["fetch".into()], None).unwrap();
+        handle.start();
+        let call_id = handle.pending_call_id().unwrap();
+        let (tag, _) = handle.resume_as_future();
+        assert_eq!(tag, MontyProgressTag::ResolveFutures);
+
+        let descriptor = binary::decode_object(&handle.progress_bin(tag)).unwrap();
+        assert_eq!(
+            descriptor,
+            MontyObject::Tuple(vec![
+                MontyObject::Int(MontyProgressTag::ResolveFutures as i64),
+                MontyObject::List(vec![MontyObject::Int(call_id.into())]),
+            ])
+        );
+    }
+
+    unsafe extern "C" fn native_add(
+        user_data: *mut c_void,
+        args: *const u8,
+        args_len: usize,
+        _kwargs: *const u8,
+        _kwargs_len: usize,
+        result: *mut crate::native_fn::MontyNativeResult,
+    ) {
+        unsafe { *user_data.cast::<u32>() += 1 };
+        let args = unsafe { std::slice::from_raw_parts(args, args_len) };
+        let sum = match binary::decode_object(args) {
+            Ok(MontyObject::List(items)) => items
+                .iter()
+                .map(|item| match item {
+                    MontyObject::Int(n) => *n,
+                    _ => 0,
+                })
+                .sum(),
+            _ => 0,
+        };
+        unsafe { (*result).set_value(&binary::encode_object(&MontyObject::Int(sum))) };
+    }
+
+    #[test]
+    fn test_native_fn_called_without_pausing() {
+        let code = "total = 0\nfor i in range(5):\n    total = add(total, i)\nfetch(total)";
+        let mut handle =
+            MontyHandle::new(code.into(), vec!["add".into(), "fetch".into()], None).unwrap();
+        let mut calls = 0u32;
+        handle.register_native_fn("add".into(), native_add, (&raw mut calls).cast());
+
+        let (tag, _) = handle.start();
+        assert_eq!(tag, MontyProgressTag::Pending);
+        assert_eq!(calls, 5);
+        assert_eq!(handle.pending_fn_name(), Some("fetch"));
+        assert_eq!(handle.pending_fn_args_json(), Some("[10]"));
+
+        let (tag, _) = handle.resume("\"done\"");
+        assert_eq!(tag, MontyProgressTag::Complete);
+    }
+
+    #[test]
+    fn test_native_fn_in_run_to_completion() {
+        let mut handle =
+            MontyHandle::new("add(add(1, 2), 3)".into(), vec!["add".into()], None).unwrap();
+        let mut calls = 0u32;
+        handle.register_native_fn("add".into(), native_add, (&raw mut calls).cast());
+
+        let (tag, result_json, _) = handle.run();
+        assert_eq!(tag, MontyResultTag::Ok);
+        let parsed: Value = serde_json::from_str(&result_json).unwrap();
+        assert_eq!(parsed["value"], 6);
+        assert_eq!(calls, 2);
+    }
+
+    #[test]
+    fn test_run_to_completion_rejects_unregistered_call() {
+        let mut handle = MontyHandle::new(
+            "add(1, 2) + fetch()".into(),
+            vec!["add".into(), "fetch".into()],
+            None,
+        )
+        .unwrap();
+        let mut calls = 0u32;
+        handle.register_native_fn("add".into(), native_add, (&raw mut calls).cast());
+
+        let (tag, _, err) = handle.run();
+        assert_eq!(tag, MontyResultTag::Error);
+        assert!(err.unwrap().contains("fetch is not a native function"));
+    }
+
+    #[test]
+    fn test_progress_bin_state_mismatch() {
+        let handle = MontyHandle::new("2 + 2".into(), vec![], None).unwrap();
+        let descriptor = binary::decode_object(&handle.progress_bin(MontyProgressTag::Error));
+        assert_eq!(
+            descriptor.unwrap(),
+            MontyObject::Tuple(vec![
+                MontyObject::Int(MontyProgressTag::Error as i64),
+                MontyObject::None,
+            ])
+        );
+    }
+
+    #[test]
+    fn test_resume_futures_bin() {
+        let mut handle = MontyHandle::new(
+            async_code_gather().into(),
+            vec!["foo".into(), "bar".into()],
+            None,
+        )
+        .unwrap();
+
+        handle.start();
+        let id0 = handle.pending_call_id().unwrap();
+        handle.resume_as_future();
+        let id1 = handle.pending_call_id().unwrap();
+        let (tag, _) = handle.resume_as_future();
+        assert_eq!(tag, MontyProgressTag::ResolveFutures);
+
+        let results = binary::encode_object(&MontyObject::dict(vec![
+            (MontyObject::Int(id0.into()), MontyObject::Int(10)),
+            (MontyObject::Int(id1.into()), MontyObject::Int(32)),
+        ]));
+        let (tag, _) = handle.resume_futures_bin(&results, &[]);
+        assert_eq!(tag, MontyProgressTag::Complete);
+
+        let result = decode_dict(&handle.complete_result_bin().unwrap());
+        assert_eq!(dict_get(&result, "value"), Some(&MontyObject::Int(42)));
+    }
+
+    #[test]
+    fn test_resume_futures_bin_with_error() {
+        let mut handle = MontyHandle::new(
+            async_code_gather().into(),
+            vec!["foo".into(), "bar".into()],
+            None,
+        )
+        .unwrap();
+
+        handle.start();
+        let id0 = handle.pending_call_id().unwrap();
+        handle.resume_as_future();
+        let id1 = handle.pending_call_id().unwrap();
+        handle.resume_as_future();
+
+        let results = binary::encode_object(&MontyObject::dict(vec![(
+            MontyObject::Int(id0.into()),
+            MontyObject::Int(10),
+        )]));
+        let errors = binary::encode_object(&MontyObject::dict(vec![(
+            MontyObject::Int(id1.into()),
+            MontyObject::String("bar failed".into()),
+        )]));
+        let (tag, _) = handle.resume_futures_bin(&results, &errors);
+        assert_eq!(tag, MontyProgressTag::Error);
+        assert_eq!(handle.complete_is_error(), Some(true));
+    }
+
+    #[test]
+    fn test_resume_futures_bin_invalid() {
+        let mut handle =
+            MontyHandle::new(async_code_single().into(), vec!["fetch".into()], None).unwrap();
+        handle.start();
+        handle.resume_as_future();
+        let (tag, err) = handle.resume_futures_bin(&[0xFF], &[]);
+        assert_eq!(tag, MontyProgressTag::Error);
+        assert!(err.unwrap().contains("invalid results"));
+    }
+
+    // --- resource usage ---
+
+    const ALLOCATING_CODE: &str = "data = [str(i) for i in range(200)]\nlen(data)";
+
+    const RECURSIVE_CODE: &str = "def f(n):\n    return 0 if n == 0 else f(n - 1) + 1\nf(20)";
+
+    #[test]
+    fn test_usage_populated_after_run() {
+        let mut handle = MontyHandle::new(ALLOCATING_CODE.into(), vec![], None).unwrap();
+        let (tag, result_json, _) = handle.run();
+        assert_eq!(tag, MontyResultTag::Ok);
+
+        let usage = handle.usage();
+        assert!(usage.memory_bytes_used > 0);
+        assert!(usage.allocations > 0);
+
+        let parsed: Value = serde_json::from_str(&result_json).unwrap();
+        assert_eq!(
+            parsed["usage"]["memory_bytes_used"],
+            usage.memory_bytes_used
+        );
+        assert_eq!(parsed["usage"]["allocations"], usage.allocations);
+    }
+
+    #[test]
+    fn test_usage_tracks_recursion_depth() {
+        let mut handle = MontyHandle::new(RECURSIVE_CODE.into(), vec![], None).unwrap();
+        handle.run();
+        assert!(handle.usage().stack_depth_used > 1);
+    }
+
+    #[test]
+    fn test_usage_with_limits() {
+        let mut handle = MontyHandle::new(ALLOCATING_CODE.into(), vec![], None).unwrap();
+        handle.set_memory_limit(10 * 1024 * 1024);
+        let (tag, _, _) = handle.run();
+        assert_eq!(tag, MontyResultTag::Ok);
+        assert!(handle.usage().allocations > 0);
+    }
+
+    #[test]
+    fn test_usage_readable_while_paused() {
+        let code = format!("{ALLOCATING_CODE}\next_fn(len(data))");
+        let mut handle = MontyHandle::new(code, vec!["ext_fn".into()], None).unwrap();
+        assert_eq!(handle.usage(), MontyUsage::from(ResourceUsage::default()));
+
+        let (tag, _) = handle.start();
+        assert_eq!(tag, MontyProgressTag::Pending);
+        let paused = handle.usage();
+        assert!(paused.allocations > 0);
+
+        handle.resume("1");
+        assert!(handle.usage().allocations >= paused.allocations);
+    }
+
+    #[test]
+    fn test_inspect_json_while_paused() {
+        let code = format!("{ALLOCATING_CODE}\next_fn(data, 'x', key=[1, 2])");
+        let mut handle = MontyHandle::new(code, vec!["ext_fn".into()], None).unwrap();
+        handle.set_stack_limit(50);
+        let idle: Value = serde_json::from_str(&handle.inspect_json()).unwrap();
+        assert_eq!(idle["state"], "ready");
+        assert_eq!(idle["live_allocations"], 0);
+        assert_eq!(idle["pending"], Value::Null);
+
+        let (tag, _) = handle.start();
+        assert_eq!(tag, MontyProgressTag::Pending);
+        let paused: Value = serde_json::from_str(&handle.inspect_json()).unwrap();
+        assert_eq!(paused["state"], "pending");
+        assert!(paused["heap_bytes"].as_u64().unwrap() > 0);
+        assert!(paused["live_allocations"].as_u64().unwrap() > 0);
+        assert!(!paused["live_by_size"].as_array().unwrap().is_empty());
+        assert_eq!(paused["stack_limit"], 50);
+        assert_eq!(paused["memory_limit"], Value::Null);
+        let pending = &paused["pending"];
+        assert_eq!(pending["function_name"], "ext_fn");
+        assert_eq!(pending["args"][0]["type"], "list");
+        assert_eq!(pending["args"][1], json!({"type": "str", "len": 1}));
+        assert_eq!(
+            pending["kwargs"],
+            json!([{"name": "key", "type": "list", "len": 2}])
+        );
+
+        handle.resume("null");
+        let done: Value = serde_json::from_str(&handle.inspect_json()).unwrap();
+        assert_eq!(done["state"], "complete");
+        assert_eq!(done["pending"], Value::Null);
+    }
+
+    #[test]
+    fn test_usage_cpu_time_sentinel() {
+        let usage = MontyUsage::from(ResourceUsage::default());
+        assert_eq!(usage.cpu_time_ms, -1);
+        let usage = MontyUsage::from(ResourceUsage {
+            cpu_time_ms: Some(3),
+            ..ResourceUsage::default()
+        });
+        assert_eq!(usage.cpu_time_ms, 3);
+    }
 }
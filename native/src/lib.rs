@@ -1,15 +1,38 @@
 #![allow(clippy::missing_safety_doc)]
 
+mod batch;
+mod binary;
+mod cache;
 mod convert;
 mod error;
 mod handle;
+mod lookup;
+mod native_fn;
+mod output;
+mod program;
+mod repl;
+mod snapshot_file;
+mod trace;
+mod tracker;
 
+pub use batch::MontyBatchCallback;
+pub use binary::{decode_object, encode_object};
+pub use cache::{MontyCacheStats, MontyProgramCache};
 pub use handle::{MontyHandle, MontyProgressTag, MontyResultTag};
+pub use native_fn::{MontyNativeFn, MontyNativeResult};
+pub use output::MontyOutputCallback;
+pub use program::MontyProgram;
+pub use repl::MontyReplSession;
+pub use tracker::{MontyInterrupt, MontyUsage};
 
-use std::ffi::{c_char, c_int};
+use std::ffi::{c_char, c_int, c_void};
+use std::path::Path;
 use std::ptr;
+use std::sync::Arc;
 
+use convert::monty_object_to_json;
 use error::{catch_ffi_panic, parse_c_str, to_c_string};
+use output::OutputStream;
 
 /// Common FFI wrapper for functions returning `MontyProgressTag`.
 /// Handles: handle null check, panic boundary, error out-parameter.
@@ -46,6 +69,38 @@ macro_rules! ffi_progress {
 // Lifecycle
 // ---------------------------------------------------------------------------
 
+/// Parsed arguments shared by `monty_create` and `monty_program_compile`.
+type SourceArgs = (String, Vec<String>, Option<String>);
+
+/// Parse the `code`, `ext_fns`, and `script_name` C strings.
+///
+/// Writes to `out_error` and returns `Err(())` on NULL `code` or invalid UTF-8.
+unsafe fn parse_source_args(
+    code: *const c_char,
+    ext_fns: *const c_char,
+    script_name: *const c_char,
+    out_error: *mut *mut c_char,
+) -> Result<SourceArgs, ()> {
+    let code_str = unsafe { parse_c_str(code, "code", out_error) }?.to_string();
+
+    let ext_fn_list = if ext_fns.is_null() {
+        vec![]
+    } else {
+        match unsafe { parse_c_str(ext_fns, "ext_fns", out_error) }? {
+            "" => vec![],
+            s => s.split(',').map(|f| f.trim().to_string()).collect(),
+        }
+    };
+
+    let name = if script_name.is_null() {
+        None
+    } else {
+        Some(unsafe { parse_c_str(script_name, "script_name", out_error) }?.to_string())
+    };
+
+    Ok((code_str, ext_fn_list, name))
+}
+
 /// Create a new `MontyHandle` from Python source code.
 ///
 /// - `code`: NUL-terminated UTF-8 Python source.
@@ -61,32 +116,221 @@ pub unsafe extern "C" fn monty_create(
     script_name: *const c_char,
     out_error: *mut *mut c_char,
 ) -> *mut MontyHandle {
-    let code_str = match unsafe { parse_c_str(code, "code", out_error) } {
-        Ok(s) => s.to_string(),
-        Err(()) => return ptr::null_mut(),
+    let (code_str, ext_fn_list, name) =
+        match unsafe { parse_source_args(code, ext_fns, script_name, out_error) } {
+            Ok(args) => args,
+            Err(()) => return ptr::null_mut(),
+        };
+
+    match catch_ffi_panic(|| MontyHandle::new(code_str, ext_fn_list, name)) {
+        Ok(Ok(handle)) => Box::into_raw(Box::new(handle)),
+        Ok(Err(exc)) => {
+            if !out_error.is_null() {
+                unsafe { *out_error = to_c_string(&exc.summary()) };
+            }
+            ptr::null_mut()
+        }
+        Err(panic_msg) => {
+            if !out_error.is_null() {
+                unsafe { *out_error = to_c_string(&panic_msg) };
+            }
+            ptr::null_mut()
+        }
+    }
+}
+
+/// Create a new `MontyHandle` whose code reads named inputs as globals.
+///
+/// - `inputs` / `inputs_len`: a dict in the binary value encoding mapping
+///   each input name (string) to its value.
+///
+/// Other arguments match `monty_create`. Use `monty_program_compile_with_inputs`
+/// to run the same code with different inputs without recompiling it.
+///
+/// Returns a heap-allocated handle, or NULL on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_create_with_inputs(
+    code: *const c_char,
+    ext_fns: *const c_char,
+    inputs: *const u8,
+    inputs_len: usize,
+    script_name: *const c_char,
+    out_error: *mut *mut c_char,
+) -> *mut MontyHandle {
+    let (code_str, ext_fn_list, name) =
+        match unsafe { parse_source_args(code, ext_fns, script_name, out_error) } {
+            Ok(args) => args,
+            Err(()) => return ptr::null_mut(),
+        };
+    let Ok(bytes) = (unsafe { parse_bytes(inputs, inputs_len, "inputs", out_error) }) else {
+        return ptr::null_mut();
     };
 
-    let ext_fn_list = if ext_fns.is_null() {
-        vec![]
+    let created = catch_ffi_panic(|| {
+        let inputs = binary::decode_named_map(bytes)?;
+        MontyHandle::with_inputs(code_str, inputs, ext_fn_list, name).map_err(|e| e.summary())
+    });
+    match created.and_then(|r| r) {
+        Ok(handle) => Box::into_raw(Box::new(handle)),
+        Err(msg) => {
+            if !out_error.is_null() {
+                unsafe { *out_error = to_c_string(&msg) };
+            }
+            ptr::null_mut()
+        }
+    }
+}
+
+/// Return `handle` to Ready state with new code, reusing its allocations
+/// instead of freeing it and creating another.
+///
+/// Arguments after `handle` match `monty_create_cached`: `inputs` may be
+/// NULL for none. Any paused execution is dropped, and these are cleared
+/// as for a new handle:
+///
+/// - limits (`monty_set_memory_limit` and the rest);
+/// - native functions (`monty_register_native_fn`);
+/// - the output stream (`monty_set_output_stream`) and buffered output;
+/// - tracing (`monty_set_trace`);
+/// - resource usage.
+///
+/// An interrupt set with `monty_set_interrupt` is kept, so a host watching
+/// one interrupt across reused handles can still stop the next run.
+///
+/// Returns 0 on success. Returns -1 and sets `out_error` if `handle` is
+/// NULL or the code does not compile, leaving the handle as it was.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_reset(
+    handle: *mut MontyHandle,
+    code: *const c_char,
+    ext_fns: *const c_char,
+    inputs: *const u8,
+    inputs_len: usize,
+    script_name: *const c_char,
+    out_error: *mut *mut c_char,
+) -> c_int {
+    if handle.is_null() {
+        if !out_error.is_null() {
+            unsafe { *out_error = to_c_string("handle is NULL") };
+        }
+        return -1;
+    }
+    let (code_str, ext_fn_list, name) =
+        match unsafe { parse_source_args(code, ext_fns, script_name, out_error) } {
+            Ok(args) => args,
+            Err(()) => return -1,
+        };
+    let bytes: &[u8] = if inputs.is_null() {
+        &[]
     } else {
-        match unsafe { parse_c_str(ext_fns, "ext_fns", out_error) } {
-            Ok("") => vec![],
-            Ok(s) => s.split(',').map(|f| f.trim().to_string()).collect(),
+        unsafe { std::slice::from_raw_parts(inputs, inputs_len) }
+    };
+    let h = unsafe { &mut *handle };
+
+    let reset = catch_ffi_panic(|| {
+        let inputs = if bytes.is_empty() {
+            vec![]
+        } else {
+            binary::decode_named_map(bytes)?
+        };
+        h.reset(code_str, inputs, ext_fn_list, name)
+            .map_err(|e| e.summary())
+    });
+    match reset.and_then(|r| r) {
+        Ok(()) => 0,
+        Err(msg) => {
+            if !out_error.is_null() {
+                unsafe { *out_error = to_c_string(&msg) };
+            }
+            -1
+        }
+    }
+}
+
+/// Free a `MontyHandle`. Safe to call with NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_free(handle: *mut MontyHandle) {
+    if !handle.is_null() {
+        drop(unsafe { Box::from_raw(handle) });
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Compiled programs
+// ---------------------------------------------------------------------------
+
+/// Compile Python source code once into a reusable `MontyProgram`.
+///
+/// Arguments match `monty_create`. Instantiate execution handles from the
+/// program with `monty_program_instantiate` and free it with
+/// `monty_program_free`.
+///
+/// Returns a heap-allocated program, or NULL on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_program_compile(
+    code: *const c_char,
+    ext_fns: *const c_char,
+    script_name: *const c_char,
+    out_error: *mut *mut c_char,
+) -> *mut MontyProgram {
+    let (code_str, ext_fn_list, name) =
+        match unsafe { parse_source_args(code, ext_fns, script_name, out_error) } {
+            Ok(args) => args,
             Err(()) => return ptr::null_mut(),
+        };
+
+    match catch_ffi_panic(|| MontyProgram::compile(code_str, ext_fn_list, name)) {
+        Ok(Ok(program)) => Box::into_raw(Box::new(program)),
+        Ok(Err(exc)) => {
+            if !out_error.is_null() {
+                unsafe { *out_error = to_c_string(&exc.summary()) };
+            }
+            ptr::null_mut()
         }
-    };
+        Err(panic_msg) => {
+            if !out_error.is_null() {
+                unsafe { *out_error = to_c_string(&panic_msg) };
+            }
+            ptr::null_mut()
+        }
+    }
+}
 
-    let name = if script_name.is_null() {
-        None
+/// Compile a reusable `MontyProgram` whose code reads named inputs as
+/// globals.
+///
+/// - `input_names`: NUL-terminated comma-separated input names (or NULL).
+///
+/// Other arguments match `monty_program_compile`. Supply values for each
+/// instance with `monty_program_instantiate_with_inputs`.
+///
+/// Returns a heap-allocated program, or NULL on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_program_compile_with_inputs(
+    code: *const c_char,
+    ext_fns: *const c_char,
+    input_names: *const c_char,
+    script_name: *const c_char,
+    out_error: *mut *mut c_char,
+) -> *mut MontyProgram {
+    let (code_str, ext_fn_list, name) =
+        match unsafe { parse_source_args(code, ext_fns, script_name, out_error) } {
+            Ok(args) => args,
+            Err(()) => return ptr::null_mut(),
+        };
+    let names = if input_names.is_null() {
+        vec![]
     } else {
-        match unsafe { parse_c_str(script_name, "script_name", out_error) } {
-            Ok(s) => Some(s.to_string()),
+        match unsafe { parse_c_str(input_names, "input_names", out_error) } {
+            Ok("") => vec![],
+            Ok(s) => s.split(',').map(|n| n.trim().to_string()).collect(),
             Err(()) => return ptr::null_mut(),
         }
     };
 
-    match catch_ffi_panic(|| MontyHandle::new(code_str, ext_fn_list, name)) {
-        Ok(Ok(handle)) => Box::into_raw(Box::new(handle)),
+    match catch_ffi_panic(|| MontyProgram::compile_with_inputs(code_str, names, ext_fn_list, name))
+    {
+        Ok(Ok(program)) => Box::into_raw(Box::new(program)),
         Ok(Err(exc)) => {
             if !out_error.is_null() {
                 unsafe { *out_error = to_c_string(&exc.summary()) };
@@ -102,11 +346,225 @@ pub unsafe extern "C" fn monty_create(
     }
 }
 
-/// Free a `MontyHandle`. Safe to call with NULL.
+/// Create a fresh `MontyHandle` in Ready state from a compiled program.
+///
+/// The program is not modified and stays valid; the returned handle is
+/// independent of it and must be freed with `monty_free`.
+///
+/// Returns a heap-allocated handle, or NULL on error.
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn monty_free(handle: *mut MontyHandle) {
-    if !handle.is_null() {
-        drop(unsafe { Box::from_raw(handle) });
+pub unsafe extern "C" fn monty_program_instantiate(
+    program: *const MontyProgram,
+    out_error: *mut *mut c_char,
+) -> *mut MontyHandle {
+    if program.is_null() {
+        if !out_error.is_null() {
+            unsafe { *out_error = to_c_string("program is NULL") };
+        }
+        return ptr::null_mut();
+    }
+    let p = unsafe { &*program };
+    match catch_ffi_panic(|| p.instantiate()) {
+        Ok(handle) => Box::into_raw(Box::new(handle)),
+        Err(panic_msg) => {
+            if !out_error.is_null() {
+                unsafe { *out_error = to_c_string(&panic_msg) };
+            }
+            ptr::null_mut()
+        }
+    }
+}
+
+/// Create a fresh `MontyHandle` from a program compiled with inputs,
+/// binding a value to each of them.
+///
+/// - `inputs` / `inputs_len`: a dict in the binary value encoding mapping
+///   every input name declared at compile time (string) to its value.
+///   Missing or unknown names are an error.
+///
+/// Returns a heap-allocated handle, or NULL on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_program_instantiate_with_inputs(
+    program: *const MontyProgram,
+    inputs: *const u8,
+    inputs_len: usize,
+    out_error: *mut *mut c_char,
+) -> *mut MontyHandle {
+    if program.is_null() {
+        if !out_error.is_null() {
+            unsafe { *out_error = to_c_string("program is NULL") };
+        }
+        return ptr::null_mut();
+    }
+    let Ok(bytes) = (unsafe { parse_bytes(inputs, inputs_len, "inputs", out_error) }) else {
+        return ptr::null_mut();
+    };
+    let p = unsafe { &*program };
+    let created = catch_ffi_panic(|| {
+        let inputs = binary::decode_named_map(bytes)?;
+        p.instantiate_with_inputs(inputs)
+    });
+    match created.and_then(|r| r) {
+        Ok(handle) => Box::into_raw(Box::new(handle)),
+        Err(msg) => {
+            if !out_error.is_null() {
+                unsafe { *out_error = to_c_string(&msg) };
+            }
+            ptr::null_mut()
+        }
+    }
+}
+
+/// Free a `MontyProgram`. Safe to call with NULL.
+///
+/// Handles already instantiated from the program remain valid.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_program_free(program: *mut MontyProgram) {
+    if !program.is_null() {
+        drop(unsafe { Box::from_raw(program) });
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Program cache
+// ---------------------------------------------------------------------------
+
+/// Create a `MontyProgramCache` holding at most `capacity_bytes` of
+/// compiled programs (approximate; 0 disables caching).
+///
+/// The cache is reference counted and thread-safe: share it between
+/// threads or isolates with `monty_cache_retain`, and release each
+/// reference with `monty_cache_free`.
+#[unsafe(no_mangle)]
+pub extern "C" fn monty_cache_new(capacity_bytes: usize) -> *const MontyProgramCache {
+    Arc::into_raw(Arc::new(MontyProgramCache::new(capacity_bytes)))
+}
+
+/// Create a `MontyProgramCache` like `monty_cache_new`, backed by the
+/// directory `dir`.
+///
+/// The directory is created if missing but not read on open. A lookup that
+/// misses in memory loads the program from the directory if an earlier
+/// process built against the same monty revision stored it there, and each
+/// newly compiled program is written back, so the next process skips the
+/// compile without paying to load programs it never uses.
+///
+/// Returns NULL and sets `out_error` if `dir` cannot be created.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_cache_open(
+    capacity_bytes: usize,
+    dir: *const c_char,
+    out_error: *mut *mut c_char,
+) -> *const MontyProgramCache {
+    let Ok(dir) = (unsafe { parse_c_str(dir, "dir", out_error) }) else {
+        return ptr::null();
+    };
+    let opened = catch_ffi_panic(|| MontyProgramCache::open(capacity_bytes, Path::new(dir)));
+    match opened.and_then(|r| r) {
+        Ok(cache) => Arc::into_raw(Arc::new(cache)),
+        Err(msg) => {
+            if !out_error.is_null() {
+                unsafe { *out_error = to_c_string(&msg) };
+            }
+            ptr::null()
+        }
+    }
+}
+
+/// Take another reference to `cache`. Safe to call with NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_cache_retain(cache: *const MontyProgramCache) {
+    if !cache.is_null() {
+        unsafe { Arc::increment_strong_count(cache) };
+    }
+}
+
+/// Release a reference to `cache`, freeing it with the last one. Safe to
+/// call with NULL. Handles created from the cache remain valid.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_cache_free(cache: *const MontyProgramCache) {
+    if !cache.is_null() {
+        unsafe { Arc::decrement_strong_count(cache) };
+    }
+}
+
+/// Drop every program held in memory by `cache`. Counters and any cache
+/// directory are kept.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_cache_clear(cache: *const MontyProgramCache) {
+    if !cache.is_null() {
+        unsafe { &*cache }.clear();
+    }
+}
+
+/// Read the cache counters into `out`.
+///
+/// Returns 0 on success, -1 if `cache` or `out` is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_cache_stats(
+    cache: *const MontyProgramCache,
+    out: *mut MontyCacheStats,
+) -> c_int {
+    if cache.is_null() || out.is_null() {
+        return -1;
+    }
+    unsafe { *out = (*cache).stats() };
+    0
+}
+
+/// Create a `MontyHandle`, reusing the compiled program from `cache` when
+/// the same source, external functions, script name, and input names were
+/// compiled before.
+///
+/// - `inputs` / `inputs_len`: as for `monty_create_with_inputs`, or NULL/0
+///   for no inputs. Only the names are part of the cache key.
+///
+/// Other arguments match `monty_create`. Returns a heap-allocated handle,
+/// or NULL on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_create_cached(
+    cache: *const MontyProgramCache,
+    code: *const c_char,
+    ext_fns: *const c_char,
+    inputs: *const u8,
+    inputs_len: usize,
+    script_name: *const c_char,
+    out_error: *mut *mut c_char,
+) -> *mut MontyHandle {
+    if cache.is_null() {
+        if !out_error.is_null() {
+            unsafe { *out_error = to_c_string("cache is NULL") };
+        }
+        return ptr::null_mut();
+    }
+    let (code_str, ext_fn_list, name) =
+        match unsafe { parse_source_args(code, ext_fns, script_name, out_error) } {
+            Ok(args) => args,
+            Err(()) => return ptr::null_mut(),
+        };
+    let bytes: &[u8] = if inputs.is_null() {
+        &[]
+    } else {
+        unsafe { std::slice::from_raw_parts(inputs, inputs_len) }
+    };
+    let c = unsafe { &*cache };
+
+    let created = catch_ffi_panic(|| {
+        let inputs = if bytes.is_empty() {
+            vec![]
+        } else {
+            binary::decode_named_map(bytes)?
+        };
+        c.create(code_str, inputs, ext_fn_list, name)
+    });
+    match created.and_then(|r| r) {
+        Ok(handle) => Box::into_raw(Box::new(handle)),
+        Err(msg) => {
+            if !out_error.is_null() {
+                unsafe { *out_error = to_c_string(&msg) };
+            }
+            ptr::null_mut()
+        }
     }
 }
 
@@ -136,10 +594,25 @@ pub unsafe extern "C" fn monty_run(
 
     let h = unsafe { &mut *handle };
 
-    match catch_ffi_panic(|| h.run()) {
+    let outcome = catch_ffi_panic(|| {
+        let (tag, err) = match h.execute() {
+            Ok(done) => done,
+            Err(msg) => (MontyResultTag::Error, Some(msg)),
+        };
+        // Only build the JSON envelope if the caller asked for it; binary
+        // callers read it via `monty_complete_result_bin` instead.
+        let json = if result_json.is_null() {
+            None
+        } else {
+            Some(to_c_string(h.complete_result_json().unwrap_or_default()))
+        };
+        (tag, json, err)
+    });
+
+    match outcome {
         Ok((tag, json, err)) => {
-            if !result_json.is_null() {
-                unsafe { *result_json = to_c_string(&json) };
+            if let Some(json) = json {
+                unsafe { *result_json = json };
             }
             if !error_msg.is_null() {
                 match err {
@@ -159,10 +632,128 @@ pub unsafe extern "C" fn monty_run(
 }
 
 // ---------------------------------------------------------------------------
-// Execution: iterative (start / resume)
+// Execution: batches
 // ---------------------------------------------------------------------------
 
-/// Start iterative execution (pauses at external function calls).
+/// Run `program` to completion once per input set, in parallel.
+///
+/// - `inputs` / `inputs_len`: a List in the binary value encoding with one
+///   Dict per job, mapping each input name the program was compiled with
+///   to its value.
+/// - `threads`: worker threads to use, or 0 for one per available core;
+///   a larger count is clamped to the available cores.
+/// - `limits_json`: limits applied to every job, as a JSON object with
+///   optional `memory_bytes`, `timeout_ms` and `stack_depth` keys, or NULL.
+/// - `interrupt`: watched by every job, or NULL. Setting it from another
+///   thread stops the running jobs with a `KeyboardInterrupt` and fails
+///   the jobs not yet started; the batch still returns every result.
+/// - `on_result` / `user_data`: if `on_result` is non-NULL it receives each
+///   job's result on the calling thread as soon as the job finishes, and
+///   `out_results` / `out_len` are not written.
+/// - `out_results` / `out_len`: otherwise receive a binary List of every
+///   job's result in input order (caller frees with `monty_bytes_free`).
+/// - `out_error`: receives an error message on failure (caller frees).
+///
+/// Each job's result is a binary `(result_tag, envelope)` Tuple, with the
+/// envelope as from `monty_complete_result_bin`. A failing job reports its
+/// error there without stopping the others. Jobs cannot call external
+/// functions; the program itself is not modified.
+///
+/// Returns 0 on success, -1 if the arguments are invalid.
+#[unsafe(no_mangle)]
+#[allow(clippy::too_many_arguments)]
+pub unsafe extern "C" fn monty_run_batch(
+    program: *const MontyProgram,
+    inputs: *const u8,
+    inputs_len: usize,
+    threads: usize,
+    limits_json: *const c_char,
+    interrupt: *const MontyInterrupt,
+    on_result: Option<MontyBatchCallback>,
+    user_data: *mut c_void,
+    out_results: *mut *mut u8,
+    out_len: *mut usize,
+    out_error: *mut *mut c_char,
+) -> c_int {
+    let fail = |msg: &str| {
+        if !out_error.is_null() {
+            unsafe { *out_error = to_c_string(msg) };
+        }
+        -1
+    };
+    if program.is_null() {
+        return fail("program is NULL");
+    }
+    if on_result.is_none() && (out_results.is_null() || out_len.is_null()) {
+        return fail("out_results is NULL");
+    }
+    let Ok(bytes) = (unsafe { parse_bytes(inputs, inputs_len, "inputs", out_error) }) else {
+        return -1;
+    };
+    let sets = match batch::decode_input_sets(bytes) {
+        Ok(sets) => sets,
+        Err(msg) => return fail(&msg),
+    };
+    let limits = if limits_json.is_null() {
+        batch::BatchLimits::default()
+    } else {
+        let Ok(json) = (unsafe { parse_c_str(limits_json, "limits_json", out_error) }) else {
+            return -1;
+        };
+        match batch::BatchLimits::from_json(json) {
+            Ok(limits) => limits,
+            Err(msg) => return fail(&msg),
+        }
+    };
+    let p = unsafe { &*program };
+    // Jobs hold a reference for the batch, taken like `monty_set_interrupt`.
+    let interrupt = (!interrupt.is_null()).then(|| {
+        unsafe { Arc::increment_strong_count(interrupt) };
+        unsafe { Arc::from_raw(interrupt) }
+    });
+    let interrupt = interrupt.as_ref();
+
+    let outcome = catch_ffi_panic(|| match on_result {
+        Some(callback) => {
+            batch::run_batch(p, sets, threads, limits, interrupt, |index, result| {
+                let bytes = result.to_bin();
+                unsafe { callback(user_data, index, bytes.as_ptr(), bytes.len()) };
+            });
+            None
+        }
+        None => {
+            let mut results: Vec<Option<batch::JobResult>> = Vec::new();
+            results.resize_with(sets.len(), || None);
+            batch::run_batch(p, sets, threads, limits, interrupt, |index, result| {
+                results[index] = Some(result);
+            });
+            // Every result is written in place into the one buffer, so
+            // packed arrays stay aligned to its start.
+            let mut buf = Vec::new();
+            buf.push(binary::TAG_LIST);
+            binary::write_len(&mut buf, results.len());
+            for result in results.iter().flatten() {
+                result.write_bin(&mut buf);
+            }
+            Some(buf)
+        }
+    });
+
+    match outcome {
+        Ok(Some(buf)) => {
+            unsafe { *out_results = bytes_out(Some(buf), out_len) };
+            0
+        }
+        Ok(None) => 0,
+        Err(panic_msg) => fail(&panic_msg),
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Execution: iterative (start / resume)
+// ---------------------------------------------------------------------------
+
+/// Start iterative execution (pauses at external function calls).
 ///
 /// - `out_error`: receives an error message on failure (caller frees).
 ///
@@ -209,6 +800,79 @@ pub unsafe extern "C" fn monty_resume_with_error(
     ffi_progress!(handle, out_error, |h| h.resume_with_error(msg))
 }
 
+/// Resume execution with a return value in the binary value encoding.
+///
+/// - `value`: pointer to the encoded value.
+/// - `len`: byte count.
+/// - `out_error`: receives an error message on failure (caller frees).
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_resume_bin(
+    handle: *mut MontyHandle,
+    value: *const u8,
+    len: usize,
+    out_error: *mut *mut c_char,
+) -> MontyProgressTag {
+    let bytes = match unsafe { parse_bytes(value, len, "value", out_error) } {
+        Ok(b) => b,
+        Err(()) => return MontyProgressTag::Error,
+    };
+    ffi_progress!(handle, out_error, |h| h.resume_bin(bytes))
+}
+
+/// Start iterative execution and return the resulting progress descriptor
+/// in the same call.
+///
+/// - `out_progress` / `out_len`: receive the descriptor described under
+///   `monty_progress_bin` (caller frees with `monty_bytes_free`).
+///   `out_progress` is set to NULL if `handle` is NULL.
+/// - `out_error`: receives an error message on failure (caller frees).
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_start_step(
+    handle: *mut MontyHandle,
+    out_progress: *mut *mut u8,
+    out_len: *mut usize,
+    out_error: *mut *mut c_char,
+) -> MontyProgressTag {
+    if !out_progress.is_null() {
+        unsafe { *out_progress = ptr::null_mut() };
+    }
+    let tag = ffi_progress!(handle, out_error, |h| h.start());
+    unsafe { progress_out(handle, tag, out_progress, out_len) };
+    tag
+}
+
+/// Resume with a binary-encoded return value and return the next progress
+/// descriptor in the same call.
+///
+/// Replaces the `monty_resume_bin` → `monty_pending_*` accessor sequence
+/// with a single crossing per external call.
+///
+/// - `value` / `len`: the encoded return value.
+/// - `out_progress` / `out_len`: receive the descriptor described under
+///   `monty_progress_bin` (caller frees with `monty_bytes_free`).
+///   `out_progress` is set to NULL if `handle` or `value` is NULL.
+/// - `out_error`: receives an error message on failure (caller frees).
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_resume_step(
+    handle: *mut MontyHandle,
+    value: *const u8,
+    len: usize,
+    out_progress: *mut *mut u8,
+    out_len: *mut usize,
+    out_error: *mut *mut c_char,
+) -> MontyProgressTag {
+    if !out_progress.is_null() {
+        unsafe { *out_progress = ptr::null_mut() };
+    }
+    let bytes = match unsafe { parse_bytes(value, len, "value", out_error) } {
+        Ok(b) => b,
+        Err(()) => return MontyProgressTag::Error,
+    };
+    let tag = ffi_progress!(handle, out_error, |h| h.resume_bin(bytes));
+    unsafe { progress_out(handle, tag, out_progress, out_len) };
+    tag
+}
+
 // ---------------------------------------------------------------------------
 // Async / Futures
 // ---------------------------------------------------------------------------
@@ -266,6 +930,34 @@ pub unsafe extern "C" fn monty_resume_futures(
         .resume_futures(results_str, errors_str))
 }
 
+/// Resume futures with binary-encoded results and errors.
+///
+/// - `results`/`results_len`: dict mapping integer call IDs to values.
+/// - `errors`/`errors_len`: dict mapping integer call IDs to error message
+///   strings, or NULL/0 for no errors.
+/// - `out_error`: receives an error message on failure (caller frees).
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_resume_futures_bin(
+    handle: *mut MontyHandle,
+    results: *const u8,
+    results_len: usize,
+    errors: *const u8,
+    errors_len: usize,
+    out_error: *mut *mut c_char,
+) -> MontyProgressTag {
+    let results_bytes = match unsafe { parse_bytes(results, results_len, "results", out_error) } {
+        Ok(b) => b,
+        Err(()) => return MontyProgressTag::Error,
+    };
+    let errors_bytes: &[u8] = if errors.is_null() {
+        &[]
+    } else {
+        unsafe { std::slice::from_raw_parts(errors, errors_len) }
+    };
+    ffi_progress!(handle, out_error, |h| h
+        .resume_futures_bin(results_bytes, errors_bytes))
+}
+
 // ---------------------------------------------------------------------------
 // State accessors
 // ---------------------------------------------------------------------------
@@ -353,6 +1045,80 @@ pub unsafe extern "C" fn monty_complete_result_json(handle: *const MontyHandle)
     }
 }
 
+/// Get the pending function arguments as a binary-encoded list.
+/// Caller frees with `monty_bytes_free`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_pending_fn_args_bin(
+    handle: *const MontyHandle,
+    out_len: *mut usize,
+) -> *mut u8 {
+    if handle.is_null() || out_len.is_null() {
+        return ptr::null_mut();
+    }
+    let h = unsafe { &*handle };
+    unsafe { bytes_out(h.pending_fn_args_bin(), out_len) }
+}
+
+/// Get the pending function keyword arguments as a binary-encoded dict.
+/// Caller frees with `monty_bytes_free`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_pending_fn_kwargs_bin(
+    handle: *const MontyHandle,
+    out_len: *mut usize,
+) -> *mut u8 {
+    if handle.is_null() || out_len.is_null() {
+        return ptr::null_mut();
+    }
+    let h = unsafe { &*handle };
+    unsafe { bytes_out(h.pending_fn_kwargs_bin(), out_len) }
+}
+
+/// Get the completed result envelope in the binary value encoding.
+/// Caller frees with `monty_bytes_free`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_complete_result_bin(
+    handle: *const MontyHandle,
+    out_len: *mut usize,
+) -> *mut u8 {
+    if handle.is_null() || out_len.is_null() {
+        return ptr::null_mut();
+    }
+    let h = unsafe { &*handle };
+    unsafe { bytes_out(h.complete_result_bin(), out_len) }
+}
+
+/// Read the resource usage so far into `out`. Valid in every state,
+/// including while paused at an external call.
+///
+/// Returns 0 on success, -1 if `handle` or `out` is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_usage(handle: *const MontyHandle, out: *mut MontyUsage) -> c_int {
+    if handle.is_null() || out.is_null() {
+        return -1;
+    }
+    let h = unsafe { &*handle };
+    unsafe { *out = h.usage() };
+    0
+}
+
+/// Inspect the live heap and stack of the execution. Valid in every
+/// state, and meant for a handle paused at an external call.
+///
+/// Returns a JSON object with `state`, `heap_bytes`, `peak_heap_bytes`,
+/// `memory_limit`, `live_allocations`, `allocations`, `live_by_size`
+/// (non-empty size classes as `{max_bytes, count}`, `max_bytes` null for
+/// the largest), `stack_depth`, `max_stack_depth`, `stack_limit`,
+/// `time_elapsed_ms`, and `pending` (the paused call's `function_name`,
+/// `call_id`, and `args`/`kwargs` as `{type, len}`, or null). Caller frees
+/// with `monty_string_free`. Returns NULL if `handle` is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_inspect_json(handle: *const MontyHandle) -> *mut c_char {
+    if handle.is_null() {
+        return ptr::null_mut();
+    }
+    to_c_string(&unsafe { &*handle }.inspect_json())
+}
+
 /// Whether the completed result is an error. Returns 1 for error, 0 for success,
 /// -1 if not in Complete state.
 #[unsafe(no_mangle)]
@@ -368,11 +1134,135 @@ pub unsafe extern "C" fn monty_complete_is_error(handle: *const MontyHandle) ->
     }
 }
 
+// ---------------------------------------------------------------------------
+// Result access
+// ---------------------------------------------------------------------------
+
+/// Get part of the completed value as a JSON string, serializing nothing
+/// else.
+///
+/// - `path_json`: JSON array of steps from the value — a string selects a
+///   dict key or dataclass attribute, an integer a list/tuple element
+///   (negative from the end) or an integer dict key. NULL or `[]` selects
+///   the whole value.
+/// - `out_error`: receives an error message on failure (caller frees).
+///
+/// Returns the JSON (caller frees with `monty_string_free`), or NULL if the
+/// handle is not complete or the path does not resolve.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_result_get_path(
+    handle: *const MontyHandle,
+    path_json: *const c_char,
+    out_error: *mut *mut c_char,
+) -> *mut c_char {
+    match unsafe { result_at(handle, path_json, out_error) } {
+        Ok(obj) => to_c_string(&monty_object_to_json(obj).to_string()),
+        Err(()) => ptr::null_mut(),
+    }
+}
+
+/// Get part of the completed value in the binary value encoding.
+///
+/// Arguments match `monty_result_get_path`; `out_len` receives the byte
+/// count. Caller frees with `monty_bytes_free`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_result_get_path_bin(
+    handle: *const MontyHandle,
+    path_json: *const c_char,
+    out_len: *mut usize,
+    out_error: *mut *mut c_char,
+) -> *mut u8 {
+    if out_len.is_null() {
+        return ptr::null_mut();
+    }
+    match unsafe { result_at(handle, path_json, out_error) } {
+        Ok(obj) => unsafe { bytes_out(Some(encode_object(obj)), out_len) },
+        Err(()) => ptr::null_mut(),
+    }
+}
+
+/// Get `value[start:end]` for the list, tuple, str or bytes at `path_json`
+/// as a JSON string.
+///
+/// Bounds follow Python: negative values count from the end and
+/// out-of-range bounds are clamped, so `INT64_MAX` as `end` slices to the
+/// end. Other arguments match `monty_result_get_path`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_result_slice(
+    handle: *const MontyHandle,
+    path_json: *const c_char,
+    start: i64,
+    end: i64,
+    out_error: *mut *mut c_char,
+) -> *mut c_char {
+    match unsafe { result_slice(handle, path_json, start, end, out_error) } {
+        Ok(obj) => to_c_string(&monty_object_to_json(&obj).to_string()),
+        Err(()) => ptr::null_mut(),
+    }
+}
+
+/// Get `value[start:end]` like `monty_result_slice`, in the binary value
+/// encoding. Caller frees with `monty_bytes_free`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_result_slice_bin(
+    handle: *const MontyHandle,
+    path_json: *const c_char,
+    start: i64,
+    end: i64,
+    out_len: *mut usize,
+    out_error: *mut *mut c_char,
+) -> *mut u8 {
+    if out_len.is_null() {
+        return ptr::null_mut();
+    }
+    match unsafe { result_slice(handle, path_json, start, end, out_error) } {
+        Ok(obj) => unsafe { bytes_out(Some(encode_object(&obj)), out_len) },
+        Err(()) => ptr::null_mut(),
+    }
+}
+
+/// `len()` of the part of the completed value at `path_json`.
+///
+/// Returns -1 if the handle is not complete, the path does not resolve,
+/// or the value has no length.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_result_len(
+    handle: *const MontyHandle,
+    path_json: *const c_char,
+) -> i64 {
+    match unsafe { result_at(handle, path_json, ptr::null_mut()) } {
+        Ok(obj) => lookup::len(obj)
+            .and_then(|n| i64::try_from(n).ok())
+            .unwrap_or(-1),
+        Err(()) => -1,
+    }
+}
+
+/// Python type name (`"dict"`, `"list"`, `"int"`, ...) of the part of the
+/// completed value at `path_json`.
+///
+/// Returns NULL if the handle is not complete or the path does not
+/// resolve. Caller frees with `monty_string_free`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_result_type(
+    handle: *const MontyHandle,
+    path_json: *const c_char,
+) -> *mut c_char {
+    match unsafe { result_at(handle, path_json, ptr::null_mut()) } {
+        Ok(obj) => to_c_string(lookup::type_name(obj)),
+        Err(()) => ptr::null_mut(),
+    }
+}
+
 // ---------------------------------------------------------------------------
 // Snapshots
 // ---------------------------------------------------------------------------
 
-/// Serialize the compiled code to a byte buffer. Caller frees with `monty_bytes_free`.
+/// Serialize the handle to a byte buffer. Caller frees with `monty_bytes_free`.
+///
+/// Valid in Ready state (compiled code only) and while paused at an external
+/// call or waiting on futures (the whole in-flight execution). Returns NULL
+/// once complete.
 ///
 /// - `out_len`: receives the byte count.
 ///
@@ -386,20 +1276,17 @@ pub unsafe extern "C" fn monty_snapshot(
         return ptr::null_mut();
     }
     let h = unsafe { &*handle };
-    match h.snapshot() {
-        Ok(bytes) => {
-            let len = bytes.len();
-            let boxed = bytes.into_boxed_slice();
-            let ptr = Box::into_raw(boxed) as *mut u8;
-            unsafe { *out_len = len };
-            ptr
-        }
-        Err(_) => ptr::null_mut(),
-    }
+    unsafe { bytes_out(h.snapshot().ok(), out_len) }
 }
 
 /// Restore a `MontyHandle` from a snapshot byte buffer.
 ///
+/// An in-flight snapshot restores paused; query `monty_progress_state` and
+/// the `monty_pending_*` accessors to see where it stopped. `data` may also
+/// be a snapshot container (as written by `monty_snapshot_file`), e.g. a
+/// region of a caller-owned mmap; it is validated and read in place, and
+/// only borrowed for the duration of the call.
+///
 /// - `data`: pointer to the byte buffer.
 /// - `len`: byte count.
 /// - `out_error`: receives an error message on failure (caller frees).
@@ -430,6 +1317,111 @@ pub unsafe extern "C" fn monty_restore(
     }
 }
 
+/// Write the handle's snapshot to `path` as a snapshot container: a
+/// versioned header with a CRC-32 of the payload.
+///
+/// Valid in the same states as `monty_snapshot`. The file is written to a
+/// temporary sibling and renamed into place.
+///
+/// - `path`: destination file path (UTF-8).
+/// - `out_error`: receives an error message on failure (caller frees).
+///
+/// Returns 0 on success, -1 on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_snapshot_file(
+    handle: *const MontyHandle,
+    path: *const c_char,
+    out_error: *mut *mut c_char,
+) -> c_int {
+    if handle.is_null() {
+        if !out_error.is_null() {
+            unsafe { *out_error = to_c_string("handle is NULL") };
+        }
+        return -1;
+    }
+    let Ok(path) = (unsafe { parse_c_str(path, "path", out_error) }) else {
+        return -1;
+    };
+    let h = unsafe { &*handle };
+    match h.snapshot_to_file(Path::new(path)) {
+        Ok(()) => 0,
+        Err(msg) => {
+            if !out_error.is_null() {
+                unsafe { *out_error = to_c_string(&msg) };
+            }
+            -1
+        }
+    }
+}
+
+/// Restore a `MontyHandle` from a snapshot container file.
+///
+/// The file is memory-mapped on unix and deserialized straight from the
+/// mapping, so no copy of the snapshot is made on the heap; the header
+/// and checksum are verified first. Elsewhere the file is read into
+/// memory.
+///
+/// - `path`: file written by `monty_snapshot_file` (UTF-8).
+/// - `out_error`: receives an error message on failure (caller frees).
+///
+/// Returns a new handle, or NULL on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_restore_file(
+    path: *const c_char,
+    out_error: *mut *mut c_char,
+) -> *mut MontyHandle {
+    let Ok(path) = (unsafe { parse_c_str(path, "path", out_error) }) else {
+        return ptr::null_mut();
+    };
+    match MontyHandle::restore_file(Path::new(path)) {
+        Ok(handle) => Box::into_raw(Box::new(handle)),
+        Err(msg) => {
+            if !out_error.is_null() {
+                unsafe { *out_error = to_c_string(&msg) };
+            }
+            ptr::null_mut()
+        }
+    }
+}
+
+/// Current progress of a handle as one binary-encoded descriptor, so a
+/// caller can read a pending call (name, args, kwargs, call ID, method
+/// flag) in a single crossing. Caller frees with `monty_bytes_free`.
+///
+/// The descriptor is a tuple whose first element is the progress tag:
+///
+/// - `MONTY_PROGRESS_PENDING`: `(1, fn_name, args, kwargs, call_id, method_call)`
+/// - `MONTY_PROGRESS_COMPLETE` / `MONTY_PROGRESS_ERROR`: `(tag, result)`, where
+///   `result` is the `monty_complete_result_bin` envelope
+/// - `MONTY_PROGRESS_RESOLVE_FUTURES`: `(3, call_ids)`
+///
+/// Returns NULL in Ready state or if `handle` or `out_len` is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_progress_bin(
+    handle: *const MontyHandle,
+    out_len: *mut usize,
+) -> *mut u8 {
+    if handle.is_null() || out_len.is_null() {
+        return ptr::null_mut();
+    }
+    let h = unsafe { &*handle };
+    unsafe { bytes_out(h.progress_tag().map(|tag| h.progress_bin(tag)), out_len) }
+}
+
+/// Current progress of a handle, as `monty_start`/`monty_resume` last
+/// reported it.
+///
+/// Returns a `MontyProgressTag` value, or -1 in Ready state or if `handle`
+/// is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_progress_state(handle: *const MontyHandle) -> c_int {
+    if handle.is_null() {
+        return -1;
+    }
+    let h = unsafe { &*handle };
+    h.progress_tag().map_or(-1, |tag| tag as c_int)
+}
+
 // ---------------------------------------------------------------------------
 // Resource limits
 // ---------------------------------------------------------------------------
@@ -458,6 +1450,354 @@ pub unsafe extern "C" fn monty_set_stack_limit(handle: *mut MontyHandle, depth:
     }
 }
 
+// ---------------------------------------------------------------------------
+// Interrupts
+// ---------------------------------------------------------------------------
+
+/// Create a `MontyInterrupt`, a cancellation flag that may be set from any
+/// thread while another thread runs a handle watching it.
+///
+/// The interrupt is reference counted like `MontyProgramCache`: share it
+/// with `monty_interrupt_retain` and release each reference with
+/// `monty_interrupt_free`.
+#[unsafe(no_mangle)]
+pub extern "C" fn monty_interrupt_new() -> *const MontyInterrupt {
+    Arc::into_raw(Arc::new(MontyInterrupt::default()))
+}
+
+/// Take another reference to `interrupt`. Safe to call with NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_interrupt_retain(interrupt: *const MontyInterrupt) {
+    if !interrupt.is_null() {
+        unsafe { Arc::increment_strong_count(interrupt) };
+    }
+}
+
+/// Release one reference to `interrupt`. Safe to call with NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_interrupt_free(interrupt: *const MontyInterrupt) {
+    if !interrupt.is_null() {
+        unsafe { Arc::decrement_strong_count(interrupt) };
+    }
+}
+
+/// Interrupt every execution watching `interrupt`. Thread-safe.
+///
+/// Each one stops at its next time check — also while running inside
+/// `monty_run`/`monty_start`/a resume on another thread — and fails with
+/// a `KeyboardInterrupt`. A paused execution fails when resumed. The flag
+/// stays set, interrupting later executions too, until
+/// `monty_interrupt_clear`. Safe to call with NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_interrupt(interrupt: *const MontyInterrupt) {
+    if !interrupt.is_null() {
+        unsafe { &*interrupt }.set();
+    }
+}
+
+/// Reset `interrupt` so that watching executions run normally again.
+/// Thread-safe. Safe to call with NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_interrupt_clear(interrupt: *const MontyInterrupt) {
+    if !interrupt.is_null() {
+        unsafe { &*interrupt }.clear();
+    }
+}
+
+/// Make `handle` watch `interrupt`, taking its own reference. Pass NULL to
+/// stop watching.
+///
+/// Call it from the thread that owns the handle, between calls. It applies
+/// to the handle's current execution, even while paused, and survives
+/// `monty_reset`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_set_interrupt(
+    handle: *mut MontyHandle,
+    interrupt: *const MontyInterrupt,
+) {
+    if handle.is_null() {
+        return;
+    }
+    let interrupt = (!interrupt.is_null()).then(|| {
+        unsafe { Arc::increment_strong_count(interrupt) };
+        unsafe { Arc::from_raw(interrupt) }
+    });
+    unsafe { &mut *handle }.set_interrupt(interrupt);
+}
+
+// ---------------------------------------------------------------------------
+// Tracing
+// ---------------------------------------------------------------------------
+
+/// Start (`enabled` non-zero) or stop recording trace events on `handle`.
+///
+/// Each event is a span of compile, VM, host-wait or conversion time; see
+/// `monty_trace_json`. Enabling a handle that compiled its own source
+/// records the compile first. Stopping drops events not yet drained, and
+/// `monty_reset` stops tracing. Does nothing if `handle` is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_set_trace(handle: *mut MontyHandle, enabled: c_int) {
+    if !handle.is_null() {
+        unsafe { &mut *handle }.set_trace(enabled != 0);
+    }
+}
+
+/// Drain the trace events recorded since the last call, oldest first.
+///
+/// Returns a JSON array of objects with `kind` (`"compile"`, `"vm"`,
+/// `"host"` or `"convert"`), `op` (the call or conversion, e.g. `"start"`,
+/// `"resume"`, `"args_bin"`), `at_us` (start, in microseconds since the
+/// handle was created or reset), `duration_us`, and for conversions
+/// `bytes`. Caller frees with `monty_string_free`. Returns NULL if tracing
+/// is off or `handle` is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_trace_json(handle: *const MontyHandle) -> *mut c_char {
+    if handle.is_null() {
+        return ptr::null_mut();
+    }
+    match unsafe { &*handle }.take_trace_json() {
+        Some(json) => to_c_string(&json),
+        None => ptr::null_mut(),
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Print output streaming
+// ---------------------------------------------------------------------------
+
+/// Stream print output instead of collecting it into the completion
+/// result's `print_output`. Takes effect from the next run, start, or
+/// resume.
+///
+/// With a `callback`, output is delivered line by line as Python prints
+/// it, on the thread driving the handle; a trailing partial line is
+/// delivered when the VM next pauses or completes. `user_data` is passed
+/// through untouched and must stay valid for as long as the handle can
+/// run. Nothing is retained, so `max_retained_bytes` is ignored.
+///
+/// With a NULL `callback`, output is buffered for `monty_take_output`.
+/// At most the newest `max_retained_bytes` bytes are kept (0 keeps
+/// everything); older output is dropped and reported as a
+/// `[... N bytes dropped]` line.
+///
+/// The stream is not part of snapshots. Does nothing if `handle` is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_set_output_stream(
+    handle: *mut MontyHandle,
+    max_retained_bytes: usize,
+    callback: Option<MontyOutputCallback>,
+    user_data: *mut c_void,
+) {
+    if handle.is_null() {
+        return;
+    }
+    let stream = match callback {
+        Some(callback) => OutputStream::with_callback(callback, user_data),
+        None => OutputStream::buffered(max_retained_bytes),
+    };
+    unsafe { &mut *handle }.set_output_stream(stream);
+}
+
+/// Drain output buffered since the last call (see
+/// `monty_set_output_stream`). Valid in every state.
+///
+/// Returns a NUL-terminated UTF-8 string (caller frees with
+/// `monty_string_free`), or NULL if nothing is buffered.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_take_output(handle: *mut MontyHandle) -> *mut c_char {
+    if handle.is_null() {
+        return ptr::null_mut();
+    }
+    match unsafe { &mut *handle }.take_output() {
+        Some(text) => to_c_string(&text),
+        None => ptr::null_mut(),
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Native host functions
+// ---------------------------------------------------------------------------
+
+/// Register a native host function that the VM calls in-process, without
+/// pausing, whenever Python calls the external function `name`.
+///
+/// `name` must be one of the external functions passed to `monty_create`
+/// (or `monty_program_compile`); calls to other external functions still
+/// pause as usual. `func` runs on the thread driving the handle, and
+/// `user_data` is passed through untouched, so it must stay valid for as
+/// long as the handle can run. Registrations are not part of snapshots;
+/// register again after `monty_restore`.
+///
+/// Returns 0 on success, -1 if `handle`, `name`, or `func` is NULL or
+/// `name` is not valid UTF-8.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_register_native_fn(
+    handle: *mut MontyHandle,
+    name: *const c_char,
+    func: Option<MontyNativeFn>,
+    user_data: *mut c_void,
+) -> c_int {
+    let Some(func) = func else {
+        return -1;
+    };
+    if handle.is_null() {
+        return -1;
+    }
+    let Ok(name) = (unsafe { parse_c_str(name, "name", ptr::null_mut()) }) else {
+        return -1;
+    };
+    let h = unsafe { &mut *handle };
+    h.register_native_fn(name.to_string(), func, user_data);
+    0
+}
+
+/// Return an encoded value from a native function. Only valid inside the
+/// callback that received `result`. Does nothing if either pointer is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_native_result_set_bin(
+    result: *mut MontyNativeResult,
+    value: *const u8,
+    len: usize,
+) {
+    if result.is_null() || value.is_null() {
+        return;
+    }
+    let bytes = unsafe { std::slice::from_raw_parts(value, len) };
+    unsafe { &mut *result }.set_value(bytes);
+}
+
+/// Raise `RuntimeError(message)` in Python from a native function. Only
+/// valid inside the callback that received `result`. Does nothing if
+/// either pointer is NULL or `message` is not valid UTF-8.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_native_result_set_error(
+    result: *mut MontyNativeResult,
+    message: *const c_char,
+) {
+    if result.is_null() {
+        return;
+    }
+    if let Ok(message) = unsafe { parse_c_str(message, "message", ptr::null_mut()) } {
+        unsafe { &mut *result }.set_error(message);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// REPL sessions
+// ---------------------------------------------------------------------------
+
+/// Create a persistent session whose globals survive between
+/// `monty_repl_feed` calls.
+///
+/// - `script_name`: NUL-terminated UTF-8 script name for tracebacks (or NULL for `"<input>"`).
+/// - `out_error`: on failure, receives an error message (caller frees).
+///
+/// Returns a heap-allocated session (free with `monty_repl_free`), or NULL on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_repl_create(
+    script_name: *const c_char,
+    out_error: *mut *mut c_char,
+) -> *mut MontyReplSession {
+    let name = if script_name.is_null() {
+        None
+    } else {
+        match unsafe { parse_c_str(script_name, "script_name", out_error) } {
+            Ok(s) => Some(s.to_string()),
+            Err(()) => return ptr::null_mut(),
+        }
+    };
+    Box::into_raw(Box::new(MontyReplSession::new(name)))
+}
+
+/// Run `code` in the session's namespace. Only the new code is compiled;
+/// variables, functions, and imports from earlier calls stay live in the VM.
+///
+/// Outputs match `monty_run`: `result_json` receives the result envelope
+/// (also on error), `error_msg` the error summary.
+///
+/// Returns `MONTY_RESULT_OK` or `MONTY_RESULT_ERROR`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_repl_feed(
+    session: *mut MontyReplSession,
+    code: *const c_char,
+    result_json: *mut *mut c_char,
+    error_msg: *mut *mut c_char,
+) -> MontyResultTag {
+    if session.is_null() {
+        if !error_msg.is_null() {
+            unsafe { *error_msg = to_c_string("session is NULL") };
+        }
+        return MontyResultTag::Error;
+    }
+    let Ok(code_str) = (unsafe { parse_c_str(code, "code", error_msg) }) else {
+        return MontyResultTag::Error;
+    };
+
+    let s = unsafe { &mut *session };
+    match catch_ffi_panic(|| s.feed(code_str)) {
+        Ok((tag, json, err)) => {
+            if !result_json.is_null() {
+                unsafe { *result_json = to_c_string(&json) };
+            }
+            if !error_msg.is_null() {
+                match err {
+                    Some(ref msg) => unsafe { *error_msg = to_c_string(msg) },
+                    None => unsafe { *error_msg = ptr::null_mut() },
+                }
+            }
+            tag
+        }
+        Err(panic_msg) => {
+            if !error_msg.is_null() {
+                unsafe { *error_msg = to_c_string(&panic_msg) };
+            }
+            MontyResultTag::Error
+        }
+    }
+}
+
+/// Drop all session state; the next feed starts from an empty namespace.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_repl_reset(session: *mut MontyReplSession) {
+    if !session.is_null() {
+        unsafe { &mut *session }.reset();
+    }
+}
+
+/// Set the memory limit in bytes for the session's whole live heap.
+/// Applies from the next feed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_repl_set_memory_limit(session: *mut MontyReplSession, bytes: usize) {
+    if !session.is_null() {
+        unsafe { &mut *session }.set_memory_limit(bytes);
+    }
+}
+
+/// Set the time limit in milliseconds for each feed. Applies from the
+/// next feed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_repl_set_time_limit_ms(session: *mut MontyReplSession, ms: u64) {
+    if !session.is_null() {
+        unsafe { &mut *session }.set_time_limit_ms(ms);
+    }
+}
+
+/// Set the session stack depth limit. Applies from the next feed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_repl_set_stack_limit(session: *mut MontyReplSession, depth: usize) {
+    if !session.is_null() {
+        unsafe { &mut *session }.set_stack_limit(depth);
+    }
+}
+
+/// Free a `MontyReplSession`. Safe to call with NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_repl_free(session: *mut MontyReplSession) {
+    if !session.is_null() {
+        drop(unsafe { Box::from_raw(session) });
+    }
+}
+
 // ---------------------------------------------------------------------------
 // Memory management
 // ---------------------------------------------------------------------------
@@ -470,10 +1810,171 @@ pub unsafe extern "C" fn monty_string_free(ptr: *mut c_char) {
     }
 }
 
-/// Free a byte buffer returned by `monty_snapshot`.
+/// Free a byte buffer returned by `monty_snapshot` or any `*_bin` accessor.
+/// `len` must be the length reported with the buffer.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn monty_bytes_free(ptr: *mut u8, len: usize) {
-    if !ptr.is_null() && len > 0 {
-        drop(unsafe { Box::from_raw(std::ptr::slice_from_raw_parts_mut(ptr, len)) });
+    if !ptr.is_null() {
+        debug_assert_eq!(unsafe { bytes_len(ptr) }, len, "monty_bytes_free length");
+        unsafe { bytes_release(ptr) };
+    }
+}
+
+/// Free a byte buffer like `monty_bytes_free`, from its pointer alone.
+///
+/// `void *` so it can serve as a Dart `NativeFinalizer` for an external
+/// typed list viewing the buffer.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn monty_bytes_release(ptr: *mut c_void) {
+    if !ptr.is_null() {
+        unsafe { bytes_release(ptr.cast()) };
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Byte buffer helpers
+// ---------------------------------------------------------------------------
+
+/// Bytes in front of every buffer from [`bytes_out`], holding its length
+/// so it can be freed from its pointer alone.
+const BYTES_HEADER: usize = 8;
+
+/// Words of the allocation behind a buffer of `len` bytes.
+fn bytes_words(len: usize) -> usize {
+    (BYTES_HEADER + len).div_ceil(8)
+}
+
+/// Hand a byte buffer to the caller, writing its length to `out_len`.
+/// Returns NULL for `None`. The caller frees with `monty_bytes_free` or
+/// `monty_bytes_release`.
+///
+/// The bytes are copied into a `u64` allocation after a length header,
+/// so the buffer starts on an 8-byte boundary: packed arrays aligned to
+/// the start of the encoding can then be viewed in place.
+///
+/// # Safety
+/// `out_len` must be a valid, non-null pointer.
+unsafe fn bytes_out(bytes: Option<Vec<u8>>, out_len: *mut usize) -> *mut u8 {
+    let Some(bytes) = bytes else {
+        return ptr::null_mut();
+    };
+    let len = bytes.len();
+    let mut words = vec![0u64; bytes_words(len)].into_boxed_slice();
+    words[0] = len as u64;
+    let base = Box::into_raw(words).cast::<u8>();
+    // SAFETY: the allocation holds BYTES_HEADER + len bytes.
+    let data = unsafe { base.add(BYTES_HEADER) };
+    unsafe { ptr::copy_nonoverlapping(bytes.as_ptr(), data, len) };
+    unsafe { *out_len = len };
+    data
+}
+
+/// Length of a buffer from [`bytes_out`].
+///
+/// # Safety
+/// `data` must come from [`bytes_out`] and not have been freed.
+unsafe fn bytes_len(data: *const u8) -> usize {
+    unsafe { data.sub(BYTES_HEADER).cast::<u64>().read() as usize }
+}
+
+/// Free a buffer from [`bytes_out`].
+///
+/// # Safety
+/// `data` must come from [`bytes_out`] and not have been freed.
+unsafe fn bytes_release(data: *mut u8) {
+    let words = bytes_words(unsafe { bytes_len(data) });
+    let base = unsafe { data.sub(BYTES_HEADER) }.cast::<u64>();
+    drop(unsafe { Box::from_raw(ptr::slice_from_raw_parts_mut(base, words)) });
+}
+
+/// Write the descriptor for a step that returned `tag` to `out_progress`
+/// and `out_len`. Does nothing if either out-parameter is NULL.
+///
+/// # Safety
+/// `handle` must be a valid, non-null handle.
+unsafe fn progress_out(
+    handle: *const MontyHandle,
+    tag: MontyProgressTag,
+    out_progress: *mut *mut u8,
+    out_len: *mut usize,
+) {
+    if out_progress.is_null() || out_len.is_null() {
+        return;
+    }
+    let h = unsafe { &*handle };
+    let bytes = catch_ffi_panic(|| h.progress_bin(tag)).ok();
+    unsafe { *out_progress = bytes_out(bytes, out_len) };
+}
+
+/// Resolve `path_json` (NULL for the whole value) in the completed value
+/// of `handle`, writing to `out_error` on failure.
+///
+/// # Safety
+/// `handle` must be a valid handle if non-null, and `path_json` a valid
+/// NUL-terminated C string if non-null.
+unsafe fn result_at<'a>(
+    handle: *const MontyHandle,
+    path_json: *const c_char,
+    out_error: *mut *mut c_char,
+) -> Result<&'a MontyObject, ()> {
+    let fail = |msg: &str| {
+        if !out_error.is_null() {
+            unsafe { *out_error = to_c_string(msg) };
+        }
+    };
+    if handle.is_null() {
+        fail("handle is NULL");
+        return Err(());
+    }
+    let path_json = if path_json.is_null() {
+        None
+    } else {
+        Some(unsafe { parse_c_str(path_json, "path_json", out_error) }?)
+    };
+    let h = unsafe { &*handle };
+    let Some(value) = h.complete_value() else {
+        fail("handle is not complete");
+        return Err(());
+    };
+    lookup::parse_path(path_json)
+        .and_then(|path| lookup::resolve(value, &path))
+        .map_err(|msg| fail(&msg))
+}
+
+/// Slice the value at `path_json` like `result_at` resolves it.
+///
+/// # Safety
+/// As for `result_at`.
+unsafe fn result_slice(
+    handle: *const MontyHandle,
+    path_json: *const c_char,
+    start: i64,
+    end: i64,
+    out_error: *mut *mut c_char,
+) -> Result<MontyObject, ()> {
+    let obj = unsafe { result_at(handle, path_json, out_error) }?;
+    lookup::slice(obj, start, end).map_err(|msg| {
+        if !out_error.is_null() {
+            unsafe { *out_error = to_c_string(&msg) };
+        }
+    })
+}
+
+/// Borrow a caller-owned byte buffer, writing to `out_error` if it is NULL.
+///
+/// # Safety
+/// `data` must point to at least `len` readable bytes if non-null.
+unsafe fn parse_bytes<'a>(
+    data: *const u8,
+    len: usize,
+    name: &str,
+    out_error: *mut *mut c_char,
+) -> Result<&'a [u8], ()> {
+    if data.is_null() {
+        if !out_error.is_null() {
+            unsafe { *out_error = to_c_string(&format!("{name} is NULL")) };
+        }
+        return Err(());
     }
+    Ok(unsafe { std::slice::from_raw_parts(data, len) })
 }
@@ -0,0 +1,263 @@
+//! Reading parts of a completed value in place.
+//!
+//! A finished handle keeps its result as a `MontyObject`; the
+//! `monty_result_*` functions walk into it and serialize only the part
+//! asked for, so a host forwarding a few keys of a large structure never
+//! pays to convert the rest.
+//!
+//! A path is a JSON array of steps applied from the result value:
+//!
+//! - a string selects a dict key, or a dataclass attribute
+//! - an integer selects a list or tuple element (negative counts from the
+//!   end), or a dict key equal to that integer
+
+use monty::MontyObject;
+use serde_json::Value;
+
+/// Parse a path; `None` is the empty path (the value itself).
+pub(crate) fn parse_path(path_json: Option<&str>) -> Result<Vec<Value>, String> {
+    let Some(path_json) = path_json else {
+        return Ok(Vec::new());
+    };
+    match serde_json::from_str(path_json) {
+        Ok(Value::Array(steps)) => Ok(steps),
+        Ok(_) => Err("path must be a JSON array".into()),
+        Err(e) => Err(format!("invalid path JSON: {e}")),
+    }
+}
+
+/// Follow `path` from `root`.
+pub(crate) fn resolve<'a>(
+    root: &'a MontyObject,
+    path: &[Value],
+) -> Result<&'a MontyObject, String> {
+    let mut current = root;
+    for step in path {
+        current = match (current, step) {
+            (MontyObject::Dict(pairs) | MontyObject::Dataclass { attrs: pairs, .. }, _) => pairs
+                .into_iter()
+                .find(|(k, _)| key_matches(k, step))
+                .map(|(_, v)| v)
+                .ok_or_else(|| format!("key not found: {step}"))?,
+            (
+                MontyObject::List(items)
+                | MontyObject::Tuple(items)
+                | MontyObject::NamedTuple { values: items, .. },
+                Value::Number(n),
+            ) => {
+                let index = n.as_i64().ok_or_else(|| format!("invalid index: {n}"))?;
+                let at = normalize_index(index, items.len())
+                    .ok_or_else(|| format!("index out of range: {index}"))?;
+                &items[at]
+            }
+            (other, _) => {
+                return Err(format!("cannot index {} with {step}", type_name(other)));
+            }
+        };
+    }
+    Ok(current)
+}
+
+/// Python type name of `obj`, as `type(obj).__name__` would report it for
+/// built-in types.
+pub(crate) fn type_name(obj: &MontyObject) -> &'static str {
+    match obj {
+        MontyObject::None => "NoneType",
+        MontyObject::Bool(_) => "bool",
+        MontyObject::Int(_) | MontyObject::BigInt(_) => "int",
+        MontyObject::Float(_) => "float",
+        MontyObject::String(_) => "str",
+        MontyObject::Bytes(_) => "bytes",
+        MontyObject::List(_) => "list",
+        MontyObject::Tuple(_) => "tuple",
+        MontyObject::NamedTuple { .. } => "namedtuple",
+        MontyObject::Dict(_) => "dict",
+        MontyObject::Set(_) => "set",
+        MontyObject::FrozenSet(_) => "frozenset",
+        MontyObject::Ellipsis => "ellipsis",
+        MontyObject::Path(_) => "Path",
+        MontyObject::Dataclass { .. } => "dataclass",
+        MontyObject::Type(_) => "type",
+        MontyObject::BuiltinFunction(_) => "builtin_function_or_method",
+        MontyObject::Exception { .. } => "exception",
+        MontyObject::Repr(_) | MontyObject::Cycle(..) => "object",
+    }
+}
+
+/// `len(obj)`, or `None` for values without a length.
+pub(crate) fn len(obj: &MontyObject) -> Option<usize> {
+    match obj {
+        MontyObject::String(s) => Some(s.chars().count()),
+        MontyObject::Bytes(bytes) => Some(bytes.len()),
+        MontyObject::List(items)
+        | MontyObject::Tuple(items)
+        | MontyObject::NamedTuple { values: items, .. }
+        | MontyObject::Set(items)
+        | MontyObject::FrozenSet(items) => Some(items.len()),
+        MontyObject::Dict(pairs) => Some(pairs.into_iter().count()),
+        _ => None,
+    }
+}
+
+/// `obj[start:end]` with Python's clamping of out-of-range bounds.
+///
+/// Lists slice to lists, tuples (named or not) to tuples, and strings and
+/// bytes to their own type.
+pub(crate) fn slice(obj: &MontyObject, start: i64, end: i64) -> Result<MontyObject, String> {
+    Ok(match obj {
+        MontyObject::List(items) => {
+            let (s, e) = slice_bounds(items.len(), start, end);
+            MontyObject::List(items[s..e].to_vec())
+        }
+        MontyObject::Tuple(items) | MontyObject::NamedTuple { values: items, .. } => {
+            let (s, e) = slice_bounds(items.len(), start, end);
+            MontyObject::Tuple(items[s..e].to_vec())
+        }
+        MontyObject::Bytes(bytes) => {
+            let (s, e) = slice_bounds(bytes.len(), start, end);
+            MontyObject::Bytes(bytes[s..e].to_vec())
+        }
+        MontyObject::String(text) => {
+            let (s, e) = slice_bounds(text.chars().count(), start, end);
+            MontyObject::String(text.chars().skip(s).take(e - s).collect())
+        }
+        other => return Err(format!("cannot slice {}", type_name(other))),
+    })
+}
+
+fn key_matches(key: &MontyObject, step: &Value) -> bool {
+    match (key, step) {
+        (MontyObject::String(k), Value::String(s)) => k == s,
+        (MontyObject::Int(k), Value::Number(n)) => n.as_i64() == Some(*k),
+        _ => false,
+    }
+}
+
+fn normalize_index(index: i64, len: usize) -> Option<usize> {
+    let len = i64::try_from(len).ok()?;
+    let at = if index < 0 { index + len } else { index };
+    if (0..len).contains(&at) {
+        usize::try_from(at).ok()
+    } else {
+        None
+    }
+}
+
+fn slice_bounds(len: usize, start: i64, end: i64) -> (usize, usize) {
+    let n = i64::try_from(len).unwrap_or(i64::MAX);
+    let clamp = |i: i64| {
+        let i = if i < 0 {
+            i.saturating_add(n).max(0)
+        } else {
+            i.min(n)
+        };
+        // In 0..=len by construction.
+        usize::try_from(i).unwrap_or(len)
+    };
+    let (s, e) = (clamp(start), clamp(end));
+    (s, e.max(s))
+}
+
+#[cfg(test)]
+mod tests {
+    use serde_json::json;
+
+    use super::*;
+
+    fn sample() -> MontyObject {
+        MontyObject::dict(vec![
+            (
+                MontyObject::String("users".into()),
+                MontyObject::List(vec![
+                    MontyObject::dict(vec![(
+                        MontyObject::String("name".into()),
+                        MontyObject::String("ada".into()),
+                    )]),
+                    MontyObject::dict(vec![(
+                        MontyObject::String("name".into()),
+                        MontyObject::String("bob".into()),
+                    )]),
+                ]),
+            ),
+            (MontyObject::Int(7), MontyObject::Bool(true)),
+        ])
+    }
+
+    fn at(path: Value) -> Result<MontyObject, String> {
+        let root = sample();
+        let steps = parse_path(Some(&path.to_string()))?;
+        resolve(&root, &steps).cloned()
+    }
+
+    #[test]
+    fn test_resolve_keys_and_indices() {
+        assert_eq!(
+            at(json!(["users", -1, "name"])).unwrap(),
+            MontyObject::String("bob".into())
+        );
+        assert_eq!(at(json!([7])).unwrap(), MontyObject::Bool(true));
+        assert_eq!(at(json!([])).unwrap(), sample());
+        assert_eq!(
+            resolve(&sample(), &parse_path(None).unwrap()).unwrap(),
+            &sample()
+        );
+    }
+
+    #[test]
+    fn test_resolve_errors() {
+        assert!(
+            at(json!(["missing"]))
+                .unwrap_err()
+                .contains("key not found")
+        );
+        assert!(
+            at(json!(["users", 2]))
+                .unwrap_err()
+                .contains("out of range")
+        );
+        assert!(
+            at(json!(["users", "x"]))
+                .unwrap_err()
+                .contains("cannot index list")
+        );
+        assert!(parse_path(Some("{}")).unwrap_err().contains("JSON array"));
+        assert!(parse_path(Some("[")).unwrap_err().contains("invalid path"));
+    }
+
+    #[test]
+    fn test_len_and_type_name() {
+        let root = sample();
+        assert_eq!(len(&root), Some(2));
+        assert_eq!(type_name(&root), "dict");
+        assert_eq!(len(&MontyObject::String("héllo".into())), Some(5));
+        assert_eq!(len(&MontyObject::Int(1)), None);
+        assert_eq!(type_name(&MontyObject::None), "NoneType");
+    }
+
+    #[test]
+    fn test_slice_clamps_like_python() {
+        let list = MontyObject::List((0..5).map(MontyObject::Int).collect());
+        assert_eq!(
+            slice(&list, 1, 3).unwrap(),
+            MontyObject::List(vec![MontyObject::Int(1), MontyObject::Int(2)])
+        );
+        assert_eq!(
+            slice(&list, -2, i64::MAX).unwrap(),
+            MontyObject::List(vec![MontyObject::Int(3), MontyObject::Int(4)])
+        );
+        assert_eq!(slice(&list, 4, 1).unwrap(), MontyObject::List(vec![]));
+        assert_eq!(
+            slice(&list, i64::MIN, 1).unwrap(),
+            MontyObject::List(vec![MontyObject::Int(0)])
+        );
+        assert_eq!(
+            slice(&MontyObject::String("héllo".into()), 1, 3).unwrap(),
+            MontyObject::String("él".into())
+        );
+        assert!(
+            slice(&MontyObject::Int(1), 0, 1)
+                .unwrap_err()
+                .contains("cannot slice int")
+        );
+    }
+}
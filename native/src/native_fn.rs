@@ -0,0 +1,197 @@
+use std::collections::HashMap;
+use std::ffi::c_void;
+
+use monty::{ExcType, ExternalResult, MontyException, MontyObject};
+
+use crate::binary;
+
+/// Signature of a native host function registered with
+/// `monty_register_native_fn`.
+///
+/// `args` is a binary-encoded list and `kwargs` a binary-encoded dict, both
+/// borrowed for the duration of the call. The callback reports its outcome
+/// through `result`; leaving it untouched returns `None` to Python.
+pub type MontyNativeFn = unsafe extern "C" fn(
+    user_data: *mut c_void,
+    args: *const u8,
+    args_len: usize,
+    kwargs: *const u8,
+    kwargs_len: usize,
+    result: *mut MontyNativeResult,
+);
+
+/// Outcome of one native call, filled in by the callback through
+/// `monty_native_result_set_bin` / `monty_native_result_set_error`.
+#[derive(Default)]
+pub struct MontyNativeResult {
+    outcome: Option<Result<Vec<u8>, String>>,
+}
+
+impl MontyNativeResult {
+    /// Record an encoded return value, replacing any earlier outcome.
+    pub fn set_value(&mut self, value: &[u8]) {
+        self.outcome = Some(Ok(value.to_vec()));
+    }
+
+    /// Record an error message, raised as `RuntimeError` in Python.
+    pub fn set_error(&mut self, message: &str) {
+        self.outcome = Some(Err(message.to_string()));
+    }
+}
+
+/// A registered callback and its opaque user data.
+struct NativeFn {
+    func: MontyNativeFn,
+    user_data: *mut c_void,
+}
+
+/// Native host functions invoked in-process, without pausing the VM.
+///
+/// Looked up by name when the VM yields a `FunctionCall`; a hit is called
+/// directly and its result fed straight back to the VM, so the caller only
+/// sees the calls it did not register.
+#[derive(Default)]
+pub struct NativeFns {
+    fns: HashMap<String, NativeFn>,
+}
+
+// SAFETY: the registering caller guarantees `user_data` may be used from
+// whichever thread drives the handle, as documented on
+// `monty_register_native_fn`.
+unsafe impl Send for NativeFns {}
+
+impl NativeFns {
+    /// Register `func` under `name`, replacing any earlier registration.
+    pub fn register(&mut self, name: String, func: MontyNativeFn, user_data: *mut c_void) {
+        self.fns.insert(name, NativeFn { func, user_data });
+    }
+
+    /// Remove every registration, keeping the map's allocation.
+    pub fn clear(&mut self) {
+        self.fns.clear();
+    }
+
+    /// Whether no native functions are registered.
+    pub fn is_empty(&self) -> bool {
+        self.fns.is_empty()
+    }
+
+    /// Whether a native function is registered as `name`.
+    pub fn contains(&self, name: &str) -> bool {
+        self.fns.contains_key(name)
+    }
+
+    /// Invoke the native function registered as `name`.
+    ///
+    /// Returns `None` if no function has that name.
+    pub fn call(
+        &self,
+        name: &str,
+        args: &[MontyObject],
+        kwargs: &[(MontyObject, MontyObject)],
+    ) -> Option<ExternalResult> {
+        let native = self.fns.get(name)?;
+
+        let mut args_buf = Vec::new();
+        binary::write_list(&mut args_buf, args);
+        let mut kwargs_buf = Vec::new();
+        binary::write_pairs(&mut kwargs_buf, kwargs.iter().map(|(k, v)| (k, v)));
+
+        let mut result = MontyNativeResult::default();
+        unsafe {
+            (native.func)(
+                native.user_data,
+                args_buf.as_ptr(),
+                args_buf.len(),
+                kwargs_buf.as_ptr(),
+                kwargs_buf.len(),
+                &mut result,
+            );
+        }
+
+        Some(match result.outcome {
+            None => ExternalResult::Return(MontyObject::None),
+            Some(Ok(bytes)) => match binary::decode_object(&bytes) {
+                Ok(obj) => ExternalResult::Return(obj),
+                Err(e) => runtime_error(format!(
+                    "native function {name} returned an invalid value: {e}"
+                )),
+            },
+            Some(Err(message)) => runtime_error(message),
+        })
+    }
+}
+
+fn runtime_error(message: String) -> ExternalResult {
+    ExternalResult::Error(MontyException::new(ExcType::RuntimeError, Some(message)))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    unsafe extern "C" fn double_first(
+        _user_data: *mut c_void,
+        args: *const u8,
+        args_len: usize,
+        _kwargs: *const u8,
+        _kwargs_len: usize,
+        result: *mut MontyNativeResult,
+    ) {
+        let args = unsafe { std::slice::from_raw_parts(args, args_len) };
+        let result = unsafe { &mut *result };
+        match binary::decode_object(args) {
+            Ok(MontyObject::List(items)) => match items.first() {
+                Some(MontyObject::Int(n)) => {
+                    result.set_value(&binary::encode_object(&MontyObject::Int(n * 2)));
+                }
+                _ => result.set_error("expected an int"),
+            },
+            _ => result.set_error("bad args"),
+        }
+    }
+
+    unsafe extern "C" fn count_calls(
+        user_data: *mut c_void,
+        _args: *const u8,
+        _args_len: usize,
+        _kwargs: *const u8,
+        _kwargs_len: usize,
+        _result: *mut MontyNativeResult,
+    ) {
+        unsafe { *user_data.cast::<u32>() += 1 };
+    }
+
+    #[test]
+    fn test_call_returns_value() {
+        let mut fns = NativeFns::default();
+        fns.register("double".into(), double_first, std::ptr::null_mut());
+
+        let result = fns.call("double", &[MontyObject::Int(21)], &[]).unwrap();
+        assert!(matches!(
+            result,
+            ExternalResult::Return(MontyObject::Int(42))
+        ));
+    }
+
+    #[test]
+    fn test_call_error_and_unknown() {
+        let mut fns = NativeFns::default();
+        fns.register("double".into(), double_first, std::ptr::null_mut());
+
+        let result = fns.call("double", &[MontyObject::None], &[]).unwrap();
+        assert!(matches!(result, ExternalResult::Error(_)));
+        assert!(fns.call("missing", &[], &[]).is_none());
+    }
+
+    #[test]
+    fn test_untouched_result_is_none_and_user_data_passed() {
+        let mut count = 0u32;
+        let mut fns = NativeFns::default();
+        fns.register("count".into(), count_calls, (&raw mut count).cast());
+
+        let result = fns.call("count", &[], &[]).unwrap();
+        assert!(matches!(result, ExternalResult::Return(MontyObject::None)));
+        assert_eq!(count, 1);
+    }
+}
@@ -0,0 +1,177 @@
+//! Streaming print output.
+//!
+//! By default a handle collects everything Python prints and reports it
+//! once, as `print_output` in the completion result. An [`OutputStream`]
+//! replaces that: output is handed to a C callback line by line as it is
+//! produced, or — without a callback — kept in a bounded buffer that the
+//! host drains with `monty_take_output` whenever it likes.
+
+use std::borrow::Cow;
+use std::ffi::{c_char, c_void};
+
+use monty::{MontyException, PrintWriterCallback};
+
+/// Signature of the callback registered with `monty_set_output_stream`.
+///
+/// `text` is `len` bytes of UTF-8 (not NUL-terminated), borrowed for the
+/// duration of the call. It is normally one line including its trailing
+/// `\n`; output with no newline yet is delivered when the VM next pauses or
+/// completes.
+pub type MontyOutputCallback =
+    unsafe extern "C" fn(user_data: *mut c_void, text: *const c_char, len: usize);
+
+/// Destination for a handle's print output while streaming.
+pub struct OutputStream {
+    callback: Option<(MontyOutputCallback, *mut c_void)>,
+    /// Output not yet delivered: a partial line when there is a callback,
+    /// everything since the last [`Self::take`] when there is not.
+    pending: String,
+    /// Most bytes `pending` may retain without a callback; 0 is unbounded.
+    max_retained: usize,
+    /// Bytes dropped from the front of `pending` to respect `max_retained`.
+    dropped: usize,
+}
+
+// SAFETY: the registering caller guarantees `user_data` may be used from
+// whichever thread drives the handle, as documented on
+// `monty_set_output_stream`.
+unsafe impl Send for OutputStream {}
+
+impl OutputStream {
+    /// Stream to `callback`, called with `user_data` for each line.
+    pub fn with_callback(callback: MontyOutputCallback, user_data: *mut c_void) -> Self {
+        Self {
+            callback: Some((callback, user_data)),
+            pending: String::new(),
+            max_retained: 0,
+            dropped: 0,
+        }
+    }
+
+    /// Buffer output for [`Self::take`], keeping at most the newest
+    /// `max_retained` bytes (0 keeps everything).
+    pub fn buffered(max_retained: usize) -> Self {
+        Self {
+            callback: None,
+            pending: String::new(),
+            max_retained,
+            dropped: 0,
+        }
+    }
+
+    /// Drain buffered output. Returns `None` if there is none.
+    ///
+    /// When older output was discarded to respect the retention limit, the
+    /// result starts with a `[... N bytes dropped]` line.
+    pub fn take(&mut self) -> Option<String> {
+        if self.pending.is_empty() && self.dropped == 0 {
+            return None;
+        }
+        let mut out = std::mem::take(&mut self.pending);
+        if self.dropped > 0 {
+            out.insert_str(0, &format!("[... {} bytes dropped]\n", self.dropped));
+            self.dropped = 0;
+        }
+        Some(out)
+    }
+
+    /// Deliver a trailing partial line to the callback. Called whenever the
+    /// VM returns control to the host.
+    pub fn flush(&mut self) {
+        if self.callback.is_some() && !self.pending.is_empty() {
+            let line = std::mem::take(&mut self.pending);
+            self.emit(&line);
+        }
+    }
+
+    fn emit(&self, text: &str) {
+        if let Some((callback, user_data)) = self.callback {
+            // SAFETY: the caller of `monty_set_output_stream` guarantees the
+            // callback and `user_data` stay valid while the handle runs.
+            unsafe { callback(user_data, text.as_ptr().cast(), text.len()) };
+        }
+    }
+
+    fn push(&mut self, text: &str) {
+        self.pending.push_str(text);
+        if self.callback.is_some() {
+            if let Some(end) = self.pending.rfind('\n') {
+                let rest = self.pending.split_off(end + 1);
+                let lines = std::mem::replace(&mut self.pending, rest);
+                self.emit(&lines);
+            }
+        } else if self.max_retained > 0 && self.pending.len() > self.max_retained {
+            let mut cut = self.pending.len() - self.max_retained;
+            while !self.pending.is_char_boundary(cut) {
+                cut += 1;
+            }
+            self.pending.drain(..cut);
+            self.dropped += cut;
+        }
+    }
+}
+
+impl PrintWriterCallback for OutputStream {
+    fn stdout_write(&mut self, output: Cow<'_, str>) -> Result<(), MontyException> {
+        self.push(&output);
+        Ok(())
+    }
+
+    fn stdout_push(&mut self, end: char) -> Result<(), MontyException> {
+        self.push(end.encode_utf8(&mut [0; 4]));
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_buffered_take_drains() {
+        let mut stream = OutputStream::buffered(0);
+        assert_eq!(stream.take(), None);
+        stream.push("a");
+        stream.push("b\n");
+        assert_eq!(stream.take().as_deref(), Some("ab\n"));
+        assert_eq!(stream.take(), None);
+    }
+
+    #[test]
+    fn test_buffered_cap_drops_oldest() {
+        let mut stream = OutputStream::buffered(4);
+        stream.push("0123");
+        stream.push("45");
+        assert_eq!(
+            stream.take().as_deref(),
+            Some("[... 2 bytes dropped]\n2345")
+        );
+    }
+
+    #[test]
+    fn test_buffered_cap_respects_char_boundaries() {
+        let mut stream = OutputStream::buffered(3);
+        stream.push("aé€");
+        // "aé€" is 1 + 2 + 3 bytes; keeping 3 bytes must not split 'é'.
+        assert_eq!(stream.take().as_deref(), Some("[... 3 bytes dropped]\n€"));
+    }
+
+    unsafe extern "C" fn collect(user_data: *mut c_void, text: *const c_char, len: usize) {
+        let lines = unsafe { &mut *user_data.cast::<Vec<String>>() };
+        let bytes = unsafe { std::slice::from_raw_parts(text.cast::<u8>(), len) };
+        lines.push(String::from_utf8(bytes.to_vec()).unwrap());
+    }
+
+    #[test]
+    fn test_callback_is_line_buffered() {
+        let mut lines: Vec<String> = Vec::new();
+        let mut stream = OutputStream::with_callback(collect, (&raw mut lines).cast());
+        stream.push("one");
+        stream.push("\ntwo\nthr");
+        stream.push("ee");
+        stream.flush();
+        stream.flush();
+        assert_eq!(lines, ["one\ntwo\n", "three"]);
+        assert_eq!(stream.take(), None);
+    }
+}
@@ -0,0 +1,205 @@
+use std::sync::Arc;
+
+use monty::{MontyException, MontyObject, MontyRun};
+
+use crate::handle::{MontyHandle, compile};
+
+/// A compiled Python program that can be instantiated many times.
+///
+/// Parsing and compilation happen once in [`MontyProgram::compile`]. Each
+/// call to [`MontyProgram::instantiate`] clones the compiled `MontyRun`
+/// into a fresh handle in `Ready` state, skipping the parser entirely.
+pub struct MontyProgram {
+    compiled: Arc<MontyRun>,
+    /// Inputs declared at compile time, in the order the VM expects them.
+    input_names: Vec<String>,
+}
+
+impl MontyProgram {
+    /// Compile Python source code into a reusable program.
+    ///
+    /// Arguments match [`MontyHandle::new`].
+    pub fn compile(
+        code: String,
+        external_functions: Vec<String>,
+        script_name: Option<String>,
+    ) -> Result<Self, MontyException> {
+        Self::compile_with_inputs(code, vec![], external_functions, script_name)
+    }
+
+    /// Compile a program that reads `input_names` as global variables,
+    /// supplied per instance by [`MontyProgram::instantiate_with_inputs`].
+    pub fn compile_with_inputs(
+        code: String,
+        input_names: Vec<String>,
+        external_functions: Vec<String>,
+        script_name: Option<String>,
+    ) -> Result<Self, MontyException> {
+        let compiled = compile(code, input_names.clone(), external_functions, script_name)?;
+        Ok(Self {
+            compiled: Arc::new(compiled),
+            input_names,
+        })
+    }
+
+    /// Create a new execution handle from the compiled program.
+    ///
+    /// The handle starts with no resource limits and empty print output,
+    /// exactly like one returned by [`MontyHandle::new`].
+    pub fn instantiate(&self) -> MontyHandle {
+        MontyHandle::from_compiled(MontyRun::clone(&self.compiled))
+    }
+
+    /// Approximate memory held by the compiled program: the size of its
+    /// serialized form.
+    pub fn size_bytes(&self) -> usize {
+        self.dump().map_or(0, |bytes| bytes.len())
+    }
+
+    /// Serialize the compiled program, for [`MontyProgram::load`].
+    pub fn dump(&self) -> Result<Vec<u8>, String> {
+        self.compiled
+            .dump()
+            .map_err(|e| format!("program dump failed: {e}"))
+    }
+
+    /// Rebuild a program from [`MontyProgram::dump`] output, declaring the
+    /// same `input_names` it was compiled with.
+    pub fn load(bytes: &[u8], input_names: Vec<String>) -> Result<Self, String> {
+        let compiled = MontyRun::load(bytes).map_err(|e| format!("program load failed: {e}"))?;
+        Ok(Self {
+            compiled: Arc::new(compiled),
+            input_names,
+        })
+    }
+
+    /// Create a new execution handle with values for the program's inputs.
+    ///
+    /// `inputs` may be in any order but must name every declared input
+    /// exactly once.
+    pub fn instantiate_with_inputs(
+        &self,
+        mut inputs: Vec<(String, MontyObject)>,
+    ) -> Result<MontyHandle, String> {
+        let mut values = Vec::with_capacity(self.input_names.len());
+        for name in &self.input_names {
+            let pos = inputs
+                .iter()
+                .position(|(n, _)| n == name)
+                .ok_or_else(|| format!("missing input: {name}"))?;
+            values.push(inputs.swap_remove(pos).1);
+        }
+        if let Some((name, _)) = inputs.first() {
+            return Err(format!("unknown input: {name}"));
+        }
+        let mut handle = self.instantiate();
+        handle.set_inputs(values);
+        Ok(handle)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use serde_json::Value;
+
+    use super::*;
+    use crate::handle::{MontyProgressTag, MontyResultTag};
+
+    #[test]
+    fn test_compile_syntax_error() {
+        assert!(MontyProgram::compile("def".into(), vec![], None).is_err());
+    }
+
+    #[test]
+    fn test_instantiate_runs_independently() {
+        let program = MontyProgram::compile("2 + 2".into(), vec![], None).unwrap();
+        for _ in 0..3 {
+            let mut handle = program.instantiate();
+            let (tag, result_json, _) = handle.run();
+            assert_eq!(tag, MontyResultTag::Ok);
+            let parsed: Value = serde_json::from_str(&result_json).unwrap();
+            assert_eq!(parsed["value"], 4);
+        }
+    }
+
+    #[test]
+    fn test_instantiate_iterative() {
+        let program =
+            MontyProgram::compile("ext_fn(1) + 1".into(), vec!["ext_fn".into()], None).unwrap();
+
+        let mut first = program.instantiate();
+        let mut second = program.instantiate();
+        assert_eq!(first.start().0, MontyProgressTag::Pending);
+        assert_eq!(second.start().0, MontyProgressTag::Pending);
+
+        assert_eq!(first.resume("10").0, MontyProgressTag::Complete);
+        assert_eq!(second.resume("20").0, MontyProgressTag::Complete);
+
+        let first: Value = serde_json::from_str(first.complete_result_json().unwrap()).unwrap();
+        let second: Value = serde_json::from_str(second.complete_result_json().unwrap()).unwrap();
+        assert_eq!(first["value"], 11);
+        assert_eq!(second["value"], 21);
+    }
+
+    #[test]
+    fn test_instantiate_with_inputs() {
+        let program = MontyProgram::compile_with_inputs(
+            "x * y".into(),
+            vec!["x".into(), "y".into()],
+            vec![],
+            None,
+        )
+        .unwrap();
+        for (x, expected) in [(2, 6), (5, 15)] {
+            let inputs = vec![
+                ("y".into(), MontyObject::Int(3)),
+                ("x".into(), MontyObject::Int(x)),
+            ];
+            let mut handle = program.instantiate_with_inputs(inputs).unwrap();
+            let (tag, result_json, _) = handle.run();
+            assert_eq!(tag, MontyResultTag::Ok);
+            let parsed: Value = serde_json::from_str(&result_json).unwrap();
+            assert_eq!(parsed["value"], expected);
+        }
+    }
+
+    #[test]
+    fn test_dump_load_round_trip() {
+        let program =
+            MontyProgram::compile_with_inputs("x + 1".into(), vec!["x".into()], vec![], None)
+                .unwrap();
+        let loaded = MontyProgram::load(&program.dump().unwrap(), vec!["x".into()]).unwrap();
+        let mut handle = loaded
+            .instantiate_with_inputs(vec![("x".into(), MontyObject::Int(41))])
+            .unwrap();
+        let (tag, result_json, _) = handle.run();
+        assert_eq!(tag, MontyResultTag::Ok);
+        let parsed: Value = serde_json::from_str(&result_json).unwrap();
+        assert_eq!(parsed["value"], 42);
+    }
+
+    #[test]
+    fn test_instantiate_with_inputs_checks_names() {
+        let program =
+            MontyProgram::compile_with_inputs("x".into(), vec!["x".into()], vec![], None).unwrap();
+        let err = program.instantiate_with_inputs(vec![]).err().unwrap();
+        assert_eq!(err, "missing input: x");
+
+        let inputs = vec![
+            ("x".into(), MontyObject::Int(1)),
+            ("z".into(), MontyObject::Int(2)),
+        ];
+        let err = program.instantiate_with_inputs(inputs).err().unwrap();
+        assert_eq!(err, "unknown input: z");
+    }
+
+    #[test]
+    fn test_instantiate_keeps_script_name() {
+        let program = MontyProgram::compile("1/0".into(), vec![], Some("rule.py".into())).unwrap();
+        let mut handle = program.instantiate();
+        let (tag, result_json, _) = handle.run();
+        assert_eq!(tag, MontyResultTag::Error);
+        let parsed: Value = serde_json::from_str(&result_json).unwrap();
+        assert_eq!(parsed["error"]["filename"], "rule.py");
+    }
+}
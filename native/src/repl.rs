@@ -0,0 +1,325 @@
+//! Persistent sessions backed by monty's REPL.
+//!
+//! A [`MontyReplSession`] keeps one `MontyRepl` — heap and global namespace —
+//! alive between calls. Each [`MontyReplSession::feed`] compiles and runs only
+//! the new snippet against the existing namespace, so the cost of a call
+//! does not grow with the amount of state the session has accumulated.
+//!
+//! Limits are enforced per feed: before each feed the session swaps a
+//! fresh `LimitedTracker` into the REPL's [`FeedTracker`], so the time
+//! budget runs from the start of that feed and limits changed between
+//! feeds take effect on the live session.
+
+use std::cell::RefCell;
+use std::rc::Rc;
+use std::sync::Arc;
+use std::time::Duration;
+
+use monty::{
+    LimitedTracker, MontyObject, MontyRepl, PrintWriter, ResourceError, ResourceLimits,
+    ResourceTracker,
+};
+
+use crate::convert::monty_object_to_json;
+use crate::error::monty_exception_to_json;
+use crate::handle::{MontyResultTag, build_result_json};
+use crate::tracker::{Meter, MeteredTracker};
+
+/// Opaque session exposed to C callers.
+pub struct MontyReplSession {
+    repl: Option<MontyRepl<MeteredTracker<FeedTracker>>>,
+    script_name: String,
+    limits: ResourceLimits,
+    meter: Arc<Meter>,
+    tracker: FeedTracker,
+}
+
+/// The limits of a session's REPL, shared between the session and the
+/// tracker moved into the REPL so the session can renew them per feed.
+///
+/// Only touched by the thread feeding the session.
+#[derive(Debug, Clone, Default)]
+struct FeedTracker(Rc<RefCell<Option<LimitedTracker>>>);
+
+impl FeedTracker {
+    /// Enforce `limits` from now on, with a time budget starting now.
+    /// `live_bytes` is the heap the session already holds, charged to the
+    /// new tracker so the memory limit keeps covering the whole session.
+    fn renew(&self, limits: &ResourceLimits, live_bytes: usize) {
+        let mut tracker = LimitedTracker::new(limits.clone());
+        if live_bytes > 0 {
+            // Over a lowered limit already: the next allocation fails.
+            let _ = tracker.on_allocate(|| live_bytes);
+        }
+        *self.0.borrow_mut() = Some(tracker);
+    }
+}
+
+impl ResourceTracker for FeedTracker {
+    fn on_allocate(&mut self, get_size: impl FnOnce() -> usize) -> Result<(), ResourceError> {
+        match self.0.borrow_mut().as_mut() {
+            Some(tracker) => tracker.on_allocate(get_size),
+            None => Ok(()),
+        }
+    }
+
+    fn on_free(&mut self, get_size: impl FnOnce() -> usize) {
+        if let Some(tracker) = self.0.borrow_mut().as_mut() {
+            tracker.on_free(get_size);
+        }
+    }
+
+    fn check_time(&self) -> Result<(), ResourceError> {
+        self.0
+            .borrow()
+            .as_ref()
+            .map_or(Ok(()), LimitedTracker::check_time)
+    }
+
+    fn check_recursion_depth(&self, depth: usize) -> Result<(), ResourceError> {
+        self.0
+            .borrow()
+            .as_ref()
+            .map_or(Ok(()), |tracker| tracker.check_recursion_depth(depth))
+    }
+
+    fn check_large_result(&self, estimated_bytes: usize) -> Result<(), ResourceError> {
+        self.0.borrow().as_ref().map_or(Ok(()), |tracker| {
+            tracker.check_large_result(estimated_bytes)
+        })
+    }
+}
+
+impl MontyReplSession {
+    /// Create an empty session. The REPL itself is started by the first
+    /// [`Self::feed`].
+    ///
+    /// `script_name` sets the filename used in tracebacks; `None` defaults
+    /// to `"<input>"`.
+    pub fn new(script_name: Option<String>) -> Self {
+        Self {
+            repl: None,
+            script_name: script_name.unwrap_or_else(|| "<input>".into()),
+            limits: ResourceLimits::new(),
+            meter: Arc::default(),
+            tracker: FeedTracker::default(),
+        }
+    }
+
+    /// Run `code` in the session's namespace.
+    ///
+    /// Returns `(result_tag, result_json, error_msg)` like
+    /// `MontyHandle::run`. The `usage` in the result covers this call only;
+    /// `memory_bytes_used` is the session's peak live heap during it. The
+    /// time limit, if any, applies to this call alone.
+    pub fn feed(&mut self, code: &str) -> (MontyResultTag, String, Option<String>) {
+        let mut print = PrintWriter::Collect(String::new());
+        self.meter.restart();
+        self.tracker
+            .renew(&self.limits, self.meter.heap().heap_bytes);
+        let meter = Arc::clone(&self.meter);
+
+        let result = meter.time(|| {
+            let repl = match self.repl.take() {
+                Some(repl) => repl,
+                None => {
+                    let tracker =
+                        MeteredTracker::new(self.tracker.clone(), Arc::clone(&self.meter));
+                    // Start on an empty snippet and feed `code` like any
+                    // other, so a first feed that raises keeps the REPL.
+                    MontyRepl::new(
+                        String::new(),
+                        &self.script_name,
+                        vec![],
+                        vec![],
+                        vec![],
+                        tracker,
+                        &mut print,
+                    )?
+                    .0
+                }
+            };
+            self.repl.insert(repl).feed(code, &mut print)
+        });
+
+        let print_output = match print {
+            PrintWriter::Collect(collected) => collected,
+            _ => String::new(),
+        };
+        let usage = self.meter.usage();
+        match result {
+            Ok(obj) => {
+                let json =
+                    build_result_json(monty_object_to_json(&obj), None, usage, &print_output);
+                (MontyResultTag::Ok, json, None)
+            }
+            Err(exc) => {
+                let msg = exc.summary();
+                let json = build_result_json(
+                    monty_object_to_json(&MontyObject::None),
+                    Some(monty_exception_to_json(&exc)),
+                    usage,
+                    &print_output,
+                );
+                (MontyResultTag::Error, json, Some(msg))
+            }
+        }
+    }
+
+    /// Drop all session state. The next [`Self::feed`] starts a fresh REPL.
+    pub fn reset(&mut self) {
+        self.repl = None;
+        self.meter = Arc::default();
+        self.tracker = FeedTracker::default();
+    }
+
+    /// Whether the session holds a live REPL.
+    pub fn is_started(&self) -> bool {
+        self.repl.is_some()
+    }
+
+    /// Set the memory limit in bytes, for the session's whole live heap.
+    /// Takes effect from the next feed.
+    pub fn set_memory_limit(&mut self, bytes: usize) {
+        self.limits.max_memory = Some(bytes);
+    }
+
+    /// Set the time limit in milliseconds for each feed. Takes effect
+    /// from the next feed.
+    pub fn set_time_limit_ms(&mut self, ms: u64) {
+        self.limits.max_duration = Some(Duration::from_millis(ms));
+    }
+
+    /// Set the stack depth limit. Takes effect from the next feed.
+    pub fn set_stack_limit(&mut self, depth: usize) {
+        self.limits.max_recursion_depth = Some(depth);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use serde_json::{Value, json};
+
+    use super::*;
+
+    fn result_value(json: &str) -> Value {
+        serde_json::from_str::<Value>(json).unwrap()["value"].clone()
+    }
+
+    #[test]
+    fn test_globals_persist_between_feeds() {
+        let mut session = MontyReplSession::new(None);
+        let (tag, _, _) = session.feed("x = 40");
+        assert_eq!(tag, MontyResultTag::Ok);
+        let (tag, result, _) = session.feed("x + 2");
+        assert_eq!(tag, MontyResultTag::Ok);
+        assert_eq!(result_value(&result), json!(42));
+    }
+
+    #[test]
+    fn test_functions_persist_between_feeds() {
+        let mut session = MontyReplSession::new(None);
+        session.feed("def double(n):\n    return n * 2");
+        let (_, result, _) = session.feed("double(21)");
+        assert_eq!(result_value(&result), json!(42));
+    }
+
+    #[test]
+    fn test_error_keeps_session_state() {
+        let mut session = MontyReplSession::new(None);
+        session.feed("x = 1");
+        let (tag, result, err) = session.feed("1 / 0");
+        assert_eq!(tag, MontyResultTag::Error);
+        assert!(err.unwrap().contains("ZeroDivisionError"));
+        let parsed: Value = serde_json::from_str(&result).unwrap();
+        assert_eq!(parsed["error"]["exc_type"], "ZeroDivisionError");
+
+        let (_, result, _) = session.feed("x");
+        assert_eq!(result_value(&result), json!(1));
+    }
+
+    #[test]
+    fn test_print_output_is_per_feed() {
+        let mut session = MontyReplSession::new(None);
+        let (_, result, _) = session.feed("print('a')");
+        let parsed: Value = serde_json::from_str(&result).unwrap();
+        assert_eq!(parsed["print_output"], "a\n");
+        let (_, result, _) = session.feed("1");
+        let parsed: Value = serde_json::from_str(&result).unwrap();
+        assert!(parsed.get("print_output").is_none());
+    }
+
+    #[test]
+    fn test_reset_clears_state() {
+        let mut session = MontyReplSession::new(None);
+        session.feed("x = 1");
+        assert!(session.is_started());
+        session.reset();
+        assert!(!session.is_started());
+        let (tag, _, err) = session.feed("x");
+        assert_eq!(tag, MontyResultTag::Error);
+        assert!(err.unwrap().contains("NameError"));
+    }
+
+    #[test]
+    fn test_script_name_in_traceback() {
+        let mut session = MontyReplSession::new(Some("session.py".into()));
+        let (_, result, _) = session.feed("raise ValueError('x')");
+        let parsed: Value = serde_json::from_str(&result).unwrap();
+        assert_eq!(parsed["error"]["traceback"][0]["filename"], "session.py");
+    }
+
+    #[test]
+    fn test_memory_limit_applies() {
+        let mut session = MontyReplSession::new(None);
+        session.set_memory_limit(1024);
+        let (tag, _, _) = session.feed("x = [i for i in range(100000)]");
+        assert_eq!(tag, MontyResultTag::Error);
+    }
+
+    #[test]
+    fn test_first_feed_error_keeps_session() {
+        let mut session = MontyReplSession::new(None);
+        let (tag, _, _) = session.feed("x = 1\nraise ValueError('x')");
+        assert_eq!(tag, MontyResultTag::Error);
+        assert!(session.is_started());
+        let (tag, result, _) = session.feed("x");
+        assert_eq!(tag, MontyResultTag::Ok);
+        assert_eq!(result_value(&result), json!(1));
+    }
+
+    #[test]
+    fn test_time_limit_is_per_feed() {
+        let mut session = MontyReplSession::new(None);
+        session.set_time_limit_ms(200);
+        session.feed("x = 1");
+        std::thread::sleep(Duration::from_millis(300));
+        let (tag, result, _) = session.feed("x + 1");
+        assert_eq!(tag, MontyResultTag::Ok, "{result}");
+        assert_eq!(result_value(&result), json!(2));
+    }
+
+    #[test]
+    fn test_limits_apply_to_live_session() {
+        let mut session = MontyReplSession::new(None);
+        session.feed("def down(n):\n    return 0 if n == 0 else down(n - 1)");
+        let (tag, _, _) = session.feed("down(50)");
+        assert_eq!(tag, MontyResultTag::Ok);
+
+        session.set_stack_limit(10);
+        let (tag, _, _) = session.feed("down(50)");
+        assert_eq!(tag, MontyResultTag::Error);
+        let (_, result, _) = session.feed("down(3)");
+        assert_eq!(result_value(&result), json!(0));
+    }
+
+    #[test]
+    fn test_memory_limit_counts_existing_heap() {
+        let mut session = MontyReplSession::new(None);
+        let (tag, _, _) = session.feed("keep = [i for i in range(10000)]");
+        assert_eq!(tag, MontyResultTag::Ok);
+        session.set_memory_limit(1024);
+        let (tag, _, _) = session.feed("more = [0]");
+        assert_eq!(tag, MontyResultTag::Error);
+    }
+}
@@ -0,0 +1,271 @@
+//! On-disk snapshot container and zero-copy file mapping.
+//!
+//! A container wraps the bytes of [`crate::MontyHandle::snapshot`] in a
+//! fixed header so a file can be validated before it is deserialized:
+//!
+//! | offset | size | field                                   |
+//! |--------|------|-----------------------------------------|
+//! | 0      | 8    | magic `MONTYSNP`                        |
+//! | 8      | 2    | container version (u16 LE), currently 1 |
+//! | 10     | 2    | flags (u16 LE), reserved, must be 0     |
+//! | 12     | 4    | CRC-32 (IEEE) of the payload (u32 LE)   |
+//! | 16     | 8    | payload length (u64 LE)                 |
+//! | 24     | ..   | payload                                 |
+
+use std::fs::File;
+use std::path::Path;
+use std::sync::atomic::{AtomicU64, Ordering};
+
+/// Leading bytes of every snapshot container.
+pub const CONTAINER_MAGIC: &[u8; 8] = b"MONTYSNP";
+/// Container version written by [`encode`].
+const CONTAINER_VERSION: u16 = 1;
+/// Size of the fixed header preceding the payload.
+const HEADER_LEN: usize = 24;
+
+/// Wrap snapshot `payload` in a container.
+pub fn encode(payload: &[u8]) -> Vec<u8> {
+    let mut buf = Vec::with_capacity(HEADER_LEN + payload.len());
+    buf.extend_from_slice(CONTAINER_MAGIC);
+    buf.extend_from_slice(&CONTAINER_VERSION.to_le_bytes());
+    buf.extend_from_slice(&0u16.to_le_bytes());
+    buf.extend_from_slice(&crc32(payload).to_le_bytes());
+    buf.extend_from_slice(&(payload.len() as u64).to_le_bytes());
+    buf.extend_from_slice(payload);
+    buf
+}
+
+/// Whether `bytes` starts with [`CONTAINER_MAGIC`].
+pub fn is_container(bytes: &[u8]) -> bool {
+    bytes.starts_with(CONTAINER_MAGIC)
+}
+
+/// Validate a container and borrow its payload.
+pub fn decode(bytes: &[u8]) -> Result<&[u8], String> {
+    let header = bytes
+        .get(..HEADER_LEN)
+        .filter(|h| h.starts_with(CONTAINER_MAGIC))
+        .ok_or("restore failed: not a snapshot container")?;
+    let version = u16::from_le_bytes([header[8], header[9]]);
+    if version != CONTAINER_VERSION {
+        return Err(format!(
+            "restore failed: unsupported container version {version}"
+        ));
+    }
+    let flags = u16::from_le_bytes([header[10], header[11]]);
+    if flags != 0 {
+        return Err(format!(
+            "restore failed: unsupported container flags {flags:#x}"
+        ));
+    }
+    let crc = u32::from_le_bytes(header[12..16].try_into().unwrap());
+    let len = u64::from_le_bytes(header[16..24].try_into().unwrap());
+
+    let payload = &bytes[HEADER_LEN..];
+    if payload.len() as u64 != len {
+        return Err(format!(
+            "restore failed: container payload is {} bytes, header says {len}",
+            payload.len()
+        ));
+    }
+    if crc32(payload) != crc {
+        return Err("restore failed: container checksum mismatch".into());
+    }
+    Ok(payload)
+}
+
+/// Write `payload` to `path` as a container.
+///
+/// Writes to a sibling temporary file and renames it into place, so a
+/// reader never maps a half-written snapshot. The temporary name is unique
+/// per process and call, so concurrent writers of the same path (threads,
+/// or processes sharing a directory) do not clobber each other mid-write.
+pub fn write(path: &Path, payload: &[u8]) -> Result<(), String> {
+    static NEXT_TMP: AtomicU64 = AtomicU64::new(0);
+
+    let mut tmp = path.as_os_str().to_owned();
+    tmp.push(format!(
+        ".{}.{}.tmp",
+        std::process::id(),
+        NEXT_TMP.fetch_add(1, Ordering::Relaxed)
+    ));
+    let written = std::fs::write(&tmp, encode(payload)).and_then(|()| std::fs::rename(&tmp, path));
+    if written.is_err() {
+        let _ = std::fs::remove_file(&tmp);
+    }
+    written.map_err(|e| format!("snapshot write failed: {e}"))
+}
+
+/// A read-only view of a whole file.
+///
+/// On unix this is a private `mmap`, so restoring from it reads the
+/// snapshot straight out of the page cache rather than copying it into a
+/// heap buffer first. Elsewhere (including WASI) the file is read into
+/// memory.
+pub struct MappedFile {
+    #[cfg(unix)]
+    ptr: *mut libc::c_void,
+    #[cfg(unix)]
+    len: usize,
+    #[cfg(not(unix))]
+    bytes: Vec<u8>,
+}
+
+impl MappedFile {
+    /// Map the file at `path`.
+    #[cfg(unix)]
+    pub fn open(path: &Path) -> Result<Self, String> {
+        use std::os::fd::AsRawFd;
+
+        let file = File::open(path).map_err(|e| format!("restore failed: {e}"))?;
+        let len = file
+            .metadata()
+            .map_err(|e| format!("restore failed: {e}"))?
+            .len() as usize;
+        if len == 0 {
+            // mmap rejects zero-length mappings.
+            return Ok(Self {
+                ptr: std::ptr::null_mut(),
+                len,
+            });
+        }
+        // SAFETY: mapping a file we just opened, read-only and private; the
+        // mapping outlives `file`, which is allowed by POSIX.
+        let ptr = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(),
+                len,
+                libc::PROT_READ,
+                libc::MAP_PRIVATE,
+                file.as_raw_fd(),
+                0,
+            )
+        };
+        if ptr == libc::MAP_FAILED {
+            return Err(format!(
+                "restore failed: mmap: {}",
+                std::io::Error::last_os_error()
+            ));
+        }
+        Ok(Self { ptr, len })
+    }
+
+    /// Read the file at `path`.
+    #[cfg(not(unix))]
+    pub fn open(path: &Path) -> Result<Self, String> {
+        use std::io::Read;
+
+        let mut bytes = Vec::new();
+        File::open(path)
+            .and_then(|mut f| f.read_to_end(&mut bytes))
+            .map_err(|e| format!("restore failed: {e}"))?;
+        Ok(Self { bytes })
+    }
+
+    /// The file's contents.
+    pub fn bytes(&self) -> &[u8] {
+        #[cfg(unix)]
+        {
+            if self.ptr.is_null() {
+                return &[];
+            }
+            // SAFETY: `ptr` maps `len` readable bytes until `drop`.
+            unsafe { std::slice::from_raw_parts(self.ptr.cast(), self.len) }
+        }
+        #[cfg(not(unix))]
+        {
+            &self.bytes
+        }
+    }
+}
+
+#[cfg(unix)]
+impl Drop for MappedFile {
+    fn drop(&mut self) {
+        if !self.ptr.is_null() {
+            // SAFETY: `ptr`/`len` came from a successful `mmap`.
+            unsafe { libc::munmap(self.ptr, self.len) };
+        }
+    }
+}
+
+/// CRC-32 (IEEE 802.3, reflected, as used by zlib and PNG).
+fn crc32(data: &[u8]) -> u32 {
+    const TABLE: [u32; 256] = {
+        let mut table = [0u32; 256];
+        let mut i = 0;
+        while i < 256 {
+            let mut c = i as u32;
+            let mut k = 0;
+            while k < 8 {
+                c = if c & 1 != 0 {
+                    0xEDB8_8320 ^ (c >> 1)
+                } else {
+                    c >> 1
+                };
+                k += 1;
+            }
+            table[i] = c;
+            i += 1;
+        }
+        table
+    };
+
+    !data.iter().fold(!0u32, |crc, &b| {
+        TABLE[((crc ^ b as u32) & 0xFF) as usize] ^ (crc >> 8)
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_crc32_check_value() {
+        assert_eq!(crc32(b"123456789"), 0xCBF4_3926);
+        assert_eq!(crc32(b""), 0);
+    }
+
+    #[test]
+    fn test_encode_decode_round_trip() {
+        let bytes = encode(b"payload");
+        assert!(is_container(&bytes));
+        assert_eq!(bytes.len(), HEADER_LEN + 7);
+        assert_eq!(decode(&bytes).unwrap(), b"payload");
+    }
+
+    #[test]
+    fn test_decode_rejects_corruption() {
+        let good = encode(b"payload");
+
+        let mut flipped = good.clone();
+        *flipped.last_mut().unwrap() ^= 1;
+        assert!(decode(&flipped).unwrap_err().contains("checksum"));
+
+        assert!(
+            decode(&good[..good.len() - 1])
+                .unwrap_err()
+                .contains("header says")
+        );
+
+        let mut version = good.clone();
+        version[8] = 9;
+        assert!(decode(&version).unwrap_err().contains("version 9"));
+
+        assert!(decode(b"MONTYSNP").is_err());
+        assert!(decode(b"not a container at all!!").is_err());
+    }
+
+    #[test]
+    fn test_write_and_map() {
+        let path = std::env::temp_dir().join(format!("monty_snap_{}.bin", std::process::id()));
+        write(&path, b"mapped payload").unwrap();
+
+        let mapped = MappedFile::open(&path).unwrap();
+        assert_eq!(decode(mapped.bytes()).unwrap(), b"mapped payload");
+        drop(mapped);
+        std::fs::remove_file(&path).unwrap();
+
+        assert!(MappedFile::open(&path).is_err());
+    }
+}
@@ -0,0 +1,190 @@
+//! Optional per-handle latency tracing.
+//!
+//! With tracing enabled (`monty_set_trace`) a handle records a
+//! [`TraceEvent`] for each stretch of work it does: compiling, each VM
+//! segment of a run/start/resume, the host's wait between a pause and the
+//! next resume, and every value conversion with the bytes it produced or
+//! consumed. The host drains them as JSON with `monty_trace_json`, so it
+//! can tell whether a slow request went on Python, conversion, or the
+//! host. Disabled, every instrumented path costs a `None` check.
+
+use std::cell::{Cell, RefCell};
+use std::time::{Duration, Instant};
+
+use serde_json::{Value, json};
+
+/// What a [`TraceEvent`] measured.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(crate) enum TraceKind {
+    /// Compiling the source, when the handle compiled it itself.
+    Compile,
+    /// Running inside the VM; `op` names the call that ran it.
+    Vm,
+    /// Paused, waiting for the host to resume.
+    Host,
+    /// Converting values to or from JSON or the binary encoding.
+    Convert,
+}
+
+impl TraceKind {
+    fn name(self) -> &'static str {
+        match self {
+            Self::Compile => "compile",
+            Self::Vm => "vm",
+            Self::Host => "host",
+            Self::Convert => "convert",
+        }
+    }
+}
+
+/// One timed span.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub(crate) struct TraceEvent {
+    pub kind: TraceKind,
+    pub op: &'static str,
+    /// Start, relative to the trace's origin.
+    pub at: Duration,
+    pub duration: Duration,
+    /// Bytes converted; 0 for non-conversion events.
+    pub bytes: usize,
+}
+
+impl TraceEvent {
+    fn to_json(&self) -> Value {
+        let mut event = json!({
+            "kind": self.kind.name(),
+            "op": self.op,
+            "at_us": micros(self.at),
+            "duration_us": micros(self.duration),
+        });
+        if self.kind == TraceKind::Convert {
+            event["bytes"] = json!(self.bytes);
+        }
+        event
+    }
+}
+
+/// Events recorded by one handle, in start order.
+pub(crate) struct Trace {
+    origin: Instant,
+    events: RefCell<Vec<TraceEvent>>,
+    /// When the VM last paused for the host, until the next resume.
+    paused_at: Cell<Option<Instant>>,
+}
+
+impl Trace {
+    /// A trace whose event times are relative to `origin`.
+    pub(crate) fn new(origin: Instant) -> Self {
+        Self {
+            origin,
+            events: RefCell::new(Vec::new()),
+            paused_at: Cell::new(None),
+        }
+    }
+
+    /// Record a span from `started` to now.
+    pub(crate) fn record(&self, kind: TraceKind, op: &'static str, started: Instant, bytes: usize) {
+        self.push(kind, op, started, started.elapsed(), bytes);
+    }
+
+    /// Record a span of known `duration` that began at `started`.
+    pub(crate) fn push(
+        &self,
+        kind: TraceKind,
+        op: &'static str,
+        started: Instant,
+        duration: Duration,
+        bytes: usize,
+    ) {
+        self.events.borrow_mut().push(TraceEvent {
+            kind,
+            op,
+            at: started.saturating_duration_since(self.origin),
+            duration,
+            bytes,
+        });
+    }
+
+    /// Note that the VM has paused for the host.
+    pub(crate) fn paused(&self) {
+        self.paused_at.set(Some(Instant::now()));
+    }
+
+    /// Close the host wait opened by [`Self::paused`], if any, as an event
+    /// for `op`.
+    pub(crate) fn resumed(&self, op: &'static str) {
+        if let Some(started) = self.paused_at.take() {
+            self.record(TraceKind::Host, op, started, 0);
+        }
+    }
+
+    /// Move the recorded events out, oldest first.
+    pub(crate) fn take(&self) -> Vec<TraceEvent> {
+        std::mem::take(&mut *self.events.borrow_mut())
+    }
+
+    /// Drain the recorded events as a JSON array.
+    pub(crate) fn take_json(&self) -> String {
+        let events: Vec<Value> = self.take().iter().map(TraceEvent::to_json).collect();
+        Value::Array(events).to_string()
+    }
+}
+
+fn micros(d: Duration) -> u64 {
+    u64::try_from(d.as_micros()).unwrap_or(u64::MAX)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_take_drains_in_order() {
+        let trace = Trace::new(Instant::now());
+        trace.record(TraceKind::Vm, "start", Instant::now(), 0);
+        trace.record(TraceKind::Convert, "args_json", Instant::now(), 12);
+        let events = trace.take();
+        assert_eq!(events.len(), 2);
+        assert_eq!(events[0].kind, TraceKind::Vm);
+        assert_eq!(events[1].bytes, 12);
+        assert!(trace.take().is_empty());
+    }
+
+    #[test]
+    fn test_host_wait_spans_pause_to_resume() {
+        let trace = Trace::new(Instant::now());
+        trace.resumed("resume");
+        assert!(trace.take().is_empty(), "no pause, no wait");
+
+        trace.paused();
+        std::thread::sleep(Duration::from_millis(2));
+        trace.resumed("resume");
+        trace.resumed("resume");
+        let events = trace.take();
+        assert_eq!(events.len(), 1);
+        assert_eq!(events[0].kind, TraceKind::Host);
+        assert!(events[0].duration >= Duration::from_millis(2));
+    }
+
+    #[test]
+    fn test_json_shape() {
+        let origin = Instant::now();
+        let trace = Trace::new(origin);
+        trace.push(
+            TraceKind::Compile,
+            "compile",
+            origin,
+            Duration::from_micros(40),
+            0,
+        );
+        trace.push(TraceKind::Convert, "result_bin", origin, Duration::ZERO, 9);
+        let parsed: Value = serde_json::from_str(&trace.take_json()).unwrap();
+        assert_eq!(
+            parsed,
+            json!([
+                {"kind": "compile", "op": "compile", "at_us": 0, "duration_us": 40},
+                {"kind": "convert", "op": "result_bin", "at_us": 0, "duration_us": 0, "bytes": 9},
+            ])
+        );
+    }
+}
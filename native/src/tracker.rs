@@ -0,0 +1,578 @@
+//! Resource metering for executions.
+//!
+//! [`MeteredTracker`] wraps a monty `ResourceTracker` (limited or not) and
+//! records what the VM actually used into a shared [`Meter`]. The meter is
+//! held by both the tracker (moved into the VM/snapshot) and the handle, so
+//! usage can be read at any point — including while paused at an external
+//! call — without touching the VM.
+//!
+//! When a paused execution is snapshotted, the tracker serializes its inner
+//! tracker plus the meter's counters. On restore the counters are loaded into
+//! the meter installed with [`restore_into`], so the restored handle and its
+//! tracker share one meter again.
+//!
+//! A meter can also watch a [`MontyInterrupt`]: once the interrupt is set,
+//! the tracker's next time check fails, from whichever thread set it.
+
+use std::cell::RefCell;
+use std::sync::Arc;
+use std::sync::atomic::{AtomicBool, AtomicIsize, AtomicPtr, AtomicU64, AtomicUsize, Ordering};
+use std::time::{Duration, Instant};
+
+use monty::{ResourceError, ResourceTracker};
+use serde::{Deserialize, Deserializer, Serialize, Serializer};
+use serde_json::{Value, json};
+
+/// Resource usage reported in the `usage` key of every result and by
+/// `monty_usage`.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub(crate) struct ResourceUsage {
+    /// Peak live heap bytes.
+    pub memory_bytes_used: usize,
+    /// Wall time spent inside the VM, excluding time paused at external calls.
+    pub time_elapsed_ms: u64,
+    /// Deepest recursion depth reached.
+    pub stack_depth_used: usize,
+    /// Number of heap allocations.
+    pub allocations: usize,
+    /// Thread CPU time spent inside the VM, if the platform reports it.
+    pub cpu_time_ms: Option<u64>,
+}
+
+impl ResourceUsage {
+    pub(crate) fn to_json(self) -> Value {
+        json!({
+            "memory_bytes_used": self.memory_bytes_used,
+            "time_elapsed_ms": self.time_elapsed_ms,
+            "stack_depth_used": self.stack_depth_used,
+            "allocations": self.allocations,
+            "cpu_time_ms": self.cpu_time_ms,
+        })
+    }
+}
+
+/// Resource usage as returned by `monty_usage` — matches `MontyUsage` in
+/// the C header.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct MontyUsage {
+    pub memory_bytes_used: usize,
+    pub time_elapsed_ms: u64,
+    pub stack_depth_used: usize,
+    pub allocations: usize,
+    /// `-1` when the platform does not report thread CPU time.
+    pub cpu_time_ms: i64,
+}
+
+impl From<ResourceUsage> for MontyUsage {
+    fn from(usage: ResourceUsage) -> Self {
+        Self {
+            memory_bytes_used: usage.memory_bytes_used,
+            time_elapsed_ms: usage.time_elapsed_ms,
+            stack_depth_used: usage.stack_depth_used,
+            allocations: usage.allocations,
+            cpu_time_ms: usage
+                .cpu_time_ms
+                .map_or(-1, |ms| i64::try_from(ms).unwrap_or(i64::MAX)),
+        }
+    }
+}
+
+/// Cancellation flag for executions, set from any thread.
+///
+/// Opaque to C callers (`MontyInterrupt` in the header). Once set, every
+/// execution watching it stops at its next time check with a
+/// `KeyboardInterrupt`, and it stays set until cleared.
+#[derive(Debug, Default)]
+pub struct MontyInterrupt(AtomicBool);
+
+impl MontyInterrupt {
+    /// Request that watching executions stop.
+    pub(crate) fn set(&self) {
+        // Nothing else is published through the flag, so relaxed suffices;
+        // the VM sees it within a few time checks at most.
+        self.0.store(true, Ordering::Relaxed);
+    }
+
+    /// Let watching executions run again.
+    pub(crate) fn clear(&self) {
+        self.0.store(false, Ordering::Relaxed);
+    }
+
+    pub(crate) fn is_set(&self) -> bool {
+        self.0.load(Ordering::Relaxed)
+    }
+}
+
+/// Size classes of [`HeapStats::live_by_size`]: up to 16 bytes, then
+/// each power of two up to 16 KiB, then everything larger.
+pub(crate) const SIZE_CLASSES: usize = 12;
+
+/// Live heap and stack as of the last VM step, for `monty_inspect_json`.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub(crate) struct HeapStats {
+    /// Live heap bytes.
+    pub heap_bytes: usize,
+    /// Peak live heap bytes, as in [`ResourceUsage`].
+    pub peak_heap_bytes: usize,
+    /// Allocations not yet freed.
+    pub live_allocations: usize,
+    /// Live allocations per size class, smallest first.
+    pub live_by_size: [usize; SIZE_CLASSES],
+    /// Recursion depth at the last depth check, i.e. where the VM stopped.
+    pub stack_depth: usize,
+    /// Deepest recursion depth reached.
+    pub max_stack_depth: usize,
+}
+
+impl HeapStats {
+    /// Largest allocation counted in size class `class`, or `None` for the
+    /// last, unbounded class.
+    pub(crate) fn class_max_bytes(class: usize) -> Option<usize> {
+        (class + 1 < SIZE_CLASSES).then(|| 16 << class)
+    }
+}
+
+/// Counters shared between a [`MeteredTracker`] and its handle.
+///
+/// Written only by the thread driving the VM, so relaxed ordering suffices.
+#[derive(Debug, Default)]
+pub(crate) struct Meter {
+    current_memory: AtomicUsize,
+    peak_memory: AtomicUsize,
+    allocations: AtomicUsize,
+    max_depth: AtomicUsize,
+    vm_time_us: AtomicU64,
+    cpu_time_us: AtomicU64,
+    /// Live allocation counts, overall and per size class. Signed so a
+    /// free of something allocated before the meter was attached (e.g.
+    /// before a restore) can go below zero without a compare loop; reads
+    /// clamp at zero. Not part of snapshots.
+    live_allocations: AtomicIsize,
+    live_by_size: [AtomicIsize; SIZE_CLASSES],
+    /// Depth passed to the last recursion check. Not part of snapshots.
+    depth: AtomicUsize,
+    /// Interrupt checked with every time check; null when none.
+    interrupt: AtomicPtr<MontyInterrupt>,
+}
+
+impl Meter {
+    /// Check `interrupt` from now on, including in trackers already paused
+    /// against this meter. `None` stops checking.
+    ///
+    /// The caller keeps `interrupt` alive for as long as it is watched, and
+    /// only swaps it from the thread driving the VM.
+    pub(crate) fn watch(&self, interrupt: Option<&Arc<MontyInterrupt>>) {
+        let ptr = interrupt.map_or(std::ptr::null_mut(), |i| Arc::as_ptr(i).cast_mut());
+        self.interrupt.store(ptr, Ordering::Relaxed);
+    }
+
+    /// Whether the watched interrupt, if any, is set.
+    pub(crate) fn interrupted(&self) -> bool {
+        let ptr = self.interrupt.load(Ordering::Relaxed);
+        // SAFETY: a non-null pointer is kept alive by whoever called
+        // `watch` (see there).
+        !ptr.is_null() && unsafe { (*ptr).is_set() }
+    }
+
+    /// Run one VM step, adding its wall and CPU time to the meter.
+    pub(crate) fn time<R>(&self, f: impl FnOnce() -> R) -> R {
+        let wall = Instant::now();
+        let cpu = thread_cpu_time_us();
+        let result = f();
+        let elapsed = u64::try_from(wall.elapsed().as_micros()).unwrap_or(u64::MAX);
+        self.vm_time_us.fetch_add(elapsed, Ordering::Relaxed);
+        if let (Some(before), Some(after)) = (cpu, thread_cpu_time_us()) {
+            self.cpu_time_us
+                .fetch_add(after.saturating_sub(before), Ordering::Relaxed);
+        }
+        result
+    }
+
+    /// Start a new accounting period: zero every counter except live
+    /// memory, which carries over as the new peak baseline.
+    pub(crate) fn restart(&self) {
+        let current = self.current_memory.load(Ordering::Relaxed);
+        self.peak_memory.store(current, Ordering::Relaxed);
+        self.allocations.store(0, Ordering::Relaxed);
+        self.max_depth.store(0, Ordering::Relaxed);
+        self.vm_time_us.store(0, Ordering::Relaxed);
+        self.cpu_time_us.store(0, Ordering::Relaxed);
+    }
+
+    /// Snapshot the counters.
+    pub(crate) fn usage(&self) -> ResourceUsage {
+        ResourceUsage {
+            memory_bytes_used: self.peak_memory.load(Ordering::Relaxed),
+            time_elapsed_ms: self.vm_time_us.load(Ordering::Relaxed) / 1000,
+            stack_depth_used: self.max_depth.load(Ordering::Relaxed),
+            allocations: self.allocations.load(Ordering::Relaxed),
+            cpu_time_ms: cfg!(unix).then(|| self.cpu_time_us.load(Ordering::Relaxed) / 1000),
+        }
+    }
+
+    /// Snapshot the live heap and stack counters.
+    pub(crate) fn heap(&self) -> HeapStats {
+        let live =
+            |count: &AtomicIsize| usize::try_from(count.load(Ordering::Relaxed)).unwrap_or(0);
+        HeapStats {
+            heap_bytes: self.current_memory.load(Ordering::Relaxed),
+            peak_heap_bytes: self.peak_memory.load(Ordering::Relaxed),
+            live_allocations: live(&self.live_allocations),
+            live_by_size: std::array::from_fn(|class| live(&self.live_by_size[class])),
+            stack_depth: self.depth.load(Ordering::Relaxed),
+            max_stack_depth: self.max_depth.load(Ordering::Relaxed),
+        }
+    }
+
+    fn counters(&self) -> MeterCounters {
+        MeterCounters {
+            current_memory: self.current_memory.load(Ordering::Relaxed),
+            peak_memory: self.peak_memory.load(Ordering::Relaxed),
+            allocations: self.allocations.load(Ordering::Relaxed),
+            max_depth: self.max_depth.load(Ordering::Relaxed),
+            vm_time_us: self.vm_time_us.load(Ordering::Relaxed),
+            cpu_time_us: self.cpu_time_us.load(Ordering::Relaxed),
+        }
+    }
+
+    fn load(&self, counters: &MeterCounters) {
+        self.current_memory
+            .store(counters.current_memory, Ordering::Relaxed);
+        self.peak_memory
+            .store(counters.peak_memory, Ordering::Relaxed);
+        self.allocations
+            .store(counters.allocations, Ordering::Relaxed);
+        self.max_depth.store(counters.max_depth, Ordering::Relaxed);
+        self.vm_time_us
+            .store(counters.vm_time_us, Ordering::Relaxed);
+        self.cpu_time_us
+            .store(counters.cpu_time_us, Ordering::Relaxed);
+    }
+}
+
+/// Serialized form of a [`Meter`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Serialize, Deserialize)]
+struct MeterCounters {
+    current_memory: usize,
+    peak_memory: usize,
+    allocations: usize,
+    max_depth: usize,
+    vm_time_us: u64,
+    cpu_time_us: u64,
+}
+
+thread_local! {
+    /// Meter that deserialized [`MeteredTracker`]s attach to.
+    static RESTORE_METER: RefCell<Option<Arc<Meter>>> = const { RefCell::new(None) };
+}
+
+/// Run `f` (a deserialization) so that every `MeteredTracker` it produces
+/// records into `meter`.
+pub(crate) fn restore_into<R>(meter: &Arc<Meter>, f: impl FnOnce() -> R) -> R {
+    let previous = RESTORE_METER.with(|m| m.replace(Some(Arc::clone(meter))));
+    let result = f();
+    RESTORE_METER.with(|m| *m.borrow_mut() = previous);
+    result
+}
+
+/// A `ResourceTracker` that forwards every check to `inner` and records
+/// usage into a shared [`Meter`].
+#[derive(Debug)]
+pub(crate) struct MeteredTracker<T> {
+    inner: T,
+    meter: Arc<Meter>,
+}
+
+impl<T: ResourceTracker> MeteredTracker<T> {
+    pub(crate) fn new(inner: T, meter: Arc<Meter>) -> Self {
+        Self { inner, meter }
+    }
+}
+
+#[derive(Serialize)]
+struct SavedTrackerRef<'a, T> {
+    inner: &'a T,
+    meter: MeterCounters,
+}
+
+#[derive(Deserialize)]
+struct SavedTracker<T> {
+    inner: T,
+    meter: MeterCounters,
+}
+
+impl<T: Serialize> Serialize for MeteredTracker<T> {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        SavedTrackerRef {
+            inner: &self.inner,
+            meter: self.meter.counters(),
+        }
+        .serialize(serializer)
+    }
+}
+
+impl<'de, T: Deserialize<'de>> Deserialize<'de> for MeteredTracker<T> {
+    fn deserialize<D: Deserializer<'de>>(deserializer: D) -> Result<Self, D::Error> {
+        let saved = SavedTracker::<T>::deserialize(deserializer)?;
+        let meter = RESTORE_METER
+            .with(|m| m.borrow().clone())
+            .unwrap_or_default();
+        meter.load(&saved.meter);
+        Ok(Self {
+            inner: saved.inner,
+            meter,
+        })
+    }
+}
+
+impl<T: ResourceTracker> ResourceTracker for MeteredTracker<T> {
+    fn on_allocate(&mut self, get_size: impl FnOnce() -> usize) -> Result<(), ResourceError> {
+        let size = get_size();
+        self.inner.on_allocate(|| size)?;
+        let meter = &self.meter;
+        meter.allocations.fetch_add(1, Ordering::Relaxed);
+        meter.live_allocations.fetch_add(1, Ordering::Relaxed);
+        meter.live_by_size[size_class(size)].fetch_add(1, Ordering::Relaxed);
+        let current = meter.current_memory.fetch_add(size, Ordering::Relaxed) + size;
+        meter.peak_memory.fetch_max(current, Ordering::Relaxed);
+        Ok(())
+    }
+
+    fn on_free(&mut self, get_size: impl FnOnce() -> usize) {
+        let size = get_size();
+        self.inner.on_free(|| size);
+        // Saturate rather than wrap if the VM frees something allocated
+        // before this tracker was attached.
+        let _ = self.meter.current_memory.fetch_update(
+            Ordering::Relaxed,
+            Ordering::Relaxed,
+            |current| Some(current.saturating_sub(size)),
+        );
+        self.meter.live_allocations.fetch_sub(1, Ordering::Relaxed);
+        self.meter.live_by_size[size_class(size)].fetch_sub(1, Ordering::Relaxed);
+    }
+
+    fn check_time(&self) -> Result<(), ResourceError> {
+        if self.meter.interrupted() {
+            // Reported as a timeout by the VM; the handle rewrites it as a
+            // KeyboardInterrupt once the VM has unwound.
+            let elapsed = self.meter.vm_time_us.load(Ordering::Relaxed);
+            return Err(ResourceError::Time {
+                limit: Duration::ZERO,
+                elapsed: Duration::from_micros(elapsed),
+            });
+        }
+        self.inner.check_time()
+    }
+
+    fn check_recursion_depth(&self, depth: usize) -> Result<(), ResourceError> {
+        self.meter.max_depth.fetch_max(depth, Ordering::Relaxed);
+        self.meter.depth.store(depth, Ordering::Relaxed);
+        self.inner.check_recursion_depth(depth)
+    }
+
+    fn check_large_result(&self, estimated_bytes: usize) -> Result<(), ResourceError> {
+        self.inner.check_large_result(estimated_bytes)
+    }
+}
+
+/// Index into [`Meter::live_by_size`] for an allocation of `size` bytes.
+fn size_class(size: usize) -> usize {
+    let bits = usize::BITS - size.saturating_sub(1).leading_zeros();
+    (bits.saturating_sub(4) as usize).min(SIZE_CLASSES - 1)
+}
+
+/// CPU time consumed by the calling thread, in microseconds.
+#[cfg(unix)]
+fn thread_cpu_time_us() -> Option<u64> {
+    let mut ts = libc::timespec {
+        tv_sec: 0,
+        tv_nsec: 0,
+    };
+    // SAFETY: `ts` is a valid, writable timespec.
+    let rc = unsafe { libc::clock_gettime(libc::CLOCK_THREAD_CPUTIME_ID, &mut ts) };
+    if rc != 0 {
+        return None;
+    }
+    let secs = u64::try_from(ts.tv_sec).ok()?;
+    let nanos = u64::try_from(ts.tv_nsec).ok()?;
+    Some(secs * 1_000_000 + nanos / 1000)
+}
+
+/// CPU time is not available on this platform.
+#[cfg(not(unix))]
+fn thread_cpu_time_us() -> Option<u64> {
+    None
+}
+
+#[cfg(test)]
+mod tests {
+    use monty::NoLimitTracker;
+
+    use super::*;
+
+    #[test]
+    fn test_tracks_peak_memory_and_allocations() {
+        let meter = Arc::new(Meter::default());
+        let mut tracker = MeteredTracker::new(NoLimitTracker, Arc::clone(&meter));
+        tracker.on_allocate(|| 100).unwrap();
+        tracker.on_allocate(|| 50).unwrap();
+        tracker.on_free(|| 100);
+        tracker.on_allocate(|| 20).unwrap();
+
+        let usage = meter.usage();
+        assert_eq!(usage.memory_bytes_used, 150);
+        assert_eq!(usage.allocations, 3);
+    }
+
+    #[test]
+    fn test_restart_keeps_live_memory() {
+        let meter = Arc::new(Meter::default());
+        let mut tracker = MeteredTracker::new(NoLimitTracker, Arc::clone(&meter));
+        tracker.on_allocate(|| 100).unwrap();
+        tracker.on_allocate(|| 50).unwrap();
+        tracker.on_free(|| 50);
+        meter.restart();
+
+        let usage = meter.usage();
+        assert_eq!(usage.memory_bytes_used, 100);
+        assert_eq!(usage.allocations, 0);
+    }
+
+    #[test]
+    fn test_free_saturates() {
+        let meter = Arc::new(Meter::default());
+        let mut tracker = MeteredTracker::new(NoLimitTracker, Arc::clone(&meter));
+        tracker.on_free(|| 10);
+        tracker.on_allocate(|| 5).unwrap();
+        assert_eq!(meter.usage().memory_bytes_used, 5);
+    }
+
+    #[test]
+    fn test_tracks_max_depth() {
+        let meter = Arc::new(Meter::default());
+        let tracker = MeteredTracker::new(NoLimitTracker, Arc::clone(&meter));
+        tracker.check_recursion_depth(3).unwrap();
+        tracker.check_recursion_depth(7).unwrap();
+        tracker.check_recursion_depth(2).unwrap();
+        assert_eq!(meter.usage().stack_depth_used, 7);
+    }
+
+    #[test]
+    fn test_heap_counts_live_allocations_by_size() {
+        let meter = Arc::new(Meter::default());
+        let mut tracker = MeteredTracker::new(NoLimitTracker, Arc::clone(&meter));
+        tracker.on_allocate(|| 8).unwrap();
+        tracker.on_allocate(|| 16).unwrap();
+        tracker.on_allocate(|| 17).unwrap();
+        tracker.on_allocate(|| 1 << 20).unwrap();
+        tracker.on_free(|| 8);
+        tracker.check_recursion_depth(5).unwrap();
+        tracker.check_recursion_depth(2).unwrap();
+
+        let heap = meter.heap();
+        assert_eq!(heap.heap_bytes, 16 + 17 + (1 << 20));
+        assert_eq!(heap.live_allocations, 3);
+        assert_eq!(heap.live_by_size[0], 1);
+        assert_eq!(heap.live_by_size[1], 1);
+        assert_eq!(heap.live_by_size[SIZE_CLASSES - 1], 1);
+        assert_eq!((heap.stack_depth, heap.max_stack_depth), (2, 5));
+    }
+
+    #[test]
+    fn test_live_counts_clamp_at_zero() {
+        let meter = Arc::new(Meter::default());
+        let mut tracker = MeteredTracker::new(NoLimitTracker, Arc::clone(&meter));
+        tracker.on_free(|| 32);
+        let heap = meter.heap();
+        assert_eq!(heap.live_allocations, 0);
+        assert_eq!(heap.live_by_size[1], 0);
+    }
+
+    #[test]
+    fn test_size_classes() {
+        assert_eq!(size_class(0), 0);
+        assert_eq!(size_class(16), 0);
+        assert_eq!(size_class(32), 1);
+        assert_eq!(size_class(16 << 10), SIZE_CLASSES - 2);
+        assert_eq!(size_class(usize::MAX), SIZE_CLASSES - 1);
+        assert_eq!(HeapStats::class_max_bytes(0), Some(16));
+        assert_eq!(HeapStats::class_max_bytes(SIZE_CLASSES - 1), None);
+    }
+
+    #[test]
+    fn test_time_accumulates() {
+        let meter = Meter::default();
+        let value = meter.time(|| {
+            std::thread::sleep(std::time::Duration::from_millis(5));
+            42
+        });
+        assert_eq!(value, 42);
+        assert!(meter.usage().time_elapsed_ms >= 5);
+    }
+
+    #[cfg(unix)]
+    #[test]
+    fn test_cpu_time_reported_on_unix() {
+        assert!(Meter::default().usage().cpu_time_ms.is_some());
+    }
+
+    #[test]
+    fn test_serde_round_trip_restores_into_meter() {
+        let meter = Arc::new(Meter::default());
+        let mut tracker = MeteredTracker::new(NoLimitTracker, Arc::clone(&meter));
+        tracker.on_allocate(|| 64).unwrap();
+        tracker.check_recursion_depth(4).unwrap();
+        let bytes = postcard::to_allocvec(&tracker).unwrap();
+
+        let restored_meter = Arc::new(Meter::default());
+        let restored: MeteredTracker<NoLimitTracker> =
+            restore_into(&restored_meter, || postcard::from_bytes(&bytes)).unwrap();
+
+        assert!(Arc::ptr_eq(&restored.meter, &restored_meter));
+        assert_eq!(restored_meter.usage(), meter.usage());
+    }
+
+    #[test]
+    fn test_interrupt_fails_time_check() {
+        let meter = Arc::new(Meter::default());
+        let tracker = MeteredTracker::new(NoLimitTracker, Arc::clone(&meter));
+        let interrupt = Arc::new(MontyInterrupt::default());
+        meter.watch(Some(&interrupt));
+        assert!(tracker.check_time().is_ok());
+
+        interrupt.set();
+        assert!(tracker.check_time().is_err());
+
+        interrupt.clear();
+        assert!(tracker.check_time().is_ok());
+    }
+
+    #[test]
+    fn test_unwatched_interrupt_is_ignored() {
+        let meter = Arc::new(Meter::default());
+        let tracker = MeteredTracker::new(NoLimitTracker, Arc::clone(&meter));
+        let interrupt = Arc::new(MontyInterrupt::default());
+        interrupt.set();
+        assert!(tracker.check_time().is_ok());
+
+        meter.watch(Some(&interrupt));
+        meter.watch(None);
+        assert!(tracker.check_time().is_ok());
+    }
+
+    #[test]
+    fn test_usage_json_keys() {
+        let json = ResourceUsage::default().to_json();
+        for key in [
+            "memory_bytes_used",
+            "time_elapsed_ms",
+            "stack_depth_used",
+            "allocations",
+            "cpu_time_ms",
+        ] {
+            assert!(json.get(key).is_some(), "missing {key}");
+        }
+    }
+}
@@ -1,4 +1,4 @@
-use std::ffi::{CStr, CString, c_char};
+use std::ffi::{CStr, CString, c_char, c_int};
 use std::ptr;
 
 use dart_monty_native::*;
@@ -165,8 +165,9 @@ fn null_safety() {
     // monty_string_free with NULL
     unsafe { monty_string_free(ptr::null_mut()) };
 
-    // monty_bytes_free with NULL
+    // monty_bytes_free / monty_bytes_release with NULL
     unsafe { monty_bytes_free(ptr::null_mut(), 0) };
+    unsafe { monty_bytes_release(ptr::null_mut()) };
 }
 
 // ---------------------------------------------------------------------------
@@ -1331,3 +1332,1602 @@ fn async_gather_via_ffi() {
     }
     unsafe { monty_free(handle) };
 }
+
+// ---------------------------------------------------------------------------
+// FFI Boundary: Compiled programs (compile once → instantiate many)
+// ---------------------------------------------------------------------------
+
+#[test]
+fn program_compile_instantiate_run_via_ffi() {
+    let code = c("x = ext_fn(1)\nx * 2");
+    let ext_fns = c("ext_fn");
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let program = unsafe {
+        monty_program_compile(code.as_ptr(), ext_fns.as_ptr(), ptr::null(), &mut out_error)
+    };
+    assert!(!program.is_null(), "monty_program_compile returned NULL");
+
+    for value in [5, 21] {
+        let handle = unsafe { monty_program_instantiate(program, &mut out_error) };
+        assert!(!handle.is_null());
+
+        let tag = unsafe { monty_start(handle, &mut out_error) };
+        assert_eq!(tag, MontyProgressTag::Pending);
+
+        let value_json = CString::new(value.to_string()).unwrap();
+        let tag = unsafe { monty_resume(handle, value_json.as_ptr(), &mut out_error) };
+        assert_eq!(tag, MontyProgressTag::Complete);
+
+        let result_str = unsafe { read_c_string(monty_complete_result_json(handle)) };
+        let result: serde_json::Value = serde_json::from_str(&result_str).unwrap();
+        assert_eq!(result["value"], value * 2);
+
+        unsafe { monty_free(handle) };
+    }
+
+    unsafe { monty_program_free(program) };
+}
+
+#[test]
+fn program_handle_outlives_program_via_ffi() {
+    let code = c("40 + 2");
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let program =
+        unsafe { monty_program_compile(code.as_ptr(), ptr::null(), ptr::null(), &mut out_error) };
+    assert!(!program.is_null());
+    let handle = unsafe { monty_program_instantiate(program, &mut out_error) };
+    assert!(!handle.is_null());
+    unsafe { monty_program_free(program) };
+
+    let mut result_json: *mut c_char = ptr::null_mut();
+    let mut error_msg: *mut c_char = ptr::null_mut();
+    let tag = unsafe { monty_run(handle, &mut result_json, &mut error_msg) };
+    assert_eq!(tag, MontyResultTag::Ok);
+    let parsed: serde_json::Value =
+        serde_json::from_str(&unsafe { read_c_string(result_json) }).unwrap();
+    assert_eq!(parsed["value"], 42);
+
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn program_null_safety_via_ffi() {
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let program =
+        unsafe { monty_program_compile(ptr::null(), ptr::null(), ptr::null(), &mut out_error) };
+    assert!(program.is_null());
+    assert_eq!(unsafe { read_c_string(out_error) }, "code is NULL");
+
+    let mut out_error: *mut c_char = ptr::null_mut();
+    let handle = unsafe { monty_program_instantiate(ptr::null(), &mut out_error) };
+    assert!(handle.is_null());
+    assert_eq!(unsafe { read_c_string(out_error) }, "program is NULL");
+
+    unsafe { monty_program_free(ptr::null_mut()) };
+}
+
+#[test]
+fn program_compile_syntax_error_via_ffi() {
+    let code = c("def");
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let program =
+        unsafe { monty_program_compile(code.as_ptr(), ptr::null(), ptr::null(), &mut out_error) };
+    assert!(program.is_null());
+    assert!(!unsafe { read_c_string(out_error) }.is_empty());
+}
+
+// ---------------------------------------------------------------------------
+// FFI Boundary: Binary value transport
+// ---------------------------------------------------------------------------
+
+unsafe fn read_bytes(ptr: *mut u8, len: usize) -> Vec<u8> {
+    assert!(!ptr.is_null(), "unexpected NULL buffer");
+    let bytes = unsafe { std::slice::from_raw_parts(ptr, len) }.to_vec();
+    unsafe { monty_bytes_free(ptr, len) };
+    bytes
+}
+
+#[test]
+fn binary_buffers_are_aligned_and_released_by_pointer_via_ffi() {
+    let code = c("[1, 2, 3]");
+    let handle = unsafe { monty_create(code.as_ptr(), ptr::null(), ptr::null(), ptr::null_mut()) };
+    let tag = unsafe { monty_run(handle, ptr::null_mut(), ptr::null_mut()) };
+    assert_eq!(tag, MontyResultTag::Ok);
+
+    let mut len = 0usize;
+    let buf = unsafe { monty_complete_result_bin(handle, &mut len) };
+    assert!(!buf.is_null());
+    assert_eq!(buf as usize % 8, 0, "buffer starts on an 8-byte boundary");
+    assert!(len > 0);
+    unsafe { monty_bytes_release(buf.cast()) };
+    unsafe { monty_free(handle) };
+}
+
+fn envelope_get<'a>(envelope: &'a MontyObject, key: &str) -> Option<&'a MontyObject> {
+    let MontyObject::Dict(pairs) = envelope else {
+        panic!("expected dict envelope, got {envelope:?}");
+    };
+    pairs
+        .into_iter()
+        .find(|(k, _)| *k == MontyObject::String(key.into()))
+        .map(|(_, v)| v)
+}
+
+#[test]
+fn binary_pending_args_and_resume_via_ffi() {
+    let code = c("ext_fn(1, 'two', x=[3.5])");
+    let ext_fns = c("ext_fn");
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let handle =
+        unsafe { monty_create(code.as_ptr(), ext_fns.as_ptr(), ptr::null(), &mut out_error) };
+    assert!(!handle.is_null());
+    let tag = unsafe { monty_start(handle, &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Pending);
+
+    let mut len = 0usize;
+    let args = unsafe { read_bytes(monty_pending_fn_args_bin(handle, &mut len), len) };
+    assert_eq!(
+        decode_object(&args).unwrap(),
+        MontyObject::List(vec![MontyObject::Int(1), MontyObject::String("two".into())])
+    );
+    let kwargs = unsafe { read_bytes(monty_pending_fn_kwargs_bin(handle, &mut len), len) };
+    let kwargs = decode_object(&kwargs).unwrap();
+    assert_eq!(
+        envelope_get(&kwargs, "x"),
+        Some(&MontyObject::List(vec![MontyObject::Float(3.5)]))
+    );
+
+    let value = encode_object(&MontyObject::Int(99));
+    let tag = unsafe { monty_resume_bin(handle, value.as_ptr(), value.len(), &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Complete);
+
+    let result = unsafe { read_bytes(monty_complete_result_bin(handle, &mut len), len) };
+    let envelope = decode_object(&result).unwrap();
+    assert_eq!(
+        envelope_get(&envelope, "value"),
+        Some(&MontyObject::Int(99))
+    );
+    assert!(envelope_get(&envelope, "usage").is_some());
+    assert!(envelope_get(&envelope, "error").is_none());
+
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn step_loop_single_crossing_via_ffi() {
+    let code = c("total = 0\nfor i in range(3):\n    total += lookup(i)\ntotal");
+    let ext_fns = c("lookup");
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let handle =
+        unsafe { monty_create(code.as_ptr(), ext_fns.as_ptr(), ptr::null(), &mut out_error) };
+    assert!(!handle.is_null());
+
+    let mut desc: *mut u8 = ptr::null_mut();
+    let mut len = 0usize;
+    let mut tag = unsafe { monty_start_step(handle, &mut desc, &mut len, &mut out_error) };
+    let mut calls = 0;
+    while tag == MontyProgressTag::Pending {
+        let descriptor = decode_object(&unsafe { read_bytes(desc, len) }).unwrap();
+        let MontyObject::Tuple(fields) = descriptor else {
+            panic!("expected tuple descriptor");
+        };
+        assert_eq!(fields[1], MontyObject::String("lookup".into()));
+        let MontyObject::List(args) = &fields[2] else {
+            panic!("expected args list");
+        };
+        let MontyObject::Int(i) = args[0] else {
+            panic!("expected int arg");
+        };
+        let value = encode_object(&MontyObject::Int(i * 10));
+        tag = unsafe {
+            monty_resume_step(
+                handle,
+                value.as_ptr(),
+                value.len(),
+                &mut desc,
+                &mut len,
+                &mut out_error,
+            )
+        };
+        calls += 1;
+    }
+    assert_eq!(calls, 3);
+    assert_eq!(tag, MontyProgressTag::Complete);
+
+    let descriptor = decode_object(&unsafe { read_bytes(desc, len) }).unwrap();
+    let MontyObject::Tuple(fields) = descriptor else {
+        panic!("expected tuple descriptor");
+    };
+    assert_eq!(fields[0], MontyObject::Int(0));
+    assert_eq!(
+        envelope_get(&fields[1], "value"),
+        Some(&MontyObject::Int(30))
+    );
+
+    let current = unsafe { read_bytes(monty_progress_bin(handle, &mut len), len) };
+    assert_eq!(decode_object(&current).unwrap(), MontyObject::Tuple(fields));
+
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn step_null_safety_via_ffi() {
+    let mut desc: *mut u8 = ptr::null_mut();
+    let mut len = 0usize;
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let tag = unsafe { monty_start_step(ptr::null_mut(), &mut desc, &mut len, &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Error);
+    assert!(desc.is_null());
+    assert_eq!(unsafe { read_c_string(out_error) }, "handle is NULL");
+
+    out_error = ptr::null_mut();
+    let tag = unsafe {
+        monty_resume_step(
+            ptr::null_mut(),
+            ptr::null(),
+            0,
+            &mut desc,
+            &mut len,
+            &mut out_error,
+        )
+    };
+    assert_eq!(tag, MontyProgressTag::Error);
+    assert!(desc.is_null());
+    assert_eq!(unsafe { read_c_string(out_error) }, "value is NULL");
+
+    assert!(unsafe { monty_progress_bin(ptr::null(), &mut len) }.is_null());
+
+    let code = c("2 + 2");
+    let handle = unsafe { monty_create(code.as_ptr(), ptr::null(), ptr::null(), &mut out_error) };
+    assert!(unsafe { monty_progress_bin(handle, &mut len) }.is_null());
+    unsafe { monty_free(handle) };
+}
+
+unsafe extern "C" fn native_lookup(
+    user_data: *mut std::ffi::c_void,
+    args: *const u8,
+    args_len: usize,
+    _kwargs: *const u8,
+    _kwargs_len: usize,
+    result: *mut MontyNativeResult,
+) {
+    let table = unsafe { &*user_data.cast::<Vec<i64>>() };
+    let args = decode_object(unsafe { std::slice::from_raw_parts(args, args_len) }).unwrap();
+    let MontyObject::List(items) = args else {
+        panic!("expected args list");
+    };
+    let value = match items.first() {
+        Some(MontyObject::Int(i)) => usize::try_from(*i).ok().and_then(|i| table.get(i)),
+        _ => None,
+    };
+    match value {
+        Some(v) => {
+            let encoded = encode_object(&MontyObject::Int(*v));
+            unsafe { monty_native_result_set_bin(result, encoded.as_ptr(), encoded.len()) };
+        }
+        None => {
+            let message = c("index out of range");
+            unsafe { monty_native_result_set_error(result, message.as_ptr()) };
+        }
+    }
+}
+
+#[test]
+fn native_fn_runs_without_pausing_via_ffi() {
+    let code = c("sum([lookup(i) for i in range(3)])");
+    let ext_fns = c("lookup");
+    let name = c("lookup");
+    let mut table: Vec<i64> = vec![10, 20, 30];
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let handle =
+        unsafe { monty_create(code.as_ptr(), ext_fns.as_ptr(), ptr::null(), &mut out_error) };
+    assert!(!handle.is_null());
+    let rc = unsafe {
+        monty_register_native_fn(
+            handle,
+            name.as_ptr(),
+            Some(native_lookup),
+            (&raw mut table).cast(),
+        )
+    };
+    assert_eq!(rc, 0);
+
+    let mut result_json: *mut c_char = ptr::null_mut();
+    let mut error_msg: *mut c_char = ptr::null_mut();
+    let tag = unsafe { monty_run(handle, &mut result_json, &mut error_msg) };
+    assert_eq!(tag, MontyResultTag::Ok);
+    let result: serde_json::Value =
+        serde_json::from_str(&unsafe { read_c_string(result_json) }).unwrap();
+    assert_eq!(result["value"], 60);
+
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn native_fn_error_raises_in_python_via_ffi() {
+    let code = c("try:\n    lookup(9)\nexcept RuntimeError as e:\n    r = str(e)\nr");
+    let ext_fns = c("lookup");
+    let name = c("lookup");
+    let mut table: Vec<i64> = vec![];
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let handle =
+        unsafe { monty_create(code.as_ptr(), ext_fns.as_ptr(), ptr::null(), &mut out_error) };
+    let rc = unsafe {
+        monty_register_native_fn(
+            handle,
+            name.as_ptr(),
+            Some(native_lookup),
+            (&raw mut table).cast(),
+        )
+    };
+    assert_eq!(rc, 0);
+
+    let tag = unsafe { monty_start(handle, &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Complete);
+    let result: serde_json::Value =
+        serde_json::from_str(&unsafe { read_c_string(monty_complete_result_json(handle)) })
+            .unwrap();
+    assert_eq!(result["value"], "index out of range");
+
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn register_native_fn_null_safety_via_ffi() {
+    let name = c("lookup");
+    assert_eq!(
+        unsafe {
+            monty_register_native_fn(
+                ptr::null_mut(),
+                name.as_ptr(),
+                Some(native_lookup),
+                ptr::null_mut(),
+            )
+        },
+        -1
+    );
+
+    let code = c("1");
+    let mut out_error: *mut c_char = ptr::null_mut();
+    let handle = unsafe { monty_create(code.as_ptr(), ptr::null(), ptr::null(), &mut out_error) };
+    assert_eq!(
+        unsafe {
+            monty_register_native_fn(handle, ptr::null(), Some(native_lookup), ptr::null_mut())
+        },
+        -1
+    );
+    assert_eq!(
+        unsafe { monty_register_native_fn(handle, name.as_ptr(), None, ptr::null_mut()) },
+        -1
+    );
+    unsafe { monty_native_result_set_bin(ptr::null_mut(), ptr::null(), 0) };
+    unsafe { monty_native_result_set_error(ptr::null_mut(), ptr::null()) };
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn binary_run_without_result_json_via_ffi() {
+    let code = c("[1, 2 ** 70]");
+    let mut out_error: *mut c_char = ptr::null_mut();
+    let mut error_msg: *mut c_char = ptr::null_mut();
+
+    let handle = unsafe { monty_create(code.as_ptr(), ptr::null(), ptr::null(), &mut out_error) };
+    assert!(!handle.is_null());
+    let tag = unsafe { monty_run(handle, ptr::null_mut(), &mut error_msg) };
+    assert_eq!(tag, MontyResultTag::Ok);
+    assert!(error_msg.is_null());
+
+    let mut len = 0usize;
+    let result = unsafe { read_bytes(monty_complete_result_bin(handle, &mut len), len) };
+    let envelope = decode_object(&result).unwrap();
+    let Some(MontyObject::List(items)) = envelope_get(&envelope, "value") else {
+        panic!("expected list value");
+    };
+    assert_eq!(items[0], MontyObject::Int(1));
+    assert!(matches!(items[1], MontyObject::BigInt(_)));
+
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn binary_resume_futures_via_ffi() {
+    let code = c(r"
+import asyncio
+
+async def main():
+    a, b = await asyncio.gather(foo(), bar())
+    return a + b
+
+await main()
+");
+    let ext_fns = c("foo,bar");
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let handle =
+        unsafe { monty_create(code.as_ptr(), ext_fns.as_ptr(), ptr::null(), &mut out_error) };
+    assert!(!handle.is_null());
+
+    let mut tag = unsafe { monty_start(handle, &mut out_error) };
+    let mut call_ids = Vec::new();
+    while tag == MontyProgressTag::Pending {
+        call_ids.push(unsafe { monty_pending_call_id(handle) });
+        tag = unsafe { monty_resume_as_future(handle, &mut out_error) };
+    }
+    assert_eq!(tag, MontyProgressTag::ResolveFutures);
+    assert_eq!(call_ids.len(), 2);
+
+    let results = encode_object(&MontyObject::dict(vec![
+        (MontyObject::Int(call_ids[0].into()), MontyObject::Int(10)),
+        (MontyObject::Int(call_ids[1].into()), MontyObject::Int(32)),
+    ]));
+    let tag = unsafe {
+        monty_resume_futures_bin(
+            handle,
+            results.as_ptr(),
+            results.len(),
+            ptr::null(),
+            0,
+            &mut out_error,
+        )
+    };
+    assert_eq!(tag, MontyProgressTag::Complete);
+
+    let mut len = 0usize;
+    let result = unsafe { read_bytes(monty_complete_result_bin(handle, &mut len), len) };
+    let envelope = decode_object(&result).unwrap();
+    assert_eq!(
+        envelope_get(&envelope, "value"),
+        Some(&MontyObject::Int(42))
+    );
+
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn binary_null_safety_via_ffi() {
+    let mut len = 0usize;
+    assert!(unsafe { monty_pending_fn_args_bin(ptr::null(), &mut len) }.is_null());
+    assert!(unsafe { monty_pending_fn_kwargs_bin(ptr::null(), &mut len) }.is_null());
+    assert!(unsafe { monty_complete_result_bin(ptr::null(), &mut len) }.is_null());
+
+    let code = c("ext_fn()");
+    let ext_fns = c("ext_fn");
+    let mut out_error: *mut c_char = ptr::null_mut();
+    let handle =
+        unsafe { monty_create(code.as_ptr(), ext_fns.as_ptr(), ptr::null(), &mut out_error) };
+    assert!(!handle.is_null());
+    assert_eq!(
+        unsafe { monty_start(handle, &mut out_error) },
+        MontyProgressTag::Pending
+    );
+
+    let tag = unsafe { monty_resume_bin(handle, ptr::null(), 0, &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Error);
+    assert_eq!(unsafe { read_c_string(out_error) }, "value is NULL");
+
+    let garbage = [0xFFu8];
+    let tag = unsafe { monty_resume_bin(handle, garbage.as_ptr(), 1, &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Error);
+    assert!(unsafe { read_c_string(out_error) }.starts_with("invalid value"));
+
+    unsafe { monty_free(handle) };
+}
+
+// ---------------------------------------------------------------------------
+// FFI Boundary: Resource usage accounting
+// ---------------------------------------------------------------------------
+
+#[test]
+fn usage_readable_while_paused_via_ffi() {
+    let code = c("data = [str(i) for i in range(100)]\next_fn(len(data))");
+    let ext_fns = c("ext_fn");
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let handle =
+        unsafe { monty_create(code.as_ptr(), ext_fns.as_ptr(), ptr::null(), &mut out_error) };
+    assert!(!handle.is_null());
+    let tag = unsafe { monty_start(handle, &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Pending);
+
+    let mut usage = MontyUsage::default();
+    assert_eq!(unsafe { monty_usage(handle, &mut usage) }, 0);
+    assert!(usage.memory_bytes_used > 0);
+    assert!(usage.allocations > 0);
+
+    let value = c("0");
+    let tag = unsafe { monty_resume(handle, value.as_ptr(), &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Complete);
+
+    let result_str = unsafe { read_c_string(monty_complete_result_json(handle)) };
+    let result: serde_json::Value = serde_json::from_str(&result_str).unwrap();
+    let mut done = MontyUsage::default();
+    assert_eq!(unsafe { monty_usage(handle, &mut done) }, 0);
+    assert!(done.allocations >= usage.allocations);
+    assert_eq!(result["usage"]["allocations"], done.allocations);
+    assert_eq!(result["usage"]["memory_bytes_used"], done.memory_bytes_used);
+
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn usage_null_safety_via_ffi() {
+    let mut usage = MontyUsage::default();
+    assert_eq!(unsafe { monty_usage(ptr::null(), &mut usage) }, -1);
+
+    let code = c("1");
+    let mut out_error: *mut c_char = ptr::null_mut();
+    let handle = unsafe { monty_create(code.as_ptr(), ptr::null(), ptr::null(), &mut out_error) };
+    assert_eq!(unsafe { monty_usage(handle, ptr::null_mut()) }, -1);
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn inspect_paused_handle_via_ffi() {
+    let code = c("data = [str(i) for i in range(100)]\next_fn(data)");
+    let ext_fns = c("ext_fn");
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let handle =
+        unsafe { monty_create(code.as_ptr(), ext_fns.as_ptr(), ptr::null(), &mut out_error) };
+    assert!(!handle.is_null());
+    let tag = unsafe { monty_start(handle, &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Pending);
+
+    let json = unsafe { read_c_string(monty_inspect_json(handle)) };
+    let inspection: serde_json::Value = serde_json::from_str(&json).unwrap();
+    assert_eq!(inspection["state"], "pending");
+    assert!(inspection["live_allocations"].as_u64().unwrap() > 0);
+    assert_eq!(inspection["pending"]["function_name"], "ext_fn");
+    assert_eq!(
+        inspection["pending"]["args"],
+        serde_json::json!([{"type": "list", "len": 100}])
+    );
+
+    assert!(unsafe { monty_inspect_json(ptr::null()) }.is_null());
+    unsafe { monty_free(handle) };
+}
+
+// ---------------------------------------------------------------------------
+// FFI Boundary: In-flight snapshots (pause → snapshot → free → restore → resume)
+// ---------------------------------------------------------------------------
+
+#[test]
+fn paused_snapshot_round_trip_via_ffi() {
+    let code = c("print('parked')\nresult = ext_fn('job-1')\nresult * 2");
+    let ext_fns = c("ext_fn");
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let handle =
+        unsafe { monty_create(code.as_ptr(), ext_fns.as_ptr(), ptr::null(), &mut out_error) };
+    assert!(!handle.is_null());
+    let tag = unsafe { monty_start(handle, &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Pending);
+
+    let mut snap_len: usize = 0;
+    let snap_ptr = unsafe { monty_snapshot(handle, &mut snap_len) };
+    assert!(!snap_ptr.is_null());
+    unsafe { monty_free(handle) };
+
+    let restored = unsafe { monty_restore(snap_ptr, snap_len, &mut out_error) };
+    assert!(!restored.is_null());
+    unsafe { monty_bytes_free(snap_ptr, snap_len) };
+
+    assert_eq!(
+        unsafe { monty_progress_state(restored) },
+        MontyProgressTag::Pending as c_int
+    );
+    let fn_name = unsafe { read_c_string(monty_pending_fn_name(restored)) };
+    assert_eq!(fn_name, "ext_fn");
+    let args = unsafe { read_c_string(monty_pending_fn_args_json(restored)) };
+    assert_eq!(args, r#"["job-1"]"#);
+
+    let value = c("21");
+    let tag = unsafe { monty_resume(restored, value.as_ptr(), &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Complete);
+    let result_str = unsafe { read_c_string(monty_complete_result_json(restored)) };
+    let result: serde_json::Value = serde_json::from_str(&result_str).unwrap();
+    assert_eq!(result["value"], 42);
+    assert_eq!(result["print_output"], "parked\n");
+
+    unsafe { monty_free(restored) };
+}
+
+#[test]
+fn snapshot_after_complete_returns_null_via_ffi() {
+    let code = c("1");
+    let mut out_error: *mut c_char = ptr::null_mut();
+    let handle = unsafe { monty_create(code.as_ptr(), ptr::null(), ptr::null(), &mut out_error) };
+    assert_eq!(unsafe { monty_progress_state(handle) }, -1);
+    let tag = unsafe { monty_start(handle, &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Complete);
+    assert_eq!(
+        unsafe { monty_progress_state(handle) },
+        MontyProgressTag::Complete as c_int
+    );
+
+    let mut snap_len: usize = 0;
+    assert!(unsafe { monty_snapshot(handle, &mut snap_len) }.is_null());
+    assert_eq!(unsafe { monty_progress_state(ptr::null()) }, -1);
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn snapshot_file_round_trip_via_ffi() {
+    let code = c("result = ext_fn(7)\nresult + 1");
+    let ext_fns = c("ext_fn");
+    let path = std::env::temp_dir().join(format!("monty_ffi_{}.snap", std::process::id()));
+    let c_path = c(path.to_str().unwrap());
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let handle =
+        unsafe { monty_create(code.as_ptr(), ext_fns.as_ptr(), ptr::null(), &mut out_error) };
+    assert_eq!(
+        unsafe { monty_start(handle, &mut out_error) },
+        MontyProgressTag::Pending
+    );
+    assert_eq!(
+        unsafe { monty_snapshot_file(handle, c_path.as_ptr(), &mut out_error) },
+        0
+    );
+    unsafe { monty_free(handle) };
+
+    let restored = unsafe { monty_restore_file(c_path.as_ptr(), &mut out_error) };
+    assert!(!restored.is_null());
+    let value = c("41");
+    assert_eq!(
+        unsafe { monty_resume(restored, value.as_ptr(), &mut out_error) },
+        MontyProgressTag::Complete
+    );
+    unsafe { monty_free(restored) };
+
+    // The same container restores from a caller-owned buffer.
+    let mut bytes = std::fs::read(&path).unwrap();
+    let restored = unsafe { monty_restore(bytes.as_ptr(), bytes.len(), &mut out_error) };
+    assert!(!restored.is_null());
+    unsafe { monty_free(restored) };
+
+    // A corrupted payload fails the checksum.
+    *bytes.last_mut().unwrap() ^= 0xFF;
+    std::fs::write(&path, &bytes).unwrap();
+    let restored = unsafe { monty_restore_file(c_path.as_ptr(), &mut out_error) };
+    assert!(restored.is_null());
+    let err = unsafe { read_c_string(out_error) };
+    assert!(err.contains("checksum"), "{err}");
+    std::fs::remove_file(&path).unwrap();
+}
+
+#[test]
+fn snapshot_file_null_safety_via_ffi() {
+    let path = c("/nonexistent/dir/x.snap");
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    assert_eq!(
+        unsafe { monty_snapshot_file(ptr::null(), path.as_ptr(), &mut out_error) },
+        -1
+    );
+    assert_eq!(unsafe { read_c_string(out_error) }, "handle is NULL");
+
+    let code = c("1");
+    let handle = unsafe { monty_create(code.as_ptr(), ptr::null(), ptr::null(), &mut out_error) };
+    assert_eq!(
+        unsafe { monty_snapshot_file(handle, ptr::null(), &mut out_error) },
+        -1
+    );
+    assert_eq!(unsafe { read_c_string(out_error) }, "path is NULL");
+    assert_eq!(
+        unsafe { monty_snapshot_file(handle, path.as_ptr(), ptr::null_mut()) },
+        -1
+    );
+    unsafe { monty_free(handle) };
+
+    assert!(unsafe { monty_restore_file(ptr::null(), &mut out_error) }.is_null());
+    assert_eq!(unsafe { read_c_string(out_error) }, "path is NULL");
+    assert!(unsafe { monty_restore_file(path.as_ptr(), &mut out_error) }.is_null());
+    unsafe { monty_string_free(out_error) };
+}
+
+// ---------------------------------------------------------------------------
+// FFI Boundary: Persistent sessions (create → feed × N → reset → free)
+// ---------------------------------------------------------------------------
+
+/// Feed `code` to `session`, returning `(tag, parsed result envelope)`.
+unsafe fn repl_feed(
+    session: *mut MontyReplSession,
+    code: &str,
+) -> (MontyResultTag, serde_json::Value) {
+    let code = c(code);
+    let mut result_json: *mut c_char = ptr::null_mut();
+    let mut error_msg: *mut c_char = ptr::null_mut();
+    let tag = unsafe { monty_repl_feed(session, code.as_ptr(), &mut result_json, &mut error_msg) };
+    if !error_msg.is_null() {
+        unsafe { monty_string_free(error_msg) };
+    }
+    let json_str = unsafe { read_c_string(result_json) };
+    (tag, serde_json::from_str(&json_str).unwrap())
+}
+
+#[test]
+fn session_state_persists_via_ffi() {
+    let mut out_error: *mut c_char = ptr::null_mut();
+    let session = unsafe { monty_repl_create(ptr::null(), &mut out_error) };
+    assert!(!session.is_null());
+
+    let (tag, _) = unsafe {
+        repl_feed(
+            session,
+            "counter = 0\ndef bump():\n    global counter\n    counter += 1\n    return counter",
+        )
+    };
+    assert_eq!(tag, MontyResultTag::Ok);
+    for expected in 1..=3 {
+        let (tag, result) = unsafe { repl_feed(session, "bump()") };
+        assert_eq!(tag, MontyResultTag::Ok);
+        assert_eq!(result["value"], expected);
+    }
+
+    unsafe { monty_repl_reset(session) };
+    let (tag, result) = unsafe { repl_feed(session, "counter") };
+    assert_eq!(tag, MontyResultTag::Error);
+    assert_eq!(result["error"]["exc_type"], "NameError");
+
+    unsafe { monty_repl_free(session) };
+}
+
+#[test]
+fn session_null_safety_via_ffi() {
+    let code = c("1");
+    let mut error_msg: *mut c_char = ptr::null_mut();
+    let tag = unsafe {
+        monty_repl_feed(
+            ptr::null_mut(),
+            code.as_ptr(),
+            ptr::null_mut(),
+            &mut error_msg,
+        )
+    };
+    assert_eq!(tag, MontyResultTag::Error);
+    assert_eq!(unsafe { read_c_string(error_msg) }, "session is NULL");
+
+    let mut out_error: *mut c_char = ptr::null_mut();
+    let session = unsafe { monty_repl_create(ptr::null(), &mut out_error) };
+    let tag = unsafe { monty_repl_feed(session, ptr::null(), ptr::null_mut(), &mut error_msg) };
+    assert_eq!(tag, MontyResultTag::Error);
+    assert_eq!(unsafe { read_c_string(error_msg) }, "code is NULL");
+
+    unsafe {
+        monty_repl_reset(ptr::null_mut());
+        monty_repl_set_memory_limit(ptr::null_mut(), 1);
+        monty_repl_free(ptr::null_mut());
+        monty_repl_free(session);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Print output streaming
+// ---------------------------------------------------------------------------
+
+unsafe extern "C" fn collect_output(
+    user_data: *mut std::ffi::c_void,
+    text: *const c_char,
+    len: usize,
+) {
+    let lines = unsafe { &mut *user_data.cast::<Vec<String>>() };
+    let bytes = unsafe { std::slice::from_raw_parts(text.cast::<u8>(), len) };
+    lines.push(std::str::from_utf8(bytes).unwrap().to_string());
+}
+
+#[test]
+fn output_stream_callback_via_ffi() {
+    let code = c("print('a')\nprint('b', end='')\nx = ext(1)\nprint('c')\nx");
+    let ext_fns = c("ext");
+    let mut lines: Vec<String> = Vec::new();
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let handle =
+        unsafe { monty_create(code.as_ptr(), ext_fns.as_ptr(), ptr::null(), &mut out_error) };
+    unsafe { monty_set_output_stream(handle, 0, Some(collect_output), (&raw mut lines).cast()) };
+
+    let tag = unsafe { monty_start(handle, &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Pending);
+    // The partial line is flushed when the VM pauses.
+    assert_eq!(lines, ["a\n", "b"]);
+
+    let value = c("7");
+    let tag = unsafe { monty_resume(handle, value.as_ptr(), &mut out_error) };
+    assert_eq!(tag, MontyProgressTag::Complete);
+    assert_eq!(lines, ["a\n", "b", "c\n"]);
+    let result: serde_json::Value =
+        serde_json::from_str(&unsafe { read_c_string(monty_complete_result_json(handle)) })
+            .unwrap();
+    assert_eq!(result["value"], 7);
+    assert!(result.get("print_output").is_none());
+    assert!(unsafe { monty_take_output(handle) }.is_null());
+
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn output_stream_buffer_via_ffi() {
+    let code = c("for i in range(100):\n    print(i)");
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let handle = unsafe { monty_create(code.as_ptr(), ptr::null(), ptr::null(), &mut out_error) };
+    unsafe { monty_set_output_stream(handle, 9, None, ptr::null_mut()) };
+
+    let mut result_json: *mut c_char = ptr::null_mut();
+    let mut error_msg: *mut c_char = ptr::null_mut();
+    let tag = unsafe { monty_run(handle, &mut result_json, &mut error_msg) };
+    assert_eq!(tag, MontyResultTag::Ok);
+    unsafe { monty_string_free(result_json) };
+
+    let out = unsafe { read_c_string(monty_take_output(handle)) };
+    assert_eq!(out, "[... 281 bytes dropped]\n97\n98\n99\n");
+    assert!(unsafe { monty_take_output(handle) }.is_null());
+
+    unsafe {
+        monty_set_output_stream(ptr::null_mut(), 0, None, ptr::null_mut());
+        assert!(monty_take_output(ptr::null_mut()).is_null());
+        monty_free(handle);
+    }
+}
+
+#[test]
+fn inputs_via_ffi() {
+    let code = c("x + len(names)");
+    let inputs = encode_object(&MontyObject::dict(vec![
+        (MontyObject::String("x".into()), MontyObject::Int(40)),
+        (
+            MontyObject::String("names".into()),
+            MontyObject::List(vec![MontyObject::None, MontyObject::None]),
+        ),
+    ]));
+    let mut out_error: *mut c_char = ptr::null_mut();
+
+    let handle = unsafe {
+        monty_create_with_inputs(
+            code.as_ptr(),
+            ptr::null(),
+            inputs.as_ptr(),
+            inputs.len(),
+            ptr::null(),
+            &mut out_error,
+        )
+    };
+    assert!(!handle.is_null());
+    let mut result_json: *mut c_char = ptr::null_mut();
+    let mut error_msg: *mut c_char = ptr::null_mut();
+    let tag = unsafe { monty_run(handle, &mut result_json, &mut error_msg) };
+    assert_eq!(tag, MontyResultTag::Ok);
+    let result: serde_json::Value =
+        serde_json::from_str(&unsafe { read_c_string(result_json) }).unwrap();
+    assert_eq!(result["value"], 42);
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn program_inputs_via_ffi() {
+    let code = c("a * b");
+    let names = c("a, b");
+    let mut out_error: *mut c_char = ptr::null_mut();
+    let program = unsafe {
+        monty_program_compile_with_inputs(
+            code.as_ptr(),
+            ptr::null(),
+            names.as_ptr(),
+            ptr::null(),
+            &mut out_error,
+        )
+    };
+    assert!(!program.is_null());
+
+    for (a, expected) in [(2, 14), (3, 21)] {
+        let inputs = encode_object(&MontyObject::dict(vec![
+            (MontyObject::String("b".into()), MontyObject::Int(7)),
+            (MontyObject::String("a".into()), MontyObject::Int(a)),
+        ]));
+        let handle = unsafe {
+            monty_program_instantiate_with_inputs(
+                program,
+                inputs.as_ptr(),
+                inputs.len(),
+                &mut out_error,
+            )
+        };
+        assert!(!handle.is_null());
+        let mut result_json: *mut c_char = ptr::null_mut();
+        let tag = unsafe { monty_run(handle, &mut result_json, ptr::null_mut()) };
+        assert_eq!(tag, MontyResultTag::Ok);
+        let result: serde_json::Value =
+            serde_json::from_str(&unsafe { read_c_string(result_json) }).unwrap();
+        assert_eq!(result["value"], expected);
+        unsafe { monty_free(handle) };
+    }
+
+    let partial = encode_object(&MontyObject::dict(vec![(
+        MontyObject::String("a".into()),
+        MontyObject::Int(1),
+    )]));
+    let handle = unsafe {
+        monty_program_instantiate_with_inputs(
+            program,
+            partial.as_ptr(),
+            partial.len(),
+            &mut out_error,
+        )
+    };
+    assert!(handle.is_null());
+    assert_eq!(unsafe { read_c_string(out_error) }, "missing input: b");
+
+    unsafe { monty_program_free(program) };
+}
+
+// ---------------------------------------------------------------------------
+// Program cache
+// ---------------------------------------------------------------------------
+
+unsafe fn cache_stats(cache: *const MontyProgramCache) -> MontyCacheStats {
+    let mut stats = MontyCacheStats::default();
+    assert_eq!(unsafe { monty_cache_stats(cache, &mut stats) }, 0);
+    stats
+}
+
+#[test]
+fn cache_hits_via_ffi() {
+    let cache = monty_cache_new(1 << 20);
+    let code = c("x * 2");
+    for x in [1, 2, 3] {
+        let inputs = encode_object(&MontyObject::dict(vec![(
+            MontyObject::String("x".into()),
+            MontyObject::Int(x),
+        )]));
+        let mut out_error: *mut c_char = ptr::null_mut();
+        let handle = unsafe {
+            monty_create_cached(
+                cache,
+                code.as_ptr(),
+                ptr::null(),
+                inputs.as_ptr(),
+                inputs.len(),
+                ptr::null(),
+                &mut out_error,
+            )
+        };
+        assert!(!handle.is_null());
+        let mut result_json: *mut c_char = ptr::null_mut();
+        let tag = unsafe { monty_run(handle, &mut result_json, ptr::null_mut()) };
+        assert_eq!(tag, MontyResultTag::Ok);
+        let result: serde_json::Value =
+            serde_json::from_str(&unsafe { read_c_string(result_json) }).unwrap();
+        assert_eq!(result["value"], x * 2);
+        unsafe { monty_free(handle) };
+    }
+
+    let stats = unsafe { cache_stats(cache) };
+    assert_eq!((stats.hits, stats.misses, stats.entries), (2, 1, 1));
+    assert_eq!(stats.capacity_bytes, 1 << 20);
+
+    unsafe { monty_cache_clear(cache) };
+    assert_eq!(unsafe { cache_stats(cache) }.entries, 0);
+    unsafe { monty_cache_free(cache) };
+}
+
+#[test]
+fn cache_compile_error_via_ffi() {
+    let cache = monty_cache_new(1 << 20);
+    let code = c("def");
+    let mut out_error: *mut c_char = ptr::null_mut();
+    let handle = unsafe {
+        monty_create_cached(
+            cache,
+            code.as_ptr(),
+            ptr::null(),
+            ptr::null(),
+            0,
+            ptr::null(),
+            &mut out_error,
+        )
+    };
+    assert!(handle.is_null());
+    assert!(!unsafe { read_c_string(out_error) }.is_empty());
+    assert_eq!(unsafe { cache_stats(cache) }.entries, 0);
+    unsafe { monty_cache_free(cache) };
+}
+
+#[test]
+fn cache_shared_across_threads() {
+    struct Shared(*const MontyProgramCache);
+    // SAFETY: MontyProgramCache is Sync; the pointer outlives the scope.
+    unsafe impl Sync for Shared {}
+
+    let cache = Shared(monty_cache_new(1 << 20));
+    std::thread::scope(|scope| {
+        for _ in 0..4 {
+            scope.spawn(|| {
+                let code = c("sum(range(10))");
+                for _ in 0..8 {
+                    let handle = unsafe {
+                        monty_create_cached(
+                            cache.0,
+                            code.as_ptr(),
+                            ptr::null(),
+                            ptr::null(),
+                            0,
+                            ptr::null(),
+                            ptr::null_mut(),
+                        )
+                    };
+                    assert!(!handle.is_null());
+                    let tag = unsafe { monty_run(handle, ptr::null_mut(), ptr::null_mut()) };
+                    assert_eq!(tag, MontyResultTag::Ok);
+                    unsafe { monty_free(handle) };
+                }
+            });
+        }
+    });
+
+    let stats = unsafe { cache_stats(cache.0) };
+    assert_eq!(stats.hits + stats.misses, 32);
+    assert_eq!(stats.entries, 1);
+    // Threads that missed concurrently each compiled; the rest hit.
+    assert!(stats.misses <= 4);
+
+    unsafe { monty_cache_retain(cache.0) };
+    unsafe { monty_cache_free(cache.0) };
+    assert_eq!(unsafe { cache_stats(cache.0) }.entries, 1);
+    unsafe { monty_cache_free(cache.0) };
+    unsafe { monty_cache_free(ptr::null()) };
+}
+
+#[test]
+fn cache_directory_serves_next_open_on_a_miss() {
+    let dir = std::env::temp_dir().join(format!("dart_monty_cache_ffi_{}", std::process::id()));
+    let _ = std::fs::remove_dir_all(&dir);
+    let c_dir = c(dir.to_str().unwrap());
+    let code = c("6 * 7");
+
+    for expected_loads in [0, 1] {
+        let mut out_error: *mut c_char = ptr::null_mut();
+        let cache = unsafe { monty_cache_open(1 << 20, c_dir.as_ptr(), &mut out_error) };
+        assert!(!cache.is_null());
+        // Nothing is read until a lookup misses.
+        assert_eq!(unsafe { cache_stats(cache) }.disk_loads, 0);
+
+        let handle = unsafe {
+            monty_create_cached(
+                cache,
+                code.as_ptr(),
+                ptr::null(),
+                ptr::null(),
+                0,
+                ptr::null(),
+                &mut out_error,
+            )
+        };
+        assert!(!handle.is_null());
+        let mut result_json: *mut c_char = ptr::null_mut();
+        let tag = unsafe { monty_run(handle, &mut result_json, ptr::null_mut()) };
+        assert_eq!(tag, MontyResultTag::Ok);
+        let result: serde_json::Value =
+            serde_json::from_str(&unsafe { read_c_string(result_json) }).unwrap();
+        assert_eq!(result["value"], 42);
+        unsafe { monty_free(handle) };
+
+        // Both lookups miss in memory. The first open compiles and writes;
+        // the second is served from disk.
+        let stats = unsafe { cache_stats(cache) };
+        assert_eq!(stats.misses, 1);
+        assert_eq!(stats.disk_loads, expected_loads);
+        assert_eq!(stats.disk_writes, 1 - expected_loads);
+        unsafe { monty_cache_free(cache) };
+    }
+
+    std::fs::remove_dir_all(&dir).unwrap();
+}
+
+// ---------------------------------------------------------------------------
+// Handle reuse
+// ---------------------------------------------------------------------------
+
+#[test]
+fn reset_reuses_handle_via_ffi() {
+    let first = c("ext_fn(1)");
+    let ext_fns = c("ext_fn");
+    let handle = unsafe {
+        monty_create(
+            first.as_ptr(),
+            ext_fns.as_ptr(),
+            ptr::null(),
+            ptr::null_mut(),
+        )
+    };
+    assert!(!handle.is_null());
+    assert_eq!(
+        unsafe { monty_start(handle, ptr::null_mut()) },
+        MontyProgressTag::Pending
+    );
+
+    for x in [3, 4] {
+        let code = c("x * x");
+        let inputs = encode_object(&MontyObject::dict(vec![(
+            MontyObject::String("x".into()),
+            MontyObject::Int(x),
+        )]));
+        let mut out_error: *mut c_char = ptr::null_mut();
+        let rc = unsafe {
+            monty_reset(
+                handle,
+                code.as_ptr(),
+                ptr::null(),
+                inputs.as_ptr(),
+                inputs.len(),
+                ptr::null(),
+                &mut out_error,
+            )
+        };
+        assert_eq!(rc, 0);
+        let mut result_json: *mut c_char = ptr::null_mut();
+        let tag = unsafe { monty_run(handle, &mut result_json, ptr::null_mut()) };
+        assert_eq!(tag, MontyResultTag::Ok);
+        let result: serde_json::Value =
+            serde_json::from_str(&unsafe { read_c_string(result_json) }).unwrap();
+        assert_eq!(result["value"], x * x);
+    }
+
+    let bad = c("def");
+    let mut out_error: *mut c_char = ptr::null_mut();
+    let rc = unsafe {
+        monty_reset(
+            handle,
+            bad.as_ptr(),
+            ptr::null(),
+            ptr::null(),
+            0,
+            ptr::null(),
+            &mut out_error,
+        )
+    };
+    assert_eq!(rc, -1);
+    assert!(!unsafe { read_c_string(out_error) }.is_empty());
+    unsafe { monty_free(handle) };
+
+    let mut out_error: *mut c_char = ptr::null_mut();
+    let rc = unsafe {
+        monty_reset(
+            ptr::null_mut(),
+            bad.as_ptr(),
+            ptr::null(),
+            ptr::null(),
+            0,
+            ptr::null(),
+            &mut out_error,
+        )
+    };
+    assert_eq!(rc, -1);
+    assert_eq!(unsafe { read_c_string(out_error) }, "handle is NULL");
+}
+
+// ---------------------------------------------------------------------------
+// Interrupts
+// ---------------------------------------------------------------------------
+
+#[test]
+fn interrupt_stops_run_on_another_thread() {
+    let interrupt = monty_interrupt_new();
+    // Raw pointers are not Send; the interrupt is thread-safe by contract.
+    let interrupt_addr = interrupt as usize;
+
+    let worker = std::thread::spawn(move || {
+        let code = c("i = 0\nwhile True:\n    i += 1");
+        let handle =
+            unsafe { monty_create(code.as_ptr(), ptr::null(), ptr::null(), ptr::null_mut()) };
+        assert!(!handle.is_null());
+        unsafe { monty_set_interrupt(handle, interrupt_addr as *const MontyInterrupt) };
+
+        let mut result_json: *mut c_char = ptr::null_mut();
+        let tag = unsafe { monty_run(handle, &mut result_json, ptr::null_mut()) };
+        let result: serde_json::Value =
+            serde_json::from_str(&unsafe { read_c_string(result_json) }).unwrap();
+        unsafe { monty_free(handle) };
+        (tag, result)
+    });
+
+    std::thread::sleep(std::time::Duration::from_millis(50));
+    unsafe { monty_interrupt(interrupt) };
+    let (tag, result) = worker.join().unwrap();
+
+    assert_eq!(tag, MontyResultTag::Error);
+    assert_eq!(result["error"]["exc_type"], "KeyboardInterrupt");
+    unsafe { monty_interrupt_free(interrupt) };
+}
+
+#[test]
+fn cleared_interrupt_lets_handle_run() {
+    let interrupt = monty_interrupt_new();
+    unsafe { monty_interrupt(interrupt) };
+    unsafe { monty_interrupt_clear(interrupt) };
+
+    let code = c("1 + 1");
+    let handle = unsafe { monty_create(code.as_ptr(), ptr::null(), ptr::null(), ptr::null_mut()) };
+    unsafe { monty_set_interrupt(handle, interrupt) };
+    // The handle holds its own reference.
+    unsafe { monty_interrupt_free(interrupt) };
+
+    let tag = unsafe { monty_run(handle, ptr::null_mut(), ptr::null_mut()) };
+    assert_eq!(tag, MontyResultTag::Ok);
+    unsafe { monty_free(handle) };
+}
+
+// ---------------------------------------------------------------------------
+// Tracing
+// ---------------------------------------------------------------------------
+
+#[test]
+fn trace_json_splits_vm_host_and_conversion() {
+    let code = c("x = ext_fn(1)\nx + 1");
+    let ext_fns = c("ext_fn");
+    let handle = unsafe {
+        monty_create(
+            code.as_ptr(),
+            ext_fns.as_ptr(),
+            ptr::null(),
+            ptr::null_mut(),
+        )
+    };
+    assert!(!handle.is_null());
+    assert!(
+        unsafe { monty_trace_json(handle) }.is_null(),
+        "off by default"
+    );
+    unsafe { monty_set_trace(handle, 1) };
+
+    let tag = unsafe { monty_start(handle, ptr::null_mut()) };
+    assert_eq!(tag, MontyProgressTag::Pending);
+    let value = c("41");
+    let tag = unsafe { monty_resume(handle, value.as_ptr(), ptr::null_mut()) };
+    assert_eq!(tag, MontyProgressTag::Complete);
+
+    let events: serde_json::Value =
+        serde_json::from_str(&unsafe { read_c_string(monty_trace_json(handle)) }).unwrap();
+    let kinds: Vec<&str> = events
+        .as_array()
+        .unwrap()
+        .iter()
+        .map(|e| e["kind"].as_str().unwrap())
+        .collect();
+    assert_eq!(kinds, ["compile", "vm", "host", "convert", "vm"]);
+    assert_eq!(events[3]["bytes"], 2);
+    assert!(events[2]["at_us"].as_u64() >= events[1]["at_us"].as_u64());
+
+    unsafe { monty_set_trace(handle, 0) };
+    assert!(unsafe { monty_trace_json(handle) }.is_null());
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn trace_null_handle_is_safe() {
+    unsafe { monty_set_trace(ptr::null_mut(), 1) };
+    assert!(unsafe { monty_trace_json(ptr::null()) }.is_null());
+}
+
+// ---------------------------------------------------------------------------
+// Result access
+// ---------------------------------------------------------------------------
+
+#[test]
+fn result_path_reads_parts_of_the_value() {
+    let code = c("{'users': [{'name': 'ada'}, {'name': 'bob'}], 'n': list(range(20))}");
+    let handle = unsafe { monty_create(code.as_ptr(), ptr::null(), ptr::null(), ptr::null_mut()) };
+    assert!(!handle.is_null());
+    let tag = unsafe { monty_run(handle, ptr::null_mut(), ptr::null_mut()) };
+    assert_eq!(tag, MontyResultTag::Ok);
+
+    let path = c(r#"["users", -1, "name"]"#);
+    let json = unsafe { monty_result_get_path(handle, path.as_ptr(), ptr::null_mut()) };
+    assert_eq!(unsafe { read_c_string(json) }, r#""bob""#);
+
+    let mut len = 0usize;
+    let bin =
+        unsafe { monty_result_get_path_bin(handle, path.as_ptr(), &mut len, ptr::null_mut()) };
+    let decoded = decode_object(unsafe { std::slice::from_raw_parts(bin, len) }).unwrap();
+    assert_eq!(decoded, MontyObject::String("bob".into()));
+    unsafe { monty_bytes_free(bin, len) };
+
+    let n = c(r#"["n"]"#);
+    assert_eq!(unsafe { monty_result_len(handle, n.as_ptr()) }, 20);
+    assert_eq!(unsafe { monty_result_len(handle, ptr::null()) }, 2);
+    let slice = unsafe { monty_result_slice(handle, n.as_ptr(), -2, i64::MAX, ptr::null_mut()) };
+    assert_eq!(unsafe { read_c_string(slice) }, "[18,19]");
+    let ty = unsafe { monty_result_type(handle, ptr::null()) };
+    assert_eq!(unsafe { read_c_string(ty) }, "dict");
+
+    unsafe { monty_free(handle) };
+}
+
+#[test]
+fn result_path_errors() {
+    let code = c("[1, 2]");
+    let handle = unsafe { monty_create(code.as_ptr(), ptr::null(), ptr::null(), ptr::null_mut()) };
+    let mut error: *mut c_char = ptr::null_mut();
+    assert!(unsafe { monty_result_get_path(handle, ptr::null(), &mut error) }.is_null());
+    assert_eq!(unsafe { read_c_string(error) }, "handle is not complete");
+    assert_eq!(unsafe { monty_result_len(handle, ptr::null()) }, -1);
+
+    unsafe { monty_run(handle, ptr::null_mut(), ptr::null_mut()) };
+    let path = c("[5]");
+    let mut error: *mut c_char = ptr::null_mut();
+    assert!(unsafe { monty_result_get_path(handle, path.as_ptr(), &mut error) }.is_null());
+    assert!(unsafe { read_c_string(error) }.contains("out of range"));
+    let mut error: *mut c_char = ptr::null_mut();
+    let slice = unsafe { monty_result_slice(handle, c("[0]").as_ptr(), 0, 1, &mut error) };
+    assert!(slice.is_null());
+    assert!(unsafe { read_c_string(error) }.contains("cannot slice int"));
+    assert!(unsafe { monty_result_type(handle, path.as_ptr()) }.is_null());
+
+    assert!(unsafe { monty_result_get_path(ptr::null(), ptr::null(), ptr::null_mut()) }.is_null());
+    assert_eq!(unsafe { monty_result_len(ptr::null(), ptr::null()) }, -1);
+    unsafe { monty_free(handle) };
+}
+
+// ---------------------------------------------------------------------------
+// Batch execution
+// ---------------------------------------------------------------------------
+
+fn batch_program(code: &str, names: &str) -> *mut MontyProgram {
+    let code = c(code);
+    let names = c(names);
+    let program = unsafe {
+        monty_program_compile_with_inputs(
+            code.as_ptr(),
+            ptr::null(),
+            names.as_ptr(),
+            ptr::null(),
+            ptr::null_mut(),
+        )
+    };
+    assert!(!program.is_null());
+    program
+}
+
+fn batch_inputs(xs: &[i64]) -> Vec<u8> {
+    encode_object(&MontyObject::List(
+        xs.iter()
+            .map(|&x| {
+                MontyObject::dict(vec![(MontyObject::String("x".into()), MontyObject::Int(x))])
+            })
+            .collect(),
+    ))
+}
+
+/// `(tag, value)` of one decoded `(result_tag, envelope)` batch result.
+fn batch_value(result: &MontyObject) -> (i64, MontyObject) {
+    let MontyObject::Tuple(items) = result else {
+        panic!("expected tuple, got {result:?}");
+    };
+    let MontyObject::Int(tag) = items[0] else {
+        panic!("expected tag");
+    };
+    let MontyObject::Dict(envelope) = &items[1] else {
+        panic!("expected envelope");
+    };
+    let value = envelope
+        .into_iter()
+        .find(|(k, _)| k == &MontyObject::String("value".into()))
+        .map(|(_, v)| v.clone())
+        .unwrap();
+    (tag, value)
+}
+
+#[test]
+fn run_batch_returns_results_in_order() {
+    let program = batch_program("x * x", "x");
+    let xs: Vec<i64> = (0..20).collect();
+    let inputs = batch_inputs(&xs);
+    let mut out: *mut u8 = ptr::null_mut();
+    let mut out_len: usize = 0;
+    let mut error: *mut c_char = ptr::null_mut();
+    let limits = c(r#"{"timeout_ms": 5000}"#);
+    let rc = unsafe {
+        monty_run_batch(
+            program,
+            inputs.as_ptr(),
+            inputs.len(),
+            3,
+            limits.as_ptr(),
+            ptr::null(),
+            None,
+            ptr::null_mut(),
+            &mut out,
+            &mut out_len,
+            &mut error,
+        )
+    };
+    assert_eq!(rc, 0);
+    assert!(error.is_null());
+    let bytes = unsafe { std::slice::from_raw_parts(out, out_len) };
+    let MontyObject::List(results) = decode_object(bytes).unwrap() else {
+        panic!("expected list");
+    };
+    assert_eq!(results.len(), xs.len());
+    for (x, result) in xs.iter().zip(&results) {
+        assert_eq!(batch_value(result), (0, MontyObject::Int(x * x)));
+    }
+    unsafe { monty_bytes_free(out, out_len) };
+
+    // The program is untouched and can run another batch.
+    let inputs = batch_inputs(&[9]);
+    let rc = unsafe {
+        monty_run_batch(
+            program,
+            inputs.as_ptr(),
+            inputs.len(),
+            0,
+            ptr::null(),
+            ptr::null(),
+            None,
+            ptr::null_mut(),
+            &mut out,
+            &mut out_len,
+            ptr::null_mut(),
+        )
+    };
+    assert_eq!(rc, 0);
+    let bytes = unsafe { std::slice::from_raw_parts(out, out_len) };
+    let MontyObject::List(results) = decode_object(bytes).unwrap() else {
+        panic!("expected list");
+    };
+    assert_eq!(batch_value(&results[0]), (0, MontyObject::Int(81)));
+    unsafe { monty_bytes_free(out, out_len) };
+    unsafe { monty_program_free(program) };
+}
+
+unsafe extern "C" fn collect_batch_result(
+    user_data: *mut std::ffi::c_void,
+    index: usize,
+    result: *const u8,
+    len: usize,
+) {
+    let results = unsafe { &mut *(user_data as *mut Vec<(usize, MontyObject)>) };
+    let bytes = unsafe { std::slice::from_raw_parts(result, len) };
+    results.push((index, decode_object(bytes).unwrap()));
+}
+
+#[test]
+fn run_batch_streams_results_to_a_callback() {
+    let program = batch_program("1 // x", "x");
+    let inputs = batch_inputs(&[1, 0, 4]);
+    let mut results: Vec<(usize, MontyObject)> = Vec::new();
+    let rc = unsafe {
+        monty_run_batch(
+            program,
+            inputs.as_ptr(),
+            inputs.len(),
+            2,
+            ptr::null(),
+            ptr::null(),
+            Some(collect_batch_result),
+            &mut results as *mut _ as *mut std::ffi::c_void,
+            ptr::null_mut(),
+            ptr::null_mut(),
+            ptr::null_mut(),
+        )
+    };
+    assert_eq!(rc, 0);
+    results.sort_by_key(|(i, _)| *i);
+    let indices: Vec<usize> = results.iter().map(|(i, _)| *i).collect();
+    assert_eq!(indices, [0, 1, 2]);
+    assert_eq!(batch_value(&results[0].1), (0, MontyObject::Int(1)));
+    // One failing job reports its error without stopping the others.
+    assert_eq!(batch_value(&results[1].1).0, MontyResultTag::Error as i64);
+    assert_eq!(batch_value(&results[2].1), (0, MontyObject::Int(0)));
+    unsafe { monty_program_free(program) };
+}
+
+#[test]
+fn interrupt_stops_run_batch_on_another_thread() {
+    let interrupt = monty_interrupt_new();
+    // Raw pointers are not Send; both are thread-safe by contract.
+    let interrupt_addr = interrupt as usize;
+    let program_addr = batch_program("while True:\n    x += 1", "x") as usize;
+
+    let worker = std::thread::spawn(move || {
+        let inputs = batch_inputs(&[0, 1, 2, 3]);
+        let mut out: *mut u8 = ptr::null_mut();
+        let mut out_len: usize = 0;
+        let rc = unsafe {
+            monty_run_batch(
+                program_addr as *const MontyProgram,
+                inputs.as_ptr(),
+                inputs.len(),
+                2,
+                ptr::null(),
+                interrupt_addr as *const MontyInterrupt,
+                None,
+                ptr::null_mut(),
+                &mut out,
+                &mut out_len,
+                ptr::null_mut(),
+            )
+        };
+        assert_eq!(rc, 0);
+        let bytes = unsafe { std::slice::from_raw_parts(out, out_len) };
+        let results = decode_object(bytes).unwrap();
+        unsafe { monty_bytes_free(out, out_len) };
+        results
+    });
+
+    std::thread::sleep(std::time::Duration::from_millis(50));
+    unsafe { monty_interrupt(interrupt) };
+    let MontyObject::List(results) = worker.join().unwrap() else {
+        panic!("expected list");
+    };
+
+    // Running jobs stop and the rest never start; every job still reports.
+    assert_eq!(results.len(), 4);
+    for result in &results {
+        assert_eq!(batch_value(result).0, MontyResultTag::Error as i64);
+    }
+    unsafe { monty_interrupt_free(interrupt) };
+    unsafe { monty_program_free(program_addr as *mut MontyProgram) };
+}
+
+#[test]
+fn run_batch_rejects_bad_arguments() {
+    let program = batch_program("x", "x");
+    let mut out: *mut u8 = ptr::null_mut();
+    let mut out_len: usize = 0;
+    let run = |inputs: &[u8], limits: *const c_char, out: *mut *mut u8, out_len: *mut usize| {
+        let mut error: *mut c_char = ptr::null_mut();
+        let rc = unsafe {
+            monty_run_batch(
+                program,
+                inputs.as_ptr(),
+                inputs.len(),
+                0,
+                limits,
+                ptr::null(),
+                None,
+                ptr::null_mut(),
+                out,
+                out_len,
+                &mut error,
+            )
+        };
+        assert_eq!(rc, -1);
+        unsafe { read_c_string(error) }
+    };
+
+    let not_a_list = encode_object(&MontyObject::Int(1));
+    assert!(run(&not_a_list, ptr::null(), &mut out, &mut out_len).contains("list"));
+    let inputs = batch_inputs(&[1]);
+    let limits = c("[");
+    assert!(run(&inputs, limits.as_ptr(), &mut out, &mut out_len).contains("limits"));
+    assert!(run(&inputs, ptr::null(), ptr::null_mut(), ptr::null_mut()).contains("out_results"));
+    assert!(out.is_null());
+
+    let rc = unsafe {
+        monty_run_batch(
+            ptr::null(),
+            inputs.as_ptr(),
+            inputs.len(),
+            0,
+            ptr::null(),
+            ptr::null(),
+            None,
+            ptr::null_mut(),
+            &mut out,
+            &mut out_len,
+            ptr::null_mut(),
+        )
+    };
+    assert_eq!(rc, -1);
+    unsafe { monty_program_free(program) };
+}
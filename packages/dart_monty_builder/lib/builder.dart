@@ -0,0 +1,12 @@
+/// `build_runner` builder that precompiles `.py` assets into Monty
+/// snapshots; see [PrecompileBuilder].
+library;
+
+import 'package:build/build.dart';
+import 'package:dart_monty_builder/src/precompile_builder.dart';
+
+export 'src/precompile_builder.dart' show PrecompileBuilder;
+
+/// Creates a [PrecompileBuilder] from its `build.yaml` options.
+Builder precompileBuilder(BuilderOptions options) =>
+    PrecompileBuilder.fromOptions(options);
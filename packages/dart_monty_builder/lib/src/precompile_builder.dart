@@ -0,0 +1,91 @@
+import 'dart:io';
+
+import 'package:build/build.dart';
+
+/// Precompiles each `.py` asset into a `.monty` snapshot container next
+/// to it, by running the `monty_precompile` tool from `native/`.
+///
+/// The app then runs the bundled bytes with `MontyFfi.runPrecompiled` or
+/// `MontyFfi.startPrecompiled`, so nothing is compiled on the device.
+/// Enable it for the assets to precompile in the app's `build.yaml`:
+///
+/// ```yaml
+/// targets:
+///   $default:
+///     builders:
+///       dart_monty_builder:precompile:
+///         enabled: true
+///         generate_for: ['assets/python/**.py']
+///         options:
+///           external_functions: [fetch]
+/// ```
+///
+/// Options:
+///
+/// - `executable`: path to `monty_precompile` (default: found on `PATH`),
+///   built by `cargo build --release` in `native/`. Use the build matching
+///   the native library the app ships, since snapshots are tied to it.
+/// - `external_functions`: names the precompiled code may call.
+class PrecompileBuilder implements Builder {
+  /// Creates a [PrecompileBuilder] running [executable] and declaring
+  /// [externalFunctions] for every asset.
+  PrecompileBuilder({
+    this.executable = defaultExecutable,
+    this.externalFunctions = const [],
+  });
+
+  /// Reads [executable] and [externalFunctions] from `build.yaml`
+  /// options (`executable`, `external_functions`).
+  factory PrecompileBuilder.fromOptions(BuilderOptions options) {
+    final config = options.config;
+    final names = config['external_functions'] as List<Object?>? ?? const [];
+
+    return PrecompileBuilder(
+      executable: config['executable'] as String? ?? defaultExecutable,
+      externalFunctions: [for (final name in names) name! as String],
+    );
+  }
+
+  /// Default for [executable].
+  static const defaultExecutable = 'monty_precompile';
+
+  /// The precompiler to run.
+  final String executable;
+
+  /// External functions declared for every precompiled asset.
+  final List<String> externalFunctions;
+
+  @override
+  Map<String, List<String>> get buildExtensions => const {
+        '.py': ['.monty'],
+      };
+
+  @override
+  Future<void> build(BuildStep buildStep) async {
+    final input = buildStep.inputId;
+    final temp = await Directory.systemTemp.createTemp('monty_precompile');
+    try {
+      final source = File('${temp.path}/${input.pathSegments.last}');
+      await source.writeAsBytes(await buildStep.readAsBytes(input));
+      final output = File('${temp.path}/out.monty');
+      final result = await Process.run(executable, [
+        for (final name in externalFunctions) ...['--external', name],
+        '--script-name',
+        input.path,
+        source.path,
+        output.path,
+      ]);
+      if (result.exitCode != 0) {
+        log.severe('Precompiling ${input.path} failed: ${result.stderr}');
+
+        return;
+      }
+      await buildStep.writeAsBytes(
+        input.changeExtension('.monty'),
+        await output.readAsBytes(),
+      );
+    } finally {
+      await temp.delete(recursive: true);
+    }
+  }
+}
@@ -0,0 +1,71 @@
+@TestOn('!windows')
+library;
+
+import 'dart:io';
+
+import 'package:build/build.dart';
+import 'package:build_test/build_test.dart';
+import 'package:dart_monty_builder/builder.dart';
+import 'package:test/test.dart';
+
+void main() {
+  late Directory temp;
+  late String executable;
+
+  setUp(() {
+    temp = Directory.systemTemp.createTempSync('precompile_builder_test');
+    // Stands in for monty_precompile: records its arguments and copies the
+    // source to the output path.
+    executable = '${temp.path}/fake_precompile';
+    File(executable).writeAsStringSync('''
+#!/bin/sh
+echo "\$@" > "${temp.path}/args"
+for arg; do src=\$out; out=\$arg; done
+case \$(cat "\$src") in fail*) echo "SyntaxError" >&2; exit 1;; esac
+cp "\$src" "\$out"
+''');
+    Process.runSync('chmod', ['+x', executable]);
+  });
+
+  tearDown(() => temp.deleteSync(recursive: true));
+
+  test('writes a .monty output per .py asset', () async {
+    await testBuilder(
+      PrecompileBuilder(executable: executable, externalFunctions: ['fetch']),
+      {'app|assets/add.py': '1 + 2'},
+      outputs: {'app|assets/add.monty': '1 + 2'},
+    );
+
+    final args = File('${temp.path}/args').readAsStringSync();
+    expect(args, startsWith('--external fetch --script-name assets/add.py '));
+  });
+
+  test('logs a failed precompile and writes nothing', () async {
+    final logs = <String>[];
+
+    await testBuilder(
+      PrecompileBuilder(executable: executable),
+      {'app|assets/bad.py': 'fail'},
+      outputs: const {},
+      onLog: (record) => logs.add(record.message),
+    );
+
+    expect(logs.single, contains('SyntaxError'));
+  });
+
+  test('reads options from build.yaml', () {
+    final builder = precompileBuilder(
+      const BuilderOptions({
+        'executable': '/opt/monty_precompile',
+        'external_functions': ['a', 'b'],
+      }),
+    ) as PrecompileBuilder;
+
+    expect(builder.executable, '/opt/monty_precompile');
+    expect(builder.externalFunctions, ['a', 'b']);
+    expect(
+      (precompileBuilder(BuilderOptions.empty) as PrecompileBuilder).executable,
+      PrecompileBuilder.defaultExecutable,
+    );
+  });
+}
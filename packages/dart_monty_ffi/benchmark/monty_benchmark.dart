@@ -0,0 +1,21 @@
+/// Benchmarks the FFI backend over both value transports.
+///
+/// Run from packages/dart_monty_ffi after building the native library:
+///   DART_MONTY_LIB_PATH=../../native/target/release/libdart_monty_native.so \
+///     dart run benchmark/monty_benchmark.dart
+library;
+
+import 'package:dart_monty_ffi/dart_monty_ffi.dart';
+
+import '../../dart_monty_platform_interface/benchmark/monty_benchmarks.dart';
+
+Future<void> main() async {
+  await runMontyBenchmarks(
+    'ffi',
+    () => MontyFfi(bindings: NativeBindingsFfi()),
+  );
+  await runMontyBenchmarks(
+    'ffi_json',
+    () => MontyFfi(bindings: NativeBindingsFfi(binaryTransport: false)),
+  );
+}
@@ -3,6 +3,9 @@ library;
 
 export 'src/ffi_core_bindings.dart';
 export 'src/monty_ffi.dart';
+export 'src/monty_program_cache.dart';
+export 'src/monty_value_codec.dart';
+export 'src/monty_value_ref.dart';
 export 'src/native_bindings.dart';
 export 'src/native_bindings_ffi.dart';
 export 'src/native_library_loader.dart';
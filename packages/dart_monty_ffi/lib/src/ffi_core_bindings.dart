@@ -1,6 +1,10 @@
+import 'dart:async';
 import 'dart:convert';
 import 'dart:typed_data';
 
+import 'package:dart_monty_ffi/src/monty_program_cache.dart';
+import 'package:dart_monty_ffi/src/monty_value_codec.dart';
+import 'package:dart_monty_ffi/src/monty_value_ref.dart';
 import 'package:dart_monty_ffi/src/native_bindings.dart';
 import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
 
@@ -9,9 +13,9 @@ import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart
 /// [CoreProgressResult]).
 ///
 /// Owns the handle lifecycle internally — callers never see the raw `int`
-/// handle. Translation methods extract JSON from the FFI result structs
-/// and map them to the core intermediate types that [BaseMontyPlatform]
-/// consumes.
+/// handle. Translation methods decode the FFI result structs (JSON or
+/// binary, see [NativeBindings.binaryTransport]) and map them to the core
+/// intermediate types that [BaseMontyPlatform] consumes.
 ///
 /// ```dart
 /// final bindings = FfiCoreBindings(bindings: NativeBindingsFfi());
@@ -19,10 +23,103 @@ import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart
 /// ```
 class FfiCoreBindings implements MontyCoreBindings {
   /// Creates an [FfiCoreBindings] backed by [bindings].
-  FfiCoreBindings({required NativeBindings bindings}) : _bindings = bindings;
+  ///
+  /// [maxBufferedOutput] caps the print output retained natively between
+  /// two reads while [output] has a listener; see [output].
+  ///
+  /// If [programCache] is given, [run] and [start] create their handles
+  /// through it, so code seen before is not compiled again. The cache is
+  /// not disposed with these bindings.
+  ///
+  /// If [reuseHandles] is `true`, a finished handle is kept and reset
+  /// with the next program instead of being freed; see [reuseHandles].
+  ///
+  /// If [interrupt] is given, every handle watches it instead of an
+  /// interrupt owned by these bindings; see [interrupt].
+  ///
+  /// If [encodedValues] is `true`, result values are left in the binary
+  /// encoding; see [encodedValues].
+  FfiCoreBindings({
+    required NativeBindings bindings,
+    this.maxBufferedOutput = defaultMaxBufferedOutput,
+    this.programCache,
+    this.reuseHandles = false,
+    this.interrupt,
+    this.encodedValues = false,
+  }) : _bindings = bindings;
+
+  /// Default for [maxBufferedOutput]: 1 MiB.
+  static const defaultMaxBufferedOutput = 1 << 20;
+
+  /// Most bytes of print output the native side retains between two
+  /// reads when the bindings buffer it instead of calling back line by
+  /// line (see [NativeBindings.setOutputStream]); older output is
+  /// replaced by a `[... N bytes dropped]` line. `0` is unbounded.
+  final int maxBufferedOutput;
+
+  /// Cache used to create handles for [run] and [start], if any.
+  final MontyProgramCache? programCache;
+
+  /// Whether [run] and [start] reuse the previous execution's handle via
+  /// [NativeBindings.reset] instead of creating a new one.
+  ///
+  /// At most one finished handle is kept; it is freed by [dispose].
+  /// Ignored when [programCache] is set, since cached handles share their
+  /// compiled program rather than compiling it again.
+  final bool reuseHandles;
+
+  /// Address of a caller-owned interrupt (see [NativeBindings.interruptNew])
+  /// watched by every handle, if any.
+  ///
+  /// Setting it from another isolate stops the execution running here at
+  /// its next time check. It is cleared each time [run] or [start] begins
+  /// and is not freed with these bindings. When `null`, [cancel] uses an
+  /// interrupt created on first use.
+  final int? interrupt;
+
+  /// Whether the value of a finished run, feed or complete progress is
+  /// returned as a [MontyEncodedValue] instead of being decoded.
+  ///
+  /// For a caller that only hands the value on, such as an isolate
+  /// worker sending it to the isolate that asked for it. Only takes
+  /// effect with the binary transport; the rest of each result is
+  /// decoded as usual.
+  final bool encodedValues;
 
   final NativeBindings _bindings;
+  int? _ownInterrupt;
   int? _handle;
+  int? _spareHandle;
+  int? _repl;
+  int? _streamedHandle;
+  int? _tracedHandle;
+  // Synchronous, so print output reaches listeners while the VM is still
+  // running inside the native call.
+  final StreamController<String> _output =
+      StreamController.broadcast(sync: true);
+  final StreamController<MontyTraceEvent> _trace =
+      StreamController.broadcast();
+
+  /// Python `print()` output, streamed instead of collected.
+  ///
+  /// While this has a listener, output is emitted here instead of in the
+  /// result's `printOutput`: line by line as Python prints it, with a
+  /// trailing partial line at the next pause or at completion. Listeners
+  /// are called synchronously from inside the running call, so they must
+  /// not call back into these bindings. Bindings that only buffer output
+  /// natively (see [maxBufferedOutput]) emit it each time the VM returns
+  /// control instead. With no listener, output is collected into the
+  /// result as before. REPL [feed] output is always collected.
+  Stream<String> get output => _output.stream;
+
+  /// Timed spans of each call's work.
+  ///
+  /// While this has a listener, handles record native trace events —
+  /// compile, each VM segment, the wait for the host between a pause and
+  /// the next resume, and every value conversion with its size — which
+  /// are emitted here each time the VM returns control, followed by a
+  /// `dart_decode` conversion event for decoding the result in Dart.
+  Stream<MontyTraceEvent> get trace => _trace.stream;
 
   @override
   Future<bool> init() async => true;
@@ -30,34 +127,141 @@ class FfiCoreBindings implements MontyCoreBindings {
   @override
   Future<CoreRunResult> run(
     String code, {
+    String? inputsJson,
     String? limitsJson,
     String? scriptName,
   }) async {
-    final handle = _bindings.create(code, scriptName: scriptName);
+    final handle = _watchInterrupt(
+      _create(
+        code,
+        scriptName: scriptName,
+        inputs: _encodeInputs(inputsJson),
+      ),
+    );
     try {
       _applyLimits(handle, limitsJson);
+      _applyOutputStream(handle);
+      _applyTrace(handle);
       final result = _bindings.run(handle);
+      _drainOutput(handle);
+      _drainTrace(handle);
 
-      return _translateRunResult(result);
+      return _traceDecode(() => _translateRunResult(result));
     } finally {
-      _bindings.free(handle);
+      _freeHandle(handle);
     }
   }
 
+  /// Runs [code] like [run], but leaves a successful value in its native
+  /// handle and returns a [MontyValueRef] for reading it a part at a time.
+  ///
+  /// On error `ref` is `null` and `result` carries the error, as [run]
+  /// would return it. On success `result` has no value, and print output
+  /// is only delivered through [output]. The caller owns the ref's handle
+  /// and frees it with [MontyValueRef.dispose]; it is neither reused nor
+  /// freed by [dispose].
+  Future<({CoreRunResult result, MontyValueRef? ref})> runRef(
+    String code, {
+    String? inputsJson,
+    String? limitsJson,
+    String? scriptName,
+  }) async {
+    final handle = _watchInterrupt(
+      _create(
+        code,
+        scriptName: scriptName,
+        inputs: _encodeInputs(inputsJson),
+      ),
+    );
+    try {
+      _applyLimits(handle, limitsJson);
+      _applyOutputStream(handle);
+      _applyTrace(handle);
+      final result = _bindings.runDeferred(handle);
+      _drainOutput(handle);
+      _drainTrace(handle);
+      if (result.tag == 0) {
+        _forgetHandle(handle);
+
+        return (
+          result: const CoreRunResult(ok: true),
+          ref: MontyValueRef.forHandle(_bindings, handle),
+        );
+      }
+      final translated = _translateRunResult(result);
+      _freeHandle(handle);
+
+      return (result: translated, ref: null);
+    } on Object {
+      _freeHandle(handle);
+      rethrow;
+    }
+  }
+
+  /// Runs [code] to completion once per entry of [inputs], in parallel on
+  /// up to [threads] native threads (`0` for one per core).
+  ///
+  /// [code] is compiled once, with the keys of the first input set as its
+  /// input names; every set must supply the same names. [limitsJson]
+  /// applies to each run. Returns one result per input set, in order; a
+  /// failing run is reported in its own result without stopping the
+  /// others. The code cannot call external functions, and print output is
+  /// collected into each result rather than sent to [output]. Setting
+  /// [interrupt] from another isolate stops the batch.
+  Future<List<CoreRunResult>> runBatch(
+    String code,
+    List<Map<String, Object?>> inputs, {
+    String? limitsJson,
+    String? scriptName,
+    int threads = 0,
+  }) async {
+    if (inputs.isEmpty) return const [];
+    final program = _bindings.compileProgram(
+      code,
+      scriptName: scriptName,
+      inputNames: inputs.first.keys.join(','),
+    );
+    final Uint8List results;
+    try {
+      results = _bindings.runBatch(
+        program,
+        MontyValueCodec.encode(inputs),
+        threads: threads,
+        limitsJson: limitsJson,
+        interrupt: _clearedInterrupt(),
+      );
+    } finally {
+      _bindings.freeProgram(program);
+    }
+
+    return _traceDecode(
+      () => [
+        for (final item in MontyValueCodec.split(results))
+          _translateBatchResult(item),
+      ],
+    );
+  }
+
   @override
   Future<CoreProgressResult> start(
     String code, {
+    String? inputsJson,
     String? extFnsJson,
     String? limitsJson,
     String? scriptName,
   }) async {
     final extFns = _parseExtFns(extFnsJson);
-    final handle = _bindings.create(
-      code,
-      externalFunctions: extFns,
-      scriptName: scriptName,
+    final handle = _watchInterrupt(
+      _create(
+        code,
+        externalFunctions: extFns,
+        scriptName: scriptName,
+        inputs: _encodeInputs(inputsJson),
+      ),
     );
     _applyLimits(handle, limitsJson);
+    _applyOutputStream(handle);
+    _applyTrace(handle);
     final progress = _bindings.start(handle);
 
     return _translateProgressResult(handle, progress);
@@ -71,6 +275,17 @@ class FfiCoreBindings implements MontyCoreBindings {
     return _translateProgressResult(handle, progress);
   }
 
+  /// Resumes with a Dart [value], using the binary transport when the
+  /// bindings support it and JSON otherwise.
+  Future<CoreProgressResult> resumeValue(Object? value) async {
+    final handle = _requireHandle('resume');
+    final progress = _bindings.binaryTransport
+        ? _bindings.resumeBin(handle, MontyValueCodec.encode(value))
+        : _bindings.resume(handle, json.encode(value));
+
+    return _translateProgressResult(handle, progress);
+  }
+
   @override
   Future<CoreProgressResult> resumeWithError(String errorMessage) async {
     final handle = _requireHandle('resumeWithError');
@@ -98,6 +313,56 @@ class FfiCoreBindings implements MontyCoreBindings {
     return _translateProgressResult(handle, progress);
   }
 
+  /// Resolves pending futures with Dart [results] and [errors] keyed by
+  /// call ID, using the binary transport when the bindings support it and
+  /// JSON otherwise.
+  Future<CoreProgressResult> resolveFuturesValues(
+    Map<int, Object?> results, {
+    Map<int, String>? errors,
+  }) async {
+    final handle = _requireHandle('resolveFutures');
+    final ProgressResult progress;
+    if (_bindings.binaryTransport) {
+      progress = _bindings.resolveFuturesBin(
+        handle,
+        MontyValueCodec.encodeCallIdMap(results),
+        errors != null && errors.isNotEmpty
+            ? MontyValueCodec.encodeCallIdMap(errors)
+            : null,
+      );
+    } else {
+      final resultsJson = json.encode(
+        results.map((k, v) => MapEntry(k.toString(), v)),
+      );
+      final errorsJson = errors != null
+          ? json.encode(
+              errors.map((k, v) => MapEntry(k.toString(), v)),
+            )
+          : '{}';
+      progress = _bindings.resolveFutures(handle, resultsJson, errorsJson);
+    }
+
+    return _translateProgressResult(handle, progress);
+  }
+
+  /// Reads the resource usage of the active execution, or `null` when no
+  /// execution is paused.
+  Future<MontyResourceUsage?> usage() async {
+    final handle = _handle;
+
+    return handle != null ? _bindings.usage(handle) : null;
+  }
+
+  /// Inspects the live heap and stack of the active execution, or returns
+  /// `null` when no execution is paused.
+  Future<MontyInspection?> inspect() async {
+    final handle = _handle;
+    if (handle == null) return null;
+    final inspection = json.decode(_bindings.inspectJson(handle));
+
+    return MontyInspection.fromJson(inspection as Map<String, dynamic>);
+  }
+
   @override
   Future<Uint8List> snapshot() async {
     final handle = _requireHandle('snapshot');
@@ -107,16 +372,134 @@ class FfiCoreBindings implements MontyCoreBindings {
 
   @override
   Future<void> restoreSnapshot(Uint8List data) async {
-    _handle = _bindings.restore(data);
+    _handle = _watchInterrupt(_bindings.restore(data));
+  }
+
+  /// Writes a snapshot of the active handle to [path] as a snapshot
+  /// container.
+  Future<void> snapshotToFile(String path) async {
+    final handle = _requireHandle('snapshotToFile');
+    _bindings.snapshotToFile(handle, path);
+  }
+
+  /// Replaces the active handle with one restored from the snapshot
+  /// container file at [path].
+  Future<void> restoreSnapshotFile(String path) async {
+    _handle = _watchInterrupt(_bindings.restoreFile(path));
+  }
+
+  /// Runs a precompiled program to completion, like [run] but without
+  /// parsing or compiling anything.
+  ///
+  /// [data] is a file written by the `monty_precompile` tool (a snapshot
+  /// container), or the [snapshot] of a program that has not started.
+  Future<CoreRunResult> runPrecompiled(
+    Uint8List data, {
+    String? limitsJson,
+  }) async {
+    final handle = _watchInterrupt(_bindings.restore(data));
+    try {
+      _applyLimits(handle, limitsJson);
+      _applyOutputStream(handle);
+      _applyTrace(handle);
+      final result = _bindings.run(handle);
+      _drainOutput(handle);
+      _drainTrace(handle);
+
+      return _traceDecode(() => _translateRunResult(result));
+    } finally {
+      _freeHandle(handle);
+    }
+  }
+
+  /// Starts a precompiled program like [start]; see [runPrecompiled].
+  ///
+  /// The external functions it may call were declared when it was
+  /// precompiled.
+  Future<CoreProgressResult> startPrecompiled(
+    Uint8List data, {
+    String? limitsJson,
+  }) async {
+    final handle = _watchInterrupt(_bindings.restore(data));
+    _applyLimits(handle, limitsJson);
+    _applyOutputStream(handle);
+    _applyTrace(handle);
+    final progress = _bindings.start(handle);
+
+    return _translateProgressResult(handle, progress);
+  }
+
+  /// Reads where the active execution is paused, e.g. after
+  /// [restoreSnapshot] of an in-flight snapshot, or `null` if nothing is
+  /// paused.
+  Future<CoreProgressResult?> progress() async {
+    final handle = _handle;
+    if (handle == null) return null;
+    final progress = _bindings.progress(handle);
+
+    return progress != null ? _translateProgressResult(handle, progress) : null;
+  }
+
+  /// Runs [code] in a persistent native REPL session, creating it on
+  /// first use with [scriptName].
+  ///
+  /// Globals persist inside the VM between calls, so each call compiles
+  /// and runs only [code]. Limits in [limitsJson] apply from this call
+  /// on, each call getting the full time limit. [scriptName] is ignored
+  /// once the session exists; call [resetSession] to change it.
+  Future<CoreRunResult> feed(
+    String code, {
+    String? limitsJson,
+    String? scriptName,
+  }) async {
+    var repl = _repl;
+    if (repl == null) {
+      repl = _bindings.replCreate(scriptName: scriptName);
+      _repl = repl;
+    }
+    _applyReplLimits(repl, limitsJson);
+
+    return _translateRunResult(_bindings.replFeed(repl, code));
+  }
+
+  /// Interrupts the active execution, if any.
+  ///
+  /// Calls here are synchronous, so nothing is running while this runs; a
+  /// paused execution fails with a `KeyboardInterrupt` on its next resume.
+  /// To stop a running one, set [interrupt] from another isolate instead.
+  Future<void> cancel() async {
+    final interrupt = this.interrupt ?? _ownInterrupt;
+    if (interrupt != null) _bindings.interrupt(interrupt);
+  }
+
+  /// Frees the REPL session, if any. The next [feed] starts a new one.
+  Future<void> resetSession() async {
+    final repl = _repl;
+    if (repl != null) {
+      _bindings.replFree(repl);
+      _repl = null;
+    }
   }
 
   @override
   Future<void> dispose() async {
     final handle = _handle;
     if (handle != null) {
-      _bindings.free(handle);
-      _handle = null;
+      _freeHandle(handle);
+    }
+    final spare = _spareHandle;
+    if (spare != null) {
+      _spareHandle = null;
+      _bindings.free(spare);
+    }
+    final ownInterrupt = _ownInterrupt;
+    if (ownInterrupt != null) {
+      _ownInterrupt = null;
+      _bindings.interruptFree(ownInterrupt);
     }
+    await resetSession();
+    await _output.close();
+    await _trace.close();
   }
 
   // ---------------------------------------------------------------------------
@@ -125,11 +508,10 @@ class FfiCoreBindings implements MontyCoreBindings {
 
   CoreRunResult _translateRunResult(RunResult result) {
     if (result.tag == 0) {
-      final resultJson = result.resultJson;
-      if (resultJson == null) {
+      final jsonMap = _decodeEnvelope(result.resultJson, result.resultBin);
+      if (jsonMap == null) {
         throw StateError('OK result JSON is null');
       }
-      final jsonMap = json.decode(resultJson) as Map<String, dynamic>;
       final usageMap = jsonMap['usage'] as Map<String, dynamic>?;
       final errorMap = jsonMap['error'] as Map<String, dynamic>?;
 
@@ -145,9 +527,8 @@ class FfiCoreBindings implements MontyCoreBindings {
     }
 
     // tag == 1: error
-    final resultJson = result.resultJson;
-    if (resultJson != null) {
-      final jsonMap = json.decode(resultJson) as Map<String, dynamic>;
+    final jsonMap = _decodeEnvelope(result.resultJson, result.resultBin);
+    if (jsonMap != null) {
       final errorMap = jsonMap['error'] as Map<String, dynamic>?;
       if (errorMap != null) {
         return CoreRunResult(
@@ -169,18 +550,41 @@ class FfiCoreBindings implements MontyCoreBindings {
     );
   }
 
+  /// Translates one `[resultTag, envelope]` pair from
+  /// [NativeBindings.runBatch].
+  CoreRunResult _translateBatchResult(Uint8List item) {
+    final parts = MontyValueCodec.split(item);
+
+    return _translateRunResult(
+      RunResult(
+        tag: MontyValueCodec.decode(parts[0])! as int,
+        resultBin: parts[1],
+      ),
+    );
+  }
+
   CoreProgressResult _translateProgressResult(
     int handle,
     ProgressResult progress,
+  ) {
+    _drainOutput(handle);
+    _drainTrace(handle);
+
+    return _traceDecode(() => _decodeProgressResult(handle, progress));
+  }
+
+  CoreProgressResult _decodeProgressResult(
+    int handle,
+    ProgressResult progress,
   ) {
     switch (progress.tag) {
       case 0: // complete
         _freeHandle(handle);
-        final resultJson = progress.resultJson;
-        if (resultJson == null) {
+        final jsonMap =
+            _decodeEnvelope(progress.resultJson, progress.resultBin);
+        if (jsonMap == null) {
           throw StateError('Complete result JSON is null');
         }
-        final jsonMap = json.decode(resultJson) as Map<String, dynamic>;
         final usageMap = jsonMap['usage'] as Map<String, dynamic>?;
         final errorMap = jsonMap['error'] as Map<String, dynamic>?;
 
@@ -196,18 +600,31 @@ class FfiCoreBindings implements MontyCoreBindings {
 
       case 1: // pending
         _handle = handle;
+        final argsBin = progress.argumentsBin;
         final argsJson = progress.argumentsJson;
-        final args = argsJson != null
-            ? List<Object?>.from(
-                json.decode(argsJson) as List<Object?>,
-              )
-            : const <Object?>[];
+        final List<Object?> args;
+        if (argsBin != null) {
+          args = MontyValueCodec.decode(
+            argsBin,
+            typedData: _bindings.typedData,
+          ) as List<Object?>;
+        } else if (argsJson != null) {
+          args = List<Object?>.from(json.decode(argsJson) as List<Object?>);
+        } else {
+          args = const <Object?>[];
+        }
 
+        final kwargsBin = progress.kwargsBin;
         final kwargsJson = progress.kwargsJson;
         Map<String, Object?>? kwargs;
-        if (kwargsJson != null) {
+        if (kwargsBin != null || kwargsJson != null) {
           final decoded = Map<String, Object?>.from(
-            json.decode(kwargsJson) as Map<String, dynamic>,
+            (kwargsBin != null
+                ? MontyValueCodec.decode(
+                    kwargsBin,
+                    typedData: _bindings.typedData,
+                  )
+                : json.decode(kwargsJson!)) as Map<String, dynamic>,
           );
           kwargs = decoded.isNotEmpty ? decoded : null;
         }
@@ -223,9 +640,9 @@ class FfiCoreBindings implements MontyCoreBindings {
 
       case 2: // error
         _freeHandle(handle);
-        final errorResultJson = progress.resultJson;
-        if (errorResultJson != null) {
-          final jsonMap = json.decode(errorResultJson) as Map<String, dynamic>;
+        final jsonMap =
+            _decodeEnvelope(progress.resultJson, progress.resultBin);
+        if (jsonMap != null) {
           final errorMap = jsonMap['error'] as Map<String, dynamic>?;
           if (errorMap != null) {
             return CoreProgressResult(
@@ -271,20 +688,113 @@ class FfiCoreBindings implements MontyCoreBindings {
   // Private helpers
   // ---------------------------------------------------------------------------
 
+  /// Decodes a result envelope from whichever transport populated it.
+  /// Returns `null` if neither is present.
+  Map<String, dynamic>? _decodeEnvelope(String? resultJson, Uint8List? bin) {
+    if (bin != null && encodedValues) {
+      return {
+        for (final MapEntry(:key, value: part)
+            in MontyValueCodec.splitDict(bin).entries)
+          key: key == 'value'
+              ? MontyEncodedValue(part)
+              : MontyValueCodec.decode(part),
+      };
+    }
+    if (bin != null) {
+      return MontyValueCodec.decode(bin, typedData: _bindings.typedData)
+          as Map<String, dynamic>;
+    }
+    if (resultJson == null) return null;
+
+    return json.decode(resultJson) as Map<String, dynamic>;
+  }
+
+  /// Switches [handle] to streamed output the first time it is used
+  /// while [output] has a listener.
+  void _applyOutputStream(int handle) {
+    if (_output.hasListener && _streamedHandle != handle) {
+      _bindings.setOutputStream(
+        handle,
+        maxRetainedBytes: maxBufferedOutput,
+        onOutput: _output.add,
+      );
+      _streamedHandle = handle;
+    }
+  }
+
+  void _drainOutput(int handle) {
+    if (!_output.hasListener) return;
+    final text = _bindings.takeOutput(handle);
+    if (text != null) _output.add(text);
+  }
+
+  /// Starts tracing [handle] the first time it is used while [trace] has
+  /// a listener.
+  void _applyTrace(int handle) {
+    if (_trace.hasListener && _tracedHandle != handle) {
+      _bindings.setTrace(handle, enabled: true);
+      _tracedHandle = handle;
+    }
+  }
+
+  void _drainTrace(int handle) {
+    if (!_trace.hasListener) return;
+    final events = _bindings.takeTrace(handle);
+    if (events == null) return;
+    for (final event in json.decode(events) as List<Object?>) {
+      final parsed = MontyTraceEvent.fromJson(event! as Map<String, dynamic>);
+      if (parsed != null) _trace.add(parsed);
+    }
+  }
+
+  /// Runs [decode], reporting its time on [trace] while that has a
+  /// listener.
+  T _traceDecode<T>(T Function() decode) {
+    if (!_trace.hasListener) return decode();
+    final watch = Stopwatch()..start();
+    final result = decode();
+    _trace.add(
+      MontyTraceEvent(
+        kind: MontyTraceKind.convert,
+        op: 'dart_decode',
+        duration: watch.elapsed,
+      ),
+    );
+
+    return result;
+  }
+
   int _requireHandle(String method) {
     final handle = _handle;
     if (handle == null) {
       throw StateError('Cannot $method: no active handle');
     }
+    _applyOutputStream(handle);
+    _applyTrace(handle);
 
     return handle;
   }
 
   void _freeHandle(int handle) {
+    _forgetHandle(handle);
+    if (reuseHandles && programCache == null && _spareHandle == null) {
+      _spareHandle = handle;
+    } else {
+      _bindings.free(handle);
+    }
+  }
+
+  /// Drops every reference to [handle] without freeing it.
+  void _forgetHandle(int handle) {
     if (_handle == handle) {
       _handle = null;
     }
-    _bindings.free(handle);
+    if (_streamedHandle == handle) {
+      _streamedHandle = null;
+    }
+    if (_tracedHandle == handle) {
+      _tracedHandle = null;
+    }
   }
 
   void _applyLimits(int handle, String? limitsJson) {
@@ -301,6 +811,82 @@ class FfiCoreBindings implements MontyCoreBindings {
     }
   }
 
+  void _applyReplLimits(int session, String? limitsJson) {
+    if (limitsJson == null) return;
+    final limits = json.decode(limitsJson) as Map<String, dynamic>;
+    _bindings.replSetLimits(
+      session,
+      memoryBytes: limits['memory_bytes'] as int?,
+      timeoutMs: limits['timeout_ms'] as int?,
+      stackDepth: limits['stack_depth'] as int?,
+    );
+  }
+
+  /// Clears the interrupt and makes [handle] watch it, for a new or
+  /// restored execution.
+  int _watchInterrupt(int handle) {
+    _bindings.setInterrupt(handle, _clearedInterrupt());
+
+    return handle;
+  }
+
+  /// The interrupt, created on first use, cleared for a new execution.
+  int _clearedInterrupt() {
+    final interrupt =
+        this.interrupt ?? (_ownInterrupt ??= _bindings.interruptNew());
+    _bindings.interruptClear(interrupt);
+
+    return interrupt;
+  }
+
+  /// Creates a handle through [programCache] when there is one, or by
+  /// resetting the spare handle kept by [reuseHandles].
+  int _create(
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    Uint8List? inputs,
+  }) {
+    final cache = programCache;
+    if (cache != null) {
+      return cache.create(
+        code,
+        externalFunctions: externalFunctions,
+        scriptName: scriptName,
+        inputs: inputs,
+      );
+    }
+    final spare = _spareHandle;
+    if (spare != null) {
+      // On a compile error the spare is left untouched and stays kept.
+      _bindings.reset(
+        spare,
+        code,
+        externalFunctions: externalFunctions,
+        scriptName: scriptName,
+        inputs: inputs,
+      );
+      _spareHandle = null;
+
+      return spare;
+    }
+
+    return _bindings.create(
+      code,
+      externalFunctions: externalFunctions,
+      scriptName: scriptName,
+      inputs: inputs,
+    );
+  }
+
+  /// Re-encodes a JSON object of inputs in the binary value format
+  /// expected by [NativeBindings.create].
+  Uint8List? _encodeInputs(String? inputsJson) {
+    if (inputsJson == null) return null;
+
+    return MontyValueCodec.encode(json.decode(inputsJson));
+  }
+
   /// Converts a JSON array of function names to the comma-separated format
   /// expected by [NativeBindings.create].
   String? _parseExtFns(String? extFnsJson) {
@@ -2,14 +2,17 @@ import 'dart:convert';
 import 'dart:typed_data';
 
 import 'package:dart_monty_ffi/src/ffi_core_bindings.dart';
+import 'package:dart_monty_ffi/src/monty_program_cache.dart';
+import 'package:dart_monty_ffi/src/monty_value_ref.dart';
 import 'package:dart_monty_ffi/src/native_bindings.dart';
 import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
 
 /// Native FFI implementation of [MontyPlatform].
 ///
 /// Extends [BaseMontyPlatform] to inherit run/start/resume/dispose logic
-/// and adds [MontySnapshotCapable] and [MontyFutureCapable] capabilities
-/// by delegating to [FfiCoreBindings].
+/// and adds [MontySnapshotCapable], [MontyFutureCapable],
+/// [MontyReplCapable], and [MontyInspectable] capabilities by delegating
+/// to [FfiCoreBindings].
 ///
 /// ```dart
 /// final monty = MontyFfi(bindings: NativeBindingsFfi());
@@ -18,30 +21,92 @@ import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart
 /// await monty.dispose();
 /// ```
 class MontyFfi extends BaseMontyPlatform
-    implements MontySnapshotCapable, MontyFutureCapable {
+    implements
+        MontySnapshotCapable,
+        MontyFutureCapable,
+        MontyReplCapable,
+        MontyInspectable {
   /// Creates a [MontyFfi] with the given [bindings].
-  factory MontyFfi({required NativeBindings bindings}) {
-    final core = FfiCoreBindings(bindings: bindings);
+  ///
+  /// [maxBufferedOutput] caps the print output retained natively between
+  /// two [output] events; see [FfiCoreBindings.maxBufferedOutput].
+  ///
+  /// Pass a [programCache] to reuse compiled programs across runs and
+  /// across every interpreter sharing the cache. It stays owned by the
+  /// caller.
+  ///
+  /// Set [reuseHandles] to reset one native handle between runs instead
+  /// of allocating a new one each time; see [FfiCoreBindings.reuseHandles].
+  ///
+  /// Pass the address of an [interrupt] to stop executions from another
+  /// isolate; see [FfiCoreBindings.interrupt].
+  ///
+  /// Set [encodedValues] to leave result values encoded for handing on;
+  /// see [FfiCoreBindings.encodedValues].
+  factory MontyFfi({
+    required NativeBindings bindings,
+    int maxBufferedOutput = FfiCoreBindings.defaultMaxBufferedOutput,
+    MontyProgramCache? programCache,
+    bool reuseHandles = false,
+    int? interrupt,
+    bool encodedValues = false,
+  }) {
+    final core = FfiCoreBindings(
+      bindings: bindings,
+      maxBufferedOutput: maxBufferedOutput,
+      programCache: programCache,
+      reuseHandles: reuseHandles,
+      interrupt: interrupt,
+      encodedValues: encodedValues,
+    );
     return MontyFfi._(coreBindings: core, nativeBindings: bindings);
   }
 
   MontyFfi._({
     required FfiCoreBindings coreBindings,
     required NativeBindings nativeBindings,
-  })  : _nativeBindings = nativeBindings,
+  })  : _core = coreBindings,
+        _nativeBindings = nativeBindings,
         super(bindings: coreBindings);
 
+  final FfiCoreBindings _core;
   final NativeBindings _nativeBindings;
 
   @override
   String get backendName => 'MontyFfi';
 
+  /// Python `print()` output as the VM produces it.
+  ///
+  /// Output is emitted line by line while the VM runs, as long as this has
+  /// a listener, and is then left out of [MontyResult.printOutput].
+  /// Listeners run inside the call that is running the VM and must not
+  /// call back into this instance. See [FfiCoreBindings.output].
+  @override
+  Stream<String> get output => _core.output;
+
+  /// Native trace events for each call while this has a listener. See
+  /// [FfiCoreBindings.trace].
+  @override
+  Stream<MontyTraceEvent> get trace => _core.trace;
+
+  @override
+  Future<CoreProgressResult> resumeCore(Object? returnValue) {
+    return _core.resumeValue(returnValue);
+  }
+
+  @override
+  Future<CoreProgressResult> resolveFuturesCore(
+    Map<int, Object?> results, {
+    Map<int, String>? errors,
+  }) {
+    return _core.resolveFuturesValues(results, errors: errors);
+  }
+
   @override
   Future<MontyProgress> resumeAsFuture() async {
     assertNotDisposed('resumeAsFuture');
     assertActive('resumeAsFuture');
-    final progress = await coreBindings.resumeAsFuture();
-    return translateProgress(progress);
+    return resumePendingAsFuture();
   }
 
   @override
@@ -51,19 +116,174 @@ class MontyFfi extends BaseMontyPlatform
   }) async {
     assertNotDisposed('resolveFutures');
     assertActive('resolveFutures');
-    final resultsJson = json.encode(
-      results.map((k, v) => MapEntry(k.toString(), v)),
+    return resolvePendingFutures(results, errors: errors);
+  }
+
+  /// Runs [code] to completion like [run], but leaves the value on the
+  /// native side and returns a [MontyValueRef] that reads it a part at a
+  /// time, serializing only what is asked for.
+  ///
+  /// Use it when a script returns a large structure of which only a few
+  /// keys are needed. Throws [MontyException] if the code fails, as [run]
+  /// does. Print output is only delivered through [output]. Call
+  /// [MontyValueRef.dispose] once done with the value.
+  Future<MontyValueRef> runRef(
+    String code, {
+    Map<String, Object?>? inputs,
+    MontyLimits? limits,
+    String? scriptName,
+  }) async {
+    assertNotDisposed('runRef');
+    assertIdle('runRef');
+    final limitsMap = limits?.toJson();
+    final (:result, :ref) = await _core.runRef(
+      code,
+      inputsJson: inputs != null && inputs.isNotEmpty
+          ? json.encode(inputs)
+          : null,
+      limitsJson: limitsMap != null && limitsMap.isNotEmpty
+          ? json.encode(limitsMap)
+          : null,
+      scriptName: scriptName,
+    );
+    if (ref != null) return ref;
+    translateRunResult(result);
+
+    throw StateError('runRef failed without an error');
+  }
+
+  /// Runs [code] once per entry of [inputs] in parallel on a pool of
+  /// native threads, compiling it only once.
+  ///
+  /// [threads] caps the pool (`0` for one per core). Results come back in
+  /// input order, and each input set must supply the same names. The
+  /// calling isolate blocks until every run has finished; to stop the
+  /// batch early, set the interrupt passed to the constructor (see
+  /// [FfiCoreBindings.interrupt]) from another isolate.
+  @override
+  Future<List<MontyResult>> runBatch(
+    String code,
+    List<Map<String, Object?>> inputs, {
+    MontyLimits? limits,
+    String? scriptName,
+    int threads = 0,
+  }) async {
+    assertNotDisposed('runBatch');
+    assertIdle('runBatch');
+    final limitsMap = limits?.toJson();
+    final results = await _core.runBatch(
+      code,
+      inputs,
+      limitsJson: limitsMap != null && limitsMap.isNotEmpty
+          ? json.encode(limitsMap)
+          : null,
+      scriptName: scriptName,
+      threads: threads,
     );
-    final errorsJson = errors != null
-        ? json.encode(
-            errors.map((k, v) => MapEntry(k.toString(), v)),
-          )
-        : '{}';
-    final progress = await coreBindings.resolveFutures(
-      resultsJson,
-      errorsJson,
+
+    return [for (final result in results) _batchResult(result)];
+  }
+
+  /// Runs a program precompiled at build time by the `monty_precompile`
+  /// tool (or the `dart_monty_builder:precompile` builder), without
+  /// compiling it on the device.
+  ///
+  /// [data] is the precompiled file's bytes, e.g. a bundled asset. The
+  /// program must have been precompiled by the same native library
+  /// version. Throws [MontyException] if the code fails, as [run] does.
+  Future<MontyResult> runPrecompiled(
+    Uint8List data, {
+    MontyLimits? limits,
+  }) async {
+    assertNotDisposed('runPrecompiled');
+    assertIdle('runPrecompiled');
+    final limitsMap = limits?.toJson();
+    final result = await _core.runPrecompiled(
+      data,
+      limitsJson: limitsMap != null && limitsMap.isNotEmpty
+          ? json.encode(limitsMap)
+          : null,
     );
-    return translateProgress(progress);
+    return translateRunResult(result);
+  }
+
+  /// Starts a precompiled program like [start]; see [runPrecompiled].
+  ///
+  /// Its external functions were declared when it was precompiled.
+  Future<MontyProgress> startPrecompiled(
+    Uint8List data, {
+    MontyLimits? limits,
+  }) async {
+    assertNotDisposed('startPrecompiled');
+    assertIdle('startPrecompiled');
+    final limitsMap = limits?.toJson();
+    final progress = await _core.startPrecompiled(
+      data,
+      limitsJson: limitsMap != null && limitsMap.isNotEmpty
+          ? json.encode(limitsMap)
+          : null,
+    );
+    return coalesceProgress(progress);
+  }
+
+  /// Reads the resource usage of the paused execution so far, or `null`
+  /// when idle.
+  Future<MontyResourceUsage?> currentUsage() async {
+    assertNotDisposed('currentUsage');
+    return _core.usage();
+  }
+
+  /// Reads where the active execution is paused — most usefully right
+  /// after [restore] of an in-flight snapshot — or `null` if nothing is
+  /// paused.
+  Future<MontyProgress?> pendingProgress() async {
+    assertNotDisposed('pendingProgress');
+    final progress = await _core.progress();
+    return progress != null ? translateProgress(progress) : null;
+  }
+
+  /// Inspects the heap and stack of the paused execution, or returns
+  /// `null` when idle.
+  @override
+  Future<MontyInspection?> inspect() async {
+    assertNotDisposed('inspect');
+    return _core.inspect();
+  }
+
+  @override
+  Future<MontyResult> feed(
+    String code, {
+    MontyLimits? limits,
+    String? scriptName,
+  }) async {
+    assertNotDisposed('feed');
+    assertIdle('feed');
+    final limitsMap = limits?.toJson();
+    final result = await _core.feed(
+      code,
+      limitsJson: limitsMap != null && limitsMap.isNotEmpty
+          ? json.encode(limitsMap)
+          : null,
+      scriptName: scriptName,
+    );
+    return translateRunResult(result);
+  }
+
+  /// Interrupts the paused execution, if any, so that its next resume
+  /// fails with a `KeyboardInterrupt`.
+  ///
+  /// FFI calls block this isolate, so this cannot reach a running
+  /// execution; see [FfiCoreBindings.cancel].
+  @override
+  Future<void> cancel() async {
+    if (isDisposed) return;
+    await _core.cancel();
+  }
+
+  @override
+  Future<void> resetSession() async {
+    assertNotDisposed('resetSession');
+    await _core.resetSession();
   }
 
   @override
@@ -77,9 +297,64 @@ class MontyFfi extends BaseMontyPlatform
   Future<MontyPlatform> restore(Uint8List data) async {
     assertNotDisposed('restore');
     assertIdle('restore');
-    final core = FfiCoreBindings(bindings: _nativeBindings);
+    final core = FfiCoreBindings(
+      bindings: _nativeBindings,
+      maxBufferedOutput: _core.maxBufferedOutput,
+      programCache: _core.programCache,
+      reuseHandles: _core.reuseHandles,
+      interrupt: _core.interrupt,
+      encodedValues: _core.encodedValues,
+    );
     await core.restoreSnapshot(data);
     return MontyFfi._(coreBindings: core, nativeBindings: _nativeBindings)
-      ..markActive();
+      ..markActive()
+      ..callCache = callCache;
+  }
+
+  /// Writes a snapshot of the active execution to [path] as a snapshot
+  /// container file, for a later [restoreFile].
+  ///
+  /// Valid in the same states as [snapshot]. The bytes go straight from
+  /// the native side to disk without passing through Dart.
+  Future<void> snapshotToFile(String path) async {
+    assertNotDisposed('snapshotToFile');
+    assertActive('snapshotToFile');
+    await coreBindings.snapshotToFile(path);
+  }
+
+  /// Restores a snapshot container file written by [snapshotToFile] into a
+  /// new [MontyFfi] instance.
+  ///
+  /// The header and checksum are verified, then the file is memory-mapped
+  /// and deserialized in place where the platform allows, so a cold start
+  /// costs page faults rather than a read and copy.
+  Future<MontyPlatform> restoreFile(String path) async {
+    assertNotDisposed('restoreFile');
+    assertIdle('restoreFile');
+    final core = FfiCoreBindings(
+      bindings: _nativeBindings,
+      maxBufferedOutput: _core.maxBufferedOutput,
+      programCache: _core.programCache,
+      reuseHandles: _core.reuseHandles,
+      interrupt: _core.interrupt,
+      encodedValues: _core.encodedValues,
+    );
+    await core.restoreSnapshotFile(path);
+    return MontyFfi._(coreBindings: core, nativeBindings: _nativeBindings)
+      ..markActive()
+      ..callCache = callCache;
+  }
+
+  /// Translates one [runBatch] result, reporting an error as a result
+  /// rather than throwing.
+  MontyResult _batchResult(CoreRunResult result) {
+    try {
+      return translateRunResult(result);
+    } on MontyException catch (e) {
+      return MontyResult(
+        error: e,
+        usage: result.usage ?? MontyResourceUsage.zero,
+      );
+    }
   }
 }
@@ -0,0 +1,109 @@
+import 'dart:typed_data';
+
+import 'package:dart_monty_ffi/src/native_bindings.dart';
+
+/// A native cache of compiled programs, shared by every interpreter that
+/// uses it.
+///
+/// Programs are keyed by a hash of their source together with the
+/// external function names, script name, and input names, and evicted
+/// least recently used first once [capacityBytes] is exceeded. Creating an
+/// execution for code already in the cache skips parsing and compilation.
+///
+/// With a `directory`, the cache also persists compiled programs there and
+/// loads them when the next process creates its cache, so autoscaled
+/// workers skip recompiling on startup.
+///
+/// The native cache is thread-safe and reference counted: pass [address]
+/// to another isolate and wrap it there with [MontyProgramCache.attach].
+/// Each wrapper must be [dispose]d; the cache is freed with the last one.
+///
+/// ```dart
+/// final bindings = NativeBindingsFfi();
+/// final cache = MontyProgramCache(bindings: bindings);
+/// final monty = MontyFfi(bindings: bindings, programCache: cache);
+/// await monty.run('2 + 2'); // compiles
+/// await monty.run('2 + 2'); // cache hit
+/// print(cache.stats.hits); // 1
+/// ```
+class MontyProgramCache {
+  /// Creates a cache holding roughly [capacityBytes] of compiled programs.
+  /// `0` disables caching.
+  ///
+  /// If [directory] is given, programs are also stored in it and loaded
+  /// from it on a miss; see [NativeBindings.cacheNew]. Programs written by
+  /// a build against a different monty revision are ignored. Throws
+  /// `MontyException` if the directory cannot be created.
+  MontyProgramCache({
+    required NativeBindings bindings,
+    int capacityBytes = defaultCapacityBytes,
+    String? directory,
+  })  : _bindings = bindings,
+        address = bindings.cacheNew(capacityBytes, directory: directory);
+
+  /// Wraps the existing cache at [address], taking a reference to it.
+  MontyProgramCache.attach({
+    required NativeBindings bindings,
+    required this.address,
+  }) : _bindings = bindings {
+    bindings.cacheRetain(address);
+  }
+
+  /// Default for the `capacityBytes` constructor argument: 16 MiB.
+  static const defaultCapacityBytes = 16 << 20;
+
+  final NativeBindings _bindings;
+  bool _disposed = false;
+
+  /// Address of the native cache, for [MontyProgramCache.attach].
+  final int address;
+
+  /// Hit/miss and size counters.
+  ProgramCacheStats get stats {
+    _assertNotDisposed('stats');
+    return _bindings.cacheStats(address);
+  }
+
+  /// The size limit the cache was created with.
+  int get capacityBytes => stats.capacityBytes;
+
+  /// Drops every program cached in memory. Counters and the directory are
+  /// kept.
+  void clear() {
+    _assertNotDisposed('clear');
+    _bindings.cacheClear(address);
+  }
+
+  /// Creates a handle for [code] through the cache; see
+  /// [NativeBindings.createCached].
+  int create(
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    Uint8List? inputs,
+  }) {
+    _assertNotDisposed('create');
+    return _bindings.createCached(
+      address,
+      code,
+      externalFunctions: externalFunctions,
+      scriptName: scriptName,
+      inputs: inputs,
+    );
+  }
+
+  /// Releases this reference to the cache. Safe to call more than once.
+  ///
+  /// Handles created through the cache remain valid.
+  void dispose() {
+    if (_disposed) return;
+    _disposed = true;
+    _bindings.cacheFree(address);
+  }
+
+  void _assertNotDisposed(String method) {
+    if (_disposed) {
+      throw StateError('Cannot call $method() on a disposed cache');
+    }
+  }
+}
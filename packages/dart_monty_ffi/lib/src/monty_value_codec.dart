@@ -0,0 +1,499 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+/// Codec for the compact binary value encoding used by the `*_bin`
+/// functions in `dart_monty.h`.
+///
+/// Each value is a one-byte tag followed by its payload. All integers are
+/// little-endian; lengths and element counts are uint32.
+///
+/// [decode] produces the same Dart shapes as `json.decode` of the JSON
+/// API, so callers can switch transports without changing how they read
+/// values:
+///
+/// - BigInt outside the 64-bit range → decimal `String`
+/// - NaN / ±Infinity → `'NaN'` / `'Infinity'` / `'-Infinity'`
+/// - Tuple, Set, FrozenSet → `List`
+/// - Dict with only `String` keys → `Map<String, Object?>`, otherwise a
+///   `List` of `[key, value]` pairs
+/// - Bytes → `List` of `int`
+/// - Ellipsis → `'...'`
+///
+/// Lists of only ints or only floats arrive packed, but decode to a
+/// `List` like any other list whatever their length.
+///
+/// With `typedData: true`, [decode] instead returns Bytes as a
+/// [Uint8List] and every packed list as an [Int64List] or [Float64List],
+/// a packed float list keeping NaN and ±Infinity as doubles. These are
+/// views into the decoded buffer where its alignment allows, so a large
+/// result is not copied again.
+abstract final class MontyValueCodec {
+  static const _tagNone = 0x00;
+  static const _tagFalse = 0x01;
+  static const _tagTrue = 0x02;
+  static const _tagInt = 0x03;
+  static const _tagBigInt = 0x04;
+  static const _tagFloat = 0x05;
+  static const _tagString = 0x06;
+  static const _tagBytes = 0x07;
+  static const _tagList = 0x08;
+  static const _tagTuple = 0x09;
+  static const _tagDict = 0x0A;
+  static const _tagSet = 0x0B;
+  static const _tagFrozenSet = 0x0C;
+  static const _tagEllipsis = 0x0D;
+  static const _tagIntArray = 0x0E;
+  static const _tagFloatArray = 0x0F;
+
+  static final _minInt64 = BigInt.parse('-9223372036854775808');
+  static final _maxInt64 = BigInt.parse('9223372036854775807');
+
+  /// Encodes [value] for `monty_resume_bin` / `monty_resume_futures_bin`.
+  ///
+  /// Supports `null`, [bool], [int], [double] (including non-finite),
+  /// [String], [BigInt], [List], [Set], and [Map] with any encodable keys.
+  /// [Int64List] and [Float64List] encode packed and arrive as a Python
+  /// `list` of `int` / `float`. Other typed lists such as [Uint8List]
+  /// encode as a Python `list`, matching the JSON transport. Any other
+  /// object is converted through its `toJson()` method, as `json.encode`
+  /// would.
+  static Uint8List encode(Object? value) {
+    final writer = _Writer()..value(value);
+
+    return writer.takeBytes();
+  }
+
+  /// Encodes a call-ID-keyed map for `monty_resume_futures_bin`.
+  static Uint8List encodeCallIdMap(Map<int, Object?> values) {
+    final writer = _Writer()..dict(values);
+
+    return writer.takeBytes();
+  }
+
+  /// Splits an encoded List or Tuple into views of its encoded elements,
+  /// without decoding them.
+  ///
+  /// Used to pick apart the progress descriptors returned by
+  /// `monty_progress_bin` and the `monty_*_step` functions, so argument
+  /// and result payloads can be handed on without re-encoding.
+  ///
+  /// Throws [FormatException] if [bytes] is not a single List or Tuple.
+  static List<Uint8List> split(Uint8List bytes) {
+    final reader = _Reader(bytes);
+    final tag = reader._byte();
+    if (tag != _tagList && tag != _tagTuple) {
+      throw FormatException('Expected a List or Tuple', bytes, 0);
+    }
+    final count = reader._u32();
+    final parts = <Uint8List>[];
+    for (var i = 0; i < count; i++) {
+      final start = reader.offset;
+      reader.skip();
+      parts.add(Uint8List.sublistView(bytes, start, reader.offset));
+    }
+    if (reader.offset != bytes.length) {
+      throw FormatException(
+        'Trailing bytes after value',
+        bytes,
+        reader.offset,
+      );
+    }
+
+    return parts;
+  }
+
+  /// Splits an encoded Dict with only `String` keys into views of its
+  /// encoded values, decoding only the keys.
+  ///
+  /// Used to leave a result envelope's `value` encoded while its other
+  /// fields are read; see [MontyEncodedValue].
+  ///
+  /// Throws [FormatException] if [bytes] is not a single Dict or has a
+  /// key that is not a `String`.
+  static Map<String, Uint8List> splitDict(Uint8List bytes) {
+    final reader = _Reader(bytes);
+    if (reader._byte() != _tagDict) {
+      throw FormatException('Expected a Dict', bytes, 0);
+    }
+    final count = reader._u32();
+    final parts = <String, Uint8List>{};
+    for (var i = 0; i < count; i++) {
+      final keyOffset = reader.offset;
+      final key = reader.value();
+      if (key is! String) {
+        throw FormatException('Expected a String key', bytes, keyOffset);
+      }
+      final start = reader.offset;
+      reader.skip();
+      parts[key] = Uint8List.sublistView(bytes, start, reader.offset);
+    }
+    if (reader.offset != bytes.length) {
+      throw FormatException(
+        'Trailing bytes after value',
+        bytes,
+        reader.offset,
+      );
+    }
+
+    return parts;
+  }
+
+  /// Decodes a single value produced by the native `*_bin` accessors.
+  ///
+  /// Set [typedData] to get Bytes and packed lists as typed-list views
+  /// instead of `List`s; see [MontyValueCodec].
+  ///
+  /// Throws [FormatException] on malformed input or trailing bytes.
+  static Object? decode(Uint8List bytes, {bool typedData = false}) {
+    final reader = _Reader(bytes, typedData: typedData);
+    final value = reader.value();
+    if (reader.offset != bytes.length) {
+      throw FormatException(
+        'Trailing bytes after value',
+        bytes,
+        reader.offset,
+      );
+    }
+
+    return value;
+  }
+}
+
+/// A value still in the binary encoding, standing in for the decoded
+/// value while it is handed on unread.
+///
+/// Produced in place of `MontyResult.value` by bindings created with
+/// `FfiCoreBindings.encodedValues`, so a value bound for another isolate
+/// crosses as one buffer and is decoded only where it is used.
+final class MontyEncodedValue {
+  /// Wraps [bytes], one value as produced by the native `*_bin` accessors.
+  const MontyEncodedValue(this.bytes);
+
+  /// The encoded value.
+  final Uint8List bytes;
+
+  /// Decodes [bytes] with [MontyValueCodec.decode].
+  Object? decode({bool typedData = false}) =>
+      MontyValueCodec.decode(bytes, typedData: typedData);
+
+  @override
+  String toString() => 'MontyEncodedValue(${bytes.length} bytes)';
+}
+
+final class _Writer {
+  Uint8List _buf = Uint8List(64);
+  late ByteData _data = ByteData.sublistView(_buf);
+  int _len = 0;
+
+  Uint8List takeBytes() => Uint8List.sublistView(_buf, 0, _len);
+
+  void _reserve(int extra) {
+    final needed = _len + extra;
+    if (needed <= _buf.length) return;
+    var size = _buf.length * 2;
+    while (size < needed) {
+      size *= 2;
+    }
+    _buf = Uint8List(size)..setRange(0, _len, _buf);
+    _data = ByteData.sublistView(_buf);
+  }
+
+  void _byte(int b) {
+    _reserve(1);
+    _buf[_len++] = b;
+  }
+
+  void _u32(int n) {
+    _reserve(4);
+    _data.setUint32(_len, n, Endian.little);
+    _len += 4;
+  }
+
+  void _raw(List<int> bytes) {
+    _reserve(bytes.length);
+    _buf.setRange(_len, _len + bytes.length, bytes);
+    _len += bytes.length;
+  }
+
+  void value(Object? v) {
+    switch (v) {
+      case null:
+        _byte(MontyValueCodec._tagNone);
+      case true:
+        _byte(MontyValueCodec._tagTrue);
+      case false:
+        _byte(MontyValueCodec._tagFalse);
+      case final int n:
+        _reserve(9);
+        _buf[_len++] = MontyValueCodec._tagInt;
+        _data.setInt64(_len, n, Endian.little);
+        _len += 8;
+      case final double f:
+        _reserve(9);
+        _buf[_len++] = MontyValueCodec._tagFloat;
+        _data.setFloat64(_len, f, Endian.little);
+        _len += 8;
+      case final String s:
+        final utf8Bytes = utf8.encode(s);
+        _byte(MontyValueCodec._tagString);
+        _u32(utf8Bytes.length);
+        _raw(utf8Bytes);
+      case final BigInt n:
+        _bigInt(n);
+      case final Int64List items:
+        _packed(MontyValueCodec._tagIntArray, items);
+      case final Float64List items:
+        _packed(MontyValueCodec._tagFloatArray, items);
+      case final List<Object?> items:
+        _seq(MontyValueCodec._tagList, items);
+      case final Set<Object?> items:
+        _seq(MontyValueCodec._tagSet, items);
+      case final Map<Object?, Object?> map:
+        dict(map);
+      default:
+        // Mirror json.encode: fall back to the object's toJson().
+        value(json.decode(json.encode(v)));
+    }
+  }
+
+  void dict(Map<Object?, Object?> map) {
+    _byte(MontyValueCodec._tagDict);
+    _u32(map.length);
+    for (final MapEntry(:key, value: v) in map.entries) {
+      value(key);
+      value(v);
+    }
+  }
+
+  void _seq(int tag, Iterable<Object?> items) {
+    _byte(tag);
+    _u32(items.length);
+    items.forEach(value);
+  }
+
+  void _packed(int tag, TypedData items) {
+    final count = items.lengthInBytes ~/ 8;
+    _byte(tag);
+    _u32(count);
+    // Pad so the elements start on an 8-byte boundary, as the native side
+    // writes them.
+    final pad = (8 - (_len + 1) % 8) % 8;
+    _reserve(1 + pad);
+    _buf.fillRange(_len, _len + 1 + pad, 0);
+    _buf[_len] = pad;
+    _len += 1 + pad;
+    _raw(items.buffer.asUint8List(items.offsetInBytes, items.lengthInBytes));
+  }
+
+  void _bigInt(BigInt n) {
+    if (n >= MontyValueCodec._minInt64 && n <= MontyValueCodec._maxInt64) {
+      value(n.toInt());
+
+      return;
+    }
+    final magnitude = <int>[];
+    final byteMask = BigInt.from(0xFF);
+    for (var rest = n.abs(); rest > BigInt.zero; rest >>= 8) {
+      magnitude.add((rest & byteMask).toInt());
+    }
+    _byte(MontyValueCodec._tagBigInt);
+    _byte(n.isNegative ? 1 : 0);
+    _u32(magnitude.length);
+    _raw(magnitude);
+  }
+}
+
+final class _Reader {
+  _Reader(this._bytes, {this.typedData = false})
+      : _data = ByteData.sublistView(_bytes);
+
+  final Uint8List _bytes;
+  final ByteData _data;
+  final bool typedData;
+  int offset = 0;
+
+  void _need(int n) {
+    if (offset + n > _bytes.length) {
+      throw FormatException('Unexpected end of input', _bytes, offset);
+    }
+  }
+
+  int _byte() {
+    _need(1);
+
+    return _bytes[offset++];
+  }
+
+  int _u32() {
+    _need(4);
+    final n = _data.getUint32(offset, Endian.little);
+    offset += 4;
+
+    return n;
+  }
+
+  Uint8List _take(int n) {
+    _need(n);
+    final view = Uint8List.sublistView(_bytes, offset, offset + n);
+    offset += n;
+
+    return view;
+  }
+
+  Object? value() {
+    final tagOffset = offset;
+    final tag = _byte();
+    switch (tag) {
+      case MontyValueCodec._tagNone:
+        return null;
+      case MontyValueCodec._tagFalse:
+        return false;
+      case MontyValueCodec._tagTrue:
+        return true;
+      case MontyValueCodec._tagInt:
+        _need(8);
+        final n = _data.getInt64(offset, Endian.little);
+        offset += 8;
+
+        return n;
+      case MontyValueCodec._tagBigInt:
+        final negative = _byte() != 0;
+        final magnitude = _take(_u32());
+        var n = BigInt.zero;
+        for (var i = magnitude.length - 1; i >= 0; i--) {
+          n = (n << 8) | BigInt.from(magnitude[i]);
+        }
+
+        return (negative ? -n : n).toString();
+      case MontyValueCodec._tagFloat:
+        _need(8);
+        final f = _data.getFloat64(offset, Endian.little);
+        offset += 8;
+
+        return _float(f);
+      case MontyValueCodec._tagString:
+        return utf8.decode(_take(_u32()));
+      case MontyValueCodec._tagBytes:
+        final bytes = _take(_u32());
+
+        return typedData ? bytes : List<Object?>.of(bytes);
+      case MontyValueCodec._tagIntArray:
+        final elements = _aligned(_packed());
+        final ints = elements.buffer
+            .asInt64List(elements.offsetInBytes, elements.length ~/ 8);
+
+        return typedData ? ints : List<Object?>.of(ints);
+      case MontyValueCodec._tagFloatArray:
+        final elements = _aligned(_packed());
+        final floats = elements.buffer
+            .asFloat64List(elements.offsetInBytes, elements.length ~/ 8);
+
+        return typedData ? floats : [for (final f in floats) _float(f)];
+      case MontyValueCodec._tagList ||
+            MontyValueCodec._tagTuple ||
+            MontyValueCodec._tagSet ||
+            MontyValueCodec._tagFrozenSet:
+        final count = _u32();
+
+        return List<Object?>.generate(count, (_) => value());
+      case MontyValueCodec._tagDict:
+        return _dict(_u32());
+      case MontyValueCodec._tagEllipsis:
+        return '...';
+      default:
+        throw FormatException(
+          'Unknown value tag 0x${tag.toRadixString(16).padLeft(2, '0')}',
+          _bytes,
+          tagOffset,
+        );
+    }
+  }
+
+  /// Advances past one value without decoding it.
+  void skip() {
+    final tagOffset = offset;
+    final tag = _byte();
+    switch (tag) {
+      case MontyValueCodec._tagNone ||
+            MontyValueCodec._tagFalse ||
+            MontyValueCodec._tagTrue ||
+            MontyValueCodec._tagEllipsis:
+        return;
+      case MontyValueCodec._tagInt || MontyValueCodec._tagFloat:
+        _take(8);
+      case MontyValueCodec._tagBigInt:
+        _byte();
+        _take(_u32());
+      case MontyValueCodec._tagString || MontyValueCodec._tagBytes:
+        _take(_u32());
+      case MontyValueCodec._tagIntArray || MontyValueCodec._tagFloatArray:
+        _packed();
+      case MontyValueCodec._tagList ||
+            MontyValueCodec._tagTuple ||
+            MontyValueCodec._tagSet ||
+            MontyValueCodec._tagFrozenSet:
+        for (var i = _u32(); i > 0; i--) {
+          skip();
+        }
+      case MontyValueCodec._tagDict:
+        for (var i = _u32() * 2; i > 0; i--) {
+          skip();
+        }
+      default:
+        throw FormatException(
+          'Unknown value tag 0x${tag.toRadixString(16).padLeft(2, '0')}',
+          _bytes,
+          tagOffset,
+        );
+    }
+  }
+
+  /// [f] as `json.decode` of the JSON API gives it: non-finite values as
+  /// strings.
+  static Object _float(double f) {
+    if (f.isNaN) return 'NaN';
+    if (f.isInfinite) return f.isNegative ? '-Infinity' : 'Infinity';
+
+    return f;
+  }
+
+  /// Reads a packed array header, returning a view of its elements.
+  Uint8List _packed() {
+    final count = _u32();
+    _take(_byte());
+
+    return _take(count * 8);
+  }
+
+  /// Returns [elements] if they can be viewed as 64-bit values in place,
+  /// otherwise an aligned copy.
+  ///
+  /// Views need [Endian.host] to be little-endian, as it is on every
+  /// platform the native library supports.
+  static Uint8List _aligned(Uint8List elements) {
+    return elements.offsetInBytes % 8 == 0
+        ? elements
+        : Uint8List.fromList(elements);
+  }
+
+  Object _dict(int count) {
+    final keys = List<Object?>.filled(count, null);
+    final values = List<Object?>.filled(count, null);
+    var allStringKeys = true;
+    for (var i = 0; i < count; i++) {
+      final key = value();
+      keys[i] = key;
+      values[i] = value();
+      if (key is! String) allStringKeys = false;
+    }
+    if (allStringKeys) {
+      return <String, Object?>{
+        for (var i = 0; i < count; i++) keys[i]! as String: values[i],
+      };
+    }
+
+    return [
+      for (var i = 0; i < count; i++) [keys[i], values[i]],
+    ];
+  }
+}
@@ -0,0 +1,113 @@
+import 'dart:ffi' show Finalizable;
+
+import 'package:dart_monty_ffi/src/native_bindings.dart';
+import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
+
+/// A completed value left in its native handle and read a part at a time.
+///
+/// Returned by `MontyFfi.runRef`. Indexing with `[]` only extends the
+/// path; nothing crosses to the native side until [value], [slice],
+/// [length] or [type] is read, and then only the selected part is
+/// serialized. Forwarding a few keys of a large result therefore costs
+/// those keys, not the whole structure.
+///
+/// ```dart
+/// final ref = await monty.runRef(code);
+/// try {
+///   final name = ref['users'][0]['name'].value;
+///   final count = ref['users'].length;
+/// } finally {
+///   ref.dispose();
+/// }
+/// ```
+///
+/// Every ref derived from the same result shares its handle; [dispose]
+/// on any of them frees it, after which all of them throw [StateError].
+final class MontyValueRef {
+  /// Wraps a completed [handle], taking ownership of it.
+  ///
+  /// [handle] must have run to completion without error, e.g. via
+  /// [NativeBindings.runDeferred].
+  MontyValueRef.forHandle(NativeBindings bindings, int handle)
+      : this._(_ResultHandle(bindings, handle), const []);
+
+  MontyValueRef._(this._result, this.path);
+
+  final _ResultHandle _result;
+
+  /// Steps from the result value to this part of it: [String] dict keys
+  /// and [int] indices.
+  final List<Object> path;
+
+  /// The ref for `key` within this value: a [String] dict key, or an
+  /// [int] list/tuple index (negative from the end) or integer dict key.
+  ///
+  /// Does not read anything; a missing key surfaces when the returned ref
+  /// is read.
+  MontyValueRef operator [](Object key) {
+    if (key is! String && key is! int) {
+      throw ArgumentError.value(key, 'key', 'Must be a String or an int');
+    }
+
+    return MontyValueRef._(_result, List.unmodifiable([...path, key]));
+  }
+
+  /// Reads this part of the result, decoded like a [MontyResult.value].
+  ///
+  /// Throws [MontyException] if [path] does not resolve.
+  Object? get value => _result.bindings.resultGet(_result.handle, path);
+
+  /// Reads `value[start:end]` of a list, tuple, str or bytes, with
+  /// Python's handling of negative and out-of-range bounds. A `null`
+  /// [end] slices to the end.
+  ///
+  /// Throws [MontyException] if [path] does not resolve or the value
+  /// cannot be sliced.
+  Object? slice(int start, [int? end]) =>
+      _result.bindings.resultSlice(_result.handle, path, start, end);
+
+  /// `len()` of this value, or `null` if it has no length or [path] does
+  /// not resolve.
+  int? get length => _result.bindings.resultLength(_result.handle, path);
+
+  /// Python type name of this value (`dict`, `list`, `int`, ...), or
+  /// `null` if [path] does not resolve.
+  String? get type => _result.bindings.resultType(_result.handle, path);
+
+  /// Whether the handle behind this ref has been freed.
+  bool get isDisposed => _result.isDisposed;
+
+  /// Frees the handle behind this ref and every ref sharing it. Safe to
+  /// call more than once.
+  void dispose() => _result.dispose();
+
+  @override
+  String toString() => 'MontyValueRef(${path.join('/')})';
+}
+
+/// A handle shared by every [MontyValueRef] into one result.
+///
+/// The handle is freed by [dispose], or natively once every ref into it
+/// has been garbage collected, as for a ref dropped without disposing.
+final class _ResultHandle implements Finalizable {
+  _ResultHandle(this.bindings, int handle) : _handle = handle {
+    bindings.attachFree(this, handle);
+  }
+
+  final NativeBindings bindings;
+  int? _handle;
+
+  int get handle =>
+      _handle ?? (throw StateError('MontyValueRef used after dispose'));
+
+  bool get isDisposed => _handle == null;
+
+  void dispose() {
+    final handle = _handle;
+    if (handle == null) return;
+    _handle = null;
+    bindings
+      ..detachFree(this)
+      ..free(handle);
+  }
+}
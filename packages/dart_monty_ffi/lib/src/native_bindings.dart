@@ -1,11 +1,19 @@
+import 'dart:ffi' show Finalizable;
 import 'dart:typed_data';
 
+import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
+
 /// Result of [NativeBindings.run].
 ///
-/// Contains either a JSON result string or an error message.
+/// Contains either a result envelope (JSON or binary) or an error message.
 final class RunResult {
   /// Creates a [RunResult].
-  const RunResult({required this.tag, this.resultJson, this.errorMessage});
+  const RunResult({
+    required this.tag,
+    this.resultJson,
+    this.resultBin,
+    this.errorMessage,
+  });
 
   /// `0` = OK, `1` = error.
   final int tag;
@@ -13,6 +21,10 @@ final class RunResult {
   /// JSON string with the execution result (when tag == 0).
   final String? resultJson;
 
+  /// Binary-encoded result envelope, used instead of [resultJson] when
+  /// [NativeBindings.binaryTransport] is enabled.
+  final Uint8List? resultBin;
+
   /// Error message (when tag == 1).
   final String? errorMessage;
 }
@@ -27,10 +39,13 @@ final class ProgressResult {
     required this.tag,
     this.functionName,
     this.argumentsJson,
+    this.argumentsBin,
     this.kwargsJson,
+    this.kwargsBin,
     this.callId,
     this.methodCall,
     this.resultJson,
+    this.resultBin,
     this.isError,
     this.errorMessage,
     this.futureCallIdsJson,
@@ -45,9 +60,17 @@ final class ProgressResult {
   /// Pending function arguments as JSON array (when tag == 1).
   final String? argumentsJson;
 
+  /// Pending function arguments as a binary-encoded list (when tag == 1
+  /// and [NativeBindings.binaryTransport] is enabled).
+  final Uint8List? argumentsBin;
+
   /// Pending keyword arguments as JSON object (when tag == 1).
   final String? kwargsJson;
 
+  /// Pending keyword arguments as a binary-encoded dict (when tag == 1
+  /// and [NativeBindings.binaryTransport] is enabled).
+  final Uint8List? kwargsBin;
+
   /// Unique call identifier for this pending call (when tag == 1).
   final int? callId;
 
@@ -57,6 +80,10 @@ final class ProgressResult {
   /// Completed result as JSON string (when tag == 0).
   final String? resultJson;
 
+  /// Binary-encoded result envelope (when tag == 0 or 2 and
+  /// [NativeBindings.binaryTransport] is enabled).
+  final Uint8List? resultBin;
+
   /// Whether the completed result is an error: `1` = yes, `0` = no,
   /// `-1` = not in complete state (when tag == 0).
   final int? isError;
@@ -68,7 +95,42 @@ final class ProgressResult {
   final String? futureCallIdsJson;
 }
 
-/// Abstract interface over the 17 native C functions.
+/// Counters returned by [NativeBindings.cacheStats].
+final class ProgramCacheStats {
+  /// Creates a [ProgramCacheStats].
+  const ProgramCacheStats({
+    required this.hits,
+    required this.misses,
+    required this.entries,
+    required this.bytes,
+    required this.capacityBytes,
+    this.diskLoads = 0,
+    this.diskWrites = 0,
+  });
+
+  /// Handles created from an already compiled program.
+  final int hits;
+
+  /// Handles that had to compile their program.
+  final int misses;
+
+  /// Programs currently cached.
+  final int entries;
+
+  /// Approximate size of the cached programs.
+  final int bytes;
+
+  /// The limit the cache was created with.
+  final int capacityBytes;
+
+  /// Programs read from the cache directory instead of compiled.
+  final int diskLoads;
+
+  /// Programs written to the cache directory.
+  final int diskWrites;
+}
+
+/// Abstract interface over the native C API in `dart_monty.h`.
 ///
 /// Uses `int` handles (the pointer address) instead of `Pointer<T>` types
 /// so that the interface remains pure Dart and trivially mockable.
@@ -79,6 +141,21 @@ abstract class NativeBindings {
   /// Creates a [NativeBindings].
   NativeBindings();
 
+  /// Whether values cross the boundary in the binary encoding decoded by
+  /// `MontyValueCodec`.
+  ///
+  /// When `true`, results populate the `*Bin` fields instead of the
+  /// `*Json` ones, and callers should prefer [resumeBin] and
+  /// [resolveFuturesBin].
+  bool get binaryTransport;
+
+  /// Whether binary-transport values decode bytes and lists of only ints
+  /// or only floats as typed lists, as `MontyValueCodec.decode` does with
+  /// `typedData`.
+  ///
+  /// When `false`, they decode to `List`s, as from the JSON transport.
+  bool get typedData => false;
+
   /// Creates a handle from Python [code].
   ///
   /// If [externalFunctions] is non-null, it is a comma-separated list of
@@ -87,15 +164,84 @@ abstract class NativeBindings {
   /// If [scriptName] is non-null, it overrides the default filename used
   /// in tracebacks and error messages.
   ///
+  /// If [inputs] is non-null, it is a `MontyValueCodec`-encoded map of
+  /// input names to values, which the code reads as global variables.
+  ///
   /// Returns the handle address as an `int`, or throws on error.
-  int create(String code, {String? externalFunctions, String? scriptName});
+  int create(
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    Uint8List? inputs,
+  });
+
+  /// Loads new [code] into an existing [handle], returning it to the
+  /// ready state.
+  ///
+  /// Takes the same arguments as [create] and drops any paused execution,
+  /// limits and captured output, but keeps the handle's native buffers so
+  /// a reused handle avoids most of the allocation a fresh one needs.
+  ///
+  /// Throws [MontyException] if [code] fails to compile; the handle is
+  /// left unchanged in that case.
+  void reset(
+    int handle,
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    Uint8List? inputs,
+  });
 
   /// Frees the handle at [handle]. Safe to call with `0`.
   void free(int handle);
 
+  /// Frees [handle] natively once [owner] is garbage collected, for an
+  /// owner that may be dropped without being disposed. Call
+  /// [detachFree] with [owner] before freeing [handle] yourself.
+  void attachFree(Finalizable owner, int handle);
+
+  /// Cancels the [attachFree] of [owner], if any.
+  void detachFree(Finalizable owner);
+
   /// Runs the handle to completion.
   RunResult run(int handle);
 
+  /// Runs the handle to completion like [run], but leaves a successful
+  /// value in the handle instead of reading it.
+  ///
+  /// On success [RunResult.resultJson] and [RunResult.resultBin] are
+  /// `null`; read parts of the value with [resultGet] and the other
+  /// `result*` methods until the handle is freed. Errors carry their
+  /// result envelope as [run] does.
+  RunResult runDeferred(int handle);
+
+  /// Reads the part of the completed value at [path], decoded as [run]
+  /// decodes a result value.
+  ///
+  /// Each step of [path] is a [String] dict key or an [int] list/tuple
+  /// index (negative from the end) or integer dict key; `[]` is the
+  /// whole value.
+  ///
+  /// Throws [MontyException] if the handle is not complete or [path]
+  /// does not resolve.
+  Object? resultGet(int handle, List<Object> path);
+
+  /// Reads `value[start:end]` of the list, tuple, str or bytes at [path],
+  /// with Python's handling of negative and out-of-range bounds. A `null`
+  /// [end] slices to the end.
+  ///
+  /// Throws [MontyException] as [resultGet] does, or if the value cannot
+  /// be sliced.
+  Object? resultSlice(int handle, List<Object> path, int start, [int? end]);
+
+  /// `len()` of the value at [path], or `null` if it has no length or
+  /// [path] does not resolve.
+  int? resultLength(int handle, List<Object> path);
+
+  /// Python type name (`dict`, `list`, `int`, ...) of the value at
+  /// [path], or `null` if [path] does not resolve.
+  String? resultType(int handle, List<Object> path);
+
   /// Starts iterative execution. Returns progress with accessor data
   /// already populated.
   ProgressResult start(int handle);
@@ -103,6 +249,9 @@ abstract class NativeBindings {
   /// Resumes with a JSON-encoded return [valueJson].
   ProgressResult resume(int handle, String valueJson);
 
+  /// Resumes with a binary-encoded return [value].
+  ProgressResult resumeBin(int handle, Uint8List value);
+
   /// Resumes with an [errorMessage] (raises RuntimeError in Python).
   ProgressResult resumeWithError(int handle, String errorMessage);
 
@@ -119,6 +268,16 @@ abstract class NativeBindings {
     String errorsJson,
   );
 
+  /// Resolves pending futures with binary-encoded [results] and [errors].
+  ///
+  /// Both are dicts keyed by integer call_id; [errors] maps to error
+  /// message strings and may be `null` for no errors.
+  ProgressResult resolveFuturesBin(
+    int handle,
+    Uint8List results,
+    Uint8List? errors,
+  );
+
   /// Sets the memory limit in bytes.
   void setMemoryLimit(int handle, int bytes);
 
@@ -128,11 +287,207 @@ abstract class NativeBindings {
   /// Sets the stack depth limit.
   void setStackLimit(int handle, int depth);
 
+  /// Creates an interrupt: a cancellation flag that handles watch via
+  /// [setInterrupt].
+  ///
+  /// Returns its address as an `int`; release it with [interruptFree].
+  /// The address may be used from any isolate.
+  int interruptNew();
+
+  /// Releases the interrupt at [interrupt]. Handles watching it keep their
+  /// own reference. Safe to call with `0`.
+  void interruptFree(int interrupt);
+
+  /// Sets [interrupt], so every execution watching it fails with a
+  /// `KeyboardInterrupt` at its next time check, even one running on
+  /// another isolate's thread. It stays set until [interruptClear].
+  void interrupt(int interrupt);
+
+  /// Unsets [interrupt].
+  void interruptClear(int interrupt);
+
+  /// Makes [handle] watch [interrupt], or stop watching with `0`. Applies
+  /// to the current execution, even while paused, and survives [reset].
+  void setInterrupt(int handle, int interrupt);
+
+  /// Streams the print output of [handle] instead of collecting it into
+  /// the completion result's `print_output`.
+  ///
+  /// With [onOutput], output is handed to it line by line while the VM
+  /// runs, synchronously on the calling isolate; a trailing partial line
+  /// follows when the VM next pauses or completes. [onOutput] must not
+  /// call back into these bindings. It is kept until [free].
+  ///
+  /// Without [onOutput], output is buffered for [takeOutput], keeping at
+  /// most the newest [maxRetainedBytes] between calls (`0` keeps
+  /// everything). Takes effect from the next run, start, or resume.
+  void setOutputStream(
+    int handle, {
+    int maxRetainedBytes = 0,
+    void Function(String text)? onOutput,
+  });
+
+  /// Drains the print output buffered for [handle] since the last call,
+  /// or returns `null` if there is none. See [setOutputStream].
+  String? takeOutput(int handle);
+
+  /// Starts or stops recording trace events on [handle]. Tracing stops on
+  /// [reset].
+  void setTrace(int handle, {required bool enabled});
+
+  /// Drains the trace events recorded on [handle] since the last call, as
+  /// a JSON array, or returns `null` if tracing is off. See
+  /// `MontyTraceEvent.fromJson` for the event shape.
+  String? takeTrace(int handle);
+
+  /// Reads the resource usage so far. Valid in every state, including
+  /// while paused at an external call.
+  MontyResourceUsage usage(int handle);
+
+  /// Inspects the live heap and stack of [handle] as a JSON object. Valid
+  /// in every state. See `MontyInspection.fromJson` for the shape.
+  String inspectJson(int handle);
+
   /// Serializes the handle state to a byte buffer (snapshot).
+  ///
+  /// Valid in Ready state and while paused at an external call or waiting
+  /// on futures; an in-flight snapshot captures the whole execution.
   Uint8List snapshot(int handle);
 
+  /// Reads the current progress of [handle] as the last start/resume
+  /// reported it, e.g. after [restore] of an in-flight snapshot.
+  ///
+  /// Returns `null` in Ready state.
+  ProgressResult? progress(int handle);
+
   /// Restores a handle from snapshot [data].
   ///
   /// Returns the new handle address as an `int`, or throws on error.
   int restore(Uint8List data);
+
+  /// Writes the snapshot of [handle] to [path] as a snapshot container
+  /// (versioned, checksummed header plus the [snapshot] bytes).
+  ///
+  /// Throws on error.
+  void snapshotToFile(int handle, String path);
+
+  /// Restores a handle from the snapshot container file at [path].
+  ///
+  /// The file is memory-mapped and deserialized in place where the
+  /// platform allows, so the snapshot never passes through the Dart heap.
+  /// Returns the new handle address as an `int`, or throws on error.
+  int restoreFile(String path);
+
+  /// Compiles Python [code] once into a reusable program.
+  ///
+  /// [externalFunctions] and [scriptName] match [create]. If
+  /// [inputNames] is non-null, it is a comma-separated list of the inputs
+  /// each instance must supply to [instantiateProgram].
+  ///
+  /// Returns the program address as an `int`, or throws on error.
+  int compileProgram(
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    String? inputNames,
+  });
+
+  /// Creates a fresh handle in Ready state from the compiled [program].
+  ///
+  /// [inputs] is encoded as for [create] and must name every input the
+  /// program was compiled with. The program is left untouched. Returns the
+  /// handle address as an `int`, or throws on error. Free the handle with
+  /// [free].
+  int instantiateProgram(int program, {Uint8List? inputs});
+
+  /// Frees the program at [program]. Safe to call with `0`.
+  ///
+  /// Handles already instantiated from it remain valid.
+  void freeProgram(int program);
+
+  /// Runs the compiled [program] to completion once per input set, in
+  /// parallel on native threads. The program is left untouched.
+  ///
+  /// [inputs] is a `MontyValueCodec`-encoded list of maps, each naming
+  /// every input the program was compiled with. [threads] caps the worker
+  /// threads (`0` for one per core), and [limitsJson], if non-null, is
+  /// applied to every run. Every run watches [interrupt], if non-null:
+  /// setting it from another isolate stops the batch, failing the runs
+  /// still going and those not yet started.
+  ///
+  /// Returns an encoded list with one `[resultTag, envelope]` pair per
+  /// input set, in input order, where `envelope` is the binary result
+  /// envelope of that run. A failing run reports its error there;
+  /// throws [MontyException] only if the batch itself is invalid.
+  Uint8List runBatch(
+    int program,
+    Uint8List inputs, {
+    int threads = 0,
+    String? limitsJson,
+    int? interrupt,
+  });
+
+  /// Creates a program cache holding roughly [capacityBytes] of compiled
+  /// programs (`0` disables caching).
+  ///
+  /// If [directory] is non-null, the cache is also backed by that
+  /// directory: compiled programs are written there, and one left by an
+  /// earlier process (built against the same monty revision) is loaded
+  /// instead of compiled the first time it is looked up. Nothing is read
+  /// when the cache is created.
+  ///
+  /// The cache is thread-safe and reference counted, so its address may be
+  /// handed to other isolates that [cacheRetain] it. Returns the cache
+  /// address as an `int`; release it with [cacheFree]. Throws if
+  /// [directory] cannot be created.
+  int cacheNew(int capacityBytes, {String? directory});
+
+  /// Takes another reference to the cache at [cache].
+  void cacheRetain(int cache);
+
+  /// Releases a reference to the cache at [cache], freeing it with the
+  /// last one. Safe to call with `0`.
+  void cacheFree(int cache);
+
+  /// Drops every program [cache] holds in memory. Counters and the cache
+  /// directory are kept.
+  void cacheClear(int cache);
+
+  /// Reads the hit/miss and size counters of [cache].
+  ProgramCacheStats cacheStats(int cache);
+
+  /// Creates a handle like [create], reusing the compiled program from
+  /// [cache] when the same code was compiled before with the same
+  /// [externalFunctions], [scriptName], and input names.
+  ///
+  /// Returns the handle address as an `int`, or throws on error.
+  int createCached(
+    int cache,
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    Uint8List? inputs,
+  });
+
+  /// Creates a persistent REPL session whose globals, functions, and
+  /// imports survive between [replFeed] calls.
+  ///
+  /// Returns the session address as an `int`, or throws on error.
+  int replCreate({String? scriptName});
+
+  /// Runs [code] in the namespace of [session]. Only the new code is
+  /// compiled; earlier state stays live in the VM.
+  RunResult replFeed(int session, String code);
+
+  /// Sets limits for [session] from its next [replFeed] on; `null` leaves
+  /// a limit unchanged. The time limit applies to each feed.
+  void replSetLimits(
+    int session, {
+    int? memoryBytes,
+    int? timeoutMs,
+    int? stackDepth,
+  });
+
+  /// Frees the session at [session]. Safe to call with `0`.
+  void replFree(int session);
 }
@@ -1,8 +1,10 @@
+import 'dart:convert';
 import 'dart:ffi';
 import 'dart:io' show Platform;
 import 'dart:typed_data';
 
 import 'package:dart_monty_ffi/src/generated/dart_monty_bindings.dart';
+import 'package:dart_monty_ffi/src/monty_value_codec.dart';
 import 'package:dart_monty_ffi/src/native_bindings.dart';
 import 'package:dart_monty_ffi/src/native_library_loader.dart';
 import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
@@ -11,15 +13,32 @@ import 'package:ffi/ffi.dart';
 /// Real FFI implementation of [NativeBindings].
 ///
 /// Manages all pointer lifecycle internally: allocates out-params, reads
-/// C strings, and calls `monty_string_free`/`monty_bytes_free`.
+/// C strings, and calls `monty_string_free`. Native byte buffers are
+/// handed out as views released by `monty_bytes_release` once they are
+/// garbage collected.
+///
+/// Out-params come from a [_Scratch] allocated once per instance rather
+/// than a `calloc`/`free` pair per call.
 class NativeBindingsFfi extends NativeBindings {
   /// Creates [NativeBindingsFfi] by opening the native library.
   ///
   /// Pass [libraryPath] to override the default platform resolution.
   /// On iOS, symbols are statically linked into the main executable, so
   /// [DynamicLibrary.process] is used instead of [DynamicLibrary.open].
-  NativeBindingsFfi({String? libraryPath})
-      : _lib = DartMontyBindings(
+  ///
+  /// Set [binaryTransport] to `false` to exchange values as JSON strings
+  /// instead of the binary encoding. Set [typedData] to decode bytes and
+  /// lists of only ints or only floats as typed lists; it requires the
+  /// binary transport.
+  NativeBindingsFfi({
+    String? libraryPath,
+    this.binaryTransport = true,
+    this.typedData = false,
+  })  : assert(
+          binaryTransport || !typedData,
+          'typedData requires binaryTransport',
+        ),
+        _lib = DartMontyBindings(
           Platform.isIOS
               ? DynamicLibrary.process()
               : DynamicLibrary.open(
@@ -29,11 +48,27 @@ class NativeBindingsFfi extends NativeBindings {
 
   final DartMontyBindings _lib;
 
+  final _Scratch _scratch = _Scratch();
+
+  /// Calls `monty_free` on handles given to [attachFree].
+  late final NativeFinalizer _freeFinalizer =
+      NativeFinalizer(_lib.addresses.monty_free.cast());
+
+  /// Print callbacks given to [setOutputStream], by handle.
+  final Map<int, NativeCallable<_OutputCallback>> _outputCallbacks = {};
+
+  @override
+  final bool binaryTransport;
+
+  @override
+  final bool typedData;
+
   @override
   int create(
     String code, {
     String? externalFunctions,
     String? scriptName,
+    Uint8List? inputs,
   }) {
     final cCode = code.toNativeUtf8().cast<Char>();
     final nullChar = nullptr.cast<Char>();
@@ -42,10 +77,20 @@ class NativeBindingsFfi extends NativeBindings {
         : nullChar;
     final cScriptName =
         scriptName != null ? scriptName.toNativeUtf8().cast<Char>() : nullChar;
-    final outError = calloc<Pointer<Char>>();
+    final cInputs = inputs != null ? _copyToNative(inputs) : nullptr;
+    final outError = _scratch.outError;
 
     try {
-      final handle = _lib.monty_create(cCode, cExtFns, cScriptName, outError);
+      final handle = inputs != null
+          ? _lib.monty_create_with_inputs(
+              cCode,
+              cExtFns,
+              cInputs,
+              inputs.length,
+              cScriptName,
+              outError,
+            )
+          : _lib.monty_create(cCode, cExtFns, cScriptName, outError);
       if (handle == nullptr) {
         final errorMsg = _readAndFreeString(outError.value);
         throw MontyException(message: errorMsg ?? 'monty_create returned null');
@@ -56,7 +101,47 @@ class NativeBindingsFfi extends NativeBindings {
       calloc.free(cCode);
       if (externalFunctions != null) calloc.free(cExtFns);
       if (scriptName != null) calloc.free(cScriptName);
-      calloc.free(outError);
+      if (inputs != null) calloc.free(cInputs);
+    }
+  }
+
+  @override
+  void reset(
+    int handle,
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    Uint8List? inputs,
+  }) {
+    final cCode = code.toNativeUtf8().cast<Char>();
+    final nullChar = nullptr.cast<Char>();
+    final cExtFns = externalFunctions != null
+        ? externalFunctions.toNativeUtf8().cast<Char>()
+        : nullChar;
+    final cScriptName =
+        scriptName != null ? scriptName.toNativeUtf8().cast<Char>() : nullChar;
+    final cInputs = inputs != null ? _copyToNative(inputs) : nullptr;
+    final outError = _scratch.outError;
+
+    try {
+      final rc = _lib.monty_reset(
+        Pointer<MontyHandle>.fromAddress(handle),
+        cCode,
+        cExtFns,
+        cInputs,
+        inputs?.length ?? 0,
+        cScriptName,
+        outError,
+      );
+      if (rc != 0) {
+        final errorMsg = _readAndFreeString(outError.value);
+        throw MontyException(message: errorMsg ?? 'monty_reset failed');
+      }
+    } finally {
+      calloc.free(cCode);
+      if (externalFunctions != null) calloc.free(cExtFns);
+      if (scriptName != null) calloc.free(cScriptName);
+      if (inputs != null) calloc.free(cInputs);
     }
   }
 
@@ -64,59 +149,183 @@ class NativeBindingsFfi extends NativeBindings {
   void free(int handle) {
     if (handle == 0) return;
     _lib.monty_free(Pointer<MontyHandle>.fromAddress(handle));
+    _outputCallbacks.remove(handle)?.close();
+  }
+
+  @override
+  void attachFree(Finalizable owner, int handle) {
+    if (handle == 0) return;
+    _freeFinalizer.attach(
+      owner,
+      Pointer<Void>.fromAddress(handle),
+      detach: owner,
+    );
   }
 
+  @override
+  void detachFree(Finalizable owner) => _freeFinalizer.detach(owner);
+
   @override
   RunResult run(int handle) {
     final ptr = Pointer<MontyHandle>.fromAddress(handle);
-    final outResult = calloc<Pointer<Char>>();
-    final outError = calloc<Pointer<Char>>();
+    final outResult = _scratch.outResult;
+    final outError = _scratch.outError;
+
+    // In binary mode, pass NULL so the JSON envelope is never built.
+    final tag = _lib.monty_run(
+      ptr,
+      binaryTransport ? nullptr : outResult,
+      outError,
+    );
+    final resultJson = _readAndFreeString(outResult.value);
+    final resultBin = binaryTransport ? _completeResultBin(ptr) : null;
+    final errorMsg = _readAndFreeString(outError.value);
+
+    return RunResult(
+      tag: tag.value,
+      resultJson: resultJson,
+      resultBin: resultBin,
+      errorMessage: errorMsg,
+    );
+  }
+
+  @override
+  RunResult runDeferred(int handle) {
+    final ptr = Pointer<MontyHandle>.fromAddress(handle);
+    final outError = _scratch.outError;
+
+    final tag = _lib.monty_run(ptr, nullptr, outError);
+    final errorMsg = _readAndFreeString(outError.value);
+    if (tag.value == 0) {
+      return RunResult(tag: tag.value, errorMessage: errorMsg);
+    }
+
+    return RunResult(
+      tag: tag.value,
+      resultJson: binaryTransport
+          ? null
+          : _readAndFreeString(_lib.monty_complete_result_json(ptr)),
+      resultBin: binaryTransport ? _completeResultBin(ptr) : null,
+      errorMessage: errorMsg,
+    );
+  }
+
+  @override
+  Object? resultGet(int handle, List<Object> path) {
+    final ptr = Pointer<MontyHandle>.fromAddress(handle);
+
+    return _readResultPart(
+      'monty_result_get_path',
+      path,
+      (cPath, outError) => _lib.monty_result_get_path(ptr, cPath, outError),
+      (cPath, outLen, outError) =>
+          _lib.monty_result_get_path_bin(ptr, cPath, outLen, outError),
+    );
+  }
+
+  @override
+  Object? resultSlice(int handle, List<Object> path, int start, [int? end]) {
+    final ptr = Pointer<MontyHandle>.fromAddress(handle);
+    // INT64_MAX: past any end, clamped natively.
+    final stop = end ?? 0x7FFFFFFFFFFFFFFF;
+
+    return _readResultPart(
+      'monty_result_slice',
+      path,
+      (cPath, outError) =>
+          _lib.monty_result_slice(ptr, cPath, start, stop, outError),
+      (cPath, outLen, outError) => _lib.monty_result_slice_bin(
+        ptr,
+        cPath,
+        start,
+        stop,
+        outLen,
+        outError,
+      ),
+    );
+  }
 
+  @override
+  int? resultLength(int handle, List<Object> path) {
+    final cPath = json.encode(path).toNativeUtf8().cast<Char>();
     try {
-      final tag = _lib.monty_run(ptr, outResult, outError);
-      final resultJson = _readAndFreeString(outResult.value);
-      final errorMsg = _readAndFreeString(outError.value);
+      final len = _lib.monty_result_len(
+        Pointer<MontyHandle>.fromAddress(handle),
+        cPath,
+      );
 
-      return RunResult(
-        tag: tag.value,
-        resultJson: resultJson,
-        errorMessage: errorMsg,
+      return len < 0 ? null : len;
+    } finally {
+      calloc.free(cPath);
+    }
+  }
+
+  @override
+  String? resultType(int handle, List<Object> path) {
+    final cPath = json.encode(path).toNativeUtf8().cast<Char>();
+    try {
+      return _readAndFreeString(
+        _lib.monty_result_type(Pointer<MontyHandle>.fromAddress(handle), cPath),
       );
     } finally {
-      calloc
-        ..free(outResult)
-        ..free(outError);
+      calloc.free(cPath);
     }
   }
 
   @override
   ProgressResult start(int handle) {
     final ptr = Pointer<MontyHandle>.fromAddress(handle);
-    final outError = calloc<Pointer<Char>>();
-
-    try {
-      final tag = _lib.monty_start(ptr, outError);
+    final outError = _scratch.outError;
 
-      return _buildProgressResult(ptr, tag, outError.value);
-    } finally {
-      calloc.free(outError);
+    if (binaryTransport) {
+      return _step(
+        ptr,
+        outError,
+        (outProgress, outLen) =>
+            _lib.monty_start_step(ptr, outProgress, outLen, outError),
+      );
     }
+    final tag = _lib.monty_start(ptr, outError);
+
+    return _buildProgressResult(ptr, tag, outError.value);
   }
 
   @override
   ProgressResult resume(int handle, String valueJson) {
     final ptr = Pointer<MontyHandle>.fromAddress(handle);
     final cValue = valueJson.toNativeUtf8().cast<Char>();
-    final outError = calloc<Pointer<Char>>();
+    final outError = _scratch.outError;
 
     try {
       final tag = _lib.monty_resume(ptr, cValue, outError);
 
       return _buildProgressResult(ptr, tag, outError.value);
     } finally {
-      calloc
-        ..free(cValue)
-        ..free(outError);
+      calloc.free(cValue);
+    }
+  }
+
+  @override
+  ProgressResult resumeBin(int handle, Uint8List value) {
+    final ptr = Pointer<MontyHandle>.fromAddress(handle);
+    final cValue = _copyToNative(value);
+    final outError = _scratch.outError;
+
+    try {
+      return _step(
+        ptr,
+        outError,
+        (outProgress, outLen) => _lib.monty_resume_step(
+          ptr,
+          cValue,
+          value.length,
+          outProgress,
+          outLen,
+          outError,
+        ),
+      );
+    } finally {
+      calloc.free(cValue);
     }
   }
 
@@ -124,31 +333,25 @@ class NativeBindingsFfi extends NativeBindings {
   ProgressResult resumeWithError(int handle, String errorMessage) {
     final ptr = Pointer<MontyHandle>.fromAddress(handle);
     final cError = errorMessage.toNativeUtf8().cast<Char>();
-    final outError = calloc<Pointer<Char>>();
+    final outError = _scratch.outError;
 
     try {
       final tag = _lib.monty_resume_with_error(ptr, cError, outError);
 
       return _buildProgressResult(ptr, tag, outError.value);
     } finally {
-      calloc
-        ..free(cError)
-        ..free(outError);
+      calloc.free(cError);
     }
   }
 
   @override
   ProgressResult resumeAsFuture(int handle) {
     final ptr = Pointer<MontyHandle>.fromAddress(handle);
-    final outError = calloc<Pointer<Char>>();
+    final outError = _scratch.outError;
 
-    try {
-      final tag = _lib.monty_resume_as_future(ptr, outError);
+    final tag = _lib.monty_resume_as_future(ptr, outError);
 
-      return _buildProgressResult(ptr, tag, outError.value);
-    } finally {
-      calloc.free(outError);
-    }
+    return _buildProgressResult(ptr, tag, outError.value);
   }
 
   @override
@@ -160,7 +363,7 @@ class NativeBindingsFfi extends NativeBindings {
     final ptr = Pointer<MontyHandle>.fromAddress(handle);
     final cResults = resultsJson.toNativeUtf8().cast<Char>();
     final cErrors = errorsJson.toNativeUtf8().cast<Char>();
-    final outError = calloc<Pointer<Char>>();
+    final outError = _scratch.outError;
 
     try {
       final tag = _lib.monty_resume_futures(ptr, cResults, cErrors, outError);
@@ -169,8 +372,35 @@ class NativeBindingsFfi extends NativeBindings {
     } finally {
       calloc
         ..free(cResults)
-        ..free(cErrors)
-        ..free(outError);
+        ..free(cErrors);
+    }
+  }
+
+  @override
+  ProgressResult resolveFuturesBin(
+    int handle,
+    Uint8List results,
+    Uint8List? errors,
+  ) {
+    final ptr = Pointer<MontyHandle>.fromAddress(handle);
+    final cResults = _copyToNative(results);
+    final cErrors = errors != null ? _copyToNative(errors) : nullptr;
+    final outError = _scratch.outError;
+
+    try {
+      final tag = _lib.monty_resume_futures_bin(
+        ptr,
+        cResults,
+        results.length,
+        cErrors,
+        errors?.length ?? 0,
+        outError,
+      );
+
+      return _buildProgressResult(ptr, tag, outError.value);
+    } finally {
+      calloc.free(cResults);
+      if (errors != null) calloc.free(cErrors);
     }
   }
 
@@ -198,30 +428,132 @@ class NativeBindingsFfi extends NativeBindings {
     );
   }
 
+  @override
+  int interruptNew() => _lib.monty_interrupt_new().address;
+
+  @override
+  void interruptFree(int interrupt) {
+    if (interrupt == 0) return;
+    _lib.monty_interrupt_free(Pointer<MontyInterrupt>.fromAddress(interrupt));
+  }
+
+  @override
+  void interrupt(int interrupt) =>
+      _lib.monty_interrupt(Pointer<MontyInterrupt>.fromAddress(interrupt));
+
+  @override
+  void interruptClear(int interrupt) => _lib.monty_interrupt_clear(
+        Pointer<MontyInterrupt>.fromAddress(interrupt),
+      );
+
+  @override
+  void setInterrupt(int handle, int interrupt) => _lib.monty_set_interrupt(
+        Pointer<MontyHandle>.fromAddress(handle),
+        Pointer<MontyInterrupt>.fromAddress(interrupt),
+      );
+
+  @override
+  void setOutputStream(
+    int handle, {
+    int maxRetainedBytes = 0,
+    void Function(String text)? onOutput,
+  }) {
+    // The VM runs inside the blocking native call on this isolate's
+    // thread, so the callback is isolate-local: a listener callable would
+    // only be delivered once the call returned.
+    final callback = onOutput == null
+        ? null
+        : NativeCallable<_OutputCallback>.isolateLocal(
+            (Pointer<Void> _, Pointer<Char> text, int len) =>
+                onOutput(utf8.decode(text.cast<Uint8>().asTypedList(len))),
+          );
+    _lib.monty_set_output_stream(
+      Pointer<MontyHandle>.fromAddress(handle),
+      maxRetainedBytes,
+      callback?.nativeFunction.cast() ?? nullptr,
+      nullptr,
+    );
+    // Closed only once the handle can no longer call it.
+    final previous = callback != null
+        ? _outputCallbacks[handle]
+        : _outputCallbacks.remove(handle);
+    if (callback != null) _outputCallbacks[handle] = callback;
+    previous?.close();
+  }
+
+  @override
+  String? takeOutput(int handle) => _readAndFreeString(
+        _lib.monty_take_output(Pointer<MontyHandle>.fromAddress(handle)),
+      );
+
+  @override
+  void setTrace(int handle, {required bool enabled}) => _lib.monty_set_trace(
+        Pointer<MontyHandle>.fromAddress(handle),
+        enabled ? 1 : 0,
+      );
+
+  @override
+  String? takeTrace(int handle) => _readAndFreeString(
+        _lib.monty_trace_json(Pointer<MontyHandle>.fromAddress(handle)),
+      );
+
+  @override
+  MontyResourceUsage usage(int handle) {
+    final out = _scratch.usage;
+
+    final rc = _lib.monty_usage(Pointer<MontyHandle>.fromAddress(handle), out);
+    if (rc != 0) {
+      throw StateError('monty_usage failed');
+    }
+    final usage = out.ref;
+
+    return MontyResourceUsage(
+      memoryBytesUsed: usage.memory_bytes_used,
+      timeElapsedMs: usage.time_elapsed_ms,
+      stackDepthUsed: usage.stack_depth_used,
+      allocations: usage.allocations,
+      cpuTimeMs: usage.cpu_time_ms >= 0 ? usage.cpu_time_ms : null,
+    );
+  }
+
+  @override
+  String inspectJson(int handle) {
+    final json = _readAndFreeString(
+      _lib.monty_inspect_json(Pointer<MontyHandle>.fromAddress(handle)),
+    );
+    if (json == null) {
+      throw StateError('monty_inspect_json failed');
+    }
+
+    return json;
+  }
+
   @override
   Uint8List snapshot(int handle) {
     final ptr = Pointer<MontyHandle>.fromAddress(handle);
-    final outLen = calloc<Size>();
-
-    try {
-      final buf = _lib.monty_snapshot(ptr, outLen);
-      if (buf == nullptr) {
-        throw StateError('monty_snapshot returned null');
-      }
-      final len = outLen.value;
-      final bytes = Uint8List.fromList(buf.cast<Uint8>().asTypedList(len));
-      _lib.monty_bytes_free(buf, len);
+    final outLen = _scratch.outLen;
 
-      return bytes;
-    } finally {
-      calloc.free(outLen);
+    final buf = _lib.monty_snapshot(ptr, outLen);
+    if (buf == nullptr) {
+      throw StateError('monty_snapshot returned null');
     }
+
+    return _adoptBytes(buf.cast(), outLen.value);
+  }
+
+  @override
+  ProgressResult? progress(int handle) {
+    final ptr = Pointer<MontyHandle>.fromAddress(handle);
+    final tag = _lib.monty_progress_state(ptr);
+    if (tag < 0) return null;
+
+    return _buildProgressResult(ptr, MontyProgressTag.fromValue(tag), nullptr);
   }
 
   @override
   int restore(Uint8List data) {
     final cData = calloc<Uint8>(data.length);
-    final outError = calloc<Pointer<Char>>();
+    final outError = _scratch.outError;
 
     try {
       cData.asTypedList(data.length).setAll(0, data);
@@ -235,12 +567,340 @@ class NativeBindingsFfi extends NativeBindings {
 
       return handle.address;
     } finally {
-      calloc
-        ..free(cData)
-        ..free(outError);
+      calloc.free(cData);
+    }
+  }
+
+  @override
+  void snapshotToFile(int handle, String path) {
+    final ptr = Pointer<MontyHandle>.fromAddress(handle);
+    final cPath = path.toNativeUtf8().cast<Char>();
+    final outError = _scratch.outError;
+
+    try {
+      if (_lib.monty_snapshot_file(ptr, cPath, outError) != 0) {
+        final errorMsg = _readAndFreeString(outError.value);
+        throw MontyException(
+          message: errorMsg ?? 'monty_snapshot_file failed',
+        );
+      }
+    } finally {
+      calloc.free(cPath);
     }
   }
 
+  @override
+  int restoreFile(String path) {
+    final cPath = path.toNativeUtf8().cast<Char>();
+    final outError = _scratch.outError;
+
+    try {
+      final handle = _lib.monty_restore_file(cPath, outError);
+      if (handle == nullptr) {
+        final errorMsg = _readAndFreeString(outError.value);
+        throw MontyException(
+          message: errorMsg ?? 'monty_restore_file returned null',
+        );
+      }
+
+      return handle.address;
+    } finally {
+      calloc.free(cPath);
+    }
+  }
+
+  @override
+  int compileProgram(
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    String? inputNames,
+  }) {
+    final cCode = code.toNativeUtf8().cast<Char>();
+    final nullChar = nullptr.cast<Char>();
+    final cExtFns = externalFunctions != null
+        ? externalFunctions.toNativeUtf8().cast<Char>()
+        : nullChar;
+    final cScriptName =
+        scriptName != null ? scriptName.toNativeUtf8().cast<Char>() : nullChar;
+    final cInputNames =
+        inputNames != null ? inputNames.toNativeUtf8().cast<Char>() : nullChar;
+    final outError = _scratch.outError;
+
+    try {
+      final program = inputNames != null
+          ? _lib.monty_program_compile_with_inputs(
+              cCode,
+              cExtFns,
+              cInputNames,
+              cScriptName,
+              outError,
+            )
+          : _lib.monty_program_compile(cCode, cExtFns, cScriptName, outError);
+      if (program == nullptr) {
+        final errorMsg = _readAndFreeString(outError.value);
+        throw MontyException(
+          message: errorMsg ?? 'monty_program_compile returned null',
+        );
+      }
+
+      return program.address;
+    } finally {
+      calloc.free(cCode);
+      if (externalFunctions != null) calloc.free(cExtFns);
+      if (scriptName != null) calloc.free(cScriptName);
+      if (inputNames != null) calloc.free(cInputNames);
+    }
+  }
+
+  @override
+  int instantiateProgram(int program, {Uint8List? inputs}) {
+    final cProgram = Pointer<MontyProgram>.fromAddress(program);
+    final cInputs = inputs != null ? _copyToNative(inputs) : nullptr;
+    final outError = _scratch.outError;
+
+    try {
+      final handle = inputs != null
+          ? _lib.monty_program_instantiate_with_inputs(
+              cProgram,
+              cInputs,
+              inputs.length,
+              outError,
+            )
+          : _lib.monty_program_instantiate(cProgram, outError);
+      if (handle == nullptr) {
+        final errorMsg = _readAndFreeString(outError.value);
+        throw MontyException(
+          message: errorMsg ?? 'monty_program_instantiate returned null',
+        );
+      }
+
+      return handle.address;
+    } finally {
+      if (inputs != null) calloc.free(cInputs);
+    }
+  }
+
+  @override
+  void freeProgram(int program) {
+    if (program == 0) return;
+    _lib.monty_program_free(Pointer<MontyProgram>.fromAddress(program));
+  }
+
+  @override
+  Uint8List runBatch(
+    int program,
+    Uint8List inputs, {
+    int threads = 0,
+    String? limitsJson,
+    int? interrupt,
+  }) {
+    final cInputs = _copyToNative(inputs);
+    final cLimits = limitsJson != null
+        ? limitsJson.toNativeUtf8().cast<Char>()
+        : nullptr.cast<Char>();
+    final outResults = _scratch.outProgress;
+    final outLen = _scratch.outLen;
+    final outError = _scratch.outError;
+
+    try {
+      final rc = _lib.monty_run_batch(
+        Pointer<MontyProgram>.fromAddress(program),
+        cInputs,
+        inputs.length,
+        threads,
+        cLimits,
+        Pointer<MontyInterrupt>.fromAddress(interrupt ?? 0),
+        nullptr,
+        nullptr,
+        outResults,
+        outLen,
+        outError,
+      );
+      if (rc != 0) {
+        final errorMsg = _readAndFreeString(outError.value);
+        throw MontyException(message: errorMsg ?? 'monty_run_batch failed');
+      }
+
+      return _readAndFreeBytes(outResults.value, outLen)!;
+    } finally {
+      calloc.free(cInputs);
+      if (limitsJson != null) calloc.free(cLimits);
+    }
+  }
+
+  @override
+  int cacheNew(int capacityBytes, {String? directory}) {
+    if (directory == null) {
+      return _lib.monty_cache_new(capacityBytes).address;
+    }
+    final cDir = directory.toNativeUtf8().cast<Char>();
+    final outError = _scratch.outError;
+
+    try {
+      final cache = _lib.monty_cache_open(capacityBytes, cDir, outError);
+      if (cache == nullptr) {
+        final errorMsg = _readAndFreeString(outError.value);
+        throw MontyException(
+          message: errorMsg ?? 'monty_cache_open returned null',
+        );
+      }
+
+      return cache.address;
+    } finally {
+      calloc.free(cDir);
+    }
+  }
+
+  @override
+  void cacheRetain(int cache) {
+    _lib.monty_cache_retain(Pointer<MontyProgramCache>.fromAddress(cache));
+  }
+
+  @override
+  void cacheFree(int cache) {
+    if (cache == 0) return;
+    _lib.monty_cache_free(Pointer<MontyProgramCache>.fromAddress(cache));
+  }
+
+  @override
+  void cacheClear(int cache) {
+    _lib.monty_cache_clear(Pointer<MontyProgramCache>.fromAddress(cache));
+  }
+
+  @override
+  ProgramCacheStats cacheStats(int cache) {
+    final out = _scratch.cacheStats;
+
+    final rc = _lib.monty_cache_stats(
+      Pointer<MontyProgramCache>.fromAddress(cache),
+      out,
+    );
+    if (rc != 0) {
+      throw StateError('monty_cache_stats failed');
+    }
+    final stats = out.ref;
+
+    return ProgramCacheStats(
+      hits: stats.hits,
+      misses: stats.misses,
+      entries: stats.entries,
+      bytes: stats.bytes,
+      capacityBytes: stats.capacity_bytes,
+      diskLoads: stats.disk_loads,
+      diskWrites: stats.disk_writes,
+    );
+  }
+
+  @override
+  int createCached(
+    int cache,
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    Uint8List? inputs,
+  }) {
+    final cCode = code.toNativeUtf8().cast<Char>();
+    final nullChar = nullptr.cast<Char>();
+    final cExtFns = externalFunctions != null
+        ? externalFunctions.toNativeUtf8().cast<Char>()
+        : nullChar;
+    final cScriptName =
+        scriptName != null ? scriptName.toNativeUtf8().cast<Char>() : nullChar;
+    final cInputs = inputs != null ? _copyToNative(inputs) : nullptr;
+    final outError = _scratch.outError;
+
+    try {
+      final handle = _lib.monty_create_cached(
+        Pointer<MontyProgramCache>.fromAddress(cache),
+        cCode,
+        cExtFns,
+        cInputs,
+        inputs?.length ?? 0,
+        cScriptName,
+        outError,
+      );
+      if (handle == nullptr) {
+        final errorMsg = _readAndFreeString(outError.value);
+        throw MontyException(
+          message: errorMsg ?? 'monty_create_cached returned null',
+        );
+      }
+
+      return handle.address;
+    } finally {
+      calloc.free(cCode);
+      if (externalFunctions != null) calloc.free(cExtFns);
+      if (scriptName != null) calloc.free(cScriptName);
+      if (inputs != null) calloc.free(cInputs);
+    }
+  }
+
+  @override
+  int replCreate({String? scriptName}) {
+    final cScriptName = scriptName != null
+        ? scriptName.toNativeUtf8().cast<Char>()
+        : nullptr.cast<Char>();
+    final outError = _scratch.outError;
+
+    try {
+      final session = _lib.monty_repl_create(cScriptName, outError);
+      if (session == nullptr) {
+        final errorMsg = _readAndFreeString(outError.value);
+        throw MontyException(
+          message: errorMsg ?? 'monty_repl_create returned null',
+        );
+      }
+
+      return session.address;
+    } finally {
+      if (scriptName != null) calloc.free(cScriptName);
+    }
+  }
+
+  @override
+  RunResult replFeed(int session, String code) {
+    final cCode = code.toNativeUtf8().cast<Char>();
+    final outResult = _scratch.outResult;
+    final outError = _scratch.outError;
+
+    try {
+      final tag = _lib.monty_repl_feed(
+        Pointer<MontyReplSession>.fromAddress(session),
+        cCode,
+        outResult,
+        outError,
+      );
+
+      return RunResult(
+        tag: tag.value,
+        resultJson: _readAndFreeString(outResult.value),
+        errorMessage: _readAndFreeString(outError.value),
+      );
+    } finally {
+      calloc.free(cCode);
+    }
+  }
+
+  @override
+  void replSetLimits(
+    int session, {
+    int? memoryBytes,
+    int? timeoutMs,
+    int? stackDepth,
+  }) {
+    final ptr = Pointer<MontyReplSession>.fromAddress(session);
+    if (memoryBytes != null) _lib.monty_repl_set_memory_limit(ptr, memoryBytes);
+    if (timeoutMs != null) _lib.monty_repl_set_time_limit_ms(ptr, timeoutMs);
+    if (stackDepth != null) _lib.monty_repl_set_stack_limit(ptr, stackDepth);
+  }
+
+  @override
+  void replFree(int session) {
+    if (session == 0) return;
+    _lib.monty_repl_free(Pointer<MontyReplSession>.fromAddress(session));
+  }
+
   // ---------------------------------------------------------------------------
   // Helpers
   // ---------------------------------------------------------------------------
@@ -250,11 +910,19 @@ class NativeBindingsFfi extends NativeBindings {
     MontyProgressTag tag,
     Pointer<Char> errorPtr,
   ) {
+    if (binaryTransport && tag != MontyProgressTag.MONTY_PROGRESS_ERROR) {
+      final outLen = _scratch.outLen;
+      final descriptor =
+          _readAndFreeBytes(_lib.monty_progress_bin(ptr, outLen), outLen);
+      if (descriptor != null) {
+        return _progressFromDescriptor(tag, descriptor, errorPtr);
+      }
+    }
     switch (tag) {
       case MontyProgressTag.MONTY_PROGRESS_COMPLETE:
+        final isError = _lib.monty_complete_is_error(ptr);
         final resultJsonPtr = _lib.monty_complete_result_json(ptr);
         final resultJson = _readAndFreeString(resultJsonPtr);
-        final isError = _lib.monty_complete_is_error(ptr);
 
         return ProgressResult(
           tag: 0,
@@ -265,12 +933,12 @@ class NativeBindingsFfi extends NativeBindings {
       case MontyProgressTag.MONTY_PROGRESS_PENDING:
         final fnNamePtr = _lib.monty_pending_fn_name(ptr);
         final fnName = _readAndFreeString(fnNamePtr);
+        final callId = _lib.monty_pending_call_id(ptr);
+        final methodCall = _lib.monty_pending_method_call(ptr);
         final argsPtr = _lib.monty_pending_fn_args_json(ptr);
         final argsJson = _readAndFreeString(argsPtr);
         final kwargsPtr = _lib.monty_pending_fn_kwargs_json(ptr);
         final kwargsJson = _readAndFreeString(kwargsPtr);
-        final callId = _lib.monty_pending_call_id(ptr);
-        final methodCall = _lib.monty_pending_method_call(ptr);
 
         return ProgressResult(
           tag: 1,
@@ -284,6 +952,13 @@ class NativeBindingsFfi extends NativeBindings {
       case MontyProgressTag.MONTY_PROGRESS_ERROR:
         final errorMsg = _readAndFreeString(errorPtr);
         // handle_exception sets state to Complete with full error JSON
+        if (binaryTransport) {
+          return ProgressResult(
+            tag: 2,
+            errorMessage: errorMsg,
+            resultBin: _completeResultBin(ptr),
+          );
+        }
         final resultJsonPtr = _lib.monty_complete_result_json(ptr);
         final resultJson = _readAndFreeString(resultJsonPtr);
 
@@ -301,6 +976,147 @@ class NativeBindingsFfi extends NativeBindings {
     }
   }
 
+  /// Runs a `monty_*_step` call and builds its result from the returned
+  /// descriptor, falling back to the accessors if none was produced.
+  ProgressResult _step(
+    Pointer<MontyHandle> ptr,
+    Pointer<Pointer<Char>> outError,
+    MontyProgressTag Function(
+      Pointer<Pointer<Uint8>> outProgress,
+      Pointer<Size> outLen,
+    ) call,
+  ) {
+    final outProgress = _scratch.outProgress;
+    final outLen = _scratch.outLen;
+    final tag = call(outProgress, outLen);
+    final descriptor = _readAndFreeBytes(outProgress.value, outLen);
+    if (descriptor == null) {
+      return _buildProgressResult(ptr, tag, outError.value);
+    }
+
+    return _progressFromDescriptor(tag, descriptor, outError.value);
+  }
+
+  /// Builds a [ProgressResult] from a `monty_progress_bin` descriptor.
+  ///
+  /// Argument and result payloads stay encoded, as views into
+  /// [descriptor].
+  ProgressResult _progressFromDescriptor(
+    MontyProgressTag tag,
+    Uint8List descriptor,
+    Pointer<Char> errorPtr,
+  ) {
+    final fields = MontyValueCodec.split(descriptor);
+    switch (tag) {
+      case MontyProgressTag.MONTY_PROGRESS_COMPLETE:
+        return ProgressResult(tag: 0, resultBin: fields[1], isError: 0);
+
+      case MontyProgressTag.MONTY_PROGRESS_PENDING:
+        return ProgressResult(
+          tag: 1,
+          functionName: MontyValueCodec.decode(fields[1])! as String,
+          argumentsBin: fields[2],
+          kwargsBin: fields[3],
+          callId: MontyValueCodec.decode(fields[4])! as int,
+          methodCall: MontyValueCodec.decode(fields[5])! as bool,
+        );
+
+      case MontyProgressTag.MONTY_PROGRESS_ERROR:
+        final result = fields[1];
+
+        return ProgressResult(
+          tag: 2,
+          errorMessage: _readAndFreeString(errorPtr),
+          // A bare None means the call failed before execution completed.
+          resultBin: MontyValueCodec.decode(result) == null ? null : result,
+        );
+
+      case MontyProgressTag.MONTY_PROGRESS_RESOLVE_FUTURES:
+        return ProgressResult(
+          tag: 3,
+          futureCallIdsJson: json.encode(MontyValueCodec.decode(fields[1])),
+        );
+    }
+  }
+
+  /// Reads the binary complete-result envelope, or `null` if the handle is
+  /// not in Complete state.
+  Uint8List? _completeResultBin(Pointer<MontyHandle> ptr) {
+    final outLen = _scratch.outLen;
+    return _readAndFreeBytes(
+      _lib.monty_complete_result_bin(ptr, outLen),
+      outLen,
+    );
+  }
+
+  /// Reads a part of a completed value through [readBin] or [readJson],
+  /// whichever matches [binaryTransport], and decodes it.
+  ///
+  /// Throws [MontyException] with the native error if [function] fails.
+  Object? _readResultPart(
+    String function,
+    List<Object> path,
+    Pointer<Char> Function(Pointer<Char>, Pointer<Pointer<Char>>) readJson,
+    Pointer<Uint8> Function(
+      Pointer<Char>,
+      Pointer<Size>,
+      Pointer<Pointer<Char>>,
+    ) readBin,
+  ) {
+    final cPath = json.encode(path).toNativeUtf8().cast<Char>();
+    final outError = _scratch.outError;
+    try {
+      if (binaryTransport) {
+        final outLen = _scratch.outLen;
+        final bytes =
+            _readAndFreeBytes(readBin(cPath, outLen, outError), outLen);
+        if (bytes != null) {
+          return MontyValueCodec.decode(bytes, typedData: typedData);
+        }
+      } else {
+        final text = _readAndFreeString(readJson(cPath, outError));
+        if (text != null) return json.decode(text);
+      }
+      throw MontyException(
+        message: _readAndFreeString(outError.value) ?? '$function failed',
+      );
+    } finally {
+      calloc.free(cPath);
+    }
+  }
+
+  /// Takes ownership of a native byte buffer of the length in [outLen].
+  /// Returns `null` if the pointer is null.
+  Uint8List? _readAndFreeBytes(Pointer<Uint8> ptr, Pointer<Size> outLen) {
+    if (ptr == nullptr) return null;
+
+    return _adoptBytes(ptr, outLen.value);
+  }
+
+  /// Views the native buffer [ptr] of [len] bytes without copying it.
+  ///
+  /// The buffer is released by `monty_bytes_release` once the view, and
+  /// every view taken of it, is garbage collected. Native buffers are
+  /// 8-byte aligned, so packed lists decoded with [typedData] are views
+  /// into it too.
+  Uint8List _adoptBytes(Pointer<Uint8> ptr, int len) {
+    return ptr.asTypedList(
+      len,
+      finalizer: _lib.addresses.monty_bytes_release,
+      token: ptr.cast(),
+    );
+  }
+
+  /// Copies [data] into a `calloc`-allocated native buffer. Caller frees.
+  Pointer<Uint8> _copyToNative(Uint8List data) {
+    // calloc<Uint8>(0) may return nullptr; every encoded value has at
+    // least a tag byte, so allocate at least one.
+    final ptr = calloc<Uint8>(data.isEmpty ? 1 : data.length);
+    ptr.asTypedList(data.length).setAll(0, data);
+
+    return ptr;
+  }
+
   /// Reads a C string, converts to Dart string, and frees via
   /// `monty_string_free`. Returns `null` if the pointer is null.
   String? _readAndFreeString(Pointer<Char> ptr) {
@@ -311,3 +1127,48 @@ class NativeBindingsFfi extends NativeBindings {
     return str;
   }
 }
+
+/// Native signature of `MontyOutputCallback`.
+typedef _OutputCallback = Void Function(Pointer<Void>, Pointer<Char>, Size);
+
+/// Out-param slots shared by every call on one [NativeBindingsFfi].
+///
+/// Reuse is safe because each binding call is synchronous and never
+/// re-enters the bindings. Getters clear pointer and length slots so a
+/// stale value from a previous call is never read back. The memory goes
+/// back to the native heap when the owning bindings are collected.
+final class _Scratch implements Finalizable {
+  _Scratch() {
+    for (final slot in <Pointer<NativeType>>[
+      _outError,
+      _outResult,
+      _outLen,
+      _outProgress,
+      usage,
+      cacheStats,
+    ]) {
+      _finalizer.attach(this, slot.cast());
+    }
+  }
+
+  static final _finalizer = NativeFinalizer(calloc.nativeFree);
+
+  final Pointer<Pointer<Char>> _outError = calloc<Pointer<Char>>();
+  final Pointer<Pointer<Char>> _outResult = calloc<Pointer<Char>>();
+  final Pointer<Size> _outLen = calloc<Size>();
+  final Pointer<Pointer<Uint8>> _outProgress = calloc<Pointer<Uint8>>();
+
+  /// Filled in by `monty_usage`.
+  final Pointer<MontyUsage> usage = calloc<MontyUsage>();
+
+  /// Filled in by `monty_cache_stats`.
+  final Pointer<MontyCacheStats> cacheStats = calloc<MontyCacheStats>();
+
+  Pointer<Pointer<Char>> get outError => _outError..value = nullptr;
+
+  Pointer<Pointer<Char>> get outResult => _outResult..value = nullptr;
+
+  Pointer<Size> get outLen => _outLen..value = 0;
+
+  Pointer<Pointer<Uint8>> get outProgress => _outProgress..value = nullptr;
+}
@@ -182,6 +182,115 @@ void main() {
     });
   });
 
+  group('runRef()', () {
+    test('success hands the handle to the ref', () async {
+      mock.nextResultValue = {'a': 1};
+
+      final (:result, :ref) = await bindings.runRef('{"a": 1}');
+
+      expect(result.ok, isTrue);
+      expect(mock.runDeferredCalls, [42]);
+      expect(mock.runCalls, isEmpty);
+      expect(mock.freeCalls, isEmpty);
+      expect(ref, isNotNull);
+      expect(ref!['a'].value, 1);
+
+      await bindings.dispose();
+      expect(mock.freeCalls, isEmpty);
+      ref!.dispose();
+      expect(mock.freeCalls, [42]);
+    });
+
+    test('error frees the handle and returns the error', () async {
+      mock.nextRunDeferredResult = const RunResult(
+        tag: 1,
+        resultJson: '{"value": null, "error": {"message": "boom", '
+            '"exc_type": "ValueError"}, "usage": {"memory_bytes_used": 0, '
+            '"time_elapsed_ms": 0, "stack_depth_used": 0}}',
+      );
+
+      final (:result, :ref) = await bindings.runRef('raise ValueError()');
+
+      expect(ref, isNull);
+      expect(result.ok, isFalse);
+      expect(result.excType, 'ValueError');
+      expect(mock.freeCalls, [42]);
+    });
+  });
+
+  group('runBatch()', () {
+    const usage = {
+      'memory_bytes_used': 0,
+      'time_elapsed_ms': 1,
+      'stack_depth_used': 0,
+    };
+
+    test('compiles once and translates every result in order', () async {
+      mock.nextRunBatchResult = MontyValueCodec.encode([
+        [
+          0,
+          {'value': 2, 'usage': usage},
+        ],
+        [
+          1,
+          {
+            'value': null,
+            'error': {'message': 'boom', 'exc_type': 'ValueError'},
+            'usage': usage,
+          },
+        ],
+      ]);
+
+      final results = await bindings.runBatch(
+        'x * 2',
+        [
+          {'x': 1},
+          {'x': -1},
+        ],
+        limitsJson: '{"timeout_ms": 5}',
+        threads: 2,
+      );
+
+      expect(mock.compileProgramCalls.single.inputNames, 'x');
+      final call = mock.runBatchCalls.single;
+      expect(call.program, 7);
+      expect(call.threads, 2);
+      expect(call.limitsJson, '{"timeout_ms": 5}');
+      expect(MontyValueCodec.decode(call.inputs), [
+        {'x': 1},
+        {'x': -1},
+      ]);
+      expect(mock.freeProgramCalls, [7]);
+      expect(mock.createCalls, isEmpty);
+
+      expect(results, hasLength(2));
+      expect(results.first.ok, isTrue);
+      expect(results.first.value, 2);
+      expect(results.first.usage?.timeElapsedMs, 1);
+      expect(results.last.ok, isFalse);
+      expect(results.last.error, 'boom');
+      expect(results.last.excType, 'ValueError');
+    });
+
+    test('empty input list runs nothing', () async {
+      expect(await bindings.runBatch('x', []), isEmpty);
+      expect(mock.compileProgramCalls, isEmpty);
+      expect(mock.runBatchCalls, isEmpty);
+    });
+
+    test('frees the program when the batch fails', () async {
+      mock.nextRunBatchError = 'expected a list of input dicts';
+
+      await expectLater(
+        bindings.runBatch('x', [
+          {'x': 1},
+        ]),
+        throwsA(isA<MontyException>()),
+      );
+      expect(mock.freeProgramCalls, [7]);
+    });
+  });
+
   group('start()', () {
     test('complete translates to CoreProgressResult', () async {
       mock.nextStartResult = const ProgressResult(
@@ -494,6 +603,327 @@ void main() {
     });
   });
 
+  group('output', () {
+    test('is not streamed without a listener', () async {
+      await bindings.run('print(1)');
+
+      expect(mock.setOutputStreamCalls, isEmpty);
+      expect(mock.takeOutputCalls, isEmpty);
+    });
+
+    test('run() streams output while listened to', () async {
+      final chunks = <String>[];
+      bindings.output.listen(chunks.add);
+      mock.takeOutputResults.add('hi\n');
+
+      await bindings.run('print("hi")');
+      await Future<void>.delayed(Duration.zero);
+
+      expect(
+        mock.setOutputStreamCalls.single,
+        (
+          handle: 42,
+          maxRetainedBytes: FfiCoreBindings.defaultMaxBufferedOutput,
+        ),
+      );
+      expect(chunks, ['hi\n']);
+    });
+
+    test('run() emits lines as they are printed', () async {
+      final chunks = <String>[];
+      bindings.output.listen(chunks.add);
+      mock.runOutput.addAll(['a\n', 'b\n']);
+
+      await bindings.run('print("a"); print("b")');
+
+      expect(mock.outputCallbacks.keys, [42]);
+      expect(chunks, ['a\n', 'b\n']);
+    });
+
+    test('drains at each pause and at completion', () async {
+      bindings = FfiCoreBindings(bindings: mock, maxBufferedOutput: 64);
+      final chunks = <String>[];
+      bindings.output.listen(chunks.add);
+      mock
+        ..nextStartResult = const ProgressResult(tag: 1, functionName: 'fn')
+        ..takeOutputResults.addAll(['before\n', 'after\n'])
+        ..resumeResults.add(
+          const ProgressResult(
+            tag: 0,
+            resultJson: '{"value": 1, "usage": {"memory_bytes_used": 0, '
+                '"time_elapsed_ms": 0, "stack_depth_used": 0}}',
+          ),
+        );
+
+      await bindings.start('code', extFnsJson: '["fn"]');
+      await bindings.resume('1');
+      await Future<void>.delayed(Duration.zero);
+
+      expect(mock.setOutputStreamCalls, hasLength(1));
+      expect(mock.setOutputStreamCalls.single.maxRetainedBytes, 64);
+      expect(mock.takeOutputCalls, [42, 42]);
+      expect(chunks, ['before\n', 'after\n']);
+    });
+
+    test('a listener added while paused streams the rest', () async {
+      mock.nextStartResult = const ProgressResult(tag: 1, functionName: 'fn');
+      await bindings.start('code', extFnsJson: '["fn"]');
+      expect(mock.setOutputStreamCalls, isEmpty);
+
+      bindings.output.listen((_) {});
+      await bindings.resume('1');
+
+      expect(mock.setOutputStreamCalls.single.handle, 42);
+    });
+
+    test('dispose closes the stream', () async {
+      final done = bindings.output.toList();
+      await bindings.dispose();
+
+      expect(await done, isEmpty);
+    });
+  });
+
+  group('trace', () {
+    test('is not recorded without a listener', () async {
+      await bindings.run('1');
+
+      expect(mock.setTraceCalls, isEmpty);
+      expect(mock.takeTraceCalls, isEmpty);
+    });
+
+    test('run() emits native events, then the Dart decode', () async {
+      final events = <MontyTraceEvent>[];
+      bindings.trace.listen(events.add);
+      mock.takeTraceResults.add(
+        '[{"kind": "compile", "op": "compile", "at_us": 0, '
+        '"duration_us": 30}, {"kind": "vm", "op": "run", "at_us": 31, '
+        '"duration_us": 5}, {"kind": "gc", "op": "x", "duration_us": 1}]',
+      );
+
+      await bindings.run('1');
+      await Future<void>.delayed(Duration.zero);
+
+      expect(mock.setTraceCalls.single, (handle: 42, enabled: true));
+      expect(mock.takeTraceCalls, [42]);
+      expect(
+        events.map((e) => (e.kind, e.op)),
+        [
+          (MontyTraceKind.compile, 'compile'),
+          (MontyTraceKind.vm, 'run'),
+          (MontyTraceKind.convert, 'dart_decode'),
+        ],
+      );
+      expect(events[1].at, const Duration(microseconds: 31));
+    });
+
+    test('drains at each pause and at completion', () async {
+      bindings.trace.listen((_) {});
+      mock
+        ..nextStartResult = const ProgressResult(tag: 1, functionName: 'fn')
+        ..resumeResults.add(
+          const ProgressResult(
+            tag: 0,
+            resultJson: '{"value": 1, "usage": {"memory_bytes_used": 0, '
+                '"time_elapsed_ms": 0, "stack_depth_used": 0}}',
+          ),
+        );
+
+      await bindings.start('code', extFnsJson: '["fn"]');
+      await bindings.resume('1');
+
+      expect(mock.setTraceCalls, hasLength(1));
+      expect(mock.takeTraceCalls, [42, 42]);
+    });
+
+    test('dispose closes the stream', () async {
+      final done = bindings.trace.toList();
+      await bindings.dispose();
+
+      expect(await done, isEmpty);
+    });
+  });
+
+  group('program cache', () {
+    late MontyProgramCache cache;
+
+    setUp(() {
+      cache = MontyProgramCache(bindings: mock, capacityBytes: 1024);
+      bindings = FfiCoreBindings(bindings: mock, programCache: cache);
+    });
+
+    test('run() creates its handle through the cache', () async {
+      await bindings.run('x', inputsJson: '{"x": 1}', scriptName: 'a.py');
+
+      expect(mock.createCalls, isEmpty);
+      expect(mock.createCachedCalls, hasLength(1));
+      final call = mock.createCachedCalls.single;
+      expect(call.cache, mock.nextCache);
+      expect(call.code, 'x');
+      expect(call.scriptName, 'a.py');
+      expect(MontyValueCodec.decode(call.inputs!), {'x': 1});
+      expect(mock.runCalls, [mock.nextCreateCachedHandle]);
+      expect(mock.freeCalls, [mock.nextCreateCachedHandle]);
+    });
+
+    test('start() passes external functions to the cache', () async {
+      await bindings.start('f()', extFnsJson: '["f", "g"]');
+
+      expect(mock.createCachedCalls.single.externalFunctions, 'f,g');
+      expect(mock.startCalls, [mock.nextCreateCachedHandle]);
+    });
+
+    test('dispose() leaves the cache alive', () async {
+      await bindings.dispose();
+
+      expect(mock.cacheFreeCalls, isEmpty);
+    });
+  });
+
+  group('handle reuse', () {
+    setUp(() {
+      bindings = FfiCoreBindings(bindings: mock, reuseHandles: true);
+    });
+
+    test('run() keeps the finished handle instead of freeing it', () async {
+      await bindings.run('a');
+
+      expect(mock.freeCalls, isEmpty);
+    });
+
+    test('next run() resets the kept handle', () async {
+      await bindings.run('a');
+      await bindings.run('b', scriptName: 'b.py');
+
+      expect(mock.createCalls, hasLength(1));
+      final call = mock.resetCalls.single;
+      expect(call.handle, 42);
+      expect(call.code, 'b');
+      expect(call.scriptName, 'b.py');
+      expect(mock.runCalls, [42, 42]);
+    });
+
+    test('start() resets the kept handle with external functions', () async {
+      await bindings.run('a');
+      await bindings.start('f()', extFnsJson: '["f"]');
+
+      expect(mock.resetCalls.single.externalFunctions, 'f');
+      expect(mock.startCalls, [42]);
+    });
+
+    test('a failed reset keeps the handle for the next run', () async {
+      await bindings.run('a');
+      mock.nextResetError = 'SyntaxError';
+
+      await expectLater(
+        bindings.run('def'),
+        throwsA(isA<MontyException>()),
+      );
+      mock.nextResetError = null;
+      await bindings.run('b');
+
+      expect(mock.createCalls, hasLength(1));
+      expect(mock.resetCalls.map((c) => c.code), ['def', 'b']);
+      expect(mock.freeCalls, isEmpty);
+    });
+
+    test('dispose() frees the kept handle', () async {
+      await bindings.run('a');
+      await bindings.dispose();
+
+      expect(mock.freeCalls, [42]);
+    });
+
+    test('is ignored with a program cache', () async {
+      final cache = MontyProgramCache(bindings: mock, capacityBytes: 1024);
+      bindings = FfiCoreBindings(
+        bindings: mock,
+        programCache: cache,
+        reuseHandles: true,
+      );
+      await bindings.run('a');
+      await bindings.run('b');
+
+      expect(mock.resetCalls, isEmpty);
+      expect(mock.createCachedCalls, hasLength(2));
+      expect(mock.freeCalls, hasLength(2));
+    });
+  });
+
+  group('cancel()', () {
+    test('run() clears the interrupt and makes the handle watch it', () async {
+      await bindings.run('x');
+
+      expect(mock.interruptNewCalls, 1);
+      expect(mock.interruptClearCalls, [7]);
+      expect(mock.setInterruptCalls, [(handle: 42, interrupt: 7)]);
+    });
+
+    test('interrupts the paused execution', () async {
+      mock.nextStartResult = const ProgressResult(tag: 1, functionName: 'fn');
+      await bindings.start('fn()', extFnsJson: '["fn"]');
+
+      await bindings.cancel();
+
+      expect(mock.interruptCalls, [7]);
+    });
+
+    test('is a no-op before any execution', () async {
+      await bindings.cancel();
+
+      expect(mock.interruptCalls, isEmpty);
+    });
+
+    test('restored handles watch the interrupt', () async {
+      await bindings.restoreSnapshot(Uint8List.fromList([1]));
+
+      expect(mock.setInterruptCalls.single.interrupt, 7);
+    });
+
+    test('dispose() frees its own interrupt', () async {
+      await bindings.run('x');
+      await bindings.dispose();
+
+      expect(mock.interruptFreeCalls, [7]);
+    });
+
+    test('uses and keeps a caller-owned interrupt', () async {
+      bindings = FfiCoreBindings(bindings: mock, interrupt: 9);
+      await bindings.run('x');
+      await bindings.cancel();
+      await bindings.dispose();
+
+      expect(mock.interruptNewCalls, 0);
+      expect(mock.setInterruptCalls.single.interrupt, 9);
+      expect(mock.interruptCalls, [9]);
+      expect(mock.interruptFreeCalls, isEmpty);
+    });
+  });
+
+  group('usage()', () {
+    test('returns null without an active handle', () async {
+      expect(await bindings.usage(), isNull);
+      expect(mock.usageCalls, isEmpty);
+    });
+
+    test('reads usage of the paused handle', () async {
+      mock
+        ..nextStartResult = const ProgressResult(tag: 1, functionName: 'fn')
+        ..nextUsage = const MontyResourceUsage(
+          memoryBytesUsed: 64,
+          timeElapsedMs: 1,
+          stackDepthUsed: 2,
+          allocations: 3,
+        );
+      await bindings.start('code', extFnsJson: '["fn"]');
+
+      final usage = await bindings.usage();
+
+      expect(mock.usageCalls, [42]);
+      expect(usage?.allocations, 3);
+    });
+  });
+
   group('snapshot()', () {
     test('delegates to bindings', () async {
       mock.nextStartResult = const ProgressResult(
@@ -532,6 +962,64 @@ void main() {
     });
   });
 
+  group('progress()', () {
+    test('returns null without a handle', () async {
+      expect(await bindings.progress(), isNull);
+      expect(mock.progressCalls, isEmpty);
+    });
+
+    test('translates the restored handle progress', () async {
+      mock
+        ..nextRestoreHandle = 99
+        ..nextProgress = const ProgressResult(
+          tag: 1,
+          functionName: 'fetch',
+          argumentsJson: '["job"]',
+          callId: 3,
+        );
+      await bindings.restoreSnapshot(Uint8List.fromList([1]));
+
+      final progress = await bindings.progress();
+
+      expect(mock.progressCalls, [99]);
+      expect(progress?.state, 'pending');
+      expect(progress?.functionName, 'fetch');
+      expect(progress?.arguments, ['job']);
+      expect(progress?.callId, 3);
+    });
+
+    test('returns null when the handle is Ready', () async {
+      mock.nextRestoreHandle = 99;
+      await bindings.restoreSnapshot(Uint8List.fromList([1]));
+
+      expect(await bindings.progress(), isNull);
+    });
+  });
+
+  group('feed()', () {
+    test('creates the session lazily with limits and script name', () async {
+      await bindings.feed(
+        'x = 1',
+        limitsJson: '{"memory_bytes": 64, "stack_depth": 5}',
+        scriptName: 'repl.py',
+      );
+      final result = await bindings.feed('x');
+
+      expect(result.ok, isTrue);
+      expect(mock.replCreateCalls, ['repl.py']);
+      expect(mock.replSetLimitsCalls.single.memoryBytes, 64);
+      expect(mock.replSetLimitsCalls.single.stackDepth, 5);
+      expect(mock.replSetLimitsCalls.single.timeoutMs, isNull);
+      expect(mock.replFeedCalls.map((c) => c.session), [11, 11]);
+    });
+
+    test('resetSession() is a no-op without a session', () async {
+      await bindings.resetSession();
+
+      expect(mock.replFreeCalls, isEmpty);
+    });
+  });
+
   group('dispose()', () {
     test('frees active handle', () async {
       mock.nextStartResult = const ProgressResult(
@@ -604,4 +1092,222 @@ void main() {
       expect(mock.freeCalls, hasLength(1));
     });
   });
+
+  group('binary transport', () {
+    final usage = {
+      'memory_bytes_used': 0,
+      'time_elapsed_ms': 0,
+      'stack_depth_used': 0,
+    };
+
+    setUp(() => mock.binaryTransport = true);
+
+    test('run decodes resultBin envelope', () async {
+      mock.nextRunResult = RunResult(
+        tag: 0,
+        resultBin: MontyValueCodec.encode({
+          'value': [1.5, 2.5],
+          'usage': usage,
+          'print_output': 'hi\n',
+        }),
+      );
+
+      final result = await bindings.run('code');
+
+      expect(result.ok, isTrue);
+      expect(result.value, [1.5, 2.5]);
+      expect(result.printOutput, 'hi\n');
+      expect(result.usage, isNotNull);
+    });
+
+    test('run decodes packed lists as lists unless typedData', () async {
+      RunResult packed() => RunResult(
+            tag: 0,
+            resultBin: MontyValueCodec.encode({
+              'value': Int64List.fromList([1, 2]),
+              'usage': usage,
+            }),
+          );
+
+      mock.nextRunResult = packed();
+      final plain = await bindings.run('code');
+      expect(plain.value, isNot(isA<Int64List>()));
+      expect(plain.value, [1, 2]);
+
+      mock
+        ..typedData = true
+        ..nextRunResult = packed();
+      final typed = await bindings.run('code');
+      expect(typed.value, isA<Int64List>());
+      expect(typed.value, [1, 2]);
+    });
+
+    test('run error decodes error details from resultBin', () async {
+      mock.nextRunResult = RunResult(
+        tag: 1,
+        errorMessage: 'ZeroDivisionError: division by zero',
+        resultBin: MontyValueCodec.encode({
+          'value': null,
+          'error': {
+            'message': 'division by zero',
+            'exc_type': 'ZeroDivisionError',
+            'line_number': 1,
+          },
+          'usage': usage,
+        }),
+      );
+
+      final result = await bindings.run('1/0');
+
+      expect(result.ok, isFalse);
+      expect(result.error, 'division by zero');
+      expect(result.excType, 'ZeroDivisionError');
+      expect(result.lineNumber, 1);
+    });
+
+    test('pending decodes argumentsBin and kwargsBin', () async {
+      mock.nextStartResult = ProgressResult(
+        tag: 1,
+        functionName: 'fn',
+        argumentsBin: MontyValueCodec.encode([1, 'two']),
+        kwargsBin: MontyValueCodec.encode({'timeout': 30}),
+        callId: 3,
+      );
+
+      final result = await bindings.start('code', extFnsJson: '["fn"]');
+
+      expect(result.arguments, [1, 'two']);
+      expect(result.kwargs, {'timeout': 30});
+      expect(result.callId, 3);
+    });
+
+    test('pending with empty kwargsBin maps to null', () async {
+      mock.nextStartResult = ProgressResult(
+        tag: 1,
+        functionName: 'fn',
+        argumentsBin: MontyValueCodec.encode(<Object?>[]),
+        kwargsBin: MontyValueCodec.encode(<String, Object?>{}),
+      );
+
+      final result = await bindings.start('code', extFnsJson: '["fn"]');
+
+      expect(result.arguments, isEmpty);
+      expect(result.kwargs, isNull);
+    });
+
+    test('resumeValue sends binary value', () async {
+      mock.nextStartResult = const ProgressResult(tag: 1, functionName: 'fn');
+      await bindings.start('code', extFnsJson: '["fn"]');
+
+      await bindings.resumeValue({
+        'key': [1, 2, 3],
+      });
+
+      expect(mock.resumeCalls, isEmpty);
+      expect(mock.resumeBinCalls, hasLength(1));
+      expect(MontyValueCodec.decode(mock.resumeBinCalls.first.value), {
+        'key': [1, 2, 3],
+      });
+    });
+
+    test('resolveFuturesValues sends call-ID-keyed dicts', () async {
+      mock.nextStartResult = const ProgressResult(
+        tag: 3,
+        futureCallIdsJson: '[0,1]',
+      );
+      await bindings.start('code', extFnsJson: '["fn"]');
+
+      await bindings.resolveFuturesValues(
+        {0: 'a'},
+        errors: {1: 'timeout'},
+      );
+
+      expect(mock.resolveFuturesCalls, isEmpty);
+      final call = mock.resolveFuturesBinCalls.single;
+      expect(MontyValueCodec.decode(call.results), [
+        [0, 'a'],
+      ]);
+      expect(MontyValueCodec.decode(call.errors!), [
+        [1, 'timeout'],
+      ]);
+    });
+
+    test('resolveFuturesValues omits empty errors', () async {
+      mock.nextStartResult = const ProgressResult(
+        tag: 3,
+        futureCallIdsJson: '[0]',
+      );
+      await bindings.start('code', extFnsJson: '["fn"]');
+
+      await bindings.resolveFuturesValues({0: 42});
+
+      expect(mock.resolveFuturesBinCalls.single.errors, isNull);
+    });
+  });
+
+  group('encoded values', () {
+    final envelope = MontyValueCodec.encode({
+      'value': {
+        'rows': [1, 2, 3],
+      },
+      'usage': {
+        'memory_bytes_used': 8,
+        'time_elapsed_ms': 1,
+        'stack_depth_used': 2,
+      },
+      'print_output': 'hi\n',
+    });
+
+    setUp(() {
+      mock.binaryTransport = true;
+      bindings = FfiCoreBindings(bindings: mock, encodedValues: true);
+    });
+
+    test('run leaves the value encoded and decodes the rest', () async {
+      mock.nextRunResult = RunResult(tag: 0, resultBin: envelope);
+
+      final result = await bindings.run('code');
+
+      final value = result.value! as MontyEncodedValue;
+      expect(value.decode(), {
+        'rows': [1, 2, 3],
+      });
+      expect(result.usage!.memoryBytesUsed, 8);
+      expect(result.printOutput, 'hi\n');
+    });
+
+    test('complete progress leaves the value encoded', () async {
+      mock.nextStartResult = ProgressResult(tag: 0, resultBin: envelope);
+
+      final progress = await bindings.start('code');
+
+      expect(progress.value, isA<MontyEncodedValue>());
+      expect(progress.usage!.stackDepthUsed, 2);
+    });
+
+    test('has no effect on the JSON transport', () async {
+      mock
+        ..binaryTransport = false
+        ..nextRunResult = const RunResult(
+          tag: 0,
+          resultJson: '{"value": [1], "usage": null}',
+        );
+
+      final result = await bindings.run('code');
+
+      expect(result.value, [1]);
+    });
+  });
+
+  group('resumeValue() with JSON transport', () {
+    test('encodes value as JSON', () async {
+      mock.nextStartResult = const ProgressResult(tag: 1, functionName: 'fn');
+      await bindings.start('code', extFnsJson: '["fn"]');
+
+      await bindings.resumeValue([1, 'x']);
+
+      expect(mock.resumeBinCalls, isEmpty);
+      expect(mock.resumeCalls.single.valueJson, '[1,"x"]');
+    });
+  });
 }
@@ -1,6 +1,8 @@
 @Tags(['integration'])
 library;
 
+import 'dart:io';
+
 import 'package:dart_monty_ffi/dart_monty_ffi.dart';
 import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
 import 'package:test/test.dart';
@@ -91,6 +93,22 @@ void main() {
     await restored.dispose();
   });
 
+  test('snapshot file round-trip', () async {
+    final dir = Directory.systemTemp.createTempSync('monty_snap');
+    final path = '${dir.path}/paused.snap';
+    final monty = MontyFfi(bindings: bindings);
+    await monty.start('x = 42\nfetch("url")', externalFunctions: ['fetch']);
+
+    await monty.snapshotToFile(path);
+    final restored = await monty.restoreFile(path) as MontyFfi;
+    final done = await restored.resume('ok');
+    expect(done, isA<MontyComplete>());
+
+    await monty.dispose();
+    await restored.dispose();
+    dir.deleteSync(recursive: true);
+  });
+
   test('error handling: invalid syntax', () async {
     final monty = MontyFfi(bindings: bindings);
 
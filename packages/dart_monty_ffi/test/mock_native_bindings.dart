@@ -1,3 +1,4 @@
+import 'dart:ffi' show Finalizable;
 import 'dart:typed_data';
 
 import 'package:dart_monty_ffi/src/native_bindings.dart';
@@ -17,12 +18,23 @@ class MockNativeBindings extends NativeBindings {
   // Next return values (configure before calling)
   // ---------------------------------------------------------------------------
 
+  /// Value reported by [binaryTransport]. Defaults to `false` (JSON).
+  @override
+  bool binaryTransport = false;
+
+  /// Value reported by [typedData]. Defaults to `false`.
+  @override
+  bool typedData = false;
+
   /// Handle address returned by [create]. Defaults to 42.
   int nextCreateHandle = 42;
 
   /// If non-null, [create] throws this message as a [StateError].
   String? nextCreateError;
 
+  /// If non-null, [reset] throws this message as a [MontyException].
+  String? nextResetError;
+
   /// Result returned by [run].
   RunResult nextRunResult = const RunResult(
     tag: 0,
@@ -30,13 +42,22 @@ class MockNativeBindings extends NativeBindings {
         '"time_elapsed_ms": 0, "stack_depth_used": 0}}',
   );
 
+  /// Result returned by [runDeferred].
+  RunResult nextRunDeferredResult = const RunResult(tag: 0);
+
+  /// Completed value read by [resultGet], [resultSlice], [resultLength]
+  /// and [resultType], which walk paths through it as the native side
+  /// does.
+  Object? nextResultValue;
+
   /// Result returned by [start].
   ProgressResult nextStartResult = const ProgressResult(
     tag: 0,
     resultJson: _defaultCompleteJson,
   );
 
-  /// Queue of results returned by [resume]. Dequeues on each call.
+  /// Queue of results returned by [resume] and [resumeBin]. Dequeues on
+  /// each call.
   final List<ProgressResult> resumeResults = [];
 
   /// Queue of results returned by [resumeWithError]. Dequeues on each call.
@@ -45,9 +66,27 @@ class MockNativeBindings extends NativeBindings {
   /// Queue of results returned by [resumeAsFuture]. Dequeues on each call.
   final List<ProgressResult> resumeAsFutureResults = [];
 
-  /// Queue of results returned by [resolveFutures]. Dequeues on each call.
+  /// Queue of results returned by [resolveFutures] and [resolveFuturesBin].
+  /// Dequeues on each call.
   final List<ProgressResult> resolveFuturesResults = [];
 
+  /// Usage returned by [usage].
+  MontyResourceUsage nextUsage = const MontyResourceUsage(
+    memoryBytesUsed: 0,
+    timeElapsedMs: 0,
+    stackDepthUsed: 0,
+  );
+
+  /// JSON returned by [inspectJson].
+  String nextInspectJson = '{"state": "ready", "heap_bytes": 0, '
+      '"peak_heap_bytes": 0, "memory_limit": null, "live_allocations": 0, '
+      '"allocations": 0, "live_by_size": [], "stack_depth": 0, '
+      '"max_stack_depth": 0, "stack_limit": null, "time_elapsed_ms": 0, '
+      '"pending": null}';
+
+  /// Progress returned by [progress]. Defaults to `null` (Ready state).
+  ProgressResult? nextProgress;
+
   /// Data returned by [snapshot].
   Uint8List nextSnapshotData = Uint8List.fromList([1, 2, 3]);
 
@@ -57,26 +96,115 @@ class MockNativeBindings extends NativeBindings {
   /// If non-null, [restore] throws this message as a [StateError].
   String? nextRestoreError;
 
+  /// Handle address returned by [restoreFile]. Defaults to 98.
+  int nextRestoreFileHandle = 98;
+
+  /// If non-null, [restoreFile] throws this message.
+  String? nextRestoreFileError;
+
+  /// Program address returned by [compileProgram]. Defaults to 7.
+  int nextProgram = 7;
+
+  /// If non-null, [compileProgram] throws this message.
+  String? nextCompileError;
+
+  /// Handle address returned by [instantiateProgram]. Defaults to 43.
+  int nextInstantiateHandle = 43;
+
+  /// Encoded results returned by [runBatch]. Defaults to an empty list.
+  Uint8List nextRunBatchResult = Uint8List.fromList([0x08, 0, 0, 0, 0]);
+
+  /// If non-null, [runBatch] throws this message.
+  String? nextRunBatchError;
+
+  /// Cache address returned by [cacheNew]. Defaults to 5.
+  int nextCache = 5;
+
+  /// Interrupt address returned by [interruptNew]. Defaults to 7.
+  int nextInterrupt = 7;
+
+  /// Counters returned by [cacheStats].
+  ProgramCacheStats nextCacheStats = const ProgramCacheStats(
+    hits: 0,
+    misses: 0,
+    entries: 0,
+    bytes: 0,
+    capacityBytes: 0,
+  );
+
+  /// Handle address returned by [createCached]. Defaults to 44.
+  int nextCreateCachedHandle = 44;
+
+  /// Session address returned by [replCreate]. Defaults to 11.
+  int nextReplSession = 11;
+
+  /// Queue of results returned by [replFeed]. Dequeues on each call.
+  final List<RunResult> replFeedResults = [];
+
+  /// Queue of chunks returned by [takeOutput]. Dequeues on each call;
+  /// returns `null` when empty.
+  final List<String> takeOutputResults = [];
+
+  /// Text [run] hands to the handle's `onOutput` callback, if any, before
+  /// it returns.
+  final List<String> runOutput = [];
+
+  /// Queue of JSON arrays returned by [takeTrace]. Dequeues on each call;
+  /// returns `null` when empty.
+  final List<String> takeTraceResults = [];
+
   // ---------------------------------------------------------------------------
   // Call tracking
   // ---------------------------------------------------------------------------
 
-  /// Records of `(code, externalFunctions, scriptName)` passed to [create].
-  final List<({String code, String? externalFunctions, String? scriptName})>
-      createCalls = [];
+  /// Records of `(code, externalFunctions, scriptName, inputs)` passed to
+  /// [create].
+  final List<
+      ({
+        String code,
+        String? externalFunctions,
+        String? scriptName,
+        Uint8List? inputs,
+      })> createCalls = [];
+
+  /// Records of `(handle, code, externalFunctions, scriptName, inputs)`
+  /// passed to [reset].
+  final List<
+      ({
+        int handle,
+        String code,
+        String? externalFunctions,
+        String? scriptName,
+        Uint8List? inputs,
+      })> resetCalls = [];
 
   /// Handle addresses passed to [free].
   final List<int> freeCalls = [];
 
+  /// Handle addresses passed to [attachFree].
+  final List<int> attachFreeCalls = [];
+
+  /// Number of times [detachFree] was called.
+  int detachFreeCalls = 0;
+
   /// Handle addresses passed to [run].
   final List<int> runCalls = [];
 
+  /// Handle addresses passed to [runDeferred].
+  final List<int> runDeferredCalls = [];
+
+  /// Records of `(handle, path)` passed to [resultGet].
+  final List<({int handle, List<Object> path})> resultGetCalls = [];
+
   /// Handle addresses passed to [start].
   final List<int> startCalls = [];
 
   /// Records of `(handle, valueJson)` passed to [resume].
   final List<({int handle, String valueJson})> resumeCalls = [];
 
+  /// Records of `(handle, value)` passed to [resumeBin].
+  final List<({int handle, Uint8List value})> resumeBinCalls = [];
+
   /// Records of `(handle, errorMessage)` passed to [resumeWithError].
   final List<({int handle, String errorMessage})> resumeWithErrorCalls = [];
 
@@ -88,6 +216,10 @@ class MockNativeBindings extends NativeBindings {
   final List<({int handle, String resultsJson, String errorsJson})>
       resolveFuturesCalls = [];
 
+  /// Records of `(handle, results, errors)` passed to [resolveFuturesBin].
+  final List<({int handle, Uint8List results, Uint8List? errors})>
+      resolveFuturesBinCalls = [];
+
   /// Records of `(handle, bytes)` passed to [setMemoryLimit].
   final List<({int handle, int bytes})> setMemoryLimitCalls = [];
 
@@ -97,23 +229,147 @@ class MockNativeBindings extends NativeBindings {
   /// Records of `(handle, depth)` passed to [setStackLimit].
   final List<({int handle, int depth})> setStackLimitCalls = [];
 
+  /// Number of [interruptNew] calls.
+  int interruptNewCalls = 0;
+
+  /// Interrupt addresses passed to [interruptFree].
+  final List<int> interruptFreeCalls = [];
+
+  /// Interrupt addresses passed to [interrupt].
+  final List<int> interruptCalls = [];
+
+  /// Interrupt addresses passed to [interruptClear].
+  final List<int> interruptClearCalls = [];
+
+  /// Records of `(handle, interrupt)` passed to [setInterrupt].
+  final List<({int handle, int interrupt})> setInterruptCalls = [];
+
+  /// Records of `(handle, maxRetainedBytes)` passed to [setOutputStream].
+  final List<({int handle, int maxRetainedBytes})> setOutputStreamCalls = [];
+
+  /// `onOutput` callbacks passed to [setOutputStream], by handle.
+  final Map<int, void Function(String text)> outputCallbacks = {};
+
+  /// Records of handles passed to [takeOutput].
+  final List<int> takeOutputCalls = [];
+
+  /// Records of `(handle, enabled)` passed to [setTrace].
+  final List<({int handle, bool enabled})> setTraceCalls = [];
+
+  /// Records of handles passed to [takeTrace].
+  final List<int> takeTraceCalls = [];
+
+  /// Handle addresses passed to [usage].
+  final List<int> usageCalls = [];
+
+  /// Handle addresses passed to [inspectJson].
+  final List<int> inspectCalls = [];
+
   /// Handle addresses passed to [snapshot].
   final List<int> snapshotCalls = [];
 
+  /// Handle addresses passed to [progress].
+  final List<int> progressCalls = [];
+
   /// Snapshot data passed to [restore].
   final List<Uint8List> restoreCalls = [];
 
+  /// Records of `(handle, path)` passed to [snapshotToFile].
+  final List<({int handle, String path})> snapshotToFileCalls = [];
+
+  /// Paths passed to [restoreFile].
+  final List<String> restoreFileCalls = [];
+
+  /// Records of `(code, externalFunctions, scriptName, inputNames)` passed
+  /// to [compileProgram].
+  final List<
+      ({
+        String code,
+        String? externalFunctions,
+        String? scriptName,
+        String? inputNames,
+      })> compileProgramCalls = [];
+
+  /// Program addresses passed to [instantiateProgram].
+  final List<int> instantiateProgramCalls = [];
+
+  /// Encoded inputs passed to [instantiateProgram], parallel to
+  /// [instantiateProgramCalls].
+  final List<Uint8List?> instantiateProgramInputs = [];
+
+  /// Program addresses passed to [freeProgram].
+  final List<int> freeProgramCalls = [];
+
+  /// Records of `(program, inputs, threads, limitsJson, interrupt)` passed
+  /// to [runBatch].
+  final List<
+      ({
+        int program,
+        Uint8List inputs,
+        int threads,
+        String? limitsJson,
+        int? interrupt,
+      })> runBatchCalls = [];
+
+  /// Records of `(capacityBytes, directory)` passed to [cacheNew].
+  final List<({int capacityBytes, String? directory})> cacheNewCalls = [];
+
+  /// Cache addresses passed to [cacheRetain].
+  final List<int> cacheRetainCalls = [];
+
+  /// Cache addresses passed to [cacheFree].
+  final List<int> cacheFreeCalls = [];
+
+  /// Cache addresses passed to [cacheClear].
+  final List<int> cacheClearCalls = [];
+
+  /// Records of `(cache, code, externalFunctions, scriptName, inputs)`
+  /// passed to [createCached].
+  final List<
+      ({
+        int cache,
+        String code,
+        String? externalFunctions,
+        String? scriptName,
+        Uint8List? inputs,
+      })> createCachedCalls = [];
+
+  /// Script names passed to [replCreate].
+  final List<String?> replCreateCalls = [];
+
+  /// Records of `(session, code)` passed to [replFeed].
+  final List<({int session, String code})> replFeedCalls = [];
+
+  /// Records of `(session, memoryBytes, timeoutMs, stackDepth)` passed to
+  /// [replSetLimits].
+  final List<
+      ({
+        int session,
+        int? memoryBytes,
+        int? timeoutMs,
+        int? stackDepth,
+      })> replSetLimitsCalls = [];
+
+  /// Session addresses passed to [replFree].
+  final List<int> replFreeCalls = [];
+
   // ---------------------------------------------------------------------------
   // Implementation
   // ---------------------------------------------------------------------------
 
   @override
-  int create(String code, {String? externalFunctions, String? scriptName}) {
+  int create(
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    Uint8List? inputs,
+  }) {
     createCalls.add(
       (
         code: code,
         externalFunctions: externalFunctions,
-        scriptName: scriptName
+        scriptName: scriptName,
+        inputs: inputs,
       ),
     );
     final createError = nextCreateError;
@@ -124,18 +380,135 @@ class MockNativeBindings extends NativeBindings {
     return nextCreateHandle;
   }
 
+  @override
+  void reset(
+    int handle,
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    Uint8List? inputs,
+  }) {
+    resetCalls.add(
+      (
+        handle: handle,
+        code: code,
+        externalFunctions: externalFunctions,
+        scriptName: scriptName,
+        inputs: inputs,
+      ),
+    );
+    final resetError = nextResetError;
+    if (resetError != null) {
+      throw MontyException(message: resetError);
+    }
+  }
+
   @override
   void free(int handle) {
     freeCalls.add(handle);
   }
 
+  @override
+  void attachFree(Finalizable owner, int handle) {
+    attachFreeCalls.add(handle);
+  }
+
+  @override
+  void detachFree(Finalizable owner) {
+    detachFreeCalls++;
+  }
+
   @override
   RunResult run(int handle) {
     runCalls.add(handle);
+    final onOutput = outputCallbacks[handle];
+    if (onOutput != null) runOutput.forEach(onOutput);
 
     return nextRunResult;
   }
 
+  @override
+  RunResult runDeferred(int handle) {
+    runDeferredCalls.add(handle);
+
+    return nextRunDeferredResult;
+  }
+
+  @override
+  Object? resultGet(int handle, List<Object> path) {
+    resultGetCalls.add((handle: handle, path: path));
+
+    return _resolve(path);
+  }
+
+  @override
+  Object? resultSlice(int handle, List<Object> path, int start, [int? end]) {
+    final value = _resolve(path);
+    int bound(int i, int len) => (i < 0 ? i + len : i).clamp(0, len);
+    switch (value) {
+      case final String s:
+        final from = bound(start, s.length);
+        final to = bound(end ?? s.length, s.length);
+
+        return to > from ? s.substring(from, to) : '';
+      case final List<Object?> items:
+        final from = bound(start, items.length);
+        final to = bound(end ?? items.length, items.length);
+
+        return to > from ? items.sublist(from, to) : <Object?>[];
+      default:
+        throw const MontyException(message: 'cannot slice');
+    }
+  }
+
+  @override
+  int? resultLength(int handle, List<Object> path) {
+    try {
+      return switch (_resolve(path)) {
+        final String s => s.length,
+        final List<Object?> items => items.length,
+        final Map<Object?, Object?> map => map.length,
+        _ => null,
+      };
+    } on MontyException {
+      return null;
+    }
+  }
+
+  @override
+  String? resultType(int handle, List<Object> path) {
+    try {
+      return switch (_resolve(path)) {
+        null => 'NoneType',
+        bool() => 'bool',
+        int() => 'int',
+        double() => 'float',
+        String() => 'str',
+        List<Object?>() => 'list',
+        Map<Object?, Object?>() => 'dict',
+        _ => 'object',
+      };
+    } on MontyException {
+      return null;
+    }
+  }
+
+  Object? _resolve(List<Object> path) {
+    var value = nextResultValue;
+    for (final step in path) {
+      value = switch ((value, step)) {
+        (final Map<Object?, Object?> map, _) when map.containsKey(step) =>
+          map[step],
+        (final List<Object?> items, final int i)
+            when i >= -items.length && i < items.length =>
+          items[i < 0 ? i + items.length : i],
+        _ => throw MontyException(message: 'cannot resolve $step'),
+      };
+    }
+
+    return value;
+  }
+
   @override
   ProgressResult start(int handle) {
     startCalls.add(handle);
@@ -154,6 +527,17 @@ class MockNativeBindings extends NativeBindings {
     );
   }
 
+  @override
+  ProgressResult resumeBin(int handle, Uint8List value) {
+    resumeBinCalls.add((handle: handle, value: value));
+    if (resumeResults.isNotEmpty) return resumeResults.removeAt(0);
+
+    return const ProgressResult(
+      tag: 0,
+      resultJson: _defaultCompleteJson,
+    );
+  }
+
   @override
   ProgressResult resumeWithError(int handle, String errorMessage) {
     resumeWithErrorCalls.add(
@@ -201,6 +585,25 @@ class MockNativeBindings extends NativeBindings {
     );
   }
 
+  @override
+  ProgressResult resolveFuturesBin(
+    int handle,
+    Uint8List results,
+    Uint8List? errors,
+  ) {
+    resolveFuturesBinCalls.add(
+      (handle: handle, results: results, errors: errors),
+    );
+    if (resolveFuturesResults.isNotEmpty) {
+      return resolveFuturesResults.removeAt(0);
+    }
+
+    return const ProgressResult(
+      tag: 0,
+      resultJson: _defaultCompleteJson,
+    );
+  }
+
   @override
   void setMemoryLimit(int handle, int bytes) {
     setMemoryLimitCalls.add((handle: handle, bytes: bytes));
@@ -216,6 +619,90 @@ class MockNativeBindings extends NativeBindings {
     setStackLimitCalls.add((handle: handle, depth: depth));
   }
 
+  @override
+  int interruptNew() {
+    interruptNewCalls++;
+
+    return nextInterrupt;
+  }
+
+  @override
+  void interruptFree(int interrupt) {
+    interruptFreeCalls.add(interrupt);
+  }
+
+  @override
+  void interrupt(int interrupt) {
+    interruptCalls.add(interrupt);
+  }
+
+  @override
+  void interruptClear(int interrupt) {
+    interruptClearCalls.add(interrupt);
+  }
+
+  @override
+  void setInterrupt(int handle, int interrupt) {
+    setInterruptCalls.add((handle: handle, interrupt: interrupt));
+  }
+
+  @override
+  void setOutputStream(
+    int handle, {
+    int maxRetainedBytes = 0,
+    void Function(String text)? onOutput,
+  }) {
+    setOutputStreamCalls
+        .add((handle: handle, maxRetainedBytes: maxRetainedBytes));
+    if (onOutput != null) {
+      outputCallbacks[handle] = onOutput;
+    } else {
+      outputCallbacks.remove(handle);
+    }
+  }
+
+  @override
+  String? takeOutput(int handle) {
+    takeOutputCalls.add(handle);
+    if (takeOutputResults.isEmpty) return null;
+
+    return takeOutputResults.removeAt(0);
+  }
+
+  @override
+  void setTrace(int handle, {required bool enabled}) {
+    setTraceCalls.add((handle: handle, enabled: enabled));
+  }
+
+  @override
+  String? takeTrace(int handle) {
+    takeTraceCalls.add(handle);
+    if (takeTraceResults.isEmpty) return null;
+
+    return takeTraceResults.removeAt(0);
+  }
+
+  @override
+  MontyResourceUsage usage(int handle) {
+    usageCalls.add(handle);
+
+    return nextUsage;
+  }
+
+  @override
+  String inspectJson(int handle) {
+    inspectCalls.add(handle);
+
+    return nextInspectJson;
+  }
+
+  @override
+  ProgressResult? progress(int handle) {
+    progressCalls.add(handle);
+
+    return nextProgress;
+  }
+
   @override
   Uint8List snapshot(int handle) {
     snapshotCalls.add(handle);
@@ -233,4 +720,168 @@ class MockNativeBindings extends NativeBindings {
 
     return nextRestoreHandle;
   }
+
+  @override
+  void snapshotToFile(int handle, String path) {
+    snapshotToFileCalls.add((handle: handle, path: path));
+  }
+
+  @override
+  int restoreFile(String path) {
+    restoreFileCalls.add(path);
+    final restoreFileError = nextRestoreFileError;
+    if (restoreFileError != null) {
+      throw MontyException(message: restoreFileError);
+    }
+
+    return nextRestoreFileHandle;
+  }
+
+  @override
+  int compileProgram(
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    String? inputNames,
+  }) {
+    compileProgramCalls.add(
+      (
+        code: code,
+        externalFunctions: externalFunctions,
+        scriptName: scriptName,
+        inputNames: inputNames,
+      ),
+    );
+    final compileError = nextCompileError;
+    if (compileError != null) {
+      throw MontyException(message: compileError);
+    }
+
+    return nextProgram;
+  }
+
+  @override
+  int instantiateProgram(int program, {Uint8List? inputs}) {
+    instantiateProgramCalls.add(program);
+    instantiateProgramInputs.add(inputs);
+
+    return nextInstantiateHandle;
+  }
+
+  @override
+  void freeProgram(int program) {
+    freeProgramCalls.add(program);
+  }
+
+  @override
+  Uint8List runBatch(
+    int program,
+    Uint8List inputs, {
+    int threads = 0,
+    String? limitsJson,
+    int? interrupt,
+  }) {
+    runBatchCalls.add(
+      (
+        program: program,
+        inputs: inputs,
+        threads: threads,
+        limitsJson: limitsJson,
+        interrupt: interrupt,
+      ),
+    );
+    final error = nextRunBatchError;
+    if (error != null) {
+      throw MontyException(message: error);
+    }
+
+    return nextRunBatchResult;
+  }
+
+  @override
+  int cacheNew(int capacityBytes, {String? directory}) {
+    cacheNewCalls.add((capacityBytes: capacityBytes, directory: directory));
+
+    return nextCache;
+  }
+
+  @override
+  void cacheRetain(int cache) {
+    cacheRetainCalls.add(cache);
+  }
+
+  @override
+  void cacheFree(int cache) {
+    cacheFreeCalls.add(cache);
+  }
+
+  @override
+  void cacheClear(int cache) {
+    cacheClearCalls.add(cache);
+  }
+
+  @override
+  ProgramCacheStats cacheStats(int cache) => nextCacheStats;
+
+  @override
+  int createCached(
+    int cache,
+    String code, {
+    String? externalFunctions,
+    String? scriptName,
+    Uint8List? inputs,
+  }) {
+    createCachedCalls.add(
+      (
+        cache: cache,
+        code: code,
+        externalFunctions: externalFunctions,
+        scriptName: scriptName,
+        inputs: inputs,
+      ),
+    );
+
+    return nextCreateCachedHandle;
+  }
+
+  @override
+  int replCreate({String? scriptName}) {
+    replCreateCalls.add(scriptName);
+
+    return nextReplSession;
+  }
+
+  @override
+  RunResult replFeed(int session, String code) {
+    replFeedCalls.add((session: session, code: code));
+    if (replFeedResults.isNotEmpty) return replFeedResults.removeAt(0);
+
+    return const RunResult(
+      tag: 0,
+      resultJson: '{"value": null, "usage": {"memory_bytes_used": 0, '
+          '"time_elapsed_ms": 0, "stack_depth_used": 0}}',
+    );
+  }
+
+  @override
+  void replSetLimits(
+    int session, {
+    int? memoryBytes,
+    int? timeoutMs,
+    int? stackDepth,
+  }) {
+    replSetLimitsCalls.add(
+      (
+        session: session,
+        memoryBytes: memoryBytes,
+        timeoutMs: timeoutMs,
+        stackDepth: stackDepth,
+      ),
+    );
+  }
+
+  @override
+  void replFree(int session) {
+    replFreeCalls.add(session);
+  }
 }
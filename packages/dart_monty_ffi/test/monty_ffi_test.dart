@@ -1,6 +1,8 @@
+import 'dart:convert';
 import 'dart:typed_data';
 
 import 'package:dart_monty_ffi/src/monty_ffi.dart';
+import 'package:dart_monty_ffi/src/monty_value_codec.dart';
 import 'package:dart_monty_ffi/src/native_bindings.dart';
 import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
 import 'package:test/test.dart';
@@ -102,10 +104,14 @@ void main() {
       expect(mock.createCalls.first.scriptName, 'test.py');
     });
 
-    test('throws UnsupportedError for non-empty inputs', () {
+    test('passes inputs to create() in the binary value format', () async {
+      mock.nextRunResult = RunResult(tag: 0, resultJson: _okResultJson(2));
+      final result = await monty.run('a + 1', inputs: {'a': 1});
+
+      expect(result.value, 2);
       expect(
-        () => monty.run('x', inputs: {'a': 1}),
-        throwsA(isA<UnsupportedError>()),
+        MontyValueCodec.decode(mock.createCalls.first.inputs!),
+        {'a': 1},
       );
     });
 
@@ -115,6 +121,7 @@ void main() {
       // ignore: avoid_redundant_argument_values
       final result = await monty.run('1', inputs: null);
       expect(result.value, 1);
+      expect(mock.createCalls.first.inputs, isNull);
     });
 
     test('allows empty inputs', () async {
@@ -158,6 +165,127 @@ void main() {
   // ===========================================================================
   // start()
   // ===========================================================================
+  group('runRef()', () {
+    test('returns a ref to the value', () async {
+      mock.nextResultValue = [1, 2, 3];
+
+      final ref = await monty.runRef('[1, 2, 3]');
+
+      expect(ref.length, 3);
+      expect(ref[-1].value, 3);
+      ref.dispose();
+      expect(mock.freeCalls, [42]);
+    });
+
+    test('throws MontyException on error', () async {
+      mock.nextRunDeferredResult = RunResult(
+        tag: 1,
+        resultJson: _errorResultJson('boom'),
+      );
+
+      await expectLater(
+        monty.runRef('raise ValueError()'),
+        throwsA(isA<MontyException>()),
+      );
+    });
+  });
+
+  group('runBatch()', () {
+    test('returns results in order with errors as results', () async {
+      final usage = json.decode(_usageJson) as Map<String, dynamic>;
+      mock.nextRunBatchResult = MontyValueCodec.encode([
+        [
+          0,
+          {'value': 2, 'usage': usage},
+        ],
+        [
+          1,
+          {
+            'value': null,
+            'error': {'message': 'boom'},
+            'usage': usage,
+          },
+        ],
+      ]);
+
+      final results = await monty.runBatch(
+        'x * 2',
+        [
+          {'x': 1},
+          {'x': -1},
+        ],
+        limits: const MontyLimits(timeoutMs: 50),
+        threads: 4,
+      );
+
+      expect(results.first.value, 2);
+      expect(results.first.usage.stackDepthUsed, 3);
+      expect(results.last.isError, isTrue);
+      expect(results.last.error?.message, 'boom');
+      final call = mock.runBatchCalls.single;
+      expect(call.threads, 4);
+      expect(json.decode(call.limitsJson!), {'timeout_ms': 50});
+    });
+
+    test('runs the batch watching a cleared interrupt', () async {
+      await monty.runBatch('x', [
+        {'x': 1},
+      ]);
+
+      expect(mock.runBatchCalls.single.interrupt, mock.nextInterrupt);
+      expect(mock.interruptClearCalls, [mock.nextInterrupt]);
+    });
+
+    test('throws after dispose', () async {
+      await monty.dispose();
+
+      expect(() => monty.runBatch('x', const []), throwsStateError);
+    });
+  });
+
+  group('runPrecompiled() / startPrecompiled()', () {
+    final data = Uint8List.fromList([1, 2, 3]);
+
+    test('runs the restored program without compiling', () async {
+      mock
+        ..nextRestoreHandle = 77
+        ..nextRunResult = RunResult(tag: 0, resultJson: _okResultJson(3));
+
+      final result = await monty.runPrecompiled(
+        data,
+        limits: const MontyLimits(memoryBytes: 1024),
+      );
+
+      expect(result.value, 3);
+      expect(mock.createCalls, isEmpty);
+      expect(mock.restoreCalls.single, data);
+      expect(mock.runCalls, [77]);
+      expect(mock.setMemoryLimitCalls.single, (handle: 77, bytes: 1024));
+      expect(mock.freeCalls, [77]);
+    });
+
+    test('starts the restored program and stays active at a call', () async {
+      mock
+        ..nextRestoreHandle = 77
+        ..nextStartResult = const ProgressResult(tag: 1, functionName: 'f');
+
+      final progress = await monty.startPrecompiled(data);
+
+      expect(progress, isA<MontyPending>());
+      expect(mock.startCalls, [77]);
+      expect(() => monty.runPrecompiled(data), throwsStateError);
+    });
+
+    test('throws MontyException when the program fails', () async {
+      mock.nextRunResult = const RunResult(tag: 1, errorMessage: 'boom');
+
+      expect(
+        () => monty.runPrecompiled(data),
+        throwsA(isA<MontyException>()),
+      );
+    });
+  });
+
   group('start()', () {
     test('returns MontyComplete when code completes immediately', () async {
       mock.nextStartResult = ProgressResult(
@@ -305,10 +433,12 @@ void main() {
       );
     });
 
-    test('throws UnsupportedError for non-empty inputs', () {
+    test('passes inputs to create()', () async {
+      await monty.start('x', inputs: {'x': 'hello'});
+
       expect(
-        () => monty.start('x', inputs: {'a': 1}),
-        throwsA(isA<UnsupportedError>()),
+        MontyValueCodec.decode(mock.createCalls.first.inputs!),
+        {'x': 'hello'},
       );
     });
 
@@ -487,6 +617,168 @@ void main() {
     });
   });
 
+  // ===========================================================================
+  // currentUsage()
+  // ===========================================================================
+  group('currentUsage()', () {
+    test('returns null when idle', () async {
+      expect(await monty.currentUsage(), isNull);
+    });
+
+    test('reads usage while paused', () async {
+      mock
+        ..nextStartResult = const ProgressResult(
+          tag: 1,
+          functionName: 'f',
+          argumentsJson: '[]',
+        )
+        ..nextUsage = const MontyResourceUsage(
+          memoryBytesUsed: 128,
+          timeElapsedMs: 2,
+          stackDepthUsed: 1,
+          allocations: 9,
+        );
+      await monty.start('x', externalFunctions: ['f']);
+
+      final usage = await monty.currentUsage();
+
+      expect(usage?.memoryBytesUsed, 128);
+      expect(usage?.allocations, 9);
+    });
+
+    test('throws StateError when disposed', () async {
+      await monty.dispose();
+      expect(() => monty.currentUsage(), throwsStateError);
+    });
+  });
+
+  // ===========================================================================
+  // inspect()
+  // ===========================================================================
+  group('inspect()', () {
+    test('returns null when idle', () async {
+      expect(await monty.inspect(), isNull);
+      expect(mock.inspectCalls, isEmpty);
+    });
+
+    test('inspects the paused handle', () async {
+      mock
+        ..nextStartResult = const ProgressResult(
+          tag: 1,
+          functionName: 'f',
+          argumentsJson: '[]',
+        )
+        ..nextInspectJson = '{"state": "pending", "heap_bytes": 512, '
+            '"peak_heap_bytes": 600, "memory_limit": 1024, '
+            '"live_allocations": 3, "allocations": 5, '
+            '"live_by_size": [{"max_bytes": 32, "count": 3}], '
+            '"stack_depth": 2, "max_stack_depth": 2, "stack_limit": null, '
+            '"time_elapsed_ms": 0, "pending": {"function_name": "f", '
+            '"call_id": 0, "args": [{"type": "str", "len": 4}], '
+            '"kwargs": []}}';
+      await monty.start('x', externalFunctions: ['f']);
+
+      final inspection = await monty.inspect();
+
+      expect(mock.inspectCalls, hasLength(1));
+      expect(inspection?.heapBytes, 512);
+      expect(inspection?.memoryLimit, 1024);
+      expect(inspection?.liveBySize, const [
+        MontyHeapBucket(maxBytes: 32, count: 3),
+      ]);
+      expect(
+        inspection?.pendingCall?.arguments,
+        const [MontyValueShape(type: 'str', length: 4)],
+      );
+    });
+
+    test('throws StateError when disposed', () async {
+      await monty.dispose();
+      expect(() => monty.inspect(), throwsStateError);
+    });
+  });
+
+  // ===========================================================================
+  // feed() / resetSession()
+  // ===========================================================================
+  group('feed()', () {
+    test('creates one REPL session and reuses it', () async {
+      mock.replFeedResults.addAll([
+        RunResult(tag: 0, resultJson: _okResultJson('null')),
+        RunResult(tag: 0, resultJson: _okResultJson(43)),
+      ]);
+
+      await monty.feed('x = 42', scriptName: 'repl.py');
+      final result = await monty.feed('x + 1');
+
+      expect(result.value, 43);
+      expect(mock.replCreateCalls, ['repl.py']);
+      expect(mock.replFeedCalls.map((c) => c.code), ['x = 42', 'x + 1']);
+      expect(mock.createCalls, isEmpty);
+    });
+
+    test('applies limits given with each feed', () async {
+      await monty.feed(
+        '1',
+        limits: const MontyLimits(memoryBytes: 1024, timeoutMs: 50),
+      );
+      await monty.feed('2');
+      await monty.feed('3', limits: const MontyLimits(memoryBytes: 1));
+
+      expect(mock.replCreateCalls, hasLength(1));
+      expect(mock.replSetLimitsCalls, hasLength(2));
+      expect(mock.replSetLimitsCalls.first.memoryBytes, 1024);
+      expect(mock.replSetLimitsCalls.first.timeoutMs, 50);
+      expect(mock.replSetLimitsCalls.last.memoryBytes, 1);
+      expect(mock.replSetLimitsCalls.last.timeoutMs, isNull);
+    });
+
+    test('throws MontyException on error and keeps the session', () async {
+      mock.replFeedResults.add(
+        RunResult(
+          tag: 1,
+          resultJson: _errorResultJson('boom'),
+          errorMessage: 'boom',
+        ),
+      );
+
+      await expectLater(
+        monty.feed('raise ValueError()'),
+        throwsA(isA<MontyException>()),
+      );
+      await monty.feed('1');
+      expect(mock.replCreateCalls, hasLength(1));
+      expect(mock.replFreeCalls, isEmpty);
+    });
+
+    test('resetSession() frees the session', () async {
+      await monty.feed('x = 1');
+      await monty.resetSession();
+      await monty.feed('x');
+
+      expect(mock.replFreeCalls, [11]);
+      expect(mock.replCreateCalls, hasLength(2));
+    });
+
+    test('dispose() frees the session', () async {
+      await monty.feed('x = 1');
+      await monty.dispose();
+
+      expect(mock.replFreeCalls, [11]);
+    });
+
+    test('throws StateError when active', () async {
+      mock.nextStartResult = const ProgressResult(
+        tag: 1,
+        functionName: 'f',
+        argumentsJson: '[]',
+      );
+      await monty.start('f()', externalFunctions: ['f']);
+
+      expect(() => monty.feed('1'), throwsStateError);
+    });
+  });
+
   // ===========================================================================
   // snapshot()
   // ===========================================================================
@@ -557,6 +849,26 @@ void main() {
       expect((progress as MontyComplete).result.value, 10);
     });
 
+    test('pendingProgress() reports where the snapshot paused', () async {
+      mock
+        ..nextRestoreHandle = 77
+        ..nextProgress = const ProgressResult(
+          tag: 3,
+          futureCallIdsJson: '[0, 1]',
+        );
+
+      final restored =
+          await monty.restore(Uint8List.fromList([1, 2, 3])) as MontyFfi;
+      final progress = await restored.pendingProgress();
+
+      expect(progress, isA<MontyResolveFutures>());
+      expect((progress! as MontyResolveFutures).pendingCallIds, [0, 1]);
+    });
+
+    test('pendingProgress() is null when idle', () async {
+      expect(await monty.pendingProgress(), isNull);
+    });
+
     test('throws MontyException when restore fails', () {
       mock.nextRestoreError = 'invalid snapshot';
 
@@ -589,6 +901,56 @@ void main() {
     });
   });
 
+  // ===========================================================================
+  // snapshotToFile() / restoreFile()
+  // ===========================================================================
+  group('snapshotToFile() / restoreFile()', () {
+    test('snapshotToFile() writes the active handle', () async {
+      mock.nextStartResult = const ProgressResult(
+        tag: 1,
+        functionName: 'f',
+        argumentsJson: '[]',
+      );
+      await monty.start('x', externalFunctions: ['f']);
+
+      await monty.snapshotToFile('/tmp/a.snap');
+
+      expect(mock.snapshotToFileCalls, hasLength(1));
+      expect(mock.snapshotToFileCalls.first.path, '/tmp/a.snap');
+    });
+
+    test('snapshotToFile() throws StateError when idle', () {
+      expect(() => monty.snapshotToFile('/tmp/a.snap'), throwsStateError);
+    });
+
+    test('restoreFile() returns new MontyFfi in active state', () async {
+      mock.resumeResults.add(
+        ProgressResult(tag: 0, resultJson: _okResultJson(5), isError: 0),
+      );
+
+      final restored = await monty.restoreFile('/tmp/a.snap') as MontyFfi;
+
+      expect(mock.restoreFileCalls, ['/tmp/a.snap']);
+      expect(() => restored.run('x'), throwsStateError);
+      final progress = await restored.resume('val');
+      expect((progress as MontyComplete).result.value, 5);
+    });
+
+    test('restoreFile() throws MontyException when restore fails', () {
+      mock.nextRestoreFileError = 'container checksum mismatch';
+
+      expect(
+        () => monty.restoreFile('/tmp/a.snap'),
+        throwsA(isA<MontyException>()),
+      );
+    });
+
+    test('restoreFile() throws StateError when disposed', () async {
+      await monty.dispose();
+      expect(() => monty.restoreFile('/tmp/a.snap'), throwsStateError);
+    });
+  });
+
   // ===========================================================================
   // dispose()
   // ===========================================================================
@@ -0,0 +1,104 @@
+import 'package:dart_monty_ffi/dart_monty_ffi.dart';
+import 'package:test/test.dart';
+
+import 'mock_native_bindings.dart';
+
+void main() {
+  late MockNativeBindings mock;
+
+  setUp(() {
+    mock = MockNativeBindings();
+  });
+
+  group('MontyProgramCache()', () {
+    test('creates a native cache with the given capacity', () {
+      final cache = MontyProgramCache(bindings: mock, capacityBytes: 4096);
+
+      expect(mock.cacheNewCalls.single.capacityBytes, 4096);
+      expect(mock.cacheNewCalls.single.directory, isNull);
+      expect(cache.address, mock.nextCache);
+    });
+
+    test('defaults to defaultCapacityBytes', () {
+      MontyProgramCache(bindings: mock);
+
+      expect(
+        mock.cacheNewCalls.single.capacityBytes,
+        MontyProgramCache.defaultCapacityBytes,
+      );
+    });
+
+    test('forwards the cache directory', () {
+      MontyProgramCache(bindings: mock, directory: '/var/cache/monty');
+
+      expect(mock.cacheNewCalls.single.directory, '/var/cache/monty');
+    });
+  });
+
+  group('MontyProgramCache.attach()', () {
+    test('retains the existing cache', () {
+      final cache = MontyProgramCache.attach(bindings: mock, address: 77);
+
+      expect(cache.address, 77);
+      expect(mock.cacheNewCalls, isEmpty);
+      expect(mock.cacheRetainCalls, [77]);
+    });
+  });
+
+  group('stats', () {
+    test('reads the native counters', () {
+      mock.nextCacheStats = const ProgramCacheStats(
+        hits: 3,
+        misses: 1,
+        entries: 1,
+        bytes: 200,
+        capacityBytes: 4096,
+      );
+      final cache = MontyProgramCache(bindings: mock);
+
+      expect(cache.stats.hits, 3);
+      expect(cache.stats.misses, 1);
+      expect(cache.capacityBytes, 4096);
+    });
+  });
+
+  group('create()', () {
+    test('forwards to createCached', () {
+      final cache = MontyProgramCache(bindings: mock);
+
+      final handle = cache.create('f()', externalFunctions: 'f');
+
+      expect(handle, mock.nextCreateCachedHandle);
+      final call = mock.createCachedCalls.single;
+      expect(call.cache, cache.address);
+      expect(call.code, 'f()');
+      expect(call.externalFunctions, 'f');
+    });
+  });
+
+  group('clear()', () {
+    test('clears the native cache', () {
+      MontyProgramCache(bindings: mock).clear();
+
+      expect(mock.cacheClearCalls, [mock.nextCache]);
+    });
+  });
+
+  group('dispose()', () {
+    test('releases the reference once', () {
+      MontyProgramCache(bindings: mock)
+        ..dispose()
+        ..dispose();
+
+      expect(mock.cacheFreeCalls, [mock.nextCache]);
+    });
+
+    test('later calls throw StateError', () {
+      final cache = MontyProgramCache(bindings: mock)..dispose();
+
+      expect(() => cache.stats, throwsStateError);
+      expect(cache.clear, throwsStateError);
+      expect(() => cache.create('1'), throwsStateError);
+    });
+  });
+}
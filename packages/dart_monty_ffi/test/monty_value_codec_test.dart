@@ -0,0 +1,270 @@
+import 'dart:typed_data';
+
+import 'package:dart_monty_ffi/dart_monty_ffi.dart';
+import 'package:test/test.dart';
+
+Object? _roundTrip(Object? value) =>
+    MontyValueCodec.decode(MontyValueCodec.encode(value));
+
+void main() {
+  group('encode()', () {
+    test('scalars use one tag byte plus payload', () {
+      expect(MontyValueCodec.encode(null), [0x00]);
+      expect(MontyValueCodec.encode(false), [0x01]);
+      expect(MontyValueCodec.encode(true), [0x02]);
+      expect(
+        MontyValueCodec.encode(1),
+        [0x03, 1, 0, 0, 0, 0, 0, 0, 0],
+      );
+    });
+
+    test('strings are length-prefixed UTF-8', () {
+      expect(
+        MontyValueCodec.encode('hé'),
+        [0x06, 3, 0, 0, 0, 0x68, 0xC3, 0xA9],
+      );
+    });
+
+    test('BigInt within 64 bits encodes as Int', () {
+      expect(
+        MontyValueCodec.encode(BigInt.from(-2)),
+        MontyValueCodec.encode(-2),
+      );
+    });
+
+    test('BigInt beyond 64 bits encodes sign and magnitude', () {
+      final bytes = MontyValueCodec.encode(-(BigInt.one << 64));
+      expect(bytes, [0x04, 1, 9, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1]);
+    });
+
+    test('Set encodes as Set tag', () {
+      expect(MontyValueCodec.encode({1}).first, 0x0B);
+    });
+
+    test('Uint8List encodes as List', () {
+      expect(MontyValueCodec.encode(Uint8List.fromList([7])).first, 0x08);
+    });
+
+    test('Int64List and Float64List encode packed and aligned', () {
+      final ints = MontyValueCodec.encode(Int64List.fromList([1, -1]));
+      // Tag, count, pad length 2, two pad bytes, then the elements.
+      expect(ints.sublist(0, 8), [0x0E, 2, 0, 0, 0, 2, 0, 0]);
+      expect(ints, hasLength(8 + 16));
+
+      final floats = MontyValueCodec.encode(Float64List.fromList([0.5]));
+      expect(floats.first, 0x0F);
+    });
+
+    test('falls back to toJson()', () {
+      expect(_roundTrip(_JsonValue()), {'a': 1});
+    });
+
+    test('encodeCallIdMap keys by int', () {
+      expect(
+        MontyValueCodec.decode(MontyValueCodec.encodeCallIdMap({3: 'x'})),
+        [
+          [3, 'x'],
+        ],
+      );
+    });
+  });
+
+  group('decode()', () {
+    test('round-trips JSON-compatible values', () {
+      final value = {
+        'ints': [0, -1, 9007199254740993],
+        'floats': [0.5, -2.25],
+        'text': 'hello',
+        'nested': {
+          'flag': true,
+          'none': null,
+        },
+      };
+      expect(_roundTrip(value), value);
+    });
+
+    test('non-finite floats decode as JSON strings', () {
+      expect(_roundTrip(double.nan), 'NaN');
+      expect(_roundTrip(double.infinity), 'Infinity');
+      expect(_roundTrip(double.negativeInfinity), '-Infinity');
+    });
+
+    test('large BigInt decodes as decimal string', () {
+      final n = BigInt.parse('123456789012345678901234567890');
+      expect(_roundTrip(n), n.toString());
+      expect(_roundTrip(-n), (-n).toString());
+    });
+
+    test('Set decodes as List', () {
+      expect(_roundTrip({1, 2}), [1, 2]);
+    });
+
+    test('dict with non-string keys decodes as pairs', () {
+      expect(_roundTrip({1: 'a', 'b': 2}), [
+        [1, 'a'],
+        ['b', 2],
+      ]);
+    });
+
+    test('Tuple, Bytes, and Ellipsis tags', () {
+      expect(
+        MontyValueCodec.decode(Uint8List.fromList([0x09, 1, 0, 0, 0, 0x00])),
+        [null],
+      );
+      final bytes = MontyValueCodec.decode(
+        Uint8List.fromList([0x07, 2, 0, 0, 0, 1, 2]),
+      );
+      expect(bytes, isNot(isA<Uint8List>()));
+      expect(bytes, [1, 2]);
+      expect(MontyValueCodec.decode(Uint8List.fromList([0x0D])), '...');
+    });
+
+    test('packed arrays decode as plain lists', () {
+      final ints = MontyValueCodec.decode(
+        MontyValueCodec.encode(Int64List.fromList([3])),
+      );
+      expect(ints, isNot(isA<TypedData>()));
+      expect(ints, [3]);
+      (ints! as List<Object?>).add('grows');
+
+      final floats = MontyValueCodec.decode(
+        MontyValueCodec.encode(Float64List.fromList([double.nan, 1.5])),
+      );
+      expect(floats, isNot(isA<TypedData>()));
+      expect(floats, ['NaN', 1.5]);
+    });
+
+    test('typedData decodes packed arrays as typed-list views', () {
+      final ints = MontyValueCodec.encode(Int64List.fromList([3, -4]));
+      final decoded = MontyValueCodec.decode(ints, typedData: true);
+      expect(decoded, isA<Int64List>());
+      expect(decoded, [3, -4]);
+      expect((decoded! as Int64List).buffer, same(ints.buffer));
+
+      final floats = MontyValueCodec.decode(
+        MontyValueCodec.encode(Float64List.fromList([double.nan, 1.5])),
+        typedData: true,
+      );
+      expect(floats, isA<Float64List>());
+      expect((floats! as Float64List)[0], isNaN);
+      expect(floats[1], 1.5);
+    });
+
+    test('typedData decodes Bytes as a Uint8List view', () {
+      final bytes = Uint8List.fromList([0x07, 2, 0, 0, 0, 1, 2]);
+      final decoded = MontyValueCodec.decode(bytes, typedData: true);
+      expect(decoded, isA<Uint8List>());
+      expect(decoded, [1, 2]);
+      expect((decoded! as Uint8List).buffer, same(bytes.buffer));
+    });
+
+    test('packed arrays at an unaligned offset decode as copies', () {
+      // Pad length 0 puts the element at offset 6.
+      final bytes = Uint8List.fromList([
+        0x0E, 1, 0, 0, 0, 0, //
+        5, 0, 0, 0, 0, 0, 0, 0,
+      ]);
+      final decoded = MontyValueCodec.decode(bytes, typedData: true);
+      expect(decoded, isA<Int64List>());
+      expect(decoded, [5]);
+    });
+
+    test('throws FormatException on truncated input', () {
+      expect(
+        () => MontyValueCodec.decode(Uint8List.fromList([0x03, 1])),
+        throwsFormatException,
+      );
+    });
+
+    test('throws FormatException on unknown tag', () {
+      expect(
+        () => MontyValueCodec.decode(Uint8List.fromList([0xFF])),
+        throwsFormatException,
+      );
+    });
+
+    test('throws FormatException on trailing bytes', () {
+      expect(
+        () => MontyValueCodec.decode(Uint8List.fromList([0x00, 0x00])),
+        throwsFormatException,
+      );
+    });
+  });
+
+  group('split()', () {
+    test('returns encoded element views of a tuple', () {
+      // Tuple(1, 'a', [None]) as monty_progress_bin would emit it.
+      final bytes = Uint8List.fromList([
+        0x09, 3, 0, 0, 0, //
+        0x03, 1, 0, 0, 0, 0, 0, 0, 0, //
+        0x06, 1, 0, 0, 0, 0x61, //
+        0x08, 1, 0, 0, 0, 0x00,
+      ]);
+      final parts = MontyValueCodec.split(bytes);
+
+      expect(parts, hasLength(3));
+      expect(MontyValueCodec.decode(parts[0]), 1);
+      expect(MontyValueCodec.decode(parts[1]), 'a');
+      expect(MontyValueCodec.decode(parts[2]), [null]);
+    });
+
+    test('skips nested dicts and big ints', () {
+      final value = [
+        {'k': -(BigInt.one << 70), 2: 0.5},
+        true,
+      ];
+      final parts = MontyValueCodec.split(MontyValueCodec.encode(value));
+
+      expect(parts, hasLength(2));
+      expect(MontyValueCodec.decode(parts[1]), isTrue);
+    });
+
+    test('skips packed arrays', () {
+      final value = [
+        Float64List.fromList([1, 2, 3]),
+        'after',
+      ];
+      final parts = MontyValueCodec.split(MontyValueCodec.encode(value));
+
+      expect(parts, hasLength(2));
+      expect(MontyValueCodec.decode(parts[1]), 'after');
+    });
+
+    test('throws FormatException on a non-sequence', () {
+      expect(
+        () => MontyValueCodec.split(MontyValueCodec.encode('x')),
+        throwsFormatException,
+      );
+    });
+  });
+
+  group('splitDict()', () {
+    test('returns encoded value views keyed by name', () {
+      final parts = MontyValueCodec.splitDict(
+        MontyValueCodec.encode({
+          'value': [1, 2],
+          'print_output': null,
+        }),
+      );
+
+      expect(parts.keys, ['value', 'print_output']);
+      expect(MontyValueCodec.decode(parts['value']!), [1, 2]);
+      expect(MontyValueCodec.decode(parts['print_output']!), isNull);
+    });
+
+    test('throws FormatException on a non-dict or a non-string key', () {
+      expect(
+        () => MontyValueCodec.splitDict(MontyValueCodec.encode([1])),
+        throwsFormatException,
+      );
+      expect(
+        () => MontyValueCodec.splitDict(MontyValueCodec.encode({1: 'a'})),
+        throwsFormatException,
+      );
+    });
+  });
+}
+
+class _JsonValue {
+  Map<String, Object?> toJson() => {'a': 1};
+}
@@ -0,0 +1,67 @@
+import 'package:dart_monty_ffi/dart_monty_ffi.dart';
+import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
+import 'package:test/test.dart';
+
+import 'mock_native_bindings.dart';
+
+void main() {
+  late MockNativeBindings mock;
+  late MontyValueRef ref;
+
+  setUp(() {
+    mock = MockNativeBindings()
+      ..nextResultValue = {
+        'users': [
+          {'name': 'ada'},
+          {'name': 'bob'},
+        ],
+        'title': 'report',
+      };
+    ref = MontyValueRef.forHandle(mock, 42);
+  });
+
+  test('indexing builds a path without reading', () {
+    final name = ref['users'][-1]['name'];
+
+    expect(name.path, ['users', -1, 'name']);
+    expect(mock.resultGetCalls, isEmpty);
+    expect(name.value, 'bob');
+    expect(mock.resultGetCalls.single.path, ['users', -1, 'name']);
+  });
+
+  test('reads length, type and slices', () {
+    expect(ref.length, 2);
+    expect(ref.type, 'dict');
+    expect(ref['users'].type, 'list');
+    expect(ref['title'].slice(1, 3), 'ep');
+    expect(ref['users'].slice(-1), [
+      {'name': 'bob'},
+    ]);
+  });
+
+  test('missing keys surface when read', () {
+    final missing = ref['nope'];
+
+    expect(() => missing.value, throwsA(isA<MontyException>()));
+    expect(missing.length, isNull);
+    expect(missing.type, isNull);
+  });
+
+  test('rejects keys that are not String or int', () {
+    expect(() => ref[1.5], throwsArgumentError);
+  });
+
+  test('dispose frees the shared handle once', () {
+    final child = ref['users'];
+
+    child.dispose();
+    ref.dispose();
+
+    expect(mock.freeCalls, [42]);
+    expect(mock.attachFreeCalls, [42]);
+    expect(mock.detachFreeCalls, 1);
+    expect(ref.isDisposed, isTrue);
+    expect(() => ref.value, throwsStateError);
+    expect(() => child.length, throwsStateError);
+  });
+}
@@ -0,0 +1,17 @@
+/// Benchmarks the native backend, including the Isolate hop per call.
+///
+/// Run from packages/dart_monty_native after building the native library:
+///   DART_MONTY_LIB_PATH=../../native/target/release/libdart_monty_native.so \
+///     dart run benchmark/monty_benchmark.dart
+library;
+
+import 'package:dart_monty_native/dart_monty_native.dart';
+
+import '../../dart_monty_platform_interface/benchmark/monty_benchmarks.dart';
+
+Future<void> main() => runMontyBenchmarks('native', () async {
+      final monty = MontyNative(bindings: NativeIsolateBindingsImpl());
+      await monty.initialize();
+
+      return monty;
+    });
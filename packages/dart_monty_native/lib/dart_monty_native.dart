@@ -6,6 +6,7 @@ import 'package:dart_monty_native/src/native_isolate_bindings_impl.dart';
 import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
 
 export 'src/monty_native.dart';
+export 'src/monty_pool.dart';
 export 'src/native_isolate_bindings.dart';
 export 'src/native_isolate_bindings_impl.dart';
 
@@ -18,7 +18,7 @@ import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart
 /// ```
 class MontyNative extends MontyPlatform
     with MontyStateMixin
-    implements MontySnapshotCapable, MontyFutureCapable {
+    implements MontySnapshotCapable, MontyFutureCapable, MontyReplCapable {
   /// Creates a [MontyNative] with the given [bindings].
   MontyNative({required NativeIsolateBindings bindings}) : _bindings = bindings;
 
@@ -28,6 +28,18 @@ class MontyNative extends MontyPlatform
   @override
   String get backendName => 'MontyNative';
 
+  /// Print output from the background Isolate.
+  ///
+  /// Text arrives line by line while the interpreter runs, instead of
+  /// only in [MontyResult.printOutput] at the end.
+  @override
+  Stream<String> get output => _bindings.output;
+
+  /// Trace events for each call, including the hop to the background
+  /// Isolate and back.
+  @override
+  Stream<MontyTraceEvent> get trace => _bindings.trace;
+
   /// Initializes the background Isolate.
   ///
   /// Must be called before any execution methods. Initialization is
@@ -52,13 +64,42 @@ class MontyNative extends MontyPlatform
   }) async {
     assertNotDisposed('run');
     assertIdle('run');
-    rejectInputs(inputs);
     await _ensureInitialized();
 
     return _bindings.run(
       code,
+      inputs: inputs,
+      limits: limits,
+      scriptName: scriptName,
+    );
+  }
+
+  /// Runs [code] once per entry of [inputs] in parallel on native threads
+  /// started by the background Isolate, compiling it only once.
+  ///
+  /// [threads] caps the threads (`0` for one per core). Results come back
+  /// in input order, and each input set must supply the same names. The
+  /// calling isolate stays responsive, and [cancel] stops the batch: runs
+  /// still going end with a `KeyboardInterrupt` and runs not yet started
+  /// report an error, each as its own result.
+  @override
+  Future<List<MontyResult>> runBatch(
+    String code,
+    List<Map<String, Object?>> inputs, {
+    MontyLimits? limits,
+    String? scriptName,
+    int threads = 0,
+  }) async {
+    assertNotDisposed('runBatch');
+    assertIdle('runBatch');
+    await _ensureInitialized();
+
+    return _bindings.runBatch(
+      code,
+      inputs,
       limits: limits,
       scriptName: scriptName,
+      threads: threads,
     );
   }
 
@@ -72,11 +113,11 @@ class MontyNative extends MontyPlatform
   }) async {
     assertNotDisposed('start');
     assertIdle('start');
-    rejectInputs(inputs);
     await _ensureInitialized();
 
     final progress = await _bindings.start(
       code,
+      inputs: inputs,
       externalFunctions: externalFunctions,
       limits: limits,
       scriptName: scriptName,
@@ -142,6 +183,66 @@ class MontyNative extends MontyPlatform
       ..markActive();
   }
 
+  /// Writes a snapshot of the active execution to [path] as a snapshot
+  /// container file, for a later [restoreFile].
+  ///
+  /// Only the path crosses the Isolate boundary; the snapshot bytes go
+  /// from the native side straight to disk.
+  Future<void> snapshotToFile(String path) {
+    assertNotDisposed('snapshotToFile');
+    assertActive('snapshotToFile');
+
+    return _bindings.snapshotToFile(path);
+  }
+
+  /// Restores a snapshot container file written by [snapshotToFile]
+  /// (or `monty_snapshot_file`) into a new [MontyNative] instance.
+  ///
+  /// The file is memory-mapped and deserialized in place in the
+  /// background Isolate, so no snapshot bytes are copied between Isolates.
+  Future<MontyPlatform> restoreFile(String path) async {
+    assertNotDisposed('restoreFile');
+    assertIdle('restoreFile');
+
+    await _bindings.restoreFile(path);
+
+    return MontyNative(bindings: _bindings)
+      .._initialized = _initialized
+      ..markActive();
+  }
+
+  @override
+  Future<MontyResult> feed(
+    String code, {
+    MontyLimits? limits,
+    String? scriptName,
+  }) async {
+    assertNotDisposed('feed');
+    assertIdle('feed');
+    await _ensureInitialized();
+
+    return _bindings.feed(code, limits: limits, scriptName: scriptName);
+  }
+
+  /// Interrupts the execution in the background Isolate without queueing
+  /// behind it, so a busy [run], [runBatch], [start] or resume ends with a
+  /// `KeyboardInterrupt` at the interpreter's next time check.
+  ///
+  /// Does nothing before [initialize] or after [dispose].
+  @override
+  Future<void> cancel() async {
+    if (isDisposed || !_initialized) return;
+    await _bindings.cancel();
+  }
+
+  @override
+  Future<void> resetSession() async {
+    assertNotDisposed('resetSession');
+    if (!_initialized) return;
+
+    await _bindings.resetSession();
+  }
+
   @override
   Future<void> dispose() async {
     if (isDisposed) return;
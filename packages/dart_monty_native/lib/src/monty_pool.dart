@@ -0,0 +1,313 @@
+import 'dart:async';
+import 'dart:collection';
+import 'dart:io' show Platform;
+import 'dart:typed_data';
+
+import 'package:dart_monty_ffi/dart_monty_ffi.dart' show MontyProgramCache;
+import 'package:dart_monty_native/src/monty_native.dart';
+import 'package:dart_monty_native/src/native_isolate_bindings.dart';
+import 'package:dart_monty_native/src/native_isolate_bindings_impl.dart';
+import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
+
+/// A pool of [MontyNative] workers, each running in its own background
+/// Isolate, that spreads executions across cores.
+///
+/// Workers are spawned lazily up to [size] (default: the number of
+/// processors). When every worker is busy, requests wait in a FIFO queue;
+/// once [maxQueued] requests are waiting, further requests fail fast with a
+/// [StateError] so callers can shed load.
+///
+/// A paused execution returned by [start] stays pinned to its worker until
+/// it completes, fails, or is [MontyPoolExecution.cancel]led.
+///
+/// ```dart
+/// final pool = MontyPool();
+/// final results = await Future.wait([
+///   for (final code in scripts) pool.run(code),
+/// ]);
+/// await pool.dispose();
+/// ```
+class MontyPool {
+  /// Creates a [MontyPool].
+  ///
+  /// [size] caps the number of worker Isolates and defaults to
+  /// [Platform.numberOfProcessors]. [maxQueued] caps the number of requests
+  /// waiting for a worker.
+  ///
+  /// Each worker gets its own bindings from [bindingsFactory], which
+  /// defaults to a [NativeIsolateBindingsImpl] using [libraryPath] and
+  /// [programCache]. Sharing one [programCache] lets every worker reuse
+  /// programs compiled by the others; it stays owned by the caller and
+  /// must outlive the pool.
+  MontyPool({
+    int? size,
+    this.maxQueued = 1024,
+    NativeIsolateBindings Function()? bindingsFactory,
+    String? libraryPath,
+    MontyProgramCache? programCache,
+  })  : size = size ?? Platform.numberOfProcessors,
+        _bindingsFactory = bindingsFactory ??
+            (() => NativeIsolateBindingsImpl(
+                  libraryPath: libraryPath,
+                  programCache: programCache,
+                )) {
+    if (this.size < 1) {
+      throw ArgumentError.value(size, 'size', 'must be at least 1');
+    }
+    if (maxQueued < 0) {
+      throw ArgumentError.value(maxQueued, 'maxQueued', 'must be >= 0');
+    }
+  }
+
+  /// Maximum number of worker Isolates.
+  final int size;
+
+  /// Maximum number of requests waiting for a worker.
+  final int maxQueued;
+
+  final NativeIsolateBindings Function() _bindingsFactory;
+  final List<MontyNative> _workers = [];
+  final Queue<MontyNative> _idle = Queue();
+  final Queue<Completer<MontyNative>> _waiting = Queue();
+  int _spawning = 0;
+  bool _disposed = false;
+
+  /// Number of worker Isolates spawned so far.
+  int get workerCount => _workers.length;
+
+  /// Number of workers not currently executing or pinned.
+  int get idleCount => _idle.length;
+
+  /// Number of requests waiting for a worker.
+  int get queueLength => _waiting.length;
+
+  /// Runs [code] to completion on the next free worker.
+  Future<MontyResult> run(
+    String code, {
+    Map<String, Object?>? inputs,
+    MontyLimits? limits,
+    String? scriptName,
+  }) async {
+    final worker = await _acquire('run');
+    try {
+      return await worker.run(
+        code,
+        inputs: inputs,
+        limits: limits,
+        scriptName: scriptName,
+      );
+    } on MontyException {
+      rethrow;
+    } on Object {
+      await _discard(worker);
+      rethrow;
+    } finally {
+      _release(worker);
+    }
+  }
+
+  /// Starts iterative execution of [code] on the next free worker.
+  ///
+  /// If the execution pauses, the worker stays pinned to the returned
+  /// [MontyPoolExecution] until it finishes.
+  Future<MontyPoolExecution> start(
+    String code, {
+    Map<String, Object?>? inputs,
+    List<String>? externalFunctions,
+    MontyLimits? limits,
+    String? scriptName,
+  }) async {
+    final worker = await _acquire('start');
+    final execution = MontyPoolExecution._(this, worker);
+    await execution._step(
+      () => worker.start(
+        code,
+        inputs: inputs,
+        externalFunctions: externalFunctions,
+        limits: limits,
+        scriptName: scriptName,
+      ),
+    );
+
+    return execution;
+  }
+
+  /// Disposes every worker and fails all queued requests.
+  ///
+  /// Safe to call more than once.
+  Future<void> dispose() async {
+    if (_disposed) return;
+    _disposed = true;
+    while (_waiting.isNotEmpty) {
+      _waiting.removeFirst().completeError(StateError('MontyPool disposed'));
+    }
+    final workers = List<MontyNative>.of(_workers);
+    _workers.clear();
+    _idle.clear();
+    await Future.wait(workers.map((w) => w.dispose()));
+  }
+
+  // ---------------------------------------------------------------------------
+  // Scheduling
+  // ---------------------------------------------------------------------------
+
+  Future<MontyNative> _acquire(String method) async {
+    if (_disposed) {
+      throw StateError('Cannot call $method() on a disposed MontyPool');
+    }
+    if (_idle.isNotEmpty) return _idle.removeFirst();
+    if (_workers.length + _spawning < size) return _spawn();
+    if (_waiting.length >= maxQueued) {
+      throw StateError(
+        'MontyPool queue is full ($maxQueued requests waiting)',
+      );
+    }
+    final completer = Completer<MontyNative>();
+    _waiting.add(completer);
+
+    return completer.future;
+  }
+
+  Future<MontyNative> _spawn() async {
+    _spawning++;
+    try {
+      final worker = MontyNative(bindings: _bindingsFactory());
+      await worker.initialize();
+      if (_disposed) {
+        await worker.dispose();
+        throw StateError('MontyPool disposed');
+      }
+      _workers.add(worker);
+
+      return worker;
+    } finally {
+      _spawning--;
+    }
+  }
+
+  /// Returns [worker] to the pool, handing it straight to the oldest
+  /// waiting request if there is one.
+  void _release(MontyNative worker) {
+    if (_disposed || !_workers.contains(worker)) return;
+    if (_waiting.isNotEmpty) {
+      _waiting.removeFirst().complete(worker);
+    } else {
+      _idle.add(worker);
+    }
+  }
+
+  /// Drops a worker whose Isolate is stuck or broken, and spawns a
+  /// replacement for the oldest waiting request.
+  Future<void> _discard(MontyNative worker) async {
+    _workers.remove(worker);
+    _idle.remove(worker);
+    await worker.dispose();
+    if (!_disposed && _waiting.isNotEmpty) {
+      final next = _waiting.removeFirst();
+      unawaited(_spawn().then(next.complete, onError: next.completeError));
+    }
+  }
+}
+
+/// An iterative execution started by [MontyPool.start], pinned to one
+/// worker until it completes.
+final class MontyPoolExecution {
+  MontyPoolExecution._(this._pool, this._worker);
+
+  final MontyPool _pool;
+  final MontyNative _worker;
+  late MontyProgress _progress;
+  bool _done = false;
+  bool _stepping = false;
+
+  /// The most recent progress of this execution.
+  MontyProgress get progress => _progress;
+
+  /// Whether the execution has finished and released its worker.
+  bool get isDone => _done;
+
+  /// Resumes the paused execution with [returnValue].
+  Future<MontyProgress> resume(Object? returnValue) =>
+      _step(() => _worker.resume(returnValue), method: 'resume');
+
+  /// Resumes the paused execution by raising [errorMessage] in Python.
+  Future<MontyProgress> resumeWithError(String errorMessage) => _step(
+        () => _worker.resumeWithError(errorMessage),
+        method: 'resumeWithError',
+      );
+
+  /// Converts the pending call into a future and continues execution.
+  Future<MontyProgress> resumeAsFuture() =>
+      _step(_worker.resumeAsFuture, method: 'resumeAsFuture');
+
+  /// Resolves pending futures with [results] and optional [errors].
+  Future<MontyProgress> resolveFutures(
+    Map<int, Object?> results, {
+    Map<int, String>? errors,
+  }) =>
+      _step(
+        () => _worker.resolveFutures(results, errors: errors),
+        method: 'resolveFutures',
+      );
+
+  /// Captures the paused execution as a snapshot.
+  Future<Uint8List> snapshot() {
+    _assertNotDone('snapshot');
+
+    return _worker.snapshot();
+  }
+
+  /// Stops this execution.
+  ///
+  /// A step still running on the worker is interrupted (see
+  /// [MontyNative.cancel]) and fails with a `KeyboardInterrupt`, freeing
+  /// the worker as any failure does. A paused execution is abandoned and
+  /// its worker's Isolate replaced, since a paused interpreter cannot be
+  /// reset in place. Does nothing once the execution is done, when the
+  /// worker may already be running someone else's code.
+  Future<void> cancel() async {
+    if (_done) return;
+    if (_stepping) {
+      await _worker.cancel();
+
+      return;
+    }
+    _done = true;
+    await _pool._discard(_worker);
+  }
+
+  Future<MontyProgress> _step(
+    Future<MontyProgress> Function() fn, {
+    String method = 'start',
+  }) async {
+    _assertNotDone(method);
+    _stepping = true;
+    try {
+      final progress = await fn();
+      _progress = progress;
+      if (progress is MontyComplete) _finish();
+
+      return progress;
+    } on MontyException {
+      _finish();
+      rethrow;
+    } on Object {
+      _done = true;
+      await _pool._discard(_worker);
+      rethrow;
+    } finally {
+      _stepping = false;
+    }
+  }
+
+  void _finish() {
+    _done = true;
+    _pool._release(_worker);
+  }
+
+  void _assertNotDone(String method) {
+    if (_done) {
+      throw StateError('Cannot call $method() on a finished execution');
+    }
+  }
+}
@@ -15,21 +15,46 @@ abstract class NativeIsolateBindings {
   /// Returns `true` if the Isolate spawned successfully.
   Future<bool> init();
 
+  /// Print output from the background Isolate, delivered line by line
+  /// while the interpreter runs.
+  Stream<String> get output;
+
+  /// Trace events from the background Isolate, followed by an
+  /// [MontyTraceKind.isolate] event timing each request's round trip.
+  Stream<MontyTraceEvent> get trace;
+
   /// Runs Python [code] to completion in the background Isolate.
   ///
-  /// If [scriptName] is non-null, it overrides the default filename in
-  /// tracebacks and error messages.
+  /// [inputs], if non-null, are bound as global variables before the code
+  /// runs. If [scriptName] is non-null, it overrides the default filename
+  /// in tracebacks and error messages.
   Future<MontyResult> run(
     String code, {
+    Map<String, Object?>? inputs,
     MontyLimits? limits,
     String? scriptName,
   });
 
+  /// Runs [code] once per entry of [inputs] on native threads started by
+  /// the background Isolate, compiling it once.
+  ///
+  /// [threads] caps the threads (`0` for one per core). Results come back
+  /// in input order, a failed run as a result with its error set.
+  Future<List<MontyResult>> runBatch(
+    String code,
+    List<Map<String, Object?>> inputs, {
+    MontyLimits? limits,
+    String? scriptName,
+    int threads = 0,
+  });
+
   /// Starts iterative execution of [code] in the background Isolate.
   ///
-  /// If [scriptName] is non-null, it overrides the default filename.
+  /// [inputs] are as for [run]. If [scriptName] is non-null, it overrides
+  /// the default filename.
   Future<MontyProgress> start(
     String code, {
+    Map<String, Object?>? inputs,
     List<String>? externalFunctions,
     MontyLimits? limits,
     String? scriptName,
@@ -57,6 +82,32 @@ abstract class NativeIsolateBindings {
   /// Restores interpreter state from snapshot [data].
   Future<void> restore(Uint8List data);
 
+  /// Writes a snapshot of the current interpreter state to the snapshot
+  /// container file at [path].
+  Future<void> snapshotToFile(String path);
+
+  /// Restores interpreter state from the snapshot container file at
+  /// [path].
+  Future<void> restoreFile(String path);
+
+  /// Feeds [code] to the REPL session in the background Isolate.
+  ///
+  /// Variables defined by earlier feeds stay live in the interpreter.
+  /// [limits] apply from this feed on, as for `MontyReplCapable.feed`;
+  /// [scriptName] takes effect when the session is created.
+  Future<MontyResult> feed(
+    String code, {
+    MontyLimits? limits,
+    String? scriptName,
+  });
+
+  /// Discards the REPL session, if any.
+  Future<void> resetSession();
+
+  /// Interrupts the execution running or paused in the background
+  /// Isolate, without waiting for the Isolate to become free.
+  Future<void> cancel();
+
   /// Disposes the background Isolate and frees resources.
   Future<void> dispose();
 }
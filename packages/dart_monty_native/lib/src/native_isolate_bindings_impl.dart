@@ -12,15 +12,47 @@ import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart
 
 /// Initial configuration sent from main -> Isolate at spawn time.
 final class _InitMessage {
-  const _InitMessage(this.mainSendPort, {this.libraryPath});
+  const _InitMessage(
+    this.mainSendPort, {
+    this.libraryPath,
+    this.programCacheAddress,
+  });
   final SendPort mainSendPort;
   final String? libraryPath;
+  final int? programCacheAddress;
 }
 
 /// Message sent from the Isolate once it's ready.
 final class _ReadyMessage {
-  const _ReadyMessage(this.sendPort);
+  const _ReadyMessage(this.sendPort, {required this.interruptAddress});
   final SendPort sendPort;
+
+  /// Interrupt watched by the Isolate's executions; set it to cancel them.
+  final int interruptAddress;
+}
+
+/// Turns forwarding of print output on or off (main -> Isolate).
+final class _StreamOutputMessage {
+  const _StreamOutputMessage({required this.enabled});
+  final bool enabled;
+}
+
+/// Print output produced in the Isolate (Isolate -> main).
+final class _OutputMessage {
+  const _OutputMessage(this.text);
+  final String text;
+}
+
+/// Turns forwarding of trace events on or off (main -> Isolate).
+final class _StreamTraceMessage {
+  const _StreamTraceMessage({required this.enabled});
+  final bool enabled;
+}
+
+/// A trace event recorded in the Isolate (Isolate -> main).
+final class _TraceMessage {
+  const _TraceMessage(this.event);
+  final MontyTraceEvent event;
 }
 
 /// Base request type sent from main -> Isolate.
@@ -30,21 +62,46 @@ sealed class _Request {
 }
 
 final class _RunRequest extends _Request {
-  const _RunRequest(super.id, this.code, {this.limits, this.scriptName});
+  const _RunRequest(
+    super.id,
+    this.code, {
+    this.inputs,
+    this.limits,
+    this.scriptName,
+  });
   final String code;
+  final Map<String, Object?>? inputs;
   final MontyLimits? limits;
   final String? scriptName;
 }
 
+final class _RunBatchRequest extends _Request {
+  const _RunBatchRequest(
+    super.id,
+    this.code,
+    this.inputs, {
+    this.limits,
+    this.scriptName,
+    this.threads = 0,
+  });
+  final String code;
+  final List<Map<String, Object?>> inputs;
+  final MontyLimits? limits;
+  final String? scriptName;
+  final int threads;
+}
+
 final class _StartRequest extends _Request {
   const _StartRequest(
     super.id,
     this.code, {
+    this.inputs,
     this.externalFunctions,
     this.limits,
     this.scriptName,
   });
   final String code;
+  final Map<String, Object?>? inputs;
   final List<String>? externalFunctions;
   final MontyLimits? limits;
   final String? scriptName;
@@ -75,8 +132,30 @@ final class _SnapshotRequest extends _Request {
 }
 
 final class _RestoreRequest extends _Request {
-  const _RestoreRequest(super.id, this.data);
-  final Uint8List data;
+  _RestoreRequest(super.id, Uint8List data)
+      : data = TransferableTypedData.fromList([data]);
+  final TransferableTypedData data;
+}
+
+final class _SnapshotToFileRequest extends _Request {
+  const _SnapshotToFileRequest(super.id, this.path);
+  final String path;
+}
+
+final class _RestoreFileRequest extends _Request {
+  const _RestoreFileRequest(super.id, this.path);
+  final String path;
+}
+
+final class _FeedRequest extends _Request {
+  const _FeedRequest(super.id, this.code, {this.limits, this.scriptName});
+  final String code;
+  final MontyLimits? limits;
+  final String? scriptName;
+}
+
+final class _ResetSessionRequest extends _Request {
+  const _ResetSessionRequest(super.id);
 }
 
 final class _DisposeRequest extends _Request {
@@ -89,25 +168,89 @@ sealed class _Response {
   final int id;
 }
 
+/// A [MontyResult] crossing the boundary with its value still in the
+/// binary encoding, moved as one [TransferableTypedData] rather than
+/// copied object by object. The value is decoded by [toResult] on the
+/// receiving side.
+final class _ResultMessage {
+  _ResultMessage(MontyResult result)
+      : usage = result.usage,
+        error = result.error,
+        printOutput = result.printOutput,
+        value = result.value is MontyEncodedValue ? null : result.value,
+        encodedValue = switch (result.value) {
+          MontyEncodedValue(:final bytes) =>
+            TransferableTypedData.fromList([bytes]),
+          _ => null,
+        };
+
+  final MontyResourceUsage usage;
+  final MontyException? error;
+  final String? printOutput;
+
+  /// The value when it arrived decoded, e.g. from the JSON transport.
+  final Object? value;
+  final TransferableTypedData? encodedValue;
+
+  /// Rebuilds the result; call at most once.
+  MontyResult toResult() {
+    final encoded = encodedValue;
+
+    return MontyResult(
+      value: encoded != null
+          ? MontyValueCodec.decode(encoded.materialize().asUint8List())
+          : value,
+      error: error,
+      usage: usage,
+      printOutput: printOutput,
+    );
+  }
+}
+
 final class _RunResponse extends _Response {
-  const _RunResponse(super.id, this.result);
-  final MontyResult result;
+  _RunResponse(super.id, MontyResult result) : result = _ResultMessage(result);
+  final _ResultMessage result;
+}
+
+final class _RunBatchResponse extends _Response {
+  _RunBatchResponse(super.id, List<MontyResult> results)
+      : results = [for (final result in results) _ResultMessage(result)];
+  final List<_ResultMessage> results;
 }
 
 final class _ProgressResponse extends _Response {
-  const _ProgressResponse(super.id, this.progress);
-  final MontyProgress progress;
+  _ProgressResponse(super.id, MontyProgress progress)
+      : _progress = progress is MontyComplete ? null : progress,
+        _complete =
+            progress is MontyComplete ? _ResultMessage(progress.result) : null;
+  final MontyProgress? _progress;
+  final _ResultMessage? _complete;
+
+  /// Rebuilds the progress; call at most once.
+  MontyProgress toProgress() => switch (_complete) {
+        final complete? => MontyComplete(result: complete.toResult()),
+        null => _progress!,
+      };
 }
 
 final class _SnapshotResponse extends _Response {
-  const _SnapshotResponse(super.id, this.data);
-  final Uint8List data;
+  _SnapshotResponse(super.id, Uint8List data)
+      : data = TransferableTypedData.fromList([data]);
+  final TransferableTypedData data;
 }
 
 final class _RestoreResponse extends _Response {
   const _RestoreResponse(super.id);
 }
 
+final class _SnapshotToFileResponse extends _Response {
+  const _SnapshotToFileResponse(super.id);
+}
+
+final class _ResetSessionResponse extends _Response {
+  const _ResetSessionResponse(super.id);
+}
+
 final class _DisposeResponse extends _Response {
   const _DisposeResponse(super.id);
 }
@@ -133,13 +276,73 @@ void _isolateEntryPoint(_InitMessage init) {
 
 Future<void> _isolateMain(_InitMessage init) async {
   final receivePort = ReceivePort();
-  init.mainSendPort.send(_ReadyMessage(receivePort.sendPort));
+  final bindings = NativeBindingsFfi(libraryPath: init.libraryPath);
+  // Take this Isolate's reference before reporting ready, so the sender may
+  // release its own once init() completes.
+  final cacheAddress = init.programCacheAddress;
+  final programCache = cacheAddress != null
+      ? MontyProgramCache.attach(bindings: bindings, address: cacheAddress)
+      : null;
+  // The main isolate sets this while the VM is busy here, so cancelling
+  // does not wait behind the running request.
+  final interrupt = bindings.interruptNew();
+  init.mainSendPort.send(
+    _ReadyMessage(receivePort.sendPort, interruptAddress: interrupt),
+  );
 
+  // Executions on a worker run one after another, so one handle can be
+  // reset and reused for each instead of allocated afresh.
+  //
+  // Result values stay encoded here and are decoded by the main isolate,
+  // so a large result crosses as one buffer instead of a deep copy.
   var monty = MontyFfi(
-    bindings: NativeBindingsFfi(libraryPath: init.libraryPath),
+    bindings: bindings,
+    programCache: programCache,
+    reuseHandles: true,
+    interrupt: interrupt,
+    encodedValues: true,
   );
+  StreamSubscription<String>? output;
+  void forwardOutput() {
+    output = monty.output.listen(
+      (text) => init.mainSendPort.send(_OutputMessage(text)),
+    );
+  }
+
+  StreamSubscription<MontyTraceEvent>? trace;
+  void forwardTrace() {
+    trace = monty.trace.listen(
+      (event) => init.mainSendPort.send(_TraceMessage(event)),
+    );
+  }
+
+  // A restore replaces `monty`; move any forwarding over to the new one.
+  Future<void> reforward() async {
+    if (output != null) {
+      await output?.cancel();
+      forwardOutput();
+    }
+    if (trace != null) {
+      await trace?.cancel();
+      forwardTrace();
+    }
+  }
 
   await for (final message in receivePort) {
+    if (message is _StreamOutputMessage) {
+      await output?.cancel();
+      output = null;
+      if (message.enabled) forwardOutput();
+
+      continue;
+    }
+    if (message is _StreamTraceMessage) {
+      await trace?.cancel();
+      trace = null;
+      if (message.enabled) forwardTrace();
+
+      continue;
+    }
     if (message is! _Request) continue;
 
     try {
@@ -147,25 +350,46 @@ Future<void> _isolateMain(_InitMessage init) async {
         case _RunRequest(
             :final id,
             :final code,
+            :final inputs,
             :final limits,
             :final scriptName,
           ):
           final result = await monty.run(
             code,
+            inputs: inputs,
             limits: limits,
             scriptName: scriptName,
           );
           init.mainSendPort.send(_RunResponse(id, result));
 
+        case _RunBatchRequest(
+            :final id,
+            :final code,
+            :final inputs,
+            :final limits,
+            :final scriptName,
+            :final threads,
+          ):
+          final results = await monty.runBatch(
+            code,
+            inputs,
+            limits: limits,
+            scriptName: scriptName,
+            threads: threads,
+          );
+          init.mainSendPort.send(_RunBatchResponse(id, results));
+
         case _StartRequest(
             :final id,
             :final code,
+            :final inputs,
             :final externalFunctions,
             :final limits,
             :final scriptName,
           ):
           final progress = await monty.start(
             code,
+            inputs: inputs,
             externalFunctions: externalFunctions,
             limits: limits,
             scriptName: scriptName,
@@ -193,12 +417,51 @@ Future<void> _isolateMain(_InitMessage init) async {
           init.mainSendPort.send(_SnapshotResponse(id, data));
 
         case _RestoreRequest(:final id, :final data):
-          final restored = await monty.restore(data);
+          final restored =
+              await monty.restore(data.materialize().asUint8List());
+          final previous = monty;
           monty = restored as MontyFfi;
+          await reforward();
+          // The old instance's handles, a spare one included, would leak.
+          await previous.dispose();
           init.mainSendPort.send(_RestoreResponse(id));
 
+        case _SnapshotToFileRequest(:final id, :final path):
+          await monty.snapshotToFile(path);
+          init.mainSendPort.send(_SnapshotToFileResponse(id));
+
+        case _RestoreFileRequest(:final id, :final path):
+          final restored = await monty.restoreFile(path);
+          final previous = monty;
+          monty = restored as MontyFfi;
+          await reforward();
+          // The old instance's handles, a spare one included, would leak.
+          await previous.dispose();
+          init.mainSendPort.send(_RestoreResponse(id));
+
+        case _FeedRequest(
+            :final id,
+            :final code,
+            :final limits,
+            :final scriptName,
+          ):
+          final result = await monty.feed(
+            code,
+            limits: limits,
+            scriptName: scriptName,
+          );
+          init.mainSendPort.send(_RunResponse(id, result));
+
+        case _ResetSessionRequest(:final id):
+          await monty.resetSession();
+          init.mainSendPort.send(_ResetSessionResponse(id));
+
         case _DisposeRequest(:final id):
+          await output?.cancel();
+          await trace?.cancel();
           await monty.dispose();
+          programCache?.dispose();
+          bindings.interruptFree(interrupt);
           init.mainSendPort.send(_DisposeResponse(id));
           receivePort.close();
 
@@ -230,16 +493,48 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
   ///
   /// If [libraryPath] is provided, it is forwarded to [NativeBindingsFfi]
   /// inside the Isolate to override the default library lookup.
-  NativeIsolateBindingsImpl({this.libraryPath});
+  ///
+  /// If [programCache] is provided, the Isolate creates its handles
+  /// through the same native cache, taking its own reference during
+  /// [init]. [programCache] must not be disposed before [init] completes.
+  NativeIsolateBindingsImpl({this.libraryPath, this.programCache});
 
   /// Optional path to the native shared library.
   final String? libraryPath;
 
+  /// Optional program cache shared with the Isolate.
+  final MontyProgramCache? programCache;
+
   Isolate? _isolate;
   SendPort? _sendPort;
+  int? _interruptAddress;
+  NativeBindingsFfi? _interruptBindings;
   ReceivePort? _receivePort;
   int _nextId = 0;
   final Map<int, Completer<_Response>> _pending = {};
+  late final StreamController<String> _output = StreamController.broadcast(
+    onListen: () => _sendPort?.send(const _StreamOutputMessage(enabled: true)),
+    onCancel: () => _sendPort?.send(const _StreamOutputMessage(enabled: false)),
+  );
+  late final StreamController<MontyTraceEvent> _trace =
+      StreamController.broadcast(
+    onListen: () => _sendPort?.send(const _StreamTraceMessage(enabled: true)),
+    onCancel: () => _sendPort?.send(const _StreamTraceMessage(enabled: false)),
+  );
+
+  /// Print output from the background Isolate.
+  ///
+  /// Output is only forwarded across the Isolate boundary while this stream
+  /// has a listener.
+  @override
+  Stream<String> get output => _output.stream;
+
+  /// Trace events from the background Isolate, forwarded only while this
+  /// stream has a listener. Each request's events are followed by an
+  /// [MontyTraceKind.isolate] event for its whole round trip, measured
+  /// here, so the hop costs are the round trip less the spans inside it.
+  @override
+  Stream<MontyTraceEvent> get trace => _trace.stream;
 
   @override
   Future<bool> init() async {
@@ -249,10 +544,21 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
 
     receivePort.listen((message) {
       if (message is _ReadyMessage) {
+        _interruptAddress = message.interruptAddress;
         completer.complete(message.sendPort);
 
         return;
       }
+      if (message is _OutputMessage) {
+        _output.add(message.text);
+
+        return;
+      }
+      if (message is _TraceMessage) {
+        _trace.add(message.event);
+
+        return;
+      }
       if (message is _Response) {
         final pending = _pending.remove(message.id);
         pending?.complete(message);
@@ -270,7 +576,11 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
 
     final isolate = await Isolate.spawn(
       _isolateEntryPoint,
-      _InitMessage(receivePort.sendPort, libraryPath: libraryPath),
+      _InitMessage(
+        receivePort.sendPort,
+        libraryPath: libraryPath,
+        programCacheAddress: programCache?.address,
+      ),
     );
     _isolate = isolate;
 
@@ -278,7 +588,14 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
       ..addOnExitListener(receivePort.sendPort)
       ..addErrorListener(receivePort.sendPort);
 
-    _sendPort = await completer.future;
+    final sendPort = await completer.future;
+    _sendPort = sendPort;
+    if (_output.hasListener) {
+      sendPort.send(const _StreamOutputMessage(enabled: true));
+    }
+    if (_trace.hasListener) {
+      sendPort.send(const _StreamTraceMessage(enabled: true));
+    }
 
     return true;
   }
@@ -286,19 +603,49 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
   @override
   Future<MontyResult> run(
     String code, {
+    Map<String, Object?>? inputs,
     MontyLimits? limits,
     String? scriptName,
   }) async {
     final response = await _send<_RunResponse>(
-      _RunRequest(_nextId++, code, limits: limits, scriptName: scriptName),
+      _RunRequest(
+        _nextId++,
+        code,
+        inputs: inputs,
+        limits: limits,
+        scriptName: scriptName,
+      ),
     );
 
-    return response.result;
+    return response.result.toResult();
+  }
+
+  @override
+  Future<List<MontyResult>> runBatch(
+    String code,
+    List<Map<String, Object?>> inputs, {
+    MontyLimits? limits,
+    String? scriptName,
+    int threads = 0,
+  }) async {
+    final response = await _send<_RunBatchResponse>(
+      _RunBatchRequest(
+        _nextId++,
+        code,
+        inputs,
+        limits: limits,
+        scriptName: scriptName,
+        threads: threads,
+      ),
+    );
+
+    return [for (final result in response.results) result.toResult()];
   }
 
   @override
   Future<MontyProgress> start(
     String code, {
+    Map<String, Object?>? inputs,
     List<String>? externalFunctions,
     MontyLimits? limits,
     String? scriptName,
@@ -307,13 +654,14 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
       _StartRequest(
         _nextId++,
         code,
+        inputs: inputs,
         externalFunctions: externalFunctions,
         limits: limits,
         scriptName: scriptName,
       ),
     );
 
-    return response.progress;
+    return response.toProgress();
   }
 
   @override
@@ -322,7 +670,7 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
       _ResumeRequest(_nextId++, returnValue),
     );
 
-    return response.progress;
+    return response.toProgress();
   }
 
   @override
@@ -331,7 +679,7 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
       _ResumeWithErrorRequest(_nextId++, errorMessage),
     );
 
-    return response.progress;
+    return response.toProgress();
   }
 
   @override
@@ -340,7 +688,7 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
       _ResumeAsFutureRequest(_nextId++),
     );
 
-    return response.progress;
+    return response.toProgress();
   }
 
   @override
@@ -352,7 +700,7 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
       _ResolveFuturesRequest(_nextId++, results, errors: errors),
     );
 
-    return response.progress;
+    return response.toProgress();
   }
 
   @override
@@ -361,7 +709,7 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
       _SnapshotRequest(_nextId++),
     );
 
-    return response.data;
+    return response.data.materialize().asUint8List();
   }
 
   @override
@@ -369,9 +717,52 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
     await _send<_RestoreResponse>(_RestoreRequest(_nextId++, data));
   }
 
+  @override
+  Future<void> snapshotToFile(String path) async {
+    await _send<_SnapshotToFileResponse>(
+      _SnapshotToFileRequest(_nextId++, path),
+    );
+  }
+
+  @override
+  Future<void> restoreFile(String path) async {
+    await _send<_RestoreResponse>(_RestoreFileRequest(_nextId++, path));
+  }
+
+  @override
+  Future<MontyResult> feed(
+    String code, {
+    MontyLimits? limits,
+    String? scriptName,
+  }) async {
+    final response = await _send<_RunResponse>(
+      _FeedRequest(_nextId++, code, limits: limits, scriptName: scriptName),
+    );
+
+    return response.result.toResult();
+  }
+
+  @override
+  Future<void> resetSession() async {
+    await _send<_ResetSessionResponse>(_ResetSessionRequest(_nextId++));
+  }
+
+  /// Sets the Isolate's interrupt directly from this isolate, through a
+  /// [NativeBindingsFfi] opened on first use, so a busy Isolate stops at
+  /// its next time check rather than after the running request.
+  @override
+  Future<void> cancel() async {
+    final address = _interruptAddress;
+    if (address == null) return;
+    (_interruptBindings ??= NativeBindingsFfi(libraryPath: libraryPath))
+        .interrupt(address);
+  }
+
   @override
   Future<void> dispose() async {
     if (_sendPort == null) return;
+    // The Isolate frees the interrupt while disposing.
+    _interruptAddress = null;
 
     try {
       await _send<_DisposeResponse>(_DisposeRequest(_nextId++));
@@ -384,6 +775,8 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
       _isolate = null;
       _sendPort = null;
       _receivePort = null;
+      await _output.close();
+      await _trace.close();
     }
   }
 
@@ -397,9 +790,19 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
     }
     final completer = Completer<_Response>();
     _pending[request.id] = completer;
+    final watch = _trace.hasListener ? (Stopwatch()..start()) : null;
     _sendPort?.send(request);
 
     return completer.future.then((response) {
+      if (watch != null && !_trace.isClosed) {
+        _trace.add(
+          MontyTraceEvent(
+            kind: MontyTraceKind.isolate,
+            op: _opName(request),
+            duration: watch.elapsed,
+          ),
+        );
+      }
       if (response is _ErrorResponse) {
         throw response.exception;
       }
@@ -411,6 +814,23 @@ class NativeIsolateBindingsImpl extends NativeIsolateBindings {
     });
   }
 
+  static String _opName(_Request request) => switch (request) {
+        _RunRequest() => 'run',
+        _RunBatchRequest() => 'run_batch',
+        _StartRequest() => 'start',
+        _ResumeRequest() => 'resume',
+        _ResumeWithErrorRequest() => 'resume_with_error',
+        _ResumeAsFutureRequest() => 'resume_as_future',
+        _ResolveFuturesRequest() => 'resolve_futures',
+        _SnapshotRequest() => 'snapshot',
+        _RestoreRequest() => 'restore',
+        _SnapshotToFileRequest() => 'snapshot_to_file',
+        _RestoreFileRequest() => 'restore_file',
+        _FeedRequest() => 'feed',
+        _ResetSessionRequest() => 'reset_session',
+        _DisposeRequest() => 'dispose',
+      };
+
   void _failAllPending(String message) {
     final pending = Map<int, Completer<_Response>>.of(_pending);
     _pending.clear();
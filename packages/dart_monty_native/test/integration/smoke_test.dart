@@ -111,6 +111,54 @@ void main() {
     await monty.dispose();
   });
 
+  test('large result: decoded after crossing the isolate', () async {
+    final monty = createMonty();
+    final result = await monty.run(
+      '{"rows": [{"id": i, "name": str(i)} for i in range(2000)]}',
+    );
+
+    final rows = (result.value! as Map<String, Object?>)['rows']! as List;
+    expect(rows, hasLength(2000));
+    expect(rows.last, {'id': 1999, 'name': '1999'});
+    await monty.dispose();
+  });
+
+  test('snapshot bytes survive a restore round-trip', () async {
+    final monty = createMonty();
+    await monty.start('x = fetch()\nx + 1', externalFunctions: ['fetch']);
+    final data = await monty.snapshot();
+    await monty.resume(0);
+
+    final restored = await monty.restore(data);
+    final done = await restored.resume(41) as MontyComplete;
+
+    expect(done.result.value, 42);
+    await restored.dispose();
+  });
+
+  test('runBatch: runs in the Isolate and stops on cancel', () async {
+    final monty = createMonty();
+    final results = await monty.runBatch('x * 2', [
+      for (var x = 0; x < 8; x++) {'x': x},
+    ]);
+    expect([for (final r in results) r.value], [0, 2, 4, 6, 8, 10, 12, 14]);
+
+    final looping = monty.runBatch(
+      'while True:\n    x += 1',
+      [
+        for (var x = 0; x < 4; x++) {'x': x},
+      ],
+      threads: 2,
+    );
+    await Future<void>.delayed(const Duration(milliseconds: 50));
+    await monty.cancel();
+    final stopped = await looping;
+    expect(stopped, hasLength(4));
+    expect(stopped.every((r) => r.isError), isTrue);
+
+    await monty.dispose();
+  });
+
   test('multiple instances: no state bleed', () async {
     final a = createMonty();
     final b = createMonty();
@@ -1,3 +1,4 @@
+import 'dart:async';
 import 'dart:typed_data';
 
 import 'package:dart_monty_native/src/native_isolate_bindings.dart';
@@ -22,6 +23,9 @@ class MockNativeIsolateBindings extends NativeIsolateBindings {
     usage: _zeroUsage,
   );
 
+  /// Results returned by [runBatch].
+  List<MontyResult> nextRunBatchResults = const [];
+
   /// Result returned by [start].
   MontyProgress nextStartResult = const MontyComplete(
     result: MontyResult(usage: _zeroUsage),
@@ -42,6 +46,9 @@ class MockNativeIsolateBindings extends NativeIsolateBindings {
   /// If non-null, [restore] throws this as a [MontyException].
   String? nextRestoreError;
 
+  /// If non-null, [restoreFile] throws this as a [MontyException].
+  String? nextRestoreFileError;
+
   /// If non-null, [dispose] throws this as a [MontyException].
   String? nextDisposeError;
 
@@ -51,6 +58,17 @@ class MockNativeIsolateBindings extends NativeIsolateBindings {
   /// Queue of results returned by [resolveFutures]. Dequeues on each call.
   final List<MontyProgress> resolveFuturesResults = [];
 
+  /// Queue of results returned by [feed]. Dequeues on each call.
+  final List<MontyResult> feedResults = [];
+
+  /// Controller behind [output]; add to it to simulate print output.
+  final StreamController<String> outputController =
+      StreamController.broadcast();
+
+  /// Controller behind [trace]; add to it to simulate trace events.
+  final StreamController<MontyTraceEvent> traceController =
+      StreamController.broadcast();
+
   // ---------------------------------------------------------------------------
   // Call tracking
   // ---------------------------------------------------------------------------
@@ -58,15 +76,30 @@ class MockNativeIsolateBindings extends NativeIsolateBindings {
   /// Number of times [init] was called.
   int initCalls = 0;
 
-  /// Records of `(code, limits, scriptName)` passed to [run].
-  final List<({String code, MontyLimits? limits, String? scriptName})>
-      runCalls = [];
+  /// Records of `(code, inputs, limits, scriptName)` passed to [run].
+  final List<
+      ({
+        String code,
+        Map<String, Object?>? inputs,
+        MontyLimits? limits,
+        String? scriptName,
+      })> runCalls = [];
 
-  /// Records of `(code, externalFunctions, limits, scriptName)` passed to
-  /// [start].
+  /// Records of `(code, inputs, limits, threads)` passed to [runBatch].
   final List<
       ({
         String code,
+        List<Map<String, Object?>> inputs,
+        MontyLimits? limits,
+        int threads,
+      })> runBatchCalls = [];
+
+  /// Records of `(code, inputs, externalFunctions, limits, scriptName)`
+  /// passed to [start].
+  final List<
+      ({
+        String code,
+        Map<String, Object?>? inputs,
         List<String>? externalFunctions,
         MontyLimits? limits,
         String? scriptName,
@@ -84,9 +117,18 @@ class MockNativeIsolateBindings extends NativeIsolateBindings {
   /// Records of snapshot data passed to [restore].
   final List<Uint8List> restoreCalls = [];
 
+  /// Paths passed to [snapshotToFile].
+  final List<String> snapshotToFileCalls = [];
+
+  /// Paths passed to [restoreFile].
+  final List<String> restoreFileCalls = [];
+
   /// Number of times [dispose] was called.
   int disposeCalls = 0;
 
+  /// Number of times [cancel] was called.
+  int cancelCalls = 0;
+
   /// Number of times [resumeAsFuture] was called.
   int resumeAsFutureCalls = 0;
 
@@ -96,6 +138,13 @@ class MockNativeIsolateBindings extends NativeIsolateBindings {
   /// Records of errors passed to [resolveFutures], in call order.
   final List<Map<int, String>?> resolveFuturesErrorsCalls = [];
 
+  /// Records of `(code, limits, scriptName)` passed to [feed].
+  final List<({String code, MontyLimits? limits, String? scriptName})>
+      feedCalls = [];
+
+  /// Number of times [resetSession] was called.
+  int resetSessionCalls = 0;
+
   // ---------------------------------------------------------------------------
   // Private
   // ---------------------------------------------------------------------------
@@ -120,17 +169,36 @@ class MockNativeIsolateBindings extends NativeIsolateBindings {
   @override
   Future<MontyResult> run(
     String code, {
+    Map<String, Object?>? inputs,
     MontyLimits? limits,
     String? scriptName,
   }) async {
-    runCalls.add((code: code, limits: limits, scriptName: scriptName));
+    runCalls.add(
+      (code: code, inputs: inputs, limits: limits, scriptName: scriptName),
+    );
 
     return nextRunResult;
   }
 
+  @override
+  Future<List<MontyResult>> runBatch(
+    String code,
+    List<Map<String, Object?>> inputs, {
+    MontyLimits? limits,
+    String? scriptName,
+    int threads = 0,
+  }) async {
+    runBatchCalls.add(
+      (code: code, inputs: inputs, limits: limits, threads: threads),
+    );
+
+    return nextRunBatchResults;
+  }
+
   @override
   Future<MontyProgress> start(
     String code, {
+    Map<String, Object?>? inputs,
     List<String>? externalFunctions,
     MontyLimits? limits,
     String? scriptName,
@@ -138,6 +206,7 @@ class MockNativeIsolateBindings extends NativeIsolateBindings {
     startCalls.add(
       (
         code: code,
+        inputs: inputs,
         externalFunctions: externalFunctions,
         limits: limits,
         scriptName: scriptName,
@@ -215,6 +284,48 @@ class MockNativeIsolateBindings extends NativeIsolateBindings {
     }
   }
 
+  @override
+  Future<void> snapshotToFile(String path) async {
+    snapshotToFileCalls.add(path);
+  }
+
+  @override
+  Future<void> restoreFile(String path) async {
+    restoreFileCalls.add(path);
+    final error = nextRestoreFileError;
+    if (error != null) {
+      throw MontyException(message: error);
+    }
+  }
+
+  @override
+  Future<MontyResult> feed(
+    String code, {
+    MontyLimits? limits,
+    String? scriptName,
+  }) async {
+    feedCalls.add((code: code, limits: limits, scriptName: scriptName));
+    if (feedResults.isNotEmpty) return feedResults.removeAt(0);
+
+    return const MontyResult(usage: _zeroUsage);
+  }
+
+  @override
+  Future<void> resetSession() async {
+    resetSessionCalls++;
+  }
+
+  @override
+  Stream<String> get output => outputController.stream;
+
+  @override
+  Stream<MontyTraceEvent> get trace => traceController.stream;
+
+  @override
+  Future<void> cancel() async {
+    cancelCalls++;
+  }
+
   @override
   Future<void> dispose() async {
     disposeCalls++;
@@ -90,11 +90,9 @@ void main() {
       expect(mock.runCalls.first.limits, isNull);
     });
 
-    test('throws UnsupportedError for non-empty inputs', () {
-      expect(
-        () => monty.run('x', inputs: {'a': 1}),
-        throwsA(isA<UnsupportedError>()),
-      );
+    test('forwards inputs to bindings', () async {
+      await monty.run('a', inputs: {'a': 1});
+      expect(mock.runCalls.first.inputs, {'a': 1});
     });
 
     test('allows null inputs', () async {
@@ -138,6 +136,43 @@ void main() {
     });
   });
 
+  // ===========================================================================
+  // runBatch()
+  // ===========================================================================
+  group('runBatch()', () {
+    test('forwards the batch to the background Isolate', () async {
+      mock.nextRunBatchResults = [
+        const MontyResult(value: 2, usage: _zeroUsage),
+        const MontyResult(value: 4, usage: _zeroUsage),
+      ];
+
+      final results = await monty.runBatch(
+        'x * 2',
+        [
+          {'x': 1},
+          {'x': 2},
+        ],
+        limits: const MontyLimits(timeoutMs: 50),
+        threads: 2,
+      );
+
+      expect([for (final result in results) result.value], [2, 4]);
+      expect(mock.initCalls, 1);
+      expect(mock.runCalls, isEmpty);
+      final call = mock.runBatchCalls.single;
+      expect(call.code, 'x * 2');
+      expect(call.inputs, hasLength(2));
+      expect(call.limits?.timeoutMs, 50);
+      expect(call.threads, 2);
+    });
+
+    test('throws after dispose', () async {
+      await monty.dispose();
+
+      expect(() => monty.runBatch('x', const []), throwsStateError);
+    });
+  });
+
   // ===========================================================================
   // start()
   // ===========================================================================
@@ -201,11 +236,9 @@ void main() {
       expect(mock.startCalls.first.externalFunctions, isNull);
     });
 
-    test('throws UnsupportedError for non-empty inputs', () {
-      expect(
-        () => monty.start('x', inputs: {'a': 1}),
-        throwsA(isA<UnsupportedError>()),
-      );
+    test('forwards inputs to bindings', () async {
+      await monty.start('x', inputs: {'x': 'v'});
+      expect(mock.startCalls.first.inputs, {'x': 'v'});
     });
 
     test('throws StateError when disposed', () async {
@@ -573,6 +606,150 @@ void main() {
     });
   });
 
+  // ===========================================================================
+  // snapshotToFile() / restoreFile()
+  // ===========================================================================
+  group('snapshotToFile() / restoreFile()', () {
+    test('snapshotToFile() sends only the path', () async {
+      mock.nextStartResult =
+          const MontyPending(functionName: 'f', arguments: []);
+      await monty.start('x', externalFunctions: ['f']);
+
+      await monty.snapshotToFile('/tmp/a.snap');
+
+      expect(mock.snapshotToFileCalls, ['/tmp/a.snap']);
+    });
+
+    test('snapshotToFile() throws StateError when idle', () {
+      expect(() => monty.snapshotToFile('/tmp/a.snap'), throwsStateError);
+    });
+
+    test('restoreFile() returns new MontyNative in active state', () async {
+      final restored = await monty.restoreFile('/tmp/a.snap') as MontyNative;
+
+      expect(mock.restoreFileCalls, ['/tmp/a.snap']);
+      expect(() => restored.run('x'), throwsStateError);
+    });
+
+    test('restoreFile() throws MontyException when restore fails', () {
+      mock.nextRestoreFileError = 'container checksum mismatch';
+
+      expect(
+        () => monty.restoreFile('/tmp/a.snap'),
+        throwsA(isA<MontyException>()),
+      );
+    });
+  });
+
+  // ===========================================================================
+  // feed() / resetSession()
+  // ===========================================================================
+  group('feed() / resetSession()', () {
+    test('initializes lazily and forwards to bindings', () async {
+      mock.feedResults.add(
+        MontyResult(value: 3, usage: _usage(memory: 0, time: 0, stack: 0)),
+      );
+      const limits = MontyLimits(memoryBytes: 1024);
+      final result = await monty.feed(
+        'x + 1',
+        limits: limits,
+        scriptName: 'repl.py',
+      );
+
+      expect(result.value, 3);
+      expect(mock.initCalls, 1);
+      expect(mock.feedCalls.single.code, 'x + 1');
+      expect(mock.feedCalls.single.limits, limits);
+      expect(mock.feedCalls.single.scriptName, 'repl.py');
+      expect(monty.state, MontyState.idle);
+    });
+
+    test('throws StateError while an execution is active', () async {
+      mock.nextStartResult = const MontyPending(
+        functionName: 'fetch',
+        arguments: [],
+      );
+      await monty.start('fetch()', externalFunctions: ['fetch']);
+
+      expect(() => monty.feed('1'), throwsStateError);
+    });
+
+    test('resetSession() is a no-op before initialization', () async {
+      await monty.resetSession();
+
+      expect(mock.resetSessionCalls, 0);
+    });
+
+    test('resetSession() forwards once initialized', () async {
+      await monty.feed('x = 1');
+      await monty.resetSession();
+
+      expect(mock.resetSessionCalls, 1);
+    });
+  });
+
+  // ===========================================================================
+  // output
+  // ===========================================================================
+  group('output', () {
+    test('forwards print output from the bindings', () async {
+      final chunks = <String>[];
+      monty.output.listen(chunks.add);
+
+      mock.outputController
+        ..add('a\n')
+        ..add('b\n');
+      await Future<void>.delayed(Duration.zero);
+
+      expect(chunks, ['a\n', 'b\n']);
+    });
+  });
+
+  // ===========================================================================
+  // trace
+  // ===========================================================================
+  group('trace', () {
+    test('forwards trace events from the bindings', () async {
+      const event = MontyTraceEvent(
+        kind: MontyTraceKind.isolate,
+        op: 'run',
+        duration: Duration(milliseconds: 1),
+      );
+      final events = monty.trace.first;
+      mock.traceController.add(event);
+
+      expect(await events, event);
+    });
+  });
+
+  // ===========================================================================
+  // cancel()
+  // ===========================================================================
+  group('cancel()', () {
+    test('forwards to the bindings while a run is in flight', () async {
+      await monty.initialize();
+      final run = monty.run('while True: pass');
+      await monty.cancel();
+      await run;
+
+      expect(mock.cancelCalls, 1);
+    });
+
+    test('does nothing before initialize', () async {
+      await monty.cancel();
+
+      expect(mock.cancelCalls, 0);
+    });
+
+    test('does nothing after dispose', () async {
+      await monty.initialize();
+      await monty.dispose();
+      await monty.cancel();
+
+      expect(mock.cancelCalls, 0);
+    });
+  });
+
   // ===========================================================================
   // dispose()
   // ===========================================================================
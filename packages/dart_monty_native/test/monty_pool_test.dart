@@ -0,0 +1,281 @@
+import 'dart:async';
+
+import 'package:dart_monty_native/src/monty_pool.dart';
+import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+import 'mock_native_isolate_bindings.dart';
+
+/// A mock whose [run] blocks until [gate] completes.
+class _GatedBindings extends MockNativeIsolateBindings {
+  Completer<void> gate = Completer<void>()..complete();
+
+  @override
+  Future<MontyResult> run(
+    String code, {
+    Map<String, Object?>? inputs,
+    MontyLimits? limits,
+    String? scriptName,
+  }) async {
+    await gate.future;
+
+    return super.run(
+      code,
+      inputs: inputs,
+      limits: limits,
+      scriptName: scriptName,
+    );
+  }
+
+  /// Gates [resume] like [gate] does [run].
+  Completer<void> resumeGate = Completer<void>()..complete();
+
+  @override
+  Future<MontyProgress> resume(Object? returnValue) async {
+    await resumeGate.future;
+
+    return super.resume(returnValue);
+  }
+}
+
+void main() {
+  late List<_GatedBindings> mocks;
+
+  MontyPool pool({int size = 2, int maxQueued = 8}) => MontyPool(
+        size: size,
+        maxQueued: maxQueued,
+        bindingsFactory: () {
+          final mock = _GatedBindings();
+          mocks.add(mock);
+
+          return mock;
+        },
+      );
+
+  setUp(() {
+    mocks = [];
+  });
+
+  // ===========================================================================
+  // Construction
+  // ===========================================================================
+  group('constructor', () {
+    test('defaults size to the processor count', () {
+      expect(MontyPool(bindingsFactory: _GatedBindings.new).size, isPositive);
+    });
+
+    test('rejects size < 1', () {
+      expect(() => MontyPool(size: 0), throwsArgumentError);
+    });
+
+    test('rejects negative maxQueued', () {
+      expect(() => MontyPool(maxQueued: -1), throwsArgumentError);
+    });
+  });
+
+  // ===========================================================================
+  // run()
+  // ===========================================================================
+  group('run()', () {
+    test('spawns workers lazily and reuses idle ones', () async {
+      final p = pool();
+      await p.run('1');
+      await p.run('2');
+
+      expect(p.workerCount, 1);
+      expect(p.idleCount, 1);
+      expect(mocks.single.runCalls.map((c) => c.code), ['1', '2']);
+      await p.dispose();
+    });
+
+    test('spreads concurrent runs across workers', () async {
+      final p = pool();
+      final results = await Future.wait([p.run('a'), p.run('b')]);
+
+      expect(results, hasLength(2));
+      expect(p.workerCount, 2);
+      expect(mocks.map((m) => m.runCalls.length), [1, 1]);
+      await p.dispose();
+    });
+
+    test('queues when all workers are busy', () async {
+      final p = pool(size: 1);
+      final first = p.run('a');
+      await pumpEventQueue();
+      mocks.single.gate = Completer<void>();
+      final second = p.run('b');
+      final third = p.run('c');
+      await pumpEventQueue();
+
+      expect(p.queueLength, 1);
+      mocks.single.gate.complete();
+      await Future.wait([first, second, third]);
+
+      expect(p.workerCount, 1);
+      expect(p.queueLength, 0);
+      expect(mocks.single.runCalls.map((c) => c.code), ['a', 'b', 'c']);
+      await p.dispose();
+    });
+
+    test('throws StateError when the queue is full', () async {
+      final p = pool(size: 1, maxQueued: 1);
+      await p.run('warm');
+      mocks.single.gate = Completer<void>();
+      final running = p.run('a');
+      final queued = p.run('b');
+      await pumpEventQueue();
+
+      await expectLater(p.run('c'), throwsStateError);
+      mocks.single.gate.complete();
+      await Future.wait([running, queued]);
+      await p.dispose();
+    });
+
+    test('keeps the worker after a MontyException', () async {
+      final p = pool(size: 1);
+      await p.run('warm');
+      mocks.single.gate = Completer<void>()
+        ..completeError(const MontyException(message: 'boom'));
+
+      await expectLater(p.run('x'), throwsA(isA<MontyException>()));
+      expect(p.workerCount, 1);
+      expect(p.idleCount, 1);
+      await p.dispose();
+    });
+
+    test('replaces the worker after an unexpected error', () async {
+      final p = pool(size: 1);
+      await p.run('warm');
+      mocks.single.gate = Completer<void>()..completeError(StateError('dead'));
+
+      await expectLater(p.run('x'), throwsStateError);
+      expect(p.workerCount, 0);
+      expect(mocks.single.disposeCalls, 1);
+
+      mocks.single.gate = Completer<void>()..complete();
+      await p.run('y');
+      expect(mocks, hasLength(2));
+      await p.dispose();
+    });
+  });
+
+  // ===========================================================================
+  // start()
+  // ===========================================================================
+  group('start()', () {
+    test('releases the worker when execution completes immediately', () async {
+      final p = pool(size: 1);
+      final execution = await p.start('x');
+
+      expect(execution.isDone, isTrue);
+      expect(execution.progress, isA<MontyComplete>());
+      expect(p.idleCount, 1);
+      await p.dispose();
+    });
+
+    test('pins the worker while paused', () async {
+      final p = pool(size: 1);
+      await p.run('warm');
+      final mock = mocks.single
+        ..nextStartResult = const MontyPending(
+          functionName: 'fetch',
+          arguments: [],
+        );
+
+      final execution = await p.start('fetch()', externalFunctions: ['fetch']);
+      expect(execution.isDone, isFalse);
+      expect(p.idleCount, 0);
+
+      final queuedRun = p.run('later');
+      await pumpEventQueue();
+      expect(p.queueLength, 1);
+
+      final done = await execution.resume('data');
+      expect(done, isA<MontyComplete>());
+      expect(mock.resumeCalls, ['data']);
+      await queuedRun;
+      expect(p.queueLength, 0);
+      expect(mocks, hasLength(1));
+      await p.dispose();
+    });
+
+    test('throws StateError when resuming a finished execution', () async {
+      final p = pool(size: 1);
+      final execution = await p.start('x');
+
+      expect(() => execution.resume(1), throwsStateError);
+      await p.dispose();
+    });
+
+    test('cancel() replaces the pinned worker', () async {
+      final p = pool(size: 1);
+      await p.run('warm');
+      mocks.single.nextStartResult = const MontyPending(
+        functionName: 'fetch',
+        arguments: [],
+      );
+      final execution = await p.start('fetch()', externalFunctions: ['fetch']);
+
+      await execution.cancel();
+      expect(execution.isDone, isTrue);
+      expect(mocks.single.disposeCalls, 1);
+      expect(p.workerCount, 0);
+      await p.dispose();
+    });
+
+    test('cancel() interrupts a running step but not a later one', () async {
+      final p = pool(size: 1);
+      await p.run('warm');
+      final mock = mocks.single
+        ..nextStartResult = const MontyPending(
+          functionName: 'fetch',
+          arguments: [],
+        )
+        ..resumeGate = Completer<void>();
+      final execution = await p.start('fetch()', externalFunctions: ['fetch']);
+      final resuming = execution.resume(1);
+      await pumpEventQueue();
+
+      await execution.cancel();
+      expect(mock.cancelCalls, 1);
+      expect(mock.disposeCalls, 0);
+      mock.resumeGate.complete();
+      await resuming;
+      expect(execution.isDone, isTrue);
+      expect(p.idleCount, 1);
+
+      // The worker belongs to the pool again; cancelling must not touch it.
+      await execution.cancel();
+      expect(mock.cancelCalls, 1);
+      await p.dispose();
+    });
+  });
+
+  // ===========================================================================
+  // dispose()
+  // ===========================================================================
+  group('dispose()', () {
+    test('disposes every worker and fails queued requests', () async {
+      final p = pool(size: 1);
+      await p.run('warm');
+      mocks.single.gate = Completer<void>();
+      final running = p.run('a');
+      final queued = p.run('b');
+      await pumpEventQueue();
+
+      final disposing = p.dispose();
+      await expectLater(queued, throwsStateError);
+      mocks.single.gate.complete();
+      await disposing;
+      await running;
+      expect(mocks.single.disposeCalls, 1);
+    });
+
+    test('rejects new requests', () async {
+      final p = pool();
+      await p.dispose();
+
+      expect(() => p.run('x'), throwsStateError);
+    });
+  });
+}
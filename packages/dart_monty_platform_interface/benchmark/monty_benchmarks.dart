@@ -0,0 +1,218 @@
+/// Benchmark suite for dart_monty backends.
+///
+/// Each backend package runs the same suite from its `benchmark/` runner,
+/// which imports this file by relative path so neither the suite nor
+/// `benchmark_harness` is part of the published library:
+/// ```dart
+/// Future<void> main() => runMontyBenchmarks('ffi', () => MontyFfi());
+/// ```
+/// A runner's package needs `benchmark_harness` in its `dev_dependencies`.
+library;
+
+import 'dart:async';
+
+import 'package:benchmark_harness/benchmark_harness.dart';
+import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
+
+/// Creates a fresh platform instance for one benchmark.
+typedef MontyFactory = FutureOr<MontyPlatform> Function();
+
+/// Payload sizes (list lengths) measured by the value-transfer benchmarks.
+const defaultPayloadSizes = [10, 1000, 100000];
+
+/// Base class for benchmarks run against any [MontyPlatform] backend.
+///
+/// Each benchmark gets its own platform from the factory in [setup] and
+/// disposes it in [teardown]. Scores are reported as
+/// `<backend>.<name>(RunTime): <us> us.` by the default emitter.
+abstract class MontyBenchmark extends AsyncBenchmarkBase {
+  /// Creates a [MontyBenchmark] named `<backend>.<name>`.
+  MontyBenchmark(String backend, String name, this._create)
+      : super('$backend.$name');
+
+  final MontyFactory _create;
+
+  /// The platform under test, valid between [setup] and [teardown].
+  late MontyPlatform monty;
+
+  /// Number of operations one [run] performs. The reported score is per
+  /// operation.
+  int get operations => 1;
+
+  @override
+  Future<void> setup() async {
+    monty = await _create();
+  }
+
+  @override
+  Future<void> teardown() => monty.dispose();
+
+  @override
+  Future<double> measure() async => await super.measure() / operations;
+}
+
+/// The standard benchmark suite for [backend].
+///
+/// Covers create/compile latency, run throughput, per-external-call
+/// overhead, snapshot/restore cost, and value-transfer cost for each of
+/// [payloadSizes].
+List<MontyBenchmark> montyBenchmarks(
+  String backend,
+  MontyFactory create, {
+  Iterable<int> payloadSizes = defaultPayloadSizes,
+}) =>
+    [
+      _CreateRunBenchmark(backend, create),
+      _CompileBenchmark(backend, create),
+      _RunThroughputBenchmark(backend, create),
+      _ExternalCallBenchmark(backend, create),
+      _SnapshotRestoreBenchmark(backend, create),
+      for (final size in payloadSizes)
+        _ValueTransferBenchmark(backend, create, size),
+    ];
+
+/// Runs [montyBenchmarks] for [backend] in order and prints each score.
+///
+/// Benchmarks the backend does not support (e.g. snapshots) are reported
+/// as skipped.
+Future<void> runMontyBenchmarks(
+  String backend,
+  MontyFactory create, {
+  Iterable<int> payloadSizes = defaultPayloadSizes,
+}) async {
+  final benchmarks =
+      montyBenchmarks(backend, create, payloadSizes: payloadSizes);
+  for (final benchmark in benchmarks) {
+    try {
+      await benchmark.report();
+    } on UnsupportedError catch (e) {
+      print('${benchmark.name}: skipped (${e.message})');
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Benchmarks
+// ---------------------------------------------------------------------------
+
+/// Handle creation plus compile and run of a trivial program.
+class _CreateRunBenchmark extends MontyBenchmark {
+  _CreateRunBenchmark(String backend, MontyFactory create)
+      : super(backend, 'create_run', create);
+
+  @override
+  Future<void> run() async {
+    await monty.run('1');
+  }
+}
+
+/// Compile latency of a 200-function program that does no work.
+class _CompileBenchmark extends MontyBenchmark {
+  _CompileBenchmark(String backend, MontyFactory create)
+      : super(backend, 'compile_200_defs', create);
+
+  static final _code = [
+    for (var i = 0; i < 200; i++) 'def f$i(x):\n    return x + $i\n',
+    '0',
+  ].join('\n');
+
+  @override
+  Future<void> run() async {
+    await monty.run(_code);
+  }
+}
+
+/// Interpreter throughput on a recursive, call-heavy program.
+class _RunThroughputBenchmark extends MontyBenchmark {
+  _RunThroughputBenchmark(String backend, MontyFactory create)
+      : super(backend, 'run_fib_18', create);
+
+  static const _code = 'def fib(n):\n'
+      '    return n if n < 2 else fib(n - 1) + fib(n - 2)\n'
+      '\n'
+      'fib(18)';
+
+  @override
+  Future<void> run() async {
+    await monty.run(_code);
+  }
+}
+
+/// Cost of one external call round trip: pause, read the pending call,
+/// resume with a value.
+class _ExternalCallBenchmark extends MontyBenchmark {
+  _ExternalCallBenchmark(String backend, MontyFactory create)
+      : super(backend, 'external_call', create);
+
+  static const _calls = 100;
+  static const _code = 'total = 0\n'
+      'for i in range($_calls):\n'
+      '    total += lookup(i)\n'
+      'total';
+
+  @override
+  int get operations => _calls;
+
+  @override
+  Future<void> run() async {
+    var progress = await monty.start(_code, externalFunctions: ['lookup']);
+    while (progress is MontyPending) {
+      progress = await monty.resume(progress.arguments.first);
+    }
+  }
+}
+
+/// Snapshot of a paused execution, restore into another instance, and
+/// resume of the restored execution to completion.
+class _SnapshotRestoreBenchmark extends MontyBenchmark {
+  _SnapshotRestoreBenchmark(String backend, MontyFactory create)
+      : super(backend, 'snapshot_restore', create);
+
+  late MontyPlatform _spare;
+
+  @override
+  Future<void> setup() async {
+    await super.setup();
+    if (monty is! MontySnapshotCapable) {
+      await monty.dispose();
+      throw UnsupportedError('${monty.runtimeType} cannot snapshot');
+    }
+    _spare = await _create();
+    await monty.start(
+      'x = [i for i in range(100)]\nfetch(len(x))',
+      externalFunctions: ['fetch'],
+    );
+  }
+
+  @override
+  Future<void> run() async {
+    final data = await (monty as MontySnapshotCapable).snapshot();
+    final restored = await (_spare as MontySnapshotCapable).restore(data);
+    await restored.resume(0);
+  }
+
+  @override
+  Future<void> teardown() async {
+    await super.teardown();
+    await _spare.dispose();
+  }
+}
+
+/// Round trip of a list of [size] ints: Dart → Python as a resume value,
+/// and back as the result.
+class _ValueTransferBenchmark extends MontyBenchmark {
+  _ValueTransferBenchmark(String backend, MontyFactory create, this.size)
+      : _payload = List<int>.generate(size, (i) => i),
+        super(backend, 'value_transfer_$size', create);
+
+  /// Number of list elements transferred each way.
+  final int size;
+
+  final List<int> _payload;
+
+  @override
+  Future<void> run() async {
+    await monty.start('echo()', externalFunctions: ['echo']);
+    await monty.resume(_payload);
+  }
+}
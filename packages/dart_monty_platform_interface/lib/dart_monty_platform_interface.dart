@@ -6,10 +6,14 @@ library;
 
 export 'src/base_monty_platform.dart';
 export 'src/core_bindings.dart';
+export 'src/monty_call_cache.dart';
 export 'src/monty_exception.dart';
 export 'src/monty_future_capable.dart';
+export 'src/monty_inspectable.dart';
+export 'src/monty_inspection.dart';
 export 'src/monty_limits.dart';
 export 'src/monty_platform.dart';
+export 'src/monty_repl_capable.dart';
 export 'src/monty_progress.dart';
 export 'src/monty_resource_usage.dart';
 export 'src/monty_result.dart';
@@ -17,3 +21,4 @@ export 'src/monty_session.dart';
 export 'src/monty_snapshot_capable.dart';
 export 'src/monty_stack_frame.dart';
 export 'src/monty_state_mixin.dart';
+export 'src/monty_trace_event.dart';
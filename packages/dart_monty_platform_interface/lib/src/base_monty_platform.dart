@@ -1,6 +1,7 @@
 import 'dart:convert';
 
 import 'package:dart_monty_platform_interface/src/core_bindings.dart';
+import 'package:dart_monty_platform_interface/src/monty_call_cache.dart';
 import 'package:dart_monty_platform_interface/src/monty_exception.dart';
 import 'package:dart_monty_platform_interface/src/monty_limits.dart';
 import 'package:dart_monty_platform_interface/src/monty_platform.dart';
@@ -36,14 +37,20 @@ abstract class BaseMontyPlatform extends MontyPlatform with MontyStateMixin {
   @protected
   MontyCoreBindings get coreBindings => _bindings;
 
-  static const _zeroUsage = MontyResourceUsage(
-    memoryBytesUsed: 0,
-    timeElapsedMs: 0,
-    stackDepthUsed: 0,
-  );
-
   bool _initialized = false;
 
+  /// Remembers results of the external calls it has a policy for, so
+  /// identical calls are answered without reaching the host; see
+  /// [MontyCallCache].
+  ///
+  /// Calls answered from the cache never surface as [MontyPending], and
+  /// futures shared by identical calls in flight are left out of
+  /// [MontyResolveFutures.pendingCallIds]. `null`, the default, passes
+  /// every call to the host.
+  MontyCallCache? callCache;
+
+  final _calls = _CallBook();
+
   @override
   Future<MontyResult> run(
     String code, {
@@ -53,14 +60,14 @@ abstract class BaseMontyPlatform extends MontyPlatform with MontyStateMixin {
   }) async {
     assertNotDisposed('run');
     assertIdle('run');
-    rejectInputs(inputs);
     await _ensureInitialized();
     final result = await _bindings.run(
       code,
+      inputsJson: _encodeInputs(inputs),
       limitsJson: _encodeLimits(limits),
       scriptName: scriptName,
     );
-    return _translateRunResult(result);
+    return translateRunResult(result);
   }
 
   @override
@@ -73,25 +80,25 @@ abstract class BaseMontyPlatform extends MontyPlatform with MontyStateMixin {
   }) async {
     assertNotDisposed('start');
     assertIdle('start');
-    rejectInputs(inputs);
     await _ensureInitialized();
     final progress = await _bindings.start(
       code,
+      inputsJson: _encodeInputs(inputs),
       extFnsJson: _encodeExternalFunctions(externalFunctions),
       limitsJson: _encodeLimits(limits),
       scriptName: scriptName,
     );
-    return translateProgress(progress);
+    return coalesceProgress(progress);
   }
 
   @override
   Future<MontyProgress> resume(Object? returnValue) async {
     assertNotDisposed('resume');
     assertActive('resume');
-    final progress = await _bindings.resume(
-      json.encode(returnValue),
-    );
-    return translateProgress(progress);
+    final key = _calls.takePending()?.key;
+    if (key != null) callCache?.store(key, returnValue);
+    final progress = await resumeCore(returnValue);
+    return coalesceProgress(progress);
   }
 
   @override
@@ -100,19 +107,145 @@ abstract class BaseMontyPlatform extends MontyPlatform with MontyStateMixin {
   ) async {
     assertNotDisposed('resumeWithError');
     assertActive('resumeWithError');
+    _calls.takePending();
     final progress = await _bindings.resumeWithError(
       errorMessage,
     );
-    return translateProgress(progress);
+    return coalesceProgress(progress);
   }
 
   @override
   Future<void> dispose() async {
     if (isDisposed) return;
+    _calls.clear();
     await _bindings.dispose();
     markDisposed();
   }
 
+  /// Resumes the paused call with [returnValue] in the bindings, without
+  /// consulting [callCache].
+  ///
+  /// Sends [returnValue] as JSON; subclasses with a cheaper transport
+  /// override this.
+  @protected
+  Future<CoreProgressResult> resumeCore(Object? returnValue) {
+    return _bindings.resume(json.encode(returnValue));
+  }
+
+  /// Resolves the awaited futures in the bindings, without consulting
+  /// [callCache].
+  ///
+  /// Sends [results] and [errors] as JSON; subclasses with a cheaper
+  /// transport override this.
+  @protected
+  Future<CoreProgressResult> resolveFuturesCore(
+    Map<int, Object?> results, {
+    Map<int, String>? errors,
+  }) {
+    return _bindings.resolveFutures(
+      json.encode(results.map((k, v) => MapEntry(k.toString(), v))),
+      json.encode(errors?.map((k, v) => MapEntry(k.toString(), v)) ?? {}),
+    );
+  }
+
+  /// Resumes the paused call as a future, for subclasses implementing
+  /// `MontyFutureCapable.resumeAsFuture`.
+  ///
+  /// A memoized call becomes in flight: identical calls made before its
+  /// future resolves share its result rather than reaching the host.
+  @protected
+  Future<MontyProgress> resumePendingAsFuture() async {
+    final pending = _calls.takePending();
+    final cache = callCache;
+    if (pending != null && cache != null) {
+      _calls.awaitHost(
+        pending,
+        share: cache.policies[pending.key.function]?.asFuture ?? false,
+      );
+    }
+    final progress = await _bindings.resumeAsFuture();
+    return coalesceProgress(progress);
+  }
+
+  /// Resolves the awaited futures with the host's [results] and [errors],
+  /// for subclasses implementing `MontyFutureCapable.resolveFutures`.
+  ///
+  /// Memoized results are remembered in [callCache], and futures left out
+  /// of the host's [MontyResolveFutures] are resolved alongside.
+  @protected
+  Future<MontyProgress> resolvePendingFutures(
+    Map<int, Object?> results, {
+    Map<int, String>? errors,
+  }) async {
+    _calls.settle(results, errors ?? const {}, callCache);
+    final (known, knownErrors) = _calls.takeKnown();
+    final allErrors = {...?errors, ...knownErrors};
+    final progress = await resolveFuturesCore(
+      {...results, ...known},
+      errors: allErrors.isEmpty ? null : allErrors,
+    );
+    return coalesceProgress(progress);
+  }
+
+  /// Translates [progress] like [translateProgress], first answering
+  /// every call [callCache] can without the host.
+  ///
+  /// A cache hit is resumed with the remembered result, and a call
+  /// identical to a future in flight is resumed as a future sharing its
+  /// result, until the execution completes or needs the host.
+  @protected
+  Future<MontyProgress> coalesceProgress(CoreProgressResult progress) async {
+    var next = progress;
+    while (true) {
+      final MontyProgress translated;
+      try {
+        translated = translateProgress(next);
+      } on Object {
+        _calls.clear();
+        rethrow;
+      }
+      if (translated is MontyComplete) {
+        _calls.clear();
+        return translated;
+      }
+      if (translated is MontyResolveFutures) {
+        final forHost = _calls.forHost(translated.pendingCallIds);
+        if (forHost.isNotEmpty) {
+          return forHost.length == translated.pendingCallIds.length
+              ? translated
+              : MontyResolveFutures(pendingCallIds: forHost);
+        }
+        final (known, knownErrors) = _calls.takeKnown();
+        if (known.isEmpty && knownErrors.isEmpty) return translated;
+        next = await resolveFuturesCore(
+          known,
+          errors: knownErrors.isEmpty ? null : knownErrors,
+        );
+        continue;
+      }
+      final cache = callCache;
+      if (cache == null || translated is! MontyPending) return translated;
+      final key = cache.keyOf(translated);
+      if (key == null) return translated;
+      final hit = cache.lookup(key);
+      if (!cache.policies[key.function]!.asFuture) {
+        if (hit == null) {
+          _calls.pend(key, translated.callId);
+          return translated;
+        }
+        next = await resumeCore(hit.value);
+        continue;
+      }
+      if (hit != null) {
+        _calls.know(translated.callId, hit.value);
+      } else if (!_calls.share(key, translated.callId)) {
+        _calls.pend(key, translated.callId);
+        return translated;
+      }
+      next = await _bindings.resumeAsFuture();
+    }
+  }
+
   // -- Private translation helpers --
 
   Future<void> _ensureInitialized() async {
@@ -122,12 +255,15 @@ abstract class BaseMontyPlatform extends MontyPlatform with MontyStateMixin {
     }
   }
 
-  MontyResult _translateRunResult(CoreRunResult r) {
+  /// Translates a [CoreRunResult] into a [MontyResult], throwing
+  /// [MontyException] for errors.
+  @protected
+  MontyResult translateRunResult(CoreRunResult r) {
     if (r.ok) {
       return MontyResult(
         value: r.value,
         error: _buildError(r.error, r.excType, r.traceback),
-        usage: r.usage ?? _zeroUsage,
+        usage: r.usage ?? MontyResourceUsage.zero,
         printOutput: r.printOutput,
       );
     }
@@ -152,7 +288,7 @@ abstract class BaseMontyPlatform extends MontyPlatform with MontyStateMixin {
           result: MontyResult(
             value: p.value,
             error: _buildError(p.error, p.excType, p.traceback),
-            usage: p.usage ?? _zeroUsage,
+            usage: p.usage ?? MontyResourceUsage.zero,
           ),
         );
       case 'pending':
@@ -188,6 +324,11 @@ abstract class BaseMontyPlatform extends MontyPlatform with MontyStateMixin {
     }
   }
 
+  String? _encodeInputs(Map<String, Object?>? inputs) {
+    if (inputs == null || inputs.isEmpty) return null;
+    return json.encode(inputs);
+  }
+
   String? _encodeLimits(MontyLimits? limits) {
     if (limits == null) return null;
     final map = limits.toJson();
@@ -220,3 +361,113 @@ abstract class BaseMontyPlatform extends MontyPlatform with MontyStateMixin {
     return MontyStackFrame.listFromJson(traceback);
   }
 }
+
+/// A call paused for the host: its cache key and VM call ID.
+typedef _PendingCall = ({MontyCallKey key, int callId});
+
+/// Bookkeeping of one execution's memoized calls for
+/// [BaseMontyPlatform.coalesceProgress].
+final class _CallBook {
+  /// The memoized call last handed to the host.
+  _PendingCall? _pending;
+
+  /// Cache keys of futures the host is resolving, by call ID.
+  final Map<int, MontyCallKey> _hostFutures = {};
+
+  /// Futures the host is resolving that identical calls share, by key.
+  final Map<MontyCallKey, int> _inFlight = {};
+
+  /// Futures sharing a host future's result: call ID to the host's.
+  final Map<int, int> _shared = {};
+
+  /// Results and errors of futures resolved without the host.
+  final Map<int, Object?> _known = {};
+  final Map<int, String> _knownErrors = {};
+
+  void pend(MontyCallKey key, int callId) {
+    _pending = (key: key, callId: callId);
+  }
+
+  _PendingCall? takePending() {
+    final pending = _pending;
+    _pending = null;
+    return pending;
+  }
+
+  /// Records that the host resolves [pending]'s future, shared by
+  /// identical calls in flight if [share].
+  void awaitHost(_PendingCall pending, {required bool share}) {
+    _hostFutures[pending.callId] = pending.key;
+    if (share) _inFlight.putIfAbsent(pending.key, () => pending.callId);
+  }
+
+  /// Records [value] as the result of the future of [callId].
+  void know(int callId, Object? value) {
+    _known[callId] = value;
+  }
+
+  /// Makes the future of [callId] share a host future with the same
+  /// [key], returning `false` if none is in flight.
+  bool share(MontyCallKey key, int callId) {
+    final host = _inFlight[key];
+    if (host == null) return false;
+    _shared[callId] = host;
+    return true;
+  }
+
+  /// The [pendingCallIds] whose futures only the host can resolve.
+  List<int> forHost(List<int> pendingCallIds) => [
+        for (final id in pendingCallIds)
+          if (!_known.containsKey(id) &&
+              !_knownErrors.containsKey(id) &&
+              !_shared.containsKey(id))
+            id,
+      ];
+
+  /// Applies the host's answers: remembers memoized [results] in [cache]
+  /// and passes every answer on to the futures sharing it.
+  void settle(
+    Map<int, Object?> results,
+    Map<int, String> errors,
+    MontyCallCache? cache,
+  ) {
+    for (final MapEntry(key: id, :value) in results.entries) {
+      final key = _hostFutures.remove(id);
+      if (key == null) continue;
+      cache?.store(key, value);
+      if (_inFlight[key] == id) _inFlight.remove(key);
+    }
+    for (final id in errors.keys) {
+      final key = _hostFutures.remove(id);
+      if (key != null && _inFlight[key] == id) _inFlight.remove(key);
+    }
+    _shared.removeWhere((id, host) {
+      if (results.containsKey(host)) {
+        _known[id] = results[host];
+      } else if (errors.containsKey(host)) {
+        _knownErrors[id] = errors[host]!;
+      } else {
+        return false;
+      }
+      return true;
+    });
+  }
+
+  /// Drains the results and errors of futures resolved without the host.
+  (Map<int, Object?>, Map<int, String>) takeKnown() {
+    final known = {..._known};
+    final knownErrors = {..._knownErrors};
+    _known.clear();
+    _knownErrors.clear();
+    return (known, knownErrors);
+  }
+
+  void clear() {
+    _pending = null;
+    _hostFutures.clear();
+    _inFlight.clear();
+    _shared.clear();
+    _known.clear();
+    _knownErrors.clear();
+  }
+}
@@ -152,8 +152,8 @@ final class CoreProgressResult {
 /// [CoreRunResult] / [CoreProgressResult] into domain types
 /// ([MontyResult], [MontyProgress], [MontyException]).
 ///
-/// Methods accept JSON-level data (strings for limits, external functions,
-/// resume values) — adapters handle serialization details specific to
+/// Methods accept JSON-level data (strings for inputs, limits, external
+/// functions, resume values) — adapters handle serialization details specific to
 /// their transport (FFI handles vs WASM Worker messages).
 abstract class MontyCoreBindings {
   /// Initializes the backend (Isolate, Worker, etc.).
@@ -162,15 +162,22 @@ abstract class MontyCoreBindings {
   Future<bool> init();
 
   /// Runs [code] to completion and returns the result.
+  ///
+  /// [inputsJson], if non-null, is a JSON object whose entries the code
+  /// reads as global variables.
   Future<CoreRunResult> run(
     String code, {
+    String? inputsJson,
     String? limitsJson,
     String? scriptName,
   });
 
   /// Starts iterative execution of [code] with optional external functions.
+  ///
+  /// [inputsJson] is as for [run].
   Future<CoreProgressResult> start(
     String code, {
+    String? inputsJson,
     String? extFnsJson,
     String? limitsJson,
     String? scriptName,
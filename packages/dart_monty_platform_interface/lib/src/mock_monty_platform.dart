@@ -1,3 +1,4 @@
+import 'dart:async';
 import 'dart:collection';
 import 'dart:typed_data';
 
@@ -7,6 +8,7 @@ import 'package:dart_monty_platform_interface/src/monty_platform.dart';
 import 'package:dart_monty_platform_interface/src/monty_progress.dart';
 import 'package:dart_monty_platform_interface/src/monty_result.dart';
 import 'package:dart_monty_platform_interface/src/monty_snapshot_capable.dart';
+import 'package:dart_monty_platform_interface/src/monty_trace_event.dart';
 
 /// A mock implementation of [MontyPlatform] for testing.
 ///
@@ -51,6 +53,23 @@ class MockMontyPlatform extends MontyPlatform
   /// Whether [dispose] has been called.
   bool isDisposed = false;
 
+  /// Call count for [cancel].
+  int cancelCount = 0;
+
+  /// Backs [output]; add to it to simulate streamed print output.
+  final StreamController<String> outputController =
+      StreamController<String>.broadcast();
+
+  @override
+  Stream<String> get output => outputController.stream;
+
+  /// Backs [trace]; add to it to simulate trace events.
+  final StreamController<MontyTraceEvent> traceController =
+      StreamController<MontyTraceEvent>.broadcast();
+
+  @override
+  Stream<MontyTraceEvent> get trace => traceController.stream;
+
   // ---------------------------------------------------------------------------
   // Invocation history (what was called)
   // ---------------------------------------------------------------------------
@@ -265,6 +284,11 @@ class MockMontyPlatform extends MontyPlatform
     return platform;
   }
 
+  @override
+  Future<void> cancel() async {
+    cancelCount++;
+  }
+
   @override
   Future<void> dispose() async {
     isDisposed = true;
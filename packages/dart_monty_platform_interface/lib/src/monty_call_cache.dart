@@ -0,0 +1,247 @@
+import 'dart:collection';
+import 'dart:convert';
+
+import 'package:dart_monty_platform_interface/src/base_monty_platform.dart';
+import 'package:dart_monty_platform_interface/src/monty_progress.dart';
+import 'package:meta/meta.dart';
+
+/// How a [MontyCallCache] memoizes one external function.
+@immutable
+final class MontyCallPolicy {
+  /// Creates a [MontyCallPolicy].
+  const MontyCallPolicy({
+    this.ttl,
+    this.maxEntries = 256,
+    this.asFuture = false,
+  }) : assert(maxEntries > 0, 'maxEntries must be positive');
+
+  /// How long a remembered result stays valid, or `null` to keep it until
+  /// it is evicted or the cache is cleared.
+  final Duration? ttl;
+
+  /// Most results remembered for this function; the least recently used
+  /// is evicted first.
+  final int maxEntries;
+
+  /// Whether the host answers this function with `resumeAsFuture` and
+  /// `resolveFutures` rather than `resume`.
+  ///
+  /// A cache hit is then handed to the script as an already-resolved
+  /// future, and a call identical to one still in flight shares its
+  /// future's result instead of reaching the host. Leave it `false` for
+  /// functions the host answers with `resume`: a script calling such a
+  /// function gets a cache hit as a plain value.
+  final bool asFuture;
+
+  @override
+  bool operator ==(Object other) {
+    return identical(this, other) ||
+        (other is MontyCallPolicy &&
+            other.ttl == ttl &&
+            other.maxEntries == maxEntries &&
+            other.asFuture == asFuture);
+  }
+
+  @override
+  int get hashCode => Object.hash(ttl, maxEntries, asFuture);
+
+  @override
+  String toString() => 'MontyCallPolicy(ttl: $ttl, '
+      'maxEntries: $maxEntries, asFuture: $asFuture)';
+}
+
+/// Results of external calls remembered by function name and arguments,
+/// so repeated identical calls skip the host.
+///
+/// Assign one to [BaseMontyPlatform.callCache]. Only functions with a
+/// [MontyCallPolicy] in [policies] are memoized; every other call reaches
+/// the host as usual. Two calls are identical when their function name,
+/// positional arguments and keyword arguments are equal, with dict keys
+/// compared regardless of order. Error results are never remembered.
+///
+/// A cache may be shared by several platforms, and outlives executions:
+/// a result learned in one run answers the same call in the next until
+/// its [MontyCallPolicy.ttl] passes.
+///
+/// ```dart
+/// monty.callCache = MontyCallCache({
+///   'lookup_user': MontyCallPolicy(ttl: Duration(minutes: 5)),
+/// });
+/// ```
+class MontyCallCache {
+  /// Creates a [MontyCallCache] memoizing the functions in [policies].
+  ///
+  /// [clock] supplies the current time for [MontyCallPolicy.ttl]; it
+  /// defaults to [DateTime.now].
+  MontyCallCache(
+    Map<String, MontyCallPolicy> policies, {
+    DateTime Function()? clock,
+  })  : policies = Map.unmodifiable(policies),
+        _clock = clock ?? DateTime.now;
+
+  /// Policies by function name.
+  final Map<String, MontyCallPolicy> policies;
+
+  final DateTime Function() _clock;
+  final Map<String, LinkedHashMap<String, _Entry>> _entries = {};
+  int _hits = 0;
+  int _misses = 0;
+
+  /// Lookups answered from the cache.
+  int get hits => _hits;
+
+  /// Lookups of memoized functions that found nothing valid.
+  int get misses => _misses;
+
+  /// Results currently remembered, across all functions.
+  int get length =>
+      _entries.values.fold(0, (sum, entries) => sum + entries.length);
+
+  /// The key [pending] is remembered under, or `null` if its function is
+  /// not memoized.
+  MontyCallKey? keyOf(MontyPending pending) {
+    if (!policies.containsKey(pending.functionName)) return null;
+    final buffer = StringBuffer();
+    _writeCanonical(buffer, pending.arguments);
+    buffer.write('|');
+    _writeCanonical(buffer, pending.kwargs ?? const <String, Object?>{});
+
+    return MontyCallKey._(pending.functionName, buffer.toString());
+  }
+
+  /// The result remembered for [key], as a one-field record so a `null`
+  /// result is told apart from a miss, or `null` on a miss.
+  ({Object? value})? lookup(MontyCallKey key) {
+    final entries = _entries[key.function];
+    final entry = entries?.remove(key._arguments);
+    if (entry == null || entry.isExpired(_clock())) {
+      _misses++;
+
+      return null;
+    }
+    // Re-inserting marks the entry most recently used.
+    entries![key._arguments] = entry;
+    _hits++;
+
+    return (value: entry.value);
+  }
+
+  /// Remembers [value] as the result of [key], evicting the least
+  /// recently used result of the same function beyond its
+  /// [MontyCallPolicy.maxEntries].
+  void store(MontyCallKey key, Object? value) {
+    final policy = policies[key.function];
+    if (policy == null) return;
+    final ttl = policy.ttl;
+    final entries = _entries.putIfAbsent(key.function, LinkedHashMap.new)
+      ..remove(key._arguments);
+    entries[key._arguments] = _Entry(
+      value,
+      ttl != null ? _clock().add(ttl) : null,
+    );
+    while (entries.length > policy.maxEntries) {
+      entries.remove(entries.keys.first);
+    }
+  }
+
+  /// Forgets every remembered result of [function], or of all functions
+  /// when `null`.
+  void clear([String? function]) {
+    if (function == null) {
+      _entries.clear();
+    } else {
+      _entries.remove(function);
+    }
+  }
+}
+
+/// Identifies one external call in a [MontyCallCache]: its function name
+/// and canonicalized arguments.
+@immutable
+final class MontyCallKey {
+  const MontyCallKey._(this.function, this._arguments);
+
+  /// The external function called.
+  final String function;
+
+  final String _arguments;
+
+  @override
+  bool operator ==(Object other) {
+    return identical(this, other) ||
+        (other is MontyCallKey &&
+            other.function == function &&
+            other._arguments == _arguments);
+  }
+
+  @override
+  int get hashCode => Object.hash(function, _arguments);
+
+  @override
+  String toString() => 'MontyCallKey($function $_arguments)';
+}
+
+final class _Entry {
+  const _Entry(this.value, this.expiresAt);
+
+  final Object? value;
+  final DateTime? expiresAt;
+
+  bool isExpired(DateTime now) {
+    final expiresAt = this.expiresAt;
+
+    return expiresAt != null && !now.isBefore(expiresAt);
+  }
+}
+
+/// Writes [value] so equal arguments always produce the same text: dict
+/// entries in key order, and each scalar tagged with its type so `1`,
+/// `true` and `'1'` stay distinct.
+void _writeCanonical(StringBuffer buffer, Object? value) {
+  switch (value) {
+    case null:
+      buffer.write('none');
+    case bool():
+      buffer.write('bool:$value');
+    case int():
+      buffer.write('int:$value');
+    case double():
+      buffer.write('float:$value');
+    case String():
+      buffer
+        ..write('str:')
+        ..write(json.encode(value));
+    case List<Object?>():
+      buffer.write('[');
+      for (final item in value) {
+        _writeCanonical(buffer, item);
+        buffer.write(',');
+      }
+      buffer.write(']');
+    case Map<Object?, Object?>():
+      final entries = [
+        for (final MapEntry(:key, :value) in value.entries)
+          (_canonical(key), value),
+      ]..sort((a, b) => a.$1.compareTo(b.$1));
+      buffer.write('{');
+      for (final (key, item) in entries) {
+        buffer
+          ..write(key)
+          ..write('=');
+        _writeCanonical(buffer, item);
+        buffer.write(',');
+      }
+      buffer.write('}');
+    default:
+      buffer
+        ..write('${value.runtimeType}:')
+        ..write(json.encode(value.toString()));
+  }
+}
+
+String _canonical(Object? value) {
+  final buffer = StringBuffer();
+  _writeCanonical(buffer, value);
+
+  return buffer.toString();
+}
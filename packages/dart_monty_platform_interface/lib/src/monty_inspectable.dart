@@ -0,0 +1,19 @@
+import 'package:dart_monty_platform_interface/src/monty_inspection.dart';
+import 'package:dart_monty_platform_interface/src/monty_platform.dart';
+
+/// Interface for platforms that can look into a live execution's heap and
+/// stack.
+///
+/// Callers check `platform is MontyInspectable` before invoking
+/// [inspect], avoiding `UnsupportedError` on platforms that lack support.
+///
+/// See also:
+/// - [MontyPlatform] — the core platform contract
+/// - [MontyInspection] — what an inspection reports
+abstract class MontyInspectable {
+  /// Inspects the active execution, most usefully while it is paused at
+  /// an external call.
+  ///
+  /// Returns `null` when no execution is active.
+  Future<MontyInspection?> inspect();
+}
@@ -0,0 +1,320 @@
+import 'package:collection/collection.dart';
+import 'package:meta/meta.dart';
+
+const _deepEquality = DeepCollectionEquality();
+
+/// A look at the live heap and stack of an execution, from
+/// `MontyInspectable.inspect`.
+///
+/// Taken while paused at an external call it shows what the script is
+/// holding on to at that point: how much heap is live and in what sizes,
+/// how deep the recursion is, and the shape of the arguments the host is
+/// about to receive.
+///
+/// Heap figures come from the interpreter's allocation tracker, which
+/// sees allocation sizes but not object types or frames. Live counts
+/// cover activity since the execution was started or restored.
+@immutable
+final class MontyInspection {
+  /// Creates a [MontyInspection].
+  const MontyInspection({
+    required this.state,
+    required this.heapBytes,
+    required this.peakHeapBytes,
+    required this.liveAllocations,
+    required this.allocations,
+    required this.stackDepth,
+    required this.maxStackDepth,
+    required this.timeElapsedMs,
+    this.memoryLimit,
+    this.stackLimit,
+    this.liveBySize = const [],
+    this.pendingCall,
+  });
+
+  /// Creates a [MontyInspection] from a JSON map, as reported by the
+  /// native core's `monty_inspect_json`.
+  factory MontyInspection.fromJson(Map<String, dynamic> json) {
+    final pending = json['pending'] as Map<String, dynamic>?;
+
+    return MontyInspection(
+      state: json['state'] as String,
+      heapBytes: json['heap_bytes'] as int,
+      peakHeapBytes: json['peak_heap_bytes'] as int,
+      memoryLimit: json['memory_limit'] as int?,
+      liveAllocations: json['live_allocations'] as int,
+      allocations: json['allocations'] as int,
+      liveBySize: [
+        for (final bucket in json['live_by_size'] as List? ?? const [])
+          MontyHeapBucket.fromJson(bucket as Map<String, dynamic>),
+      ],
+      stackDepth: json['stack_depth'] as int,
+      maxStackDepth: json['max_stack_depth'] as int,
+      stackLimit: json['stack_limit'] as int?,
+      timeElapsedMs: json['time_elapsed_ms'] as int,
+      pendingCall:
+          pending != null ? MontyPendingCallShape.fromJson(pending) : null,
+    );
+  }
+
+  /// Execution state: `ready`, `pending`, `resolve_futures`, `complete`
+  /// or `consumed`.
+  final String state;
+
+  /// Live heap bytes.
+  final int heapBytes;
+
+  /// Peak live heap bytes so far.
+  final int peakHeapBytes;
+
+  /// The memory limit in bytes, or `null` if none is set.
+  final int? memoryLimit;
+
+  /// Allocations not yet freed.
+  final int liveAllocations;
+
+  /// Allocations made so far, freed or not.
+  final int allocations;
+
+  /// Live allocations by size class, smallest first. Empty classes are
+  /// left out.
+  final List<MontyHeapBucket> liveBySize;
+
+  /// Recursion depth where the VM last stopped.
+  final int stackDepth;
+
+  /// Deepest recursion depth reached.
+  final int maxStackDepth;
+
+  /// The recursion limit, or `null` if none is set.
+  final int? stackLimit;
+
+  /// Time spent inside the VM in milliseconds, excluding pauses.
+  final int timeElapsedMs;
+
+  /// The external call the execution is paused at, or `null` if it is
+  /// not paused at one.
+  final MontyPendingCallShape? pendingCall;
+
+  /// Serializes this inspection to a JSON-compatible map.
+  Map<String, dynamic> toJson() {
+    return {
+      'state': state,
+      'heap_bytes': heapBytes,
+      'peak_heap_bytes': peakHeapBytes,
+      'memory_limit': memoryLimit,
+      'live_allocations': liveAllocations,
+      'allocations': allocations,
+      'live_by_size': [for (final bucket in liveBySize) bucket.toJson()],
+      'stack_depth': stackDepth,
+      'max_stack_depth': maxStackDepth,
+      'stack_limit': stackLimit,
+      'time_elapsed_ms': timeElapsedMs,
+      'pending': pendingCall?.toJson(),
+    };
+  }
+
+  @override
+  bool operator ==(Object other) {
+    return identical(this, other) ||
+        (other is MontyInspection &&
+            other.state == state &&
+            other.heapBytes == heapBytes &&
+            other.peakHeapBytes == peakHeapBytes &&
+            other.memoryLimit == memoryLimit &&
+            other.liveAllocations == liveAllocations &&
+            other.allocations == allocations &&
+            _deepEquality.equals(other.liveBySize, liveBySize) &&
+            other.stackDepth == stackDepth &&
+            other.maxStackDepth == maxStackDepth &&
+            other.stackLimit == stackLimit &&
+            other.timeElapsedMs == timeElapsedMs &&
+            other.pendingCall == pendingCall);
+  }
+
+  @override
+  int get hashCode => Object.hash(
+        state,
+        heapBytes,
+        peakHeapBytes,
+        memoryLimit,
+        liveAllocations,
+        allocations,
+        _deepEquality.hash(liveBySize),
+        stackDepth,
+        maxStackDepth,
+        stackLimit,
+        timeElapsedMs,
+        pendingCall,
+      );
+
+  @override
+  String toString() {
+    return 'MontyInspection($state, heapBytes: $heapBytes, '
+        'liveAllocations: $liveAllocations, stackDepth: $stackDepth'
+        '${pendingCall != null ? ', pendingCall: $pendingCall' : ''})';
+  }
+}
+
+/// The live allocations of one size class in a [MontyInspection].
+@immutable
+final class MontyHeapBucket {
+  /// Creates a [MontyHeapBucket].
+  const MontyHeapBucket({required this.count, this.maxBytes});
+
+  /// Creates a [MontyHeapBucket] from a JSON map.
+  ///
+  /// Expected keys: `max_bytes` (nullable), `count`.
+  factory MontyHeapBucket.fromJson(Map<String, dynamic> json) {
+    return MontyHeapBucket(
+      maxBytes: json['max_bytes'] as int?,
+      count: json['count'] as int,
+    );
+  }
+
+  /// Size of the largest allocation counted here, or `null` for the
+  /// unbounded class holding the largest allocations.
+  final int? maxBytes;
+
+  /// Live allocations in this class.
+  final int count;
+
+  /// Serializes this bucket to a JSON-compatible map.
+  Map<String, dynamic> toJson() => {'max_bytes': maxBytes, 'count': count};
+
+  @override
+  bool operator ==(Object other) {
+    return identical(this, other) ||
+        (other is MontyHeapBucket &&
+            other.maxBytes == maxBytes &&
+            other.count == count);
+  }
+
+  @override
+  int get hashCode => Object.hash(maxBytes, count);
+
+  @override
+  String toString() => 'MontyHeapBucket(<=${maxBytes ?? 'inf'}: $count)';
+}
+
+/// The external call a [MontyInspection] was taken at, with its arguments
+/// described rather than converted.
+@immutable
+final class MontyPendingCallShape {
+  /// Creates a [MontyPendingCallShape].
+  const MontyPendingCallShape({
+    required this.functionName,
+    required this.callId,
+    this.arguments = const [],
+    this.kwargs = const {},
+  });
+
+  /// Creates a [MontyPendingCallShape] from a JSON map.
+  ///
+  /// Expected keys: `function_name`, `call_id`, `args` (a list of value
+  /// shapes) and `kwargs` (a list of value shapes with a `name`).
+  factory MontyPendingCallShape.fromJson(Map<String, dynamic> json) {
+    final kwargs = (json['kwargs'] as List? ?? const [])
+        .cast<Map<String, dynamic>>();
+
+    return MontyPendingCallShape(
+      functionName: json['function_name'] as String,
+      callId: json['call_id'] as int,
+      arguments: [
+        for (final arg in json['args'] as List? ?? const [])
+          MontyValueShape.fromJson(arg as Map<String, dynamic>),
+      ],
+      kwargs: {
+        for (final kwarg in kwargs)
+          kwarg['name'] as String: MontyValueShape.fromJson(kwarg),
+      },
+    );
+  }
+
+  /// The external function called.
+  final String functionName;
+
+  /// The VM's ID for the call.
+  final int callId;
+
+  /// Shapes of the positional arguments.
+  final List<MontyValueShape> arguments;
+
+  /// Shapes of the keyword arguments, by name.
+  final Map<String, MontyValueShape> kwargs;
+
+  /// Serializes this call to a JSON-compatible map.
+  Map<String, dynamic> toJson() {
+    return {
+      'function_name': functionName,
+      'call_id': callId,
+      'args': [for (final arg in arguments) arg.toJson()],
+      'kwargs': [
+        for (final MapEntry(:key, :value) in kwargs.entries)
+          {'name': key, ...value.toJson()},
+      ],
+    };
+  }
+
+  @override
+  bool operator ==(Object other) {
+    return identical(this, other) ||
+        (other is MontyPendingCallShape &&
+            other.functionName == functionName &&
+            other.callId == callId &&
+            _deepEquality.equals(other.arguments, arguments) &&
+            _deepEquality.equals(other.kwargs, kwargs));
+  }
+
+  @override
+  int get hashCode => Object.hash(
+        functionName,
+        callId,
+        _deepEquality.hash(arguments),
+        _deepEquality.hash(kwargs),
+      );
+
+  @override
+  String toString() => 'MontyPendingCallShape($functionName, '
+      'arguments: $arguments, kwargs: $kwargs)';
+}
+
+/// The Python type and length of a value, without the value itself.
+@immutable
+final class MontyValueShape {
+  /// Creates a [MontyValueShape].
+  const MontyValueShape({required this.type, this.length});
+
+  /// Creates a [MontyValueShape] from a JSON map.
+  ///
+  /// Expected keys: `type`, `len` (nullable).
+  factory MontyValueShape.fromJson(Map<String, dynamic> json) {
+    return MontyValueShape(
+      type: json['type'] as String,
+      length: json['len'] as int?,
+    );
+  }
+
+  /// Python type name, e.g. `list` or `str`.
+  final String type;
+
+  /// `len()` of the value, or `null` if it has none.
+  final int? length;
+
+  /// Serializes this shape to a JSON-compatible map.
+  Map<String, dynamic> toJson() => {'type': type, 'len': length};
+
+  @override
+  bool operator ==(Object other) {
+    return identical(this, other) ||
+        (other is MontyValueShape &&
+            other.type == type &&
+            other.length == length);
+  }
+
+  @override
+  int get hashCode => Object.hash(type, length);
+
+  @override
+  String toString() => length != null ? '$type[$length]' : type;
+}
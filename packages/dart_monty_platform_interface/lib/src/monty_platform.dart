@@ -1,6 +1,9 @@
+import 'package:dart_monty_platform_interface/src/monty_exception.dart';
 import 'package:dart_monty_platform_interface/src/monty_limits.dart';
 import 'package:dart_monty_platform_interface/src/monty_progress.dart';
+import 'package:dart_monty_platform_interface/src/monty_resource_usage.dart';
 import 'package:dart_monty_platform_interface/src/monty_result.dart';
+import 'package:dart_monty_platform_interface/src/monty_trace_event.dart';
 import 'package:meta/meta.dart';
 import 'package:plugin_platform_interface/plugin_platform_interface.dart';
 
@@ -74,6 +77,44 @@ abstract class MontyPlatform extends PlatformInterface {
     throw UnimplementedError('run() has not been implemented.');
   }
 
+  /// Runs [code] to completion once per entry of [inputs] and returns the
+  /// results in the same order.
+  ///
+  /// Every run gets its own variable bindings from [inputs] and the same
+  /// [limits]. A run that fails is reported by a result with
+  /// [MontyResult.error] set instead of throwing, so the other runs still
+  /// complete. The code cannot call external functions.
+  ///
+  /// Platforms that can run interpreters in parallel override this; the
+  /// default implementation calls [run] for each input set in turn.
+  ///
+  /// ```dart
+  /// final results = await platform.runBatch(
+  ///   'x * 2',
+  ///   [for (var x = 0; x < 3; x++) {'x': x}],
+  /// );
+  /// print([for (final result in results) result.value]); // [0, 2, 4]
+  /// ```
+  Future<List<MontyResult>> runBatch(
+    String code,
+    List<Map<String, Object?>> inputs, {
+    MontyLimits? limits,
+    String? scriptName,
+  }) async {
+    final results = <MontyResult>[];
+    for (final set in inputs) {
+      try {
+        results.add(
+          await run(code, inputs: set, limits: limits, scriptName: scriptName),
+        );
+      } on MontyException catch (e) {
+        results.add(MontyResult(error: e, usage: MontyResourceUsage.zero));
+      }
+    }
+
+    return results;
+  }
+
   /// Starts a multi-step execution of [code].
   ///
   /// When the code calls an external function listed in
@@ -103,6 +144,35 @@ abstract class MontyPlatform extends PlatformInterface {
     throw UnimplementedError('resumeWithError() has not been implemented.');
   }
 
+  /// Python `print()` output, streamed as the interpreter produces it.
+  ///
+  /// Platforms that support streaming emit output here while the stream
+  /// has a listener, instead of collecting it into
+  /// [MontyResult.printOutput]; how often chunks arrive is up to the
+  /// platform. The default implementation never emits, and output stays in
+  /// the result.
+  Stream<String> get output => const Stream.empty();
+
+  /// Timed spans of the work behind each call, for finding where latency
+  /// goes.
+  ///
+  /// Platforms that support tracing record events while the stream has a
+  /// listener and emit them each time the interpreter returns control.
+  /// Recording costs time of its own, so nothing is recorded without a
+  /// listener. The default implementation never emits.
+  Stream<MontyTraceEvent> get trace => const Stream.empty();
+
+  /// Interrupts the execution in progress, if any.
+  ///
+  /// May be called while a [run], [start] or resume is still pending. A
+  /// running execution stops at the interpreter's next time check and
+  /// ends with a `KeyboardInterrupt` error; a paused one ends the same way
+  /// when resumed. Executions started after that are unaffected.
+  ///
+  /// The default implementation does nothing, for platforms that cannot
+  /// preempt the interpreter.
+  Future<void> cancel() async {}
+
   /// Releases resources held by this interpreter instance.
   Future<void> dispose() {
     throw UnimplementedError('dispose() has not been implemented.');
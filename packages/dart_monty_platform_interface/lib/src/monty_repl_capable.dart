@@ -0,0 +1,37 @@
+import 'package:dart_monty_platform_interface/src/monty_exception.dart';
+import 'package:dart_monty_platform_interface/src/monty_limits.dart';
+import 'package:dart_monty_platform_interface/src/monty_platform.dart';
+import 'package:dart_monty_platform_interface/src/monty_result.dart';
+import 'package:dart_monty_platform_interface/src/monty_session.dart';
+
+/// Interface for platforms that keep a live REPL session inside the VM.
+///
+/// Unlike [MontySession], which copies the persisted variables a call
+/// uses in and out as JSON on each call, a REPL session keeps its heap
+/// and global namespace alive between [feed] calls, so each call costs
+/// only the new code and any value — functions, classes, non-JSON
+/// objects — persists. Callers
+/// check `platform is MontyReplCapable` before invoking these methods.
+///
+/// See also:
+/// - [MontyPlatform] — the core platform contract
+/// - [MontySession] — portable JSON-based state persistence
+abstract class MontyReplCapable {
+  /// Runs [code] in the platform's REPL session, starting one if needed.
+  ///
+  /// [limits] apply from this call on, with the time limit counted per
+  /// call; a limit left `null` keeps its earlier value. [scriptName] is
+  /// applied when the session starts and ignored afterwards; call
+  /// [resetSession] to start over with a different one.
+  ///
+  /// Throws [MontyException] if the code raises; the session and its
+  /// state survive the error.
+  Future<MontyResult> feed(
+    String code, {
+    MontyLimits? limits,
+    String? scriptName,
+  });
+
+  /// Discards the REPL session and all of its state.
+  Future<void> resetSession();
+}
@@ -3,7 +3,8 @@ import 'package:meta/meta.dart';
 /// Resource usage statistics from a Monty Python execution.
 ///
 /// Tracks [memoryBytesUsed], [timeElapsedMs], and [stackDepthUsed] to help
-/// callers monitor and budget sandbox resources.
+/// callers monitor and budget sandbox resources. Backends that meter the VM
+/// also report [allocations] and [cpuTimeMs]; these are `null` otherwise.
 @immutable
 final class MontyResourceUsage {
   /// Creates a [MontyResourceUsage] with the given resource metrics.
@@ -11,21 +12,33 @@ final class MontyResourceUsage {
     required this.memoryBytesUsed,
     required this.timeElapsedMs,
     required this.stackDepthUsed,
+    this.allocations,
+    this.cpuTimeMs,
   });
 
+  /// Usage of nothing, reported for results made up from an exception
+  /// without the VM having run, e.g. a failed run in a batch.
+  static const zero = MontyResourceUsage(
+    memoryBytesUsed: 0,
+    timeElapsedMs: 0,
+    stackDepthUsed: 0,
+  );
+
   /// Creates a [MontyResourceUsage] from a JSON map.
   ///
   /// Expected keys: `memory_bytes_used`, `time_elapsed_ms`,
-  /// `stack_depth_used`.
+  /// `stack_depth_used`. Optional keys: `allocations`, `cpu_time_ms`.
   factory MontyResourceUsage.fromJson(Map<String, dynamic> json) {
     return MontyResourceUsage(
       memoryBytesUsed: json['memory_bytes_used'] as int,
       timeElapsedMs: json['time_elapsed_ms'] as int,
       stackDepthUsed: json['stack_depth_used'] as int,
+      allocations: json['allocations'] as int?,
+      cpuTimeMs: json['cpu_time_ms'] as int?,
     );
   }
 
-  /// The number of bytes of memory used during execution.
+  /// The peak number of bytes of memory used during execution.
   final int memoryBytesUsed;
 
   /// The wall-clock time elapsed in milliseconds.
@@ -34,12 +47,21 @@ final class MontyResourceUsage {
   /// The maximum stack depth reached during execution.
   final int stackDepthUsed;
 
+  /// The number of heap allocations, if reported by the backend.
+  final int? allocations;
+
+  /// The CPU time spent executing in milliseconds, if reported by the
+  /// backend.
+  final int? cpuTimeMs;
+
   /// Serializes this resource usage to a JSON-compatible map.
   Map<String, dynamic> toJson() {
     return {
       'memory_bytes_used': memoryBytesUsed,
       'time_elapsed_ms': timeElapsedMs,
       'stack_depth_used': stackDepthUsed,
+      if (allocations != null) 'allocations': allocations,
+      if (cpuTimeMs != null) 'cpu_time_ms': cpuTimeMs,
     };
   }
 
@@ -49,7 +71,9 @@ final class MontyResourceUsage {
         (other is MontyResourceUsage &&
             other.memoryBytesUsed == memoryBytesUsed &&
             other.timeElapsedMs == timeElapsedMs &&
-            other.stackDepthUsed == stackDepthUsed);
+            other.stackDepthUsed == stackDepthUsed &&
+            other.allocations == allocations &&
+            other.cpuTimeMs == cpuTimeMs);
   }
 
   @override
@@ -57,6 +81,8 @@ final class MontyResourceUsage {
         memoryBytesUsed,
         timeElapsedMs,
         stackDepthUsed,
+        allocations,
+        cpuTimeMs,
       );
 
   @override
@@ -64,6 +90,8 @@ final class MontyResourceUsage {
     return 'MontyResourceUsage('
         'memoryBytesUsed: $memoryBytesUsed, '
         'timeElapsedMs: $timeElapsedMs, '
-        'stackDepthUsed: $stackDepthUsed)';
+        'stackDepthUsed: $stackDepthUsed'
+        '${allocations != null ? ', allocations: $allocations' : ''}'
+        '${cpuTimeMs != null ? ', cpuTimeMs: $cpuTimeMs' : ''})';
   }
 }
@@ -2,6 +2,7 @@ import 'package:dart_monty_platform_interface/src/monty_exception.dart';
 import 'package:dart_monty_platform_interface/src/monty_limits.dart';
 import 'package:dart_monty_platform_interface/src/monty_platform.dart';
 import 'package:dart_monty_platform_interface/src/monty_progress.dart';
+import 'package:dart_monty_platform_interface/src/monty_repl_capable.dart';
 import 'package:dart_monty_platform_interface/src/monty_resource_usage.dart';
 import 'package:dart_monty_platform_interface/src/monty_result.dart';
 import 'package:meta/meta.dart';
@@ -18,11 +19,21 @@ const _persistStateFn = '__persist_state__';
 /// Excludes `==` (comparison) and augmented assignments (`+=`, etc.).
 final _assignmentPattern = RegExp(r'^([a-zA-Z]\w*)\s*=[^=]', multiLine: true);
 
-/// Zero-cost usage for error results synthesized from caught exceptions.
-const _zeroUsage = MontyResourceUsage(
-  memoryBytesUsed: 0,
-  timeElapsedMs: 0,
-  stackDepthUsed: 0,
+/// Matches identifier-like tokens, to find the persisted names a call's
+/// code mentions.
+final _identifierPattern = RegExp(r'[a-zA-Z_]\w*');
+
+/// Matches what may follow a mention of a name the code rebinds: an
+/// assignment, augmented assignment, annotation or walrus, possibly past
+/// the closing brackets of a target, or the comma of a tuple target.
+final _rebindAfterPattern = RegExp(
+  r'[)\]]*\s*(?:(?:[-+*/%&|^@:]|//|\*\*|<<|>>)?=(?!=)|:[^=\n]*=(?!=)|,)',
+);
+
+/// Matches what may precede such a mention, up to the name: a binding
+/// keyword, or the comma of a tuple target.
+final _rebindBeforePattern = RegExp(
+  r'(?:\b(?:del|for|as|global|nonlocal|import|def|class)\s+|,\s*)$',
 );
 
 /// Python keyword prefixes that indicate a line is a statement (not an
@@ -53,6 +64,16 @@ const _statementPrefixes = [
 /// types persist (int, float, str, bool, list, dict, None).
 /// Non-serializable values are silently dropped after each call.
 ///
+/// Each call injects only the persisted variables its code mentions, and
+/// persists only the names it assigns or may change; the rest stay in
+/// Dart untouched, so a large value costs nothing in calls that do not
+/// use it. A scalar a call only reads is copied in but not back out.
+///
+/// For state too large to copy in at all, create the session with
+/// `resident: true` on a platform implementing [MontyReplCapable]: every
+/// value then stays in the VM heap, referenced by its global name, and
+/// each call ships only its code.
+///
 /// ```dart
 /// final session = MontySession(platform: monty);
 /// await session.run('x = 42');
@@ -64,15 +85,46 @@ class MontySession {
   ///
   /// The session does not take ownership of the platform — calling
   /// [dispose] on the session does NOT dispose the underlying platform.
-  MontySession({required MontyPlatform platform}) : _platform = platform;
+  ///
+  /// If [resident] is `true`, state is kept in the platform's REPL session
+  /// instead of being copied in and out of each call; see [resident].
+  /// Throws [ArgumentError] if [platform] is not [MontyReplCapable].
+  MontySession({required MontyPlatform platform, this.resident = false})
+      : _platform = platform {
+    if (resident && platform is! MontyReplCapable) {
+      throw ArgumentError.value(
+        platform,
+        'platform',
+        'must implement MontyReplCapable for a resident session',
+      );
+    }
+  }
+
+  /// Whether values stay resident in the VM between calls.
+  ///
+  /// A resident session runs each call as a [MontyReplCapable.feed], so
+  /// no value crosses the boundary and any value persists, JSON or not.
+  /// [state] is then always empty, and [start] is unavailable since a
+  /// feed cannot pause for external functions.
+  final bool resident;
 
   final MontyPlatform _platform;
+
+  /// Whether the next resident call must start a new REPL session.
+  bool _resetPending = false;
   Map<String, Object?> _state = {};
   bool _disposed = false;
 
+  /// Persisted names the current call restores.
+  Set<String> _restoring = const {};
+
+  /// Names the current call persists; see [_capturePersistArgs].
+  Set<String> _persisting = const {};
+
   /// The current persisted state as a JSON-decoded map.
   ///
-  /// Read-only snapshot. Returns an empty map if no state has been persisted.
+  /// Read-only snapshot. Returns an empty map if no state has been
+  /// persisted, and always for a [resident] session.
   Map<String, Object?> get state => Map<String, Object?>.from(_state);
 
   /// Executes [code] with state restored from previous calls.
@@ -89,6 +141,7 @@ class MontySession {
     String? scriptName,
   }) async {
     _checkNotDisposed();
+    if (resident) return _feed(code, limits: limits, scriptName: scriptName);
     final wrappedCode = _wrapCode(code);
 
     var progress = await _safeStart(
@@ -101,7 +154,7 @@ class MontySession {
     while (true) {
       switch (progress) {
         case MontyPending(functionName: _restoreStateFn):
-          progress = await _safeResume(_state);
+          progress = await _safeResume(_restoredState());
 
         case MontyPending(functionName: _persistStateFn):
           _capturePersistArgs(progress.arguments);
@@ -132,6 +185,8 @@ class MontySession {
   /// The caller must resume through [resume] or [resumeWithError] on
   /// this session (not on the underlying platform) so that internal
   /// state functions are intercepted on completion.
+  ///
+  /// Throws [UnsupportedError] on a [resident] session.
   Future<MontyProgress> start(
     String code, {
     List<String>? externalFunctions,
@@ -139,6 +194,9 @@ class MontySession {
     String? scriptName,
   }) async {
     _checkNotDisposed();
+    if (resident) {
+      throw UnsupportedError('start() is not available on a resident session');
+    }
     final wrappedCode = _wrapCode(code);
     final allExtFns = [
       _restoreStateFn,
@@ -181,15 +239,18 @@ class MontySession {
   /// Clears all persisted state.
   ///
   /// After calling this, the next `run()` or `start()` call begins with
-  /// empty globals (as if creating a fresh session).
+  /// empty globals (as if creating a fresh session). A [resident] session
+  /// resets the platform's REPL session before its next call.
   void clearState() {
     _checkNotDisposed();
     _state = {};
+    _resetPending = resident;
   }
 
   /// Disposes the session.
   ///
-  /// Clears persisted state. Does NOT dispose the underlying [MontyPlatform].
+  /// Clears persisted state. Does NOT dispose the underlying [MontyPlatform],
+  /// nor reset the REPL session holding a [resident] session's values.
   void dispose() {
     _state = {};
     _disposed = true;
@@ -210,8 +271,13 @@ class MontySession {
   /// the result value. After persistence, `__r` is re-emitted as the
   /// final expression so `MontyResult.value` reflects the user's code.
   String _wrapCode(String userCode) {
+    _restoring = _referencedNames(userCode);
+    _persisting = {
+      ..._changedNames(userCode, _restoring),
+      ..._extractAssignmentTargets(userCode),
+    };
     final restore = _generateRestore();
-    final persist = _generatePersist(userCode);
+    final persist = _generatePersist();
     final (processedCode, hasResult) = _captureLastExpression(userCode);
 
     final buf = StringBuffer(restore)
@@ -230,11 +296,11 @@ class MontySession {
   /// Generates Python code to restore state from the `__restore_state__`
   /// external function.
   ///
-  /// The function returns the current state as a Python dict. Each known
-  /// key is unpacked into a local variable assignment.
+  /// The function returns the restored names (see [_restoredState]) as a
+  /// Python dict, each unpacked into a variable assignment.
   String _generateRestore() {
     final buf = StringBuffer('__d = __restore_state__()');
-    for (final key in _state.keys) {
+    for (final key in _restoring) {
       buf.write('\n$key = __d["$key"]');
     }
 
@@ -243,21 +309,16 @@ class MontySession {
 
   /// Generates Python code to persist state via `__persist_state__`.
   ///
-  /// Builds a dict of all known variable names (previous state keys +
-  /// new assignment targets from [userCode]), using try/except per
+  /// Builds a dict of the names the call may have changed — the restored
+  /// names plus the new assignment targets — using try/except per
   /// variable to gracefully skip undefined or non-serializable values.
-  String _generatePersist(String userCode) {
-    final names = <String>{
-      ..._state.keys,
-      ..._extractAssignmentTargets(userCode),
-    };
-
-    if (names.isEmpty) {
+  String _generatePersist() {
+    if (_persisting.isEmpty) {
       return '__persist_state__({})';
     }
 
     final buf = StringBuffer('__d2 = {}');
-    for (final name in names) {
+    for (final name in _persisting) {
       buf
         ..write('\ntry:')
         ..write('\n    __d2["$name"] = $name')
@@ -320,6 +381,53 @@ class MontySession {
     return (lines.join('\n'), true);
   }
 
+  /// The persisted names that appear anywhere in [code].
+  ///
+  /// Names can only be read or rebound by code that spells them out, so
+  /// the others need not cross the boundary. A mention inside a string or
+  /// comment merely restores a value that was not needed.
+  Set<String> _referencedNames(String code) {
+    if (_state.isEmpty) return const {};
+
+    return {
+      for (final match in _identifierPattern.allMatches(code))
+        if (_state.containsKey(match[0])) match[0]!,
+    };
+  }
+
+  /// The names of [restored] that [code] must write back.
+  ///
+  /// A list or dict may be mutated through any name bound to it — a loop
+  /// variable, an alias, a function parameter — so it is always written
+  /// back. An immutable scalar (int, float, str, bool or None) changes
+  /// only by being rebound, so it is written back only when a mention of
+  /// it is assigned to, follows a binding keyword such as `del` or `for`,
+  /// or is next to a comma, as in a tuple target.
+  Set<String> _changedNames(String code, Set<String> restored) {
+    final scalars = {
+      for (final name in restored)
+        if (_isImmutableScalar(_state[name])) name,
+    };
+    final changed = restored.difference(scalars);
+    if (scalars.isEmpty) return changed;
+    for (final match in _identifierPattern.allMatches(code)) {
+      final name = match[0]!;
+      if (!scalars.contains(name) || changed.contains(name)) continue;
+      final lineStart = code.lastIndexOf('\n', match.start) + 1;
+      if (_rebindAfterPattern.matchAsPrefix(code, match.end) != null ||
+          _rebindBeforePattern.hasMatch(
+            code.substring(lineStart, match.start),
+          )) {
+        changed.add(name);
+      }
+    }
+
+    return changed;
+  }
+
+  static bool _isImmutableScalar(Object? value) =>
+      value == null || value is num || value is String || value is bool;
+
   /// Extracts simple assignment targets from [code].
   ///
   /// Returns variable names from top-level `identifier = expression`
@@ -361,7 +469,7 @@ class MontySession {
     while (true) {
       switch (current) {
         case MontyPending(functionName: _restoreStateFn):
-          current = await _safeResume(_state);
+          current = await _safeResume(_restoredState());
 
         case MontyPending(functionName: _persistStateFn):
           _capturePersistArgs(current.arguments);
@@ -375,12 +483,23 @@ class MontySession {
     }
   }
 
-  /// Captures persisted state from `__persist_state__` arguments.
+  /// The values the `__restore_state__` call returns.
+  Map<String, Object?> _restoredState() => {
+        for (final name in _restoring) name: _state[name],
+      };
+
+  /// Merges persisted state from `__persist_state__` arguments.
+  ///
+  /// A name the call persisted but that is missing from the dict was
+  /// deleted or is no longer serializable, and is dropped.
   void _capturePersistArgs(List<Object?> arguments) {
     if (arguments.isEmpty) return;
     final arg = arguments.first;
     if (arg is Map) {
-      _state = Map<String, Object?>.from(arg);
+      for (final name in _persisting) {
+        if (!arg.containsKey(name)) _state.remove(name);
+      }
+      _state.addAll(Map<String, Object?>.from(arg));
     }
   }
 
@@ -388,6 +507,26 @@ class MontySession {
   // Safe platform wrappers
   // ---------------------------------------------------------------------------
 
+  /// Runs [code] in the platform's REPL session, for a [resident] session.
+  ///
+  /// Converts a [MontyException] to an error result, as [run] does.
+  Future<MontyResult> _feed(
+    String code, {
+    MontyLimits? limits,
+    String? scriptName,
+  }) async {
+    final repl = _platform as MontyReplCapable;
+    if (_resetPending) {
+      _resetPending = false;
+      await repl.resetSession();
+    }
+    try {
+      return await repl.feed(code, limits: limits, scriptName: scriptName);
+    } on MontyException catch (e) {
+      return MontyResult(error: e, usage: MontyResourceUsage.zero);
+    }
+  }
+
   /// Wraps [MontyPlatform.start], catching [MontyException] thrown for
   /// Python runtime errors during `start()`/`resume()` and converting
   /// them to [MontyComplete] with an error result.
@@ -405,7 +544,9 @@ class MontySession {
         scriptName: scriptName,
       );
     } on MontyException catch (e) {
-      return MontyComplete(result: MontyResult(error: e, usage: _zeroUsage));
+      return MontyComplete(
+        result: MontyResult(error: e, usage: MontyResourceUsage.zero),
+      );
     }
   }
 
@@ -414,7 +555,9 @@ class MontySession {
     try {
       return await _platform.resume(returnValue);
     } on MontyException catch (e) {
-      return MontyComplete(result: MontyResult(error: e, usage: _zeroUsage));
+      return MontyComplete(
+        result: MontyResult(error: e, usage: MontyResourceUsage.zero),
+      );
     }
   }
 
@@ -423,7 +566,9 @@ class MontySession {
     try {
       return await _platform.resumeWithError(errorMessage);
     } on MontyException catch (e) {
-      return MontyComplete(result: MontyResult(error: e, usage: _zeroUsage));
+      return MontyComplete(
+        result: MontyResult(error: e, usage: MontyResourceUsage.zero),
+      );
     }
   }
 
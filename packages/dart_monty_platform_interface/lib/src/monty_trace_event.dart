@@ -0,0 +1,108 @@
+import 'package:meta/meta.dart';
+
+/// What a [MontyTraceEvent] measured.
+enum MontyTraceKind {
+  /// Compiling the source.
+  compile,
+
+  /// Running inside the VM.
+  vm,
+
+  /// Paused at an external call or on futures, waiting for the host to
+  /// resume.
+  host,
+
+  /// Converting values to or from JSON or the binary encoding.
+  convert,
+
+  /// Passing a call to the isolate or worker running the interpreter and
+  /// back, including everything it did there.
+  isolate,
+}
+
+/// One timed span of work behind an execution, from a platform's trace
+/// stream.
+///
+/// Together the events show where a slow call went: Python
+/// ([MontyTraceKind.vm]), value conversion ([MontyTraceKind.convert]), the
+/// host ([MontyTraceKind.host]), or hops between isolates
+/// ([MontyTraceKind.isolate]).
+@immutable
+final class MontyTraceEvent {
+  /// Creates a [MontyTraceEvent].
+  const MontyTraceEvent({
+    required this.kind,
+    required this.op,
+    required this.duration,
+    this.at,
+    this.bytes,
+  });
+
+  /// Creates a [MontyTraceEvent] from a JSON map, as reported by the
+  /// native core.
+  ///
+  /// Expected keys: `kind`, `op`, `duration_us`. Optional keys: `at_us`,
+  /// `bytes`. Returns `null` for a `kind` this version does not know.
+  static MontyTraceEvent? fromJson(Map<String, dynamic> json) {
+    final kind = MontyTraceKind.values.asNameMap()[json['kind']];
+    if (kind == null) return null;
+    final atUs = json['at_us'] as int?;
+
+    return MontyTraceEvent(
+      kind: kind,
+      op: json['op'] as String,
+      duration: Duration(microseconds: json['duration_us'] as int),
+      at: atUs != null ? Duration(microseconds: atUs) : null,
+      bytes: json['bytes'] as int?,
+    );
+  }
+
+  /// What was measured.
+  final MontyTraceKind kind;
+
+  /// The call or conversion measured, e.g. `start`, `resume` or
+  /// `args_bin`.
+  final String op;
+
+  /// How long the span took.
+  final Duration duration;
+
+  /// When the span began, relative to the creation of the native handle
+  /// running the execution, or `null` for spans measured outside it.
+  final Duration? at;
+
+  /// Bytes converted, for [MontyTraceKind.convert] spans that report it.
+  final int? bytes;
+
+  /// Serializes this event to a JSON-compatible map.
+  Map<String, dynamic> toJson() {
+    return {
+      'kind': kind.name,
+      'op': op,
+      'duration_us': duration.inMicroseconds,
+      if (at != null) 'at_us': at!.inMicroseconds,
+      if (bytes != null) 'bytes': bytes,
+    };
+  }
+
+  @override
+  bool operator ==(Object other) {
+    return identical(this, other) ||
+        (other is MontyTraceEvent &&
+            other.kind == kind &&
+            other.op == op &&
+            other.duration == duration &&
+            other.at == at &&
+            other.bytes == bytes);
+  }
+
+  @override
+  int get hashCode => Object.hash(kind, op, duration, at, bytes);
+
+  @override
+  String toString() {
+    return 'MontyTraceEvent(${kind.name} $op, ${duration.inMicroseconds}us'
+        '${at != null ? ' at ${at!.inMicroseconds}us' : ''}'
+        '${bytes != null ? ', $bytes bytes' : ''})';
+  }
+}
@@ -10,11 +10,23 @@ class _FakeCoreBindings implements MontyCoreBindings {
   int initCallCount = 0;
   bool disposeCalled = false;
   String? lastRunCode;
+  String? lastInputsJson;
   String? lastLimitsJson;
   String? lastExtFnsJson;
   String? lastScriptName;
   String? lastValueJson;
   String? lastErrorMessage;
+  String? lastResultsJson;
+  String? lastErrorsJson;
+  int resumeCallCount = 0;
+  int resumeAsFutureCallCount = 0;
+
+  /// Progress results returned in order before falling back to
+  /// [progressResult].
+  final List<CoreProgressResult> progressQueue = [];
+
+  CoreProgressResult _nextProgress() =>
+      progressQueue.isNotEmpty ? progressQueue.removeAt(0) : progressResult!;
 
   @override
   Future<bool> init() async {
@@ -25,10 +37,12 @@ class _FakeCoreBindings implements MontyCoreBindings {
   @override
   Future<CoreRunResult> run(
     String code, {
+    String? inputsJson,
     String? limitsJson,
     String? scriptName,
   }) async {
     lastRunCode = code;
+    lastInputsJson = inputsJson;
     lastLimitsJson = limitsJson;
     lastScriptName = scriptName;
     return runResult!;
@@ -37,21 +51,24 @@ class _FakeCoreBindings implements MontyCoreBindings {
   @override
   Future<CoreProgressResult> start(
     String code, {
+    String? inputsJson,
     String? extFnsJson,
     String? limitsJson,
     String? scriptName,
   }) async {
     lastRunCode = code;
+    lastInputsJson = inputsJson;
     lastExtFnsJson = extFnsJson;
     lastLimitsJson = limitsJson;
     lastScriptName = scriptName;
-    return progressResult!;
+    return _nextProgress();
   }
 
   @override
   Future<CoreProgressResult> resume(String valueJson) async {
     lastValueJson = valueJson;
-    return progressResult!;
+    resumeCallCount++;
+    return _nextProgress();
   }
 
   @override
@@ -59,19 +76,24 @@ class _FakeCoreBindings implements MontyCoreBindings {
     String errorMessage,
   ) async {
     lastErrorMessage = errorMessage;
-    return progressResult!;
+    return _nextProgress();
   }
 
   @override
-  Future<CoreProgressResult> resumeAsFuture() async =>
-      throw UnimplementedError();
+  Future<CoreProgressResult> resumeAsFuture() async {
+    resumeAsFutureCallCount++;
+    return _nextProgress();
+  }
 
   @override
   Future<CoreProgressResult> resolveFutures(
     String resultsJson,
     String errorsJson,
-  ) async =>
-      throw UnimplementedError();
+  ) async {
+    lastResultsJson = resultsJson;
+    lastErrorsJson = errorsJson;
+    return _nextProgress();
+  }
 
   @override
   Future<Uint8List> snapshot() async => throw UnimplementedError();
@@ -94,6 +116,14 @@ class _TestPlatform extends BaseMontyPlatform {
 
   /// Expose protected state transitions for testing.
   void forceActive() => markActive();
+
+  Future<MontyProgress> resumeAsFuture() => resumePendingAsFuture();
+
+  Future<MontyProgress> resolveFutures(
+    Map<int, Object?> results, {
+    Map<int, String>? errors,
+  }) =>
+      resolvePendingFutures(results, errors: errors);
 }
 
 void main() {
@@ -485,15 +515,38 @@ void main() {
       },
     );
 
-    test(
-      'run() rejects non-empty inputs',
-      () async {
-        expect(
-          () => platform.run('code', inputs: {'x': 1}),
-          throwsA(isA<UnsupportedError>()),
-        );
-      },
-    );
+  });
+
+  group('inputs encoding', () {
+    test('run() passes inputs as JSON', () async {
+      fake.runResult = const CoreRunResult(ok: true, usage: usage);
+
+      await platform.run('x + 1', inputs: {'x': 41, 'name': 'a'});
+
+      expect(fake.lastInputsJson, '{"x":41,"name":"a"}');
+    });
+
+    test('start() passes inputs as JSON', () async {
+      fake.progressResult = const CoreProgressResult(
+        state: 'complete',
+        value: 1,
+        usage: usage,
+      );
+
+      await platform.start('x', inputs: {'x': 1});
+
+      expect(fake.lastInputsJson, '{"x":1}');
+    });
+
+    test('null and empty inputs pass null to bindings', () async {
+      fake.runResult = const CoreRunResult(ok: true, usage: usage);
+
+      await platform.run('1');
+      expect(fake.lastInputsJson, isNull);
+
+      await platform.run('1', inputs: {});
+      expect(fake.lastInputsJson, isNull);
+    });
   });
 
   group('limits encoding', () {
@@ -611,6 +664,167 @@ void main() {
     });
   });
 
+  group('callCache', () {
+    CoreProgressResult call(int callId, [List<Object?> args = const [1]]) =>
+        CoreProgressResult(
+          state: 'pending',
+          functionName: 'fetch',
+          arguments: args,
+          callId: callId,
+        );
+
+    const complete = CoreProgressResult(state: 'complete', usage: usage);
+
+    test('answers a repeated call from the cache', () async {
+      final cache = MontyCallCache({'fetch': const MontyCallPolicy()});
+      platform.callCache = cache;
+      fake.progressQueue.addAll([call(1), call(2), complete]);
+
+      final first = await platform.start('code');
+      expect(first, isA<MontyPending>());
+      final progress = await platform.resume('a');
+
+      expect(progress, isA<MontyComplete>());
+      expect(fake.resumeCallCount, 2);
+      expect(fake.lastValueJson, json.encode('a'));
+      expect(cache.hits, 1);
+    });
+
+    test('passes calls with other arguments to the host', () async {
+      platform.callCache = MontyCallCache({
+        'fetch': const MontyCallPolicy(),
+      });
+      fake.progressQueue.addAll([call(1), call(2, [2])]);
+
+      await platform.start('code');
+      final progress = await platform.resume('a');
+
+      expect(progress, isA<MontyPending>());
+      expect((progress as MontyPending).callId, 2);
+      expect(fake.resumeCallCount, 1);
+    });
+
+    test('remembers nothing from resumeWithError', () async {
+      final cache = MontyCallCache({'fetch': const MontyCallPolicy()});
+      platform.callCache = cache;
+      fake.progressQueue.addAll([call(1), call(2)]);
+
+      await platform.start('code');
+      final progress = await platform.resumeWithError('boom');
+
+      expect(progress, isA<MontyPending>());
+      expect(cache.length, 0);
+    });
+
+    test('shares one host future between identical calls', () async {
+      final cache = MontyCallCache({
+        'fetch': const MontyCallPolicy(asFuture: true),
+      });
+      platform.callCache = cache;
+      fake.progressQueue.addAll([
+        call(1),
+        call(2),
+        const CoreProgressResult(
+          state: 'resolve_futures',
+          pendingCallIds: [1, 2],
+        ),
+        complete,
+      ]);
+
+      await platform.start('code');
+      final progress = await platform.resumeAsFuture();
+
+      expect(fake.resumeAsFutureCallCount, 2);
+      expect(
+        (progress as MontyResolveFutures).pendingCallIds,
+        [1],
+      );
+
+      final done = await platform.resolveFutures({1: 'r'});
+
+      expect(done, isA<MontyComplete>());
+      expect(json.decode(fake.lastResultsJson!), {'1': 'r', '2': 'r'});
+      expect(cache.length, 1);
+    });
+
+    test('resolves remembered futures without the host', () async {
+      platform.callCache = MontyCallCache({
+        'fetch': const MontyCallPolicy(asFuture: true),
+      });
+      fake.progressQueue.addAll([
+        call(1),
+        const CoreProgressResult(
+          state: 'resolve_futures',
+          pendingCallIds: [1],
+        ),
+        complete,
+        call(1),
+        const CoreProgressResult(
+          state: 'resolve_futures',
+          pendingCallIds: [1],
+        ),
+        complete,
+      ]);
+
+      await platform.start('first');
+      await platform.resumeAsFuture();
+      await platform.resolveFutures({1: 'r'});
+
+      final progress = await platform.start('second');
+
+      expect(progress, isA<MontyComplete>());
+      expect(json.decode(fake.lastResultsJson!), {'1': 'r'});
+    });
+
+    test('passes a host error on to shared futures', () async {
+      final cache = MontyCallCache({
+        'fetch': const MontyCallPolicy(asFuture: true),
+      });
+      platform.callCache = cache;
+      fake.progressQueue.addAll([
+        call(1),
+        call(2),
+        const CoreProgressResult(
+          state: 'resolve_futures',
+          pendingCallIds: [1, 2],
+        ),
+        complete,
+      ]);
+
+      await platform.start('code');
+      await platform.resumeAsFuture();
+      await platform.resolveFutures({}, errors: {1: 'boom'});
+
+      expect(
+        json.decode(fake.lastErrorsJson!),
+        {'1': 'boom', '2': 'boom'},
+      );
+      expect(cache.length, 0);
+    });
+
+    test('forgets in-flight futures when the execution fails', () async {
+      platform.callCache = MontyCallCache({
+        'fetch': const MontyCallPolicy(asFuture: true),
+      });
+      fake.progressQueue.addAll([
+        call(1),
+        const CoreProgressResult(state: 'error', error: 'boom'),
+        call(1),
+      ]);
+
+      await platform.start('first');
+      await expectLater(
+        platform.resumeAsFuture,
+        throwsA(isA<MontyException>()),
+      );
+
+      final progress = await platform.start('second');
+
+      expect(progress, isA<MontyPending>());
+      expect(fake.resumeAsFutureCallCount, 1);
+    });
+  });
+
   group('unknown progress state', () {
     test('throws StateError', () async {
       fake.progressResult = const CoreProgressResult(
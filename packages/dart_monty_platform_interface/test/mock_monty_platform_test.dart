@@ -16,5 +16,24 @@ void main() {
       MontyPlatform.instance = mock;
       expect(MontyPlatform.instance, mock);
     });
+
+    test('output emits what is added to outputController', () async {
+      final chunks = mock.output.take(2).toList();
+      mock.outputController
+        ..add('a\n')
+        ..add('b\n');
+      expect(await chunks, ['a\n', 'b\n']);
+    });
+
+    test('trace emits what is added to traceController', () async {
+      const event = MontyTraceEvent(
+        kind: MontyTraceKind.vm,
+        op: 'run',
+        duration: Duration(microseconds: 5),
+      );
+      final events = mock.trace.first;
+      mock.traceController.add(event);
+      expect(await events, event);
+    });
   });
 }
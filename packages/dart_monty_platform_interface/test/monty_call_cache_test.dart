@@ -0,0 +1,132 @@
+import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
+import 'package:test/test.dart';
+
+MontyPending _call(
+  String name, [
+  List<Object?> args = const [],
+  Map<String, Object?>? kwargs,
+]) =>
+    MontyPending(functionName: name, arguments: args, kwargs: kwargs);
+
+void main() {
+  group('MontyCallCache', () {
+    test('keys only functions with a policy', () {
+      final cache = MontyCallCache({'fetch': const MontyCallPolicy()});
+      expect(cache.keyOf(_call('fetch', [1])), isNotNull);
+      expect(cache.keyOf(_call('other', [1])), isNull);
+    });
+
+    test('keys ignore dict key order', () {
+      final cache = MontyCallCache({'fetch': const MontyCallPolicy()});
+      final a = cache.keyOf(
+        _call('fetch', [
+          {'b': 1, 'a': 2},
+        ], {
+          'y': true,
+          'x': null,
+        }),
+      );
+      final b = cache.keyOf(
+        _call('fetch', [
+          {'a': 2, 'b': 1},
+        ], {
+          'x': null,
+          'y': true,
+        }),
+      );
+      expect(a, b);
+      expect(a.hashCode, b.hashCode);
+    });
+
+    test('keys tell apart values of different types', () {
+      final cache = MontyCallCache({'fetch': const MontyCallPolicy()});
+      final keys = {
+        for (final arg in <Object?>[1, 2.5, '1', true, null, double.nan])
+          cache.keyOf(_call('fetch', [arg])),
+      };
+      expect(keys, hasLength(6));
+      expect(
+        cache.keyOf(_call('fetch', [1, 2])),
+        isNot(cache.keyOf(_call('fetch', [
+          [1, 2],
+        ]))),
+      );
+    });
+
+    test('lookup returns stored values, including null', () {
+      final cache = MontyCallCache({'fetch': const MontyCallPolicy()});
+      final key = cache.keyOf(_call('fetch', [1]))!;
+      expect(cache.lookup(key), isNull);
+      cache.store(key, null);
+      expect(cache.lookup(key), (value: null));
+      expect(cache.hits, 1);
+      expect(cache.misses, 1);
+    });
+
+    test('entries expire after their ttl', () {
+      var now = DateTime(2026);
+      final cache = MontyCallCache(
+        {'fetch': const MontyCallPolicy(ttl: Duration(seconds: 10))},
+        clock: () => now,
+      );
+      final key = cache.keyOf(_call('fetch'))!;
+      cache.store(key, 'a');
+      now = now.add(const Duration(seconds: 9));
+      expect(cache.lookup(key), (value: 'a'));
+      now = now.add(const Duration(seconds: 1));
+      expect(cache.lookup(key), isNull);
+      expect(cache.length, 0);
+    });
+
+    test('evicts the least recently used entry', () {
+      final cache = MontyCallCache({
+        'fetch': const MontyCallPolicy(maxEntries: 2),
+      });
+      final keys = [
+        for (var i = 0; i < 3; i++) cache.keyOf(_call('fetch', [i]))!,
+      ];
+      cache
+        ..store(keys[0], 0)
+        ..store(keys[1], 1);
+      expect(cache.lookup(keys[0]), isNotNull);
+      cache.store(keys[2], 2);
+      expect(cache.lookup(keys[1]), isNull);
+      expect(cache.lookup(keys[0]), (value: 0));
+      expect(cache.lookup(keys[2]), (value: 2));
+    });
+
+    test('ignores stores for functions without a policy', () {
+      final cache = MontyCallCache({'fetch': const MontyCallPolicy()});
+      final other = MontyCallCache({'other': const MontyCallPolicy()});
+      cache.store(other.keyOf(_call('other'))!, 1);
+      expect(cache.length, 0);
+    });
+
+    test('clear forgets one function or all', () {
+      final cache = MontyCallCache({
+        'a': const MontyCallPolicy(),
+        'b': const MontyCallPolicy(),
+      });
+      cache
+        ..store(cache.keyOf(_call('a'))!, 1)
+        ..store(cache.keyOf(_call('b'))!, 2);
+      cache.clear('a');
+      expect(cache.length, 1);
+      cache.clear();
+      expect(cache.length, 0);
+    });
+  });
+
+  group('MontyCallPolicy', () {
+    test('equality', () {
+      expect(
+        const MontyCallPolicy(ttl: Duration(seconds: 1), asFuture: true),
+        const MontyCallPolicy(ttl: Duration(seconds: 1), asFuture: true),
+      );
+      expect(
+        const MontyCallPolicy(maxEntries: 1),
+        isNot(const MontyCallPolicy()),
+      );
+    });
+  });
+}
@@ -0,0 +1,91 @@
+import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
+import 'package:test/test.dart';
+
+void main() {
+  const nativeJson = {
+    'state': 'pending',
+    'heap_bytes': 4096,
+    'peak_heap_bytes': 8192,
+    'memory_limit': null,
+    'live_allocations': 12,
+    'allocations': 40,
+    'live_by_size': [
+      {'max_bytes': 16, 'count': 10},
+      {'max_bytes': null, 'count': 2},
+    ],
+    'stack_depth': 3,
+    'max_stack_depth': 5,
+    'stack_limit': 100,
+    'time_elapsed_ms': 7,
+    'pending': {
+      'function_name': 'fetch',
+      'call_id': 1,
+      'args': [
+        {'type': 'list', 'len': 200},
+      ],
+      'kwargs': [
+        {'name': 'timeout', 'type': 'int', 'len': null},
+      ],
+    },
+  };
+
+  group('MontyInspection', () {
+    test('fromJson parses a native inspection', () {
+      final inspection = MontyInspection.fromJson(nativeJson);
+      expect(inspection.state, 'pending');
+      expect(inspection.heapBytes, 4096);
+      expect(inspection.peakHeapBytes, 8192);
+      expect(inspection.memoryLimit, isNull);
+      expect(inspection.liveAllocations, 12);
+      expect(inspection.allocations, 40);
+      expect(inspection.liveBySize, const [
+        MontyHeapBucket(maxBytes: 16, count: 10),
+        MontyHeapBucket(count: 2),
+      ]);
+      expect(inspection.stackDepth, 3);
+      expect(inspection.maxStackDepth, 5);
+      expect(inspection.stackLimit, 100);
+      expect(inspection.timeElapsedMs, 7);
+
+      final call = inspection.pendingCall!;
+      expect(call.functionName, 'fetch');
+      expect(call.callId, 1);
+      expect(
+        call.arguments,
+        const [MontyValueShape(type: 'list', length: 200)],
+      );
+      expect(call.kwargs, const {'timeout': MontyValueShape(type: 'int')});
+    });
+
+    test('fromJson leaves pendingCall null when not paused at a call', () {
+      final inspection = MontyInspection.fromJson({
+        ...nativeJson,
+        'state': 'complete',
+        'pending': null,
+        'live_by_size': <Object>[],
+      });
+      expect(inspection.pendingCall, isNull);
+      expect(inspection.liveBySize, isEmpty);
+    });
+
+    test('toJson round-trips', () {
+      final inspection = MontyInspection.fromJson(nativeJson);
+      expect(inspection.toJson(), nativeJson);
+      expect(MontyInspection.fromJson(inspection.toJson()), inspection);
+      expect(
+        MontyInspection.fromJson(inspection.toJson()).hashCode,
+        inspection.hashCode,
+      );
+    });
+
+    test('toString summarizes', () {
+      final inspection = MontyInspection.fromJson(nativeJson);
+      expect(inspection.toString(), contains('pending'));
+      expect(inspection.toString(), contains('fetch'));
+      expect(
+        const MontyValueShape(type: 'list', length: 2).toString(),
+        'list[2]',
+      );
+    });
+  });
+}
@@ -4,6 +4,31 @@ import 'package:test/test.dart';
 /// A valid platform implementation that extends MontyPlatform.
 class _TestMontyPlatform extends MontyPlatform {}
 
+/// A platform whose [run] doubles `x`, failing when it is negative.
+class _RunOnlyMontyPlatform extends MontyPlatform {
+  final List<Map<String, Object?>?> runInputs = [];
+
+  @override
+  Future<MontyResult> run(
+    String code, {
+    Map<String, Object?>? inputs,
+    MontyLimits? limits,
+    String? scriptName,
+  }) async {
+    runInputs.add(inputs);
+    final x = inputs!['x']! as int;
+    if (x < 0) throw const MontyException(message: 'negative');
+
+    return MontyResult(value: x * 2, usage: _usage);
+  }
+}
+
+const _usage = MontyResourceUsage(
+  memoryBytesUsed: 1,
+  timeElapsedMs: 1,
+  stackDepthUsed: 1,
+);
+
 /// An invalid implementation using `implements` instead of `extends`.
 class _ImplementsMontyPlatform implements MontyPlatform {
   // Provide a noSuchMethod so we don't need stubs for everything.
@@ -102,5 +127,54 @@ void main() {
         );
       });
     });
+
+    test('output defaults to an empty stream', () async {
+      expect(await _TestMontyPlatform().output.isEmpty, isTrue);
+    });
+
+    test('trace defaults to an empty stream', () async {
+      expect(await _TestMontyPlatform().trace.isEmpty, isTrue);
+    });
+
+    test('cancel defaults to a no-op', () async {
+      await expectLater(_TestMontyPlatform().cancel(), completes);
+    });
+
+    group('runBatch default', () {
+      test('runs each input set in order', () async {
+        final platform = _RunOnlyMontyPlatform();
+        final results = await platform.runBatch('x * 2', [
+          {'x': 1},
+          {'x': 2},
+        ]);
+        expect(results.map((r) => r.value), [2, 4]);
+        expect(platform.runInputs, [
+          {'x': 1},
+          {'x': 2},
+        ]);
+      });
+
+      test('turns a MontyException into an error result', () async {
+        final results = await _RunOnlyMontyPlatform().runBatch('x * 2', [
+          {'x': -1},
+          {'x': 3},
+        ]);
+        expect(results.first.isError, isTrue);
+        expect(results.first.error?.message, 'negative');
+        expect(results.first.usage.timeElapsedMs, 0);
+        expect(results.last.value, 6);
+      });
+
+      test('returns nothing for no input sets', () async {
+        expect(await _RunOnlyMontyPlatform().runBatch('x', []), isEmpty);
+      });
+
+      test('propagates other errors', () async {
+        await expectLater(
+          _TestMontyPlatform().runBatch('x', [{}]),
+          throwsUnimplementedError,
+        );
+      });
+    });
   });
 }
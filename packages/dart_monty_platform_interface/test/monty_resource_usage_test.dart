@@ -16,6 +16,68 @@ void main() {
       });
     });
 
+    group('optional metered fields', () {
+      test('fromJson parses allocations and cpu_time_ms', () {
+        final usage = MontyResourceUsage.fromJson(const {
+          'memory_bytes_used': 2048,
+          'time_elapsed_ms': 100,
+          'stack_depth_used': 5,
+          'allocations': 12,
+          'cpu_time_ms': 90,
+        });
+        expect(usage.allocations, 12);
+        expect(usage.cpuTimeMs, 90);
+      });
+
+      test('fromJson leaves them null when absent or null', () {
+        final usage = MontyResourceUsage.fromJson(const {
+          'memory_bytes_used': 0,
+          'time_elapsed_ms': 0,
+          'stack_depth_used': 0,
+          'cpu_time_ms': null,
+        });
+        expect(usage.allocations, isNull);
+        expect(usage.cpuTimeMs, isNull);
+      });
+
+      test('toJson, equality, and toString include them when set', () {
+        const usage = MontyResourceUsage(
+          memoryBytesUsed: 1,
+          timeElapsedMs: 2,
+          stackDepthUsed: 3,
+          allocations: 4,
+          cpuTimeMs: 5,
+        );
+        expect(usage.toJson(), {
+          'memory_bytes_used': 1,
+          'time_elapsed_ms': 2,
+          'stack_depth_used': 3,
+          'allocations': 4,
+          'cpu_time_ms': 5,
+        });
+        expect(MontyResourceUsage.fromJson(usage.toJson()), usage);
+        expect(
+          usage,
+          isNot(
+            const MontyResourceUsage(
+              memoryBytesUsed: 1,
+              timeElapsedMs: 2,
+              stackDepthUsed: 3,
+            ),
+          ),
+        );
+        expect(
+          usage.toString(),
+          'MontyResourceUsage('
+          'memoryBytesUsed: 1, '
+          'timeElapsedMs: 2, '
+          'stackDepthUsed: 3, '
+          'allocations: 4, '
+          'cpuTimeMs: 5)',
+        );
+      });
+    });
+
     group('toJson', () {
       test('serializes all fields', () {
         const usage = MontyResourceUsage(
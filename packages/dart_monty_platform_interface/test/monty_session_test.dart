@@ -552,14 +552,110 @@ void main() {
           expect(persisted['var_$i'], i);
         }
 
-        // Second run restores all 100
-        _enqueueRunCycle(mock, stateToPersist: largeState);
-        await session.run('# read them back');
+        // Second run restores only the two it reads
+        _enqueueRunCycle(mock, stateToPersist: {'var_3': 3, 'var_7': 7});
+        await session.run('var_3 + var_7');
 
-        // Verify restore received the full state
         final restoreArg = mock.resumeReturnValues[2];
-        expect(restoreArg, isA<Map<String, Object?>>());
-        expect((restoreArg! as Map<String, Object?>).length, 100);
+        expect(restoreArg, {'var_3': 3, 'var_7': 7});
+        expect(session.state.length, 100);
+      });
+
+      test('restores and persists only referenced names', () async {
+        _enqueueRunCycle(mock, stateToPersist: {'big': [1, 2, 3], 'n': 1});
+        await session.run('big = [1, 2, 3]\nn = 1');
+
+        _enqueueRunCycle(mock, stateToPersist: {'n': 2});
+        await session.run('n = n + 1');
+
+        final code = mock.lastStartCode!;
+        expect(code, contains('n = __d["n"]'));
+        expect(code, isNot(contains('big')));
+        expect(mock.resumeReturnValues[2], {'n': 1});
+        expect(session.state, {'big': [1, 2, 3], 'n': 2});
+      });
+
+      test('writes back only names the code may change', () async {
+        _enqueueRunCycle(mock, stateToPersist: {'big': [1, 2], 'n': 1});
+        await session.run('big = [1, 2]\nn = 1');
+
+        _enqueueRunCycle(mock, stateToPersist: {'total': 3});
+        await session.run('total = n + 2\nn > 0');
+
+        var code = mock.lastStartCode!;
+        expect(code, contains('n = __d["n"]'));
+        expect(code, isNot(contains('__d2["n"]')));
+        expect(code, contains('__d2["total"] = total'));
+        expect(session.state, {'big': [1, 2], 'n': 1, 'total': 3});
+
+        _enqueueRunCycle(mock, stateToPersist: {'big': [1, 2, 3]});
+        await session.run('big.append(3)');
+
+        code = mock.lastStartCode!;
+        expect(code, contains('__d2["big"] = big'));
+        expect(session.state['big'], [1, 2, 3]);
+      });
+
+      test('writes back a list mutated through a loop variable', () async {
+        _enqueueRunCycle(mock, stateToPersist: {
+          'rows': [
+            [1],
+            [2],
+          ],
+        });
+        await session.run('rows = [[1], [2]]');
+
+        _enqueueRunCycle(mock, stateToPersist: {
+          'rows': [
+            [1, 0],
+            [2, 0],
+          ],
+        });
+        await session.run('for r in rows:\n    r.append(0)');
+
+        expect(mock.lastStartCode, contains('__d2["rows"] = rows'));
+        expect(session.state['rows'], [
+          [1, 0],
+          [2, 0],
+        ]);
+      });
+
+      test('writes back a list mutated through an alias', () async {
+        _enqueueRunCycle(mock, stateToPersist: {'data': [1, 2]});
+        await session.run('data = [1, 2]');
+
+        _enqueueRunCycle(mock, stateToPersist: {
+          'data': [1, 2, 3],
+          'a': [1, 2, 3],
+        });
+        await session.run('a = data\na.append(3)');
+
+        expect(mock.lastStartCode, contains('__d2["data"] = data'));
+        expect(session.state['data'], [1, 2, 3]);
+      });
+
+      test('writes back a scalar rebound inside a block', () async {
+        _enqueueRunCycle(mock, stateToPersist: {'n': 1, 's': 'a'});
+        await session.run('n = 1\ns = "a"');
+
+        _enqueueRunCycle(mock, stateToPersist: {'n': 3, 's': 'a'});
+        await session.run('for i in range(2):\n    n += 1\nprint(s)');
+
+        final code = mock.lastStartCode!;
+        expect(code, contains('__d2["n"] = n'));
+        expect(code, isNot(contains('__d2["s"]')));
+        expect(session.state, {'n': 3, 's': 'a'});
+      });
+
+      test('drops a persisted name missing from the persist dict', () async {
+        _enqueueRunCycle(mock, stateToPersist: {'x': 1, 'y': 2});
+        await session.run('x = 1\ny = 2');
+
+        // `del x` leaves x out of the dict the postamble builds.
+        _enqueueRunCycle(mock, stateToPersist: {});
+        await session.run('del x');
+
+        expect(session.state, {'y': 2});
       });
 
       test('dunder and underscore variables excluded', () async {
@@ -611,6 +707,58 @@ void main() {
       });
     });
 
+    group('resident', () {
+      late _MockReplPlatform repl;
+
+      setUp(() {
+        repl = _MockReplPlatform();
+        session = MontySession(platform: repl, resident: true);
+      });
+
+      test('requires a MontyReplCapable platform', () {
+        expect(
+          () => MontySession(platform: mock, resident: true),
+          throwsArgumentError,
+        );
+      });
+
+      test('feeds code unwrapped, without copying state', () async {
+        repl.nextFeedResult = const MontyResult(value: 3, usage: _usage);
+        final result = await session.run('data = list(range(3))\nlen(data)');
+
+        expect(result.value, 3);
+        expect(repl.feedCalls, ['data = list(range(3))\nlen(data)']);
+        expect(repl.startCodes, isEmpty);
+        expect(session.state, isEmpty);
+      });
+
+      test('returns a raised error as a result', () async {
+        repl.nextFeedError = const MontyException(message: 'NameError: x');
+        final result = await session.run('x');
+
+        expect(result.error?.message, 'NameError: x');
+      });
+
+      test('clearState() resets the REPL before the next call', () async {
+        await session.run('x = 1');
+        session.clearState();
+        expect(repl.resetSessionCalls, 0);
+
+        await session.run('y = 2');
+        expect(repl.resetSessionCalls, 1);
+
+        await session.run('y');
+        expect(repl.resetSessionCalls, 1);
+      });
+
+      test('start() is unsupported', () {
+        expect(
+          () => session.start('f()', externalFunctions: ['f']),
+          throwsUnsupportedError,
+        );
+      });
+    });
+
     group('result capture (_captureLastExpression)', () {
       test('captures bare expression as last line', () async {
         _enqueueRunCycle(mock, stateToPersist: {'x': 42}, resultValue: 43);
@@ -791,3 +939,37 @@ void _enqueueRunCycle(
       ),
     );
 }
+
+/// A [MockMontyPlatform] that also records REPL feeds.
+class _MockReplPlatform extends MockMontyPlatform implements MontyReplCapable {
+  /// The result returned by the next [feed].
+  MontyResult nextFeedResult = const MontyResult(usage: _usage);
+
+  /// If set, the next [feed] throws it instead, once.
+  MontyException? nextFeedError;
+
+  /// The code passed to each [feed].
+  final List<String> feedCalls = [];
+
+  /// Call count for [resetSession].
+  int resetSessionCalls = 0;
+
+  @override
+  Future<MontyResult> feed(
+    String code, {
+    MontyLimits? limits,
+    String? scriptName,
+  }) async {
+    feedCalls.add(code);
+    final error = nextFeedError;
+    nextFeedError = null;
+    if (error != null) throw error;
+
+    return nextFeedResult;
+  }
+
+  @override
+  Future<void> resetSession() async {
+    resetSessionCalls++;
+  }
+}
@@ -0,0 +1,71 @@
+import 'package:dart_monty_platform_interface/dart_monty_platform_interface.dart';
+import 'package:test/test.dart';
+
+void main() {
+  group('MontyTraceEvent', () {
+    test('fromJson parses a native conversion event', () {
+      final event = MontyTraceEvent.fromJson(const {
+        'kind': 'convert',
+        'op': 'args_bin',
+        'at_us': 120,
+        'duration_us': 4,
+        'bytes': 32,
+      });
+      expect(event, isNotNull);
+      expect(event!.kind, MontyTraceKind.convert);
+      expect(event.op, 'args_bin');
+      expect(event.at, const Duration(microseconds: 120));
+      expect(event.duration, const Duration(microseconds: 4));
+      expect(event.bytes, 32);
+    });
+
+    test('fromJson leaves at and bytes null when absent', () {
+      final event = MontyTraceEvent.fromJson(const {
+        'kind': 'vm',
+        'op': 'start',
+        'duration_us': 10,
+      });
+      expect(event!.at, isNull);
+      expect(event.bytes, isNull);
+    });
+
+    test('fromJson returns null for an unknown kind', () {
+      final event = MontyTraceEvent.fromJson(const {
+        'kind': 'gc',
+        'op': 'collect',
+        'duration_us': 1,
+      });
+      expect(event, isNull);
+    });
+
+    test('toJson round-trips and equality holds', () {
+      const event = MontyTraceEvent(
+        kind: MontyTraceKind.host,
+        op: 'resume',
+        duration: Duration(milliseconds: 3),
+        at: Duration(microseconds: 50),
+      );
+      expect(event.toJson(), {
+        'kind': 'host',
+        'op': 'resume',
+        'duration_us': 3000,
+        'at_us': 50,
+      });
+      expect(MontyTraceEvent.fromJson(event.toJson()), event);
+      expect(event.hashCode, MontyTraceEvent.fromJson(event.toJson()).hashCode);
+    });
+
+    test('toString names the kind, op and duration', () {
+      const event = MontyTraceEvent(
+        kind: MontyTraceKind.convert,
+        op: 'result_json',
+        duration: Duration(microseconds: 7),
+        bytes: 18,
+      );
+      expect(
+        event.toString(),
+        'MontyTraceEvent(convert result_json, 7us, 18 bytes)',
+      );
+    });
+  });
+}
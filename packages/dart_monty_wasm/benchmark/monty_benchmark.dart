@@ -0,0 +1,21 @@
+/// Benchmarks the WASM backend in the browser.
+///
+/// Compiled to JS and run in headless Chrome with COOP/COEP headers by
+/// tool/bench.sh. Scores are printed to the console.
+///
+/// Build:
+///   dart compile js benchmark/monty_benchmark.dart \
+///     -o benchmark/web/monty_benchmark.dart.js
+library;
+
+import 'package:dart_monty_wasm/dart_monty_wasm.dart';
+
+import '../../dart_monty_platform_interface/benchmark/monty_benchmarks.dart';
+
+Future<void> main() async {
+  await runMontyBenchmarks(
+    'wasm',
+    () => MontyWasm(bindings: WasmBindingsJs()),
+  );
+  print('BENCH_DONE');
+}
@@ -3,7 +3,8 @@
  * build.js — Bundles dart_monty_wasm JS bridge and Worker.
  *
  * 1. esbuild worker_src.js → ../assets/dart_monty_worker.js (ESM)
- * 2. Patch bare specifier for sub-worker URL
+ * 2. Patch bare specifier for sub-worker URL, and the WASM fetch so pooled
+ *    Workers instantiate the Module compiled once by the bridge
  * 3. esbuild bridge.js → ../assets/dart_monty_bridge.js (IIFE)
  * 4. Copy wasi-worker-browser.mjs → ../assets/
  * 5. Copy .wasm binary → ../assets/
@@ -39,8 +40,22 @@ workerSrc = workerSrc.replace(
   /new URL\("@pydantic\/monty-wasm32-wasi\/wasi-worker-browser\.mjs"/g,
   'new URL("./wasi-worker-browser.mjs"',
 );
+// Instantiate from the Module posted by bridge.js (see wasm_module.js),
+// falling back to the loader's own fetch when none was sent.
+const wasmFetch = /await fetch\((\w+)\)\.then\(\(res\) => res\.arrayBuffer\(\)\)/;
+if (wasmFetch.test(workerSrc)) {
+  workerSrc = workerSrc.replace(
+    wasmFetch,
+    'await self.__montyWasmModule.then((m) => m ?? fetch($1).then((res) => res.arrayBuffer()))',
+  );
+} else {
+  console.warn('[build] WARN: WASM fetch not found; Workers will each compile the binary.');
+}
 fs.writeFileSync(workerPath, workerSrc);
 
+const wasmDir = path.join(NODE_MODULES, '@pydantic', 'monty-wasm32-wasi');
+const wasmFiles = fs.readdirSync(wasmDir).filter((f) => f.endsWith('.wasm'));
+
 // Step 3: Bundle bridge (IIFE)
 console.log('[build] Bundling bridge...');
 execSync(
@@ -48,6 +63,7 @@ execSync(
     `--bundle --format=iife ` +
     `--outfile=${path.join(ASSETS, 'dart_monty_bridge.js')} ` +
     `--platform=browser ` +
+    `--define:__MONTY_WASM_FILE__='${JSON.stringify(wasmFiles[0] || 'monty.wasm32-wasi.wasm')}' ` +
     `--log-level=warning`,
   { cwd: __dirname, stdio: 'inherit' },
 );
@@ -68,8 +84,6 @@ if (fs.existsSync(wasiWorkerSrc)) {
 
 // Step 5: Copy .wasm binary
 console.log('[build] Copying WASM binary...');
-const wasmDir = path.join(NODE_MODULES, '@pydantic', 'monty-wasm32-wasi');
-const wasmFiles = fs.readdirSync(wasmDir).filter((f) => f.endsWith('.wasm'));
 for (const wasmFile of wasmFiles) {
   fs.copyFileSync(path.join(wasmDir, wasmFile), path.join(ASSETS, wasmFile));
   console.log(`  Copied ${wasmFile}`);
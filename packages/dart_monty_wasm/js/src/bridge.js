@@ -1,94 +1,252 @@
 /**
- * bridge.js — Main-thread bridge between Dart JS interop and Monty WASM Worker.
+ * bridge.js — Main-thread bridge between Dart JS interop and the Monty
+ * WASM Workers.
  *
  * Exposes window.DartMontyBridge with methods Dart calls via dart:js_interop.
- * The Worker (dart_monty_worker.js) hosts the actual Monty WASM runtime.
+ * A pool of Workers (dart_monty_worker.js) hosts the Monty WASM runtime; the
+ * WebAssembly.Module is compiled once here and shared with every Worker.
+ *
+ * Each caller owns a session (see createSession). A session that is paused
+ * at an external call or waiting on futures is pinned to the Worker
+ * holding its snapshot until it completes, fails, or is disposed;
+ * everything else goes to the least busy Worker, so independent
+ * executions run in parallel.
  */
 
-let worker = null;
+import { DEFAULT_WAIT_MS, createChannel, offer } from './sync_channel.js';
+
+/* global __MONTY_WASM_FILE__ */
+const WASM_FILE = typeof __MONTY_WASM_FILE__ !== 'undefined'
+  ? __MONTY_WASM_FILE__
+  : 'monty.wasm32-wasi.wasm';
+
+/** Session used by callers that do not pass a session ID. */
+const DEFAULT_SESSION = 0;
+
+let workers = null; // [{ worker, busy, channel }]
+let initPromise = null;
 let nextId = 1;
-const pending = new Map(); // id -> { resolve, reject }
+let nextSessionId = DEFAULT_SESSION + 1;
+const pending = new Map(); // id -> { resolve, reject, entry }
+const pinned = new Map(); // sessionId -> worker entry
+
+/**
+ * Compile the Monty WASM binary once for all Workers.
+ *
+ * @returns {Promise<WebAssembly.Module|null>} null if it cannot be compiled
+ *   here, in which case each Worker fetches and compiles it itself.
+ */
+async function compileModule() {
+  try {
+    const url = new URL(`./${WASM_FILE}`, window.location.href);
+    return await WebAssembly.compileStreaming(fetch(url));
+  } catch (e) {
+    console.warn('[DartMontyBridge] Shared compile failed, Workers will compile:', e.message);
+    return null;
+  }
+}
 
 /**
- * Initialize the Monty Worker.
+ * Spawn one Worker and wait until it has loaded the runtime.
  *
- * @returns {Promise<boolean>} true if Worker loaded WASM successfully.
+ * @param {WebAssembly.Module|null} module Shared compiled module.
+ * @param {number} syncWaitMs How long a paused Worker waits on its
+ *   shared-memory channel (see sync_channel.js); 0 for no channel.
+ * @returns {Promise<object|null>} The Worker entry, or null on failure.
  */
-async function init() {
-  if (worker) return true;
+function spawnWorker(module, syncWaitMs) {
   return new Promise((resolve) => {
+    let worker;
     try {
       worker = new Worker(
         new URL('./dart_monty_worker.js', window.location.href),
         { type: 'module' },
       );
+    } catch (e) {
+      console.error('[DartMontyBridge] Failed to create Worker:', e.message);
+      resolve(null);
+      return;
+    }
+    const channel = syncWaitMs > 0 ? createChannel() : null;
+    const entry = { worker, busy: 0, channel };
 
-      worker.onmessage = (e) => {
-        const msg = e.data;
+    worker.onmessage = (e) => {
+      const msg = e.data;
 
-        if (msg.type === 'ready') {
-          console.log('[DartMontyBridge] Worker ready');
-          resolve(true);
-          return;
-        }
+      if (msg.type === 'ready') {
+        resolve(entry);
+        return;
+      }
 
-        if (msg.type === 'error' && !msg.id) {
-          console.error('[DartMontyBridge] Worker init error:', msg.message);
-          resolve(false);
-          return;
-        }
+      if (msg.type === 'error' && !msg.id) {
+        console.error('[DartMontyBridge] Worker init error:', msg.message);
+        resolve(null);
+        return;
+      }
 
-        // Route responses to pending promises
-        if (msg.id && pending.has(msg.id)) {
-          const { resolve: res } = pending.get(msg.id);
-          pending.delete(msg.id);
-          res(msg);
-        }
-      };
+      // Route responses to pending promises
+      if (msg.id && pending.has(msg.id)) {
+        const { resolve: res } = pending.get(msg.id);
+        pending.delete(msg.id);
+        entry.busy--;
+        res(msg);
+      }
+    };
 
-      worker.onerror = (err) => {
-        console.error('[DartMontyBridge] Worker error:', err.message || err);
-        for (const [, { reject }] of pending) {
-          reject(err);
+    worker.onerror = (err) => {
+      console.error('[DartMontyBridge] Worker error:', err.message || err);
+      for (const [id, p] of pending) {
+        if (p.entry === entry) {
+          pending.delete(id);
+          p.reject(err);
         }
-        pending.clear();
-        resolve(false);
-      };
-    } catch (e) {
-      console.error('[DartMontyBridge] Failed to create Worker:', e.message);
-      resolve(false);
-    }
+      }
+      for (const [sessionId, e] of pinned) {
+        if (e === entry) pinned.delete(sessionId);
+      }
+      if (workers) workers = workers.filter((w) => w !== entry);
+      resolve(null);
+    };
+
+    worker.postMessage({
+      type: 'module',
+      module,
+      syncChannel: channel,
+      syncWaitMs,
+    });
   });
 }
 
 /**
- * Send a message to the Worker and wait for a response.
+ * Initialize the Worker pool.
+ *
+ * Safe to call more than once; later calls (with any options) reuse the
+ * pool created by the first.
+ *
+ * @param {number} poolSize Number of Workers (optional). Defaults to
+ *   navigator.hardwareConcurrency, capped at 4.
+ * @param {number} syncWaitMs How long a Worker paused at an external call
+ *   blocks waiting for the answer over shared memory before going back to
+ *   its message queue (optional, default 20). Only used when the page is
+ *   cross-origin isolated; 0 turns the channel off.
+ * @returns {Promise<boolean>} true if at least one Worker loaded WASM.
+ */
+async function init(poolSize, syncWaitMs) {
+  if (!initPromise) {
+    initPromise = (async () => {
+      const size = Math.max(1, poolSize || Math.min(navigator.hardwareConcurrency || 1, 4));
+      const waitMs = syncWaitMs ?? DEFAULT_WAIT_MS;
+      const module = await compileModule();
+      const entries = await Promise.all(
+        Array.from({ length: size }, () => spawnWorker(module, waitMs)),
+      );
+      workers = entries.filter((e) => e !== null);
+      console.log(`[DartMontyBridge] ${workers.length} Worker(s) ready`);
+      return workers.length > 0;
+    })();
+  }
+  return initPromise;
+}
+
+/**
+ * Allocate a session ID. Pass it to every other call so that concurrent
+ * callers do not share interpreter state.
+ *
+ * @returns {number} A new session ID.
+ */
+function createSession() {
+  return nextSessionId++;
+}
+
+function sessionOf(sessionId) {
+  return sessionId == null ? DEFAULT_SESSION : sessionId;
+}
+
+/** Message for a pool that never started or lost every Worker. */
+const NO_WORKERS = 'No Monty Workers are running';
+
+function leastBusy() {
+  if (!workers?.length) throw new Error(NO_WORKERS);
+  return workers.reduce((a, b) => (b.busy < a.busy ? b : a));
+}
+
+/**
+ * Send a message to a Worker and wait for a response.
+ *
+ * The message goes to the Worker a session is pinned to, or else to the
+ * least busy Worker. If that Worker is blocked waiting on this session's
+ * answer, the message is written to its shared-memory channel instead of
+ * posted. Binary payloads (Uint8Array) are always posted, structured-cloned
+ * as raw bytes; bytes in results come back transferred, not cloned.
  */
-function callWorker(msg) {
+function callWorker(msg, entry) {
   return new Promise((resolve, reject) => {
     const id = nextId++;
-    pending.set(id, { resolve, reject });
-    worker.postMessage({ ...msg, id });
+    pending.set(id, { resolve, reject, entry });
+    entry.busy++;
+    const message = { ...msg, id };
+    const shared = entry.channel != null
+      && msg.data === undefined
+      && offer(entry.channel, message.sessionId, message);
+    if (!shared) entry.worker.postMessage(message);
+  });
+}
+
+/**
+ * Send a session-scoped message, keeping the session pinned while its
+ * execution is paused or waiting on futures.
+ */
+async function callSession(msg, sessionId) {
+  const session = sessionOf(sessionId);
+  const entry = pinned.get(session) || leastBusy();
+  const result = await callWorker({ ...msg, sessionId: session }, entry);
+  if (result.ok && (result.state === 'pending' || result.state === 'resolve_futures')) {
+    pinned.set(session, entry);
+  } else if (!result.ok || msg.type !== 'snapshot') {
+    // A failed call, snapshot included, leaves nothing on the Worker.
+    pinned.delete(session);
+  }
+  return result;
+}
+
+/**
+ * Encode a Worker result as JSON for Dart. Typed arrays (bytes values,
+ * transferred from the Worker) are written as arrays of numbers, as the
+ * native JSON transport writes bytes.
+ */
+function stringifyResult(result) {
+  return JSON.stringify(result, function bytesAsList(key, value) {
+    const raw = this[key];
+    return ArrayBuffer.isView(raw) && !(raw instanceof DataView)
+      ? Array.from(raw)
+      : value;
   });
 }
 
+function notInitialized() {
+  const error = workers ? NO_WORKERS : 'Not initialized';
+  return { ok: false, error, errorType: 'InitError' };
+}
+
 /**
  * Run Python code to completion.
  *
  * @param {string} code       Python source code.
  * @param {string} limitsJson JSON-encoded limits map (optional).
  * @param {string} scriptName Script name for tracebacks (optional).
+ * @param {string} inputsJson JSON object of input name -> value (optional).
  * @returns {Promise<string>} JSON result.
  */
-async function run(code, limitsJson, scriptName) {
-  if (!worker) {
-    return JSON.stringify({ ok: false, error: 'Not initialized', errorType: 'InitError' });
+async function run(code, limitsJson, scriptName, inputsJson) {
+  if (!workers?.length) {
+    return JSON.stringify(notInitialized());
   }
   const limits = limitsJson ? JSON.parse(limitsJson) : null;
   const msg = { type: 'run', code, limits };
   if (scriptName) msg.scriptName = scriptName;
-  const result = await callWorker(msg);
-  return JSON.stringify(result);
+  if (inputsJson) msg.inputs = JSON.parse(inputsJson);
+  const result = await callWorker(msg, leastBusy());
+  return stringifyResult(result);
 }
 
 /**
@@ -98,75 +256,130 @@ async function run(code, limitsJson, scriptName) {
  * @param {string} extFnsJson JSON array of external function names (optional).
  * @param {string} limitsJson JSON-encoded limits map (optional).
  * @param {string} scriptName Script name for tracebacks (optional).
+ * @param {number} sessionId  Session from createSession (optional).
+ * @param {string} inputsJson JSON object of input name -> value (optional).
  * @returns {Promise<string>} JSON result.
  */
-async function start(code, extFnsJson, limitsJson, scriptName) {
-  if (!worker) {
-    return JSON.stringify({ ok: false, error: 'Not initialized', errorType: 'InitError' });
+async function start(code, extFnsJson, limitsJson, scriptName, sessionId, inputsJson) {
+  if (!workers?.length) {
+    return JSON.stringify(notInitialized());
   }
   const extFns = extFnsJson ? JSON.parse(extFnsJson) : [];
   const limits = limitsJson ? JSON.parse(limitsJson) : null;
   const msg = { type: 'start', code, extFns, limits };
   if (scriptName) msg.scriptName = scriptName;
-  const result = await callWorker(msg);
-  return JSON.stringify(result);
+  if (inputsJson) msg.inputs = JSON.parse(inputsJson);
+  // A new execution replaces whatever the session had, wherever it was.
+  await discardSession(sessionId);
+  const result = await callSession(msg, sessionId);
+  return stringifyResult(result);
 }
 
 /**
  * Resume a paused execution with a return value.
  *
  * @param {string} valueJson JSON-encoded value to return to Python.
+ * @param {number} sessionId Session from createSession (optional).
  * @returns {Promise<string>} JSON result.
  */
-async function resume(valueJson) {
-  if (!worker) {
-    return JSON.stringify({ ok: false, error: 'Not initialized', errorType: 'InitError' });
+async function resume(valueJson, sessionId) {
+  if (!workers?.length) {
+    return JSON.stringify(notInitialized());
   }
   const value = JSON.parse(valueJson);
-  const result = await callWorker({ type: 'resume', value });
-  return JSON.stringify(result);
+  const result = await callSession({ type: 'resume', value }, sessionId);
+  return stringifyResult(result);
 }
 
 /**
  * Resume a paused execution with an error.
  *
  * @param {string} errorJson JSON-encoded error message string.
+ * @param {number} sessionId Session from createSession (optional).
  * @returns {Promise<string>} JSON result.
  */
-async function resumeWithError(errorJson) {
-  if (!worker) {
-    return JSON.stringify({ ok: false, error: 'Not initialized', errorType: 'InitError' });
+async function resumeWithError(errorJson, sessionId) {
+  if (!workers?.length) {
+    return JSON.stringify(notInitialized());
   }
   const errorMessage = JSON.parse(errorJson);
-  const result = await callWorker({ type: 'resumeWithError', errorMessage });
-  return JSON.stringify(result);
+  const result = await callSession({ type: 'resumeWithError', errorMessage }, sessionId);
+  return stringifyResult(result);
+}
+
+/**
+ * Resume a paused execution by turning the pending call into a future.
+ *
+ * The execution runs on until it awaits; the result is then either another
+ * pending call or state 'resolve_futures' with pendingCallIds.
+ *
+ * @param {number} sessionId Session from createSession (optional).
+ * @returns {Promise<string>} JSON result.
+ */
+async function resumeAsFuture(sessionId) {
+  if (!workers?.length) {
+    return JSON.stringify(notInitialized());
+  }
+  const result = await callSession({ type: 'resumeAsFuture' }, sessionId);
+  return stringifyResult(result);
+}
+
+/**
+ * Resolve the futures an execution is waiting on.
+ *
+ * @param {string} resultsJson JSON object of call ID -> return value.
+ * @param {string} errorsJson  JSON object of call ID -> error message.
+ * @param {number} sessionId   Session from createSession (optional).
+ * @returns {Promise<string>} JSON result.
+ */
+async function resolveFutures(resultsJson, errorsJson, sessionId) {
+  if (!workers?.length) {
+    return JSON.stringify(notInitialized());
+  }
+  const results = JSON.parse(resultsJson);
+  const errors = errorsJson ? JSON.parse(errorsJson) : {};
+  const result = await callSession({ type: 'resolveFutures', results, errors }, sessionId);
+  return stringifyResult(result);
 }
 
 /**
  * Capture the current interpreter state as a snapshot.
  *
- * @returns {Promise<string>} JSON result with base64-encoded data.
+ * Unlike the other calls this resolves to the result object itself, not
+ * JSON, so the snapshot bytes reach Dart as a Uint8Array (transferred from
+ * the Worker, not copied) instead of a base64 string.
+ *
+ * @param {number} sessionId Session from createSession (optional).
+ * @returns {Promise<{ok: boolean, data?: Uint8Array, error?: string, errorType?: string}>}
  */
-async function snapshot() {
-  if (!worker) {
-    return JSON.stringify({ ok: false, error: 'Not initialized', errorType: 'InitError' });
+async function snapshot(sessionId) {
+  if (!workers?.length) {
+    return notInitialized();
   }
-  const result = await callWorker({ type: 'snapshot' });
-  return JSON.stringify(result);
+  return callSession({ type: 'snapshot' }, sessionId);
 }
 
 /**
- * Restore interpreter state from a base64-encoded snapshot.
+ * Restore interpreter state from snapshot bytes.
+ *
+ * The bytes are cloned into the Worker rather than transferred, so the
+ * caller's buffer stays usable. The restored session is pinned to the
+ * Worker that loaded it.
  *
- * @param {string} dataBase64 Base64-encoded snapshot data.
+ * @param {Uint8Array} data   Snapshot bytes.
+ * @param {number} sessionId  Session from createSession (optional).
  * @returns {Promise<string>} JSON result.
  */
-async function restore(dataBase64) {
-  if (!worker) {
-    return JSON.stringify({ ok: false, error: 'Not initialized', errorType: 'InitError' });
+async function restore(data, sessionId) {
+  if (!workers?.length) {
+    return JSON.stringify(notInitialized());
   }
-  const result = await callWorker({ type: 'restore', dataBase64 });
-  return JSON.stringify(result);
+  await discardSession(sessionId);
+  const session = sessionOf(sessionId);
+  const entry = leastBusy();
+  const result = await callWorker({ type: 'restore', data, sessionId: session }, entry);
+  if (result.ok) pinned.set(session, entry);
+  return stringifyResult(result);
 }
 
 /**
@@ -175,33 +388,48 @@ async function restore(dataBase64) {
  * @returns {string} JSON describing bridge state.
  */
 function discover() {
-  return JSON.stringify({ loaded: worker !== null, architecture: 'worker' });
+  return JSON.stringify({
+    loaded: workers !== null && workers.length > 0,
+    architecture: 'worker',
+    workers: workers ? workers.length : 0,
+    syncChannel: workers ? workers.some((w) => w.channel !== null) : false,
+  });
+}
+
+async function discardSession(sessionId) {
+  const session = sessionOf(sessionId);
+  const entry = pinned.get(session);
+  if (!entry) return;
+  pinned.delete(session);
+  await callWorker({ type: 'dispose', sessionId: session }, entry);
 }
 
 /**
- * Dispose the current Worker session.
+ * Dispose a session, dropping any paused execution it holds. The Workers
+ * stay up for other sessions.
  *
+ * @param {number} sessionId Session from createSession (optional).
  * @returns {Promise<string>} JSON result.
  */
-async function dispose() {
-  if (!worker) {
-    return JSON.stringify({ ok: true });
+async function dispose(sessionId) {
+  if (workers) {
+    await discardSession(sessionId);
   }
-  const result = await callWorker({ type: 'dispose' });
-  return JSON.stringify(result);
+  return JSON.stringify({ ok: true });
 }
 
 // Expose bridge on window for Dart JS interop
 window.DartMontyBridge = {
   init,
+  createSession,
   run,
   start,
   resume,
   resumeWithError,
+  resumeAsFuture,
+  resolveFutures,
   snapshot,
   restore,
   discover,
   dispose,
 };
-
-console.log('[DartMontyBridge] Registered on window (Worker architecture)');
@@ -0,0 +1,72 @@
+/**
+ * snapshot_kind.js — Records which kind of pause a Worker snapshot holds.
+ *
+ * A session paused on an external call holds a MontySnapshot; one waiting
+ * on futures holds a MontyFutureSnapshot. Their dumps do not say which
+ * they came from, so the first byte of a snapshot records the kind and
+ * restore loads the rest back into the same class.
+ *
+ * Layout: [kind] followed by the dump of that class.
+ */
+
+/** Kind byte of a MontySnapshot: paused on an external call. */
+export const PENDING = 0;
+
+/** Kind byte of a MontyFutureSnapshot: waiting on futures. */
+export const FUTURES = 1;
+
+/**
+ * Dump the paused state of a session, tagged with its kind.
+ *
+ * @param {{snapshot: ?object, futures: ?object}|undefined} state
+ * @returns {Uint8Array|null} null when the session is not paused.
+ */
+export function dumpPaused(state) {
+  let kind;
+  let paused;
+  if (state?.snapshot) {
+    kind = PENDING;
+    paused = state.snapshot;
+  } else if (state?.futures) {
+    kind = FUTURES;
+    paused = state.futures;
+  } else {
+    return null;
+  }
+  const body = paused.dump();
+  const data = new Uint8Array(body.length + 1);
+  data[0] = kind;
+  data.set(body, 1);
+  return data;
+}
+
+/**
+ * Load bytes from dumpPaused back into the class they were dumped from.
+ *
+ * `classes.MontyFutureSnapshot` is undefined when the loaded runtime
+ * predates the futures state machine; a futures snapshot is then
+ * rejected rather than loaded as the wrong kind.
+ *
+ * @param {Uint8Array} data
+ * @param {{MontySnapshot: Function, MontyFutureSnapshot: ?Function}} classes
+ * @returns {{snapshot: ?object, futures: ?object}} The session fields to
+ *   set. The loaded value may be a MontyException, as `load` returns one
+ *   for bytes it cannot read.
+ * @throws {Error} for an unknown kind, or futures the runtime cannot load.
+ */
+export function loadPaused(data, { MontySnapshot, MontyFutureSnapshot }) {
+  const body = data.subarray(1);
+  switch (data[0]) {
+    case PENDING:
+      return { snapshot: MontySnapshot.load(body), futures: null };
+    case FUTURES:
+      if (!MontyFutureSnapshot) {
+        throw new Error(
+          'This runtime cannot restore a snapshot taken while resolving futures.',
+        );
+      }
+      return { snapshot: null, futures: MontyFutureSnapshot.load(body) };
+    default:
+      throw new Error(`Unrecognized snapshot kind: ${data[0]}.`);
+  }
+}
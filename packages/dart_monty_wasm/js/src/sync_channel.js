@@ -0,0 +1,123 @@
+/**
+ * sync_channel.js — Shared-memory channel for answering a paused Worker.
+ *
+ * When the page is cross-origin isolated, bridge.js gives each Worker a
+ * SharedArrayBuffer. A Worker that has just posted a pending call (or a
+ * wait on futures) blocks on it in Atomics.wait for up to its wait window.
+ * If the host answers within the window, bridge.js writes the next message
+ * for that session straight into shared memory and wakes the Worker,
+ * skipping the postMessage hop into the Worker and its structured clone.
+ * A slower answer finds the channel idle again and is posted as usual, so
+ * a Worker never stalls the other sessions it hosts for longer than the
+ * window.
+ *
+ * Layout: an Int32 header [state, sessionId, length] followed by the
+ * message as UTF-8 JSON.
+ */
+
+const IDLE = 0;
+const WAITING = 1; // Worker is blocked waiting on header[SESSION].
+const WRITING = 2; // Main thread is copying a message in.
+const READY = 3; // A message is ready for the Worker.
+
+const STATE = 0;
+const SESSION = 1;
+const LENGTH = 2;
+const HEADER_BYTES = 12;
+
+/** Message bytes a channel holds; larger messages are posted instead. */
+const CAPACITY = 1 << 20;
+
+/** Default time a paused Worker waits for its answer, in milliseconds. */
+export const DEFAULT_WAIT_MS = 20;
+
+const encoder = new TextEncoder();
+const decoder = new TextDecoder();
+
+/**
+ * Allocate a channel for one Worker.
+ *
+ * @returns {SharedArrayBuffer|null} null when the page is not cross-origin
+ *   isolated, so shared memory cannot be posted to a Worker.
+ */
+export function createChannel() {
+  if (typeof SharedArrayBuffer === 'undefined' || !globalThis.crossOriginIsolated) {
+    return null;
+  }
+  return new SharedArrayBuffer(HEADER_BYTES + CAPACITY);
+}
+
+/**
+ * Main thread: hand `msg` to the Worker if it is waiting on `sessionId`.
+ *
+ * @returns {boolean} false if nothing was written (the Worker is not
+ *   waiting on that session, or `msg` does not fit), in which case the
+ *   caller posts it instead.
+ */
+export function offer(channel, sessionId, msg) {
+  const header = new Int32Array(channel, 0, 3);
+  if (Atomics.load(header, STATE) !== WAITING) return false;
+  const bytes = encoder.encode(JSON.stringify(msg));
+  if (bytes.length > CAPACITY) return false;
+  if (Atomics.compareExchange(header, STATE, WAITING, WRITING) !== WAITING) {
+    return false;
+  }
+  // The session only changes while the channel is idle, so it is stable now.
+  if (Atomics.load(header, SESSION) !== sessionId) {
+    Atomics.store(header, STATE, WAITING);
+    Atomics.notify(header, STATE);
+    return false;
+  }
+  new Uint8Array(channel, HEADER_BYTES, bytes.length).set(bytes);
+  Atomics.store(header, LENGTH, bytes.length);
+  Atomics.store(header, STATE, READY);
+  Atomics.notify(header, STATE);
+  return true;
+}
+
+/**
+ * Worker: start accepting the next message of `sessionId`.
+ *
+ * Called before posting the result that pauses the session, so an answer
+ * sent as soon as the main thread sees it already finds the channel open.
+ */
+export function arm(channel, sessionId) {
+  const header = new Int32Array(channel, 0, 3);
+  Atomics.store(header, SESSION, sessionId);
+  Atomics.store(header, STATE, WAITING);
+}
+
+/**
+ * Worker: block for up to `waitMs` for the message {@link arm} opened the
+ * channel for.
+ *
+ * @returns {object|null} The message, or null if none came in time and
+ *   it will arrive as an ordinary message instead.
+ */
+export function waitFor(channel, waitMs) {
+  const header = new Int32Array(channel, 0, 3);
+  const deadline = performance.now() + waitMs;
+  for (;;) {
+    const state = Atomics.load(header, STATE);
+    if (state === READY) {
+      const length = Atomics.load(header, LENGTH);
+      // TextDecoder does not accept views of shared memory; copy first.
+      const bytes = new Uint8Array(channel, HEADER_BYTES, length).slice();
+      Atomics.store(header, STATE, IDLE);
+      return JSON.parse(decoder.decode(bytes));
+    }
+    if (state === WRITING) {
+      // The main thread finishes a write without yielding.
+      Atomics.wait(header, STATE, WRITING);
+      continue;
+    }
+    const remaining = deadline - performance.now();
+    if (remaining <= 0) {
+      if (Atomics.compareExchange(header, STATE, WAITING, IDLE) === WAITING) {
+        return null;
+      }
+      continue;
+    }
+    Atomics.wait(header, STATE, WAITING, remaining);
+  }
+}
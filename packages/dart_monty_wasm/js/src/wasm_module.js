@@ -0,0 +1,25 @@
+/**
+ * wasm_module.js — Receives the shared WebAssembly.Module in a Worker.
+ *
+ * bridge.js compiles the Monty binary once and posts it to each Worker as
+ * { type: 'module', module, syncChannel, syncWaitMs }. build.js patches
+ * the Monty loader to await self.__montyWasmModule instead of fetching
+ * and compiling the binary itself; if the bridge could not compile it
+ * (module is null), the loader falls back to its own fetch. The
+ * shared-memory channel, if any (see sync_channel.js), is kept on
+ * self.__montySyncChannel for worker_src.js.
+ *
+ * Imported first by worker_src.js so the listener exists before the
+ * loader's top-level await runs.
+ */
+
+self.__montyWasmModule = new Promise((resolve) => {
+  self.addEventListener('message', function onModule(e) {
+    if (e.data?.type !== 'module') return;
+    self.removeEventListener('message', onModule);
+    self.__montySyncChannel = e.data.syncChannel
+      ? { buffer: e.data.syncChannel, waitMs: e.data.syncWaitMs }
+      : null;
+    resolve(e.data.module || null);
+  });
+});
@@ -4,9 +4,14 @@
  * Chrome's 8MB synchronous WASM compile limit does NOT apply in Workers.
  * We directly use the stock NAPI-RS browser loader here.
  *
- * Bundled by esbuild into dart_monty_worker.js for the browser.
+ * Bundled by esbuild into dart_monty_worker.js for the browser. Several
+ * copies run side by side in a pool (see bridge.js); each holds the state
+ * of the sessions pinned to it.
  */
 
+// Must stay first: installs the listener for the shared WebAssembly.Module
+// before the Monty loader below awaits it.
+import './wasm_module.js';
 import {
   Monty,
   MontySnapshot,
@@ -14,10 +19,45 @@ import {
   MontyException,
   MontyTypingError,
 } from '@pydantic/monty-wasm32-wasi/monty.wasi-browser.js';
+import * as montyRuntime from '@pydantic/monty-wasm32-wasi/monty.wasi-browser.js';
+import { dumpPaused, loadPaused } from './snapshot_kind.js';
+import { arm, waitFor } from './sync_channel.js';
 
-let activeSnapshot = null;
-let activeMonty = null;
-let callIdCounter = 0;
+/**
+ * Progress class for an execution waiting on futures, or undefined when the
+ * loaded runtime predates the futures state machine.
+ */
+const { MontyFutureSnapshot } = montyRuntime;
+
+/** sessionId -> { monty, snapshot, futures, callIdCounter } */
+const sessions = new Map();
+
+/**
+ * Shared-memory channel from bridge.js, or null without cross-origin
+ * isolation: { buffer, waitMs }.
+ */
+const syncChannel = self.__montySyncChannel ?? null;
+
+/** Whether the last message left its session paused; see self.onmessage. */
+let paused = false;
+
+/**
+ * Note that `sessionId` is pausing, opening the shared-memory channel for
+ * its answer before the pause is posted.
+ */
+function pause(sessionId) {
+  paused = true;
+  if (syncChannel) arm(syncChannel.buffer, sessionId);
+}
+
+function sessionState(sessionId) {
+  let state = sessions.get(sessionId);
+  if (!state) {
+    state = { monty: null, snapshot: null, futures: null, callIdCounter: 0 };
+    sessions.set(sessionId, state);
+  }
+  return state;
+}
 
 // Signal ready
 self.postMessage({
@@ -90,14 +130,18 @@ function translateLimits(limits) {
 }
 
 /**
- * Post a progress result (pending or complete) back to the main thread.
- * Handles MontySnapshot (pending) vs MontyComplete dispatch.
+ * Post a progress result (pending, resolve_futures or complete) back to the
+ * main thread. Handles MontySnapshot (pending) vs MontyFutureSnapshot
+ * (resolve_futures) vs MontyComplete dispatch.
  */
-function postProgress(id, progress) {
+function postProgress(id, sessionId, progress) {
   if (progress instanceof MontySnapshot) {
-    callIdCounter++;
-    activeSnapshot = progress;
-    self.postMessage({
+    const state = sessionState(sessionId);
+    state.callIdCounter++;
+    state.snapshot = progress;
+    state.futures = null;
+    pause(sessionId);
+    postResult({
       type: 'result',
       id,
       ok: true,
@@ -105,12 +149,24 @@ function postProgress(id, progress) {
       functionName: progress.functionName,
       args: progress.args,
       kwargs: progress.kwargs,
-      callId: callIdCounter,
+      // Futures are resolved by the VM's call IDs, so prefer those.
+      callId: progress.callId ?? state.callIdCounter,
     });
-  } else {
-    activeSnapshot = null;
-    activeMonty = null;
+  } else if (MontyFutureSnapshot && progress instanceof MontyFutureSnapshot) {
+    const state = sessionState(sessionId);
+    state.snapshot = null;
+    state.futures = progress;
+    pause(sessionId);
     self.postMessage({
+      type: 'result',
+      id,
+      ok: true,
+      state: 'resolve_futures',
+      pendingCallIds: Array.from(progress.pendingCallIds),
+    });
+  } else {
+    sessions.delete(sessionId);
+    postResult({
       type: 'result',
       id,
       ok: true,
@@ -121,61 +177,121 @@ function postProgress(id, progress) {
 }
 
 /**
- * Post an error result, clearing active state.
+ * Post a result carrying Python values, transferring rather than cloning
+ * the buffers behind typed arrays in them (bytes), so a large value is not
+ * copied on its way to the main thread.
+ *
+ * Only a buffer a typed array spans whole is transferred, so a view into
+ * the WASM memory is never detached. If the buffers cannot be transferred,
+ * the result is cloned as before.
+ */
+function postResult(message) {
+  const buffers = new Set();
+  for (const value of [message.value, message.args, message.kwargs]) {
+    collectBuffers(value, buffers);
+  }
+  if (buffers.size === 0) {
+    self.postMessage(message);
+    return;
+  }
+  try {
+    self.postMessage(message, [...buffers]);
+  } catch (e) {
+    if (e?.name !== 'DataCloneError') throw e;
+    self.postMessage(message);
+  }
+}
+
+function collectBuffers(value, buffers) {
+  if (value == null || typeof value !== 'object') return;
+  if (ArrayBuffer.isView(value)) {
+    const { buffer } = value;
+    if (buffer instanceof ArrayBuffer
+      && value.byteOffset === 0
+      && value.byteLength === buffer.byteLength) {
+      buffers.add(buffer);
+    }
+    return;
+  }
+  if (value instanceof Map) {
+    for (const [key, item] of value) {
+      collectBuffers(key, buffers);
+      collectBuffers(item, buffers);
+    }
+    return;
+  }
+  const items = value instanceof Set ? value : Object.values(value);
+  for (const item of items) collectBuffers(item, buffers);
+}
+
+/**
+ * Post an error result, clearing the session's state (if any).
  */
-function postError(id, error) {
-  activeSnapshot = null;
-  activeMonty = null;
+function postError(id, error, sessionId) {
+  if (sessionId != null) sessions.delete(sessionId);
   self.postMessage({ type: 'result', id, ok: false, ...formatError(error) });
 }
 
-function handleRun(id, code, limits, scriptName) {
+/**
+ * Declare `inputs` (name -> value) on Monty.create options and return the
+ * matching options for run()/start().
+ */
+function applyInputs(opts, inputs) {
+  if (!inputs) return {};
+  opts.inputs = Object.keys(inputs);
+  return { inputs };
+}
+
+function handleRun(id, code, limits, scriptName, inputs) {
   try {
     const opts = translateLimits(limits);
     if (scriptName) opts.scriptName = scriptName;
+    const runOpts = applyInputs(opts, inputs);
     const m = Monty.create(code, opts);
     if (m instanceof MontyException || m instanceof MontyTypingError) {
       postError(id, m);
       return;
     }
-    const result = m.run();
+    const result = m.run(runOpts);
     if (result instanceof MontyException) {
       postError(id, result);
       return;
     }
-    self.postMessage({ type: 'result', id, ok: true, value: result });
+    postResult({ type: 'result', id, ok: true, value: result });
   } catch (e) {
     postError(id, e);
   }
 }
 
-function handleStart(id, code, extFns, limits, scriptName) {
+function handleStart(id, sessionId, code, extFns, limits, scriptName, inputs) {
   try {
-    callIdCounter = 0;
+    sessions.delete(sessionId);
     const opts = translateLimits(limits);
     if (scriptName) opts.scriptName = scriptName;
     if (extFns && extFns.length > 0) {
       opts.externalFunctions = extFns;
     }
+    const startOpts = applyInputs(opts, inputs);
     const m = Monty.create(code, opts);
     if (m instanceof MontyException || m instanceof MontyTypingError) {
-      postError(id, m);
+      postError(id, m, sessionId);
       return;
     }
-    activeMonty = m;
-    const progress = m.start();
+    sessionState(sessionId).monty = m;
+    const progress = m.start(startOpts);
     if (progress instanceof MontyException) {
-      postError(id, progress);
+      postError(id, progress, sessionId);
       return;
     }
-    postProgress(id, progress);
+    postProgress(id, sessionId, progress);
   } catch (e) {
-    postError(id, e);
+    postError(id, e, sessionId);
   }
 }
 
-function handleResume(id, value) {
-  if (!activeSnapshot) {
+function handleResume(id, sessionId, value) {
+  const snapshot = sessions.get(sessionId)?.snapshot;
+  if (!snapshot) {
     self.postMessage({
       type: 'result',
       id,
@@ -186,19 +302,20 @@ function handleResume(id, value) {
     return;
   }
   try {
-    const progress = activeSnapshot.resume({ returnValue: value });
+    const progress = snapshot.resume({ returnValue: value });
     if (progress instanceof MontyException) {
-      postError(id, progress);
+      postError(id, progress, sessionId);
       return;
     }
-    postProgress(id, progress);
+    postProgress(id, sessionId, progress);
   } catch (e) {
-    postError(id, e);
+    postError(id, e, sessionId);
   }
 }
 
-function handleResumeWithError(id, errorMessage) {
-  if (!activeSnapshot) {
+function handleResumeWithError(id, sessionId, errorMessage) {
+  const snapshot = sessions.get(sessionId)?.snapshot;
+  if (!snapshot) {
     self.postMessage({
       type: 'result',
       id,
@@ -209,93 +326,165 @@ function handleResumeWithError(id, errorMessage) {
     return;
   }
   try {
-    const progress = activeSnapshot.resume({
+    const progress = snapshot.resume({
       exception: { type: 'Exception', message: errorMessage },
     });
     if (progress instanceof MontyException) {
-      postError(id, progress);
+      postError(id, progress, sessionId);
       return;
     }
-    postProgress(id, progress);
+    postProgress(id, sessionId, progress);
   } catch (e) {
-    postError(id, e);
+    postError(id, e, sessionId);
   }
 }
 
-function handleSnapshot(id) {
-  if (!activeSnapshot) {
+function handleResumeAsFuture(id, sessionId) {
+  const snapshot = sessions.get(sessionId)?.snapshot;
+  if (!snapshot) {
     self.postMessage({
       type: 'result',
       id,
       ok: false,
-      error: 'No active snapshot to dump.',
+      error: 'No active snapshot to resume.',
       errorType: 'StateError',
     });
     return;
   }
+  if (!MontyFutureSnapshot) {
+    self.postMessage({
+      type: 'result',
+      id,
+      ok: false,
+      error: 'This Monty runtime does not support futures.',
+      errorType: 'UnsupportedError',
+    });
+    return;
+  }
   try {
-    const bytes = activeSnapshot.dump();
-    // Convert Uint8Array to base64
-    let binary = '';
-    for (let i = 0; i < bytes.length; i++) {
-      binary += String.fromCharCode(bytes[i]);
+    const progress = snapshot.resume({ future: true });
+    if (progress instanceof MontyException) {
+      postError(id, progress, sessionId);
+      return;
     }
-    const data = btoa(binary);
-    self.postMessage({ type: 'result', id, ok: true, data });
+    postProgress(id, sessionId, progress);
   } catch (e) {
-    postError(id, e);
+    postError(id, e, sessionId);
   }
 }
 
-function handleRestore(id, dataBase64) {
+/**
+ * Resolve the futures an execution is waiting on.
+ *
+ * @param {Object<string, *>} results      call ID -> return value.
+ * @param {Object<string, string>} errors  call ID -> message, raised in
+ *   Python as RuntimeError.
+ */
+function handleResolveFutures(id, sessionId, results, errors) {
+  const futures = sessions.get(sessionId)?.futures;
+  if (!futures) {
+    self.postMessage({
+      type: 'result',
+      id,
+      ok: false,
+      error: 'No pending futures to resolve.',
+      errorType: 'StateError',
+    });
+    return;
+  }
   try {
-    // Decode base64 to Uint8Array
-    const binary = atob(dataBase64);
-    const bytes = new Uint8Array(binary.length);
-    for (let i = 0; i < binary.length; i++) {
-      bytes[i] = binary.charCodeAt(i);
+    const exceptions = {};
+    for (const [callId, message] of Object.entries(errors || {})) {
+      exceptions[callId] = { type: 'RuntimeError', message };
     }
-    const snapshot = MontySnapshot.load(bytes);
-    if (snapshot instanceof MontyException) {
-      postError(id, snapshot);
+    const progress = futures.resume({ results: results || {}, errors: exceptions });
+    if (progress instanceof MontyException) {
+      postError(id, progress, sessionId);
+      return;
+    }
+    postProgress(id, sessionId, progress);
+  } catch (e) {
+    postError(id, e, sessionId);
+  }
+}
+
+function handleSnapshot(id, sessionId) {
+  const state = sessions.get(sessionId);
+  if (!state?.snapshot && !state?.futures) {
+    self.postMessage({
+      type: 'result',
+      id,
+      ok: false,
+      error: 'No active snapshot to dump.',
+      errorType: 'StateError',
+    });
+    return;
+  }
+  try {
+    const data = dumpPaused(state);
+    // Hand the buffer to the main thread instead of cloning it.
+    self.postMessage({ type: 'result', id, ok: true, data }, [data.buffer]);
+  } catch (e) {
+    postError(id, e, sessionId);
+  }
+}
+
+function handleRestore(id, sessionId, data) {
+  try {
+    sessions.delete(sessionId);
+    const { snapshot, futures } = loadPaused(data, { MontySnapshot, MontyFutureSnapshot });
+    const loaded = snapshot ?? futures;
+    if (loaded instanceof MontyException) {
+      postError(id, loaded, sessionId);
       return;
     }
-    activeSnapshot = snapshot;
+    Object.assign(sessionState(sessionId), { snapshot, futures });
     self.postMessage({ type: 'result', id, ok: true });
   } catch (e) {
-    postError(id, e);
+    postError(id, e, sessionId);
   }
 }
 
-function handleDispose(id) {
-  activeSnapshot = null;
-  activeMonty = null;
+function handleDispose(id, sessionId) {
+  sessions.delete(sessionId);
   self.postMessage({ type: 'result', id, ok: true });
 }
 
-self.onmessage = (e) => {
-  const { type, id, code, extFns, value, errorMessage, limits, dataBase64, scriptName } = e.data;
+function dispatch(message) {
+  const {
+    type, id, sessionId, code, extFns, value, errorMessage, limits, data, scriptName,
+    results, errors, inputs,
+  } = message;
   switch (type) {
+    case 'module':
+      // Consumed by wasm_module.js.
+      break;
     case 'run':
-      handleRun(id, code, limits, scriptName);
+      handleRun(id, code, limits, scriptName, inputs);
       break;
     case 'start':
-      handleStart(id, code, extFns, limits, scriptName);
+      handleStart(id, sessionId, code, extFns, limits, scriptName, inputs);
       break;
     case 'resume':
-      handleResume(id, value);
+      handleResume(id, sessionId, value);
       break;
     case 'resumeWithError':
-      handleResumeWithError(id, errorMessage);
+      handleResumeWithError(id, sessionId, errorMessage);
+      break;
+    case 'resumeAsFuture':
+      handleResumeAsFuture(id, sessionId);
+      break;
+    case 'resolveFutures':
+      handleResolveFutures(id, sessionId, results, errors);
       break;
     case 'snapshot':
-      handleSnapshot(id);
+      handleSnapshot(id, sessionId);
       break;
     case 'restore':
-      handleRestore(id, dataBase64);
+      handleRestore(id, sessionId, data);
       break;
     case 'dispose':
-      handleDispose(id);
+      handleDispose(id, sessionId);
       break;
     default:
       self.postMessage({
@@ -306,4 +495,20 @@ self.onmessage = (e) => {
         errorType: 'UnknownType',
       });
   }
+}
+
+/**
+ * Handle a message, then, while it leaves a session paused, wait briefly
+ * on the shared-memory channel for that session's answer instead of
+ * returning to the event loop for it.
+ */
+self.onmessage = (e) => {
+  let message = e.data;
+  while (message) {
+    paused = false;
+    dispatch(message);
+    message = syncChannel && paused
+      ? waitFor(syncChannel.buffer, syncChannel.waitMs)
+      : null;
+  }
 };
@@ -0,0 +1,17 @@
+/**
+ * channel_worker.mjs — Worker side of sync_channel.test.mjs.
+ *
+ * Arms the channel for `workerData.sessionId`, tells the main thread it
+ * is waiting, and reports what waitFor() returned within
+ * `workerData.waitMs`.
+ */
+
+import { parentPort, workerData } from 'node:worker_threads';
+
+import { arm, waitFor } from '../src/sync_channel.js';
+
+const { channel, sessionId, waitMs } = workerData;
+
+arm(channel, sessionId);
+parentPort.postMessage({ type: 'armed' });
+parentPort.postMessage({ type: 'taken', msg: waitFor(channel, waitMs) });
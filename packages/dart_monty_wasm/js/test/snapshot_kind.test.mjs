@@ -0,0 +1,74 @@
+/**
+ * snapshot_kind.test.mjs — Tests for the kind byte on Worker snapshots.
+ *
+ * Run with `npm test`. Stand-in classes record the bytes they are loaded
+ * from, so the tests need no WASM runtime.
+ */
+
+import assert from 'node:assert/strict';
+import { test } from 'node:test';
+
+import { FUTURES, PENDING, dumpPaused, loadPaused } from '../src/snapshot_kind.js';
+
+function fakeClass() {
+  return class {
+    constructor(bytes) {
+      this.bytes = Array.from(bytes);
+    }
+
+    dump() {
+      return Uint8Array.from(this.bytes);
+    }
+
+    static load(bytes) {
+      return new this(bytes);
+    }
+  };
+}
+
+const MontySnapshot = fakeClass();
+const MontyFutureSnapshot = fakeClass();
+
+test('a pending snapshot restores as a MontySnapshot', () => {
+  const data = dumpPaused({ snapshot: new MontySnapshot([1, 2]), futures: null });
+  assert.deepEqual(Array.from(data), [PENDING, 1, 2]);
+
+  const { snapshot, futures } = loadPaused(data, { MontySnapshot, MontyFutureSnapshot });
+  assert.ok(snapshot instanceof MontySnapshot);
+  assert.deepEqual(snapshot.bytes, [1, 2]);
+  assert.equal(futures, null);
+});
+
+test('a futures snapshot restores as a MontyFutureSnapshot', () => {
+  const data = dumpPaused({ snapshot: null, futures: new MontyFutureSnapshot([3]) });
+  assert.deepEqual(Array.from(data), [FUTURES, 3]);
+
+  const { snapshot, futures } = loadPaused(data, { MontySnapshot, MontyFutureSnapshot });
+  assert.equal(snapshot, null);
+  assert.ok(futures instanceof MontyFutureSnapshot);
+  assert.deepEqual(futures.bytes, [3]);
+});
+
+test('nothing is dumped for a session that is not paused', () => {
+  assert.equal(dumpPaused(undefined), null);
+  assert.equal(dumpPaused({ snapshot: null, futures: null }), null);
+});
+
+test('a futures snapshot is rejected without futures support', () => {
+  const data = dumpPaused({ snapshot: null, futures: new MontyFutureSnapshot([3]) });
+  assert.throws(
+    () => loadPaused(data, { MontySnapshot, MontyFutureSnapshot: undefined }),
+    /resolving futures/,
+  );
+});
+
+test('an unknown kind is rejected', () => {
+  assert.throws(
+    () => loadPaused(Uint8Array.of(7, 1), { MontySnapshot, MontyFutureSnapshot }),
+    /Unrecognized snapshot kind: 7/,
+  );
+  assert.throws(
+    () => loadPaused(new Uint8Array(0), { MontySnapshot, MontyFutureSnapshot }),
+    /Unrecognized snapshot kind/,
+  );
+});
@@ -0,0 +1,91 @@
+/**
+ * sync_channel.test.mjs — Tests for the shared-memory Worker channel.
+ *
+ * Run with `npm test`. Each test starts channel_worker.mjs, which arms
+ * the channel and blocks in waitFor() the way a paused Worker does.
+ */
+
+import assert from 'node:assert/strict';
+import { once } from 'node:events';
+import { test } from 'node:test';
+import { Worker } from 'node:worker_threads';
+
+import { createChannel, offer } from '../src/sync_channel.js';
+
+const HEADER_BYTES = 12;
+const CAPACITY = 1 << 20;
+
+function newChannel() {
+  return new SharedArrayBuffer(HEADER_BYTES + CAPACITY);
+}
+
+/** Start a Worker waiting on `sessionId`; resolves once it has armed. */
+async function startWaiting(channel, sessionId, waitMs) {
+  const worker = new Worker(new URL('./channel_worker.mjs', import.meta.url), {
+    workerData: { channel, sessionId, waitMs },
+  });
+  const taken = new Promise((resolve, reject) => {
+    worker.on('message', (m) => m.type === 'taken' && resolve(m.msg));
+    worker.on('error', reject);
+  });
+  const [armed] = await once(worker, 'message');
+  assert.equal(armed.type, 'armed');
+  return { worker, taken };
+}
+
+test('createChannel needs cross-origin isolation', () => {
+  assert.equal(createChannel(), null);
+  globalThis.crossOriginIsolated = true;
+  try {
+    const channel = createChannel();
+    assert.ok(channel instanceof SharedArrayBuffer);
+    assert.equal(channel.byteLength, HEADER_BYTES + CAPACITY);
+  } finally {
+    delete globalThis.crossOriginIsolated;
+  }
+});
+
+test('offer is refused while no Worker waits', () => {
+  assert.equal(offer(newChannel(), 1, { type: 'resume' }), false);
+});
+
+test('a waiting Worker takes the offered message', async () => {
+  const channel = newChannel();
+  const { worker, taken } = await startWaiting(channel, 1, 5000);
+  const msg = { type: 'resume', value: 'é', sessionId: 1 };
+
+  assert.equal(offer(channel, 1, msg), true);
+  assert.deepEqual(await taken, msg);
+  // The Worker left the channel idle, so a later answer is posted.
+  assert.equal(offer(channel, 1, msg), false);
+  await worker.terminate();
+});
+
+test('a Worker gives up after its wait window', async () => {
+  const channel = newChannel();
+  const { worker, taken } = await startWaiting(channel, 1, 20);
+
+  assert.equal(await taken, null);
+  assert.equal(offer(channel, 1, { type: 'resume' }), false);
+  await worker.terminate();
+});
+
+test('offers for another session leave the Worker waiting', async () => {
+  const channel = newChannel();
+  const { worker, taken } = await startWaiting(channel, 2, 5000);
+
+  assert.equal(offer(channel, 1, { type: 'resume', sessionId: 1 }), false);
+  assert.equal(offer(channel, 2, { type: 'resume', sessionId: 2 }), true);
+  assert.deepEqual(await taken, { type: 'resume', sessionId: 2 });
+  await worker.terminate();
+});
+
+test('messages over the capacity are refused', async () => {
+  const channel = newChannel();
+  const { worker, taken } = await startWaiting(channel, 1, 5000);
+
+  assert.equal(offer(channel, 1, { data: 'x'.repeat(CAPACITY) }), false);
+  assert.equal(offer(channel, 1, { data: 'small' }), true);
+  assert.deepEqual(await taken, { data: 'small' });
+  await worker.terminate();
+});
@@ -7,7 +7,7 @@ import 'package:dart_monty_wasm/src/wasm_core_bindings.dart';
 /// Web WASM implementation of [MontyPlatform].
 ///
 /// Extends [BaseMontyPlatform] to inherit run/start/resume/dispose logic
-/// and adds [MontySnapshotCapable] for snapshot/restore support.
+/// and adds [MontySnapshotCapable] and [MontyFutureCapable] support.
 ///
 /// ```dart
 /// final monty = MontyWasm(bindings: WasmBindingsJs());
@@ -15,7 +15,8 @@ import 'package:dart_monty_wasm/src/wasm_core_bindings.dart';
 /// print(result.value); // 4
 /// await monty.dispose();
 /// ```
-class MontyWasm extends BaseMontyPlatform implements MontySnapshotCapable {
+class MontyWasm extends BaseMontyPlatform
+    implements MontySnapshotCapable, MontyFutureCapable {
   /// Creates a [MontyWasm] with the given [bindings].
   factory MontyWasm({required WasmBindings bindings}) {
     final core = WasmCoreBindings(bindings: bindings);
@@ -33,6 +34,23 @@ class MontyWasm extends BaseMontyPlatform implements MontySnapshotCapable {
   @override
   String get backendName => 'MontyWasm';
 
+  @override
+  Future<MontyProgress> resumeAsFuture() async {
+    assertNotDisposed('resumeAsFuture');
+    assertActive('resumeAsFuture');
+    return resumePendingAsFuture();
+  }
+
+  @override
+  Future<MontyProgress> resolveFutures(
+    Map<int, Object?> results, {
+    Map<int, String>? errors,
+  }) async {
+    assertNotDisposed('resolveFutures');
+    assertActive('resolveFutures');
+    return resolvePendingFutures(results, errors: errors);
+  }
+
   @override
   Future<Uint8List> snapshot() {
     assertNotDisposed('snapshot');
@@ -47,6 +65,7 @@ class MontyWasm extends BaseMontyPlatform implements MontySnapshotCapable {
     final core = WasmCoreBindings(bindings: _wasmBindings);
     await core.restoreSnapshot(data);
     return MontyWasm._(coreBindings: core, wasmBindings: _wasmBindings)
-      ..markActive();
+      ..markActive()
+      ..callCache = callCache;
   }
 }
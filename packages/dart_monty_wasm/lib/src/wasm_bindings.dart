@@ -132,11 +132,14 @@ abstract class WasmBindings {
 
   /// Runs Python [code] to completion.
   ///
+  /// If [inputsJson] is non-null, it is a JSON object of input names to
+  /// values, bound as global variables before the code runs.
   /// If [limitsJson] is non-null, it is a JSON-encoded map of limits.
   /// If [scriptName] is non-null, it overrides the default filename in
   /// tracebacks and error messages.
   Future<WasmRunResult> run(
     String code, {
+    String? inputsJson,
     String? limitsJson,
     String? scriptName,
   });
@@ -146,8 +149,10 @@ abstract class WasmBindings {
   /// If [extFnsJson] is non-null, it is a JSON array of external function
   /// names. If [limitsJson] is non-null, it is a JSON-encoded map of limits.
   /// If [scriptName] is non-null, it overrides the default filename.
+  /// [inputsJson] is as for [run].
   Future<WasmProgressResult> start(
     String code, {
+    String? inputsJson,
     String? extFnsJson,
     String? limitsJson,
     String? scriptName,
@@ -161,12 +166,14 @@ abstract class WasmBindings {
 
   /// Resumes by creating a future for the pending call.
   ///
-  /// Not yet supported in the WASM backend.
+  /// The execution continues until it awaits, then reports
+  /// `'resolve_futures'` with the call IDs still outstanding.
   Future<WasmProgressResult> resumeAsFuture();
 
   /// Resolves pending futures with [resultsJson] and [errorsJson].
   ///
-  /// Not yet supported in the WASM backend.
+  /// Both are JSON objects keyed by call ID (as a string); each error
+  /// value is a message raised in Python as a `RuntimeError`.
   Future<WasmProgressResult> resolveFutures(
     String resultsJson,
     String errorsJson,
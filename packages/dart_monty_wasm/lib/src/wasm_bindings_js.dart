@@ -9,13 +9,20 @@ import 'package:dart_monty_wasm/src/wasm_bindings.dart';
 // ---------------------------------------------------------------------------
 
 @JS('DartMontyBridge.init')
-external JSPromise<JSBoolean> _jsInit();
+external JSPromise<JSBoolean> _jsInit([
+  JSNumber? poolSize,
+  JSNumber? syncWaitMs,
+]);
+
+@JS('DartMontyBridge.createSession')
+external JSNumber _jsCreateSession();
 
 @JS('DartMontyBridge.run')
 external JSPromise<JSString> _jsRun(
   JSString code, [
   JSString? limitsJson,
   JSString? scriptName,
+  JSString? inputsJson,
 ]);
 
 @JS('DartMontyBridge.start')
@@ -24,37 +31,97 @@ external JSPromise<JSString> _jsStart(
   JSString? extFnsJson,
   JSString? limitsJson,
   JSString? scriptName,
+  JSNumber? sessionId,
+  JSString? inputsJson,
 ]);
 
 @JS('DartMontyBridge.resume')
-external JSPromise<JSString> _jsResume(JSString valueJson);
+external JSPromise<JSString> _jsResume(
+  JSString valueJson, [
+  JSNumber? sessionId,
+]);
 
 @JS('DartMontyBridge.resumeWithError')
-external JSPromise<JSString> _jsResumeWithError(JSString errorJson);
+external JSPromise<JSString> _jsResumeWithError(
+  JSString errorJson, [
+  JSNumber? sessionId,
+]);
+
+@JS('DartMontyBridge.resumeAsFuture')
+external JSPromise<JSString> _jsResumeAsFuture([JSNumber? sessionId]);
+
+@JS('DartMontyBridge.resolveFutures')
+external JSPromise<JSString> _jsResolveFutures(
+  JSString resultsJson,
+  JSString errorsJson, [
+  JSNumber? sessionId,
+]);
 
 @JS('DartMontyBridge.snapshot')
-external JSPromise<JSString> _jsSnapshot();
+external JSPromise<_JsSnapshotResult> _jsSnapshot([JSNumber? sessionId]);
 
 @JS('DartMontyBridge.restore')
-external JSPromise<JSString> _jsRestore(JSString dataBase64);
+external JSPromise<JSString> _jsRestore(
+  JSUint8Array data, [
+  JSNumber? sessionId,
+]);
 
 @JS('DartMontyBridge.discover')
 external JSString _jsDiscover();
 
 @JS('DartMontyBridge.dispose')
-external JSPromise<JSString> _jsDispose();
+external JSPromise<JSString> _jsDispose([JSNumber? sessionId]);
+
+/// Result object of `DartMontyBridge.snapshot`, which carries the snapshot
+/// as a `Uint8Array` rather than JSON.
+extension type _JsSnapshotResult._(JSObject _) implements JSObject {
+  external bool get ok;
+  external JSUint8Array? get data;
+  external String? get error;
+}
 
 /// Concrete [WasmBindings] implementation using `dart:js_interop`.
 ///
-/// Calls into `window.DartMontyBridge` which communicates with a Web Worker
-/// hosting the @pydantic/monty WASM runtime.
+/// Calls into `window.DartMontyBridge`, which runs executions on a pool of
+/// Web Workers hosting the @pydantic/monty WASM runtime. The pool is shared
+/// by every [WasmBindingsJs] on the page, and compiles the WASM binary once.
+///
+/// Each instance owns a bridge session, so separate instances can run
+/// concurrently on different Workers; a paused execution stays on the Worker
+/// that holds its snapshot.
 class WasmBindingsJs extends WasmBindings {
   /// Creates a [WasmBindingsJs].
-  WasmBindingsJs();
+  ///
+  /// [poolSize] sets the number of Workers when this is the first instance
+  /// to [init] the bridge; it defaults to the number of logical processors,
+  /// capped at 4. Later instances share the existing pool.
+  ///
+  /// [syncWaitMs] sets how long a Worker paused at an external call waits
+  /// on shared memory for the answer; see [syncWaitMs]. Like [poolSize],
+  /// only the first instance to [init] the bridge sets it.
+  WasmBindingsJs({this.poolSize, this.syncWaitMs});
+
+  /// Requested number of Workers in the shared pool.
+  final int? poolSize;
+
+  /// Milliseconds a Worker that has just paused at an external call, or
+  /// on futures, blocks waiting for the answer on a `SharedArrayBuffer`
+  /// before going back to its message queue. `null` uses the bridge
+  /// default of 20 ms; `0` turns the channel off.
+  ///
+  /// An answer given within the window is written straight into the
+  /// Worker's memory instead of posted to it, which removes the
+  /// message-passing hop from each call. The channel needs a
+  /// cross-origin isolated page (see the README); elsewhere every answer
+  /// is posted.
+  final int? syncWaitMs;
+
+  JSNumber? _session;
 
   @override
   Future<bool> init() async {
-    final result = await _jsInit().toDart;
+    final result = await _jsInit(poolSize?.toJS, syncWaitMs?.toJS).toDart;
+    if (result.toDart) _session ??= _jsCreateSession();
 
     return result.toDart;
   }
@@ -62,6 +129,7 @@ class WasmBindingsJs extends WasmBindings {
   @override
   Future<WasmRunResult> run(
     String code, {
+    String? inputsJson,
     String? limitsJson,
     String? scriptName,
   }) async {
@@ -69,6 +137,7 @@ class WasmBindingsJs extends WasmBindings {
       code.toJS,
       limitsJson?.toJS,
       scriptName?.toJS,
+      inputsJson?.toJS,
     ).toDart;
     final map = json.decode(resultJson.toDart) as Map<String, dynamic>;
     final rawTraceback = map['traceback'] as List<Object?>?;
@@ -86,6 +155,7 @@ class WasmBindingsJs extends WasmBindings {
   @override
   Future<WasmProgressResult> start(
     String code, {
+    String? inputsJson,
     String? extFnsJson,
     String? limitsJson,
     String? scriptName,
@@ -95,6 +165,8 @@ class WasmBindingsJs extends WasmBindings {
       extFnsJson?.toJS,
       limitsJson?.toJS,
       scriptName?.toJS,
+      _session,
+      inputsJson?.toJS,
     ).toDart;
 
     return _decodeProgress(resultJson.toDart);
@@ -102,7 +174,7 @@ class WasmBindingsJs extends WasmBindings {
 
   @override
   Future<WasmProgressResult> resume(String valueJson) async {
-    final resultJson = await _jsResume(valueJson.toJS).toDart;
+    final resultJson = await _jsResume(valueJson.toJS, _session).toDart;
 
     return _decodeProgress(resultJson.toDart);
   }
@@ -110,16 +182,17 @@ class WasmBindingsJs extends WasmBindings {
   @override
   Future<WasmProgressResult> resumeWithError(String errorMessage) async {
     final errorJson = json.encode(errorMessage);
-    final resultJson = await _jsResumeWithError(errorJson.toJS).toDart;
+    final resultJson =
+        await _jsResumeWithError(errorJson.toJS, _session).toDart;
 
     return _decodeProgress(resultJson.toDart);
   }
 
   @override
   Future<WasmProgressResult> resumeAsFuture() async {
-    throw UnsupportedError(
-      'resumeAsFuture() is not supported in the WASM backend.',
-    );
+    final resultJson = await _jsResumeAsFuture(_session).toDart;
+
+    return _decodeProgress(resultJson.toDart);
   }
 
   @override
@@ -127,29 +200,29 @@ class WasmBindingsJs extends WasmBindings {
     String resultsJson,
     String errorsJson,
   ) async {
-    throw UnsupportedError(
-      'resolveFutures() is not supported in the WASM backend.',
-    );
+    final resultJson = await _jsResolveFutures(
+      resultsJson.toJS,
+      errorsJson.toJS,
+      _session,
+    ).toDart;
+
+    return _decodeProgress(resultJson.toDart);
   }
 
   @override
   Future<Uint8List> snapshot() async {
-    final resultJson = await _jsSnapshot().toDart;
-    final map = json.decode(resultJson.toDart) as Map<String, dynamic>;
-    if (map['ok'] != true) {
-      throw StateError(
-        map['error'] as String? ?? 'Snapshot failed',
-      );
+    final result = await _jsSnapshot(_session).toDart;
+    final data = result.data;
+    if (!result.ok || data == null) {
+      throw StateError(result.error ?? 'Snapshot failed');
     }
-    final dataBase64 = map['data'] as String;
 
-    return base64Decode(dataBase64);
+    return data.toDart;
   }
 
   @override
   Future<void> restore(Uint8List data) async {
-    final dataBase64 = base64Encode(data);
-    final resultJson = await _jsRestore(dataBase64.toJS).toDart;
+    final resultJson = await _jsRestore(data.toJS, _session).toDart;
     final map = json.decode(resultJson.toDart) as Map<String, dynamic>;
     if (map['ok'] != true) {
       throw StateError(
@@ -171,7 +244,7 @@ class WasmBindingsJs extends WasmBindings {
 
   @override
   Future<void> dispose() async {
-    final resultJson = await _jsDispose().toDart;
+    final resultJson = await _jsDispose(_session).toDart;
     final map = json.decode(resultJson.toDart) as Map<String, dynamic>;
     if (map['ok'] != true) {
       throw StateError(
@@ -35,12 +35,14 @@ class WasmCoreBindings implements MontyCoreBindings {
   @override
   Future<CoreRunResult> run(
     String code, {
+    String? inputsJson,
     String? limitsJson,
     String? scriptName,
   }) async {
     final sw = Stopwatch()..start();
     final result = await _bindings.run(
       code,
+      inputsJson: inputsJson,
       limitsJson: limitsJson,
       scriptName: scriptName,
     );
@@ -51,6 +53,7 @@ class WasmCoreBindings implements MontyCoreBindings {
   @override
   Future<CoreProgressResult> start(
     String code, {
+    String? inputsJson,
     String? extFnsJson,
     String? limitsJson,
     String? scriptName,
@@ -58,6 +61,7 @@ class WasmCoreBindings implements MontyCoreBindings {
     final sw = Stopwatch()..start();
     final progress = await _bindings.start(
       code,
+      inputsJson: inputsJson,
       extFnsJson: extFnsJson,
       limitsJson: limitsJson,
       scriptName: scriptName,
@@ -84,7 +88,10 @@ class WasmCoreBindings implements MontyCoreBindings {
 
   @override
   Future<CoreProgressResult> resumeAsFuture() async {
-    throw UnsupportedError('resumeAsFuture() not supported in WASM');
+    final sw = Stopwatch()..start();
+    final progress = await _bindings.resumeAsFuture();
+    sw.stop();
+    return _translateProgressResult(progress, sw.elapsedMilliseconds);
   }
 
   @override
@@ -92,7 +99,10 @@ class WasmCoreBindings implements MontyCoreBindings {
     String resultsJson,
     String errorsJson,
   ) async {
-    throw UnsupportedError('resolveFutures() not supported in WASM');
+    final sw = Stopwatch()..start();
+    final progress = await _bindings.resolveFutures(resultsJson, errorsJson);
+    sw.stop();
+    return _translateProgressResult(progress, sw.elapsedMilliseconds);
   }
 
   @override
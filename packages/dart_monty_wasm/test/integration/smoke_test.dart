@@ -26,19 +26,45 @@ external JSPromise<JSString> _bridgeStart(
   JSString code, [
   JSString? extFnsJson,
   JSString? limitsJson,
+  JSString? scriptName,
+  JSNumber? sessionId,
 ]);
 
 @JS('DartMontyBridge.resume')
-external JSPromise<JSString> _bridgeResume(JSString valueJson);
+external JSPromise<JSString> _bridgeResume(
+  JSString valueJson, [
+  JSNumber? sessionId,
+]);
+
+@JS('DartMontyBridge.createSession')
+external JSNumber _bridgeCreateSession();
+
+@JS('DartMontyBridge.discover')
+external JSString _bridgeDiscover();
 
 @JS('DartMontyBridge.resumeWithError')
 external JSPromise<JSString> _bridgeResumeWithError(JSString errorJson);
 
+@JS('DartMontyBridge.resumeAsFuture')
+external JSPromise<JSString> _bridgeResumeAsFuture();
+
+@JS('DartMontyBridge.resolveFutures')
+external JSPromise<JSString> _bridgeResolveFutures(
+  JSString resultsJson,
+  JSString errorsJson,
+);
+
 @JS('DartMontyBridge.snapshot')
-external JSPromise<JSString> _bridgeSnapshot();
+external JSPromise<_SnapshotResult> _bridgeSnapshot();
 
 @JS('DartMontyBridge.restore')
-external JSPromise<JSString> _bridgeRestore(JSString dataBase64);
+external JSPromise<JSString> _bridgeRestore(JSUint8Array data);
+
+extension type _SnapshotResult._(JSObject _) implements JSObject {
+  external bool get ok;
+  external JSUint8Array? get data;
+  external String? get error;
+}
 
 // ---------------------------------------------------------------------------
 // Helpers
@@ -161,23 +187,24 @@ Future<void> _testSnapshot() async {
   }
 
   // Take a snapshot
-  final snapResult = _parse((await _bridgeSnapshot().toDart).toDart);
+  final snapResult = await _bridgeSnapshot().toDart;
+  final data = snapResult.data;
 
-  if (snapResult['ok'] != true || snapResult['data'] == null) {
+  if (!snapResult.ok || data == null) {
     // MontySnapshot.dump() uses Node.js Buffer, not available in browsers.
     // This is a known NAPI-RS limitation — skip gracefully.
-    final error = snapResult['error'] as String? ?? '';
+    final error = snapResult.error ?? '';
     if (error.contains('Buffer')) {
       _pass('snapshot_skip_buffer');
       return;
     }
-    _fail('snapshot', 'Snapshot failed: $snapResult');
+    _fail('snapshot', 'Snapshot failed: $error');
     return;
   }
 
   // Restore the snapshot
   final restoreResult = _parse(
-    (await _bridgeRestore((snapResult['data'] as String).toJS).toDart).toDart,
+    (await _bridgeRestore(data).toDart).toDart,
   );
 
   if (restoreResult['ok'] == true) {
@@ -187,6 +214,81 @@ Future<void> _testSnapshot() async {
   }
 }
 
+Future<void> _testConcurrentSessions() async {
+  // Two sessions paused at the same time keep separate state, even when
+  // they land on the same Worker.
+  final a = _bridgeCreateSession();
+  final b = _bridgeCreateSession();
+  Future<Map<String, dynamic>> startWith(JSNumber session, int n) async =>
+      _parse(
+        (await _bridgeStart(
+          'x = $n\nfetch() + x'.toJS,
+          '["fetch"]'.toJS,
+          null,
+          null,
+          session,
+        ).toDart)
+            .toDart,
+      );
+  Future<Map<String, dynamic>> resumeWith(JSNumber session) async =>
+      _parse((await _bridgeResume('100'.toJS, session).toDart).toDart);
+
+  final started = await Future.wait([startWith(a, 1), startWith(b, 2)]);
+  if (started.any((r) => r['state'] != 'pending')) {
+    _fail('concurrent_sessions', 'Expected both pending, got $started');
+    return;
+  }
+
+  // Resume in the opposite order to the starts.
+  final doneB = await resumeWith(b);
+  final doneA = await resumeWith(a);
+  if (doneA['value'] == 101 && doneB['value'] == 102) {
+    print('SMOKE_INFO:workers=${_parse(_bridgeDiscover().toDart)['workers']}');
+    _pass('concurrent_sessions');
+  } else {
+    _fail('concurrent_sessions', 'Got a=$doneA b=$doneB');
+  }
+}
+
+Future<void> _testFutures() async {
+  // asyncio.gather issues both calls before either is resolved.
+  var result = _parse(
+    (await _bridgeStart(
+      'import asyncio\n'
+              'async def main():\n'
+              '    a, b = await asyncio.gather(foo(), bar())\n'
+              '    return a + b\n'
+              'await main()'
+          .toJS,
+      '["foo", "bar"]'.toJS,
+    ).toDart)
+        .toDart,
+  );
+  final callIds = <int>[];
+  while (result['ok'] == true && result['state'] == 'pending') {
+    callIds.add(result['callId'] as int);
+    result = _parse((await _bridgeResumeAsFuture().toDart).toDart);
+  }
+  if (result['errorType'] == 'UnsupportedError') {
+    print('SMOKE_INFO:futures=unsupported');
+    return;
+  }
+  if (result['state'] != 'resolve_futures' || callIds.length != 2) {
+    _fail('futures', 'Expected two futures, got $callIds then $result');
+    return;
+  }
+
+  final results = jsonEncode({'${callIds[0]}': 10, '${callIds[1]}': 32});
+  result = _parse(
+    (await _bridgeResolveFutures(results.toJS, '{}'.toJS).toDart).toDart,
+  );
+  if (result['state'] == 'complete' && result['value'] == 42) {
+    _pass('futures');
+  } else {
+    _fail('futures', 'Expected 42, got $result');
+  }
+}
+
 // ---------------------------------------------------------------------------
 // Main
 // ---------------------------------------------------------------------------
@@ -207,6 +309,8 @@ Future<void> main() async {
   await _testIterative();
   await _testResumeWithError();
   await _testSnapshot();
+  await _testConcurrentSessions();
+  await _testFutures();
 
   print('SMOKE_DONE');
 }
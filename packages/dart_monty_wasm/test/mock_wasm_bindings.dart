@@ -31,6 +31,12 @@ class MockWasmBindings extends WasmBindings {
   /// Queue of results returned by [resumeWithError]. Dequeues on each call.
   final List<WasmProgressResult> resumeWithErrorResults = [];
 
+  /// Queue of results returned by [resumeAsFuture]. Dequeues on each call.
+  final List<WasmProgressResult> resumeAsFutureResults = [];
+
+  /// Queue of results returned by [resolveFutures]. Dequeues on each call.
+  final List<WasmProgressResult> resolveFuturesResults = [];
+
   /// Data returned by [snapshot].
   Uint8List nextSnapshotData = Uint8List.fromList([1, 2, 3]);
 
@@ -56,15 +62,22 @@ class MockWasmBindings extends WasmBindings {
   /// Number of times [init] was called.
   int initCalls = 0;
 
-  /// Records of `(code, limitsJson, scriptName)` passed to [run].
-  final List<({String code, String? limitsJson, String? scriptName})> runCalls =
-      [];
+  /// Records of `(code, inputsJson, limitsJson, scriptName)` passed to
+  /// [run].
+  final List<
+      ({
+        String code,
+        String? inputsJson,
+        String? limitsJson,
+        String? scriptName,
+      })> runCalls = [];
 
-  /// Records of `(code, extFnsJson, limitsJson, scriptName)` passed to
-  /// [start].
+  /// Records of `(code, inputsJson, extFnsJson, limitsJson, scriptName)`
+  /// passed to [start].
   final List<
       ({
         String code,
+        String? inputsJson,
         String? extFnsJson,
         String? limitsJson,
         String? scriptName,
@@ -76,6 +89,13 @@ class MockWasmBindings extends WasmBindings {
   /// Records of `errorMessage` passed to [resumeWithError].
   final List<String> resumeWithErrorCalls = [];
 
+  /// Number of times [resumeAsFuture] was called.
+  int resumeAsFutureCalls = 0;
+
+  /// Records of `(resultsJson, errorsJson)` passed to [resolveFutures].
+  final List<({String resultsJson, String errorsJson})> resolveFuturesCalls =
+      [];
+
   /// Number of times [snapshot] was called.
   int snapshotCalls = 0;
 
@@ -102,10 +122,18 @@ class MockWasmBindings extends WasmBindings {
   @override
   Future<WasmRunResult> run(
     String code, {
+    String? inputsJson,
     String? limitsJson,
     String? scriptName,
   }) async {
-    runCalls.add((code: code, limitsJson: limitsJson, scriptName: scriptName));
+    runCalls.add(
+      (
+        code: code,
+        inputsJson: inputsJson,
+        limitsJson: limitsJson,
+        scriptName: scriptName,
+      ),
+    );
 
     return nextRunResult;
   }
@@ -113,6 +141,7 @@ class MockWasmBindings extends WasmBindings {
   @override
   Future<WasmProgressResult> start(
     String code, {
+    String? inputsJson,
     String? extFnsJson,
     String? limitsJson,
     String? scriptName,
@@ -120,6 +149,7 @@ class MockWasmBindings extends WasmBindings {
     startCalls.add(
       (
         code: code,
+        inputsJson: inputsJson,
         extFnsJson: extFnsJson,
         limitsJson: limitsJson,
         scriptName: scriptName,
@@ -155,7 +185,15 @@ class MockWasmBindings extends WasmBindings {
 
   @override
   Future<WasmProgressResult> resumeAsFuture() async {
-    throw UnsupportedError('resumeAsFuture() not supported in WASM');
+    resumeAsFutureCalls++;
+    if (resumeAsFutureResults.isNotEmpty) {
+      return resumeAsFutureResults.removeAt(0);
+    }
+
+    return const WasmProgressResult(
+      ok: true,
+      state: 'complete',
+    );
   }
 
   @override
@@ -163,7 +201,17 @@ class MockWasmBindings extends WasmBindings {
     String resultsJson,
     String errorsJson,
   ) async {
-    throw UnsupportedError('resolveFutures() not supported in WASM');
+    resolveFuturesCalls.add(
+      (resultsJson: resultsJson, errorsJson: errorsJson),
+    );
+    if (resolveFuturesResults.isNotEmpty) {
+      return resolveFuturesResults.removeAt(0);
+    }
+
+    return const WasmProgressResult(
+      ok: true,
+      state: 'complete',
+    );
   }
 
   @override
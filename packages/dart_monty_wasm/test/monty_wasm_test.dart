@@ -105,11 +105,12 @@ void main() {
       expect(mock.runCalls.first.limitsJson, isNull);
     });
 
-    test('throws UnsupportedError for non-empty inputs', () {
-      expect(
-        () => monty.run('x', inputs: {'a': 1}),
-        throwsA(isA<UnsupportedError>()),
-      );
+    test('passes inputs as JSON', () async {
+      mock.nextRunResult = const WasmRunResult(ok: true, value: 2);
+      final result = await monty.run('a + 1', inputs: {'a': 1});
+
+      expect(result.value, 2);
+      expect(mock.runCalls.first.inputsJson, '{"a":1}');
     });
 
     test('allows null inputs', () async {
@@ -269,11 +270,9 @@ void main() {
       );
     });
 
-    test('throws UnsupportedError for non-empty inputs', () {
-      expect(
-        () => monty.start('x', inputs: {'a': 1}),
-        throwsA(isA<UnsupportedError>()),
-      );
+    test('passes inputs as JSON', () async {
+      await monty.start('x', inputs: {'x': 'v'});
+      expect(mock.startCalls.first.inputsJson, '{"x":"v"}');
     });
 
     test('throws StateError when disposed', () async {
@@ -875,8 +874,8 @@ void main() {
       expect(monty, isA<MontySnapshotCapable>());
     });
 
-    test('is not MontyFutureCapable', () {
-      expect(monty, isNot(isA<MontyFutureCapable>()));
+    test('is MontyFutureCapable', () {
+      expect(monty, isA<MontyFutureCapable>());
     });
   });
 
@@ -928,5 +927,75 @@ void main() {
       expect(() => monty.run('y'), throwsStateError);
       expect(() => monty.start('y'), throwsStateError);
     });
+
+    test('gather fans out calls and resolves them together', () async {
+      mock
+        ..nextStartResult = const WasmProgressResult(
+          ok: true,
+          state: 'pending',
+          functionName: 'a',
+          arguments: [],
+          callId: 1,
+        )
+        ..resumeAsFutureResults.addAll([
+          const WasmProgressResult(
+            ok: true,
+            state: 'pending',
+            functionName: 'b',
+            arguments: [],
+            callId: 2,
+          ),
+          const WasmProgressResult(
+            ok: true,
+            state: 'resolve_futures',
+            pendingCallIds: [1, 2],
+          ),
+        ])
+        ..resolveFuturesResults.add(
+          const WasmProgressResult(ok: true, state: 'complete', value: 30),
+        );
+
+      var progress = await monty.start(
+        'sum(await asyncio.gather(a(), b()))',
+        externalFunctions: ['a', 'b'],
+      );
+      while (progress is MontyPending) {
+        progress = await monty.resumeAsFuture();
+      }
+      expect(progress, isA<MontyResolveFutures>());
+
+      final done = await monty.resolveFutures({1: 10}, errors: {2: 'boom'});
+
+      expect(done, isA<MontyComplete>());
+      expect((done as MontyComplete).result.value, 30);
+      expect(mock.resumeAsFutureCalls, 2);
+      expect(
+        mock.resolveFuturesCalls.single,
+        (resultsJson: '{"1":10}', errorsJson: '{"2":"boom"}'),
+      );
+    });
+
+    test('resolveFutures without errors sends an empty map', () async {
+      mock.nextStartResult = const WasmProgressResult(
+        ok: true,
+        state: 'resolve_futures',
+        pendingCallIds: [0],
+      );
+      await monty.start('x', externalFunctions: ['a']);
+
+      await monty.resolveFutures({0: 'v'});
+
+      expect(mock.resolveFuturesCalls.single.errorsJson, '{}');
+    });
+
+    test('resumeAsFuture throws when idle', () {
+      expect(monty.resumeAsFuture, throwsStateError);
+    });
+
+    test('resolveFutures throws after dispose', () async {
+      await monty.dispose();
+
+      expect(() => monty.resolveFutures({}), throwsStateError);
+    });
   });
 }
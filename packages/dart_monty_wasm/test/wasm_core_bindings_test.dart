@@ -277,16 +277,52 @@ void main() {
   // ===========================================================================
   // resumeAsFuture() / resolveFutures()
   // ===========================================================================
-  group('unsupported methods', () {
-    test('resumeAsFuture throws UnsupportedError', () {
-      expect(bindings.resumeAsFuture, throwsUnsupportedError);
+  group('resumeAsFuture() / resolveFutures()', () {
+    test('resumeAsFuture translates resolve_futures state', () async {
+      mock.resumeAsFutureResults.add(
+        const WasmProgressResult(
+          ok: true,
+          state: 'resolve_futures',
+          pendingCallIds: [1, 2],
+        ),
+      );
+
+      final result = await bindings.resumeAsFuture();
+
+      expect(result.state, 'resolve_futures');
+      expect(result.pendingCallIds, [1, 2]);
+      expect(mock.resumeAsFutureCalls, 1);
     });
 
-    test('resolveFutures throws UnsupportedError', () {
+    test('resolveFutures delegates JSON and translates result', () async {
+      mock.resolveFuturesResults.add(
+        const WasmProgressResult(ok: true, state: 'complete', value: 3),
+      );
+
+      final result = await bindings.resolveFutures('{"1":1}', '{"2":"x"}');
+
+      expect(result.state, 'complete');
+      expect(result.value, 3);
+      expect(result.usage, isNotNull);
       expect(
-        () => bindings.resolveFutures('{}', '{}'),
-        throwsUnsupportedError,
+        mock.resolveFuturesCalls.single,
+        (resultsJson: '{"1":1}', errorsJson: '{"2":"x"}'),
+      );
+    });
+
+    test('resolveFutures error translates to error state', () async {
+      mock.resolveFuturesResults.add(
+        const WasmProgressResult(
+          ok: false,
+          error: 'RuntimeError: boom',
+          excType: 'RuntimeError',
+        ),
       );
+
+      final result = await bindings.resolveFutures('{}', '{}');
+
+      expect(result.state, 'error');
+      expect(result.excType, 'RuntimeError');
     });
   });
 
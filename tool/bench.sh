@@ -0,0 +1,130 @@
+#!/usr/bin/env bash
+# =============================================================================
+# Benchmark Script — all backends
+# =============================================================================
+# Runs the Rust criterion benches and the Dart benchmark suite against the
+# ffi, native, and wasm backends.
+#
+# Usage: bash tool/bench.sh [--save-baseline NAME | --baseline NAME] [rust|ffi|native|wasm]...
+#
+# To check a monty rev bump for regressions:
+#   bash tool/bench.sh --save-baseline before rust   # on the old rev
+#   bash tool/bench.sh --baseline before rust        # on the new rev
+# =============================================================================
+set -euo pipefail
+
+ROOT="$(git rev-parse --show-toplevel)"
+CRITERION_ARGS=()
+TARGETS=()
+
+while [ $# -gt 0 ]; do
+  case "$1" in
+    --save-baseline|--baseline)
+      CRITERION_ARGS+=("$1" "$2")
+      shift 2
+      ;;
+    *)
+      TARGETS+=("$1")
+      shift
+      ;;
+  esac
+done
+[ ${#TARGETS[@]} -eq 0 ] && TARGETS=(rust ffi native wasm)
+
+case "$(uname -s)" in
+  Darwin) LIB="$ROOT/native/target/release/libdart_monty_native.dylib" ;;
+  *)      LIB="$ROOT/native/target/release/libdart_monty_native.so" ;;
+esac
+export DART_MONTY_LIB_PATH="$LIB"
+
+build_native() {
+  if [ ! -f "$LIB" ]; then
+    (cd "$ROOT/native" && cargo build --release)
+  fi
+}
+
+bench_rust() {
+  echo "=== Rust: cargo bench ==="
+  cd "$ROOT/native"
+  cargo bench --bench interpreter -- "${CRITERION_ARGS[@]}"
+}
+
+bench_ffi() {
+  echo "=== Dart: ffi ==="
+  build_native
+  cd "$ROOT/packages/dart_monty_ffi"
+  dart pub get
+  dart run benchmark/monty_benchmark.dart
+}
+
+bench_native() {
+  echo "=== Dart: native ==="
+  build_native
+  cd "$ROOT/packages/dart_monty_native"
+  dart pub get
+  dart run benchmark/monty_benchmark.dart
+}
+
+bench_wasm() {
+  echo "=== Dart: wasm (headless Chrome) ==="
+  local pkg="$ROOT/packages/dart_monty_wasm"
+  local web="$pkg/benchmark/web"
+
+  (cd "$pkg/js" && npm install && npm run build)
+  cd "$pkg"
+  dart pub get
+  cp "$pkg/assets/dart_monty_bridge.js" "$pkg/assets/dart_monty_worker.js" \
+     "$pkg/assets/wasi-worker-browser.mjs" "$pkg/assets/"*.wasm "$web/"
+  dart compile js -O2 benchmark/monty_benchmark.dart -o "$web/monty_benchmark.dart.js"
+
+  local port=8098
+  python3 -c "
+import http.server, functools
+
+class H(http.server.SimpleHTTPRequestHandler):
+    def end_headers(self):
+        self.send_header('Cross-Origin-Opener-Policy', 'same-origin')
+        self.send_header('Cross-Origin-Embedder-Policy', 'require-corp')
+        self.send_header('Cache-Control', 'no-store')
+        super().end_headers()
+    def guess_type(self, path):
+        if path.endswith('.mjs'): return 'application/javascript'
+        if path.endswith('.wasm'): return 'application/wasm'
+        return super().guess_type(path)
+    def log_message(self, fmt, *args): pass
+
+handler = functools.partial(H, directory='$web')
+http.server.HTTPServer(('127.0.0.1', $port), handler).serve_forever()
+" &
+  local server=$!
+  # shellcheck disable=SC2064
+  trap "kill $server 2>/dev/null || true; rm -f '$web'/*.js '$web'/*.js.* '$web'/*.mjs '$web'/*.wasm" RETURN
+  sleep 1
+
+  local chrome=""
+  for c in google-chrome-stable google-chrome chromium; do
+    if command -v "$c" &>/dev/null; then chrome="$c"; break; fi
+  done
+  if [ -z "$chrome" ]; then
+    echo "  WARN: Chrome not found. Skipping wasm benchmarks."
+    return
+  fi
+
+  local log
+  log=$(mktemp)
+  timeout 600 "$chrome" --headless=new --disable-gpu --no-sandbox \
+    --disable-dev-shm-usage --enable-logging=stderr --v=0 \
+    "http://127.0.0.1:$port/index.html" 2>"$log" || true
+  grep -oE 'wasm\.[a-z_0-9]+(\(RunTime\): [0-9.e+-]+ us\.|: skipped.*)' "$log" || true
+  grep -q 'BENCH_DONE' "$log" || { echo "FAIL: wasm benchmarks did not finish"; exit 1; }
+}
+
+for target in "${TARGETS[@]}"; do
+  case "$target" in
+    rust)   (bench_rust) ;;
+    ffi)    (bench_ffi) ;;
+    native) (bench_native) ;;
+    wasm)   (bench_wasm) ;;
+    *) echo "Unknown target: $target" >&2; exit 1 ;;
+  esac
+done
@@ -21,6 +21,7 @@ DIRS=(
   "."
   "packages/dart_monty_platform_interface"
   "packages/dart_monty_ffi"
+  "packages/dart_monty_builder"
   "packages/dart_monty_wasm"
   "packages/dart_monty_web"
   "packages/dart_monty_native"